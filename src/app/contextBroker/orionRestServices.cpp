@@ -130,6 +130,7 @@
 #include "serviceRoutinesV2/logLevelTreat.h"
 #include "serviceRoutinesV2/semStateTreat.h"
 #include "serviceRoutinesV2/getMetrics.h"
+#include "serviceRoutinesV2/getMetricsPrometheus.h"
 #include "serviceRoutinesV2/deleteMetrics.h"
 #include "serviceRoutinesV2/optionsGetOnly.h"
 #include "serviceRoutinesV2/optionsGetPostOnly.h"
@@ -216,6 +217,7 @@ static RestService getServiceV[] =
   { LogLevelRequest,                               2, { "admin", "log"                                                                 },  getLogLevel                                      },
   { SemStateRequest,                               2, { "admin", "sem"                                                                 },  semStateTreat                                    },
   { MetricsRequest,                                2, { "admin", "metrics"                                                             },  getMetrics                                       },
+  { MetricsRequest,                                3, { "admin", "metrics", "prometheus"                                               },  getMetricsPrometheus                             },
 
 #ifdef DEBUG
   { ExitRequest,                                   2, { "exit", "*"                                                                    },  exitTreat                                        },
@@ -501,6 +503,7 @@ static RestService badVerbV[] =
   { LogLevelRequest,                               2, { "admin", "log"                                                                 }, badVerbPutOnly            },
   { SemStateRequest,                               2, { "admin", "sem"                                                                 }, badVerbGetOnly            },
   { MetricsRequest,                                2, { "admin", "metrics"                                                             }, badVerbGetDeleteOnly      },
+  { MetricsRequest,                                3, { "admin", "metrics", "prometheus"                                               }, badVerbGetOnly            },
   { UpdateContext,                                 2, { "ngsi10",  "updateContext"                                                     }, badVerbPostOnly           },
   { QueryContext,                                  2, { "ngsi10",  "queryContext"                                                      }, badVerbPostOnly           },
   { SubscribeContext,                              2, { "ngsi10",  "subscribeContext"                                                  }, badVerbPostOnly           },
@@ -110,8 +110,14 @@ extern "C"
 
 #include "orionld/common/orionldState.h"                    // orionldStateRelease, kalloc, ...
 #include "orionld/context/orionldContextCacheRelease.h"     // orionldContextCacheRelease
+#include "orionld/context/orionldContextCache.h"            // orionldContextCacheMaxItems
+#include "orionld/common/orionldEndpointPoolInit.h"         // orionldEndpointPoolInit
+#include "orionld/notifications/notificationQueue.h"        // NOTIFICATION_SENDERS_MAX
+#include "orionld/notifications/notificationSendersStart.h" // notificationSendersStart
 #include "orionld/rest/orionldServiceInit.h"                // orionldServiceInit
+#include "orionld/context/orionldContextCacheUsersRelease.h" // orionldContextCacheUsersRelease
 #include "orionld/db/dbInit.h"                              // dbInit
+#include "orionld/db/dbRegCacheStart.h"                     // dbRegCacheStart
 
 #include "orionld/version.h"
 #include "orionld/orionRestServices.h"
@@ -170,6 +176,7 @@ int             subCacheInterval;
 char            notificationMode[64];
 int             notificationQueueSize;
 int             notificationThreadNum;
+int             notificationMaxPerEndpoint;
 bool            noCache;
 unsigned int    connectionMemory;
 unsigned int    maxConnections;
@@ -190,6 +197,13 @@ bool            insecureNotif;
 bool            ngsiv1Autocast;
 int             contextDownloadAttempts;
 int             contextDownloadTimeout;
+int             contextCacheSize;
+int             notifPoolSize;
+int             notifIdleTimeout;
+int             notifSenders;
+int             notifQueueSize;
+int             logQueueSize;
+int             slowRequestThreshold;
 
 
 
@@ -204,6 +218,14 @@ int             contextDownloadTimeout;
 
 #define CTX_TMO_DESC           "Timeout in milliseconds for downloading of contexts"
 #define CTX_ATT_DESC           "Number of attempts for downloading of contexts"
+#define CTX_CACHE_DESC         "Maximum number of contexts in the context cache"
+#define NOTIF_POOL_DESC        "Maximum number of keep-alive connections per notification endpoint"
+#define NOTIF_IDLE_DESC        "Seconds an idle keep-alive notification connection is kept open"
+#define NOTIF_SENDERS_DESC     "Number of notification sender threads (0: notifications are sent by the request thread)"
+#define NOTIF_QUEUE_DESC       "Maximum number of queued notifications"
+#define CURL_MAX_PER_HOST_DESC "Maximum number of simultaneous transfers per host in persistent notification mode (0: no limit)"
+#define LOG_QUEUE_DESC         "Number of log lines queued for an asynchronous log writer thread (0: synchronous logging)"
+#define SLOW_REQ_DESC          "Threshold in milliseconds for logging a per-phase trace of slow requests (0: off)"
 #define FG_DESC                "don't start as daemon"
 #define LOCALIP_DESC           "IP to receive new connections"
 #define PORT_DESC              "port to receive new connections"
@@ -231,7 +253,7 @@ int             contextDownloadTimeout;
 #define WRITE_CONCERN_DESC     "db write concern (0:unacknowledged, 1:acknowledged)"
 #define CPR_FORWARD_LIMIT_DESC "maximum number of forwarded requests to Context Providers for a single client request"
 #define SUB_CACHE_IVAL_DESC    "interval in seconds between calls to Subscription Cache refresh (0: no refresh)"
-#define NOTIFICATION_MODE_DESC "notification mode (persistent|transient|threadpool:q:n)"
+#define NOTIFICATION_MODE_DESC "notification mode (persistent|transient|threadpool:q:n[:c])"
 #define NO_CACHE               "disable subscription cache for lookups"
 #define CONN_MEMORY_DESC       "maximum memory size per connection (in kilobytes)"
 #define MAX_CONN_DESC          "maximum number of simultaneous connections"
@@ -326,6 +348,16 @@ PaArgument paArgs[] =
 
   { "-ctxTimeout",     &contextDownloadTimeout,  "CONTEXT_DOWNLOAD_TIMEOUT",  PaInt,  PaOpt, 5000, 0, 20000, CTX_TMO_DESC },
   { "-ctxAttempts",    &contextDownloadAttempts, "CONTEXT_DOWNLOAD_ATTEMPTS", PaInt,  PaOpt,    3, 0,   100, CTX_ATT_DESC },
+  { "-ctxCacheSize",   &contextCacheSize,        "CONTEXT_CACHE_SIZE",        PaInt,  PaOpt, 10000, 10, 1000000, CTX_CACHE_DESC },
+
+  { "-notifPoolSize",    &notifPoolSize,    "NOTIF_POOL_SIZE",    PaInt, PaOpt,    10, 1,                        64, NOTIF_POOL_DESC        },
+  { "-notifIdleTimeout", &notifIdleTimeout, "NOTIF_IDLE_TIMEOUT", PaInt, PaOpt,    30, 0,                      3600, NOTIF_IDLE_DESC        },
+  { "-notifSenders",     &notifSenders,     "NOTIF_SENDERS",      PaInt, PaOpt,     2, 0, NOTIFICATION_SENDERS_MAX, NOTIF_SENDERS_DESC     },
+  { "-notifQueueSize",   &notifQueueSize,   "NOTIF_QUEUE_SIZE",   PaInt, PaOpt, 10000, 1,                   1000000, NOTIF_QUEUE_DESC       },
+  { "-curlMaxPerHost",   &curlMaxPerHost,   "CURL_MAX_PER_HOST",  PaInt, PaOpt,     0, 0,                     10000, CURL_MAX_PER_HOST_DESC },
+  { "-logQueueSize",     &logQueueSize,     "LOG_QUEUE_SIZE",     PaInt, PaOpt,     0, 0,                   1000000, LOG_QUEUE_DESC         },
+
+  { "-slowRequestThreshold", &slowRequestThreshold, "SLOW_REQUEST_THRESHOLD", PaInt, PaOpt, 0, 0, 3600000, SLOW_REQ_DESC },
 
   PA_END_OF_ARGS
 };
@@ -604,7 +636,7 @@ static void contextBrokerInit(std::string dbPrefix, bool multitenant)
   /* If we use a queue for notifications, start worker threads */
   if (strcmp(notificationMode, "threadpool") == 0)
   {
-    QueueNotifier*  pQNotifier = new QueueNotifier(notificationQueueSize, notificationThreadNum);
+    QueueNotifier*  pQNotifier = new QueueNotifier(notificationQueueSize, notificationThreadNum, notificationMaxPerEndpoint);
     int             rc         = pQNotifier->start();
 
     if (rc != 0)
@@ -750,7 +782,7 @@ static SemOpType policyGet(std::string mutexPolicy)
 *
 * notificationModeParse -
 */
-static void notificationModeParse(char *notifModeArg, int *pQueueSize, int *pNumThreads)
+static void notificationModeParse(char *notifModeArg, int *pQueueSize, int *pNumThreads, int *pMaxPerEndpoint)
 {
   char* mode;
   char* first_colon;
@@ -758,12 +790,13 @@ static void notificationModeParse(char *notifModeArg, int *pQueueSize, int *pNum
   errno = 0;
   // notifModeArg is a char[64], pretty sure not a huge input to break sscanf
   // cppcheck-suppress invalidscanf
-  flds_num = sscanf(notifModeArg, "%m[^:]:%d:%d", &mode, pQueueSize, pNumThreads);
+  *pMaxPerEndpoint = 0;
+  flds_num = sscanf(notifModeArg, "%m[^:]:%d:%d:%d", &mode, pQueueSize, pNumThreads, pMaxPerEndpoint);
   if (errno != 0)
   {
     LM_X(1, ("Fatal Error parsing notification mode: sscanf (%s)", strerror(errno)));
   }
-  if (flds_num == 3 && strcmp(mode, "threadpool") == 0)
+  if ((flds_num == 3 || flds_num == 4) && strcmp(mode, "threadpool") == 0)
   {
     if (*pQueueSize <= 0)
     {
@@ -773,6 +806,10 @@ static void notificationModeParse(char *notifModeArg, int *pQueueSize, int *pNum
     {
       LM_X(1, ("Fatal Error parsing notification mode: invalid number of threads (%d)",*pNumThreads));
     }
+    if (*pMaxPerEndpoint < 0)
+    {
+      LM_X(1, ("Fatal Error parsing notification mode: invalid max number of threads per endpoint (%d)", *pMaxPerEndpoint));
+    }
   }
   else if (flds_num == 1 && strcmp(mode, "threadpool") == 0)
   {
@@ -949,8 +986,8 @@ int main(int argC, char* argV[])
     }
   }
 
-  notificationModeParse(notificationMode, &notificationQueueSize, &notificationThreadNum); // This should be called before contextBrokerInit()
-  LM_T(LmtNotifier, ("notification mode: '%s', queue size: %d, num threads %d", notificationMode, notificationQueueSize, notificationThreadNum));
+  notificationModeParse(notificationMode, &notificationQueueSize, &notificationThreadNum, &notificationMaxPerEndpoint); // This should be called before contextBrokerInit()
+  LM_T(LmtNotifier, ("notification mode: '%s', queue size: %d, num threads %d, max threads per endpoint: %d", notificationMode, notificationQueueSize, notificationThreadNum, notificationMaxPerEndpoint));
   LM_I(("Orion Context Broker is running"));
 
   if (fg == false)
@@ -964,6 +1001,17 @@ int main(int argC, char* argV[])
     _exit(s);
   }
 
+  //
+  // The log writer thread must be started after daemonize() - threads don't survive a fork()
+  //
+  if (logQueueSize > 0)
+  {
+    if (lmAsyncStart(logQueueSize) != LmsOk)
+    {
+      LM_X(1, ("Fatal Error (unable to start the asynchronous log writer thread)"));
+    }
+  }
+
 #if 0
   //
   // This 'almost always outdeffed' piece of code is used whenever a change is done to the
@@ -1007,26 +1055,6 @@ int main(int argC, char* argV[])
     LM_T(LmtRush, ("rush host: '%s', rush port: %d", rushHost.c_str(), rushPort));
   }
 
-  if (noCache == false)
-  {
-    subCacheInit(multitenancy);
-
-    if (subCacheInterval == 0)
-    {
-      // Populate subscription cache from database
-      subCacheRefresh();
-    }
-    else
-    {
-      // Populate subscription cache AND start sub-cache-refresh-thread
-      subCacheStart();
-    }
-  }
-  else
-  {
-    LM_T(LmtSubCache, ("noCache == false"));
-  }
-
   //
   // Given that contextBrokerInit() may create thread (in the threadpool notification mode,
   // it has to be done before curl_global_init(), see https://curl.haxx.se/libcurl/c/threaded-ssl.html
@@ -1050,8 +1078,40 @@ int main(int argC, char* argV[])
   //
   // Initialize orionld
   //
+  orionldContextCacheMaxItems = contextCacheSize;
+  orionldEndpointPoolInit(notifPoolSize, notifIdleTimeout);
+  notificationSendersStart(notifSenders, notifQueueSize);
   orionldServiceInit(restServiceVV, 9, getenv("ORIONLD_CACHED_CONTEXT_DIRECTORY"));
 
+  //
+  // The subscription cache and the registration cache need orionldState (initialized by orionldServiceInit) to be populated.
+  // The 'q' of NGSI-LD subscriptions is compiled as the subscriptions are inserted in the subscription cache, and that needs
+  // the context cache.
+  //
+  if (noCache == false)
+  {
+    subCacheInit(multitenancy);
+
+    if (subCacheInterval == 0)
+    {
+      // Populate subscription cache from database
+      subCacheRefresh();
+      subCacheQCompilePending();
+    }
+    else
+    {
+      // Populate subscription cache AND start sub-cache-refresh-thread
+      subCacheStart();
+    }
+
+    orionldContextCacheUsersRelease();  // The @contexts of the subscriptions are no longer used by this thread
+    dbRegCacheStart();
+  }
+  else
+  {
+    LM_T(LmtSubCache, ("noCache == false"));
+  }
+
   if (https)
   {
     char* httpsPrivateServerKey = (char*) malloc(2048);
@@ -44,6 +44,7 @@
 #include "orionld/serviceRoutines/orionldGetContext.h"
 #include "orionld/serviceRoutines/orionldGetContexts.h"
 #include "orionld/serviceRoutines/orionldGetVersion.h"
+#include "orionld/serviceRoutines/orionldGetStatistics.h"
 #include "orionld/serviceRoutines/orionldNotImplemented.h"
 #include "orionld/serviceRoutines/orionldPostBatchUpsert.h"
 
@@ -67,6 +68,7 @@ static OrionLdRestServiceSimplified getServices[] =
   { "/ngsi-ld/ex/v1/contexts/*",           orionldGetContext         },
   { "/ngsi-ld/ex/v1/contexts",             orionldGetContexts        },
   { "/ngsi-ld/ex/v1/version",              orionldGetVersion         },
+  { "/ngsi-ld/ex/v1/statistics",           orionldGetStatistics      },
   { "/ngsi-ld/v1/temporal/entities",       orionldNotImplemented     },
   { "/ngsi-ld/v1/temporal/entities/*",     orionldNotImplemented     }
 };
@@ -125,7 +127,7 @@ static OrionLdRestServiceSimplified deleteServices[] =
 //
 OrionLdRestServiceSimplifiedVector restServiceVV[] =
 {
-  { getServices,    11 },
+  { getServices,    12 },
   { NULL,           0  },
   { postServices,   8  },
   { deleteServices, 4  },
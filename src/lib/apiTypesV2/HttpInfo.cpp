@@ -51,7 +51,7 @@ namespace ngsiv2
 * HttpInfo::HttpInfo - 
 */
 #ifdef ORIONLD
-HttpInfo::HttpInfo() : verb(NOVERB), custom(false), mimeType(DEFAULT_MIMETYPE)
+HttpInfo::HttpInfo() : verb(NOVERB), custom(false), mimeType(DEFAULT_MIMETYPE), batchMaxEntities(0), batchMaxDelay(0)
 #else
 HttpInfo::HttpInfo() : verb(NOVERB), custom(false)
 #endif
@@ -65,7 +65,7 @@ HttpInfo::HttpInfo() : verb(NOVERB), custom(false)
 * HttpInfo::HttpInfo - 
 */
 #ifdef ORIONLD
-HttpInfo::HttpInfo(const std::string& _url) : url(_url), verb(NOVERB), custom(false), mimeType(DEFAULT_MIMETYPE)
+HttpInfo::HttpInfo(const std::string& _url) : url(_url), verb(NOVERB), custom(false), mimeType(DEFAULT_MIMETYPE), batchMaxEntities(0), batchMaxDelay(0)
 #else
 HttpInfo::HttpInfo(const std::string& _url) : url(_url), verb(NOVERB), custom(false)
 #endif
@@ -126,6 +126,9 @@ void HttpInfo::fill(const BSONObj& bo)
 
   mimeTypeString = bo.hasField(CSUB_MIMETYPE)? getStringFieldF(bo, CSUB_MIMETYPE) : "application/json";  // Default
   this->mimeType = longStringToMimeType(mimeTypeString);
+
+  this->batchMaxEntities = bo.hasField(CSUB_BATCH_MAX_ENTITIES)? getIntFieldF(bo, CSUB_BATCH_MAX_ENTITIES) : 0;
+  this->batchMaxDelay    = bo.hasField(CSUB_BATCH_MAX_DELAY)?    getIntFieldF(bo, CSUB_BATCH_MAX_DELAY)    : 0;
 #endif
 
   if (this->custom)
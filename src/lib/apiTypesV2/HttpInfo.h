@@ -53,6 +53,8 @@ struct HttpInfo
   bool                                custom;
 #ifdef ORIONLD
   MimeType                            mimeType;
+  int                                 batchMaxEntities;  // 0: no notification batching
+  int                                 batchMaxDelay;     // Milliseconds
 #endif
   HttpInfo();
   explicit HttpInfo(const std::string& _url);
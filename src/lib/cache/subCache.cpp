@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
 
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
@@ -41,6 +42,24 @@
 #include "cache/subCache.h"
 #include "alarmMgr/alarmMgr.h"
 
+#ifdef ORIONLD
+#include "orionld/types/OrionldGeoFilter.h"
+#include "orionld/geo/geoFilterParse.h"
+#include "orionld/common/QCompiled.h"
+#include "orionld/common/qCompiledRelease.h"
+#include "orionld/common/qCompile.h"
+#include "orionld/common/orionldState.h"
+#include "orionld/context/orionldContextFromUrl.h"
+#include "orionld/context/orionldContextCacheLookup.h"
+#include "orionld/context/orionldContextCacheUsersRelease.h"
+
+extern "C"
+{
+#include "kalloc/kaStrdup.h"
+#include "kalloc/kaBufferReset.h"
+}
+#endif
+
 using std::map;
 
 
@@ -233,6 +252,396 @@ bool             subCacheMultitenant = false;
 
 
 
+/* ****************************************************************************
+*
+* SubCacheIndex -
+*
+* To avoid having to check each and every cached subscription for each and every
+* updated entity, the subscriptions are indexed in a few levels:
+*
+*   1. Tenant (only if the broker runs with -multiservice)
+*   2. Service path
+*      - exact service paths, by the service path itself
+*      - wildcard service paths ("/a/b/#"), by the prefix ("/a/b/")
+*        To find the candidates for a service path, all its prefixes are looked up.
+*   3. Entity
+*      - by entity id            (EntityInfo with an exact id)
+*      - by entity type          (EntityInfo with an id pattern and an exact type)
+*      - the rest, in one list   (EntityInfo with both id pattern and type pattern, or no type)
+*   4. Attribute - a posting list per condition attribute, plus one list for the
+*      subscriptions without condition attributes (those match any attribute)
+*
+* The index only selects the candidates - every candidate is then checked with subMatch(),
+* just like before, so the index must never miss a subscription that would match, but it
+* can return subscriptions that don't.
+*
+* The list subCache.head/tail is still the master list of the cache, and the matching
+* subscriptions are returned in the order of that list (see CachedSubscription::insertNo).
+*/
+typedef std::vector<CachedSubscription*> CachedSubscriptionV;
+
+struct SubAttrIndex
+{
+  CachedSubscriptionV                         anyAttr;
+  std::map<std::string, CachedSubscriptionV>  byAttr;
+};
+
+struct SubEntityIndex
+{
+  std::map<std::string, SubAttrIndex>  byId;
+  std::map<std::string, SubAttrIndex>  byType;
+  SubAttrIndex                         patterns;
+};
+
+struct SubServicePathIndex
+{
+  std::map<std::string, SubEntityIndex>  exact;
+  std::map<std::string, SubEntityIndex>  wildcard;
+};
+
+static std::map<std::string, SubServicePathIndex>  subCacheIndex;
+static uint64_t                                    subCacheInsertNo = 0;
+
+
+
+/* ****************************************************************************
+*
+* subIndexTenant -
+*/
+static const char* subIndexTenant(const char* tenant)
+{
+  if ((subCacheMultitenant == false) || (tenant == NULL))
+  {
+    return "";
+  }
+
+  return tenant;
+}
+
+
+
+/* ****************************************************************************
+*
+* subIndexEntityIndex - the entity index of a subscription (NULL if not found and not to be created)
+*/
+static SubEntityIndex* subIndexEntityIndex(CachedSubscription* cSubP, bool create)
+{
+  const char*                                           tenant = subIndexTenant(cSubP->tenant);
+  std::map<std::string, SubServicePathIndex>::iterator  tIter  = subCacheIndex.find(tenant);
+
+  if (tIter == subCacheIndex.end())
+  {
+    if (create == false)
+    {
+      return NULL;
+    }
+
+    tIter = subCacheIndex.insert(std::make_pair(std::string(tenant), SubServicePathIndex())).first;
+  }
+
+  const char*                              spath    = cSubP->servicePath;
+  size_t                                   spathLen = strlen(spath);
+  std::map<std::string, SubEntityIndex>*   spMapP;
+  std::string                              key;
+
+  if ((spathLen > 0) && (spath[spathLen - 1] == '#'))
+  {
+    spMapP = &tIter->second.wildcard;
+    key    = std::string(spath, spathLen - 1);
+  }
+  else
+  {
+    spMapP = &tIter->second.exact;
+    key    = spath;
+  }
+
+  if (create == true)
+  {
+    return &(*spMapP)[key];
+  }
+
+  std::map<std::string, SubEntityIndex>::iterator eIter = spMapP->find(key);
+
+  return (eIter == spMapP->end())? NULL : &eIter->second;
+}
+
+
+
+/* ****************************************************************************
+*
+* subIndexAttrIndexes - the attribute indexes a subscription is part of
+*
+* One per EntityInfo of the subscription, possibly with duplicates.
+* A subscription without EntityInfos is not indexed at all - it never matches (see subMatch).
+*/
+static void subIndexAttrIndexes(SubEntityIndex* eIndexP, CachedSubscription* cSubP, std::vector<SubAttrIndex*>* vecP)
+{
+  for (unsigned int ix = 0; ix < cSubP->entityIdInfos.size(); ++ix)
+  {
+    EntityInfo* eiP = cSubP->entityIdInfos[ix];
+
+    if (eiP->isPattern == false)
+    {
+      vecP->push_back(&eIndexP->byId[eiP->entityId]);
+    }
+    else if ((eiP->isTypePattern == false) && (eiP->entityType != ""))
+    {
+      vecP->push_back(&eIndexP->byType[eiP->entityType]);
+    }
+    else
+    {
+      vecP->push_back(&eIndexP->patterns);
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* subIndexVectorRemove -
+*/
+static void subIndexVectorRemove(CachedSubscriptionV* vecP, CachedSubscription* cSubP)
+{
+  for (CachedSubscriptionV::iterator iter = vecP->begin(); iter != vecP->end(); ++iter)
+  {
+    if (*iter == cSubP)
+    {
+      vecP->erase(iter);
+      return;
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* subIndexInsert -
+*/
+static void subIndexInsert(CachedSubscription* cSubP)
+{
+  SubEntityIndex*             eIndexP = subIndexEntityIndex(cSubP, true);
+  std::vector<SubAttrIndex*>  attrIndexV;
+
+  subIndexAttrIndexes(eIndexP, cSubP, &attrIndexV);
+
+  for (unsigned int ix = 0; ix < attrIndexV.size(); ++ix)
+  {
+    SubAttrIndex* aIndexP = attrIndexV[ix];
+
+    if (cSubP->notifyConditionV.size() == 0)
+    {
+      aIndexP->anyAttr.push_back(cSubP);
+      continue;
+    }
+
+    for (unsigned int cIx = 0; cIx < cSubP->notifyConditionV.size(); ++cIx)
+    {
+      aIndexP->byAttr[cSubP->notifyConditionV[cIx]].push_back(cSubP);
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* subIndexRemove -
+*
+* Empty attribute lists are removed, the upper levels of the index are left as is
+* (they're few and are removed when the cache is refreshed)
+*/
+static void subIndexRemove(CachedSubscription* cSubP)
+{
+  SubEntityIndex*             eIndexP = subIndexEntityIndex(cSubP, false);
+  std::vector<SubAttrIndex*>  attrIndexV;
+
+  if (eIndexP == NULL)
+  {
+    return;
+  }
+
+  subIndexAttrIndexes(eIndexP, cSubP, &attrIndexV);
+
+  for (unsigned int ix = 0; ix < attrIndexV.size(); ++ix)
+  {
+    SubAttrIndex* aIndexP = attrIndexV[ix];
+
+    subIndexVectorRemove(&aIndexP->anyAttr, cSubP);
+
+    for (unsigned int cIx = 0; cIx < cSubP->notifyConditionV.size(); ++cIx)
+    {
+      std::map<std::string, CachedSubscriptionV>::iterator iter = aIndexP->byAttr.find(cSubP->notifyConditionV[cIx]);
+
+      if (iter != aIndexP->byAttr.end())
+      {
+        subIndexVectorRemove(&iter->second, cSubP);
+
+        if (iter->second.size() == 0)
+        {
+          aIndexP->byAttr.erase(iter);
+        }
+      }
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* subIndexAttrCandidates -
+*/
+static void subIndexAttrCandidates
+(
+  SubAttrIndex*                    aIndexP,
+  const std::vector<std::string>&  attrV,
+  CachedSubscriptionV*             candidatesP
+)
+{
+  candidatesP->insert(candidatesP->end(), aIndexP->anyAttr.begin(), aIndexP->anyAttr.end());
+
+  for (unsigned int ix = 0; ix < attrV.size(); ++ix)
+  {
+    std::map<std::string, CachedSubscriptionV>::iterator iter = aIndexP->byAttr.find(attrV[ix]);
+
+    if (iter != aIndexP->byAttr.end())
+    {
+      candidatesP->insert(candidatesP->end(), iter->second.begin(), iter->second.end());
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* subIndexEntityCandidates -
+*/
+static void subIndexEntityCandidates
+(
+  std::map<std::string, SubEntityIndex>*  spMapP,
+  const std::string&                      key,
+  const char*                             entityId,
+  const char*                             entityType,
+  const std::vector<std::string>&         attrV,
+  CachedSubscriptionV*                    candidatesP
+)
+{
+  std::map<std::string, SubEntityIndex>::iterator eIter = spMapP->find(key);
+
+  if (eIter == spMapP->end())
+  {
+    return;
+  }
+
+  SubEntityIndex*                                eIndexP = &eIter->second;
+  std::map<std::string, SubAttrIndex>::iterator  iter    = eIndexP->byId.find(entityId);
+
+  if (iter != eIndexP->byId.end())
+  {
+    subIndexAttrCandidates(&iter->second, attrV, candidatesP);
+  }
+
+  if (entityType[0] != 0)
+  {
+    iter = eIndexP->byType.find(entityType);
+
+    if (iter != eIndexP->byType.end())
+    {
+      subIndexAttrCandidates(&iter->second, attrV, candidatesP);
+    }
+  }
+  else
+  {
+    // No type in the update - any subscription by type can match (see EntityInfo::match)
+    for (iter = eIndexP->byType.begin(); iter != eIndexP->byType.end(); ++iter)
+    {
+      subIndexAttrCandidates(&iter->second, attrV, candidatesP);
+    }
+  }
+
+  subIndexAttrCandidates(&eIndexP->patterns, attrV, candidatesP);
+}
+
+
+
+/* ****************************************************************************
+*
+* insertNoLess -
+*/
+static bool insertNoLess(const CachedSubscription* cSub1P, const CachedSubscription* cSub2P)
+{
+  return cSub1P->insertNo < cSub2P->insertNo;
+}
+
+
+
+/* ****************************************************************************
+*
+* subIndexCandidates - all subscriptions that might match, in order of insertion, without duplicates
+*
+* Returns false if the index can't be used (service path "/#" - all subscriptions of the tenant are candidates).
+*/
+static bool subIndexCandidates
+(
+  const char*                      tenant,
+  const char*                      servicePath,
+  const char*                      entityId,
+  const char*                      entityType,
+  const std::vector<std::string>&  attrV,
+  CachedSubscriptionV*             candidatesP
+)
+{
+  if (strcmp(servicePath, "/#") == 0)
+  {
+    return false;
+  }
+
+  std::map<std::string, SubServicePathIndex>::iterator tIter = subCacheIndex.find(subIndexTenant(tenant));
+
+  if (tIter == subCacheIndex.end())
+  {
+    return true;
+  }
+
+  SubServicePathIndex* spIndexP = &tIter->second;
+  std::string          spath    = (servicePath[0] == 0)? "/" : servicePath;
+
+  //
+  // Exact service paths
+  // An empty service path in the update also matches subscriptions with an empty service path
+  //
+  subIndexEntityCandidates(&spIndexP->exact, spath, entityId, entityType, attrV, candidatesP);
+
+  if (servicePath[0] == 0)
+  {
+    subIndexEntityCandidates(&spIndexP->exact, "", entityId, entityType, attrV, candidatesP);
+  }
+
+  //
+  // Wildcard service paths - every prefix of the service path, plus the service path itself with a
+  // trailing slash ("/a/b/#" matches "/a/b")
+  //
+  if (spIndexP->wildcard.size() != 0)
+  {
+    for (unsigned int len = 0; len <= spath.size(); ++len)
+    {
+      subIndexEntityCandidates(&spIndexP->wildcard, spath.substr(0, len), entityId, entityType, attrV, candidatesP);
+    }
+
+    subIndexEntityCandidates(&spIndexP->wildcard, spath + "/", entityId, entityType, attrV, candidatesP);
+  }
+
+  std::sort(candidatesP->begin(), candidatesP->end(), insertNoLess);
+  candidatesP->erase(std::unique(candidatesP->begin(), candidatesP->end()), candidatesP->end());
+
+  return true;
+}
+
+
+
 /* ****************************************************************************
 *
 * subCacheInit -
@@ -244,6 +653,7 @@ void subCacheInit(bool multitenant)
 
   subCache.head   = NULL;
   subCache.tail   = NULL;
+  subCacheIndex.clear();
 
   subCacheStatisticsReset("subCacheInit");
 
@@ -477,23 +887,11 @@ void subCacheMatch
   std::vector<CachedSubscription*>*  subVecP
 )
 {
-  CachedSubscription* cSubP = subCache.head;
+  std::vector<std::string> attrV;
 
-  while (cSubP != NULL)
-  {
-    std::vector<std::string> attrV;
+  attrV.push_back(attr);
 
-    attrV.push_back(attr);
-
-    if (subMatch(cSubP, tenant, servicePath, entityId, entityType, attrV))
-    {
-      subVecP->push_back(cSubP);
-      LM_T(LmtSubCache, ("added subscription '%s': lastNotificationTime: %lu",
-                         cSubP->subscriptionId, cSubP->lastNotificationTime));
-    }
-
-    cSubP = cSubP->next;
-  }
+  subCacheMatch(tenant, servicePath, entityId, entityType, attrV, subVecP);
 }
 
 
@@ -512,6 +910,28 @@ void subCacheMatch
   std::vector<CachedSubscription*>*  subVecP
 )
 {
+  CachedSubscriptionV candidates;
+
+  if (subIndexCandidates(tenant, servicePath, entityId, entityType, attrV, &candidates) == true)
+  {
+    for (unsigned int ix = 0; ix < candidates.size(); ++ix)
+    {
+      CachedSubscription* cSubP = candidates[ix];
+
+      if (subMatch(cSubP, tenant, servicePath, entityId, entityType, attrV))
+      {
+        subVecP->push_back(cSubP);
+        LM_T(LmtSubCache, ("added subscription '%s': lastNotificationTime: %lu",
+                           cSubP->subscriptionId, cSubP->lastNotificationTime));
+      }
+    }
+
+    return;
+  }
+
+  //
+  // The index can't be used - all subscriptions are checked
+  //
   CachedSubscription* cSubP = subCache.head;
 
   while (cSubP != NULL)
@@ -569,6 +989,20 @@ void subCacheItemDestroy(CachedSubscription* cSubP)
 
   cSubP->notifyConditionV.clear();
 
+#ifdef ORIONLD
+  if (cSubP->geoFilterP != NULL)
+  {
+    delete cSubP->geoFilterP;
+    cSubP->geoFilterP = NULL;
+  }
+
+  if (cSubP->qCompiledP != NULL)
+  {
+    qCompiledRelease(cSubP->qCompiledP);
+    cSubP->qCompiledP = NULL;
+  }
+#endif
+
   cSubP->next = NULL;
 }
 
@@ -584,6 +1018,8 @@ void subCacheDestroy(void)
 
   CachedSubscription* cSubP  = subCache.head;
 
+  subCacheIndex.clear();
+
   if (subCache.head == NULL)
   {
     return;
@@ -676,6 +1112,226 @@ void subCacheUpdateStatisticsIncrement(void)
 
 
 
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* subCacheItemQCompile - compile the NGSI-LD 'q' of a cached subscription
+*
+* The attribute names of 'q' are expanded using 'contextP' or, if NULL, the @context of the subscription
+* (cSubP->ldContext), if it is in the context cache.
+*
+* This function is called with the cache semaphore taken, so the @context is never downloaded here.
+* If it isn't in the context cache, the subscription is marked 'qPending' and its 'q' is compiled later, by
+* subCacheQCompilePending, that downloads the @contexts without the cache semaphore taken.
+*
+* The caller must release the contexts used by the thread (orionldContextCacheUsersRelease), unless
+* it is a request thread, where that is done once the request is completed.
+*
+* If 'q' cannot be compiled, qCompiledP is left NULL and the 'q' of the subscription is not evaluated
+* by the subscription cache matcher.
+*/
+void subCacheItemQCompile(CachedSubscription* cSubP, OrionldContext* contextP)
+{
+  char*  title;
+  char*  detail;
+
+  if (contextP == NULL)
+  {
+    if ((contextP = orionldContextCacheLookup(cSubP->ldContext.c_str())) == NULL)
+    {
+      LM_T(LmtSubCache, ("@context '%s' of subscription '%s' not in the context cache - q compiled later",
+                         cSubP->ldContext.c_str(), cSubP->subscriptionId));
+      cSubP->qPending = true;
+      return;
+    }
+  }
+
+  cSubP->qPending   = false;
+  cSubP->qCompiledP = qCompile(contextP, cSubP->expression.q.c_str(), &title, &detail);
+
+  if (cSubP->qCompiledP == NULL)
+  {
+    LM_W(("Unable to compile q '%s' of subscription '%s' (%s: %s)",
+          cSubP->expression.q.c_str(), cSubP->subscriptionId, (title != NULL)? title : "", (detail != NULL)? detail : ""));
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* QCompiledSaved - the compiled 'q' of a subscription, kept during subCacheSync
+*/
+typedef struct QCompiledSaved
+{
+  QCompiled*   qCompiledP;
+  std::string  q;
+  std::string  ldContext;
+} QCompiledSaved;
+
+
+
+/* ****************************************************************************
+*
+* qCompiledSavedV - compiled 'q' of the subscriptions, by tenant and subscription id, during subCacheSync
+*
+* subCacheSync empties and refills the cache from the database. The compiled 'q' of the subscriptions
+* is saved here before emptying the cache, and given back to the refreshed subscriptions by subCacheItemInsert,
+* as long as their 'q' and @context are unchanged - no need to compile them again (nor to look up their @context).
+*
+* Protected by the cache semaphore.
+*/
+static std::map<std::string, QCompiledSaved> qCompiledSavedV;
+
+
+
+/* ****************************************************************************
+*
+* qCompiledSavedKey -
+*/
+static std::string qCompiledSavedKey(CachedSubscription* cSubP)
+{
+  std::string tenant = (cSubP->tenant == NULL)? "" : cSubP->tenant;
+
+  return tenant + "/" + cSubP->subscriptionId;
+}
+
+
+
+/* ****************************************************************************
+*
+* qCompiledSave - move the compiled 'q' of a subscription to qCompiledSavedV
+*/
+static void qCompiledSave(CachedSubscription* cSubP)
+{
+  std::string key = qCompiledSavedKey(cSubP);
+
+  if ((cSubP->qCompiledP == NULL) || (qCompiledSavedV.find(key) != qCompiledSavedV.end()))
+  {
+    return;
+  }
+
+  QCompiledSaved* savedP = &qCompiledSavedV[key];
+
+  savedP->qCompiledP = cSubP->qCompiledP;
+  savedP->q          = cSubP->expression.q;
+  savedP->ldContext  = cSubP->ldContext;
+  cSubP->qCompiledP  = NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* qCompiledRestore - take the saved compiled 'q' of a subscription, if 'q' and @context are unchanged
+*/
+static bool qCompiledRestore(CachedSubscription* cSubP)
+{
+  std::map<std::string, QCompiledSaved>::iterator it = qCompiledSavedV.find(qCompiledSavedKey(cSubP));
+
+  if (it == qCompiledSavedV.end())
+  {
+    return false;
+  }
+
+  if ((it->second.q != cSubP->expression.q) || (it->second.ldContext != cSubP->ldContext))
+  {
+    return false;
+  }
+
+  cSubP->qCompiledP = it->second.qCompiledP;
+  cSubP->qPending   = false;
+  qCompiledSavedV.erase(it);
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* qCompiledSavedRelease - release the saved compiled 'q' that were not given back
+*/
+static void qCompiledSavedRelease(void)
+{
+  for (std::map<std::string, QCompiledSaved>::iterator it = qCompiledSavedV.begin(); it != qCompiledSavedV.end(); ++it)
+  {
+    qCompiledRelease(it->second.qCompiledP);
+  }
+
+  qCompiledSavedV.clear();
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheQCompilePending - compile the 'q' of the subscriptions whose @context wasn't in the context cache
+*
+* The @contexts are downloaded without the cache semaphore taken - a slow or unreachable @context
+* doesn't block the matching of subscriptions meanwhile.
+* Like subCacheItemQCompile, the caller must release the contexts used by the thread (orionldContextCacheUsersRelease).
+*/
+void subCacheQCompilePending(void)
+{
+  std::vector<std::string>                urlV;
+  std::map<std::string, OrionldContext*>  contextV;
+
+  cacheSemTake(__FUNCTION__, "Collecting the @contexts of the subscriptions with q pending");
+
+  for (CachedSubscription* cSubP = subCache.head; cSubP != NULL; cSubP = cSubP->next)
+  {
+    if ((cSubP->qPending == true) && (std::find(urlV.begin(), urlV.end(), cSubP->ldContext) == urlV.end()))
+    {
+      urlV.push_back(cSubP->ldContext);
+    }
+  }
+
+  cacheSemGive(__FUNCTION__, "Collecting the @contexts of the subscriptions with q pending");
+
+  for (unsigned int ix = 0; ix < urlV.size(); ++ix)
+  {
+    OrionldProblemDetails  pd;
+    char*                  url      = kaStrdup(&orionldState.kalloc, urlV[ix].c_str());
+    OrionldContext*        contextP = orionldContextFromUrl(url, &pd);
+
+    if (contextP == NULL)
+    {
+      LM_W(("Unable to get the @context '%s' of subscriptions (%s: %s) - their q will not be evaluated", url, pd.title, pd.detail));
+      continue;
+    }
+
+    contextV[urlV[ix]] = contextP;
+  }
+
+  if (contextV.size() == 0)
+  {
+    return;
+  }
+
+  cacheSemTake(__FUNCTION__, "Compiling the q of subscriptions");
+
+  for (CachedSubscription* cSubP = subCache.head; cSubP != NULL; cSubP = cSubP->next)
+  {
+    if (cSubP->qPending == false)
+    {
+      continue;
+    }
+
+    std::map<std::string, OrionldContext*>::iterator it = contextV.find(cSubP->ldContext);
+
+    if (it != contextV.end())
+    {
+      subCacheItemQCompile(cSubP, it->second);
+    }
+  }
+
+  cacheSemGive(__FUNCTION__, "Compiling the q of subscriptions");
+}
+#endif
+
+
+
 /* ****************************************************************************
 *
 * subCacheItemInsert -
@@ -690,18 +1346,45 @@ void subCacheUpdateStatisticsIncrement(void)
 * calls this function.
 *
 * So, the subscription itself is untouched by this function, is it ONLY inserted
-* in the list (only the 'next' field is modified).
+* in the list and in the index (only the 'next' and 'insertNo' fields are modified).
 *
+* The only exceptions are the geo-filter and the 'q' of NGSI-LD subscriptions (orionld only), that are
+* parsed/compiled here, once, as all inserts pass through this function. If the geo-filter cannot be parsed,
+* geoFilterP is left NULL and the geo-filter is evaluated in the database at notification time.
 */
 void subCacheItemInsert(CachedSubscription* cSubP)
 {
   cSubP->next = NULL;
 
+#ifdef ORIONLD
+  if ((cSubP->geoFilterP == NULL) && (cSubP->expression.georel != "") && (cSubP->expression.geometry != "") && (cSubP->expression.coords != ""))
+  {
+    char* detail = NULL;
+
+    cSubP->geoFilterP = new OrionldGeoFilter();
+
+    if (geoFilterParse(cSubP->expression.geometry, cSubP->expression.coords, cSubP->expression.georel, cSubP->geoFilterP, &detail) == false)
+    {
+      LM_W(("Unable to parse the geo-filter of subscription '%s' (%s) - it will be evaluated in the database", cSubP->subscriptionId, detail));
+      delete cSubP->geoFilterP;
+      cSubP->geoFilterP = NULL;
+    }
+  }
+
+  if ((cSubP->qCompiledP == NULL) && (cSubP->ldContext != "") && (cSubP->expression.q != "") && (qCompiledRestore(cSubP) == false))
+  {
+    subCacheItemQCompile(cSubP, NULL);
+  }
+#endif
+
   LM_T(LmtSubCache, ("inserting sub '%s', lastNotificationTime: %lu",
                      cSubP->subscriptionId, cSubP->lastNotificationTime));
 
   ++subCache.noOfInserts;
 
+  cSubP->insertNo = ++subCacheInsertNo;
+  subIndexInsert(cSubP);
+
   // First insertion?
   if ((subCache.head == NULL) && (subCache.tail == NULL))
   {
@@ -982,6 +1665,7 @@ int subCacheItemRemove(CachedSubscription* cSubP)
       LM_T(LmtSubCache, ("in subCacheItemRemove, REMOVING '%s'", cSubP->subscriptionId));
       ++subCache.noOfRemoves;
 
+      subIndexRemove(cSubP);
       subCacheItemDestroy(cSubP);
       delete cSubP;
 
@@ -1068,6 +1752,10 @@ typedef struct CachedSubSaved
 * 5. Update 'lastNotificationTime/lastFailure/lastSuccess' for each item in savedSubV where non-zero
 * 6. Free the vector created in step 1 - savedSubV
 *
+* The compiled NGSI-LD 'q' of the subscriptions (orionld only) is saved in step 1 as well (qCompiledSave) and
+* given back to the refreshed cache items in step 2, by subCacheItemInsert, if 'q' and @context are unchanged.
+* The @contexts that aren't in the context cache are not downloaded here - see subCacheQCompilePending.
+*
 * NOTE
 *   This function runs in a separate thread and it allocates temporal objects (in savedSubV).
 *   If the broker dies when this function is executing, all these temporal objects will be reported
@@ -1113,6 +1801,9 @@ void subCacheSync(void)
     cssP->lastSuccess          = cSubP->lastSuccess;
 
     savedSubV[cSubP->subscriptionId] = cssP;
+#ifdef ORIONLD
+    qCompiledSave(cSubP);
+#endif
     cSubP = cSubP->next;
   }
 
@@ -1123,6 +1814,9 @@ void subCacheSync(void)
   // 2. Refresh cache (count set to 0)
   //
   subCacheRefresh();
+#ifdef ORIONLD
+  qCompiledSavedRelease();
+#endif
 
 
   //
@@ -1214,7 +1908,22 @@ static void* subCacheRefresherThread(void* vP)
   while (1)
   {
     sleep(subCacheInterval);
+
+#ifdef ORIONLD
+    //
+    // The 'q' of NGSI-LD subscriptions is compiled as the subscriptions are inserted in the cache (subCacheItemQCompile),
+    // and that needs orionldState (allocation buffer and context cache users)
+    //
+    orionldStateInit();
+#endif
+
     subCacheSync();
+
+#ifdef ORIONLD
+    subCacheQCompilePending();
+    orionldContextCacheUsersRelease();
+    kaBufferReset(&orionldState.kalloc, false);
+#endif
   }
 
   return NULL;
@@ -1233,6 +1942,9 @@ void subCacheStart(void)
 
   // Populate subscription cache from database
   subCacheRefresh();
+#ifdef ORIONLD
+  subCacheQCompilePending();
+#endif
 
   ret = pthread_create(&tid, NULL, subCacheRefresherThread, NULL);
 
@@ -39,6 +39,12 @@
 #include "apiTypesV2/SubscriptionExpression.h"
 #include "apiTypesV2/Subscription.h"
 
+#ifdef ORIONLD
+#include "orionld/types/OrionldGeoFilter.h"
+#include "orionld/common/QCompiled.h"
+#include "orionld/context/OrionldContext.h"
+#endif
+
 
 
 /* ****************************************************************************
@@ -111,10 +117,16 @@ struct CachedSubscription
   int64_t                     count;
   RenderFormat                renderFormat;
   SubscriptionExpression      expression;
+#ifdef ORIONLD
+  OrionldGeoFilter*           geoFilterP;   // 'expression' geo-filter, parsed once at insertion - NULL if none or not parsable
+  QCompiled*                  qCompiledP;   // NGSI-LD 'q', compiled at insertion - NULL if none or not compilable
+  bool                        qPending;     // 'q' not compiled yet, as its @context wasn't in the context cache
+#endif
   bool                        blacklist;
   ngsiv2::HttpInfo            httpInfo;
   int64_t                     lastFailure;  // timestamp of last notification failure
   int64_t                     lastSuccess;  // timestamp of last successful notification
+  uint64_t                    insertNo;     // order of insertion in the cache - matches are returned in this order
   struct CachedSubscription*  next;
 };
 
@@ -228,6 +240,24 @@ extern void subCacheItemInsert(CachedSubscription* cSubP);
 
 
 
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* subCacheItemQCompile - 
+*/
+extern void subCacheItemQCompile(CachedSubscription* cSubP, OrionldContext* contextP);
+
+
+
+/* ****************************************************************************
+*
+* subCacheQCompilePending - 
+*/
+extern void subCacheQCompilePending(void);
+#endif
+
+
+
 /* ****************************************************************************
 *
 * subCacheItemLookup - 
@@ -0,0 +1,366 @@
+#ifndef SRC_LIB_COMMON_SYNCQSHARDED_H_
+#define SRC_LIB_COMMON_SYNCQSHARDED_H_
+
+/*
+*
+* Copyright 2020 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Orion dev team
+*/
+
+#include <time.h>
+#include <string>
+#include <queue>
+#include <deque>
+#include <map>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+/* ****************************************************************************
+*
+* SyncQShardCounters -
+*/
+typedef struct SyncQShardCounters
+{
+  size_t              queued;
+  int                 active;
+  unsigned long long  reject;
+  unsigned long long  sentOk;
+  unsigned long long  sentError;
+  unsigned long long  shortCircuited;  // Popped while the circuit was open - not to be sent
+  const char*         circuit;         // "closed", "open" or "halfOpen"
+} SyncQShardCounters;
+
+/* ****************************************************************************
+*
+* template class SyncQSharded<> -
+*
+* A queue with one shard per key (the endpoint of a notification).
+*
+* - The total number of queued elements is limited to 'sz'. Rejections are accounted per shard.
+* - pop() serves the shards round-robin, and only shards with less than 'maxActive' elements being
+*   processed (0: no limit). Each popped element must be followed by a call to done().
+* - A shard whose elements fail 'failureThreshold' times in a row gets its circuit opened for 'openSecs' seconds
+*   (0: no circuit breaking). While open, its elements are popped without limit and flagged as 'circuitOpen',
+*   to be discarded by the caller. After that, one single element is let through (half-open), and its
+*   result closes or reopens the circuit.
+* - A shard with nothing queued nor being processed, and not used for 'idleSecs' seconds, is removed (with its
+*   counters), so that the shards of endpoints that are no longer notified don't pile up.
+*/
+template <typename Data>
+class SyncQSharded
+{
+private:
+    typedef enum CircuitState
+    {
+      CircuitClosed,
+      CircuitOpen,
+      CircuitHalfOpen
+    } CircuitState;
+
+    struct Shard
+    {
+      const std::string*  keyP;            // Points to the key in 'shards'
+      std::queue<Data>    queue;
+      int                 active;
+      bool                inRing;
+      CircuitState        circuit;
+      int                 failures;        // Consecutive failures
+      time_t              openUntil;
+      time_t              lastUsed;
+      unsigned long long  reject;
+      unsigned long long  sentOk;
+      unsigned long long  sentError;
+      unsigned long long  shortCircuited;
+
+      Shard(): keyP(NULL), active(0), inRing(false), circuit(CircuitClosed), failures(0), openUntil(0), lastUsed(0), reject(0), sentOk(0), sentError(0), shortCircuited(0) {}
+    };
+
+    std::map<std::string, Shard> shards;
+    std::deque<Shard*> ring;           // Shards with queued elements, in round-robin order
+    size_t total;
+    mutable boost::mutex mtx;
+    boost::condition_variable servable;
+    size_t max_size;
+    int max_active;
+    int failure_threshold;
+    int open_secs;
+    int idle_secs;
+    time_t last_prune;
+
+    Shard* shardGet(const std::string& key, time_t now);
+    void prune(time_t now);
+
+public:
+    SyncQSharded(size_t sz, int maxActive, int failureThreshold, int openSecs, int idleSecs = 300):
+      total(0), max_size(sz), max_active(maxActive), failure_threshold(failureThreshold), open_secs(openSecs), idle_secs(idleSecs), last_prune(0) {}
+    bool try_push(const std::string& key, Data element);
+    Data pop(std::string* keyP, bool* circuitOpenP);
+    bool done(const std::string& key, int sentOk, int sentError);
+    size_t size() const;
+    void counters(std::map<std::string, SyncQShardCounters>* countersP) const;
+};
+
+/* ****************************************************************************
+*
+* SyncQSharded<Data>::shardGet - lookup a shard, create it if not found (mutex taken by caller)
+*/
+template <typename Data>
+typename SyncQSharded<Data>::Shard* SyncQSharded<Data>::shardGet(const std::string& key, time_t now)
+{
+  typename std::map<std::string, Shard>::iterator it = shards.find(key);
+
+  if (it == shards.end())
+  {
+    it = shards.insert(std::make_pair(key, Shard())).first;
+    it->second.keyP = &it->first;
+  }
+
+  it->second.lastUsed = now;
+
+  return &it->second;
+}
+
+/* ****************************************************************************
+*
+* SyncQSharded<Data>::prune - remove the idle shards (mutex taken by caller)
+*
+* A shard is idle if nothing is queued nor being processed, its circuit isn't open, and it hasn't been used
+* for 'idle_secs' seconds. Idle shards are not in 'ring', so no pointer to them is left behind.
+* The shards are scanned at most once every 'idle_secs' seconds.
+*/
+template <typename Data>
+void SyncQSharded<Data>::prune(time_t now)
+{
+  if (now - last_prune < idle_secs)
+  {
+    return;
+  }
+
+  last_prune = now;
+
+  typename std::map<std::string, Shard>::iterator it = shards.begin();
+
+  while (it != shards.end())
+  {
+    Shard* shardP = &it->second;
+
+    if ((shardP->queue.empty()) && (shardP->active == 0) && (shardP->inRing == false) &&
+        ((shardP->circuit != CircuitOpen) || (now >= shardP->openUntil)) &&
+        (now - shardP->lastUsed >= idle_secs))
+    {
+      shards.erase(it++);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+/* ****************************************************************************
+*
+* SyncQSharded<Data>::try_push -
+*/
+template <typename Data>
+bool SyncQSharded<Data>::try_push(const std::string& key, Data element)
+{
+  boost::mutex::scoped_lock lock(mtx);
+  time_t now    = time(NULL);
+  Shard* shardP = shardGet(key, now);
+
+  if (total >= max_size)
+  {
+    ++shardP->reject;
+    return false;
+  }
+
+  shardP->queue.push(element);
+  ++total;
+
+  if (shardP->inRing == false)
+  {
+    ring.push_back(shardP);
+    shardP->inRing = true;
+  }
+
+  lock.unlock();
+  servable.notify_one();
+  return true;
+}
+
+/* ****************************************************************************
+*
+* SyncQSharded<Data>::pop -
+*/
+template <typename Data>
+Data SyncQSharded<Data>::pop(std::string* keyP, bool* circuitOpenP)
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  for (;;)
+  {
+    time_t now = time(NULL);
+
+    for (size_t ix = 0; ix < ring.size(); ++ix)
+    {
+      Shard* shardP = ring.front();
+      int    limit  = (shardP->circuit == CircuitHalfOpen)? 1 : max_active;
+
+      ring.pop_front();
+
+      if ((shardP->circuit == CircuitOpen) && (now >= shardP->openUntil))
+      {
+        shardP->circuit = CircuitHalfOpen;
+        limit           = 1;
+      }
+
+      if ((shardP->circuit != CircuitOpen) && (limit > 0) && (shardP->active >= limit))
+      {
+        ring.push_back(shardP);
+        continue;
+      }
+
+      Data element = shardP->queue.front();
+      shardP->queue.pop();
+      --total;
+
+      if (shardP->queue.empty())
+      {
+        shardP->inRing = false;
+      }
+      else
+      {
+        ring.push_back(shardP);
+      }
+
+      *circuitOpenP = (shardP->circuit == CircuitOpen);
+      if (*circuitOpenP)
+      {
+        ++shardP->shortCircuited;
+      }
+      else
+      {
+        ++shardP->active;
+      }
+
+      shardP->lastUsed = now;
+
+      *keyP = *shardP->keyP;
+      return element;
+    }
+
+    servable.wait(lock);
+  }
+}
+
+/* ****************************************************************************
+*
+* SyncQSharded<Data>::done -
+*
+* To be called when the processing of a popped element (not 'circuitOpen') is finished.
+* sentOk/sentError: number of notifications of the element that succeeded/failed.
+*
+* Returns true if the circuit of the shard was opened
+*/
+template <typename Data>
+bool SyncQSharded<Data>::done(const std::string& key, int sentOk, int sentError)
+{
+  boost::mutex::scoped_lock lock(mtx);
+  time_t now    = time(NULL);
+  Shard* shardP = shardGet(key, now);
+  bool   opened = false;
+
+  --shardP->active;
+  shardP->sentOk    += sentOk;
+  shardP->sentError += sentError;
+
+  if (sentError == 0)
+  {
+    shardP->failures = 0;
+    shardP->circuit  = CircuitClosed;
+  }
+  else
+  {
+    //
+    // 'failures' counts consecutive failures - a success breaks the sequence.
+    // The order of the notifications of the element is unknown, so its failures are assumed to be the last ones.
+    //
+    shardP->failures = (sentOk > 0)? sentError : shardP->failures + sentError;
+
+    if ((failure_threshold > 0) && ((shardP->circuit == CircuitHalfOpen) || (shardP->failures >= failure_threshold)))
+    {
+      opened            = (shardP->circuit != CircuitOpen);
+      shardP->circuit   = CircuitOpen;
+      shardP->openUntil = now + open_secs;
+    }
+  }
+
+  bool wakeUp = shardP->inRing;
+
+  prune(now);
+  lock.unlock();
+
+  if (wakeUp)
+  {
+    servable.notify_one();
+  }
+
+  return opened;
+}
+
+/* ****************************************************************************
+*
+* SyncQSharded<Data>::size -
+*/
+template <typename Data>
+size_t SyncQSharded<Data>::size() const
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  return total;
+}
+
+/* ****************************************************************************
+*
+* SyncQSharded<Data>::counters -
+*/
+template <typename Data>
+void SyncQSharded<Data>::counters(std::map<std::string, SyncQShardCounters>* countersP) const
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  for (typename std::map<std::string, Shard>::const_iterator it = shards.begin(); it != shards.end(); ++it)
+  {
+    SyncQShardCounters* cP = &(*countersP)[it->first];
+
+    cP->queued         = it->second.queue.size();
+    cP->active         = it->second.active;
+    cP->reject         = it->second.reject;
+    cP->sentOk         = it->second.sentOk;
+    cP->sentError      = it->second.sentError;
+    cP->shortCircuited = it->second.shortCircuited;
+    cP->circuit        = (it->second.circuit == CircuitClosed)? "closed" : (it->second.circuit == CircuitOpen)? "open" : "halfOpen";
+  }
+}
+
+#endif  // SRC_LIB_COMMON_SYNCQSHARDED_H_
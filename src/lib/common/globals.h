@@ -135,6 +135,7 @@
 #define OPT_NO_OVERWRITE    "noOverwrite"
 #define OPT_UPDATE          "update"
 #define OPT_REPLACE         "replace"
+#define OPT_ESTIMATED_COUNT "estimatedCount"
 #endif
 
 
@@ -25,7 +25,8 @@
 #include <semaphore.h>
 #include <errno.h>
 #include <time.h>
-#include <map>  // for curl contexts
+#include <map>     // for curl contexts
+#include <vector>  // for curl contexts
 
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
@@ -552,7 +553,26 @@ const char* timeStatSemGet(void)
 
 /* ****************************************************************************
 *  curl context
+*
+* In "persistent" notification mode, curl easy handles are kept after use, in a list of idle handles per
+* target host, and all of them share one connection cache (and DNS cache and TLS sessions) via a CURLSH.
+* Any number of threads can have transfers ongoing to the same host at the same time, each with its own easy
+* handle, and the connections to the host are reused by all of them.
+*
+* curlMaxPerHost limits the number of simultaneous transfers to one host (0: no limit).
+* Threads exceeding the limit wait (are "queued") until a transfer to the host finishes.
 */
+typedef struct CurlHost
+{
+  std::vector<CURL*>  idle;
+  int                 inFlight;
+  int                 queued;
+  unsigned long long  transfers;
+  pthread_cond_t      cond;
+
+  CurlHost(): inFlight(0), queued(0), transfers(0) { pthread_cond_init(&cond, NULL); }
+} CurlHost;
+
 
 
 //
@@ -560,12 +580,15 @@ const char* timeStatSemGet(void)
 //
 // FIXME: contexts_mutex_errors and endpoint_mutexes_errors are not yet used, see issue #2145
 //
-static std::map<std::string, struct curl_context>  contexts;
+static std::map<std::string, CurlHost>             contexts;
 static pthread_mutex_t                             contexts_mutex          = PTHREAD_MUTEX_INITIALIZER;
 static bool                                        contexts_mutex_taken    = false;
 static int                                         contexts_mutex_errors   = 0;
 static int                                         endpoint_mutexes_taken  = 0;
 static int                                         endpoint_mutexes_errors = 0;
+static CURLSH*                                     curlShare               = NULL;
+static pthread_mutex_t                             curlShareMutex[CURL_LOCK_DATA_LAST];
+int                                                curlMaxPerHost          = 0;
 
 
 /* ****************************************************************************
@@ -594,21 +617,85 @@ const char* connectionSubContextSemGet(void)
 static struct timespec accCCMutexTime = { 0, 0 };
 
 
+
+/* ****************************************************************************
+*
+* curlShareLock - 
+*/
+static void curlShareLock(CURL* curl, curl_lock_data data, curl_lock_access access, void* userptr)
+{
+  pthread_mutex_lock(&curlShareMutex[data]);
+}
+
+
+
+/* ****************************************************************************
+*
+* curlShareUnlock - 
+*/
+static void curlShareUnlock(CURL* curl, curl_lock_data data, void* userptr)
+{
+  pthread_mutex_unlock(&curlShareMutex[data]);
+}
+
+
+
+/* ****************************************************************************
+*
+* curlShareInit - 
+*
+* Called with contexts_mutex taken.
+* Without a share (if curl_share_init fails), the easy handles simply use their own connection caches.
+*/
+static void curlShareInit(void)
+{
+  for (int ix = 0; ix < CURL_LOCK_DATA_LAST; ix++)
+  {
+    pthread_mutex_init(&curlShareMutex[ix], NULL);
+  }
+
+  curlShare = curl_share_init();
+  if (curlShare == NULL)
+  {
+    LM_E(("Runtime Error (curl_share_init)"));
+    return;
+  }
+
+  curl_share_setopt(curlShare, CURLSHOPT_LOCKFUNC,   curlShareLock);
+  curl_share_setopt(curlShare, CURLSHOPT_UNLOCKFUNC, curlShareUnlock);
+  curl_share_setopt(curlShare, CURLSHOPT_SHARE,      CURL_LOCK_DATA_DNS);
+  curl_share_setopt(curlShare, CURLSHOPT_SHARE,      CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+  curl_share_setopt(curlShare, CURLSHOPT_SHARE,      CURL_LOCK_DATA_CONNECT);
+#endif
+}
+
+
+
 /* ****************************************************************************
 *
 * curl_context_cleanup - 
 */
 void curl_context_cleanup(void)
 {
-  for (std::map<std::string, struct curl_context>::iterator it = contexts.begin(); it != contexts.end(); ++it)
+  for (std::map<std::string, CurlHost>::iterator it = contexts.begin(); it != contexts.end(); ++it)
   {
-    curl_easy_reset(it->second.curl);
-    curl_easy_cleanup(it->second.curl);
-    it->second.curl = NULL;
-    release_curl_context(&it->second, true);
+    for (unsigned int ix = 0; ix < it->second.idle.size(); ++ix)
+    {
+      curl_easy_cleanup(it->second.idle[ix]);
+    }
+
+    pthread_cond_destroy(&it->second.cond);
   }
 
   contexts.clear();
+
+  if (curlShare != NULL)
+  {
+    curl_share_cleanup(curlShare);
+    curlShare = NULL;
+  }
+
   curl_global_cleanup();
 
   endpoint_mutexes_taken = 0;
@@ -620,11 +707,18 @@ void curl_context_cleanup(void)
 /* ****************************************************************************
 *
 * get_curl_context_reuse -
+*
+* If the host is at its limit (curlMaxPerHost), the calling thread waits for a transfer to the host to finish,
+* at most 'waitMs' milliseconds (forever if 'waitMs' is negative). EBUSY is returned if the wait timed out.
 */
-static int get_curl_context_reuse(const std::string& key, struct curl_context* pcc)
+static int get_curl_context_reuse(const std::string& key, struct curl_context* pcc, int waitMs)
 {
-  pcc->curl   = NULL;
-  pcc->pmutex = NULL;
+  struct timespec  startTime;
+  struct timespec  endTime;
+  struct timespec  diffTime;
+
+  pcc->curl  = NULL;
+  pcc->hostP = NULL;
 
   int s = pthread_mutex_lock(&contexts_mutex);
 
@@ -636,48 +730,83 @@ static int get_curl_context_reuse(const std::string& key, struct curl_context* p
   }
   contexts_mutex_taken = true;
 
-  std::map<std::string, struct curl_context>::iterator it;
-  it = contexts.find(key);
-  if (it == contexts.end())
+  if (curlShare == NULL)
   {
-    // not found, create it
-    pcc->curl = curl_easy_init();
-    if (pcc->curl != NULL)
+    curlShareInit();
+  }
+
+  CurlHost* hostP = &contexts[key];  // created if not found
+
+  if ((curlMaxPerHost > 0) && (hostP->inFlight >= curlMaxPerHost))
+  {
+    if (semWaitStatistics)
+    {
+      clock_gettime(CLOCK_REALTIME, &startTime);
+    }
+
+    struct timespec deadline;
+
+    if (waitMs > 0)
     {
-      pthread_mutex_t* pm = (pthread_mutex_t *) malloc(sizeof(*pm));
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec  += waitMs / 1000;
+      deadline.tv_nsec += (waitMs % 1000) * 1000000;
 
-      if (pm == NULL)
+      if (deadline.tv_nsec >= 1000000000)
       {
-        pthread_mutex_unlock(&contexts_mutex);
-        ++contexts_mutex_errors;
-        contexts_mutex_taken = false;
-        LM_E(("Runtime Error (malloc)"));
-        return -1;
+        deadline.tv_sec  += 1;
+        deadline.tv_nsec -= 1000000000;
       }
+    }
 
-      int s = pthread_mutex_init(pm, NULL);
-      if (s != 0)
+    ++hostP->queued;
+    while ((hostP->inFlight >= curlMaxPerHost) && (waitMs != 0))
+    {
+      if (waitMs < 0)
       {
-        pthread_mutex_unlock(&contexts_mutex);
-        contexts_mutex_taken = false;
-        ++contexts_mutex_errors;
-        LM_E(("Runtime Error (pthread_mutex_init)"));
-        free(pm);
-        return s;
+        pthread_cond_wait(&hostP->cond, &contexts_mutex);
       }
-      pcc->pmutex   = pm;
-      contexts[key] = *pcc;
+      else if (pthread_cond_timedwait(&hostP->cond, &contexts_mutex, &deadline) == ETIMEDOUT)
+      {
+        break;
+      }
+    }
+    --hostP->queued;
+
+    if (semWaitStatistics)
+    {
+      clock_gettime(CLOCK_REALTIME, &endTime);
+      clock_difftime(&endTime, &startTime, &diffTime);
+      clock_addtime(&accCCMutexTime, &diffTime);
     }
-    else  // curl_easy returned null
+
+    if (hostP->inFlight >= curlMaxPerHost)
     {
-      pcc->pmutex = NULL;    // unnecessary but clearer
+      contexts_mutex_taken = false;
+      pthread_mutex_unlock(&contexts_mutex);
+      return EBUSY;
     }
   }
-  else // previous context found
+
+  if (hostP->idle.size() > 0)
+  {
+    pcc->curl = hostP->idle.back();
+    hostP->idle.pop_back();
+  }
+  else
+  {
+    pcc->curl = curl_easy_init();
+  }
+
+  if (pcc->curl != NULL)
   {
-    *pcc = it->second;
+    pcc->hostP = hostP;
+    ++hostP->inFlight;
+    ++hostP->transfers;
+    ++endpoint_mutexes_taken;
   }
 
+  contexts_mutex_taken = false;
   s = pthread_mutex_unlock(&contexts_mutex);
   if (s != 0)
   {
@@ -686,54 +815,16 @@ static int get_curl_context_reuse(const std::string& key, struct curl_context* p
     return s;
   }
 
-  contexts_mutex_taken = false;
-
-  // lock the mutex, if everything was right
-  // and cc is not {NULL, NULl}
-  if (pcc->pmutex != NULL)
+  if (pcc->curl == NULL)
   {
-    struct timespec  startTime;
-    struct timespec  endTime;
-    struct timespec  diffTime;
-
-    if (semWaitStatistics)
-    {
-      clock_gettime(CLOCK_REALTIME, &startTime);
-    }
-
-    s = pthread_mutex_lock(pcc->pmutex);
-    if (s != 0)
-    {
-      ++endpoint_mutexes_errors;
-      LM_E(("Runtime Error (pthread_mutex_lock)"));
-      return s;
-    }
-    ++endpoint_mutexes_taken;
-    
-    if (semWaitStatistics)
-    {
-      clock_gettime(CLOCK_REALTIME, &endTime);
-      clock_difftime(&endTime, &startTime, &diffTime);
-
-      int s = pthread_mutex_lock(&contexts_mutex);
-      if (s != 0)
-      {
-        ++contexts_mutex_errors;
-        LM_E(("Runtime Error (pthread_mutex_lock)"));
-        return s;
-      }
-      contexts_mutex_taken = true;
+    LM_E(("Runtime Error (curl_easy_init)"));
+    return -1;
+  }
 
-      clock_addtime(&accCCMutexTime, &diffTime);
-      s = pthread_mutex_unlock(&contexts_mutex);
-      if (s != 0)
-      {
-        ++contexts_mutex_errors;
-        LM_E(("Runtime Error (pthread_mutex_unlock)"));
-        return s;
-      }
-      contexts_mutex_taken = false;
-    }
+  // curl_easy_reset (on release) clears all options, the share included
+  if (curlShare != NULL)
+  {
+    curl_easy_setopt(pcc->curl, CURLOPT_SHARE, curlShare);
   }
 
   return 0;
@@ -745,8 +836,8 @@ static int get_curl_context_reuse(const std::string& key, struct curl_context* p
 */
 static int get_curl_context_new(const std::string& key, struct curl_context* pcc)
 {
-  pcc->curl   = NULL;
-  pcc->pmutex = NULL;
+  pcc->curl  = NULL;
+  pcc->hostP = NULL;
 
   pcc->curl = curl_easy_init();
 
@@ -769,7 +860,27 @@ int get_curl_context(const std::string& key, struct curl_context* pcc)
   if (strcmp(notificationMode, "persistent") == 0)
   {
     LM_T(LmtCurlContext, ("using persistent curl_contexts"));
-    return get_curl_context_reuse(key, pcc);
+    return get_curl_context_reuse(key, pcc, -1);
+  }
+
+  return get_curl_context_new(key, pcc);
+}
+
+
+
+/* ****************************************************************************
+*
+* get_curl_context_try -
+*
+* Like get_curl_context, but waiting at most 'waitMs' milliseconds (0: not at all) if the host is at its
+* limit (curlMaxPerHost). Returns EBUSY (with pcc->curl == NULL) if no transfer to the host finished in time.
+* For callers that can't block, e.g. an event loop driving other transfers (orionldRequestSendMulti).
+*/
+int get_curl_context_try(const std::string& key, struct curl_context* pcc, int waitMs)
+{
+  if (strcmp(notificationMode, "persistent") == 0)
+  {
+    return get_curl_context_reuse(key, pcc, (waitMs < 0)? 0 : waitMs);
   }
 
   return get_curl_context_new(key, pcc);
@@ -781,36 +892,50 @@ int get_curl_context(const std::string& key, struct curl_context* pcc)
 /* ****************************************************************************
 *
 * release_curl_context_reuse -
+*
+* The easy handle goes back to the idle handles of the host (or is destroyed, if 'final').
 */
 static int release_curl_context_reuse(struct curl_context *pcc, bool final)
 {
-  // Reset context if not an empty context
-  if (pcc->curl != NULL)
+  if ((pcc->curl == NULL) || (pcc->hostP == NULL))
   {
-    curl_easy_reset(pcc->curl);
-    pcc->curl = NULL; // It will remain in global map
+    return 0;
   }
 
-  // Unlock the mutex if not an empty context
-  if (pcc->pmutex != NULL)
+  curl_easy_reset(pcc->curl);
+
+  if (final)
   {
-    int s = pthread_mutex_unlock(pcc->pmutex);
-    if (final)
-    {
-      free(pcc->pmutex);
-    }
+    curl_easy_cleanup(pcc->curl);
+    pcc->curl = NULL;
+  }
 
-    if (s != 0)
-    {
-      LM_E(("Runtime Error (pthread_mutex_unlock)"));
-      ++endpoint_mutexes_errors;
-      return s;
-    }
-    --endpoint_mutexes_taken;
+  int s = pthread_mutex_lock(&contexts_mutex);
+  if (s != 0)
+  {
+    LM_E(("Runtime Error (pthread_mutex_lock)"));
+    ++endpoint_mutexes_errors;
+    return s;
+  }
 
-    pcc->pmutex = NULL; // It will remain in global map
+  if (pcc->curl != NULL)
+  {
+    pcc->hostP->idle.push_back(pcc->curl);
+  }
+
+  --pcc->hostP->inFlight;
+  --endpoint_mutexes_taken;
+
+  if (pcc->hostP->queued > 0)
+  {
+    pthread_cond_signal(&pcc->hostP->cond);
   }
 
+  pthread_mutex_unlock(&contexts_mutex);
+
+  pcc->curl  = NULL;
+  pcc->hostP = NULL;
+
   return 0;
 }
 
@@ -844,6 +969,27 @@ int release_curl_context(struct curl_context *pcc, bool final)
   return release_curl_context_new(pcc, final);
 }
 
+/* ****************************************************************************
+*
+* curlHostCountersGet -
+*/
+void curlHostCountersGet(std::map<std::string, CurlHostCounters>* countersP)
+{
+  pthread_mutex_lock(&contexts_mutex);
+
+  for (std::map<std::string, CurlHost>::iterator it = contexts.begin(); it != contexts.end(); ++it)
+  {
+    CurlHostCounters* cP = &(*countersP)[it->first];
+
+    cP->inFlight  = it->second.inFlight;
+    cP->queued    = it->second.queued;
+    cP->idle      = it->second.idle.size();
+    cP->transfers = it->second.transfers;
+  }
+
+  pthread_mutex_unlock(&contexts_mutex);
+}
+
 /* ****************************************************************************
 *
 * mutexTimeCCReset -
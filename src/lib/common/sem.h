@@ -30,6 +30,7 @@
 
 // curl context includes
 #include <string>
+#include <map>
 
 #include <pthread.h>
 #include <curl/curl.h>
@@ -145,11 +146,33 @@ extern void semTimeTimeStatReset(void);
 struct curl_context
 {
   CURL *curl;
-  pthread_mutex_t *pmutex;
+  struct CurlHost *hostP;  // Host the context belongs to ("persistent" notification mode only)
 };
 
 
 
+/* ****************************************************************************
+*
+* CurlHostCounters - counters of the curl contexts of a host ("persistent" notification mode only)
+*/
+typedef struct CurlHostCounters
+{
+  int                 inFlight;   // Ongoing transfers
+  int                 queued;     // Threads waiting for the number of ongoing transfers to go below curlMaxPerHost
+  int                 idle;       // Idle curl handles
+  unsigned long long  transfers;  // Accumulated number of transfers
+} CurlHostCounters;
+
+
+
+/* ****************************************************************************
+*
+* curlMaxPerHost - max number of simultaneous transfers per host (0: no limit)
+*/
+extern int curlMaxPerHost;
+
+
+
 /* ****************************************************************************
 *
 * curl_context_cleanup - 
@@ -166,6 +189,14 @@ extern int get_curl_context(const std::string& key, struct curl_context *pcc);
 
 
 
+/* ****************************************************************************
+*
+* get_curl_context_try - get_curl_context without waiting (more than 'waitMs') for the per-host limit
+*/
+extern int get_curl_context_try(const std::string& key, struct curl_context *pcc, int waitMs);
+
+
+
 /* ****************************************************************************
 *
 * release_curl_context -
@@ -174,6 +205,14 @@ extern int release_curl_context(struct curl_context *pcc, bool final = false);
 
 
 
+/* ****************************************************************************
+*
+* curlHostCountersGet -
+*/
+extern void curlHostCountersGet(std::map<std::string, CurlHostCounters>* countersP);
+
+
+
 /* ****************************************************************************
 *
 * mutexTimeCCGet -
@@ -48,6 +48,8 @@
 
 #undef NDEBUG
 #include <assert.h>
+#include <pthread.h>            /* pthread_create                            */
+#include <sys/uio.h>            /* writev, struct iovec                      */
 #include <string>
 
 #include "logMsg/time.h"
@@ -1925,7 +1927,7 @@ LmStatus lmAux(char* a)
 char* lmTextGet(const char* format, ...)
 {
   va_list  args;
-  char*    vmsg = (char*) calloc(1, LM_LINE_MAX);
+  char*    vmsg = (char*) malloc(LM_LINE_MAX);  /* No need to zero it - vsnprintf terminates the string */
 
   /* "Parse" the varible arguments */
   va_start(args, format);
@@ -2262,9 +2264,435 @@ LmStatus lmPathRegister
 
 /* ****************************************************************************
 *
-* lmOut -
+* Asynchronous logging -
+*
+* Once lmAsyncStart() has been called, lmOut doesn't write the log lines itself.
+* Instead, each line is formatted by the logging thread directly into a slot of a ring buffer,
+* and a dedicated writer thread (lmAsyncWriter) drains the ring, writing the lines
+* to their file descriptors in batches, with writev().
+*
+* The ring is a bounded multi-producer/single-consumer queue that needs no lock:
+*   - a producer reserves a slot by advancing lmRingHead (compare-and-swap), formats
+*     its line into the slot and publishes it by setting the sequence number of the slot
+*   - the writer thread consumes the slots in order, and gives them back to the producers
+*     by setting their sequence numbers one lap ahead
+*
+* The log semaphore is only taken by the writer thread (and by the synchronous paths), so
+* the logging threads no longer serialize on it.
+*
+* If the ring is full, the line is dropped and counted in lmAsyncDropped - the logging thread never blocks.
+* The writer thread reports the number of dropped lines in the log.
+*
+* When the ring is empty, the writer thread sleeps on a condition variable (lmAsyncWait). A producer only takes
+* the mutex to wake it up if lmAsyncSleeping is set (lmAsyncWakeup), so, while the writer thread is busy, logging
+* costs no system call at all. Threads waiting for the ring to be drained (lmAsyncFlush) sleep on a second
+* condition variable, signaled by the writer thread once it has written the lines.
+*
+* Fatal errors (LM_X) and lines that don't fit in a slot are written synchronously, after
+* waiting for the ring to be drained (lmAsyncFlush), so that the order of the lines is kept.
 */
-LmStatus lmOut
+#define LM_ASYNC_LINE_MAX   2048
+#define LM_ASYNC_BATCH_MAX  256
+
+typedef struct LmRingSlot
+{
+  unsigned long long  seq;
+  int                 fdIx;
+  int                 len;
+  char                line[LM_ASYNC_LINE_MAX];
+} LmRingSlot;
+
+static LmRingSlot*         lmRing          = NULL;
+static unsigned long long  lmRingMask      = 0;
+static unsigned long long  lmRingHead      = 0;   /* Next slot to be reserved by a producer              */
+static unsigned long long  lmRingTail      = 0;   /* Next slot to be written by the writer thread        */
+static unsigned long long  lmAsyncDropped  = 0;   /* Lines dropped as the ring was full                  */
+static bool                lmAsyncOn       = false;
+static bool                lmAsyncSleeping = false;   /* The writer thread waits for lines (lmAsyncWakeupCond) */
+static int                 lmAsyncFlushers = 0;       /* Threads waiting in lmAsyncFlush (lmAsyncDrainedCond) */
+static pthread_t           lmAsyncThread;
+static pthread_mutex_t     lmAsyncMutex       = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t      lmAsyncWakeupCond  = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t      lmAsyncDrainedCond = PTHREAD_COND_INITIALIZER;
+
+
+
+/* ****************************************************************************
+*
+* lmRingReserve - reserve the next free slot of the ring, NULL if the ring is full
+*/
+static LmRingSlot* lmRingReserve(unsigned long long* posP)
+{
+  unsigned long long pos = __atomic_load_n(&lmRingHead, __ATOMIC_RELAXED);
+
+  while (true)
+  {
+    LmRingSlot*         slotP = &lmRing[pos & lmRingMask];
+    unsigned long long  seq   = __atomic_load_n(&slotP->seq, __ATOMIC_ACQUIRE);
+    long long           diff  = (long long) (seq - pos);
+
+    if (diff == 0)
+    {
+      if (__atomic_compare_exchange_n(&lmRingHead, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      {
+        *posP = pos;
+        return slotP;
+      }
+      /* CAS failure updated 'pos' - try again */
+    }
+    else if (diff < 0)
+    {
+      return NULL;  /* The writer thread hasn't yet freed the slot - the ring is full */
+    }
+    else
+    {
+      pos = __atomic_load_n(&lmRingHead, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncWakeup - wake the writer thread up, if it's sleeping
+*
+* Called by the producers after publishing their lines (or dropping them).
+* The fence orders the publication of the slot before the read of lmAsyncSleeping - the writer thread
+* sets lmAsyncSleeping before checking the ring a last time (see lmAsyncWait), so either the writer
+* thread sees the new line, or the producer sees that the writer thread is sleeping.
+*/
+static void lmAsyncWakeup(void)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n(&lmAsyncSleeping, __ATOMIC_SEQ_CST) == true)
+  {
+    pthread_mutex_lock(&lmAsyncMutex);
+    pthread_cond_signal(&lmAsyncWakeupCond);
+    pthread_mutex_unlock(&lmAsyncMutex);
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncWait - the writer thread waits for the slot 'tail' to be published, or for lines to be dropped
+*/
+static void lmAsyncWait(unsigned long long tail, unsigned long long droppedReported)
+{
+  LmRingSlot* slotP = &lmRing[tail & lmRingMask];
+
+  pthread_mutex_lock(&lmAsyncMutex);
+  __atomic_store_n(&lmAsyncSleeping, true, __ATOMIC_SEQ_CST);
+
+  /* Check again, now that lmAsyncSleeping is visible to the producers */
+  while ((__atomic_load_n(&slotP->seq, __ATOMIC_SEQ_CST) != tail + 1) &&
+         (__atomic_load_n(&lmAsyncDropped, __ATOMIC_SEQ_CST) == droppedReported))
+  {
+    pthread_cond_wait(&lmAsyncWakeupCond, &lmAsyncMutex);
+  }
+
+  __atomic_store_n(&lmAsyncSleeping, false, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&lmAsyncMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncBatchWrite - write a batch of consumed slots
+*
+* Consecutive lines for the same file descriptor are written with a single writev().
+* Called by the writer thread, with the log semaphore taken.
+*/
+static void lmAsyncBatchWrite(LmRingSlot** slotV, int slots)
+{
+  struct iovec  iov[LM_ASYNC_BATCH_MAX];
+  int           ix = 0;
+
+  while (ix < slots)
+  {
+    int   fdIx  = slotV[ix]->fdIx;
+    Fds*  fdP   = &fds[fdIx];
+    int   lines = 0;
+    int   sz    = 0;
+
+    while ((ix + lines < slots) && (slotV[ix + lines]->fdIx == fdIx))
+    {
+      iov[lines].iov_base  = slotV[ix + lines]->line;
+      iov[lines].iov_len   = slotV[ix + lines]->len;
+      sz                  += slotV[ix + lines]->len;
+      ++lines;
+    }
+
+    if (fdP->state == Occupied)
+    {
+      if (fdP->write != NULL)
+      {
+        for (int lIx = 0; lIx < lines; lIx++)
+        {
+          fdP->write((char*) iov[lIx].iov_base);
+        }
+      }
+      else
+      {
+        lseek(fdP->fd, 0, SEEK_END);
+
+        int nb = writev(fdP->fd, iov, lines);
+
+        if (nb == -1)
+        {
+          printf("LOG error: writev(%d): %s\n", fdP->fd, strerror(errno));
+        }
+        else if (nb != sz)
+        {
+          printf("LOG error: written %d bytes only (wanted %d)\n", nb, sz);
+        }
+      }
+    }
+
+    ix += lines;
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncDroppedReport - log the number of lines dropped since last report
+*
+* Called by the writer thread, with the log semaphore taken.
+*/
+static void lmAsyncDroppedReport(unsigned long long dropped)
+{
+  char line[256];
+
+  snprintf(line, sizeof(line), "LM: %llu log lines lost (log queue full)\n", dropped);
+
+  int sz = strlen(line);
+
+  for (int i = 0; i < FDS_MAX; i++)
+  {
+    if ((fds[i].state != Occupied) || (fds[i].write != NULL))
+    {
+      continue;
+    }
+
+    lseek(fds[i].fd, 0, SEEK_END);
+    if (write(fds[i].fd, line, sz) != sz)
+    {
+      printf("LOG error: write(%d): %s\n", fds[i].fd, strerror(errno));
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncWriter - the writer thread
+*/
+static void* lmAsyncWriter(void*)
+{
+  LmRingSlot*         slotV[LM_ASYNC_BATCH_MAX];
+  unsigned long long  droppedReported = 0;
+
+  while (true)
+  {
+    unsigned long long  tail  = lmRingTail;
+    int                 slots = 0;
+
+    while (slots < LM_ASYNC_BATCH_MAX)
+    {
+      LmRingSlot* slotP = &lmRing[(tail + slots) & lmRingMask];
+
+      if (__atomic_load_n(&slotP->seq, __ATOMIC_ACQUIRE) != tail + slots + 1)
+      {
+        break;
+      }
+
+      slotV[slots++] = slotP;
+    }
+
+    unsigned long long dropped = __atomic_load_n(&lmAsyncDropped, __ATOMIC_RELAXED);
+
+    if ((slots == 0) && (dropped == droppedReported))
+    {
+      lmAsyncWait(tail, droppedReported);
+      continue;
+    }
+
+    semTake();
+
+    if (slots > 0)
+    {
+      lmAsyncBatchWrite(slotV, slots);
+    }
+
+    if (dropped != droppedReported)
+    {
+      lmAsyncDroppedReport(dropped - droppedReported);
+      droppedReported = dropped;
+    }
+
+    if ((doClear == true) && (logLines >= atLines))
+    {
+      for (int i = 0; i < FDS_MAX; i++)
+      {
+        if ((fds[i].state == Occupied) && (fds[i].type == Fichero))
+        {
+          lmClear(i, keepLines, lastLines);
+        }
+      }
+    }
+
+    semGive();
+
+    /* Give the slots back to the producers, one lap ahead */
+    for (int ix = 0; ix < slots; ix++)
+    {
+      __atomic_store_n(&slotV[ix]->seq, tail + ix + lmRingMask + 1, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&lmRingTail, tail + slots, __ATOMIC_SEQ_CST);
+
+    /* Same as lmAsyncWakeup, for the threads waiting in lmAsyncFlush */
+    if (__atomic_load_n(&lmAsyncFlushers, __ATOMIC_SEQ_CST) > 0)
+    {
+      pthread_mutex_lock(&lmAsyncMutex);
+      pthread_cond_broadcast(&lmAsyncDrainedCond);
+      pthread_mutex_unlock(&lmAsyncMutex);
+    }
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncFlush - wait for the writer thread to write all lines queued so far
+*
+* Waits at most one second - the writer thread might be stuck on a slow file descriptor.
+*/
+void lmAsyncFlush(void)
+{
+  if (lmAsyncOn == false)
+  {
+    return;
+  }
+
+  unsigned long long  head = __atomic_load_n(&lmRingHead, __ATOMIC_ACQUIRE);
+  struct timespec     deadline;
+
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += 1;
+
+  pthread_mutex_lock(&lmAsyncMutex);
+  __atomic_add_fetch(&lmAsyncFlushers, 1, __ATOMIC_SEQ_CST);
+
+  while (__atomic_load_n(&lmRingTail, __ATOMIC_SEQ_CST) < head)
+  {
+    if (pthread_cond_timedwait(&lmAsyncDrainedCond, &lmAsyncMutex, &deadline) == ETIMEDOUT)
+    {
+      break;
+    }
+  }
+
+  __atomic_sub_fetch(&lmAsyncFlushers, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&lmAsyncMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncFlushAtExit -
+*/
+static void lmAsyncFlushAtExit(void)
+{
+  lmAsyncFlush();
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncStart - start asynchronous logging
+*
+* 'queueSize' is the number of log lines that the ring holds, rounded up to a power of two.
+*
+* NOTE
+*   The writer thread doesn't survive a fork(), so this function must be called after daemonizing.
+*/
+LmStatus lmAsyncStart(int queueSize)
+{
+  unsigned long long slots = 16;
+
+  if (lmAsyncOn == true)
+  {
+    return LmsOk;
+  }
+
+  while (slots < (unsigned long long) queueSize)
+  {
+    slots *= 2;
+  }
+
+  lmRing = (LmRingSlot*) malloc(slots * sizeof(LmRingSlot));
+  if (lmRing == NULL)
+  {
+    return LmsMalloc;
+  }
+
+  for (unsigned long long ix = 0; ix < slots; ix++)
+  {
+    lmRing[ix].seq = ix;
+  }
+
+  lmRingMask = slots - 1;
+  lmRingHead = 0;
+  lmRingTail = 0;
+
+  if (pthread_create(&lmAsyncThread, NULL, lmAsyncWriter, NULL) != 0)
+  {
+    free(lmRing);
+    lmRing = NULL;
+    return LmsOpen;
+  }
+
+  atexit(lmAsyncFlushAtExit);
+  lmAsyncOn = true;
+
+  return LmsOk;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncDroppedGet - number of log lines dropped because the ring was full
+*/
+unsigned long long lmAsyncDroppedGet(void)
+{
+  return __atomic_load_n(&lmAsyncDropped, __ATOMIC_RELAXED);
+}
+
+
+
+/* ****************************************************************************
+*
+* lmOutAsync - queue a log line for the writer thread
+*
+* Same as the synchronous part of lmOut, but formatting each line directly into a slot of the ring.
+* The hook and the warning/error functions are called just like in lmOut.
+*
+* Returns false, and queues nothing, if the line might not fit in a slot - lmOut then writes it synchronously.
+*/
+static bool lmOutAsync
 (
   char*        text,
   char         type,
@@ -2276,23 +2704,146 @@ LmStatus lmOut
   bool         use_hook
 )
 {
-  INIT_CHECK();
-  POINTER_CHECK(text);
+  static __thread char format[FDS_MAX][FORMAT_LEN + 1];
+  bool                 fdOn[FDS_MAX];
+  int                  textLen = strlen(text) + ((stre != NULL)? strlen(stre) : 0);
 
-  int   i;
-  char* line = (char*) calloc(1, LM_LINE_MAX);
-  int   sz;
-  char* format = (char*) calloc(1, FORMAT_LEN + 1);
-  char* tmP;
+  /*
+   * First, the line prefix of each file descriptor - if any line doesn't fit in a slot, nothing is queued
+   */
+  for (int i = 0; i < FDS_MAX; i++)
+  {
+    fdOn[i] = false;
+
+    if (fds[i].state != Occupied)
+    {
+      continue;
+    }
+
+    if ((fds[i].type == Stdout) && (fds[i].onlyErrorAndVerbose == true))
+    {
+      if ((type == 'T') || (type == 'D') || (type == 'H') || (type == 'M') || (type == 't'))
+      {
+        continue;
+      }
+    }
+
+    if (type == 'R')
+    {
+      format[i][0] = 0;
+    }
+    else if (lmLineFix(i, format[i], FORMAT_LEN, type, file, lineNo, fName, tLev) == NULL)
+    {
+      continue;
+    }
 
-  if ((line == NULL) || (format == NULL))
+    if (strlen(format[i]) + textLen + 8 >= LM_ASYNC_LINE_MAX)
+    {
+      return false;
+    }
+
+    fdOn[i] = true;
+  }
+
+  if ((type != 'H') && lmOutHook && (lmOutHookActive == true) && use_hook)
   {
-    if (line   != NULL)   free(line);
-    if (format != NULL)   free(format);
+    semTake();
+    lmOutHook(lmOutHookParam, text, type, time(NULL), 0, 0, file, lineNo, fName, tLev, stre);
+    semGive();
+  }
 
-    return LmsNull;
+  for (int i = 0; i < FDS_MAX; i++)
+  {
+    if (fdOn[i] == false)
+    {
+      continue;
+    }
+
+    unsigned long long  pos;
+    LmRingSlot*         slotP = lmRingReserve(&pos);
+
+    if (slotP == NULL)
+    {
+      __atomic_fetch_add(&lmAsyncDropped, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+
+    if (type == 'R')
+    {
+      if (text[1] != ':')
+      {
+        snprintf(slotP->line, LM_ASYNC_LINE_MAX, "R: %s\n", text);
+      }
+      else
+      {
+        snprintf(slotP->line, LM_ASYNC_LINE_MAX, "%s\n", text);
+      }
+    }
+    else
+    {
+      snprintf(slotP->line, LM_ASYNC_LINE_MAX, format[i], text);
+    }
+
+    if (stre != NULL)
+    {
+      strncat(slotP->line, stre, LM_ASYNC_LINE_MAX - strlen(slotP->line) - 1);
+    }
+
+    slotP->fdIx = i;
+    slotP->len  = strlen(slotP->line);
+
+    __atomic_store_n(&slotP->seq, pos + 1, __ATOMIC_RELEASE);
   }
 
+  lmAsyncWakeup();
+
+  __atomic_fetch_add(&logLines, 1, __ATOMIC_RELAXED);
+
+  if (type == 'W')
+  {
+    if (warningFunction != NULL)
+    {
+      warningFunction(warningInput, text, (char*) stre);
+    }
+  }
+  else if ((type == 'E') || (type == 'P'))
+  {
+    if (errorFunction != NULL)
+    {
+      errorFunction(errorInput, text, (char*) stre);
+    }
+  }
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmOut -
+*/
+LmStatus lmOut
+(
+  char*        text,
+  char         type,
+  const char*  file,
+  int          lineNo,
+  const char*  fName,
+  int          tLev,
+  const char*  stre,
+  bool         use_hook
+)
+{
+  INIT_CHECK();
+  POINTER_CHECK(text);
+
+  static __thread char line[LM_LINE_MAX];
+  static __thread char format[FORMAT_LEN + 1];
+  int                  i;
+  int                  sz;
+  char*                tmP;
+
   tmP = strrchr((char*) file, '/');
   if (tmP != NULL)
   {
@@ -2302,12 +2853,21 @@ LmStatus lmOut
   if (inSigHandler && (type != 'X' || type != 'x'))
   {
     lmAddMsgBuf(text, type, file, lineNo, fName, tLev, (char*) stre);
-    free(line);
-    free(format);
-
     return LmsOk;
   }
 
+  if (lmAsyncOn == true)
+  {
+    if ((type != 'X') && (type != 'x') && (lmOutAsync(text, type, file, lineNo, fName, tLev, stre, use_hook) == true))
+    {
+      return LmsOk;
+    }
+
+    /* Fatal error or too long line - written synchronously, after the lines already queued */
+    lmAsyncFlush();
+  }
+
+  line[0] = 0;
   memset(format, 0, FORMAT_LEN + 1);
 
   semTake();
@@ -2399,7 +2959,7 @@ LmStatus lmOut
     }
   }
 
-  ++logLines;
+  __atomic_fetch_add(&logLines, 1, __ATOMIC_RELAXED);  /* Also incremented by lmOutAsync, without the semaphore */
   LOG_OUT(("logLines: %d", logLines));
 
   if (type == 'W')
@@ -2434,8 +2994,6 @@ LmStatus lmOut
     }
 
     /* exit here, just in case */
-    free(line);
-    free(format);
     exit(tLev);
   }
 
@@ -2456,8 +3014,6 @@ LmStatus lmOut
 
         if ((s = lmClear(i, keepLines, lastLines)) != LmsOk)
         {
-          free(line);
-          free(format);
           semGive();
           return s;
         }
@@ -2465,8 +3021,6 @@ LmStatus lmOut
     }
   }
 
-  free(line);
-  free(format);
   semGive();
   return LmsOk;
 }
@@ -1925,4 +1925,28 @@ inline void lmTransactionEnd()
 */
 extern const char* lmSemGet(void);
 
+
+
+/* ****************************************************************************
+*
+* lmAsyncStart - start asynchronous logging, with a queue of 'queueSize' lines
+*/
+extern LmStatus lmAsyncStart(int queueSize);
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncFlush - wait for all queued log lines to be written
+*/
+extern void lmAsyncFlush(void);
+
+
+
+/* ****************************************************************************
+*
+* lmAsyncDroppedGet - number of log lines dropped because the log queue was full
+*/
+extern unsigned long long lmAsyncDroppedGet(void);
+
 #endif  // SRC_LIB_LOGMSG_LOGMSG_H_
@@ -23,16 +23,22 @@
 * Author: Ken Zangelin
 */
 #include <stdint.h>   // int64_t et al
+#include <stdio.h>    // snprintf
+#include <stdlib.h>   // calloc
+#include <string.h>   // memcmp, memcpy
 #include <sys/time.h>
+#include <pthread.h>
 
 #include <utility>
 #include <string>
+#include <vector>
 #include <map>
 
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
 #include "common/JsonHelper.h"
+#include "common/limits.h"
 #include "rest/rest.h"
 #include "rest/RestService.h"
 #include "metricsMgr/MetricsManager.h"
@@ -48,6 +54,168 @@
 
 
 
+/* ****************************************************************************
+*
+* MetricInfo - 
+*
+* Indexed by MetricId. 'promName' is NULL for _METRIC_TOTAL_SERVICE_TIME, as in Prometheus
+* format it is rendered as the sum of the service time histogram.
+*/
+typedef struct MetricInfo
+{
+  const char* name;
+  const char* promName;
+  const char* promHelp;
+} MetricInfo;
+
+static MetricInfo metricInfoV[METRIC_IDS] =
+{
+  { METRIC_TRANS_IN,             "orion_incoming_transactions_total",                    "Number of incoming requests"                },
+  { METRIC_TRANS_IN_REQ_SIZE,    "orion_incoming_transaction_request_size_bytes_total",  "Total size of the incoming request payloads" },
+  { METRIC_TRANS_IN_RESP_SIZE,   "orion_incoming_transaction_response_size_bytes_total", "Total size of the response payloads"        },
+  { METRIC_TRANS_IN_ERRORS,      "orion_incoming_transaction_errors_total",              "Number of incoming requests that failed"    },
+  { _METRIC_TOTAL_SERVICE_TIME,  NULL,                                                   NULL                                         },
+  { METRIC_TRANS_OUT,            "orion_outgoing_transactions_total",                    "Number of outgoing requests"                },
+  { METRIC_TRANS_OUT_REQ_SIZE,   "orion_outgoing_transaction_request_size_bytes_total",  "Total size of the outgoing request payloads" },
+  { METRIC_TRANS_OUT_RESP_SIZE,  "orion_outgoing_transaction_response_size_bytes_total", "Total size of the received responses"       },
+  { METRIC_TRANS_OUT_ERRORS,     "orion_outgoing_transaction_errors_total",              "Number of outgoing requests that failed"    }
+};
+
+
+
+/* ****************************************************************************
+*
+* Service time histogram -
+*
+* Upper limits of the buckets, in microseconds (as _METRIC_TOTAL_SERVICE_TIME) and in seconds
+* (as rendered). The last bucket (no limit) is '+Inf'.
+*/
+static const uint64_t histogramLimitV[METRICS_HISTOGRAM_BUCKETS - 1] =
+{
+  1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000
+};
+
+static const char* histogramLeV[METRICS_HISTOGRAM_BUCKETS] =
+{
+  "0.001", "0.005", "0.01", "0.025", "0.05", "0.1", "0.25", "0.5", "1", "2.5", "5", "+Inf"
+};
+
+
+
+/* ****************************************************************************
+*
+* MetricsShard - the counters of one thread
+*
+* counterV[keyId] is allocated by the owning thread the first time it counts for that key,
+* and published with release semantics, so that the aggregating thread can read it without a lock.
+* Only the owning thread writes the counters.
+*
+* When a thread exits, its shard is marked as free and it is adopted by the next thread that
+* needs a shard - the counters are kept as they are part of the totals.
+*/
+typedef struct MetricsShard
+{
+  uint64_t*             counterV[METRICS_KEYS_MAX];
+  bool                  inUse;
+  struct MetricsShard*  next;
+} MetricsShard;
+
+static MetricsShard*     shardList      = NULL;
+static pthread_mutex_t   shardListMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t     shardKey;
+static __thread MetricsShard* threadShardP = NULL;
+
+
+
+/* ****************************************************************************
+*
+* MetricsKeyCacheItem - per-thread cache of the last key ids looked up
+*
+* Most threads see the same few service/service-path pairs over and over, so the
+* key id is found comparing raw bytes, without any lock or string construction.
+* Service paths longer than the buffer are simply not cached.
+*/
+#define METRICS_KEY_CACHE_ITEMS      4
+#define METRICS_KEY_CACHE_SPATH_MAX  256
+
+typedef struct MetricsKeyCacheItem
+{
+  char      srv[SERVICE_NAME_MAX_LEN + 1];
+  char      subServ[METRICS_KEY_CACHE_SPATH_MAX];
+  unsigned  srvLen;
+  unsigned  subServLen;
+  int       keyId;
+} MetricsKeyCacheItem;
+
+static __thread MetricsKeyCacheItem keyCache[METRICS_KEY_CACHE_ITEMS];
+static __thread int                 keyCacheItems = 0;
+static __thread int                 keyCacheNext  = 0;
+
+
+
+/* ****************************************************************************
+*
+* shardRelease - thread exit destructor of the shard key
+*/
+static void shardRelease(void* vP)
+{
+  MetricsShard* shardP = (MetricsShard*) vP;
+
+  pthread_mutex_lock(&shardListMutex);
+  shardP->inUse = false;
+  pthread_mutex_unlock(&shardListMutex);
+}
+
+
+
+/* ****************************************************************************
+*
+* shardGet - the shard of the calling thread, adopting or creating one if needed
+*/
+static MetricsShard* shardGet(void)
+{
+  MetricsShard* shardP;
+
+  if (threadShardP != NULL)
+  {
+    return threadShardP;
+  }
+
+  pthread_mutex_lock(&shardListMutex);
+
+  for (shardP = shardList; shardP != NULL; shardP = shardP->next)
+  {
+    if (shardP->inUse == false)
+    {
+      break;
+    }
+  }
+
+  if (shardP == NULL)
+  {
+    shardP = (MetricsShard*) calloc(1, sizeof(MetricsShard));
+
+    if (shardP == NULL)
+    {
+      pthread_mutex_unlock(&shardListMutex);
+      return NULL;
+    }
+
+    shardP->next = shardList;
+    shardList    = shardP;
+  }
+
+  shardP->inUse = true;
+  pthread_mutex_unlock(&shardListMutex);
+
+  pthread_setspecific(shardKey, shardP);
+  threadShardP = shardP;
+
+  return shardP;
+}
+
+
+
 /* ****************************************************************************
 *
 * MetricsManager::MetricsManager -
@@ -114,6 +282,18 @@ bool MetricsManager::init(bool _on, bool _semWaitStatistics)
     return false;
   }
 
+  if (pthread_rwlock_init(&keyLock, NULL) != 0)
+  {
+    LM_E(("Runtime Error (error initializing 'metrics mgr' key lock)"));
+    return false;
+  }
+
+  if (pthread_key_create(&shardKey, shardRelease) != 0)
+  {
+    LM_E(("Runtime Error (error creating 'metrics mgr' thread key)"));
+    return false;
+  }
+
   return true;
 }
 
@@ -233,100 +413,223 @@ bool MetricsManager::servicePathForMetrics(const std::string& spathIn, std::stri
 
 /* ****************************************************************************
 *
-* MetricsManager::add -
+* MetricsManager::keyIdGet -
+*
+* Returns the key id of a service/service-path pair, creating it if needed, or -1 if the pair
+* is not to be counted (invalid service or service path, or METRICS_KEYS_MAX reached).
 *
-* FIXME P4: About the calls to serviceValid and subServiceValid:
-*   we check that 'srv' and 'subServ' are legal names, and if not, metrics are skipped.
-*   Doing this each time add() is called is not optimal for performance.
-*   The github issue #2781 is about better solutions for this.
-*   Note that the call to subServiceValid is inside servicePathForMetrics()
+* The validity of 'srv' and 'subServ' is checked only the first time a pair is seen
+* (see github issue #2781). Invalid pairs are not remembered, so that a client sending
+* garbage can't make the tables grow.
 */
-void MetricsManager::add(const std::string& srv, const std::string& subServ, const std::string& metric, uint64_t value)
+int MetricsManager::keyIdGet(const std::string& srv, const std::string& subServ)
 {
-  std::string subService = "not-set";
+  std::string                          rawKey = srv + '\n' + subServ;
+  std::map<std::string, int>::iterator iter;
+  int                                  keyId;
+
+  pthread_rwlock_rdlock(&keyLock);
+  iter  = rawKeyMap.find(rawKey);
+  keyId = (iter != rawKeyMap.end())? iter->second : -2;
+  pthread_rwlock_unlock(&keyLock);
+
+  if (keyId != -2)
+  {
+    return keyId;
+  }
+
+  std::string subService;
+
+  if ((serviceValid(srv) == false) || (servicePathForMetrics(subServ, &subService) == false))
+  {
+    return -1;
+  }
+
+  std::string key = srv + '\n' + subService;
+
+  pthread_rwlock_wrlock(&keyLock);
 
+  iter = keyMap.find(key);
+  if (iter != keyMap.end())
+  {
+    keyId = iter->second;
+  }
+  else if (keyV.size() < METRICS_KEYS_MAX)
+  {
+    keyId       = keyV.size();
+    keyMap[key] = keyId;
+    keyV.push_back(std::pair<std::string, std::string>(srv, subService));
+  }
+  else
+  {
+    keyId = -1;
+    LM_W(("Too many service/subservice pairs for metrics (max %d) - '%s' not counted", METRICS_KEYS_MAX, rawKey.c_str()));
+  }
+
+  //
+  // The raw map is bounded as well, as many service paths may end up in the same subservice
+  //
+  if ((keyId != -1) && (rawKeyMap.size() < 4 * METRICS_KEYS_MAX))
+  {
+    rawKeyMap[rawKey] = keyId;
+  }
+
+  pthread_rwlock_unlock(&keyLock);
+
+  return keyId;
+}
+
+
+
+/* ****************************************************************************
+*
+* MetricsManager::add -
+*
+* Lock-free: the key id comes from the per-thread key cache (keyIdGet only on a miss)
+* and the counter is only ever written by the calling thread.
+*/
+void MetricsManager::add(const std::string& srv, const std::string& subServ, MetricId metric, uint64_t value)
+{
   if (on == false)
   {
     return;
   }
 
-  if (serviceValid(srv) == false)
+  MetricsShard* shardP = shardGet();
+
+  if (shardP == NULL)
   {
     return;
   }
 
-  if (servicePathForMetrics(subServ, &subService) == false)
+  //
+  // Lookup in the key cache of the thread
+  //
+  unsigned int  srvLen     = srv.length();
+  unsigned int  subServLen = subServ.length();
+  int           keyId      = -2;
+
+  for (int ix = 0; ix < keyCacheItems; ++ix)
   {
-    return;
+    MetricsKeyCacheItem* itemP = &keyCache[ix];
+
+    if ((itemP->srvLen == srvLen) && (itemP->subServLen == subServLen) &&
+        (memcmp(itemP->srv, srv.c_str(), srvLen) == 0) && (memcmp(itemP->subServ, subServ.c_str(), subServLen) == 0))
+    {
+      keyId = itemP->keyId;
+      break;
+    }
   }
 
-  semTake();
+  if (keyId == -2)
+  {
+    keyId = keyIdGet(srv, subServ);
+
+    if ((keyId != -1) && (srvLen <= SERVICE_NAME_MAX_LEN) && (subServLen < METRICS_KEY_CACHE_SPATH_MAX))
+    {
+      MetricsKeyCacheItem* itemP = &keyCache[keyCacheNext];
 
+      memcpy(itemP->srv, srv.c_str(), srvLen);
+      memcpy(itemP->subServ, subServ.c_str(), subServLen);
+      itemP->srvLen     = srvLen;
+      itemP->subServLen = subServLen;
+      itemP->keyId      = keyId;
+
+      keyCacheNext = (keyCacheNext + 1) % METRICS_KEY_CACHE_ITEMS;
+      if (keyCacheItems < METRICS_KEY_CACHE_ITEMS)
+      {
+        ++keyCacheItems;
+      }
+    }
+  }
 
-  // Do we have the service in the map?
-  if (metrics.find(srv) == metrics.end())
+  if (keyId == -1)
   {
-    // not found: create it
-    metrics[srv] = new std::map<std::string, std::map<std::string, uint64_t>*>;
+    return;
   }
 
-  // Do we have the subservice in the map?
-  if (metrics[srv]->find(subService) == metrics[srv]->end())
+  uint64_t* counterV = shardP->counterV[keyId];
+
+  if (counterV == NULL)
   {
-    //
-    // Not Found: create it
-    //
-    metrics[srv]->insert(std::pair<std::string, std::map<std::string, uint64_t>*>
-                         (subService,
-                          new std::map<std::string, uint64_t>));
+    counterV = (uint64_t*) calloc(METRICS_COUNTERS, sizeof(uint64_t));
+    if (counterV == NULL)
+    {
+      return;
+    }
+
+    __atomic_store_n(&shardP->counterV[keyId], counterV, __ATOMIC_RELEASE);
   }
 
-  // Do we have the metric in the map?
-  if (metrics[srv]->at(subService)->find(metric) == metrics[srv]->at(subService)->end())
+  // Single writer - a relaxed store is enough for the reader to never see a torn value
+  __atomic_store_n(&counterV[metric], __atomic_load_n(&counterV[metric], __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+
+  if (metric == MetricTotalServiceTime)
   {
-    //
-    // Not Found: create it
-    //
-    metrics[srv]->at(subService)->insert(std::pair<std::string, uint64_t>(metric, 0));
+    int bucket = 0;
+
+    while ((bucket < METRICS_HISTOGRAM_BUCKETS - 1) && (value > histogramLimitV[bucket]))
+    {
+      ++bucket;
+    }
+
+    uint64_t* bucketP = &counterV[METRIC_IDS + bucket];
+    __atomic_store_n(bucketP, __atomic_load_n(bucketP, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
   }
+}
 
-  metrics[srv]->at(subService)->at(metric) += value;
 
-  semGive();
+
+/* ****************************************************************************
+*
+* MetricsManager::keysGet -
+*
+* Copy of the key table, as the aggregation must not hold keyLock (add() may need it).
+*/
+int MetricsManager::keysGet(std::vector<std::pair<std::string, std::string> >* keysP)
+{
+  pthread_rwlock_rdlock(&keyLock);
+  *keysP = keyV;
+  pthread_rwlock_unlock(&keyLock);
+
+  return keysP->size();
 }
 
 
 
 /* ****************************************************************************
 *
-* MetricsManager::_reset -
+* MetricsManager::countersAggregate -
+*
+* Sums up the counters of all shards, for the first 'keys' key ids.
+* The result, in 'totalV', is indexed [keyId * METRICS_COUNTERS + counter].
+* The reset baseline is not subtracted here.
 */
-void MetricsManager::_reset(void)
+void MetricsManager::countersAggregate(int keys, std::vector<uint64_t>* totalV)
 {
-  //
-  // Three iterators needed to iterate over the 'triple-map' metrics:
-  //   serviceIter      to iterate over all services
-  //   subServiceIter   to iterate over all sub-services of a service
-  //   metricIter       to iterate over all metrics of a sub-service
-  //
-  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>*>*>::iterator  serviceIter;
-  std::map<std::string, std::map<std::string, uint64_t>*>::iterator                          subServiceIter;
-  std::map<std::string, uint64_t>::iterator                                                  metricIter;
+  totalV->assign(keys * METRICS_COUNTERS, 0);
 
-  for (serviceIter = metrics.begin(); serviceIter != metrics.end(); ++serviceIter)
-  {
-    std::map<std::string, std::map<std::string, uint64_t>*>* servMap  = serviceIter->second;
+  pthread_mutex_lock(&shardListMutex);
 
-    for (subServiceIter = servMap->begin(); subServiceIter != servMap->end(); ++subServiceIter)
+  for (MetricsShard* shardP = shardList; shardP != NULL; shardP = shardP->next)
+  {
+    for (int keyId = 0; keyId < keys; ++keyId)
     {
-      std::map<std::string, uint64_t>* metricMap  = subServiceIter->second;
+      uint64_t* counterV = __atomic_load_n(&shardP->counterV[keyId], __ATOMIC_ACQUIRE);
 
-      for (metricIter = metricMap->begin(); metricIter != metricMap->end(); ++metricIter)
+      if (counterV == NULL)
+      {
+        continue;
+      }
+
+      for (int ix = 0; ix < METRICS_COUNTERS; ++ix)
       {
-        metricIter->second = 0;
+        (*totalV)[keyId * METRICS_COUNTERS + ix] += __atomic_load_n(&counterV[ix], __ATOMIC_RELAXED);
       }
     }
   }
+
+  pthread_mutex_unlock(&shardListMutex);
 }
 
 
@@ -382,17 +685,37 @@ static std::string metricsRender(std::map<std::string, uint64_t>* metricsMap)
 /* ****************************************************************************
 *
 * MetricsManager::_toJson -
+*
+* The aggregated counters (minus the reset baseline) are first put in a 'triple-map'
+* service -> subservice -> metric, which is then rendered.
+* Zero values are left out of the triple-map, just like they are left out of the output.
 */
-std::string MetricsManager::_toJson(void)
+std::string MetricsManager::_toJson(const std::vector<std::pair<std::string, std::string> >& keys, const std::vector<uint64_t>& totalV)
 {
+  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t> > >  metrics;
+
+  for (unsigned int keyId = 0; keyId < keys.size(); ++keyId)
+  {
+    for (int metricId = 0; metricId < METRIC_IDS; ++metricId)
+    {
+      unsigned int  ix    = keyId * METRICS_COUNTERS + metricId;
+      uint64_t      value = totalV[ix] - ((ix < base.size())? base[ix] : 0);
+
+      if (value != 0)
+      {
+        metrics[keys[keyId].first][keys[keyId].second][metricInfoV[metricId].name] = value;
+      }
+    }
+  }
+
   //
   // Three iterators needed to iterate over the 'triple-map' metrics:
   //   serviceIter      to iterate over all services
   //   subServiceIter   to iterate over all sub-services of a service
   //   metricIter       to iterate over all metrics of a sub-service
   //
-  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>*>*>::iterator  serviceIter;
-  std::map<std::string, std::map<std::string, uint64_t>*>::iterator                          subServiceIter;
+  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t> > >::iterator  serviceIter;
+  std::map<std::string, std::map<std::string, uint64_t> >::iterator                          subServiceIter;
   std::map<std::string, uint64_t>::iterator                                                  metricIter;
   JsonHelper                                                                                 top;
   JsonHelper                                                                                 services;
@@ -404,14 +727,13 @@ std::string MetricsManager::_toJson(void)
     JsonHelper                                                subServiceTop;
     JsonHelper                                                jhSubService;
     std::string                                               service        = serviceIter->first;
-    std::map<std::string, std::map<std::string, uint64_t>*>*  servMap        = serviceIter->second;
+    std::map<std::string, std::map<std::string, uint64_t> >*  servMap        = &serviceIter->second;
     std::map<std::string, uint64_t>                           serviceSum;
 
     for (subServiceIter = servMap->begin(); subServiceIter != servMap->end(); ++subServiceIter)
     {
-      JsonHelper                        jhMetrics;
       std::string                       subService           = subServiceIter->first;
-      std::map<std::string, uint64_t>*  metricMap            = subServiceIter->second;
+      std::map<std::string, uint64_t>*  metricMap            = &subServiceIter->second;
 
       for (metricIter = metricMap->begin(); metricIter != metricMap->end(); ++metricIter)
       {
@@ -419,12 +741,9 @@ std::string MetricsManager::_toJson(void)
         int64_t      value  = metricIter->second;
 
         // Add to 'sum-maps'
-        if (value != 0)
-        {
-          serviceSum[metric] += value;
-          sum[metric]        += value;
-          subServCrossTenant[subService][metric] += value;
-        }
+        serviceSum[metric]                     += value;
+        sum[metric]                            += value;
+        subServCrossTenant[subService][metric] += value;
       }
 
       std::string subServiceString = metricsRender(metricMap);
@@ -451,12 +770,9 @@ std::string MetricsManager::_toJson(void)
       //
       // Skipping empty tenant
       //
-      // Remember - when doing reset of the metrics, emptied tenants aren't removed.
-      // They are only emptied, to save the time of delete and then create again.
-      // [ Most likely they will be needed soon after the reset ]
-      //
-      // But, we don't want to show those 'emptied tenants' in the metrics output
-      // so, we skip those tenants, calling 'continue' right here
+      // A tenant whose only counters are _METRIC_TOTAL_SERVICE_TIME renders as empty.
+      // We don't want to show those tenants in the metrics output so, we skip them,
+      // calling 'continue' right here
       //
       continue;
     }
@@ -548,6 +864,10 @@ const char* MetricsManager::semStateGet(void)
 /* ****************************************************************************
 *
 * MetricsManager::release -
+*
+* Only the reset baseline is freed.
+* The shards and the key tables are kept, as other threads may still be counting
+* while the broker exits.
 */
 void MetricsManager::release(void)
 {
@@ -557,31 +877,7 @@ void MetricsManager::release(void)
   }
 
   semTake();
-
-  //
-  // Two iterators needed to iterate over metrics, clearing all maps:
-  //   serviceIter      to iterate over all services
-  //   subServiceIter   to iterate over all sub-services of a service
-  //
-  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>*>*>::iterator  serviceIter;
-  std::map<std::string, std::map<std::string, uint64_t>*>::iterator                          subServiceIter;
-
-  for (serviceIter = metrics.begin(); serviceIter != metrics.end(); ++serviceIter)
-  {
-    std::map<std::string, std::map<std::string, uint64_t>*>* servMap  = serviceIter->second;
-
-    for (subServiceIter = servMap->begin(); subServiceIter != servMap->end(); ++subServiceIter)
-    {
-      std::map<std::string, uint64_t>*  metricMap  = subServiceIter->second;
-
-      metricMap->clear();
-      delete metricMap;
-    }
-    servMap->clear();
-    delete servMap;
-  }
-  metrics.clear();
-
+  base.clear();
   semGive();
 }
 
@@ -590,6 +886,9 @@ void MetricsManager::release(void)
 /* ****************************************************************************
 *
 * MetricsManager::reset -
+*
+* The shards are never zeroed (they belong to their threads), the current totals
+* become the new baseline instead.
 */
 void MetricsManager::reset(void)
 {
@@ -598,8 +897,11 @@ void MetricsManager::reset(void)
     return;
   }
 
+  std::vector<std::pair<std::string, std::string> > keys;
+  int                                               nKeys = keysGet(&keys);
+
   semTake();
-  _reset();
+  countersAggregate(nKeys, &base);
   semGive();
 }
 
@@ -616,16 +918,116 @@ std::string MetricsManager::toJson(bool doReset)
     return "";
   }
 
+  std::vector<std::pair<std::string, std::string> > keys;
+  std::vector<uint64_t>                             totalV;
+  int                                               nKeys = keysGet(&keys);
+
   semTake();
 
-  std::string  s = _toJson();
+  countersAggregate(nKeys, &totalV);
+
+  std::string  s = _toJson(keys, totalV);
 
   if (doReset)
   {
-    _reset();
+    base = totalV;
   }
 
   semGive();
 
   return s;
 }
+
+
+
+/* ****************************************************************************
+*
+* promLabels - 
+*
+* Services and subservices have been validated (alphanumerics, '_' and '/') so they
+* need no escaping as label values.
+*/
+static void promLabels(const std::pair<std::string, std::string>& key, char* buf, int bufLen)
+{
+  const char* service    = (key.first  != "")? key.first.c_str()  : DEFAULT_SERVICE_KEY_FOR_METRICS;
+  const char* subService = (key.second != "")? key.second.c_str() : ROOT_SUB_SERVICE_KEY_FOR_METRICS;
+
+  snprintf(buf, bufLen, "service=\"%s\",subservice=\"%s\"", service, subService);
+}
+
+
+
+/* ****************************************************************************
+*
+* MetricsManager::toPrometheus -
+*
+* Prometheus text exposition format (version 0.0.4).
+*
+* The counters are rendered as they are in the shards, i.e. a reset (DELETE /admin/metrics
+* or GET /admin/metrics?reset=true) does not affect them - Prometheus counters are expected
+* to be monotonic.
+* The service time is rendered as a histogram, in seconds.
+*/
+std::string MetricsManager::toPrometheus(void)
+{
+  if (on == false)
+  {
+    return "";
+  }
+
+  std::vector<std::pair<std::string, std::string> > keys;
+  std::vector<uint64_t>                             totalV;
+  int                                               nKeys = keysGet(&keys);
+  std::string                                       out;
+  char                                              labels[SERVICE_NAME_MAX_LEN + SERVICE_PATH_MAX_TOTAL + 64];
+  char                                              line[sizeof(labels) + 256];
+
+  semTake();
+  countersAggregate(nKeys, &totalV);
+  semGive();
+
+  for (int metricId = 0; metricId < METRIC_IDS; ++metricId)
+  {
+    if (metricInfoV[metricId].promName == NULL)
+    {
+      continue;
+    }
+
+    out += std::string("# HELP ") + metricInfoV[metricId].promName + " " + metricInfoV[metricId].promHelp + "\n";
+    out += std::string("# TYPE ") + metricInfoV[metricId].promName + " counter\n";
+
+    for (int keyId = 0; keyId < nKeys; ++keyId)
+    {
+      promLabels(keys[keyId], labels, sizeof(labels));
+      snprintf(line, sizeof(line), "%s{%s} %llu\n",
+               metricInfoV[metricId].promName,
+               labels,
+               (unsigned long long) totalV[keyId * METRICS_COUNTERS + metricId]);
+      out += line;
+    }
+  }
+
+  out += "# HELP orion_service_time_seconds Time taken to serve incoming requests\n";
+  out += "# TYPE orion_service_time_seconds histogram\n";
+
+  for (int keyId = 0; keyId < nKeys; ++keyId)
+  {
+    uint64_t  cumulative = 0;
+
+    promLabels(keys[keyId], labels, sizeof(labels));
+
+    for (int bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; ++bucket)
+    {
+      cumulative += totalV[keyId * METRICS_COUNTERS + METRIC_IDS + bucket];
+      snprintf(line, sizeof(line), "orion_service_time_seconds_bucket{%s,le=\"%s\"} %llu\n", labels, histogramLeV[bucket], (unsigned long long) cumulative);
+      out += line;
+    }
+
+    snprintf(line, sizeof(line), "orion_service_time_seconds_sum{%s} %.6f\n", labels, (double) totalV[keyId * METRICS_COUNTERS + MetricTotalServiceTime] / 1000000);
+    out += line;
+    snprintf(line, sizeof(line), "orion_service_time_seconds_count{%s} %llu\n", labels, (unsigned long long) cumulative);
+    out += line;
+  }
+
+  return out;
+}
@@ -27,9 +27,11 @@
 */
 #include <stdint.h>   // int64_t et al
 #include <semaphore.h>
+#include <pthread.h>
 
 #include <utility>
 #include <string>
+#include <vector>
 #include <map>
 
 
@@ -60,6 +62,37 @@
 #define METRIC_TRANS_OUT_RESP_SIZE                 "outgoingTransactionResponseSize"
 #define METRIC_TRANS_OUT_ERRORS                    "outgoingTransactionErrors"
 
+
+
+/* ****************************************************************************
+*
+* MetricId -
+*
+* Index of each metric in the counter vector of a (service, subservice) key.
+* The string names above are what is rendered, see metricInfoV in MetricsManager.cpp.
+* The service time histogram occupies the last METRICS_HISTOGRAM_BUCKETS counters
+* of the vector.
+*/
+typedef enum MetricId
+{
+  MetricTransIn = 0,
+  MetricTransInReqSize,
+  MetricTransInRespSize,
+  MetricTransInErrors,
+  MetricTotalServiceTime,
+  MetricTransOut,
+  MetricTransOutReqSize,
+  MetricTransOutRespSize,
+  MetricTransOutErrors
+} MetricId;
+
+#define METRIC_IDS                 9
+#define METRICS_HISTOGRAM_BUCKETS  12
+#define METRICS_COUNTERS           (METRIC_IDS + METRICS_HISTOGRAM_BUCKETS)
+#define METRICS_KEYS_MAX           1024
+
+
+
 #if 0
 //
 // The following counters are still under discussion
@@ -117,20 +150,34 @@
 *     for metrics
 * 11. Try to come up with better solution for metrics for requests using invalid service-path / tenant?
 *
+* IMPLEMENTATION
+*   Every (service, subservice) pair is interned into a 'key id' the first time it is seen
+*   (validation and service path normalization happen only then).
+*   Each thread counts in its own shard (a vector of counters per key id) without any lock,
+*   and the shards are summed up only when the metrics are read.
+*   A reset doesn't touch the shards, it just moves the baseline ('base') that is subtracted
+*   when rendering.
+*   There is only one instance of MetricsManager (metricsMgr), as the shards are thread-local.
 */
 class MetricsManager
 {
  private:
-  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>*>*>  metrics;
-  bool            on;
-  sem_t           sem;
-  bool            semWaitStatistics;
-  int64_t         semWaitTime;        // measured in microseconds
+  bool                                              on;
+  sem_t                                             sem;                // Protects 'base' - taken by readers only, never by add()
+  bool                                              semWaitStatistics;
+  int64_t                                           semWaitTime;        // measured in microseconds
+  pthread_rwlock_t                                  keyLock;            // Protects the three key tables below
+  std::map<std::string, int>                        rawKeyMap;          // "service\nservice-path-as-received" -> key id
+  std::map<std::string, int>                        keyMap;             // "service\nsubservice" -> key id
+  std::vector<std::pair<std::string, std::string> > keyV;               // key id -> (service, subservice)
+  std::vector<uint64_t>                             base;               // Counter values at the last reset
 
   void            semTake(void);
   void            semGive(void);
-  void            _reset(void);
-  std::string     _toJson(void);
+  int             keyIdGet(const std::string& srv, const std::string& subServ);
+  int             keysGet(std::vector<std::pair<std::string, std::string> >* keysP);
+  void            countersAggregate(int keys, std::vector<uint64_t>* totalV);
+  std::string     _toJson(const std::vector<std::pair<std::string, std::string> >& keys, const std::vector<uint64_t>& totalV);
   bool            serviceValid(const std::string& srv);
   bool            subServiceValid(const std::string& subsrv);
   bool            servicePathForMetrics(const std::string& spath, std::string* subServiceP);
@@ -139,9 +186,10 @@ class MetricsManager
   MetricsManager();
 
   bool         init(bool _on, bool _semWaitStatistics);
-  void         add(const std::string& srv, const std::string& subServ, const std::string& metric, uint64_t value);
+  void         add(const std::string& srv, const std::string& subServ, MetricId metric, uint64_t value);
   void         reset(void);
   std::string  toJson(bool doReset);
+  std::string  toPrometheus(void);
   bool         isOn(void);
   int64_t      semWaitTimeGet(void);
   const char*  semStateGet(void);
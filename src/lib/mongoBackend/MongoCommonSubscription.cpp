@@ -145,6 +145,12 @@ void setHttpInfo(const Subscription& sub, BSONObjBuilder* b)
 #ifdef ORIONLD
   b->append("mimeType", mimeTypeToLongString(sub.notification.httpInfo.mimeType));
   LM_T(LmtMongo, ("Subscription mimeType: %d", sub.notification.httpInfo.mimeType));
+
+  if (sub.notification.httpInfo.batchMaxEntities > 0)
+  {
+    b->append(CSUB_BATCH_MAX_ENTITIES, sub.notification.httpInfo.batchMaxEntities);
+    b->append(CSUB_BATCH_MAX_DELAY,    sub.notification.httpInfo.batchMaxDelay);
+  }
 #endif
 
   LM_T(LmtMongo, ("Subscription reference: %s", sub.notification.httpInfo.url.c_str()));
@@ -55,10 +55,18 @@ extern "C"
 {
 #include "kjson/KjNode.h"                                      // KjNode, kjValueType
 #include "kjson/kjLookup.h"                                    // kjLookup
+#include "kjson/kjRender.h"                                    // kjRender
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
 }
 
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/common/geoJsonCreate.h"                      // geoJsonCreate
+#include "orionld/kjTree/kjTreeFromNotification.h"             // kjTreeFromNotification
+#include "orionld/kjTree/kjTreeRenderSize.h"                   // kjTreeRenderSize
+#include "orionld/notifications/notificationBatchAdd.h"        // notificationBatchAdd
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/geo/geoGeometryFromAttribute.h"              // geoGeometryFromAttribute
+#include "orionld/geo/geoFilterMatch.h"                        // geoFilterMatch
 #endif
 
 #include "mongoBackend/connectionOperations.h"
@@ -1202,6 +1210,10 @@ static bool addTriggeredSubscriptions_withCache
     subP->metadata  = cSubP->metadata;
 
     subP->fillExpression(cSubP->expression.georel, cSubP->expression.geometry, cSubP->expression.coords);
+#ifdef ORIONLD
+    if (cSubP->geoFilterP != NULL)
+      subP->geoFilterSet(cSubP->geoFilterP);
+#endif
 
     std::string errorString;
 
@@ -1589,6 +1601,9 @@ static bool addTriggeredSubscriptions_noCache
         std::string coords   = expr.hasField(CSUB_EXPR_COORDS) ? getStringFieldF(expr, CSUB_EXPR_COORDS) : "";
 
         trigs->fillExpression(georel, geometry, coords);
+#ifdef ORIONLD
+        trigs->geoFilterSet(NULL);
+#endif
 
         // Parsing q
         if (q != "")
@@ -1697,6 +1712,74 @@ static bool addTriggeredSubscriptions
 
 
 
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* notificationBatchAddNcr -
+*
+* The entity of the notification is rendered right away, as the request is still alive,
+* and it is added to the notification batch of the subscription.
+* The context of the subscription is taken from the subscription cache (the core context if not found).
+*/
+static void notificationBatchAddNcr
+(
+  NotifyContextRequest*    ncrP,
+  const std::string&       subId,
+  RenderFormat             renderFormat,
+  const std::string&       tenant,
+  const ngsiv2::HttpInfo&  httpInfo
+)
+{
+  std::string  ldContext;
+  char*        details;
+
+  cacheSemTake(__FUNCTION__, "context of a subscription with notification batching");
+
+  CachedSubscription* cSubP = subCacheItemLookup(tenant.c_str(), subId.c_str());
+
+  if (cSubP != NULL)
+  {
+    ldContext = cSubP->ldContext;
+  }
+
+  cacheSemGive(__FUNCTION__, "context of a subscription with notification batching");
+
+  KjNode* treeP = kjTreeFromNotification(ncrP, ldContext.c_str(), httpInfo.mimeType, renderFormat, &details);
+
+  if (treeP == NULL)
+  {
+    LM_E(("kjTreeFromNotification error: %s", details));
+    return;
+  }
+
+  KjNode* dataP   = kjLookup(treeP, "data");
+  KjNode* entityP = (dataP != NULL)? dataP->value.firstChildP : NULL;
+
+  if (entityP == NULL)
+  {
+    LM_E(("Internal Error (no entity in the notification for subscription '%s')", subId.c_str()));
+    return;
+  }
+
+  int    size = kjTreeRenderSize(orionldState.kjsonP, entityP);
+  char*  buf  = (char*) kaAlloc(&orionldState.kalloc, size);
+
+  kjRender(orionldState.kjsonP, entityP, buf, size);
+
+  notificationBatchAdd(tenant.c_str(),
+                       subId.c_str(),
+                       httpInfo.url.c_str(),
+                       httpInfo.mimeType,
+                       ldContext.c_str(),
+                       httpInfo.batchMaxEntities,
+                       httpInfo.batchMaxDelay,
+                       buf,
+                       strlen(buf));
+}
+#endif
+
+
+
 /* ****************************************************************************
 *
 * processOnChangeConditionForUpdateContext -
@@ -1767,6 +1850,18 @@ static bool processOnChangeConditionForUpdateContext
   ncr.originator.set("localhost");
 
   ncr.subscriptionId.set(subId);
+
+#ifdef ORIONLD
+  //
+  // Subscriptions with notification batching (NGSI-LD only) send the entity later, together with others
+  //
+  if ((httpInfo.batchMaxEntities > 0) && ((renderFormat == NGSI_LD_V1_NORMALIZED) || (renderFormat == NGSI_LD_V1_KEYVALUES)))
+  {
+    notificationBatchAddNcr(&ncr, subId, renderFormat, tenant, httpInfo);
+    return true;
+  }
+#endif
+
   getNotifier()->sendNotifyContextRequest(&ncr,
                                           httpInfo,
                                           tenant,
@@ -2013,6 +2108,102 @@ static void setDateModifiedMetadata(ContextElementResponse* notifyCerP)
 
 
 
+/* ****************************************************************************
+*
+* geoMatchInDb - does the entity match the geo-filter of the subscription, according to the DB?
+*
+* Looks in the database for the entity, with the geo-filter as part of the query. Note that
+* this query doesn't check any other filtering condition, assuming they are already checked
+* in other steps.
+*
+* Errors are interpreted as no-match (conservative approach)
+*/
+static bool geoMatchInDb(TriggeredSubscription* tSubP, ContextElementResponse* notifyCerP, const std::string& tenant)
+{
+  Scope        geoScope;
+  std::string  filterErr;
+
+  if (geoScope.fill(V2, tSubP->expression.geometry, tSubP->expression.coords, tSubP->expression.georel, &filterErr) != 0)
+  {
+    // This has been already checked at subscription creation/update parsing time. Thus, the code cannot reach
+    // this part.
+    //
+    // (Probably the whole if clause will disapear when the missing part of #1705 gets implemented,
+    // moving geo-stuff strings to a filter object in TriggeredSubscription class
+
+    LM_E(("Runtime Error (code cannot reach this point, error: %s)", filterErr.c_str()));
+    return false;
+  }
+
+  BSONObj areaFilter;
+  if (!processAreaScopeV2(&geoScope, &areaFilter))
+  {
+    return false;
+  }
+
+  std::string  keyId   = "_id." ENT_ENTITY_ID;
+  std::string  keyType = "_id." ENT_ENTITY_TYPE;
+  std::string  keySp   = "_id." ENT_SERVICE_PATH;
+  std::string  keyLoc  = ENT_LOCATION "." ENT_LOCATION_COORDS;
+  std::string  id      = notifyCerP->contextElement.entityId.id;
+  std::string  type    = notifyCerP->contextElement.entityId.type;
+  std::string  sp      = notifyCerP->contextElement.entityId.servicePath;
+  BSONObj      query   = BSON(keyId << id << keyType << type << keySp << sp << keyLoc << areaFilter);
+
+  unsigned long long n;
+  if (!collectionCount(getEntitiesCollectionName(tenant), query, &n, &filterErr))
+  {
+    return false;
+  }
+
+  // No result? Then no-match
+  return (n == 0)? false : true;
+}
+
+
+
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* entityGeometryGet - the location of the entity, for in-process evaluation of geo-filters
+*
+* false is returned if the location cannot be evaluated in-process: no location attribute,
+* more than one candidate (the DB knows which one is the location), or a location type that
+* orionld/geo doesn't handle (geo:line, geo:box, geo:polygon). The DB is then asked instead.
+*/
+static bool entityGeometryGet(ContextElementResponse* notifyCerP, OrionldGeometry* geoP)
+{
+  ContextAttributeVector*  caVP      = &notifyCerP->contextElement.contextAttributeVector;
+  ContextAttribute*        locationP = NULL;
+
+  for (unsigned int ix = 0; ix < caVP->size(); ++ix)
+  {
+    ContextAttribute* caP = (*caVP)[ix];
+
+    if ((caP->type != "GeoProperty") && (caP->getLocation(V2) == ""))
+    {
+      continue;
+    }
+
+    if (locationP != NULL)
+    {
+      return false;
+    }
+
+    locationP = caP;
+  }
+
+  if (locationP == NULL)
+  {
+    return false;
+  }
+
+  return geoGeometryFromAttribute(locationP, geoP);
+}
+#endif
+
+
+
 /* ****************************************************************************
 *
 * processSubscriptions - send a notification for each subscription in the map
@@ -2029,6 +2220,11 @@ static bool processSubscriptions
 {
   bool ret = true;
 
+#ifdef ORIONLD
+  OrionldGeometry  entityGeometry;
+  int              entityGeometryState = 0;  // 0: not looked up yet, 1: available, -1: not available
+#endif
+
   *err = "";
 
   for (std::map<std::string, TriggeredSubscription*>::iterator it = subs.begin(); it != subs.end(); ++it)
@@ -2069,52 +2265,31 @@ static bool processSubscriptions
     }
 
     /* Check 3: expression (georel, which also uses geometry and coords)
-     * This should be always the last check, as it is the most expensive one, given that it interacts with DB
-     * (Issue #2396 should solve that) */
+     * This should be always the last check, as it is the most expensive one.
+     * In orionld, the geo-filter is evaluated in-process whenever possible - the DB is asked otherwise */
     if ((tSubP->expression.georel != "") && (tSubP->expression.coords != "") && (tSubP->expression.geometry != ""))
     {
-      Scope        geoScope;
-      std::string  filterErr;
+      bool geoMatch;
 
-      if (geoScope.fill(V2, tSubP->expression.geometry, tSubP->expression.coords, tSubP->expression.georel, &filterErr) != 0)
+#ifdef ORIONLD
+      if ((tSubP->geoFilterP != NULL) && (entityGeometryState == 0))
       {
-        // This has been already checked at subscription creation/update parsing time. Thus, the code cannot reach
-        // this part.
-        //
-        // (Probably the whole if clause will disapear when the missing part of #1705 gets implemented,
-        // moving geo-stuff strings to a filter object in TriggeredSubscription class
-
-        LM_E(("Runtime Error (code cannot reach this point, error: %s)", filterErr.c_str()));
-        continue;
+        entityGeometryState = (entityGeometryGet(notifyCerP, &entityGeometry) == true)? 1 : -1;
       }
 
-      BSONObj areaFilter;
-      if (!processAreaScopeV2(&geoScope, &areaFilter))
+      if ((tSubP->geoFilterP != NULL) && (entityGeometryState == 1))
       {
-        // Error in processAreaScopeV2 is interpreted as no-match (conservative approach)
-        continue;
+        geoMatch = geoFilterMatch(tSubP->geoFilterP, &entityGeometry);
       }
-
-      // Look in the database of an entity that maches the geo-filters. Note that this query doesn't
-      // check any other filtering condition, assuming they are already checked in other steps.
-      std::string  keyId   = "_id." ENT_ENTITY_ID;
-      std::string  keyType = "_id." ENT_ENTITY_TYPE;
-      std::string  keySp   = "_id." ENT_SERVICE_PATH;
-      std::string  keyLoc  = ENT_LOCATION "." ENT_LOCATION_COORDS;
-      std::string  id      = notifyCerP->contextElement.entityId.id;
-      std::string  type    = notifyCerP->contextElement.entityId.type;
-      std::string  sp      = notifyCerP->contextElement.entityId.servicePath;
-      BSONObj      query   = BSON(keyId << id << keyType << type << keySp << sp << keyLoc << areaFilter);
-
-      unsigned long long n;
-      if (!collectionCount(getEntitiesCollectionName(tenant), query, &n, &filterErr))
+      else
       {
-        // Error in database access is interpreted as no-match (conservative approach)
-        continue;
+        geoMatch = geoMatchInDb(tSubP, notifyCerP, tenant);
       }
+#else
+      geoMatch = geoMatchInDb(tSubP, notifyCerP, tenant);
+#endif
 
-      // No result? Then no-match
-      if (n == 0)
+      if (geoMatch == false)
       {
         continue;
       }
@@ -2922,29 +3097,24 @@ static bool processContextAttributeVector
 
 /* ****************************************************************************
 *
-* createEntity -
+* entityDocBuild -
+*
+* Builds the document of a new entity, as it is to be inserted in the entities collection.
+* Used by createEntity() and by the bulk upsert of processContextElementVectorUpsert().
 */
-static bool createEntity
+static bool entityDocBuild
 (
   EntityId*                        eP,
   const ContextAttributeVector&    attrsV,
   int                              now,
   std::string*                     errDetail,
-  std::string                      tenant,
   const std::vector<std::string>&  servicePathV,
   ApiVersion                       apiVersion,
   const std::string&               fiwareCorrelator,
-  OrionError*                      oeP
+  OrionError*                      oeP,
+  BSONObjBuilder*                  insertedDocP
 )
 {
-  LM_T(LmtMongo, ("Entity not found in '%s' collection, creating it", getEntitiesCollectionName(tenant).c_str()));
-
-  /* Actually we don't know if this is the first entity (thus, the collection is being created) or not. However, we can
-   * invoke ensureLocationIndex() in anycase, given that it is harmless in the case the collection and index already
-   * exist (see docs.mongodb.org/manual/reference/method/db.collection.ensureIndex/) */
-  ensureLocationIndex(tenant);
-  ensureDateExpirationIndex(tenant);
-
   if (!legalIdUsage(attrsV))
   {
     *errDetail =
@@ -3049,7 +3219,7 @@ static bool createEntity
 
   bsonId.append(ENT_SERVICE_PATH, servicePathV[0] == ""? SERVICE_PATH_ROOT : servicePathV[0]);
 
-  BSONObjBuilder insertedDoc;
+  BSONObjBuilder& insertedDoc = *insertedDocP;
 
   insertedDoc.append("_id", bsonId.obj());
   insertedDoc.append(ENT_ATTRNAMES, attrNamesToAdd.arr());
@@ -3063,6 +3233,8 @@ static bool createEntity
     eP->creDate = (double) savedCreDateP->value.i;
     insertedDoc.append(ENT_CREATION_DATE, eP->creDate);
   }
+  else if (eP->creDate != 0)
+    insertedDoc.append(ENT_CREATION_DATE, eP->creDate);
   else
     insertedDoc.append(ENT_CREATION_DATE, now);
 #else
@@ -3107,6 +3279,43 @@ static bool createEntity
   // Correlator (for notification loop detection logic)
   insertedDoc.append(ENT_LAST_CORRELATOR, fiwareCorrelator);
 
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* createEntity -
+*/
+static bool createEntity
+(
+  EntityId*                        eP,
+  const ContextAttributeVector&    attrsV,
+  int                              now,
+  std::string*                     errDetail,
+  std::string                      tenant,
+  const std::vector<std::string>&  servicePathV,
+  ApiVersion                       apiVersion,
+  const std::string&               fiwareCorrelator,
+  OrionError*                      oeP
+)
+{
+  LM_T(LmtMongo, ("Entity not found in '%s' collection, creating it", getEntitiesCollectionName(tenant).c_str()));
+
+  /* Actually we don't know if this is the first entity (thus, the collection is being created) or not. However, we can
+   * invoke ensureLocationIndex() in anycase, given that it is harmless in the case the collection and index already
+   * exist (see docs.mongodb.org/manual/reference/method/db.collection.ensureIndex/) */
+  ensureLocationIndex(tenant);
+  ensureDateExpirationIndex(tenant);
+
+  BSONObjBuilder insertedDoc;
+
+  if (!entityDocBuild(eP, attrsV, now, errDetail, servicePathV, apiVersion, fiwareCorrelator, oeP, &insertedDoc))
+  {
+    return false;
+  }
+
   if (!collectionInsert(getEntitiesCollectionName(tenant), insertedDoc.obj(), errDetail))
   {
     LM_E(("Internal Error (%s)", errDetail->c_str()));
@@ -3727,6 +3936,78 @@ static void setActionType(ContextElementResponse* notifyCerP, const std::string&
 
 
 
+/* ****************************************************************************
+*
+* entityCreationNotify -
+*
+* Sends the notifications triggered by the creation of the entity in 'ceP'
+*/
+static bool entityCreationNotify
+(
+  ContextElement*                  ceP,
+  int                              now,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion,
+  std::string*                     errP
+)
+{
+  EntityId*                                      enP = &ceP->entityId;
+  std::map<std::string, TriggeredSubscription*>  subsToNotify;
+  std::vector<std::string>                       attrNames;
+  std::string                                    errReason;
+
+  for (unsigned int ix = 0; ix < ceP->contextAttributeVector.size(); ++ix)
+  {
+    attrNames.push_back(ceP->contextAttributeVector[ix]->name);
+  }
+
+  if (!addTriggeredSubscriptions(enP->id,
+                                 enP->type,
+                                 attrNames,
+                                 subsToNotify,
+                                 *errP,
+                                 tenant,
+                                 servicePathV))
+  {
+    releaseTriggeredSubscriptions(&subsToNotify);
+    return false;
+  }
+
+  //
+  // Build CER used for notifying (if needed). Service Path vector shouldn't have more than
+  // one item, so it should be safe to get item 0
+  //
+  ContextElementResponse* notifyCerP = new ContextElementResponse(ceP, apiVersion == V2);
+
+  // Set action type
+  setActionType(notifyCerP, NGSI_MD_ACTIONTYPE_APPEND);
+
+  // Set creDate and modDate times
+  notifyCerP->contextElement.entityId.creDate = now;
+  notifyCerP->contextElement.entityId.modDate = now;
+
+  for (unsigned int ix = 0; ix < notifyCerP->contextElement.contextAttributeVector.size(); ix++)
+  {
+    ContextAttribute* caP = notifyCerP->contextElement.contextAttributeVector[ix];
+    caP->creDate = now;
+    caP->modDate = now;
+  }
+
+  notifyCerP->contextElement.entityId.servicePath = servicePathV.size() > 0? servicePathV[0] : "";
+  processSubscriptions(subsToNotify, notifyCerP, &errReason, tenant, xauthToken, fiwareCorrelator);
+
+  notifyCerP->release();
+  delete notifyCerP;
+  releaseTriggeredSubscriptions(&subsToNotify);
+
+  return true;
+}
+
+
+
 /* ****************************************************************************
 *
 * processContextElement -
@@ -3979,7 +4260,6 @@ void processContextElement
     }
     else   /* APPEND or APPEND_STRICT */
     {
-      std::string  errReason;
       std::string  errDetail;
       int          now = getCurrentTime();
 
@@ -3994,56 +4274,14 @@ void processContextElement
         cerP->statusCode.fill(SccOk);
 
         /* Successful creation: send potential notifications */
-        std::map<std::string, TriggeredSubscription*>  subsToNotify;
-        std::vector<std::string>                       attrNames;
-
-        for (unsigned int ix = 0; ix < ceP->contextAttributeVector.size(); ++ix)
-        {
-          attrNames.push_back(ceP->contextAttributeVector[ix]->name);
-        }
-
-        if (!addTriggeredSubscriptions(enP->id,
-                                       enP->type,
-                                       attrNames,
-                                       subsToNotify,
-                                       err,
-                                       tenant,
-                                       servicePathV))
+        if (!entityCreationNotify(ceP, now, tenant, servicePathV, xauthToken, fiwareCorrelator, apiVersion, &err))
         {
-          releaseTriggeredSubscriptions(&subsToNotify);
           cerP->statusCode.fill(SccReceiverInternalError, err);
           responseP->oe.fill(SccReceiverInternalError, err, "InternalError");
 
           responseP->contextElementResponseVector.push_back(cerP);
           return;  // Error already in responseP
         }
-
-        //
-        // Build CER used for notifying (if needed). Service Path vector shouldn't have more than
-        // one item, so it should be safe to get item 0
-        //
-        ContextElementResponse* notifyCerP = new ContextElementResponse(ceP, apiVersion == V2);
-
-        // Set action type
-        setActionType(notifyCerP, NGSI_MD_ACTIONTYPE_APPEND);
-
-        // Set creDate and modDate times
-        notifyCerP->contextElement.entityId.creDate = now;
-        notifyCerP->contextElement.entityId.modDate = now;
-
-        for (unsigned int ix = 0; ix < notifyCerP->contextElement.contextAttributeVector.size(); ix++)
-        {
-          ContextAttribute* caP = notifyCerP->contextElement.contextAttributeVector[ix];
-          caP->creDate = now;
-          caP->modDate = now;
-        }
-
-        notifyCerP->contextElement.entityId.servicePath = servicePathV.size() > 0? servicePathV[0] : "";
-        processSubscriptions(subsToNotify, notifyCerP, &errReason, tenant, xauthToken, fiwareCorrelator);
-
-        notifyCerP->release();
-        delete notifyCerP;
-        releaseTriggeredSubscriptions(&subsToNotify);
       }
 
       responseP->contextElementResponseVector.push_back(cerP);
@@ -4059,3 +4297,538 @@ void processContextElement
 
   // Response in responseP
 }
+
+
+
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* processContextElementVectorUpsert -
+*
+* Creates or replaces all the entities in 'ceVP' with ONE unordered bulk write of replace/upsert
+* operations, instead of looking up and writing the entities one by one (processContextElement).
+*
+* The creation date of an already existing entity must be given in the EntityId::creDate of its
+* ContextElement - it is preserved in the replaced document. Also its stored service path must be given in
+* EntityId::servicePath (and its stored type in EntityId::type), as the _id of an existing document cannot
+* change - a non-empty EntityId::servicePath is what tells an existing entity from a new one.
+* The filter of each replace operation is the full _id of the document. geoPropertyV (if non-NULL) holds the
+* GeoProperty attribute of each entity in 'ceVP' (same index, NULL for entities without location).
+*
+* One ContextElementResponse per entity is added to responseP, with the outcome of the entity.
+*/
+void processContextElementVectorUpsert
+(
+  ContextElementVector*            ceVP,
+  KjNode**                         geoPropertyV,
+  UpdateContextResponse*           responseP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion
+)
+{
+  int                                   now = getCurrentTime();
+  std::vector<BSONObj>                  filterV;
+  std::vector<BSONObj>                  docV;
+  std::vector<ContextElement*>          ceInBulkV;    // ceInBulkV[ix] is the entity of docV[ix]
+  std::vector<ContextElementResponse*>  cerInBulkV;   // cerInBulkV[ix] is the response item of docV[ix]
+  std::vector<std::string>              docErrorV;
+  std::string                           err;
+
+  ensureLocationIndex(tenant);
+  ensureDateExpirationIndex(tenant);
+
+  for (unsigned int ix = 0; ix < ceVP->size(); ++ix)
+  {
+    ContextElement*          ceP  = (*ceVP)[ix];
+    ContextElementResponse*  cerP = new ContextElementResponse();
+    BSONObjBuilder           doc;
+    std::string              errDetail;
+    OrionError               oe;
+
+    cerP->contextElement.entityId.fill(ceP->entityId.id, ceP->entityId.type, "false");
+    responseP->contextElementResponseVector.push_back(cerP);
+
+    // entityDocBuild takes the location from orionldState
+    orionldState.locationAttributeP = (geoPropertyV != NULL)? geoPropertyV[ix] : NULL;
+
+    //
+    // An already existing entity keeps the service path of its _id
+    //
+    std::vector<std::string>  storedServicePathV(1, ceP->entityId.servicePath);
+    bool                      entityExists = (ceP->entityId.servicePath != "");
+
+    if (!entityDocBuild(&ceP->entityId, ceP->contextAttributeVector, now, &errDetail, (entityExists == true)? storedServicePathV : servicePathV, apiVersion, fiwareCorrelator, &oe, &doc))
+    {
+      cerP->statusCode.fill(SccInvalidParameter, (errDetail != "")? errDetail : oe.details);
+      continue;
+    }
+
+    BSONObj docObj = doc.obj();
+
+    filterV.push_back(BSON("_id" << docObj.getObjectField("_id")));
+    docV.push_back(docObj);
+    ceInBulkV.push_back(ceP);
+    cerInBulkV.push_back(cerP);
+  }
+
+  orionldState.locationAttributeP = NULL;
+
+  if (!collectionBulkReplace(getEntitiesCollectionName(tenant), filterV, docV, &docErrorV, &err))
+  {
+    LM_E(("Database Error (%s)", err.c_str()));
+
+    for (unsigned int ix = 0; ix < cerInBulkV.size(); ++ix)
+    {
+      cerInBulkV[ix]->statusCode.fill(SccReceiverInternalError, err);
+    }
+
+    responseP->oe.fill(SccReceiverInternalError, err, "InternalServerError");
+    return;
+  }
+
+  for (unsigned int ix = 0; ix < cerInBulkV.size(); ++ix)
+  {
+    ContextElementResponse* cerP = cerInBulkV[ix];
+
+    if (docErrorV[ix] != "")
+    {
+      LM_W(("Database Error (upsert of entity '%s': %s)", ceInBulkV[ix]->entityId.id.c_str(), docErrorV[ix].c_str()));
+      cerP->statusCode.fill(SccReceiverInternalError, docErrorV[ix]);
+      continue;
+    }
+
+    cerP->statusCode.fill(SccOk);
+
+    /* Successful creation/replacement: send potential notifications */
+    if (!entityCreationNotify(ceInBulkV[ix], now, tenant, servicePathV, xauthToken, fiwareCorrelator, apiVersion, &err))
+    {
+      cerP->statusCode.fill(SccReceiverInternalError, err);
+      responseP->oe.fill(SccReceiverInternalError, err, "InternalError");
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* processContextElementCreate -
+*
+* Creates the entity of 'ceP' with a count and an insert. Unlike processContextElement (APPEND), the entity
+* is not queried - an index-backed count on the entity id (see ensureEntityIndexes) tells whether an entity
+* with the same id already exists, whatever its type. An entity with the same id, type and service path that
+* is created meanwhile is detected by the duplicate key error of the insert. SccConflict is returned in both cases.
+*
+* On error, oeP is filled and its code is returned. SccOk is returned if the entity was created.
+*/
+HttpStatusCode processContextElementCreate
+(
+  ContextElement*                  ceP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion,
+  OrionError*                      oeP
+)
+{
+  EntityId*       enP          = &ceP->entityId;
+  int             now          = getCurrentTime();
+  bool            duplicateKey = false;
+  BSONObjBuilder  doc;
+  std::string     errDetail;
+  std::string     err;
+
+  unsigned long long count = 0;
+
+  ensureEntityIndexes(tenant);
+
+  //
+  // In NGSI-LD the entity id is unique, regardless of the entity type
+  //
+  if (!collectionCount(getEntitiesCollectionName(tenant), BSON("_id." ENT_ENTITY_ID << enP->id), &count, &err))
+  {
+    oeP->fill(SccReceiverInternalError, err, "InternalError");
+    return SccReceiverInternalError;
+  }
+
+  if (count != 0)
+  {
+    oeP->fill(SccConflict, enP->id, "AlreadyExists");
+    return SccConflict;
+  }
+
+  if (!entityDocBuild(enP, ceP->contextAttributeVector, now, &errDetail, servicePathV, apiVersion, fiwareCorrelator, oeP, &doc))
+  {
+    // oeP->fill() already managed by entityDocBuild()
+    return oeP->code;
+  }
+
+  if (!collectionInsert(getEntitiesCollectionName(tenant), doc.obj(), &errDetail, &duplicateKey))
+  {
+    if (duplicateKey == true)
+    {
+      oeP->fill(SccConflict, enP->id, "AlreadyExists");
+      return SccConflict;
+    }
+
+    LM_E(("Internal Error (%s)", errDetail.c_str()));
+    oeP->fill(SccReceiverInternalError, errDetail, "InternalError");
+    return SccReceiverInternalError;
+  }
+
+  /* Successful creation: send potential notifications */
+  if (!entityCreationNotify(ceP, now, tenant, servicePathV, xauthToken, fiwareCorrelator, apiVersion, &err))
+  {
+    LM_E(("Internal Error (notifying the creation of entity '%s': %s)", enP->id.c_str(), err.c_str()));
+  }
+
+  return SccOk;
+}
+
+
+
+/* ****************************************************************************
+*
+* attributesReplaceUpdateBuild -
+*
+* Builds the update of processContextElementAttributesReplace: a $set of the fields of each attribute
+* (field by field, so that the creation date of the attribute is kept), of modDate and of the location (if
+* the GeoProperty of the request is one of the attributes), plus the projection that gives back the
+* previous values of the attributes.
+*/
+static bool attributesReplaceUpdateBuild
+(
+  ContextElement*     ceP,
+  int                 now,
+  const std::string&  fiwareCorrelator,
+  ApiVersion          apiVersion,
+  BSONObj*            updateP,
+  BSONObj*            fieldsP,
+  BSONArray*          attrNamesP,
+  OrionError*         oeP
+)
+{
+  BSONObjBuilder    toSet;
+  BSONObjBuilder    toUnset;
+  BSONObjBuilder    fields;
+  BSONArrayBuilder  attrNames;
+  bool              locationReplaced = false;
+
+  fields.append("_id", 1);
+  fields.append(ENT_ATTRNAMES, 1);
+  fields.append(ENT_CREATION_DATE, 1);
+  fields.append(ENT_MODIFICATION_DATE, 1);
+
+  for (unsigned int ix = 0; ix < ceP->contextAttributeVector.size(); ++ix)
+  {
+    ContextAttribute*  caP    = ceP->contextAttributeVector[ix];
+    std::string        prefix = std::string(ENT_ATTRS) + "." + dbDotEncode(caP->name);
+    BSONObjBuilder     bsonAttr;
+    BSONObj            md;
+    BSONArray          mdNames;
+
+    bsonAttr.append(ENT_ATTRS_TYPE, caP->type);
+    bsonAttr.append(ENT_ATTRS_MODIFICATION_DATE, now);
+
+    caP->valueBson(bsonAttr, caP->type, ngsiv1Autocast && (apiVersion == V1));
+
+    if (contextAttributeCustomMetadataToBson(&md, &mdNames, caP, apiVersion == V2))
+    {
+      bsonAttr.append(ENT_ATTRS_MD, md);
+    }
+    else
+    {
+      toUnset.append(prefix + "." ENT_ATTRS_MD, 1);
+    }
+    bsonAttr.append(ENT_ATTRS_MDNAMES, mdNames);
+
+    BSONObj attr = bsonAttr.obj();
+
+    for (BSONObj::iterator iter = attr.begin(); iter.more();)
+    {
+      BSONElement e = iter.next();
+
+      toSet.appendAs(e, prefix + "." + e.fieldName());
+    }
+
+    fields.append(prefix, 1);
+    attrNames.append(caP->name);
+
+    if ((orionldState.locationAttributeP != NULL) && (caP->name == orionldState.locationAttributeP->name))
+    {
+      locationReplaced = true;
+    }
+  }
+
+  toSet.append(ENT_MODIFICATION_DATE, now);
+  toSet.append(ENT_LAST_CORRELATOR, fiwareCorrelator);
+
+  if (locationReplaced == true)
+  {
+    BSONObjBuilder  geoJson;
+    char*           errorString;
+
+    if (geoJsonCreate(orionldState.locationAttributeP, &geoJson, &errorString) == false)
+    {
+      LM_E(("Internal Error (%s)", errorString));
+      oeP->fill(SccReceiverInternalError, errorString, "InternalError");
+      return false;
+    }
+
+    toSet.append(ENT_LOCATION, BSON(ENT_LOCATION_ATTRNAME << orionldState.locationAttributeP->name <<
+                                    ENT_LOCATION_COORDS   << geoJson.obj()));
+  }
+
+  BSONObjBuilder  update;
+  BSONObj         toUnsetObj = toUnset.obj();
+
+  update.append("$set", toSet.obj());
+
+  if (toUnsetObj.nFields() > 0)
+  {
+    update.append("$unset", toUnsetObj);
+  }
+
+  *updateP    = update.obj();
+  *fieldsP    = fields.obj();
+  *attrNamesP = attrNames.arr();
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* entityPreviousAttributesMerge -
+*
+* Returns the entity document 'entityDoc' with the attributes found in 'previousDoc' (the projection
+* returned by findAndModify) put back - i.e. the entity as it was before the update.
+*/
+static BSONObj entityPreviousAttributesMerge(const BSONObj& entityDoc, const BSONObj& previousDoc)
+{
+  BSONObj         attrs         = getObjectFieldF(entityDoc, ENT_ATTRS);
+  BSONObj         previousAttrs = getObjectFieldF(previousDoc, ENT_ATTRS);
+  BSONObjBuilder  merged;
+  BSONObjBuilder  mergedAttrs;
+
+  for (BSONObj::iterator iter = entityDoc.begin(); iter.more();)
+  {
+    BSONElement e = iter.next();
+
+    if (strcmp(e.fieldName(), ENT_ATTRS) != 0)
+    {
+      merged.append(e);
+    }
+  }
+
+  for (BSONObj::iterator iter = attrs.begin(); iter.more();)
+  {
+    BSONElement e = iter.next();
+
+    if (previousAttrs.hasField(e.fieldName()))
+    {
+      mergedAttrs.append(previousAttrs.getField(e.fieldName()));
+    }
+    else
+    {
+      mergedAttrs.append(e);
+    }
+  }
+
+  merged.append(ENT_ATTRS, mergedAttrs.obj());
+
+  return merged.obj();
+}
+
+
+
+/* ****************************************************************************
+*
+* processContextElementAttributesReplace -
+*
+* Replaces the attributes of 'ceP' in the entity ceP->entityId.id with ONE findAndModify, instead of
+* reading the entire entity and writing it back (processContextElement). Only the replaced attributes,
+* modDate and (if replaced) the location are written, and only the previous values of the replaced
+* attributes are returned by the database.
+*
+* The attributes must exist - those that don't are removed from 'ceP', their names are added to
+* 'notFoundV' and the rest of the attributes are replaced.
+* The entire entity is read only if the update triggers any subscription, as notifications carry the
+* entire entity.
+*
+* Returns SccOk, SccContextElementNotFound if the entity doesn't exist, or the error (also in oeP).
+*/
+HttpStatusCode processContextElementAttributesReplace
+(
+  ContextElement*                  ceP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion,
+  std::vector<std::string>*        notFoundV,
+  OrionError*                      oeP
+)
+{
+  EntityId*    enP         = &ceP->entityId;
+  int          now         = getCurrentTime();
+  std::string  collection  = getEntitiesCollectionName(tenant);
+  BSONObj      entityQuery = BSON("_id." ENT_ENTITY_ID << enP->id << "_id." ENT_SERVICE_PATH << fillQueryServicePath(servicePathV));
+  BSONObj      previousDoc;
+  std::string  err;
+
+  //
+  // The attributes that don't exist are detected by the conditional filter ($all on attrNames).
+  // If it doesn't match, the entity is looked up to find out what is missing and the update is retried
+  // with the attributes that exist - only once, as the entity has been looked up.
+  //
+  for (int attempt = 0; attempt < 2; ++attempt)
+  {
+    BSONObj    update;
+    BSONObj    fields;
+    BSONArray  attrNames;
+
+    if (ceP->contextAttributeVector.size() == 0)
+    {
+      if (attempt == 1)
+      {
+        // The entity has been looked up - it exists but has none of the attributes
+        return SccOk;
+      }
+
+      // Nothing to replace - but a non-existing entity is still an error
+      unsigned long long count = 0;
+
+      if (!collectionCount(collection, entityQuery, &count, &err))
+      {
+        oeP->fill(SccReceiverInternalError, err, "InternalError");
+        return SccReceiverInternalError;
+      }
+
+      if (count == 0)
+      {
+        oeP->fill(SccContextElementNotFound, enP->id, "NotFound");
+        return SccContextElementNotFound;
+      }
+
+      return SccOk;
+    }
+
+    if (!attributesReplaceUpdateBuild(ceP, now, fiwareCorrelator, apiVersion, &update, &fields, &attrNames, oeP))
+    {
+      return oeP->code;
+    }
+
+    BSONObjBuilder query;
+
+    query.appendElements(entityQuery);
+    query.append(ENT_ATTRNAMES, BSON("$all" << attrNames));
+
+    if (!collectionFindAndModify(collection, query.obj(), update, fields, &previousDoc, &err))
+    {
+      oeP->fill(SccReceiverInternalError, err, "InternalError");
+      return SccReceiverInternalError;
+    }
+
+    if (!previousDoc.isEmpty())
+    {
+      break;
+    }
+
+    if (attempt == 1)
+    {
+      // The entity was modified between the lookup and the retry
+      oeP->fill(SccConflict, enP->id, "Conflict");
+      return SccConflict;
+    }
+
+    BSONObj entityDoc;
+
+    if (!collectionFindOne(collection, entityQuery, &entityDoc, &err))
+    {
+      oeP->fill(SccReceiverInternalError, err, "InternalError");
+      return SccReceiverInternalError;
+    }
+
+    if (entityDoc.isEmpty())
+    {
+      oeP->fill(SccContextElementNotFound, enP->id, "NotFound");
+      return SccContextElementNotFound;
+    }
+
+    BSONObj attrs = getObjectFieldF(entityDoc, ENT_ATTRS);
+
+    for (int ix = ceP->contextAttributeVector.size() - 1; ix >= 0; --ix)
+    {
+      ContextAttribute* caP = ceP->contextAttributeVector[ix];
+
+      if (!attrs.hasField(dbDotEncode(caP->name)))
+      {
+        notFoundV->push_back(caP->name);
+        caP->release();
+        delete caP;
+        ceP->contextAttributeVector.vec.erase(ceP->contextAttributeVector.vec.begin() + ix);
+      }
+    }
+  }
+
+  //
+  // The update is done - now the notifications
+  //
+  BSONObj                                        idField    = getObjectFieldF(previousDoc, "_id");
+  std::string                                    entityType = idField.hasField(ENT_ENTITY_TYPE)? getStringFieldF(idField, ENT_ENTITY_TYPE) : "";
+  std::vector<std::string>                       attrNames;
+  std::map<std::string, TriggeredSubscription*>  subsToNotify;
+
+  for (unsigned int ix = 0; ix < ceP->contextAttributeVector.size(); ++ix)
+  {
+    attrNames.push_back(ceP->contextAttributeVector[ix]->name);
+  }
+
+  if (!addTriggeredSubscriptions(enP->id, entityType, attrNames, subsToNotify, err, tenant, servicePathV))
+  {
+    LM_E(("Internal Error (looking up the subscriptions of entity '%s': %s)", enP->id.c_str(), err.c_str()));
+    releaseTriggeredSubscriptions(&subsToNotify);
+    return SccOk;
+  }
+
+  if (subsToNotify.size() == 0)
+  {
+    return SccOk;
+  }
+
+  BSONObj entityDoc;
+
+  if ((!collectionFindOne(collection, entityQuery, &entityDoc, &err)) || (entityDoc.isEmpty()))
+  {
+    LM_E(("Internal Error (reading entity '%s' for notifications: %s)", enP->id.c_str(), err.c_str()));
+    releaseTriggeredSubscriptions(&subsToNotify);
+    return SccOk;
+  }
+
+  // Build CER used for notifying, from the entity as it was before the update - updateAttrInNotifyCer sets the new values
+  StringList               emptyAttrL;
+  ContextElementResponse*  notifyCerP = new ContextElementResponse(entityPreviousAttributesMerge(entityDoc, previousDoc), emptyAttrL);
+
+  notifyCerP->contextElement.entityId.creDate = previousDoc.hasField(ENT_CREATION_DATE)? getIntOrLongFieldAsLongF(previousDoc, ENT_CREATION_DATE) : -1;
+  notifyCerP->contextElement.entityId.modDate = now;
+
+  for (unsigned int ix = 0; ix < ceP->contextAttributeVector.size(); ++ix)
+  {
+    updateAttrInNotifyCer(notifyCerP, ceP->contextAttributeVector[ix], apiVersion == V2, NGSI_MD_ACTIONTYPE_UPDATE);
+  }
+
+  processSubscriptions(subsToNotify, notifyCerP, &err, tenant, xauthToken, fiwareCorrelator);
+
+  notifyCerP->release();
+  delete notifyCerP;
+  releaseTriggeredSubscriptions(&subsToNotify);
+
+  return SccOk;
+}
+#endif
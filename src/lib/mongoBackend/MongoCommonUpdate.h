@@ -31,8 +31,18 @@
 
 #include "mongo/client/dbclient.h"
 
+#ifdef ORIONLD
+extern "C"
+{
+#include "kjson/KjNode.h"                                      // KjNode
+}
+#endif
+
 #include "orionTypes/UpdateActionType.h"
+#include "ngsi/ContextElementVector.h"
 #include "ngsi10/UpdateContextResponse.h"
+#include "rest/HttpStatusCode.h"
+#include "rest/OrionError.h"
 
 
 
@@ -55,4 +65,58 @@ extern void processContextElement
   Ngsiv2Flavour                        ngsiV2Flavour    = NGSIV2_NO_FLAVOUR
 );
 
+
+
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* processContextElementVectorUpsert -
+*/
+extern void processContextElementVectorUpsert
+(
+  ContextElementVector*            ceVP,
+  KjNode**                         geoPropertyV,
+  UpdateContextResponse*           responseP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion
+);
+
+
+/* ****************************************************************************
+*
+* processContextElementCreate -
+*/
+extern HttpStatusCode processContextElementCreate
+(
+  ContextElement*                  ceP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion,
+  OrionError*                      oeP
+);
+
+
+
+/* ****************************************************************************
+*
+* processContextElementAttributesReplace -
+*/
+extern HttpStatusCode processContextElementAttributesReplace
+(
+  ContextElement*                  ceP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion,
+  std::vector<std::string>*        notFoundV,
+  OrionError*                      oeP
+);
+#endif
+
 #endif  // SRC_LIB_MONGOBACKEND_MONGOCOMMONUPDATE_H_
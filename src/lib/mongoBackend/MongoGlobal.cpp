@@ -24,6 +24,7 @@
 */
 #include <stdint.h>   // int64_t et al
 #include <semaphore.h>
+#include <pthread.h>
 #include <regex.h>
 
 #include <string>
@@ -728,6 +729,71 @@ void ensureDateExpirationIndex(const std::string& tenant)
     LM_T(LmtMongo, ("ensuring TTL date expiration index on %s (tenant %s)", index.c_str(), tenant.c_str()));
   }
 }
+
+
+
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* ensureEntityIndexes -
+*
+* Ensures the location and date expiration indexes, plus the entity id and query sort indexes, in the entities
+* collection of the tenant. Unlike ensureLocationIndex/ensureDateExpirationIndex, the indexes are created
+* only the first time a tenant is seen, so that creating an entity doesn't cost extra round trips to the
+* database.
+*
+* The index on the entity id is NOT unique - the entities collection is shared with NGSIv2, where the same
+* id with different types is legal. It makes the existence check of processContextElementCreate an index
+* lookup.
+*
+* The compound index { creDate: 1, _id.id: 1, _id.type: 1 } is the sort order of the NGSI-LD entity queries
+* (see mongoCppLegacyEntitiesQuery). With it, the keyset pagination of a query is an index range scan,
+* instead of an in-memory sort of all the matching entities for each and every page.
+*
+* A failure is not remembered - the indexes are attempted again for the next entity of the tenant.
+* false is returned if any of the indexes could not be created.
+*/
+bool ensureEntityIndexes(const std::string& tenant)
+{
+  static pthread_mutex_t         tenantMutex = PTHREAD_MUTEX_INITIALIZER;
+  static std::set<std::string>   indexedTenants;
+  bool                           ok          = true;
+
+  pthread_mutex_lock(&tenantMutex);
+
+  if (indexedTenants.find(tenant) == indexedTenants.end())
+  {
+    std::string err;
+
+    ensureLocationIndex(tenant);
+    ensureDateExpirationIndex(tenant);
+
+    ok = collectionCreateIndex(getEntitiesCollectionName(tenant), BSON("_id." ENT_ENTITY_ID << 1), false, &err);
+    if (ok == false)
+    {
+      LM_W(("Unable to create the index on the entity id (tenant '%s'): %s", tenant.c_str(), err.c_str()));
+    }
+
+    if (collectionCreateIndex(getEntitiesCollectionName(tenant),
+                              BSON(ENT_CREATION_DATE << 1 << "_id." ENT_ENTITY_ID << 1 << "_id." ENT_ENTITY_TYPE << 1),
+                              false,
+                              &err) == false)
+    {
+      LM_W(("Unable to create the query sort index on creDate/id/type (tenant '%s'): %s", tenant.c_str(), err.c_str()));
+      ok = false;
+    }
+
+    if (ok == true)
+    {
+      indexedTenants.insert(tenant);
+    }
+  }
+
+  pthread_mutex_unlock(&tenantMutex);
+
+  return ok;
+}
+#endif
 /* ****************************************************************************
 *
 * matchEntity -
@@ -289,6 +289,16 @@ extern void ensureDateExpirationIndex(const std::string& tenant);
 
 
 
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* ensureEntityIndexes -
+*/
+extern bool ensureEntityIndexes(const std::string& tenant);
+#endif
+
+
+
 /* ****************************************************************************
 *
 * matchEntity -
@@ -31,6 +31,11 @@
 #include "common/RenderFormat.h"
 #include "mongoBackend/TriggeredSubscription.h"
 
+#ifdef ORIONLD
+#include "orionld/types/OrionldGeoFilter.h"
+#include "orionld/geo/geoFilterParse.h"
+#endif
+
 
 
 /* ****************************************************************************
@@ -59,6 +64,9 @@ TriggeredSubscription::TriggeredSubscription
   mdStringFilterP(NULL),
   blacklist(false)
 {
+#ifdef ORIONLD
+  geoFilterP = NULL;
+#endif
 }
 
 
@@ -87,6 +95,9 @@ TriggeredSubscription::TriggeredSubscription
   mdStringFilterP(NULL),
   blacklist(false)
 {
+#ifdef ORIONLD
+  geoFilterP = NULL;
+#endif
 }
 
 
@@ -108,6 +119,14 @@ TriggeredSubscription::~TriggeredSubscription()
     delete mdStringFilterP;
     mdStringFilterP = NULL;
   }
+
+#ifdef ORIONLD
+  if (geoFilterP != NULL)
+  {
+    delete geoFilterP;
+    geoFilterP = NULL;
+  }
+#endif
 }
 
 
@@ -133,6 +152,45 @@ void TriggeredSubscription::fillExpression
 }
 
 
+
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* TriggeredSubscription::geoFilterSet -
+*
+* Must be called after fillExpression.
+*
+* The geo-filter parsed by the subscription cache is copied, as the cached subscription
+* may be freed (by a cache refresh) before the notification is sent.
+* Without cached geo-filter (noCache mode), the expression is parsed here.
+* If there is no geo-filter to set, geoFilterP stays NULL and the expression, if any,
+* is evaluated in the database.
+*/
+void TriggeredSubscription::geoFilterSet(const OrionldGeoFilter* cachedGeoFilterP)
+{
+  if (cachedGeoFilterP != NULL)
+  {
+    geoFilterP = new OrionldGeoFilter(*cachedGeoFilterP);
+    return;
+  }
+
+  if ((expression.georel == "") || (expression.geometry == "") || (expression.coords == ""))
+    return;
+
+  char* detail = NULL;
+
+  geoFilterP = new OrionldGeoFilter();
+  if (geoFilterParse(expression.geometry, expression.coords, expression.georel, geoFilterP, &detail) == false)
+  {
+    LM_W(("Unable to parse geo-filter of subscription (%s) - evaluating it in the database", detail));
+    delete geoFilterP;
+    geoFilterP = NULL;
+  }
+}
+#endif
+
+
+
 /* ****************************************************************************
 *
 * TriggeredSubscription::toString -
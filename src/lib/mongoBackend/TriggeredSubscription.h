@@ -33,6 +33,10 @@
 #include "ngsi/StringList.h"
 #include "rest/StringFilter.h"
 
+#ifdef ORIONLD
+#include "orionld/types/OrionldGeoFilter.h"
+#endif
+
 
 
 /* ****************************************************************************
@@ -71,6 +75,10 @@ class TriggeredSubscription
     std::string               georel;
   }                        expression;      // Only used by NGSIv2 subscription
 
+#ifdef ORIONLD
+  OrionldGeoFilter*         geoFilterP;      // 'expression' parsed - NULL if no geo-filter or if it must be evaluated in the DB
+#endif
+
   TriggeredSubscription(long long                _throttling,
                         long long                _lastNotification,
                         RenderFormat             _renderFormat,
@@ -89,6 +97,9 @@ class TriggeredSubscription
   void         fillExpression(const std::string& georel, const std::string& geometry, const std::string& coords);
   bool         stringFilterSet(StringFilter* _stringFilterP, std::string* errorStringP);
   bool         mdStringFilterSet(StringFilter* _stringFilterP, std::string* errorStringP);
+#ifdef ORIONLD
+  void         geoFilterSet(const OrionldGeoFilter* cachedGeoFilterP);
+#endif
   std::string  toString(const std::string& delimiter);
 };
 
@@ -23,6 +23,7 @@
 * Author: Fermín Galán
 */
 #include <string>
+#include <vector>
 
 #include "mongo/client/dbclient.h"
 #include "mongo/client/index_spec.h"
@@ -49,6 +50,8 @@ using mongo::BSONObj;
 using mongo::DBException;
 using mongo::Query;
 using mongo::WriteConcern;
+using mongo::WriteResult;
+using mongo::BulkOperationBuilder;
 
 
 
@@ -205,6 +208,51 @@ bool collectionRangedQuery
 
 
 
+/* ****************************************************************************
+*
+* collectionRangedCount -
+*
+* Count for paginated listings, using a connection already taken by the caller.
+*
+* If 'estimated' is true, the count stops at ESTIMATED_COUNT_MAX matches, so its cost doesn't grow with
+* the size of the collection (a value of ESTIMATED_COUNT_MAX means 'at least ESTIMATED_COUNT_MAX').
+* Without filter, mongo serves the count from the collection metadata, so it is exact and cheap anyway.
+*/
+bool collectionRangedCount
+(
+  DBClientBase*       connection,
+  const std::string&  col,
+  const BSONObj&      filter,
+  bool                estimated,
+  long long*          count,
+  std::string*        err
+)
+{
+  int limit = ((estimated == true) && (filter.isEmpty() == false))? ESTIMATED_COUNT_MAX : 0;
+
+  LM_T(LmtMongo, ("count() in '%s' collection, limit %d: '%s'", col.c_str(), limit, filter.toString().c_str()));
+
+  try
+  {
+    *count = connection->count(col.c_str(), filter, 0, limit);
+  }
+  catch (const std::exception& e)
+  {
+    std::string msg = std::string("collection: ") + col.c_str() +
+      " - count(): " + filter.toString() +
+      " - exception: " + e.what();
+
+    *err = "Database Error (" + msg + ")";
+    alarmMgr.dbError(msg);
+
+    return false;
+  }
+
+  return true;
+}
+
+
+
 /* ****************************************************************************
 *
 * collectionCount -
@@ -344,12 +392,16 @@ bool collectionFindOne
 /* ****************************************************************************
 *
 * collectionInsert -
+*
+* If duplicateKeyP is non-NULL, a violation of a unique index (e.g. an already existing _id) is
+* reported in *duplicateKeyP instead of as a database error (no alarm is raised).
 */
 bool collectionInsert
 (
   const std::string&  col,
   const BSONObj&      doc,
-  std::string*        err
+  std::string*        err,
+  bool*               duplicateKeyP
 )
 {
   TIME_STAT_MONGO_WRITE_WAIT_START();
@@ -379,6 +431,16 @@ bool collectionInsert
     releaseMongoConnection(connection);
     TIME_STAT_MONGO_WRITE_WAIT_STOP();
 
+    const mongo::DBException* dbExceptionP = dynamic_cast<const mongo::DBException*>(&e);
+
+    if ((duplicateKeyP != NULL) && (dbExceptionP != NULL) && (dbExceptionP->getCode() == MONGO_DUPLICATE_KEY_ERROR))
+    {
+      *duplicateKeyP = true;
+      *err           = e.what();
+
+      return false;
+    }
+
     std::string msg = std::string("collection: ") + col.c_str() +
       " - insert(): " + doc.toString() +
       " - exception: " + e.what();
@@ -484,6 +546,188 @@ bool collectionUpdate
 
 
 
+/* ****************************************************************************
+*
+* collectionFindAndModify -
+*
+* Applies the update 'doc' to the first document matching 'q' and returns in 'result' the document
+* as it was BEFORE the update, projected by 'fields'. If no document matches, nothing is updated,
+* 'result' is left empty and true is returned - the caller tells "not found" by result->isEmpty().
+*/
+bool collectionFindAndModify
+(
+  const std::string&  col,
+  const BSONObj&      q,
+  const BSONObj&      doc,
+  const BSONObj&      fields,
+  BSONObj*            result,
+  std::string*        err
+)
+{
+  TIME_STAT_MONGO_WRITE_WAIT_START();
+  DBClientBase* connection = getMongoConnection();
+
+  if (connection == NULL)
+  {
+    TIME_STAT_MONGO_WRITE_WAIT_STOP();
+
+    LM_E(("Fatal Error (null DB connection)"));
+    *err = "null DB connection";
+
+    return false;
+  }
+
+  LM_T(LmtMongo, ("findAndModify() in '%s' collection: query='%s' doc='%s', fields='%s'",
+                  col.c_str(),
+                  q.toString().c_str(),
+                  doc.toString().c_str(),
+                  fields.toString().c_str()));
+
+  try
+  {
+    *result = connection->findAndModify(col.c_str(), q, doc, false, false, BSONObj(), fields).getOwned();
+    releaseMongoConnection(connection);
+    TIME_STAT_MONGO_WRITE_WAIT_STOP();
+    LM_I(("Database Operation Successful (findAndModify: <%s, %s>)", q.toString().c_str(), doc.toString().c_str()));
+  }
+  catch (const std::exception& e)
+  {
+    LM_E(("Database Error: %s", e.what()));
+    releaseMongoConnection(connection);
+    TIME_STAT_MONGO_WRITE_WAIT_STOP();
+
+    std::string msg = std::string("collection: ") + col.c_str() +
+      " - findAndModify(): <" + q.toString() + "," + doc.toString() + ">" +
+      " - exception: " + e.what();
+
+    *err = "Database Error (" + msg + ")";
+    alarmMgr.dbError(msg);
+
+    return false;
+  }
+  catch (...)
+  {
+    releaseMongoConnection(connection);
+    TIME_STAT_MONGO_WRITE_WAIT_STOP();
+
+    std::string msg = std::string("collection: ") + col.c_str() +
+      " - findAndModify(): <" + q.toString() + "," + doc.toString() + ">" +
+      " - exception: generic";
+
+    *err = "Database Error (" + msg + ")";
+    alarmMgr.dbError(msg);
+
+    return false;
+  }
+  alarmMgr.dbErrorReset();
+
+  return true;
+}
+
+
+
+/* ****************************************************************************
+*
+* collectionBulkReplace -
+*
+* Replaces (upserting if not found) the documents matching filterV[ix] with docV[ix],
+* all of them in ONE unordered bulk write.
+*
+* The outcome per document is returned in docErrorV (same index as in docV), as an
+* empty string if the document was written and as the error message of the database
+* if not. The return value is false only if the bulk write as a whole failed.
+*/
+bool collectionBulkReplace
+(
+  const std::string&           col,
+  const std::vector<BSONObj>&  filterV,
+  const std::vector<BSONObj>&  docV,
+  std::vector<std::string>*    docErrorV,
+  std::string*                 err
+)
+{
+  docErrorV->assign(docV.size(), "");
+
+  if (docV.size() == 0)
+  {
+    return true;
+  }
+
+  TIME_STAT_MONGO_WRITE_WAIT_START();
+  DBClientBase* connection = getMongoConnection();
+
+  if (connection == NULL)
+  {
+    TIME_STAT_MONGO_WRITE_WAIT_STOP();
+
+    LM_E(("Fatal Error (null DB connection)"));
+    *err = "null DB connection";
+
+    return false;
+  }
+
+  LM_T(LmtMongo, ("bulk replace in '%s' collection: %d documents", col.c_str(), (int) docV.size()));
+
+  BulkOperationBuilder  bulk = connection->initializeUnorderedBulkOp(col);
+  const WriteConcern    writeConcern;
+  WriteResult           writeResult;
+  std::string           exceptionText;
+
+  try
+  {
+    for (unsigned int ix = 0; ix < docV.size(); ++ix)
+    {
+      bulk.find(filterV[ix]).upsert().replaceOne(docV[ix]);
+    }
+
+    bulk.execute(&writeConcern, &writeResult);
+  }
+  catch (const std::exception& e)
+  {
+    exceptionText = e.what();
+  }
+  catch (...)
+  {
+    exceptionText = "generic";
+  }
+
+  releaseMongoConnection(connection);
+  TIME_STAT_MONGO_WRITE_WAIT_STOP();
+
+  //
+  // Errors of individual documents are reported by the driver both in the WriteResult and
+  // as an exception - only if no document is flagged, the exception concerns the entire bulk write
+  //
+  std::vector<BSONObj> writeErrors = writeResult.writeErrors();
+
+  for (unsigned int ix = 0; ix < writeErrors.size(); ++ix)
+  {
+    int index = writeErrors[ix].getField("index").numberInt();
+
+    if ((index >= 0) && (index < (int) docErrorV->size()))
+    {
+      (*docErrorV)[index] = writeErrors[ix].getField("errmsg").str();
+    }
+  }
+
+  if ((exceptionText != "") && (writeErrors.size() == 0))
+  {
+    std::string msg = std::string("collection: ") + col.c_str() + " - bulk replace - exception: " + exceptionText;
+
+    *err = "Database Error (" + msg + ")";
+    alarmMgr.dbError(msg);
+
+    return false;
+  }
+
+  LM_I(("Database Operation Successful (bulk replace: %d documents, %d errors)", (int) docV.size(), (int) writeErrors.size()));
+  alarmMgr.dbErrorReset();
+
+  return true;
+}
+
+
+
 /* ****************************************************************************
 *
 * collectionRemove -
@@ -561,7 +805,8 @@ bool collectionCreateIndex
   const std::string&  col,
   const BSONObj&      indexes,
   const bool&         isTTL,
-  std::string*        err
+  std::string*        err,
+  const bool&         isUnique
 )
 {
   TIME_STAT_MONGO_COMMAND_WAIT_START();
@@ -588,6 +833,10 @@ bool collectionCreateIndex
     {
       connection->createIndex(col.c_str(), IndexSpec().addKeys(indexes).expireAfterSeconds(0));
     }
+    else if (isUnique)
+    {
+      connection->createIndex(col.c_str(), IndexSpec().addKeys(indexes).unique());
+    }
     else
     {
       connection->createIndex(col.c_str(), indexes);
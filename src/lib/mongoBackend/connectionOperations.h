@@ -26,6 +26,7 @@
 * Author: Fermín Galán
 */
 #include <string>
+#include <vector>
 
 #include "mongo/client/dbclient.h"
 
@@ -64,6 +65,38 @@ extern bool collectionRangedQuery
 
 
 
+/* ****************************************************************************
+*
+* ESTIMATED_COUNT_MAX - where an estimated count (options=estimatedCount) stops counting
+*/
+#define ESTIMATED_COUNT_MAX  10000
+
+
+
+/* ****************************************************************************
+*
+* MONGO_DUPLICATE_KEY_ERROR - error code of a write that violates a unique index
+*/
+#define MONGO_DUPLICATE_KEY_ERROR  11000
+
+
+
+/* ****************************************************************************
+*
+* collectionRangedCount -
+*/
+extern bool collectionRangedCount
+(
+  mongo::DBClientBase*   connection,
+  const std::string&     col,
+  const mongo::BSONObj&  filter,
+  bool                   estimated,
+  long long*             count,
+  std::string*           err
+);
+
+
+
 /* ****************************************************************************
 *
 * collectionCount -
@@ -100,7 +133,8 @@ extern bool collectionInsert
 (
   const std::string&     col,
   const mongo::BSONObj&  doc,
-  std::string*           err
+  std::string*           err,
+  bool*                  duplicateKeyP = NULL
 );
 
 
@@ -120,6 +154,37 @@ extern bool collectionUpdate
 
 
 
+/* ****************************************************************************
+*
+* collectionFindAndModify -
+*/
+extern bool collectionFindAndModify
+(
+  const std::string&     col,
+  const mongo::BSONObj&  q,
+  const mongo::BSONObj&  doc,
+  const mongo::BSONObj&  fields,
+  mongo::BSONObj*        result,
+  std::string*           err
+);
+
+
+
+/* ****************************************************************************
+*
+* collectionBulkReplace -
+*/
+extern bool collectionBulkReplace
+(
+  const std::string&                  col,
+  const std::vector<mongo::BSONObj>&  filterV,
+  const std::vector<mongo::BSONObj>&  docV,
+  std::vector<std::string>*           docErrorV,
+  std::string*                        err
+);
+
+
+
 /* ****************************************************************************
 *
 * collectionRemove -
@@ -142,7 +207,8 @@ extern bool collectionCreateIndex
   const std::string&     col,
   const mongo::BSONObj&  indexes,
   const bool&            isTTL,
-  std::string*           err
+  std::string*           err,
+  const bool&            isUnique = false
 );
 
 
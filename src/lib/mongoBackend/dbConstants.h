@@ -130,6 +130,8 @@
 #define CSUB_LDCONTEXT               "ldContext"
 #define CSUB_NAME                    "name"
 #define CSUB_MIMETYPE                "mimeType"
+#define CSUB_BATCH_MAX_ENTITIES      "batchMaxEntities"
+#define CSUB_BATCH_MAX_DELAY         "batchMaxDelay"
 #endif
 
 #define CASUB_EXPIRATION             "expiration"
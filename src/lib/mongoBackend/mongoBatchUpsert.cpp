@@ -0,0 +1,103 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                      // KjNode
+}
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+#include "common/globals.h"
+#include "common/sem.h"
+#include "common/limits.h"
+#include "alarmMgr/alarmMgr.h"
+#include "ngsi10/UpdateContextRequest.h"
+#include "ngsi10/UpdateContextResponse.h"
+#include "rest/HttpStatusCode.h"
+
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/MongoCommonUpdate.h"
+#include "mongoBackend/mongoBatchUpsert.h"
+
+
+
+/* ****************************************************************************
+*
+* mongoBatchUpsert -
+*
+* Same as mongoUpdateContext with ActionTypeAppendStrict on entities that don't exist,
+* but all the entities of the request are created/replaced with ONE bulk write, and existing
+* entities don't need to be removed first.
+* See processContextElementVectorUpsert for the meaning of geoPropertyV.
+*/
+HttpStatusCode mongoBatchUpsert
+(
+  UpdateContextRequest*            requestP,
+  KjNode**                         geoPropertyV,
+  UpdateContextResponse*           responseP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion
+)
+{
+  bool reqSemTaken;
+
+  reqSemTake(__FUNCTION__, "ngsi-ld batch upsert", SemWriteOp, &reqSemTaken);
+
+  /* Check that the service path vector has only one element, returning error otherwise */
+  if (servicePathV.size() > 1)
+  {
+    char lenV[STRING_SIZE_FOR_INT];
+
+    snprintf(lenV, sizeof(lenV), "%lu", (unsigned long) servicePathV.size());
+
+    std::string details = std::string("service path length ") + lenV + " is greater than the one in update";
+    alarmMgr.badInput(clientIp, details);
+    responseP->errorCode.fill(SccBadRequest, "service path length greater than the one in update");
+    responseP->oe.fill(SccBadRequest, "service path length greater than the one in update", "BadRequest");
+  }
+  else
+  {
+    processContextElementVectorUpsert(&requestP->contextElementVector,
+                                      geoPropertyV,
+                                      responseP,
+                                      tenant,
+                                      servicePathV,
+                                      xauthToken,
+                                      fiwareCorrelator,
+                                      apiVersion);
+
+    /* As in mongoUpdateContext, errors of individual entities are in the StatusCode of their ContextElementResponse */
+    responseP->errorCode.fill(SccOk);
+  }
+
+  reqSemGive(__FUNCTION__, "ngsi-ld batch upsert", reqSemTaken);
+  return SccOk;
+}
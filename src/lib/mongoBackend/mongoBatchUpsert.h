@@ -0,0 +1,58 @@
+#ifndef SRC_LIB_MONGOBACKEND_MONGOBATCHUPSERT_H_
+#define SRC_LIB_MONGOBACKEND_MONGOBATCHUPSERT_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                      // KjNode
+}
+
+#include "rest/HttpStatusCode.h"
+#include "ngsi10/UpdateContextRequest.h"
+#include "ngsi10/UpdateContextResponse.h"
+
+
+
+/* ****************************************************************************
+*
+* mongoBatchUpsert -
+*/
+extern HttpStatusCode mongoBatchUpsert
+(
+  UpdateContextRequest*            requestP,
+  KjNode**                         geoPropertyV,
+  UpdateContextResponse*           responseP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion
+);
+
+#endif  // SRC_LIB_MONGOBACKEND_MONGOBATCHUPSERT_H_
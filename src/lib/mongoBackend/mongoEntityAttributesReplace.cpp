@@ -0,0 +1,92 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+#include "common/globals.h"
+#include "common/sem.h"
+#include "common/limits.h"
+#include "alarmMgr/alarmMgr.h"
+#include "ngsi/ContextElement.h"
+#include "rest/HttpStatusCode.h"
+#include "rest/OrionError.h"
+
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/MongoCommonUpdate.h"
+#include "mongoBackend/mongoEntityAttributesReplace.h"
+
+
+
+/* ****************************************************************************
+*
+* mongoEntityAttributesReplace -
+*
+* Replaces already existing attributes of an entity with ONE findAndModify, writing only the replaced
+* attributes (see processContextElementAttributesReplace). The names of the attributes of ceP that
+* the entity doesn't have are added to notFoundV.
+*
+* Returns SccOk if the attributes were replaced, SccContextElementNotFound if the entity doesn't exist,
+* and the error (also in oeP) otherwise.
+*/
+HttpStatusCode mongoEntityAttributesReplace
+(
+  ContextElement*                  ceP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion,
+  std::vector<std::string>*        notFoundV,
+  OrionError*                      oeP
+)
+{
+  bool            reqSemTaken;
+  HttpStatusCode  statusCode;
+
+  reqSemTake(__FUNCTION__, "ngsi-ld attribute replace", SemWriteOp, &reqSemTaken);
+
+  /* Check that the service path vector has only one element, returning error otherwise */
+  if (servicePathV.size() > 1)
+  {
+    char lenV[STRING_SIZE_FOR_INT];
+
+    snprintf(lenV, sizeof(lenV), "%lu", (unsigned long) servicePathV.size());
+
+    std::string details = std::string("service path length ") + lenV + " is greater than the one in update";
+    alarmMgr.badInput(clientIp, details);
+    oeP->fill(SccBadRequest, "service path length greater than the one in update", "BadRequest");
+    statusCode = SccBadRequest;
+  }
+  else
+  {
+    statusCode = processContextElementAttributesReplace(ceP, tenant, servicePathV, xauthToken, fiwareCorrelator, apiVersion, notFoundV, oeP);
+  }
+
+  reqSemGive(__FUNCTION__, "ngsi-ld attribute replace", reqSemTaken);
+
+  return statusCode;
+}
@@ -0,0 +1,90 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+#include <vector>
+
+#include "logMsg/logMsg.h"
+#include "logMsg/traceLevels.h"
+#include "common/globals.h"
+#include "common/sem.h"
+#include "common/limits.h"
+#include "alarmMgr/alarmMgr.h"
+#include "ngsi/ContextElement.h"
+#include "rest/HttpStatusCode.h"
+#include "rest/OrionError.h"
+
+#include "mongoBackend/MongoGlobal.h"
+#include "mongoBackend/MongoCommonUpdate.h"
+#include "mongoBackend/mongoEntityCreate.h"
+
+
+
+/* ****************************************************************************
+*
+* mongoEntityCreate -
+*
+* Same as mongoUpdateContext with ActionTypeAppend on an entity that doesn't exist, but with two
+* round trips to the database: a count on the entity id and the insert. See processContextElementCreate.
+*
+* Returns SccOk if the entity was created, SccConflict if it already existed, and the error
+* (also in oeP) otherwise.
+*/
+HttpStatusCode mongoEntityCreate
+(
+  ContextElement*                  ceP,
+  const std::string&               tenant,
+  const std::vector<std::string>&  servicePathV,
+  const std::string&               xauthToken,
+  const std::string&               fiwareCorrelator,
+  ApiVersion                       apiVersion,
+  OrionError*                      oeP
+)
+{
+  bool            reqSemTaken;
+  HttpStatusCode  statusCode;
+
+  reqSemTake(__FUNCTION__, "ngsi-ld entity creation", SemWriteOp, &reqSemTaken);
+
+  /* Check that the service path vector has only one element, returning error otherwise */
+  if (servicePathV.size() > 1)
+  {
+    char lenV[STRING_SIZE_FOR_INT];
+
+    snprintf(lenV, sizeof(lenV), "%lu", (unsigned long) servicePathV.size());
+
+    std::string details = std::string("service path length ") + lenV + " is greater than the one in update";
+    alarmMgr.badInput(clientIp, details);
+    oeP->fill(SccBadRequest, "service path length greater than the one in update", "BadRequest");
+    statusCode = SccBadRequest;
+  }
+  else
+  {
+    statusCode = processContextElementCreate(ceP, tenant, servicePathV, xauthToken, fiwareCorrelator, apiVersion, oeP);
+  }
+
+  reqSemGive(__FUNCTION__, "ngsi-ld entity creation", reqSemTaken);
+
+  return statusCode;
+}
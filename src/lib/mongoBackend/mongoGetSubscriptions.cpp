@@ -602,6 +602,11 @@ bool mongoGetLdSubscription
 /* ****************************************************************************
 *
 * mongoGetLdSubscriptions -
+*
+* If 'afterId' is non-NULL (pagination cursor), the listing starts right after the subscription with that id
+* (keyset pagination on _id), and the URI param 'offset' is not used.
+* The count (if countP != NULL) is made on all subscriptions, without the cursor, and stopped at ESTIMATED_COUNT_MAX
+* if 'countEstimated' is set.
 */
 bool mongoGetLdSubscriptions
 (
@@ -609,6 +614,8 @@ bool mongoGetLdSubscriptions
   std::vector<ngsiv2::Subscription>*  subVecP,
   const char*                         tenant,
   long long*                          countP,
+  bool                                countEstimated,
+  const char*                         afterId,
   OrionError*                         oeP
 )
 {
@@ -635,26 +642,38 @@ bool mongoGetLdSubscriptions
    */
   std::auto_ptr<DBClientCursor>  cursor;
   std::string                    err;
-  Query                          q;
+  BSONObj                        filter;
+  mongo::BSONObjBuilder          queryBuilder;
 
   // FIXME P6: This here is a bug ... See #3099 for more info
   if (!ciP->servicePathV[0].empty() && (ciP->servicePathV[0] != "/#"))
   {
-    q = Query(BSON(CSUB_SERVICE_PATH << ciP->servicePathV[0]));
+    filter = BSON(CSUB_SERVICE_PATH << ciP->servicePathV[0]);
   }
 
+  queryBuilder.appendElements(filter);
+
+  if (afterId != NULL)
+  {
+    queryBuilder.append("_id", BSON("$gt" << afterId));
+    offset = 0;
+  }
+
+  Query q(queryBuilder.obj());
+
   q.sort(BSON("_id" << 1));
 
   TIME_STAT_MONGO_READ_WAIT_START();
   DBClientBase* connection = getMongoConnection();
-  if (!collectionRangedQuery(connection,
-                             getSubscribeContextCollectionName(tenant),
-                             q,
-                             limit,
-                             offset,
-                             &cursor,
-                             countP,
-                             &err))
+  if (((countP != NULL) && (!collectionRangedCount(connection, getSubscribeContextCollectionName(tenant), filter, countEstimated, countP, &err))) ||
+      (!collectionRangedQuery(connection,
+                              getSubscribeContextCollectionName(tenant),
+                              q,
+                              limit,
+                              offset,
+                              &cursor,
+                              NULL,
+                              &err)))
   {
     releaseMongoConnection(connection);
     TIME_STAT_MONGO_READ_WAIT_STOP();
@@ -93,6 +93,8 @@ extern bool mongoGetLdSubscriptions
   std::vector<ngsiv2::Subscription>*  subVecP,
   const char*                         tenant,
   long long*                          countP,
+  bool                                countEstimated,
+  const char*                         afterId,
   OrionError*                         oeP
 );
 
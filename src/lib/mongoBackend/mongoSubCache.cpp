@@ -129,6 +129,8 @@ int mongoSubCacheItemInsert(const char* tenant, const BSONObj& sub)
 
   if (strncmp(oid, "_id: ObjectId('", 15) == 0)
     cSubP->subscriptionId  = strdup(idField.OID().toString().c_str());
+  else if (idField.type() == mongo::String)
+    cSubP->subscriptionId  = strdup(idField.String().c_str());
   else
     cSubP->subscriptionId  = strdup(idField.toString().c_str());
 #else
@@ -146,6 +148,9 @@ int mongoSubCacheItemInsert(const char* tenant, const BSONObj& sub)
   cSubP->lastSuccess           = sub.hasField(CSUB_LASTSUCCESS)?      getIntOrLongFieldAsLongF(sub, CSUB_LASTSUCCESS)      : -1;
   cSubP->count                 = 0;
   cSubP->next                  = NULL;
+#ifdef ORIONLD
+  cSubP->ldContext             = sub.hasField(CSUB_LDCONTEXT)? getStringFieldF(sub, CSUB_LDCONTEXT) : "";
+#endif
 
 
   //
@@ -394,6 +399,9 @@ int mongoSubCacheItemInsert
   cSubP->expression.georel     = georel;
   cSubP->next                  = NULL;
   cSubP->blacklist             = sub.hasField(CSUB_BLACKLIST)? getBoolFieldF(sub, CSUB_BLACKLIST) : false;
+#ifdef ORIONLD
+  cSubP->ldContext             = sub.hasField(CSUB_LDCONTEXT)? getStringFieldF(sub, CSUB_LDCONTEXT) : "";
+#endif
 
   //
   // httpInfo
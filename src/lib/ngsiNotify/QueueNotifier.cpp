@@ -22,10 +22,15 @@
 *
 * Author: Orion dev team
 */
+#include <map>
+#include <string>
+#include <vector>
+
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
 #include "common/string.h"
+#include "common/limits.h"
 #include "common/RenderFormat.h"
 #include "alarmMgr/alarmMgr.h"
 
@@ -38,7 +43,9 @@
 *
 * QueueNotifier::Notifier -
 */
-QueueNotifier::QueueNotifier(size_t queueSize, int numThreads): queue(queueSize), workers(&queue, numThreads)
+QueueNotifier::QueueNotifier(size_t queueSize, int numThreads, int maxPerEndpoint):
+  queue(queueSize, maxPerEndpoint, NOTIF_CIRCUIT_FAILURES, NOTIF_CIRCUIT_OPEN_SECS),
+  workers(&queue, numThreads)
 {
   LM_T(LmtNotifier,("Setting up queue and threads for notifications"));
 }
@@ -83,25 +90,61 @@ void QueueNotifier::sendNotifyContextRequest
                                                                           metadataFilter,
                                                                           blacklist);
 
-  size_t notificationsNum = paramsV->size();
-  for (unsigned ix = 0; ix < notificationsNum; ix++)
+  //
+  // The queue is sharded by endpoint (host:port).
+  // Normally all notifications in paramsV go to the same endpoint, but with a custom notification
+  // the URL may depend on the entity.
+  //
+  std::map<std::string, std::vector<SenderThreadParams*>*> byEndpoint;
+
+  for (unsigned ix = 0; ix < paramsV->size(); ix++)
   {
-    clock_gettime(CLOCK_REALTIME, &(((*paramsV)[ix])->timeStamp));
+    SenderThreadParams* params = (*paramsV)[ix];
+    char                portV[STRING_SIZE_FOR_INT];
+
+    clock_gettime(CLOCK_REALTIME, &params->timeStamp);
+
+    snprintf(portV, sizeof(portV), "%d", params->port);
+    std::string endpoint = params->ip + ":" + portV;
+
+    if (byEndpoint[endpoint] == NULL)
+    {
+      byEndpoint[endpoint] = new std::vector<SenderThreadParams*>();
+    }
+    byEndpoint[endpoint]->push_back(params);
   }
 
-  bool enqueued = queue.try_push(paramsV);
-  if (!enqueued)
+  delete paramsV;
+
+  for (std::map<std::string, std::vector<SenderThreadParams*>*>::iterator it = byEndpoint.begin(); it != byEndpoint.end(); ++it)
   {
-    QueueStatistics::incReject(notificationsNum);
-    LM_E(("Runtime Error (notification queue is full)"));
-    for (unsigned ix = 0; ix < paramsV->size(); ix++)
+    std::vector<SenderThreadParams*>* endpointParamsV = it->second;
+    size_t                            notificationsNum = endpointParamsV->size();
+
+    if (!queue.try_push(it->first, endpointParamsV))
     {
-      delete (*paramsV)[ix];
+      QueueStatistics::incReject(notificationsNum);
+      LM_E(("Runtime Error (notification queue is full, endpoint %s)", it->first.c_str()));
+      for (unsigned ix = 0; ix < notificationsNum; ix++)
+      {
+        delete (*endpointParamsV)[ix];
+      }
+      delete endpointParamsV;
+
+      continue;
     }
-    delete paramsV;
 
-    return;
+    QueueStatistics::incIn(notificationsNum);
   }
+}
+
+
 
-  QueueStatistics::incIn(notificationsNum);
+/* ****************************************************************************
+*
+* QueueNotifier::endpointCounters -
+*/
+void QueueNotifier::endpointCounters(std::map<std::string, SyncQShardCounters>* countersP) const
+{
+  queue.counters(countersP);
 }
@@ -28,7 +28,7 @@
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
-#include "common/SyncQOverflow.h"
+#include "common/SyncQSharded.h"
 #include "common/RenderFormat.h"
 #include "ngsiNotify/Notifier.h"
 #include "ngsiNotify/senderThread.h"
@@ -39,6 +39,10 @@
 #define DEFAULT_NOTIF_QS 100
 // default number of threads
 #define DEFAULT_NOTIF_TN 10
+// consecutive failures of an endpoint that open its circuit
+#define NOTIF_CIRCUIT_FAILURES 5
+// seconds an endpoint circuit stays open
+#define NOTIF_CIRCUIT_OPEN_SECS 30
 
 
 
@@ -49,7 +53,7 @@
 class QueueNotifier : public Notifier
 {
 public:
-  QueueNotifier(size_t queueSize, int numThreads);
+  QueueNotifier(size_t queueSize, int numThreads, int maxPerEndpoint = 0);
 
   void sendNotifyContextRequest(NotifyContextRequest*            ncr,
                                 const ngsiv2::HttpInfo&          httpInfo,
@@ -61,9 +65,10 @@ public:
                                 const std::vector<std::string>&  metadataFilter,
                                 bool                             blacklist);
   int start();
+  void endpointCounters(std::map<std::string, SyncQShardCounters>* countersP) const;
 
 private:
- SyncQOverflow<std::vector<SenderThreadParams*>*>  queue;
+ SyncQSharded<std::vector<SenderThreadParams*>*>  queue;
  QueueWorkers                        workers;
 
 };
@@ -36,6 +36,7 @@
 #include "ngsi10/NotifyContextRequest.h"
 #include "rest/httpRequestSend.h"
 #include "ngsiNotify/QueueStatistics.h"
+#include "ngsiNotify/QueueNotifier.h"
 #include "ngsiNotify/QueueWorkers.h"
 
 
@@ -77,8 +78,8 @@ int QueueWorkers::start()
 */
 static void* workerFunc(void* pSyncQ)
 {
-  SyncQOverflow<std::vector<SenderThreadParams*>*>*  queue = (SyncQOverflow<std::vector<SenderThreadParams*>*> *) pSyncQ;
-  CURL*                                              curl;
+  SyncQSharded<std::vector<SenderThreadParams*>*>*  queue = (SyncQSharded<std::vector<SenderThreadParams*>*> *) pSyncQ;
+  CURL*                                             curl;
 
   // Initialize curl context
   curl = curl_easy_init();
@@ -91,7 +92,11 @@ static void* workerFunc(void* pSyncQ)
 
   for (;;)
   {
-    std::vector<SenderThreadParams*>* paramsV = queue->pop();
+    std::string                        endpoint;
+    bool                               circuitOpen;
+    int                                sentOk    = 0;
+    int                                sentError = 0;
+    std::vector<SenderThreadParams*>*  paramsV   = queue->pop(&endpoint, &circuitOpen);
 
     for (unsigned ix = 0; ix < paramsV->size(); ix++)
     {
@@ -124,6 +129,25 @@ static void* workerFunc(void* pSyncQ)
         LM_T(LmtNotifier, ("simulatedNotification is 'true', skipping outgoing request"));
         __sync_fetch_and_add(&noOfSimulatedNotifications, 1);
       }
+      else if (circuitOpen)
+      {
+        //
+        // The endpoint has failed repeatedly - the notification is discarded without even trying,
+        // not to have a worker blocked waiting for a timeout
+        //
+        char portV[STRING_SIZE_FOR_INT];
+        snprintf(portV, sizeof(portV), "%d", params->port);
+        std::string url = params->ip + ":" + portV + params->resource;
+
+        LM_T(LmtNotifier, ("circuit open for endpoint %s, notification discarded", endpoint.c_str()));
+        QueueStatistics::incSentError();
+        alarmMgr.notificationError(url, "notification endpoint circuit open");
+
+        if (params->registration == false)
+        {
+          subCacheItemNotificationErrorStatus(params->tenant, params->subscriptionId, 1);
+        }
+      }
       else // we'll send the notification
       {
         std::string  out;
@@ -157,6 +181,7 @@ static void* workerFunc(void* pSyncQ)
 
         if (r == 0)
         {
+          ++sentOk;
           statisticsUpdate(NotifyContextSent, params->mimeType);
           QueueStatistics::incSentOK();
           alarmMgr.notificationErrorReset(url);
@@ -168,6 +193,7 @@ static void* workerFunc(void* pSyncQ)
         }
         else
         {
+          ++sentError;
           QueueStatistics::incSentError();
           alarmMgr.notificationError(url, "notification failure for queue worker");
 
@@ -185,6 +211,12 @@ static void* workerFunc(void* pSyncQ)
     // Free params vector memory
     delete paramsV;
 
+    // Concurrency and circuit accounting for the endpoint
+    if ((circuitOpen == false) && (queue->done(endpoint, sentOk, sentError) == true))
+    {
+      LM_W(("Notification endpoint %s keeps failing - circuit open for %d seconds", endpoint.c_str(), NOTIF_CIRCUIT_OPEN_SECS));
+    }
+
     // Reset curl for next iteration
     curl_easy_reset(curl);
   }
@@ -25,16 +25,16 @@
 * Author: Orion dev team
 */
 
-#include "common/SyncQOverflow.h"
+#include "common/SyncQSharded.h"
 #include "ngsiNotify/senderThread.h"
 
 class QueueWorkers
 {
 public:
-  QueueWorkers(SyncQOverflow<std::vector<SenderThreadParams*>*> *pQ, int numThreads): pQueue(pQ), numberOfThreads(numThreads) {}
+  QueueWorkers(SyncQSharded<std::vector<SenderThreadParams*>*> *pQ, int numThreads): pQueue(pQ), numberOfThreads(numThreads) {}
   int start();
 private:
-    SyncQOverflow<std::vector<SenderThreadParams*>*> *pQueue;
+    SyncQSharded<std::vector<SenderThreadParams*>*> *pQueue;
     int numberOfThreads;
 };
 
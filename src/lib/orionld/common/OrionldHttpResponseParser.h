@@ -0,0 +1,82 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDHTTPRESPONSEPARSER_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDHTTPRESPONSEPARSER_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // int64_t
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldHttpResponseState - where in the HTTP/1.x response the parser is
+//
+typedef enum OrionldHttpResponseState
+{
+  HrsStatusLine,
+  HrsHeaders,
+  HrsBody,          // Content-Length framed payload body
+  HrsChunkSize,
+  HrsChunkData,
+  HrsChunkDataEnd,  // The CRLF after the data of a chunk
+  HrsTrailers,
+  HrsUntilClose,    // No framing - the payload body ends when the connection is closed
+  HrsDone
+} OrionldHttpResponseState;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_HTTP_RESPONSE_LINE_MAX - max length of a status/header line kept by the parser
+//
+// Longer lines are truncated - only the beginning of a few headers is of interest.
+//
+#define ORIONLD_HTTP_RESPONSE_LINE_MAX  512
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldHttpResponseParser - state of the incremental parsing of an HTTP/1.x response
+//
+// The response is fed to orionldHttpResponseParse in pieces, as it arrives, so the parser keeps the line
+// being read. The payload body is not kept, just skipped.
+// A zeroed parser (calloc/bzero) is ready to parse a new response.
+//
+typedef struct OrionldHttpResponseParser
+{
+  OrionldHttpResponseState  state;
+  int                       statusCode;
+  bool                      keepAlive;
+  bool                      chunked;
+  bool                      contentLengthGiven;
+  int64_t                   contentLength;
+  int64_t                   toSkip;        // Bytes of payload body (or of the chunk) still to skip
+  int                       lineLen;
+  char                      line[ORIONLD_HTTP_RESPONSE_LINE_MAX];
+} OrionldHttpResponseParser;
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDHTTPRESPONSEPARSER_H_
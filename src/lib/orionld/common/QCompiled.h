@@ -0,0 +1,82 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_QCOMPILED_H_
+#define SRC_LIB_ORIONLD_COMMON_QCOMPILED_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <regex.h>                                             // regex_t
+
+#include "orionld/common/QNode.h"                              // QNodeType
+
+
+
+// ----------------------------------------------------------------------------
+//
+// QCompiledValue - a constant of a compiled Q-filter
+//
+// Integer and Float constants are both kept as a double in 'number', to be compared with
+// any numeric value in the entity without conversions at evaluation time.
+//
+typedef struct QCompiledValue
+{
+  QNodeType  type;     // QNodeIntegerValue, QNodeFloatValue, QNodeStringValue, QNodeTrueValue, QNodeFalseValue
+  double     number;
+  char*      string;
+} QCompiledValue;
+
+
+
+// ----------------------------------------------------------------------------
+//
+// QCompiled - a Q-filter, compiled from a QNode tree, for in-memory evaluation
+//
+// QNode trees live in the thread-local orionldState and die with the request.
+// A QCompiled tree is allocated on the heap, to live as long as the subscription it belongs to
+// (see qCompile and qCompiledRelease).
+//
+// For AND and OR, the operands are in 'children'.
+// For the rest of the operators, the variable is pre-resolved into the attribute name, the
+// sub-attribute name and the path inside the value, and the right-hand side is in valueV:
+// one value, two values for a range (rhsType == QNodeRange), N values for a list (rhsType == QNodeComma).
+// Regular expressions (~= and !~=) are pre-compiled, in regexP.
+//
+typedef struct QCompiled
+{
+  QNodeType          type;
+  struct QCompiled*  children;
+  struct QCompiled*  next;
+
+  char*              attrName;        // Expanded attribute name, as in the database ('.' replaced by '=')
+  char*              attrNameDots;    // Expanded attribute name, as in payloads
+  char*              mdName;          // Sub-attribute name, as in the database - NULL if none
+  char*              mdNameDots;      // Sub-attribute name, as in payloads
+  char**             valuePathV;      // Path inside the value, NULL-terminated - NULL if none
+
+  QNodeType          rhsType;
+  QCompiledValue*    valueV;
+  int                values;
+  regex_t*           regexP;
+} QCompiled;
+
+#endif  // SRC_LIB_ORIONLD_COMMON_QCOMPILED_H_
@@ -0,0 +1,79 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                             // pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock
+#include <string>                                                // std::string
+#include <map>                                                   // std::map
+
+#include "orionld/common/forwardStats.h"                         // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// forwardStats - counters per context provider ("host:port"), protected by forwardStatsMutex
+//
+static std::map<std::string, ForwardProviderStats>  forwardStats;
+static pthread_mutex_t                              forwardStatsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// forwardStatsAdd - account for one forwarded request
+//
+void forwardStatsAdd(const char* provider, int latencyMs, bool ok, bool timedOut)
+{
+  pthread_mutex_lock(&forwardStatsMutex);
+
+  ForwardProviderStats* statsP = &forwardStats[provider];  // zero-initialized if not found
+
+  statsP->requests += 1;
+  statsP->totalMs  += latencyMs;
+  statsP->lastMs    = latencyMs;
+
+  if (latencyMs > statsP->maxMs)
+    statsP->maxMs = latencyMs;
+
+  if (ok == false)
+    statsP->errors += 1;
+
+  if (timedOut == true)
+    statsP->timeouts += 1;
+
+  pthread_mutex_unlock(&forwardStatsMutex);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// forwardStatsGet - get a copy of the counters of all context providers
+//
+void forwardStatsGet(std::map<std::string, ForwardProviderStats>* statsP)
+{
+  pthread_mutex_lock(&forwardStatsMutex);
+  *statsP = forwardStats;
+  pthread_mutex_unlock(&forwardStatsMutex);
+}
@@ -0,0 +1,243 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strerror
+#include <errno.h>                                               // errno
+#include <unistd.h>                                              // close
+#include <fcntl.h>                                               // fcntl, O_NONBLOCK
+#include <time.h>                                                // time, clock_gettime
+#include <sys/types.h>                                           // types
+#include <sys/socket.h>                                          // socket, connect, recv
+#include <netinet/in.h>                                          // sockaddr_in
+#include <netinet/tcp.h>                                         // TCP_NODELAY
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldEndpointPool.h"                  // Endpoint Pool Internals
+#include "orionld/common/orionldEndpointLookup.h"                // orionldEndpointLookup
+#include "orionld/common/orionldEndpointResolve.h"               // orionldEndpointResolve
+#include "orionld/common/orionldEndpointIdlePurge.h"             // orionldEndpointIdlePurge
+#include "orionld/common/orionldEndpointConnect.h"               // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// idleConnectionGet - pop an idle connection that is still open
+//
+// A connection closed by the peer while idle is readable (recv returns 0) - such connections are closed.
+// The caller must have taken orionldEndpointPoolSem.
+//
+static int idleConnectionGet(OrionldEndpoint* epP)
+{
+  while (epP->idles > 0)
+  {
+    char  c;
+    int   fd = epP->idleFd[--epP->idles];
+    int   nb = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+
+    if ((nb == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+      return fd;
+
+    close(fd);
+    --epP->connections;
+    ++orionldEndpointPoolStats.staleClosed;
+  }
+
+  return -1;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// blockingModeSet -
+//
+static void blockingModeSet(int fd, bool nonBlocking)
+{
+  int flags = fcntl(fd, F_GETFL, 0);
+
+  if (nonBlocking == true)
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+  else
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// freeSlotTake - wait at most 'waitMs' milliseconds for the endpoint to have a connection that is not in use
+//
+static bool freeSlotTake(OrionldEndpoint* epP, int waitMs)
+{
+  if (sem_trywait(&epP->freeSlots) == 0)
+    return true;
+
+  if (waitMs <= 0)
+    return false;
+
+  struct timespec  deadline;
+
+  sem_wait(&orionldEndpointPoolSem);
+  ++orionldEndpointPoolStats.waits;
+  sem_post(&orionldEndpointPoolSem);
+
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec  += waitMs / 1000;
+  deadline.tv_nsec += (waitMs % 1000) * 1000000;
+
+  if (deadline.tv_nsec >= 1000000000)
+  {
+    deadline.tv_sec  += 1;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  while (sem_timedwait(&epP->freeSlots, &deadline) == -1)
+  {
+    if (errno != EINTR)
+      return false;
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldEndpointConnect -
+//
+// The semaphore is not held while resolving the host name or connecting, as both may take time.
+// A slot in the endpoint is reserved (connections is incremented) before releasing the semaphore.
+//
+// No more than orionldEndpointPoolMaxConnections connections per endpoint are in use at any time - a free
+// connection slot is taken first, waiting for a connection to be released, at most 'waitMs' milliseconds.
+//
+// In non-blocking mode (the notification sender loop), the host name is never resolved, as getaddrinfo blocks.
+// The address from the DNS cache of the pool is used, also if older than ORIONLD_ENDPOINT_DNS_TTL - the address
+// has been resolved (or refreshed) by orionldEndpointResolve as the notification was queued.
+//
+int orionldEndpointConnect(const char* host, uint16_t port, bool nonBlocking, int waitMs, OrionldEndpoint** endpointPP, bool* reusedP)
+{
+  OrionldEndpoint*    epP;
+  struct sockaddr_in  addr;
+  bool                resolved = false;
+  time_t              now      = time(NULL);
+  int                 fd;
+
+  *reusedP    = false;
+  *endpointPP = NULL;
+
+  sem_wait(&orionldEndpointPoolSem);
+  epP = orionldEndpointLookup(host, port);
+  sem_post(&orionldEndpointPoolSem);
+
+  if (freeSlotTake(epP, waitMs) == false)
+  {
+    sem_wait(&orionldEndpointPoolSem);
+    ++orionldEndpointPoolStats.rejects;
+    sem_post(&orionldEndpointPoolSem);
+
+    if (waitMs > 0)  // Not waiting is the normal case for the notification senders - they just try again later
+      LM_W(("No free connection to %s:%d within %d ms (max %d connections per endpoint)", host, port, waitMs, orionldEndpointPoolMaxConnections));
+    errno = EAGAIN;
+    return -1;
+  }
+
+  sem_wait(&orionldEndpointPoolSem);
+
+  orionldEndpointIdlePurge(epP, now);
+
+  if ((fd = idleConnectionGet(epP)) != -1)
+  {
+    ++orionldEndpointPoolStats.reuses;
+    sem_post(&orionldEndpointPoolSem);
+
+    *endpointPP = epP;
+    *reusedP    = true;
+
+    blockingModeSet(fd, nonBlocking);
+    return fd;
+  }
+
+  //
+  // A free slot and no idle connection means that connections < max - a new connection is opened
+  //
+  ++epP->connections;
+
+  if (nonBlocking == true)
+  {
+    if (epP->resolvedAt != 0)
+    {
+      addr     = epP->addr;
+      resolved = true;
+      ++orionldEndpointPoolStats.dnsCacheHits;
+    }
+    else
+      LM_E(("No resolved address for %s:%d - not resolving it in non-blocking mode", host, port));
+
+    sem_post(&orionldEndpointPoolSem);
+  }
+  else
+  {
+    sem_post(&orionldEndpointPoolSem);
+    resolved = orionldEndpointResolve(host, port, &addr);
+  }
+
+  fd = -1;
+  if ((resolved == true) && ((fd = socket(AF_INET, SOCK_STREAM, 0)) == -1))
+    LM_E(("Can't even create a socket: %s", strerror(errno)));
+  else if (resolved == true)
+  {
+    int one = 1;
+
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    blockingModeSet(fd, nonBlocking);
+
+    if ((connect(fd, (struct sockaddr*) &addr, sizeof(addr)) == -1) && ((nonBlocking == false) || (errno != EINPROGRESS)))
+    {
+      LM_E(("Unable to connect to host/port: %s:%d: %s", host, port, strerror(errno)));
+      close(fd);
+      fd = -1;
+    }
+  }
+
+  sem_wait(&orionldEndpointPoolSem);
+  if (fd == -1)
+  {
+    ++orionldEndpointPoolStats.errors;
+    --epP->connections;
+    sem_post(&epP->freeSlots);
+  }
+  else
+  {
+    ++orionldEndpointPoolStats.connects;
+    *endpointPP = epP;
+  }
+  sem_post(&orionldEndpointPoolSem);
+
+  return fd;
+}
@@ -0,0 +1,50 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDENDPOINTCONNECT_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDENDPOINTCONNECT_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint16_t
+
+#include "orionld/common/orionldEndpointPool.h"                  // OrionldEndpoint
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldEndpointConnect - get a connection to host:port, reusing an idle keep-alive connection if possible
+//
+// RETURN VALUE
+//   The file descriptor of the connection, or -1 on error.
+//   If the endpoint has reached its max connections and none is released within 'waitMs' milliseconds
+//   (0: don't wait), -1 is returned with errno set to EAGAIN.
+//   *endpointPP is set to the endpoint the connection belongs to. *reusedP is set to true for reused connections.
+//   The connection must be given back using orionldEndpointRelease().
+//
+//   If 'nonBlocking' is true, the connection is in non-blocking mode, and a new connection may still be
+//   in progress (the socket becomes writable once connected).
+//
+extern int orionldEndpointConnect(const char* host, uint16_t port, bool nonBlocking, int waitMs, OrionldEndpoint** endpointPP, bool* reusedP);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDENDPOINTCONNECT_H_
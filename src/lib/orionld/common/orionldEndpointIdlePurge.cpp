@@ -0,0 +1,64 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                              // close
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldEndpointPool.h"                  // Endpoint Pool Internals
+#include "orionld/common/orionldEndpointIdlePurge.h"             // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldEndpointIdlePurge -
+//
+// The idle stack is ordered by idleSince, oldest at the bottom, so the timed out connections are
+// removed from the bottom and the rest are moved down.
+//
+void orionldEndpointIdlePurge(OrionldEndpoint* epP, time_t now)
+{
+  int expired = 0;
+
+  while ((expired < epP->idles) && (now - epP->idleSince[expired] > orionldEndpointPoolIdleTimeout))
+  {
+    close(epP->idleFd[expired]);
+    ++expired;
+  }
+
+  if (expired == 0)
+    return;
+
+  for (int ix = expired; ix < epP->idles; ix++)
+  {
+    epP->idleFd[ix - expired]    = epP->idleFd[ix];
+    epP->idleSince[ix - expired] = epP->idleSince[ix];
+  }
+
+  epP->idles                            -= expired;
+  epP->connections                      -= expired;
+  orionldEndpointPoolStats.idleTimeouts += expired;
+}
@@ -0,0 +1,67 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp, strdup, strerror
+#include <stdlib.h>                                              // calloc
+#include <errno.h>                                               // errno
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/stringHash.h"                           // stringHash
+#include "orionld/common/orionldEndpointPool.h"                  // Endpoint Pool Internals
+#include "orionld/common/orionldEndpointLookup.h"                // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldEndpointLookup -
+//
+OrionldEndpoint* orionldEndpointLookup(const char* host, uint16_t port)
+{
+  unsigned int      bucket = (stringHash(host) ^ port) % ORIONLD_ENDPOINT_POOL_BUCKETS;
+  OrionldEndpoint*  epP;
+
+  for (epP = orionldEndpointPool[bucket]; epP != NULL; epP = epP->next)
+  {
+    if ((epP->port == port) && (strcmp(epP->host, host) == 0))
+      return epP;
+  }
+
+  epP = (OrionldEndpoint*) calloc(1, sizeof(OrionldEndpoint));
+  if (epP == NULL)
+    LM_X(1, ("Runtime Error (out of memory allocating a notification endpoint)"));
+
+  epP->host                   = strdup(host);
+  epP->port                   = port;
+
+  if (sem_init(&epP->freeSlots, 0, orionldEndpointPoolMaxConnections) == -1)
+    LM_X(1, ("Runtime Error (error initializing the connection semaphore of a notification endpoint: %s)", strerror(errno)));
+
+  epP->next                   = orionldEndpointPool[bucket];
+  orionldEndpointPool[bucket] = epP;
+
+  return epP;
+}
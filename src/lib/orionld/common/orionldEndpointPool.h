@@ -0,0 +1,126 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDENDPOINTPOOL_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDENDPOINTPOOL_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint16_t
+#include <time.h>                                                // time_t
+#include <semaphore.h>                                           // sem_t
+#include <netinet/in.h>                                          // sockaddr_in
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_ENDPOINT_POOL_BUCKETS - number of buckets of the hash table of endpoints
+//
+#define ORIONLD_ENDPOINT_POOL_BUCKETS  256
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_ENDPOINT_DNS_TTL - seconds that the resolved address of an endpoint is used before resolving it again
+//
+#define ORIONLD_ENDPOINT_DNS_TTL  60
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_ENDPOINT_MAX_CONNECTIONS - upper limit for the CLI option -notifPoolSize
+//
+#define ORIONLD_ENDPOINT_MAX_CONNECTIONS  64
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_ENDPOINT_WAIT_TIMEOUT - milliseconds to wait for a free connection, when an endpoint has reached its max connections
+//
+#define ORIONLD_ENDPOINT_WAIT_TIMEOUT  5000
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldEndpoint - a notification endpoint (host:port) and its pool of idle keep-alive connections
+//
+// 'connections' counts all pooled connections to the endpoint, both in use and idle.
+// Idle connections are kept in a stack, the most recently used on top.
+// 'freeSlots' is a counting semaphore of the connections that are not in use (max connections minus the connections
+// in use). It is taken (waiting if need be) before a connection is given out, and given back as the connection is
+// released - that is how the max number of connections per endpoint is enforced.
+//
+typedef struct OrionldEndpoint
+{
+  char*                    host;
+  uint16_t                 port;
+  struct sockaddr_in       addr;
+  time_t                   resolvedAt;
+  int                      connections;
+  sem_t                    freeSlots;
+  int                      idles;
+  int                      idleFd[ORIONLD_ENDPOINT_MAX_CONNECTIONS];
+  time_t                   idleSince[ORIONLD_ENDPOINT_MAX_CONNECTIONS];
+  struct OrionldEndpoint*  next;
+} OrionldEndpoint;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldEndpointPoolStats -
+//
+typedef struct OrionldEndpointPoolStats
+{
+  unsigned long long  connects;      // New connections
+  unsigned long long  reuses;        // Idle connections that were reused
+  unsigned long long  kept;          // Connections that were kept idle after use
+  unsigned long long  closes;        // Connections that were closed after use (not reusable)
+  unsigned long long  staleClosed;   // Idle connections found closed by the peer
+  unsigned long long  idleTimeouts;  // Idle connections closed due to the idle timeout
+  unsigned long long  waits;         // Waits for a free connection, as the endpoint had reached its max connections
+  unsigned long long  rejects;       // No free connection (non-blocking, or not within ORIONLD_ENDPOINT_WAIT_TIMEOUT)
+  unsigned long long  dnsLookups;
+  unsigned long long  dnsCacheHits;
+  unsigned long long  errors;        // Unable to resolve or connect
+} OrionldEndpointPoolStats;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldEndpointPool - the pool of keep-alive connections to notification endpoints
+//
+// All accesses are protected by orionldEndpointPoolSem.
+//
+extern sem_t                     orionldEndpointPoolSem;
+extern OrionldEndpoint*          orionldEndpointPool[ORIONLD_ENDPOINT_POOL_BUCKETS];
+extern int                       orionldEndpointPoolMaxConnections;  // Per endpoint - CLI option -notifPoolSize
+extern int                       orionldEndpointPoolIdleTimeout;     // Seconds - CLI option -notifIdleTimeout
+extern OrionldEndpointPoolStats  orionldEndpointPoolStats;
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDENDPOINTPOOL_H_
@@ -0,0 +1,54 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strerror
+#include <strings.h>                                             // bzero
+#include <errno.h>                                               // errno
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldEndpointPool.h"                  // Endpoint Pool Internals
+#include "orionld/common/orionldEndpointPoolInit.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldEndpointPoolInit -
+//
+void orionldEndpointPoolInit(int maxConnections, int idleTimeout)
+{
+  bzero(orionldEndpointPool,       sizeof(orionldEndpointPool));
+  bzero(&orionldEndpointPoolStats, sizeof(orionldEndpointPoolStats));
+
+  if (maxConnections > ORIONLD_ENDPOINT_MAX_CONNECTIONS)
+    maxConnections = ORIONLD_ENDPOINT_MAX_CONNECTIONS;
+
+  orionldEndpointPoolMaxConnections = maxConnections;
+  orionldEndpointPoolIdleTimeout    = idleTimeout;
+
+  if (sem_init(&orionldEndpointPoolSem, 0, 1) == -1)
+    LM_X(1, ("Runtime Error (error initializing semaphore for the notification endpoint pool; %s)", strerror(errno)));
+}
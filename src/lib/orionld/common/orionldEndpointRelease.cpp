@@ -0,0 +1,75 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                              // close
+#include <time.h>                                                // time
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldEndpointPool.h"                  // Endpoint Pool Internals
+#include "orionld/common/orionldEndpointIdlePurge.h"             // orionldEndpointIdlePurge
+#include "orionld/common/orionldEndpointRelease.h"               // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldEndpointRelease -
+//
+void orionldEndpointRelease(OrionldEndpoint* epP, int fd, bool reusable)
+{
+  if (fd == -1)
+    return;
+
+  sem_wait(&orionldEndpointPoolSem);
+
+  if (epP == NULL)  // Connection outside the pool
+  {
+    close(fd);
+    ++orionldEndpointPoolStats.closes;
+  }
+  else if ((reusable == true) && (epP->idles < orionldEndpointPoolMaxConnections) && (orionldEndpointPoolIdleTimeout > 0))
+  {
+    time_t now = time(NULL);
+
+    orionldEndpointIdlePurge(epP, now);
+
+    epP->idleFd[epP->idles]    = fd;
+    epP->idleSince[epP->idles] = now;
+    ++epP->idles;
+    ++orionldEndpointPoolStats.kept;
+  }
+  else
+  {
+    close(fd);
+    --epP->connections;
+    ++orionldEndpointPoolStats.closes;
+  }
+
+  if (epP != NULL)
+    sem_post(&epP->freeSlots);
+
+  sem_post(&orionldEndpointPoolSem);
+}
@@ -0,0 +1,114 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // memset, memcpy
+#include <time.h>                                                // time
+#include <sys/types.h>                                           // types
+#include <sys/socket.h>                                          // SOCK_STREAM
+#include <netinet/in.h>                                          // sockaddr_in
+#include <netdb.h>                                               // getaddrinfo
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldEndpointPool.h"                  // Endpoint Pool Internals
+#include "orionld/common/orionldEndpointLookup.h"                // orionldEndpointLookup
+#include "orionld/common/orionldEndpointResolve.h"               // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// hostResolve -
+//
+static bool hostResolve(const char* host, uint16_t port, struct sockaddr_in* addrP)
+{
+  struct addrinfo   hints;
+  struct addrinfo*  resultP = NULL;
+  int               err;
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family   = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  if ((err = getaddrinfo(host, NULL, &hints, &resultP)) != 0)
+  {
+    LM_E(("unable to find host '%s': %s", host, gai_strerror(err)));
+    return false;
+  }
+
+  memcpy(addrP, resultP->ai_addr, sizeof(struct sockaddr_in));
+  addrP->sin_port = htons(port);
+
+  freeaddrinfo(resultP);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldEndpointResolve -
+//
+// The semaphore is not held while resolving the host name, as that may take time.
+//
+bool orionldEndpointResolve(const char* host, uint16_t port, struct sockaddr_in* addrP)
+{
+  struct sockaddr_in  addr;
+  time_t              now = time(NULL);
+  OrionldEndpoint*    epP;
+
+  sem_wait(&orionldEndpointPoolSem);
+
+  epP = orionldEndpointLookup(host, port);
+
+  if ((epP->resolvedAt != 0) && (now - epP->resolvedAt <= ORIONLD_ENDPOINT_DNS_TTL))
+  {
+    addr = epP->addr;
+    ++orionldEndpointPoolStats.dnsCacheHits;
+    sem_post(&orionldEndpointPoolSem);
+
+    if (addrP != NULL)
+      *addrP = addr;
+
+    return true;
+  }
+
+  ++orionldEndpointPoolStats.dnsLookups;
+  sem_post(&orionldEndpointPoolSem);
+
+  if (hostResolve(host, port, &addr) == false)
+    return false;
+
+  sem_wait(&orionldEndpointPoolSem);
+  epP->addr       = addr;
+  epP->resolvedAt = now;
+  sem_post(&orionldEndpointPoolSem);
+
+  if (addrP != NULL)
+    *addrP = addr;
+
+  return true;
+}
@@ -0,0 +1,46 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDENDPOINTRESOLVE_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDENDPOINTRESOLVE_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint16_t
+#include <netinet/in.h>                                          // sockaddr_in
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldEndpointResolve - get the address of an endpoint, from the DNS cache of the endpoint pool or resolving it
+//
+// The host name is resolved (getaddrinfo - blocking) if not in the cache or if the cached address is older than
+// ORIONLD_ENDPOINT_DNS_TTL. So, this function must not be called from the loop of a notification sender - the
+// addresses are resolved when the notifications are queued (notificationEnqueue).
+//
+// RETURN VALUE
+//   true if the address was found, in *addrP (if addrP != NULL), false if the host couldn't be resolved
+//
+extern bool orionldEndpointResolve(const char* host, uint16_t port, struct sockaddr_in* addrP);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDENDPOINTRESOLVE_H_
@@ -0,0 +1,207 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strncmp, strncasecmp, strcasestr
+#include <stdlib.h>                                              // strtoll, strtol, atoi
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/OrionldHttpResponseParser.h"            // OrionldHttpResponseParser
+#include "orionld/common/orionldHttpResponseParse.h"             // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// headersEnd - the empty line after the headers has been reached - what comes next depends on the headers
+//
+static void headersEnd(OrionldHttpResponseParser* parserP)
+{
+  if (parserP->statusCode / 100 == 1)  // Informational response (1xx) - skipped
+    parserP->state = HrsStatusLine;
+  else if ((parserP->statusCode == 204) || (parserP->statusCode == 304))
+    parserP->state = HrsDone;
+  else if (parserP->chunked == true)
+    parserP->state = HrsChunkSize;
+  else if (parserP->contentLengthGiven == true)
+  {
+    parserP->toSkip = parserP->contentLength;
+    parserP->state  = (parserP->toSkip > 0)? HrsBody : HrsDone;
+  }
+  else
+  {
+    parserP->keepAlive = false;
+    parserP->state     = HrsUntilClose;
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// lineTreat - treat a complete line (without the ending CRLF) of the response
+//
+static bool lineTreat(OrionldHttpResponseParser* parserP)
+{
+  char* line = parserP->line;
+
+  switch (parserP->state)
+  {
+  case HrsStatusLine:
+    if (strncmp(line, "HTTP/1.", 7) != 0)
+    {
+      LM_E(("Internal Error (not an HTTP response: '%s')", line));
+      return false;
+    }
+
+    parserP->keepAlive          = (line[7] == '1');  // HTTP/1.1 is keep-alive by default, HTTP/1.0 is not
+    parserP->statusCode         = atoi(&line[9]);
+    parserP->chunked            = false;
+    parserP->contentLengthGiven = false;
+
+    if (parserP->statusCode < 100)
+    {
+      LM_E(("Internal Error (invalid HTTP status line: '%s')", line));
+      return false;
+    }
+
+    parserP->state = HrsHeaders;
+    break;
+
+  case HrsHeaders:
+    if (*line == 0)
+      headersEnd(parserP);
+    else if (strncasecmp(line, "Content-Length:", 15) == 0)
+    {
+      parserP->contentLength      = strtoll(&line[15], NULL, 10);
+      parserP->contentLengthGiven = true;
+    }
+    else if ((strncasecmp(line, "Transfer-Encoding:", 18) == 0) && (strcasestr(&line[18], "chunked") != NULL))
+      parserP->chunked = true;
+    else if (strncasecmp(line, "Connection:", 11) == 0)
+    {
+      if (strcasestr(&line[11], "close") != NULL)
+        parserP->keepAlive = false;
+      else if (strcasestr(&line[11], "keep-alive") != NULL)
+        parserP->keepAlive = true;
+    }
+    break;
+
+  case HrsChunkSize:
+    parserP->toSkip = strtol(line, NULL, 16);
+    parserP->state  = (parserP->toSkip == 0)? HrsTrailers : HrsChunkData;
+    break;
+
+  case HrsChunkDataEnd:
+    parserP->state = HrsChunkSize;
+    break;
+
+  case HrsTrailers:
+    if (*line == 0)
+      parserP->state = HrsDone;
+    break;
+
+  default:
+    break;
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldHttpResponseParse -
+//
+// The status line, the headers, and the framing of the payload body (Content-Length, chunked Transfer-Encoding,
+// or end of connection) are parsed, so that the connection can be reused afterwards.
+// Any data after the end of the response (a response not asked for?) makes the connection unusable.
+//
+int orionldHttpResponseParse(OrionldHttpResponseParser* parserP, const char* data, int dataLen)
+{
+  if (dataLen == 0)  // Connection closed by the peer
+  {
+    parserP->keepAlive = false;
+
+    if (parserP->state == HrsUntilClose)
+      parserP->state = HrsDone;
+
+    return (parserP->state == HrsDone)? parserP->statusCode : -1;
+  }
+
+  int ix = 0;
+
+  while ((ix < dataLen) && (parserP->state != HrsDone))
+  {
+    if (parserP->state == HrsUntilClose)
+      return 0;
+
+    if ((parserP->state == HrsBody) || (parserP->state == HrsChunkData))
+    {
+      int64_t skip = dataLen - ix;
+
+      if (skip > parserP->toSkip)
+        skip = parserP->toSkip;
+
+      ix              += skip;
+      parserP->toSkip -= skip;
+
+      if (parserP->toSkip == 0)
+        parserP->state = (parserP->state == HrsBody)? HrsDone : HrsChunkDataEnd;
+
+      continue;
+    }
+
+    //
+    // A line - kept (truncated if too long) until its end
+    //
+    char c = data[ix++];
+
+    if (c != '\n')
+    {
+      if (parserP->lineLen < ORIONLD_HTTP_RESPONSE_LINE_MAX - 1)
+        parserP->line[parserP->lineLen++] = c;
+      continue;
+    }
+
+    if ((parserP->lineLen > 0) && (parserP->line[parserP->lineLen - 1] == '\r'))
+      --parserP->lineLen;
+
+    parserP->line[parserP->lineLen] = 0;
+    parserP->lineLen                = 0;
+
+    if (lineTreat(parserP) == false)
+      return -1;
+  }
+
+  if (parserP->state != HrsDone)
+    return 0;
+
+  if (ix < dataLen)
+    parserP->keepAlive = false;
+
+  return parserP->statusCode;
+}
@@ -0,0 +1,45 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDHTTPRESPONSEPARSE_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDHTTPRESPONSEPARSE_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/common/OrionldHttpResponseParser.h"            // OrionldHttpResponseParser
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldHttpResponseParse - feed a piece of an HTTP/1.x response to the parser
+//
+// 'dataLen' == 0 means that the connection has been closed by the peer.
+//
+// RETURN VALUE
+//    0:  the response is not complete - more data is needed
+//   -1:  error (not an HTTP response, or the connection was closed before the end of the response)
+//   >0:  the response is complete - the HTTP status code. parserP->keepAlive tells whether the connection can be reused
+//
+extern int orionldHttpResponseParse(OrionldHttpResponseParser* parserP, const char* data, int dataLen);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDHTTPRESPONSEPARSE_H_
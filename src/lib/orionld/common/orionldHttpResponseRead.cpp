@@ -0,0 +1,83 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strerror
+#include <strings.h>                                             // bzero
+#include <errno.h>                                               // errno
+#include <unistd.h>                                              // read
+#include <poll.h>                                                // poll
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/OrionldHttpResponseParser.h"            // OrionldHttpResponseParser
+#include "orionld/common/orionldHttpResponseParse.h"             // orionldHttpResponseParse
+#include "orionld/common/orionldHttpResponseRead.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldHttpResponseRead -
+//
+// Blocking version of orionldHttpResponseParse - reads from the connection until the response is complete,
+// waiting at most 'timeoutMs' milliseconds for each piece of the response.
+//
+int orionldHttpResponseRead(int fd, char* buf, int bufSize, int timeoutMs, bool* keepAliveP)
+{
+  OrionldHttpResponseParser  parser;
+  int                        statusCode = 0;
+
+  bzero(&parser, sizeof(parser));
+  *keepAliveP = false;
+
+  while (statusCode == 0)
+  {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+
+    if (poll(&pfd, 1, timeoutMs) <= 0)
+    {
+      LM_E(("Internal Error (timeout reading HTTP response)"));
+      return -1;
+    }
+
+    int nb = read(fd, buf, bufSize);
+
+    if (nb == -1)
+    {
+      if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK))
+        continue;
+
+      LM_E(("Internal Error (reading HTTP response: %s)", strerror(errno)));
+      return -1;
+    }
+
+    statusCode = orionldHttpResponseParse(&parser, buf, nb);
+  }
+
+  if (statusCode > 0)
+    *keepAliveP = parser.keepAlive;
+
+  return statusCode;
+}
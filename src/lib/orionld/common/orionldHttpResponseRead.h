@@ -0,0 +1,44 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDHTTPRESPONSEREAD_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDHTTPRESPONSEREAD_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+// -----------------------------------------------------------------------------
+//
+// orionldHttpResponseRead - read an entire HTTP/1.x response from a connection
+//
+// The response is framed according to its headers (Content-Length, chunked Transfer-Encoding or end of connection),
+// so that the connection can be reused afterwards. The payload body is not kept - 'buf' is only used as read buffer.
+//
+// This is the blocking version of orionldHttpResponseParse, for connections in blocking mode. Event loops
+// (the notification senders) read what is available and feed it to orionldHttpResponseParse instead.
+//
+// RETURN VALUE
+//   The HTTP status code of the response, or -1 on error or timeout.
+//   *keepAliveP is set to true if the connection can be reused.
+//
+extern int orionldHttpResponseRead(int fd, char* buf, int bufSize, int timeoutMs, bool* keepAliveP);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDHTTPRESPONSEREAD_H_
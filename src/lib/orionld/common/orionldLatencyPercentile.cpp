@@ -0,0 +1,86 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/types/OrionldLatencyHistogram.h"             // OrionldLatencyHistogram, LATENCY_*
+#include "orionld/common/orionldLatencyPercentile.h"           // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// bucketHighest - the highest value that goes to bucket 'ix' - see bucketIndex() in orionldLatencyRecord.cpp
+//
+static unsigned long long bucketHighest(int ix)
+{
+  if (ix < LATENCY_SUB_BUCKETS)
+    return ix;
+
+  int                 shift = ix / LATENCY_SUB_BUCKETS - 1;
+  unsigned long long  sub   = ix % LATENCY_SUB_BUCKETS;
+  unsigned long long  low   = (LATENCY_SUB_BUCKETS + sub) << shift;
+
+  return low + (1ULL << shift) - 1;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyPercentile -
+//
+unsigned long long orionldLatencyPercentile(OrionldLatencyHistogram* hP, double percentile)
+{
+  unsigned long long count = 0;
+  unsigned long long target;
+
+  //
+  // The sum of the buckets is used instead of hP->count - they may differ slightly while requests are being recorded
+  //
+  for (int ix = 0; ix < LATENCY_BUCKETS; ix++)
+    count += hP->bucketV[ix];
+
+  if (count == 0)
+    return 0;
+
+  target = (unsigned long long) (count * percentile / 100);
+  if (target * 100 < count * percentile)
+    ++target;  // Round up
+  if (target == 0)
+    target = 1;
+
+  count = 0;
+  for (int ix = 0; ix < LATENCY_BUCKETS; ix++)
+  {
+    count += hP->bucketV[ix];
+
+    if (count >= target)
+    {
+      unsigned long long value = bucketHighest(ix);
+
+      return (value < hP->max)? value : hP->max;
+    }
+  }
+
+  return hP->max;
+}
@@ -0,0 +1,66 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/types/OrionldLatencyHistogram.h"             // OrionldLatencyHistogram, LATENCY_*
+#include "orionld/common/orionldLatencyRecord.h"               // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// bucketIndex -
+//
+// Values in [2^msb, 2^(msb+1)) are split in LATENCY_SUB_BUCKETS buckets, using the bits right after the most significant one.
+//
+static int bucketIndex(unsigned long long us)
+{
+  if (us < LATENCY_SUB_BUCKETS)
+    return us;
+
+  if (us >= (1ULL << LATENCY_MAX_BITS))
+    return LATENCY_BUCKETS - 1;
+
+  int msb   = 63 - __builtin_clzll(us);
+  int shift = msb - LATENCY_SUB_BUCKET_BITS;
+
+  return (shift + 1) * LATENCY_SUB_BUCKETS + ((us >> shift) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyRecord -
+//
+void orionldLatencyRecord(OrionldLatencyHistogram* hP, unsigned long long us)
+{
+  unsigned long long max = hP->max;
+
+  __sync_fetch_and_add(&hP->count, 1);
+  __sync_fetch_and_add(&hP->sum, us);
+  __sync_fetch_and_add(&hP->bucketV[bucketIndex(us)], 1);
+
+  while ((us > max) && (__sync_bool_compare_and_swap(&hP->max, max, us) == false))
+    max = hP->max;
+}
@@ -0,0 +1,82 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // memcpy, bzero
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, OrionldNotificationInfo
+#include "orionld/common/orionldNotificationInfoAdd.h"           // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_INFO_INITIAL_SIZE -
+//
+#define NOTIFICATION_INFO_INITIAL_SIZE  16
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldNotificationInfoAdd -
+//
+// When full, the vector is doubled in size. The old vector is not freed - it belongs to the request's allocator
+// and is freed together with everything else when the request ends.
+//
+OrionldNotificationInfo* orionldNotificationInfoAdd(void)
+{
+  if (orionldState.notificationRecords >= orionldState.notificationInfoSize)
+  {
+    int                       newSize = (orionldState.notificationInfoSize == 0)? NOTIFICATION_INFO_INITIAL_SIZE : orionldState.notificationInfoSize * 2;
+    OrionldNotificationInfo*  newV    = (OrionldNotificationInfo*) kaAlloc(&orionldState.kalloc, newSize * sizeof(OrionldNotificationInfo));
+
+    if (newV == NULL)
+    {
+      LM_E(("Out of memory (allocating room for %d notifications)", newSize));
+      return NULL;
+    }
+
+    if (orionldState.notificationRecords > 0)
+      memcpy(newV, orionldState.notificationInfo, orionldState.notificationRecords * sizeof(OrionldNotificationInfo));
+
+    LM_T(LmtSubCache, ("Room for %d notifications", newSize));
+    orionldState.notificationInfo     = newV;
+    orionldState.notificationInfoSize = newSize;
+  }
+
+  OrionldNotificationInfo* niP = &orionldState.notificationInfo[orionldState.notificationRecords];
+
+  bzero(niP, sizeof(OrionldNotificationInfo));
+  orionldState.notificationRecords += 1;
+
+  return niP;
+}
@@ -0,0 +1,430 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <stdlib.h>                                              // malloc, realloc, free
+#include <string.h>                                              // memcpy, strcmp, strlen
+#include <strings.h>                                             // bzero
+#include <errno.h>                                               // EBUSY
+#include <time.h>                                                // clock_gettime
+#include <curl/curl.h>                                           // curl
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/sem.h"                                          // get_curl_context_try, release_curl_context, curlMaxPerHost
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/orionldRequestSendMulti.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// RequestTransfer - the state of the transfer of one OrionldRequest
+//
+typedef struct RequestTransfer
+{
+  OrionldRequest*       requestP;
+  struct curl_context   cc;
+  struct curl_slist*    headers;
+  char*                 buf;
+  size_t                size;
+  size_t                used;
+  struct timespec       startTime;
+  bool                  started;
+  bool                  done;
+} RequestTransfer;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// headerName - same names as in orionldRequestSend
+//
+static const char* headerName[6] = {
+  "None",
+  "Content-Type",
+  "Accept",
+  "Link",
+  "NGSILD-Tenant",
+  "NGSILD-Path"
+};
+
+
+
+// -----------------------------------------------------------------------------
+//
+// msSince -
+//
+static int msSince(struct timespec* startP)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (now.tv_sec - startP->tv_sec) * 1000 + (now.tv_nsec - startP->tv_nsec) / 1000000;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// writeCallback -
+//
+// The response is accumulated in a malloced buffer, that is copied to orionldState.kalloc once the transfer is done
+//
+static size_t writeCallback(void* contents, size_t size, size_t members, void* userP)
+{
+  size_t            bytesToCopy = size * members;
+  RequestTransfer*  tP          = (RequestTransfer*) userP;
+
+  if (tP->used + bytesToCopy + 1 > tP->size)
+  {
+    size_t  newSize = tP->size + bytesToCopy + 2048;
+    char*   newBuf  = (char*) realloc(tP->buf, newSize);
+
+    if (newBuf == NULL)
+    {
+      LM_E(("Runtime Error (out of memory)"));
+      return 0;  // Aborts the transfer
+    }
+
+    tP->buf  = newBuf;
+    tP->size = newSize;
+  }
+
+  memcpy(&tP->buf[tP->used], contents, bytesToCopy);
+  tP->used += bytesToCopy;
+
+  return bytesToCopy;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// hostInFlight - number of transfers to 'host' that have been started but not finished
+//
+static int hostInFlight(RequestTransfer* transferV, int transfers, const char* host)
+{
+  int inFlight = 0;
+
+  for (int ix = 0; ix < transfers; ix++)
+  {
+    if ((transferV[ix].started == true) && (transferV[ix].done == false) && (strcmp(transferV[ix].requestP->host, host) == 0))
+      ++inFlight;
+  }
+
+  return inFlight;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// transferFail -
+//
+static void transferFail(RequestTransfer* tP, const char* detail, bool timedOut)
+{
+  tP->done                = true;
+  tP->requestP->ok        = false;
+  tP->requestP->timedOut  = timedOut;
+  tP->requestP->detail    = detail;
+  tP->requestP->latencyMs = (tP->started == true)? msSince(&tP->startTime) : 0;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// transferEnd - collect the result of a transfer and give back its curl handle
+//
+static void transferEnd(CURLM* multiP, RequestTransfer* tP, CURLcode cCode)
+{
+  OrionldRequest* reqP = tP->requestP;
+
+  if (tP->done == false)
+  {
+    tP->done        = true;
+    reqP->latencyMs = msSince(&tP->startTime);
+
+    curl_easy_getinfo(tP->cc.curl, CURLINFO_RESPONSE_CODE, &reqP->httpStatus);
+
+    if (cCode == CURLE_OK)
+    {
+      reqP->ok          = true;
+      reqP->responseLen = tP->used;
+      reqP->response    = (char*) kaAlloc(&orionldState.kalloc, tP->used + 1);
+
+      if (tP->used > 0)
+        memcpy(reqP->response, tP->buf, tP->used);
+      reqP->response[tP->used] = 0;
+    }
+    else
+    {
+      reqP->ok       = false;
+      reqP->timedOut = (cCode == CURLE_OPERATION_TIMEDOUT);
+      reqP->detail   = curl_easy_strerror(cCode);
+    }
+
+    LM_T(LmtRequestSend, ("Request to %s:%d done in %d ms (%s, HTTP status %ld)", reqP->host, reqP->port, reqP->latencyMs, (reqP->ok == true)? "OK" : reqP->detail, reqP->httpStatus));
+  }
+
+  curl_multi_remove_handle(multiP, tP->cc.curl);
+  release_curl_context(&tP->cc);
+
+  if (tP->headers != NULL)
+    curl_slist_free_all(tP->headers);
+  tP->headers = NULL;
+
+  free(tP->buf);
+  tP->buf = NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// transfersInFlight - number of transfers that have been started but not finished
+//
+static int transfersInFlight(RequestTransfer* transferV, int transfers)
+{
+  int inFlight = 0;
+
+  for (int ix = 0; ix < transfers; ix++)
+  {
+    if ((transferV[ix].started == true) && (transferV[ix].done == false))
+      ++inFlight;
+  }
+
+  return inFlight;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// transferStart - prepare the curl handle of a request and add it to the multi handle
+//
+// The curl context is taken without blocking (more than 'waitMs') - the host may be at its limit (-curlMaxPerHost)
+// due to transfers of other threads, and while waiting, the transfers of this thread wouldn't progress.
+// If no curl context is available, the transfer stays pending (not started), to be started in a later round.
+//
+// RETURN VALUE
+//   true if the transfer was started (or failed), false if it is still pending
+//
+static bool transferStart(CURLM* multiP, RequestTransfer* tP, int tmoInMilliSeconds, int waitMs)
+{
+  OrionldRequest*  reqP   = tP->requestP;
+  int              urlLen = strlen(reqP->protocol) + strlen(reqP->host) + strlen(reqP->urlPath) + 16;
+  char*            url;
+
+  if (get_curl_context_try(reqP->host, &tP->cc, waitMs) == EBUSY)
+  {
+    LM_T(LmtRequestSend, ("No curl context for %s right now - the request stays pending", reqP->host));
+    return false;
+  }
+
+  tP->started = true;
+  clock_gettime(CLOCK_MONOTONIC, &tP->startTime);
+
+  if (tP->cc.curl == NULL)
+  {
+    LM_E(("Internal Error (Unable to obtain CURL context)"));
+    transferFail(tP, "Unable to obtain CURL context", false);
+    return true;
+  }
+
+  url = (char*) kaAlloc(&orionldState.kalloc, urlLen);
+
+  if (reqP->port != 0)
+    snprintf(url, urlLen, "%s://%s:%d%s", reqP->protocol, reqP->host, reqP->port, reqP->urlPath);
+  else
+    snprintf(url, urlLen, "%s://%s%s", reqP->protocol, reqP->host, reqP->urlPath);
+
+  LM_T(LmtRequestSend, ("Starting request to %s", url));
+
+  if (reqP->linkHeader != NULL)
+  {
+    int   linkLen = strlen(reqP->linkHeader) + 8;
+    char* link    = (char*) kaAlloc(&orionldState.kalloc, linkLen);
+
+    snprintf(link, linkLen, "Link: %s", reqP->linkHeader);
+    tP->headers = curl_slist_append(tP->headers, link);
+  }
+
+  if (reqP->acceptHeader != NULL)
+    tP->headers = curl_slist_append(tP->headers, reqP->acceptHeader);
+
+  for (int ix = 0; (reqP->headerV != NULL) && (reqP->headerV[ix].type != HttpHeaderNone); ix++)
+  {
+    char headerString[256];
+
+    snprintf(headerString, sizeof(headerString), "%s:%s", headerName[reqP->headerV[ix].type], reqP->headerV[ix].value);
+    tP->headers = curl_slist_append(tP->headers, headerString);
+  }
+
+  curl_easy_setopt(tP->cc.curl, CURLOPT_URL, url);                         // Set the URL Path
+  curl_easy_setopt(tP->cc.curl, CURLOPT_CUSTOMREQUEST, reqP->verb);        // Set the HTTP verb
+  curl_easy_setopt(tP->cc.curl, CURLOPT_FOLLOWLOCATION, 1L);               // Follow redirections
+  curl_easy_setopt(tP->cc.curl, CURLOPT_WRITEFUNCTION, writeCallback);     // Callback function for writes
+  curl_easy_setopt(tP->cc.curl, CURLOPT_WRITEDATA, tP);                    // Custom data for response handling
+  curl_easy_setopt(tP->cc.curl, CURLOPT_TIMEOUT_MS, tmoInMilliSeconds);    // What's left of the overall deadline
+  curl_easy_setopt(tP->cc.curl, CURLOPT_FAILONERROR, true);                // Fail On Error - to detect 404 etc.
+  curl_easy_setopt(tP->cc.curl, CURLOPT_NOSIGNAL, 1L);                     // No SIGALRM for timeouts - we're multi-threaded
+  curl_easy_setopt(tP->cc.curl, CURLOPT_PRIVATE, tP);                      // To find the transfer when the easy handle is done
+  curl_easy_setopt(tP->cc.curl, CURLOPT_HTTPHEADER, tP->headers);
+
+  if (curl_multi_add_handle(multiP, tP->cc.curl) != CURLM_OK)
+  {
+    LM_E(("Internal Error (curl_multi_add_handle failed)"));
+    transferFail(tP, "Unable to start CURL transfer", false);
+    transferEnd(multiP, tP, CURLE_FAILED_INIT);  // Gives back the curl context
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldRequestSendMulti - send a number of requests concurrently and await all responses, or the deadline
+//
+// All requests are in flight at the same time (using a curl multi handle in the calling thread), so the time
+// this function takes is that of the slowest request, not the sum of all of them.
+// The only exception is the per-host limit (-curlMaxPerHost) - requests to a host that is at its limit are
+// started as soon as another request to the same host finishes (a request of this thread, or of any other thread).
+// The calling thread only waits for a curl context when it has no transfer of its own in flight.
+//
+// tmoInMilliSeconds is an overall deadline. Requests that aren't done when it expires are aborted and marked 'timedOut'.
+//
+void orionldRequestSendMulti(OrionldRequest* requestV, int requests, int tmoInMilliSeconds)
+{
+  RequestTransfer*  transferV = (RequestTransfer*) kaAlloc(&orionldState.kalloc, requests * sizeof(RequestTransfer));
+  CURLM*            multiP    = curl_multi_init();
+  struct timespec   startTime;
+
+  clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+  bzero(transferV, requests * sizeof(RequestTransfer));
+  for (int ix = 0; ix < requests; ix++)
+  {
+    transferV[ix].requestP  = &requestV[ix];
+
+    requestV[ix].ok          = false;
+    requestV[ix].timedOut    = false;
+    requestV[ix].httpStatus  = 0;
+    requestV[ix].latencyMs   = 0;
+    requestV[ix].detail      = NULL;
+    requestV[ix].response    = NULL;
+    requestV[ix].responseLen = 0;
+  }
+
+  if (multiP == NULL)
+  {
+    LM_E(("Internal Error (curl_multi_init failed)"));
+    for (int ix = 0; ix < requests; ix++)
+      transferFail(&transferV[ix], "Unable to create CURL multi handle", false);
+    return;
+  }
+
+  while (1)
+  {
+    int remainingMs = tmoInMilliSeconds - msSince(&startTime);
+    int notStarted  = 0;
+    int inFlight    = 0;
+    int running     = transfersInFlight(transferV, requests);
+
+    if (remainingMs <= 0)
+      break;
+
+    for (int ix = 0; ix < requests; ix++)
+    {
+      RequestTransfer* tP = &transferV[ix];
+
+      if ((tP->started == false) && ((curlMaxPerHost <= 0) || (hostInFlight(transferV, requests, tP->requestP->host) < curlMaxPerHost)))
+      {
+        //
+        // Nothing of this thread in flight - nothing is delayed by waiting a little for a curl context
+        //
+        int waitMs = (running == 0)? ((remainingMs < 100)? remainingMs : 100) : 0;
+
+        if (transferStart(multiP, tP, remainingMs, waitMs) == true)
+          ++running;
+      }
+
+      if (tP->started == false)
+        ++notStarted;
+      else if (tP->done == false)
+        ++inFlight;
+    }
+
+    if ((notStarted == 0) && (inFlight == 0))
+      break;
+
+    int stillRunning;
+    curl_multi_perform(multiP, &stillRunning);
+
+    CURLMsg* msgP;
+    int      msgsLeft;
+
+    while ((msgP = curl_multi_info_read(multiP, &msgsLeft)) != NULL)
+    {
+      if (msgP->msg == CURLMSG_DONE)
+      {
+        RequestTransfer* tP;
+
+        curl_easy_getinfo(msgP->easy_handle, CURLINFO_PRIVATE, (char**) &tP);
+        transferEnd(multiP, tP, msgP->data.result);
+      }
+    }
+
+    if (stillRunning > 0)
+      curl_multi_wait(multiP, NULL, 0, (remainingMs < 100)? remainingMs : 100, NULL);
+  }
+
+  //
+  // The deadline has expired - abort what's still pending
+  //
+  for (int ix = 0; ix < requests; ix++)
+  {
+    RequestTransfer* tP = &transferV[ix];
+
+    if (tP->started == false)
+      transferFail(tP, "Deadline expired before the request could be sent", true);
+    else if (tP->done == false)
+    {
+      transferFail(tP, "Deadline expired", true);
+      transferEnd(multiP, tP, CURLE_OPERATION_TIMEDOUT);
+    }
+  }
+
+  curl_multi_cleanup(multiP);
+}
@@ -0,0 +1,71 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDREQUESTSENDMULTI_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDREQUESTSENDMULTI_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint16_t
+
+#include "orionld/common/orionldRequestSend.h"                   // OrionldHttpHeader
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldRequest - one of the requests sent by orionldRequestSendMulti
+//
+// The caller fills in the input fields, orionldRequestSendMulti fills in the output fields.
+// The response body is allocated in orionldState.kalloc and is zero-terminated.
+//
+typedef struct OrionldRequest
+{
+  // Input
+  const char*          protocol;
+  const char*          host;
+  uint16_t             port;
+  const char*          verb;
+  const char*          urlPath;
+  const char*          linkHeader;        // "<url>; rel=...", without the header name. NULL if no Link header
+  const char*          acceptHeader;      // "Accept: application/json"
+  OrionldHttpHeader*   headerV;           // Terminated by an item of type HttpHeaderNone
+
+  // Output
+  bool                 ok;                // A response with a 2xx status code was received
+  bool                 timedOut;          // The overall deadline expired before the response was complete
+  long                 httpStatus;        // 0 if no response was received
+  int                  latencyMs;         // From start of the request until response complete (or failure)
+  const char*          detail;            // Reason of the failure, if !ok
+  char*                response;          // Response body (NULL if !ok)
+  int                  responseLen;
+} OrionldRequest;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldRequestSendMulti - send a number of requests concurrently and await all responses, or the deadline
+//
+extern void orionldRequestSendMulti(OrionldRequest* requestV, int requests, int tmoInMilliSeconds);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDREQUESTSENDMULTI_H_
@@ -0,0 +1,142 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                             // snprintf
+#include <stdlib.h>                                            // calloc, free
+#include <time.h>                                              // clock_gettime, CLOCK_MONOTONIC
+#include <stdint.h>                                            // uint64_t
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/types/OrionldSpan.h"                         // OrionldPhase, ORIONLD_PHASES
+#include "orionld/types/OrionldLatencyHistogram.h"             // OrionldServiceLatency
+#include "orionld/rest/OrionLdRestService.h"                   // OrionLdRestService
+#include "orionld/common/orionldState.h"                       // orionldState, slowRequestThreshold
+#include "orionld/common/orionldLatencyRecord.h"               // orionldLatencyRecord
+#include "orionld/common/orionldPhaseName.h"                   // orionldPhaseName
+#include "orionld/common/orionldSpanEnd.h"                     // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// serviceLatencyGet - the latency histograms of a service, allocated the first time the service is used
+//
+// Two threads may allocate at the same time - the loser frees its buffer.
+//
+static OrionldServiceLatency* serviceLatencyGet(OrionLdRestService* serviceP)
+{
+  OrionldServiceLatency* latencyP = serviceP->latencyP;
+
+  if (latencyP != NULL)
+    return latencyP;
+
+  latencyP = (OrionldServiceLatency*) calloc(1, sizeof(OrionldServiceLatency));
+  if (latencyP == NULL)
+    return NULL;
+
+  if (__sync_bool_compare_and_swap(&serviceP->latencyP, NULL, latencyP) == false)
+  {
+    free(latencyP);
+    latencyP = serviceP->latencyP;
+  }
+
+  return latencyP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// slowRequestTrace -
+//
+static void slowRequestTrace(uint64_t totalNs)
+{
+  char    phases[512];
+  int     len = 0;
+  char*   url = (orionldState.serviceP != NULL)? orionldState.serviceP->url : orionldState.urlPath;
+
+  for (int ix = 0; ix < ORIONLD_PHASES; ix++)
+  {
+    if (len >= (int) sizeof(phases))
+      break;
+
+    len += snprintf(&phases[len], sizeof(phases) - len, "%s%s: %.3f",
+                    (ix == 0)? "" : ", ",
+                    orionldPhaseName((OrionldPhase) ix),
+                    (double) orionldState.span.phaseV[ix] / 1000000);
+  }
+
+  LM_W(("Slow request: %s %s took %.3f ms (%s ms)",
+        orionldState.verbString,
+        (url != NULL)? url : "",
+        (double) totalNs / 1000000,
+        phases));
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldSpanEnd -
+//
+void orionldSpanEnd(void)
+{
+  struct timespec  now;
+  uint64_t         totalNs;
+
+  if (orionldState.span.start == 0)
+    return;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  totalNs = now.tv_sec * 1000000000ULL + now.tv_nsec - orionldState.span.start;
+
+  //
+  // Requests without service (not found, bad verb, ...) have no histograms
+  //
+  if (orionldState.serviceP != NULL)
+  {
+    OrionldServiceLatency* latencyP = serviceLatencyGet(orionldState.serviceP);
+
+    if (latencyP != NULL)
+    {
+      orionldLatencyRecord(&latencyP->total, totalNs / 1000);
+
+      //
+      // Phases that weren't reached (error responses, no notifications, ...) are not recorded
+      //
+      for (int ix = 0; ix < ORIONLD_PHASES; ix++)
+      {
+        if (orionldState.span.phaseV[ix] != 0)
+          orionldLatencyRecord(&latencyP->phaseV[ix], orionldState.span.phaseV[ix] / 1000);
+      }
+    }
+  }
+
+  if ((slowRequestThreshold > 0) && (totalNs >= (uint64_t) slowRequestThreshold * 1000000))
+    slowRequestTrace(totalNs);
+
+  orionldState.span.start = 0;
+}
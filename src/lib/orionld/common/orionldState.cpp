@@ -37,6 +37,9 @@ extern "C"
 #include "orionld/db/dbConfiguration.h"                        // DB_DRIVER_MONGOC
 #include "orionld/context/orionldCoreContext.h"                // orionldCoreContext
 #include "orionld/common/QNode.h"                              // QNode
+#ifdef DB_DRIVER_MONGOC
+#include "orionld/mongoc/mongocConnectionRelease.h"             // mongocConnectionRelease
+#endif
 #include "orionld/common/orionldState.h"                       // Own interface
 
 
@@ -85,8 +88,8 @@ int             orionldHostNameLen       = -1;
 // Variables for Mongo C Driver
 //
 #ifdef DB_DRIVER_MONGOC
-mongoc_collection_t*  mongoEntitiesCollectionP      = NULL;
-mongoc_collection_t*  mongoRegistrationsCollectionP = NULL;
+mongoc_uri_t*          mongocUri  = NULL;
+mongoc_client_pool_t*  mongocPool = NULL;
 #endif
 
 
@@ -171,6 +174,13 @@ void orionldStateRelease(void)
 
   if (orionldState.qMongoFilterP != NULL)
     delete orionldState.qMongoFilterP;
+
+#ifdef DB_DRIVER_MONGOC
+  //
+  // Give the connection to the database back to the pool
+  //
+  mongocConnectionRelease();
+#endif
 }
 
 
@@ -39,6 +39,7 @@ extern "C"
 #include "orionld/common/QNode.h"                                // QNode
 #include "orionld/types/OrionldGeoJsonType.h"                    // OrionldGeoJsonType
 #include "orionld/types/OrionldPrefixCache.h"                    // OrionldPrefixCache
+#include "orionld/types/OrionldSpan.h"                           // OrionldSpan
 #include "orionld/common/OrionldResponseBuffer.h"                // OrionldResponseBuffer
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 
@@ -110,15 +111,20 @@ typedef struct OrionldUriParams
 //
 // OrionldNotificationInfo -
 //
+struct OrionldEndpoint;
+
 typedef struct OrionldNotificationInfo
 {
-  char*     subscriptionId;
-  MimeType  mimeType;
-  KjNode*   attrsForNotification;
-  char*     reference;
-  int       fd;
-  bool      connected;
-  bool      allOK;
+  char*                    subscriptionId;
+  MimeType                 mimeType;
+  KjNode*                  attrsForNotification;
+  char*                    reference;
+  int                      fd;
+  struct OrionldEndpoint*  endpointP;  // The pool the connection belongs to (NULL if outside the pool)
+  bool                     connected;
+  bool                     allOK;
+  int                      batchMaxEntities;  // 0: no notification batching
+  int                      batchMaxDelay;
 } OrionldNotificationInfo;
 
 
@@ -206,18 +212,18 @@ typedef struct OrionldConnectionState
   void*                   delayedFreePointer;
 
   int                     notificationRecords;
-  OrionldNotificationInfo notificationInfo[100];
+  int                     notificationInfoSize;       // Allocated items - see orionldNotificationInfoAdd()
+  OrionldNotificationInfo* notificationInfo;          // kalloc'd, grows as needed
   bool                    notify;
   OrionldPrefixCache      prefixCache;
+  OrionldSpan             span;                         // Time spent per phase of the request - see orionldSpanMark()
   OrionldResponseBuffer   httpResponse;
 
 #ifdef DB_DRIVER_MONGOC
   //
-  // MongoDB stuff
+  // MongoDB stuff - the client is popped from mongocPool by mongocConnectionGet and pushed back by orionldStateRelease
   //
-  mongoc_uri_t*           mongoUri;
   mongoc_client_t*        mongoClient;
-  mongoc_database_t*      mongoDatabase;
 #endif
 
   //
@@ -257,10 +263,12 @@ extern char        dbName[];                 // From orionld.cpp
 extern int         dbNameLen;
 extern char        dbUser[];                 // From orionld.cpp
 extern char        dbPwd[];                  // From orionld.cpp
+extern int         dbPoolSize;               // From orionld.cpp
 extern bool        multitenancy;             // From orionld.cpp
 extern char*       tenant;                   // From orionld.cpp
 extern int         contextDownloadAttempts;  // From orionld.cpp
 extern int         contextDownloadTimeout;   // From orionld.cpp
+extern int         slowRequestThreshold;     // From orionld.cpp
 extern const char* orionldVersion;
 
 
@@ -270,8 +278,8 @@ extern const char* orionldVersion;
 // Global variables for Mongo C Driver
 //
 #ifdef DB_DRIVER_MONGOC
-extern mongoc_collection_t*  mongoEntitiesCollectionP;
-extern mongoc_collection_t*  mongoRegistrationsCollectionP;
+extern mongoc_uri_t*          mongocUri;
+extern mongoc_client_pool_t*  mongocPool;
 #endif
 
 
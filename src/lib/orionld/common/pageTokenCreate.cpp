@@ -0,0 +1,79 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strlen
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
+}
+
+#include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/common/pageTokenCreate.h"                    // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pageTokenCreate - create an opaque pagination token (URI param 'cursor')
+//
+// The token holds the sort key of the last item of a page, so that the next page can start right after it
+// (keyset pagination), instead of skipping all the items of the previous pages (offset pagination).
+//
+// The fields are joined with zero-bytes as separators and the result is hex-encoded, so the token is safe
+// as URI param value without any escaping and it's not tempting for clients to build tokens of their own.
+// The token is allocated using orionldState.kalloc.
+//
+// See pageTokenParse for the opposite operation.
+//
+char* pageTokenCreate(const char** fieldV, int fields)
+{
+  static const char  hex[] = "0123456789abcdef";
+  int                size  = 1;
+
+  for (int ix = 0; ix < fields; ix++)
+    size += (strlen(fieldV[ix]) + 1) * 2;
+
+  char* token = (char*) kaAlloc(&orionldState.kalloc, size);
+  char* outP  = token;
+
+  for (int ix = 0; ix < fields; ix++)
+  {
+    if (ix != 0)
+    {
+      *outP++ = '0';
+      *outP++ = '0';
+    }
+
+    for (const unsigned char* inP = (const unsigned char*) fieldV[ix]; *inP != 0; ++inP)
+    {
+      *outP++ = hex[*inP >> 4];
+      *outP++ = hex[*inP & 0x0F];
+    }
+  }
+
+  *outP = 0;
+
+  return token;
+}
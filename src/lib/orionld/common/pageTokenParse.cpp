@@ -0,0 +1,101 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strlen
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
+}
+
+#include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/common/pageTokenParse.h"                     // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// hexValue -
+//
+static int hexValue(char c)
+{
+  if ((c >= '0') && (c <= '9'))
+    return c - '0';
+  if ((c >= 'a') && (c <= 'f'))
+    return c - 'a' + 10;
+
+  return -1;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pageTokenParse - decode a pagination token created by pageTokenCreate
+//
+// PARAMETERS
+//   token   - the value of the URI param 'cursor'
+//   fieldV  - output vector for the fields of the token (decoded strings, allocated using orionldState.kalloc)
+//   fields  - the number of fields expected
+//
+// RETURN VALUE
+//   0 if the token is valid and holds exactly 'fields' fields, -1 otherwise
+//
+int pageTokenParse(const char* token, char** fieldV, int fields)
+{
+  int len = strlen(token);
+
+  if ((len == 0) || ((len % 2) != 0))
+    return -1;
+
+  char* decoded = (char*) kaAlloc(&orionldState.kalloc, len / 2 + 1);
+  int   fieldNo = 0;
+
+  fieldV[0] = decoded;
+
+  for (int ix = 0; ix < len; ix += 2)
+  {
+    int hi = hexValue(token[ix]);
+    int lo = hexValue(token[ix + 1]);
+
+    if ((hi == -1) || (lo == -1))
+      return -1;
+
+    char c = (char) ((hi << 4) | lo);
+
+    *decoded++ = c;
+
+    if (c == 0)
+    {
+      if (++fieldNo >= fields)
+        return -1;
+
+      fieldV[fieldNo] = decoded;
+    }
+  }
+
+  *decoded = 0;
+
+  return (fieldNo == fields - 1)? 0 : -1;
+}
@@ -41,7 +41,7 @@ extern "C"
 //
 // qAliasCompact - replace long attr names to their corresponding aliases
 //
-// OR, if compact == false, replace the alias with their long names
+// OR, if compact == false, replace the alias with their long names, as stored in the database ('.' => '=')
 //
 // So, need to find all th variable names and replace them.
 //
@@ -114,6 +114,17 @@ bool qAliasCompact(KjNode* qP, bool compact)
       if (alias != NULL)
       {
         strcpy(&out[outIx], alias);
+
+        if (compact == false)
+        {
+          // Expanded names are stored with '=' instead of '.' in the database - same as the 'q' of a created subscription
+          for (char* sP = &out[outIx]; *sP != 0; ++sP)
+          {
+            if (*sP == '.')
+              *sP = '=';
+          }
+        }
+
         outIx += strlen(alias);
       }
       else
@@ -0,0 +1,337 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // calloc, free
+#include <string.h>                                            // strdup, strchr
+#include <regex.h>                                             // regcomp
+
+extern "C"
+{
+#include "kalloc/kaStrdup.h"                                   // kaStrdup
+}
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/context/OrionldContext.h"                    // OrionldContext
+#include "orionld/common/QNode.h"                              // QNode
+#include "orionld/common/QCompiled.h"                          // QCompiled
+#include "orionld/common/qLex.h"                               // qLex
+#include "orionld/common/qParse.h"                             // qParse
+#include "orionld/common/qCompiledRelease.h"                   // qCompiledRelease
+#include "orionld/common/qCompile.h"                           // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// eqToDot - copy of 'name' with '=' replaced by '.'
+//
+static char* eqToDot(const char* name)
+{
+  char* copy = strdup(name);
+
+  for (char* cP = copy; *cP != 0; ++cP)
+  {
+    if (*cP == '=')
+      *cP = '.';
+  }
+
+  return copy;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// variableCompile - split the database path of a variable into attribute, sub-attribute and value path
+//
+// qParse (varFix) gives us one of these:
+//   attrs.A.value
+//   attrs.A.value.B.C
+//   attrs.A.md.M.value
+//   attrs.A.md.M.value.B.C
+//
+// A and M have their dots replaced by '=' already, so the dots of the path separate its components.
+//
+static bool variableCompile(QCompiled* qP, QNode* variableP, char** detailsP)
+{
+  char*  path = strdup(variableP->value.v);
+  char*  compV[64];
+  int    comps = 0;
+  char*  cP    = path;
+  int    restIx;
+
+  compV[comps++] = cP;
+  while ((cP = strchr(cP, '.')) != NULL)
+  {
+    *cP = 0;
+    ++cP;
+
+    if (comps >= (int) (sizeof(compV) / sizeof(compV[0])))
+    {
+      free(path);
+      *detailsP = (char*) "too many components in Q-filter variable";
+      return false;
+    }
+
+    compV[comps++] = cP;
+  }
+
+  if ((comps < 3) || (strcmp(compV[0], "attrs") != 0))
+  {
+    free(path);
+    *detailsP = (char*) "invalid Q-filter variable";
+    return false;
+  }
+
+  qP->attrName     = strdup(compV[1]);
+  qP->attrNameDots = eqToDot(compV[1]);
+
+  if ((strcmp(compV[2], "md") == 0) && (comps >= 5) && (strcmp(compV[4], "value") == 0))
+  {
+    qP->mdName     = strdup(compV[3]);
+    qP->mdNameDots = eqToDot(compV[3]);
+    restIx         = 5;
+  }
+  else if (strcmp(compV[2], "value") == 0)
+    restIx = 3;
+  else
+  {
+    free(path);
+    *detailsP = (char*) "invalid Q-filter variable";
+    return false;
+  }
+
+  if (restIx < comps)
+  {
+    qP->valuePathV = (char**) calloc(comps - restIx + 1, sizeof(char*));
+
+    for (int ix = restIx; ix < comps; ix++)
+      qP->valuePathV[ix - restIx] = strdup(compV[ix]);
+  }
+
+  free(path);
+  return true;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// valueCompile -
+//
+static bool valueCompile(QCompiledValue* valueP, QNode* qNodeP, char** detailsP)
+{
+  valueP->type = qNodeP->type;
+
+  switch (qNodeP->type)
+  {
+  case QNodeIntegerValue:  valueP->number = (double) qNodeP->value.i;  break;
+  case QNodeFloatValue:    valueP->number = qNodeP->value.f;           break;
+  case QNodeStringValue:   valueP->string = strdup(qNodeP->value.s);   break;
+  case QNodeTrueValue:     break;
+  case QNodeFalseValue:    break;
+  default:
+    *detailsP = (char*) "unsupported value type in Q-filter";
+    return false;
+  }
+
+  return true;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// nodeCompile -
+//
+static QCompiled* nodeCompile(QNode* qNodeP, char** detailsP)
+{
+  QCompiled* qP = (QCompiled*) calloc(1, sizeof(QCompiled));
+
+  qP->type = qNodeP->type;
+
+  if ((qNodeP->type == QNodeAnd) || (qNodeP->type == QNodeOr))
+  {
+    QCompiled* lastP = NULL;
+
+    for (QNode* childP = qNodeP->value.children; childP != NULL; childP = childP->next)
+    {
+      QCompiled* cP = nodeCompile(childP, detailsP);
+
+      if (cP == NULL)
+      {
+        qCompiledRelease(qP);
+        return NULL;
+      }
+
+      if (lastP == NULL)
+        qP->children = cP;
+      else
+        lastP->next = cP;
+      lastP = cP;
+    }
+
+    return qP;
+  }
+
+  if ((qNodeP->type == QNodeExists) || (qNodeP->type == QNodeNotExists))
+  {
+    if ((qNodeP->value.children == NULL) || (variableCompile(qP, qNodeP->value.children, detailsP) == false))
+    {
+      qCompiledRelease(qP);
+      return NULL;
+    }
+
+    return qP;
+  }
+
+  if ((qNodeP->type != QNodeEQ) && (qNodeP->type != QNodeNE) &&
+      (qNodeP->type != QNodeGT) && (qNodeP->type != QNodeGE) &&
+      (qNodeP->type != QNodeLT) && (qNodeP->type != QNodeLE) &&
+      (qNodeP->type != QNodeMatch) && (qNodeP->type != QNodeNoMatch))
+  {
+    *detailsP = (char*) "unsupported operator in Q-filter";
+    qCompiledRelease(qP);
+    return NULL;
+  }
+
+  QNode* leftP  = qNodeP->value.children;
+  QNode* rightP = (leftP != NULL)? leftP->next : NULL;
+
+  if ((rightP == NULL) || (leftP->type != QNodeVariable) || (variableCompile(qP, leftP, detailsP) == false))
+  {
+    if (*detailsP == NULL)
+      *detailsP = (char*) "invalid comparison in Q-filter";
+    qCompiledRelease(qP);
+    return NULL;
+  }
+
+  qP->rhsType = rightP->type;
+
+  if ((qNodeP->type == QNodeMatch) || (qNodeP->type == QNodeNoMatch))
+  {
+    if ((rightP->type != QNodeStringValue) && (rightP->type != QNodeRegexpValue))
+    {
+      *detailsP = (char*) "invalid regular expression in Q-filter";
+      qCompiledRelease(qP);
+      return NULL;
+    }
+
+    qP->regexP = (regex_t*) malloc(sizeof(regex_t));
+    if (regcomp(qP->regexP, rightP->value.re, REG_EXTENDED | REG_NOSUB) != 0)
+    {
+      free(qP->regexP);
+      qP->regexP = NULL;
+      *detailsP  = (char*) "invalid regular expression in Q-filter";
+      qCompiledRelease(qP);
+      return NULL;
+    }
+
+    return qP;
+  }
+
+  if ((rightP->type == QNodeRange) || (rightP->type == QNodeComma))
+  {
+    for (QNode* itemP = rightP->value.children; itemP != NULL; itemP = itemP->next)
+      ++qP->values;
+
+    qP->valueV = (QCompiledValue*) calloc(qP->values, sizeof(QCompiledValue));
+
+    int ix = 0;
+    for (QNode* itemP = rightP->value.children; itemP != NULL; itemP = itemP->next)
+    {
+      if (valueCompile(&qP->valueV[ix++], itemP, detailsP) == false)
+      {
+        qCompiledRelease(qP);
+        return NULL;
+      }
+    }
+
+    if ((rightP->type == QNodeRange) && (qP->values != 2))
+    {
+      *detailsP = (char*) "invalid range in Q-filter";
+      qCompiledRelease(qP);
+      return NULL;
+    }
+  }
+  else
+  {
+    qP->values = 1;
+    qP->valueV = (QCompiledValue*) calloc(1, sizeof(QCompiledValue));
+
+    if (valueCompile(&qP->valueV[0], rightP, detailsP) == false)
+    {
+      qCompiledRelease(qP);
+      return NULL;
+    }
+  }
+
+  return qP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// qCompile -
+//
+// The Q-filter is lexed and parsed (qLex, qParse) and the resulting QNode tree is compiled into a QCompiled tree.
+// The variables are expanded by qParse, using orionldState.contextP, so, for the duration of the call, orionldState.contextP
+// is set to 'contextP' - the @context of the subscription that owns the Q-filter.
+// Already expanded attribute names (as the 'q' is stored in the database) are left as is.
+//
+// The returned tree is allocated on the heap and must be freed using qCompiledRelease.
+//
+QCompiled* qCompile(OrionldContext* contextP, const char* q, char** titleP, char** detailsP)
+{
+  char*            qCopy        = kaStrdup(&orionldState.kalloc, q);  // qLex destroys its input
+  OrionldContext*  savedContext = orionldState.contextP;
+  QNode*           lexList;
+  QNode*           qTree;
+
+  *titleP   = NULL;
+  *detailsP = NULL;
+
+  if ((lexList = qLex(qCopy, titleP, detailsP)) == NULL)
+    return NULL;
+
+  orionldState.contextP = contextP;
+  qTree                 = qParse(lexList, titleP, detailsP);
+  orionldState.contextP = savedContext;
+
+  if (qTree == NULL)
+    return NULL;
+
+  QCompiled* qP = nodeCompile(qTree, detailsP);
+
+  if (qP == NULL)
+    *titleP = (char*) "unable to compile Q-filter";
+
+  LM_T(LmtSubCache, ("Compiled Q-filter '%s': %s", q, (qP != NULL)? "OK" : *detailsP));
+
+  return qP;
+}
@@ -0,0 +1,277 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strcmp
+#include <regex.h>                                             // regexec
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                      // KjNode
+#include "kjson/kjLookup.h"                                    // kjLookup
+}
+
+#include "orionld/common/QNode.h"                              // QNodeType
+#include "orionld/common/QCompiled.h"                          // QCompiled
+#include "orionld/common/qCompiledMatch.h"                     // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// variableLookup - find the value that a variable of the Q-filter refers to
+//
+// The attribute is looked up in the incoming request first, as it overrides the attribute in the database.
+// Attributes in the incoming request and in the database differ in a few ways:
+//   - attribute names: '.' in the request, '=' in the database
+//   - sub-attributes: direct members of the attribute in the request, members of "md" in the database
+//   - relationships: "object" in the request, "value" in the database
+//
+static KjNode* variableLookup(QCompiled* qP, KjNode* dbEntityP, KjNode* attrsP)
+{
+  KjNode*  attrP  = (attrsP != NULL)? kjLookup(attrsP, qP->attrNameDots) : NULL;
+  bool     fromDb = false;
+
+  if ((attrP == NULL) && (dbEntityP != NULL))
+  {
+    KjNode* dbAttrsP = kjLookup(dbEntityP, "attrs");
+
+    if (dbAttrsP != NULL)
+      attrP = kjLookup(dbAttrsP, qP->attrName);
+
+    fromDb = true;
+  }
+
+  if (attrP == NULL)
+    return NULL;
+
+  if (qP->mdName != NULL)
+  {
+    if (fromDb == true)
+    {
+      KjNode* mdP = kjLookup(attrP, "md");
+
+      attrP = (mdP != NULL)? kjLookup(mdP, qP->mdName) : NULL;
+    }
+    else
+      attrP = kjLookup(attrP, qP->mdNameDots);
+
+    if (attrP == NULL)
+      return NULL;
+  }
+
+  KjNode* valueP = attrP;
+
+  if (attrP->type == KjObject)  // Not a simplified sub-attribute, like "observedAt" in the request
+  {
+    valueP = kjLookup(attrP, "value");
+
+    if (valueP == NULL)
+      valueP = kjLookup(attrP, "object");
+  }
+
+  if (qP->valuePathV != NULL)
+  {
+    for (int ix = 0; (valueP != NULL) && (qP->valuePathV[ix] != NULL); ix++)
+    {
+      valueP = (valueP->type == KjObject)? kjLookup(valueP, qP->valuePathV[ix]) : NULL;
+    }
+  }
+
+  return valueP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// valueCompare - compare a value in the entity with a constant of the Q-filter
+//
+// Returns false if the two are not comparable (e.g. a string and a number).
+//
+static bool valueCompare(KjNode* nodeP, QCompiledValue* valueP, int* cmpP)
+{
+  if ((valueP->type == QNodeIntegerValue) || (valueP->type == QNodeFloatValue))
+  {
+    double d;
+
+    if (nodeP->type == KjInt)
+      d = (double) nodeP->value.i;
+    else if (nodeP->type == KjFloat)
+      d = nodeP->value.f;
+    else
+      return false;
+
+    *cmpP = (d < valueP->number)? -1 : (d > valueP->number)? 1 : 0;
+    return true;
+  }
+
+  if (valueP->type == QNodeStringValue)
+  {
+    if (nodeP->type != KjString)
+      return false;
+
+    *cmpP = strcmp(nodeP->value.s, valueP->string);
+    return true;
+  }
+
+  if ((valueP->type == QNodeTrueValue) || (valueP->type == QNodeFalseValue))
+  {
+    if (nodeP->type != KjBoolean)
+      return false;
+
+    bool b = (valueP->type == QNodeTrueValue);
+
+    *cmpP = (nodeP->value.b == b)? 0 : (nodeP->value.b == true)? 1 : -1;
+    return true;
+  }
+
+  return false;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// valueMatch - does a single value of the entity match the operator 'op' with the right-hand side of qP?
+//
+// NE and NoMatch are evaluated as EQ and Match by this function, and negated by the caller.
+//
+static bool valueMatch(QCompiled* qP, QNodeType op, KjNode* nodeP)
+{
+  int cmp;
+
+  if (op == QNodeMatch)
+  {
+    if (nodeP->type != KjString)
+      return false;
+
+    return (regexec(qP->regexP, nodeP->value.s, 0, NULL, 0) == 0);
+  }
+
+  if (op == QNodeEQ)
+  {
+    if (qP->rhsType == QNodeRange)
+    {
+      int cmpHigh;
+
+      if ((valueCompare(nodeP, &qP->valueV[0], &cmp) == false) || (valueCompare(nodeP, &qP->valueV[1], &cmpHigh) == false))
+        return false;
+
+      return ((cmp >= 0) && (cmpHigh <= 0));
+    }
+
+    for (int ix = 0; ix < qP->values; ix++)  // A list (QNodeComma) or a single value
+    {
+      if ((valueCompare(nodeP, &qP->valueV[ix], &cmp) == true) && (cmp == 0))
+        return true;
+    }
+
+    return false;
+  }
+
+  if (valueCompare(nodeP, &qP->valueV[0], &cmp) == false)
+    return false;
+
+  switch (op)
+  {
+  case QNodeGT:  return (cmp >  0);
+  case QNodeGE:  return (cmp >= 0);
+  case QNodeLT:  return (cmp <  0);
+  case QNodeLE:  return (cmp <= 0);
+  default:       break;
+  }
+
+  return false;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// anyValueMatch - like valueMatch, but for arrays, any item of the array must match (as in the database)
+//
+static bool anyValueMatch(QCompiled* qP, QNodeType op, KjNode* nodeP)
+{
+  if (nodeP->type != KjArray)
+    return valueMatch(qP, op, nodeP);
+
+  for (KjNode* itemP = nodeP->value.firstChildP; itemP != NULL; itemP = itemP->next)
+  {
+    if (valueMatch(qP, op, itemP) == true)
+      return true;
+  }
+
+  return false;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// qCompiledMatch -
+//
+// The semantics are those of the database query that qTreeToBsonObj creates for the same Q-filter:
+//   - A!=X:   the attribute must exist and differ from X
+//   - A!~=RE: the attribute must not exist or not match RE
+//
+bool qCompiledMatch(QCompiled* qP, KjNode* dbEntityP, KjNode* attrsP)
+{
+  if (qP->type == QNodeAnd)
+  {
+    for (QCompiled* childP = qP->children; childP != NULL; childP = childP->next)
+    {
+      if (qCompiledMatch(childP, dbEntityP, attrsP) == false)
+        return false;
+    }
+
+    return true;
+  }
+
+  if (qP->type == QNodeOr)
+  {
+    for (QCompiled* childP = qP->children; childP != NULL; childP = childP->next)
+    {
+      if (qCompiledMatch(childP, dbEntityP, attrsP) == true)
+        return true;
+    }
+
+    return false;
+  }
+
+  KjNode* valueP = variableLookup(qP, dbEntityP, attrsP);
+
+  switch (qP->type)
+  {
+  case QNodeExists:     return (valueP != NULL);
+  case QNodeNotExists:  return (valueP == NULL);
+  case QNodeNE:         return (valueP != NULL) && (anyValueMatch(qP, QNodeEQ, valueP) == false);
+  case QNodeNoMatch:    return (valueP == NULL) || (anyValueMatch(qP, QNodeMatch, valueP) == false);
+  default:              break;
+  }
+
+  if (valueP == NULL)
+    return false;
+
+  return anyValueMatch(qP, qP->type, valueP);
+}
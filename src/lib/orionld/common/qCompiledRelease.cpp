@@ -0,0 +1,73 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // free
+#include <regex.h>                                             // regfree
+
+#include "orionld/common/QCompiled.h"                          // QCompiled
+#include "orionld/common/qCompiledRelease.h"                   // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// qCompiledRelease -
+//
+void qCompiledRelease(QCompiled* qP)
+{
+  while (qP != NULL)
+  {
+    QCompiled* nextP = qP->next;
+
+    qCompiledRelease(qP->children);
+
+    free(qP->attrName);
+    free(qP->attrNameDots);
+    free(qP->mdName);
+    free(qP->mdNameDots);
+
+    if (qP->valuePathV != NULL)
+    {
+      for (int ix = 0; qP->valuePathV[ix] != NULL; ix++)
+        free(qP->valuePathV[ix]);
+      free(qP->valuePathV);
+    }
+
+    if (qP->valueV != NULL)
+    {
+      for (int ix = 0; ix < qP->values; ix++)
+        free(qP->valueV[ix].string);
+      free(qP->valueV);
+    }
+
+    if (qP->regexP != NULL)
+    {
+      regfree(qP->regexP);
+      free(qP->regexP);
+    }
+
+    free(qP);
+    qP = nextP;
+  }
+}
@@ -25,8 +25,11 @@
 *
 * Author: Ken Zangelin
 */
+#include <semaphore.h>                             // sem_t
+
 extern "C"
 {
+#include "kalloc/KAlloc.h"                         // KAlloc
 #include "khash/khash.h"                           // KHashTable
 #include "kjson/KjNode.h"                          // KjNode
 }
@@ -65,6 +68,51 @@ typedef union OrionldContextInfo
 
 
 
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_CONTEXT_MEMO_BUCKETS - number of buckets of the expansion memo of a context (must be a power of two)
+//
+#define ORIONLD_CONTEXT_MEMO_BUCKETS  256
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_CONTEXT_MEMO_MAX_ITEMS - max number of expansions memoized per context
+//
+#define ORIONLD_CONTEXT_MEMO_MAX_ITEMS  4096
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldContextMemoItem -
+//
+typedef struct OrionldContextMemoItem
+{
+  char*                           shortName;
+  char*                           longName;
+  struct OrionldContextMemoItem*  next;
+} OrionldContextMemoItem;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldContextMemo - expansions of prefixed names (CURIEs), e.g. "ex:speed"
+//
+// Terms are found with one lookup in the term tables, but a CURIE needs its prefix looked up and a new string
+// composed. The memo keeps these expansions, across requests. See orionldContextMemoLookup.
+//
+typedef struct OrionldContextMemo
+{
+  OrionldContextMemoItem*  bucket[ORIONLD_CONTEXT_MEMO_BUCKETS];
+  int                      items;
+  sem_t                    sem;  // Serializes the inserts - lookups take no lock
+} OrionldContextMemo;
+
+
+
 // ----------------------------------------------------------------------------
 //
 // OrionldContext -
@@ -72,13 +120,39 @@ typedef union OrionldContextInfo
 // The context is either an array of contexts or "the real thing" - a list of key-values in
 // a hash-list
 //
+// All memory of a context, except the cloned 'tree', is allocated in its own 'kalloc', so that the
+// context can be freed when evicted from the context cache.
+//
 typedef struct OrionldContext
 {
-  char*               url;
-  char*               id;         // For contexts that were created by the broker itself
-  KjNode*             tree;
-  bool                keyValues;
-  OrionldContextInfo  context;
+  char*                   url;
+  char*                   id;         // For contexts that were created by the broker itself
+  KjNode*                 tree;
+  bool                    keyValues;
+  OrionldContextInfo      context;
+
+  //
+  // All terms of the context, flattened into a single pair of hash tables - see orionldContextTermTablesCreate
+  //
+  OrionldContextHashTables  terms;
+  bool                      termsWithCore;  // The terms of the Core Context are part of 'terms'
+  OrionldContextMemo        memo;           // Expansions of prefixed names, kept across requests
+
+  //
+  // Context Cache bookkeeping - see orionldContextCache.h
+  //
+  KAlloc                  kalloc;
+  char                    kallocBuffer[2 * 1024];
+  unsigned long long      contentHash;  // Hash of the content of contexts created by the broker, 0 for downloaded contexts
+  bool                    permanent;    // Never evicted (the Core Context and preloaded contexts)
+  int                     arrayRefs;    // Number of cached array contexts that have this context as member - not evicted if > 0
+  int                     users;        // Threads using the context - evicted contexts are freed when no longer used
+  unsigned int            createdNo;    // Order of creation - contexts are presented in this order (orionldContextCacheGet)
+  struct OrionldContext*  urlNext;      // Next context in the same URL hash bucket
+  struct OrionldContext*  idNext;       // Next context in the same id hash bucket
+  struct OrionldContext*  contentNext;  // Next context in the same content hash bucket
+  struct OrionldContext*  lruPrev;      // More recently used context
+  struct OrionldContext*  lruNext;      // Less recently used context
 } OrionldContext;
 
 #endif  // SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXT_H_
@@ -33,8 +33,16 @@
 //
 // Context Cache Internals
 //
-sem_t             orionldContextCacheSem;
-OrionldContext*   orionldContextCacheArray[100];  // When 100 is not enough, a realloc is done (automatically)
-OrionldContext**  orionldContextCache         = orionldContextCacheArray;
-int               orionldContextCacheSlots    = 100;
-int               orionldContextCacheSlotIx   = 0;
+sem_t                     orionldContextCacheSem;
+OrionldContext*           orionldContextCacheUrlHash[ORIONLD_CONTEXT_CACHE_BUCKETS];
+OrionldContext*           orionldContextCacheIdHash[ORIONLD_CONTEXT_CACHE_BUCKETS];
+OrionldContext*           orionldContextCacheContentHash[ORIONLD_CONTEXT_CACHE_BUCKETS];
+OrionldContext*           orionldContextCacheLruFirst   = NULL;
+OrionldContext*           orionldContextCacheLruLast    = NULL;
+OrionldContext*           orionldContextCacheEvicted    = NULL;
+int                       orionldContextCacheItems      = 0;
+int                       orionldContextCacheMaxItems   = 10000;  // Overridden by CLI option -ctxCacheSize
+OrionldContextCacheStats  orionldContextCacheStats;
+OrionldContextMemoStats   orionldContextMemoStats;
+
+__thread OrionldContextCacheUsed  orionldContextCacheUsed;
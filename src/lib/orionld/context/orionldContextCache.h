@@ -41,12 +41,96 @@
 
 // -----------------------------------------------------------------------------
 //
-// orionldContextCache
+// ORIONLD_CONTEXT_CACHE_BUCKETS - number of buckets of the hash tables of the context cache
 //
-extern sem_t             orionldContextCacheSem;
-extern OrionldContext*   orionldContextCacheArray[100];  // When 100 is not enough, a realloc is done (automatically)
-extern OrionldContext**  orionldContextCache;
-extern int               orionldContextCacheSlots;
-extern int               orionldContextCacheSlotIx;
+#define ORIONLD_CONTEXT_CACHE_BUCKETS  4096
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_CONTEXT_CACHE_USED_ITEMS - contexts a thread can use without allocating memory for the bookkeeping
+//
+#define ORIONLD_CONTEXT_CACHE_USED_ITEMS  32
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldContextCacheStats -
+//
+typedef struct OrionldContextCacheStats
+{
+  unsigned long long  lookups;
+  unsigned long long  hits;
+  unsigned long long  misses;
+  unsigned long long  inserts;
+  unsigned long long  dedups;      // Inline contexts found by content hash - not created again
+  unsigned long long  evictions;
+  unsigned long long  frees;
+} OrionldContextCacheStats;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldContextMemoStats - counters of the expansion memos of all contexts (see orionldContextMemoLookup)
+//
+// Updated with atomic operations, not protected by orionldContextCacheSem.
+//
+typedef struct OrionldContextMemoStats
+{
+  unsigned long long  lookups;
+  unsigned long long  hits;
+  unsigned long long  inserts;
+} OrionldContextMemoStats;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldContextCacheUsed - the contexts used by a thread (see orionldContextCacheUse)
+//
+typedef struct OrionldContextCacheUsed
+{
+  OrionldContext*   fixedV[ORIONLD_CONTEXT_CACHE_USED_ITEMS];
+  OrionldContext**  vector;  // fixedV, unless the thread uses more than ORIONLD_CONTEXT_CACHE_USED_ITEMS contexts
+  int               items;
+  int               size;
+} OrionldContextCacheUsed;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextCache - the context cache
+//
+// The contexts are found in three hash tables (buckets of linked lists):
+//   - by URL
+//   - by id (only contexts created by the broker have an id)
+//   - by content hash (only contexts created by the broker, so that identical inline contexts share one cache item)
+//
+// All cached contexts are also in a doubly linked LRU list, most recently used first.
+// When the number of contexts is above orionldContextCacheMaxItems, the least recently used contexts are evicted.
+// Contexts created by the broker are never evicted, see cacheShrink in orionldContextCacheInsert.cpp.
+//
+// Each thread keeps track of the contexts it has looked up (orionldContextCacheUsed) and each context counts its users.
+// Evicted contexts are kept in orionldContextCacheEvicted until they have no users.
+//
+// All accesses are protected by orionldContextCacheSem, except orionldContextCacheUsed, that is thread-local.
+//
+extern sem_t                     orionldContextCacheSem;
+extern OrionldContext*           orionldContextCacheUrlHash[ORIONLD_CONTEXT_CACHE_BUCKETS];
+extern OrionldContext*           orionldContextCacheIdHash[ORIONLD_CONTEXT_CACHE_BUCKETS];
+extern OrionldContext*           orionldContextCacheContentHash[ORIONLD_CONTEXT_CACHE_BUCKETS];
+extern OrionldContext*           orionldContextCacheLruFirst;
+extern OrionldContext*           orionldContextCacheLruLast;
+extern OrionldContext*           orionldContextCacheEvicted;
+extern int                       orionldContextCacheItems;
+extern int                       orionldContextCacheMaxItems;
+extern OrionldContextCacheStats  orionldContextCacheStats;
+extern OrionldContextMemoStats   orionldContextMemoStats;
+
+extern __thread OrionldContextCacheUsed  orionldContextCacheUsed;
 
 #endif  // SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXTCACHE_H_
@@ -0,0 +1,131 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp
+#include <semaphore.h>                                           // sem_wait, sem_post
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/context/OrionldContext.h"                      // OrionldContext
+#include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextCacheUse.h"              // orionldContextCacheUse
+#include "orionld/context/orionldContextCacheContentLookup.h"    // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// nameEqual -
+//
+static bool nameEqual(const char* name1, const char* name2)
+{
+  if ((name1 == NULL) || (name2 == NULL))
+    return name1 == name2;
+
+  return strcmp(name1, name2) == 0;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// treeEqual - the hash says the two trees are equal - this makes sure
+//
+static bool treeEqual(KjNode* tree1P, KjNode* tree2P)
+{
+  if (tree1P->type != tree2P->type)
+    return false;
+
+  if (nameEqual(tree1P->name, tree2P->name) == false)
+    return false;
+
+  switch (tree1P->type)
+  {
+  case KjString:   return strcmp(tree1P->value.s, tree2P->value.s) == 0;
+  case KjInt:      return tree1P->value.i == tree2P->value.i;
+  case KjFloat:    return tree1P->value.f == tree2P->value.f;
+  case KjBoolean:  return tree1P->value.b == tree2P->value.b;
+  case KjNull:     return true;
+
+  case KjObject:
+  case KjArray:
+    {
+      KjNode* child1P = tree1P->value.firstChildP;
+      KjNode* child2P = tree2P->value.firstChildP;
+
+      while ((child1P != NULL) && (child2P != NULL))
+      {
+        if (treeEqual(child1P, child2P) == false)
+          return false;
+
+        child1P = child1P->next;
+        child2P = child2P->next;
+      }
+
+      return (child1P == NULL) && (child2P == NULL);
+    }
+
+  default:
+    break;
+  }
+
+  return false;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextCacheContentLookup -
+//
+// Inline contexts (contexts that are not URLs) are given a URL by the broker and inserted in the context cache.
+// Clients typically send the very same inline context over and over again, and to avoid creating a new
+// context for each and every request, the inline contexts are also indexed by the hash of their content.
+//
+OrionldContext* orionldContextCacheContentLookup(unsigned long long contentHash, KjNode* tree)
+{
+  OrionldContext* contextP;
+
+  sem_wait(&orionldContextCacheSem);
+
+  for (contextP = orionldContextCacheContentHash[contentHash % ORIONLD_CONTEXT_CACHE_BUCKETS]; contextP != NULL; contextP = contextP->contentNext)
+  {
+    if ((contextP->contentHash == contentHash) && (contextP->tree != NULL) && (treeEqual(contextP->tree, tree) == true))
+    {
+      orionldContextCacheUse(contextP);
+      ++orionldContextCacheStats.dedups;
+      break;
+    }
+  }
+
+  sem_post(&orionldContextCacheSem);
+
+  return contextP;
+}
@@ -0,0 +1,70 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                              // NULL
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/context/OrionldContext.h"                      // OrionldContext
+#include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextFree.h"                  // orionldContextFree
+#include "orionld/context/orionldContextCacheEvictedFree.h"      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextCacheEvictedFree -
+//
+// The members of an array context are kept in the cache for as long as the array context exists (arrayRefs), not only
+// while it's cached - a thread using an evicted array context also uses its members.
+//
+void orionldContextCacheEvictedFree(void)
+{
+  OrionldContext** prevNextP = &orionldContextCacheEvicted;
+
+  while (*prevNextP != NULL)
+  {
+    OrionldContext* contextP = *prevNextP;
+
+    if (contextP->users > 0)
+    {
+      prevNextP = &contextP->lruNext;
+      continue;
+    }
+
+    *prevNextP = contextP->lruNext;
+
+    if (contextP->keyValues == false)
+    {
+      for (int ix = 0; ix < contextP->context.array.items; ix++)
+        --contextP->context.array.vector[ix]->arrayRefs;
+    }
+
+    LM_T(LmtContext, ("Freeing evicted context '%s'", contextP->url));
+    orionldContextFree(contextP);
+    ++orionldContextCacheStats.frees;
+  }
+}
@@ -22,8 +22,11 @@
 *
 * Author: Ken Zangelin
 */
+#include <stdlib.h>                                              // qsort
+
 extern "C"
 {
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
 #include "kjson/KjNode.h"                                        // KjNode
 #include "kjson/kjBuilder.h"                                     // kjString, kjObject, ...
 #include "khash/khash.h"                                         // KHashTable, ...
@@ -40,15 +43,41 @@ extern "C"
 
 
 
+// -----------------------------------------------------------------------------
+//
+// createdNoCompare -
+//
+static int createdNoCompare(const void* v1, const void* v2)
+{
+  OrionldContext* c1P = *((OrionldContext**) v1);
+  OrionldContext* c2P = *((OrionldContext**) v2);
+
+  return (c1P->createdNo < c2P->createdNo)? -1 : (c1P->createdNo > c2P->createdNo)? 1 : 0;
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldContextCacheGet -
 //
+// The contexts are presented in the order they were created (the context cache itself is in LRU order).
+//
 KjNode* orionldContextCacheGet(KjNode* arrayP)
 {
-  for (int ix = 0; ix < orionldContextCacheSlotIx; ix++)
+  sem_wait(&orionldContextCacheSem);
+
+  OrionldContext** contextV = (OrionldContext**) kaAlloc(&orionldState.kalloc, (orionldContextCacheItems + 1) * sizeof(OrionldContext*));
+  int              contexts = 0;
+
+  for (OrionldContext* contextP = orionldContextCacheLruFirst; contextP != NULL; contextP = contextP->lruNext)
+    contextV[contexts++] = contextP;
+
+  qsort(contextV, contexts, sizeof(OrionldContext*), createdNoCompare);
+
+  for (int ix = 0; ix < contexts; ix++)
   {
-    OrionldContext*  contextP         = orionldContextCacheArray[ix];
+    OrionldContext*  contextP         = contextV[ix];
     KjNode*          contextObjP      = kjObject(orionldState.kjsonP, NULL);
     KjNode*          urlStringP       = kjString(orionldState.kjsonP, "url",  contextP->url);
     KjNode*          idStringP        = kjString(orionldState.kjsonP, "id",  (contextP->id == NULL)? "None" : contextP->id);
@@ -108,5 +137,7 @@ KjNode* orionldContextCacheGet(KjNode* arrayP)
     kjChildAdd(arrayP, contextObjP);
   }
 
+  sem_post(&orionldContextCacheSem);
+
   return arrayP;
 }
@@ -38,7 +38,11 @@
 //
 void orionldContextCacheInit(void)
 {
-  bzero(&orionldContextCacheArray, sizeof(orionldContextCacheArray));
+  bzero(orionldContextCacheUrlHash,     sizeof(orionldContextCacheUrlHash));
+  bzero(orionldContextCacheIdHash,      sizeof(orionldContextCacheIdHash));
+  bzero(orionldContextCacheContentHash, sizeof(orionldContextCacheContentHash));
+  bzero(&orionldContextCacheStats,      sizeof(orionldContextCacheStats));
+  bzero(&orionldContextMemoStats,       sizeof(orionldContextMemoStats));
 
   if (sem_init(&orionldContextCacheSem, 0, 1) == -1)
     LM_X(1, ("Runtime Error (error initializing semaphore for orionld context list; %s)", strerror(errno)));
@@ -22,48 +22,183 @@
 *
 * Author: Ken Zangelin
 */
-#include <strings.h>                                             // bzero
-#include <string.h>                                              // memcpy
 #include <semaphore.h>                                           // sem_wait, sem_post
 
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/common/orionldState.h"                         // kalloc, orionldState
+#include "orionld/common/stringHash.h"                           // stringHash
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 #include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextCacheUse.h"              // orionldContextCacheUse
+#include "orionld/context/orionldContextCacheEvictedFree.h"      // orionldContextCacheEvictedFree
 #include "orionld/context/orionldContextCacheInsert.h"           // Own interface
 
 
 
+// -----------------------------------------------------------------------------
+//
+// bucketRemove - remove a context from a hash bucket list
+//
+// 'nextP' gives the address of the 'next' pointer of the bucket list in question (urlNext, idNext or contentNext)
+//
+static void bucketRemove(OrionldContext** bucketP, OrionldContext* contextP, OrionldContext** (*nextP)(OrionldContext*))
+{
+  while (*bucketP != NULL)
+  {
+    if (*bucketP == contextP)
+    {
+      *bucketP = *nextP(contextP);
+      return;
+    }
+
+    bucketP = nextP(*bucketP);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// urlNextP, idNextP, contentNextP - accessors for bucketRemove
+//
+static OrionldContext** urlNextP(OrionldContext* contextP)     { return &contextP->urlNext;     }
+static OrionldContext** idNextP(OrionldContext* contextP)      { return &contextP->idNext;      }
+static OrionldContext** contentNextP(OrionldContext* contextP) { return &contextP->contentNext; }
+
+
+
+// -----------------------------------------------------------------------------
+//
+// contextEvict - take a context out of the cache and put it in the list of evicted contexts
+//
+// The context is freed once no thread is using it (see orionldContextCacheEvictedFree).
+//
+static void contextEvict(OrionldContext* contextP)
+{
+  LM_T(LmtContext, ("Evicting context '%s' from the context cache", contextP->url));
+
+  bucketRemove(&orionldContextCacheUrlHash[stringHash(contextP->url) % ORIONLD_CONTEXT_CACHE_BUCKETS], contextP, urlNextP);
+
+  if (contextP->id != NULL)
+    bucketRemove(&orionldContextCacheIdHash[stringHash(contextP->id) % ORIONLD_CONTEXT_CACHE_BUCKETS], contextP, idNextP);
+
+  if (contextP->contentHash != 0)
+    bucketRemove(&orionldContextCacheContentHash[contextP->contentHash % ORIONLD_CONTEXT_CACHE_BUCKETS], contextP, contentNextP);
+
+  // Out of the LRU list
+  if (contextP->lruPrev != NULL)
+    contextP->lruPrev->lruNext = contextP->lruNext;
+  else
+    orionldContextCacheLruFirst = contextP->lruNext;
+
+  if (contextP->lruNext != NULL)
+    contextP->lruNext->lruPrev = contextP->lruPrev;
+  else
+    orionldContextCacheLruLast = contextP->lruPrev;
+
+  // Into the list of evicted contexts
+  contextP->lruPrev           = NULL;
+  contextP->lruNext           = orionldContextCacheEvicted;
+  orionldContextCacheEvicted  = contextP;
+
+  --orionldContextCacheItems;
+  ++orionldContextCacheStats.evictions;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// cacheShrink - evict least recently used contexts until the cache is within its limits
+//
+// Contexts that are never evicted:
+//   - permanent contexts (the Core Context and preloaded contexts)
+//   - members of array contexts
+//   - contexts created by the broker (inline contexts) - they are served by the broker, under their id,
+//     and stored subscriptions and registrations refer to them
+//
+// So, the cache may stay above its limit if all its contexts are of these kinds.
+//
+static void cacheShrink(void)
+{
+  OrionldContext* contextP = orionldContextCacheLruLast;
+
+  while ((orionldContextCacheItems > orionldContextCacheMaxItems) && (contextP != NULL))
+  {
+    OrionldContext* prevP = contextP->lruPrev;
+
+    if ((contextP->permanent == false) && (contextP->arrayRefs <= 0) && (contextP->id == NULL))
+      contextEvict(contextP);
+
+    contextP = prevP;
+  }
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldContextCacheInsert -
 //
+// The context is inserted as 'most recently used', and as used by the calling thread.
+// If the cache then is above its limit, the least recently used contexts are evicted.
+//
 void orionldContextCacheInsert(OrionldContext* contextP)
 {
   sem_wait(&orionldContextCacheSem);
 
-  //
-  // Reallocation necessary?
-  //
+  unsigned int urlBucket = stringHash(contextP->url) % ORIONLD_CONTEXT_CACHE_BUCKETS;
+
+  contextP->urlNext                       = orionldContextCacheUrlHash[urlBucket];
+  orionldContextCacheUrlHash[urlBucket]   = contextP;
+
+  if (contextP->id != NULL)
+  {
+    unsigned int idBucket = stringHash(contextP->id) % ORIONLD_CONTEXT_CACHE_BUCKETS;
 
-  if (orionldContextCacheSlotIx >= orionldContextCacheSlots)
+    contextP->idNext                      = orionldContextCacheIdHash[idBucket];
+    orionldContextCacheIdHash[idBucket]   = contextP;
+  }
+
+  if (contextP->contentHash != 0)
   {
-    int   slotsToAdd   = 50;
-    int   addedSize    = slotsToAdd * sizeof(OrionldContext*);
-    int   newNoOfSlots = orionldContextCacheSlots + slotsToAdd;
-    char* newArray     = (char*) kaAlloc(&kalloc, sizeof(OrionldContext*) * newNoOfSlots);
+    unsigned int contentBucket = contextP->contentHash % ORIONLD_CONTEXT_CACHE_BUCKETS;
 
-    memcpy(newArray, (char*) orionldContextCache, sizeof(OrionldContext*) * orionldContextCacheSlots);
-    bzero(&newArray[sizeof(OrionldContext*) * orionldContextCacheSlots], addedSize);
+    contextP->contentNext                         = orionldContextCacheContentHash[contentBucket];
+    orionldContextCacheContentHash[contentBucket] = contextP;
+  }
 
-    orionldContextCacheSlots += 50;
-    orionldContextCache = (OrionldContext**) newArray;
+  //
+  // Members of an array context must stay in the cache as long as the array context does
+  //
+  if (contextP->keyValues == false)
+  {
+    for (int ix = 0; ix < contextP->context.array.items; ix++)
+      ++contextP->context.array.vector[ix]->arrayRefs;
   }
 
-  orionldContextCache[orionldContextCacheSlotIx] = contextP;
-  ++orionldContextCacheSlotIx;
+  // First in the LRU list
+  contextP->lruPrev = NULL;
+  contextP->lruNext = orionldContextCacheLruFirst;
+
+  if (orionldContextCacheLruFirst != NULL)
+    orionldContextCacheLruFirst->lruPrev = contextP;
+  else
+    orionldContextCacheLruLast = contextP;
+
+  orionldContextCacheLruFirst = contextP;
+
+  ++orionldContextCacheItems;
+  ++orionldContextCacheStats.inserts;
+
+  orionldContextCacheUse(contextP);
+
+  if (orionldContextCacheItems > orionldContextCacheMaxItems)
+    cacheShrink();
+
+  if (orionldContextCacheEvicted != NULL)
+    orionldContextCacheEvictedFree();
 
   sem_post(&orionldContextCacheSem);
 }
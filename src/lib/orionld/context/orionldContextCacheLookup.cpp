@@ -23,30 +23,86 @@
 * Author: Ken Zangelin
 */
 #include <string.h>                                              // strcmp
+#include <semaphore.h>                                           // sem_wait, sem_post
 
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
+#include "orionld/common/stringHash.h"                           // stringHash
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 #include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextCacheUse.h"              // orionldContextCacheUse
 #include "orionld/context/orionldContextCacheLookup.h"           // Own interface
 
 
 
+// -----------------------------------------------------------------------------
+//
+// lruFirst - move a context to the front of the LRU list
+//
+static void lruFirst(OrionldContext* contextP)
+{
+  if (contextP == orionldContextCacheLruFirst)
+    return;
+
+  // Out of its current position (it's not the first one, so lruPrev != NULL)
+  contextP->lruPrev->lruNext = contextP->lruNext;
+
+  if (contextP->lruNext != NULL)
+    contextP->lruNext->lruPrev = contextP->lruPrev;
+  else
+    orionldContextCacheLruLast = contextP->lruPrev;
+
+  // In, first
+  contextP->lruPrev                     = NULL;
+  contextP->lruNext                     = orionldContextCacheLruFirst;
+  orionldContextCacheLruFirst->lruPrev  = contextP;
+  orionldContextCacheLruFirst           = contextP;
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldContextCacheLookup -
 //
+// The context is looked up both by URL and by id (contexts created by the broker are also found by their id).
+// A context that is found is used by the calling thread until orionldContextCacheUsersRelease() - it may be evicted
+// meanwhile, but it is not freed.
+//
 OrionldContext* orionldContextCacheLookup(const char* url)
 {
-  for (int ix = 0; ix < orionldContextCacheSlotIx; ix++)
+  unsigned int     bucket   = stringHash(url) % ORIONLD_CONTEXT_CACHE_BUCKETS;
+  OrionldContext*  contextP;
+
+  sem_wait(&orionldContextCacheSem);
+  ++orionldContextCacheStats.lookups;
+
+  for (contextP = orionldContextCacheUrlHash[bucket]; contextP != NULL; contextP = contextP->urlNext)
+  {
+    if (strcmp(url, contextP->url) == 0)
+      break;
+  }
+
+  if (contextP == NULL)
   {
-    if (strcmp(url, orionldContextCache[ix]->url) == 0)
-      return orionldContextCache[ix];
+    for (contextP = orionldContextCacheIdHash[bucket]; contextP != NULL; contextP = contextP->idNext)
+    {
+      if (strcmp(url, contextP->id) == 0)
+        break;
+    }
+  }
 
-    if ((orionldContextCache[ix]->id != NULL) && (strcmp(url, orionldContextCache[ix]->id) == 0))
-      return orionldContextCache[ix];
+  if (contextP != NULL)
+  {
+    lruFirst(contextP);
+    orionldContextCacheUse(contextP);
+    ++orionldContextCacheStats.hits;
   }
+  else
+    ++orionldContextCacheStats.misses;
+
+  sem_post(&orionldContextCacheSem);
 
-  return NULL;
+  return contextP;
 }
@@ -37,11 +37,11 @@
 //
 void orionldContextCachePresent(const char* prefix, const char* info)
 {
-  LM_TMP(("%s: *************** %s: %d Contexts *************************", prefix, info, orionldContextCacheSlotIx));
+  LM_TMP(("%s: *************** %s: %d Contexts *************************", prefix, info, orionldContextCacheItems));
   LM_TMP(("%s: ========================================================================", prefix));
-  for (int ix = 0; ix < orionldContextCacheSlotIx; ix++)
+  for (OrionldContext* contextP = orionldContextCacheLruLast; contextP != NULL; contextP = contextP->lruPrev)
   {
-    orionldContextPresent(prefix, orionldContextCache[ix]);
+    orionldContextPresent(prefix, contextP);
     LM_TMP(("%s:", prefix));
   }
   LM_TMP(("%s: ========================================================================", prefix));
@@ -24,28 +24,41 @@
 */
 #include <unistd.h>                                              // NULL
 
-extern "C"
-{
-#include "kjson/kjFree.h"                                        // kjFree
-}
-
-#include "orionld/context/orionldContextCache.h"                 // orionldContextCache, orionldContextCacheSlotIx
+#include "orionld/context/OrionldContext.h"                      // OrionldContext
+#include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextFree.h"                  // orionldContextFree
 #include "orionld/context/orionldContextCacheRelease.h"          // Own interface
 
 
 
 // -----------------------------------------------------------------------------
 //
-// orionldContextCacheRelease -
+// contextListFree -
 //
-void orionldContextCacheRelease(void)
+static void contextListFree(OrionldContext* contextP)
 {
-  for (int ix = 0; ix < orionldContextCacheSlotIx; ix++)
+  while (contextP != NULL)
   {
-    if (orionldContextCache[ix]->tree != NULL)
-    {
-      kjFree(orionldContextCache[ix]->tree);
-      orionldContextCache[ix]->tree = NULL;
-    }
+    OrionldContext* nextP = contextP->lruNext;
+
+    orionldContextFree(contextP);
+    contextP = nextP;
   }
 }
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextCacheRelease - free all contexts, both the cached ones and those awaiting to be freed
+//
+void orionldContextCacheRelease(void)
+{
+  contextListFree(orionldContextCacheLruFirst);
+  contextListFree(orionldContextCacheEvicted);
+
+  orionldContextCacheLruFirst = NULL;
+  orionldContextCacheLruLast  = NULL;
+  orionldContextCacheEvicted  = NULL;
+  orionldContextCacheItems    = 0;
+}
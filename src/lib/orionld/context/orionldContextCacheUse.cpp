@@ -0,0 +1,87 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // malloc, free
+#include <string.h>                                              // memcpy
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/context/OrionldContext.h"                      // OrionldContext
+#include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextCacheUse.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextCacheUse -
+//
+// A context is counted only once per thread, no matter how many times the thread looks it up.
+// Permanent contexts are never freed and need no counting.
+//
+// The vector of used contexts of the thread starts as a fixed array - it's only allocated if the thread uses more than
+// ORIONLD_CONTEXT_CACHE_USED_ITEMS contexts, and in such case it is freed by orionldContextCacheUsersRelease.
+//
+void orionldContextCacheUse(OrionldContext* contextP)
+{
+  OrionldContextCacheUsed* usedP = &orionldContextCacheUsed;
+
+  if (contextP->permanent == true)
+    return;
+
+  if (usedP->vector == NULL)
+  {
+    usedP->vector = usedP->fixedV;
+    usedP->size   = ORIONLD_CONTEXT_CACHE_USED_ITEMS;
+  }
+
+  for (int ix = 0; ix < usedP->items; ix++)
+  {
+    if (usedP->vector[ix] == contextP)
+      return;
+  }
+
+  if (usedP->items >= usedP->size)
+  {
+    int               newSize = usedP->size * 2;
+    OrionldContext**  newV    = (OrionldContext**) malloc(newSize * sizeof(OrionldContext*));
+
+    if (newV == NULL)
+      LM_X(1, ("Out of memory (allocating a vector for %d used contexts)", newSize));
+
+    memcpy(newV, usedP->vector, usedP->items * sizeof(OrionldContext*));
+
+    if (usedP->vector != usedP->fixedV)
+      free(usedP->vector);
+
+    usedP->vector = newV;
+    usedP->size   = newSize;
+  }
+
+  usedP->vector[usedP->items] = contextP;
+  usedP->items += 1;
+
+  ++contextP->users;
+}
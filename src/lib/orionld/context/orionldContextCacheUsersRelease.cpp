@@ -0,0 +1,69 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // free
+#include <semaphore.h>                                           // sem_wait, sem_post
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/context/OrionldContext.h"                      // OrionldContext
+#include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextCacheEvictedFree.h"      // orionldContextCacheEvictedFree
+#include "orionld/context/orionldContextCacheUsersRelease.h"     // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextCacheUsersRelease -
+//
+// Evicted contexts that were in use by this thread may now be unused by all threads - if so, they are freed.
+//
+void orionldContextCacheUsersRelease(void)
+{
+  OrionldContextCacheUsed* usedP = &orionldContextCacheUsed;
+
+  if (usedP->items > 0)
+  {
+    sem_wait(&orionldContextCacheSem);
+
+    for (int ix = 0; ix < usedP->items; ix++)
+      --usedP->vector[ix]->users;
+
+    if (orionldContextCacheEvicted != NULL)
+      orionldContextCacheEvictedFree();
+
+    sem_post(&orionldContextCacheSem);
+
+    usedP->items = 0;
+  }
+
+  if ((usedP->vector != NULL) && (usedP->vector != usedP->fixedV))
+  {
+    free(usedP->vector);
+    usedP->vector = usedP->fixedV;
+    usedP->size   = ORIONLD_CONTEXT_CACHE_USED_ITEMS;
+  }
+}
@@ -0,0 +1,126 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                              // NULL
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "orionld/context/orionldContextContentHash.h"           // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// FNV-1a, 64 bits - see http://www.isthe.com/chongo/tech/comp/fnv/
+//
+#define FNV64_OFFSET_BASIS  14695981039346656037ULL
+#define FNV64_PRIME         1099511628211ULL
+
+
+
+// -----------------------------------------------------------------------------
+//
+// hashBytes -
+//
+static unsigned long long hashBytes(unsigned long long hash, const char* s)
+{
+  while (*s != 0)
+  {
+    hash ^= (unsigned char) *s;
+    hash *= FNV64_PRIME;
+    ++s;
+  }
+
+  // Include the terminating zero, so that { "ab": "c" } and { "a": "bc" } differ
+  hash ^= 0;
+  hash *= FNV64_PRIME;
+
+  return hash;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// hashNode -
+//
+static unsigned long long hashNode(unsigned long long hash, KjNode* nodeP)
+{
+  hash ^= (unsigned char) nodeP->type;
+  hash *= FNV64_PRIME;
+
+  if (nodeP->name != NULL)
+    hash = hashBytes(hash, nodeP->name);
+
+  switch (nodeP->type)
+  {
+  case KjString:
+    hash = hashBytes(hash, nodeP->value.s);
+    break;
+
+  case KjInt:
+    hash ^= (unsigned long long) nodeP->value.i;
+    hash *= FNV64_PRIME;
+    break;
+
+  case KjBoolean:
+    hash ^= (nodeP->value.b == true)? 1 : 0;
+    hash *= FNV64_PRIME;
+    break;
+
+  case KjObject:
+  case KjArray:
+    for (KjNode* childP = nodeP->value.firstChildP; childP != NULL; childP = childP->next)
+    {
+      hash = hashNode(hash, childP);
+    }
+
+    // End of container - so that nesting is part of the hash
+    hash ^= 0xFF;
+    hash *= FNV64_PRIME;
+    break;
+
+  default:
+    // Floats and nulls - the type is enough (floats are not valid in a context anyway)
+    break;
+  }
+
+  return hash;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextContentHash -
+//
+unsigned long long orionldContextContentHash(KjNode* contextTreeP)
+{
+  unsigned long long hash = hashNode(FNV64_OFFSET_BASIS, contextTreeP);
+
+  return (hash == 0)? 1 : hash;
+}
@@ -22,9 +22,14 @@
 *
 * Author: Ken Zangelin
 */
+#include <stdlib.h>                                              // calloc
+#include <string.h>                                              // strerror
+#include <errno.h>                                               // errno
+#include <semaphore.h>                                           // sem_init
+
 extern "C"
 {
-#include "kalloc/kaAlloc.h"                                      // kaAlloc
+#include "kalloc/kaBufferInit.h"                                 // kaBufferInit
 #include "kalloc/kaStrdup.h"                                     // kaStrdup
 #include "kjson/kjClone.h"                                       // kjClone
 }
@@ -33,7 +38,14 @@ extern "C"
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
-#include "orionld/common/orionldState.h"                         // orionldState, kalloc
+
+
+
+// -----------------------------------------------------------------------------
+//
+// contextsCreated -
+//
+static unsigned int contextsCreated = 0;
 
 
 
@@ -41,17 +53,26 @@ extern "C"
 //
 // orionldContextCreate -
 //
+// The context is allocated with calloc and has its own kalloc instance, so that it can be freed
+// (orionldContextFree) once evicted from the context cache.
+//
 OrionldContext* orionldContextCreate(const char* url, const char* id, KjNode* tree, bool keyValues, bool toBeCloned)
 {
-  OrionldContext* contextP = (OrionldContext*) kaAlloc(&kalloc, sizeof(OrionldContext));
+  OrionldContext* contextP = (OrionldContext*) calloc(1, sizeof(OrionldContext));
 
   if (contextP == NULL)
     LM_X(1, ("out of memory - trying to allocate a OrionldContext of %d bytes", sizeof(OrionldContext)));
 
-  contextP->url       = kaStrdup(&kalloc, url);
-  contextP->id        = (id == NULL)? NULL : kaStrdup(&kalloc, id);
+  kaBufferInit(&contextP->kalloc, contextP->kallocBuffer, sizeof(contextP->kallocBuffer), 8 * 1024, NULL, "Context KAlloc buffer");
+
+  contextP->url       = kaStrdup(&contextP->kalloc, url);
+  contextP->id        = (id == NULL)? NULL : kaStrdup(&contextP->kalloc, id);
   contextP->tree      = (toBeCloned == true)? kjClone(tree) : NULL;
   contextP->keyValues = keyValues;
+  contextP->createdNo = __sync_fetch_and_add(&contextsCreated, 1);
+
+  if (sem_init(&contextP->memo.sem, 0, 1) == -1)
+    LM_X(1, ("Runtime Error (error initializing semaphore for the expansion memo of a context; %s)", strerror(errno)));
 
   return contextP;
 }
@@ -0,0 +1,57 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // free
+#include <semaphore.h>                                           // sem_destroy
+
+extern "C"
+{
+#include "kalloc/kaBufferReset.h"                                // kaBufferReset
+#include "kjson/kjFree.h"                                        // kjFree
+}
+
+#include "orionld/context/OrionldContext.h"                      // OrionldContext
+#include "orionld/context/orionldContextFree.h"                  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextFree - free all memory of a context
+//
+// Everything except the cloned tree is allocated in the context's own kalloc instance.
+// The context itself is allocated with calloc, in orionldContextCreate().
+//
+void orionldContextFree(OrionldContext* contextP)
+{
+  if (contextP->tree != NULL)
+  {
+    kjFree(contextP->tree);
+    contextP->tree = NULL;
+  }
+
+  sem_destroy(&contextP->memo.sem);
+  kaBufferReset(&contextP->kalloc, false);
+  free(contextP);
+}
@@ -24,6 +24,7 @@
 */
 extern "C"
 {
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
 #include "kjson/KjNode.h"                                        // KjNode
 }
 
@@ -39,7 +40,11 @@ extern "C"
 #include "orionld/context/orionldContextFromObject.h"            // orionldContextFromObject
 #include "orionld/context/orionldContextCacheInsert.h"           // orionldContextCacheInsert
 #include "orionld/context/orionldContextCacheLookup.h"           // orionldContextCacheLookup
+#include "orionld/context/orionldContextCacheContentLookup.h"    // orionldContextCacheContentLookup
+#include "orionld/context/orionldContextContentHash.h"           // orionldContextContentHash
+#include "orionld/context/orionldContextFree.h"                  // orionldContextFree
 #include "orionld/context/orionldContextCachePresent.h"          // orionldContextCachePresent
+#include "orionld/context/orionldContextTermTablesCreate.h"      // orionldContextTermTablesCreate
 #include "orionld/context/orionldContextFromArray.h"             // Own interface
 
 
@@ -48,19 +53,35 @@ extern "C"
 //
 // orionldContextFromArray -
 //
+// Just like for key-value contexts (see orionldContextFromObject), inline array contexts are looked up by the
+// hash of their content, and the context is inserted in the context cache only after it has been successfully created.
+//
 OrionldContext* orionldContextFromArray(char* url, bool toBeCloned, int itemsInArray, KjNode* contextArrayP, OrionldProblemDetails* pdP)
 {
-  char*           id = NULL;
-  OrionldContext* contextP;
+  char*               id          = NULL;
+  unsigned long long  contentHash = 0;
+  OrionldContext*     contextP;
 
   if (url == NULL)
-    url = orionldContextUrlGenerate(&id);
+  {
+    contentHash = orionldContextContentHash(contextArrayP);
+    contextP    = orionldContextCacheContentLookup(contentHash, contextArrayP);
+
+    if (contextP != NULL)
+      return contextP;
+
+    url = orionldContextUrlGenerate(contentHash, &id);
+    if (orionldContextCacheLookup(url) != NULL)  // Same hash, different content
+      url = orionldContextUrlGenerate(0, &id);
+
+    toBeCloned = true;
+  }
 
   contextP = orionldContextCreate(url, id, contextArrayP, false, toBeCloned);
-  orionldContextCacheInsert(contextP);
+  contextP->contentHash = contentHash;
 
   contextP->context.array.items    = itemsInArray;
-  contextP->context.array.vector   = (OrionldContext**) kaAlloc(&kalloc, itemsInArray * sizeof(OrionldContext*));
+  contextP->context.array.vector   = (OrionldContext**) kaAlloc(&contextP->kalloc, itemsInArray * sizeof(OrionldContext*));
 
 
   //
@@ -85,6 +106,7 @@ OrionldContext* orionldContextFromArray(char* url, bool toBeCloned, int itemsInA
       {
         // orionldContextFromUrl fills in pdP
         LM_E(("orionldContextFromUrl: %s: %s", pdP->title, pdP->detail));
+        orionldContextFree(contextP);
         return NULL;
       }
     }
@@ -96,6 +118,7 @@ OrionldContext* orionldContextFromArray(char* url, bool toBeCloned, int itemsInA
       {
         // orionldContextFromObject fills in pdP
         LM_E(("CTX: orionldContextFromObject: %s: %s", pdP->title, pdP->detail));
+        orionldContextFree(contextP);
         return NULL;
       }
     }
@@ -107,6 +130,7 @@ OrionldContext* orionldContextFromArray(char* url, bool toBeCloned, int itemsInA
       pdP->detail = (char*) kjValueType(arrayItemP->type);
       pdP->status = 400;
 
+      orionldContextFree(contextP);
       return NULL;
     }
 
@@ -114,5 +138,8 @@ OrionldContext* orionldContextFromArray(char* url, bool toBeCloned, int itemsInA
     --slot;
   }
 
+  orionldContextTermTablesCreate(contextP);
+  orionldContextCacheInsert(contextP);
+
   return contextP;
 }
@@ -33,37 +33,23 @@ extern "C"
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
 #include "orionld/common/OrionldProblemDetails.h"                // OrionldProblemDetails, orionldProblemDetailsFill
-#include "orionld/common/orionldState.h"                         // kalloc, orionldState
 #include "orionld/context/OrionldContextItem.h"                  // OrionldContextItem
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 #include "orionld/context/orionldContextCreate.h"                // orionldContextCreate
 #include "orionld/context/orionldContextUrlGenerate.h"           // orionldContextUrlGenerate
 #include "orionld/context/orionldContextCacheInsert.h"           // orionldContextCacheInsert
+#include "orionld/context/orionldContextCacheLookup.h"           // orionldContextCacheLookup
+#include "orionld/context/orionldContextCacheContentLookup.h"    // orionldContextCacheContentLookup
+#include "orionld/context/orionldContextContentHash.h"           // orionldContextContentHash
+#include "orionld/context/orionldContextFree.h"                  // orionldContextFree
 #include "orionld/context/orionldContextCache.h"                 // ORIONLD_CONTEXT_CACHE_HASH_ARRAY_SIZE
 #include "orionld/context/orionldContextHashTablesFill.h"        // orionldContextHashTablesFill
+#include "orionld/context/orionldContextTermHash.h"              // orionldContextTermHash
+#include "orionld/context/orionldContextTermTablesCreate.h"      // orionldContextTermTablesCreate
 #include "orionld/context/orionldContextFromObject.h"            // Own interface
 
 
 
-// -----------------------------------------------------------------------------
-//
-// hashCode -
-//
-unsigned int hashCode(const char* name)
-{
-  unsigned int code = 0;
-
-  while (*name != 0)
-  {
-    code += (unsigned char) *name;
-    ++name;
-  }
-
-  return code;
-}
-
-
-
 // -----------------------------------------------------------------------------
 //
 // nameCompareFunction -
@@ -99,26 +85,47 @@ static int valueCompareFunction(const char* longname, void* itemP)
 // Served contexts need to be cloned so that they can be copied back to the caller (GET /ngsi-ld/ex/contexts/xxx).
 // For example, the URL "http:/x.y.z/contexts/context1.jsonld" was downloaded and its content is a key-value object.
 //
+// Inline contexts (url == NULL) are looked up by the hash of their content first, and if not found, the context
+// is created and given a URL that is derived from the hash. Inline contexts are always cloned, as the tree is
+// needed to compare the content when looking them up.
+// The context is inserted in the context cache only after it has been successfully created.
+//
 OrionldContext* orionldContextFromObject(char* url, bool toBeCloned, KjNode* contextObjectP, OrionldProblemDetails* pdP)
 {
-  char*           id = NULL;
-  OrionldContext* contextP;
+  char*               id          = NULL;
+  unsigned long long  contentHash = 0;
+  OrionldContext*     contextP;
 
   if (url == NULL)
-    url  = orionldContextUrlGenerate(&id);
+  {
+    contentHash = orionldContextContentHash(contextObjectP);
+    contextP    = orionldContextCacheContentLookup(contentHash, contextObjectP);
+
+    if (contextP != NULL)
+      return contextP;
+
+    url = orionldContextUrlGenerate(contentHash, &id);
+    if (orionldContextCacheLookup(url) != NULL)  // Same hash, different content
+      url = orionldContextUrlGenerate(0, &id);
+
+    toBeCloned = true;
+  }
 
   contextP = orionldContextCreate(url, id, contextObjectP, true, toBeCloned);
-  orionldContextCacheInsert(contextP);
+  contextP->contentHash = contentHash;
 
-  contextP->context.hash.nameHashTable  = khashTableCreate(&kalloc, hashCode, nameCompareFunction,  ORIONLD_CONTEXT_CACHE_HASH_ARRAY_SIZE);
-  contextP->context.hash.valueHashTable = khashTableCreate(&kalloc, hashCode, valueCompareFunction, ORIONLD_CONTEXT_CACHE_HASH_ARRAY_SIZE);
+  contextP->context.hash.nameHashTable  = khashTableCreate(&contextP->kalloc, orionldContextTermHash, nameCompareFunction,  ORIONLD_CONTEXT_CACHE_HASH_ARRAY_SIZE);
+  contextP->context.hash.valueHashTable = khashTableCreate(&contextP->kalloc, orionldContextTermHash, valueCompareFunction, ORIONLD_CONTEXT_CACHE_HASH_ARRAY_SIZE);
 
   if (orionldContextHashTablesFill(contextP, contextObjectP, pdP) == false)
   {
     // orionldContextHashTablesFill fills in pdP
+    orionldContextFree(contextP);
     return NULL;
   }
 
+  orionldContextTermTablesCreate(contextP);
+  orionldContextCacheInsert(contextP);
+
   return contextP;
 }
-
@@ -38,7 +38,6 @@
 #include "orionld/context/OrionldContextItem.h"                  // OrionldContextItem
 #include "orionld/context/orionldCoreContext.h"                  // ORIONLD_CORE_CONTEXT_URL
 #include "orionld/context/orionldContextCacheInit.h"             // orionldContextCacheInit
-#include "orionld/context/orionldContextCacheInsert.h"           // orionldContextCacheInsert
 #include "orionld/context/orionldContextFromBuffer.h"            // orionldContextFromBuffer
 #include "orionld/context/orionldContextFromUrl.h"               // orionldContextFromUrl
 #include "orionld/context/orionldContextItemLookup.h"            // orionldContextItemLookup
@@ -179,8 +178,9 @@ static void contextFileTreat(char* dir, struct dirent* dirItemP)
   //
   // We have both the URL and the 'JSON Context'.
   // Time to parse the 'JSON Context', create the OrionldContext, and insert it into the list of contexts
+  // (orionldContextFromBuffer inserts the context in the context cache).
+  // Preloaded contexts are never evicted from the context cache.
   //
-
   OrionldContext* contextP = orionldContextFromBuffer(url, json, &pd);
 
   if (strcmp(url, ORIONLD_CORE_CONTEXT_URL) == 0)
@@ -189,13 +189,11 @@ static void contextFileTreat(char* dir, struct dirent* dirItemP)
       LM_X(1, ("error creating the core context from file system file '%s'", path));
     orionldCoreContextP = contextP;
   }
-  else
-  {
-    if (contextP == NULL)
-      LM_E(("error creating context from file system file '%s'", path));
-    else
-      orionldContextCacheInsert(contextP);
-  }
+  else if (contextP == NULL)
+    LM_E(("error creating context from file system file '%s'", path));
+
+  if (contextP != NULL)
+    contextP->permanent = true;
 }
 
 
@@ -265,6 +263,8 @@ bool orionldContextInit(OrionldProblemDetails* pdP)
       return false;
   }
 
+  orionldCoreContextP->permanent = true;
+
   OrionldContextItem* vocabP = orionldContextItemLookup(orionldCoreContextP, "@vocab", NULL);
 
   if (vocabP == NULL)
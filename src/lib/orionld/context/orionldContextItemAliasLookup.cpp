@@ -61,11 +61,14 @@ char* orionldContextItemAliasLookup
   if (strncmp(longName, orionldDefaultUrl, orionldDefaultUrlLen) == 0)
     return (char*) &longName[orionldDefaultUrlLen];
 
-  // 2. Found in Core Context?
-  contextItemP = orionldContextItemValueLookup(orionldCoreContextP, longName);
+  // 2. Found in Core Context? (unless the Core Context is part of the term tables of the given context)
+  if ((contextP == NULL) || (contextP->termsWithCore == false))
+    contextItemP = orionldContextItemValueLookup(orionldCoreContextP, longName);
+  else
+    contextItemP = NULL;
 
   // 3. If not, look in the provided context, unless it's the Core Context
-  if ((contextItemP == NULL) && (contextP != orionldCoreContextP))
+  if ((contextItemP == NULL) && (contextP != NULL) && (contextP != orionldCoreContextP))
     contextItemP = orionldContextItemValueLookup(contextP, longName);
 
   // 4. If not found anywhere - return the long name
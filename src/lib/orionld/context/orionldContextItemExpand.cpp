@@ -24,15 +24,23 @@
 */
 #include <string.h>                                              // strchr
 
+extern "C"
+{
+#include "kalloc/kaStrdup.h"                                     // kaStrdup
+}
+
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 #include "orionld/context/OrionldContextItem.h"                  // OrionldContextItem
 #include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/SCOMPARE.h"                             // SCOMPAREx
 #include "orionld/context/orionldCoreContext.h"                  // orionldCoreContextP
 #include "orionld/context/orionldContextPrefixExpand.h"          // orionldContextPrefixExpand
 #include "orionld/context/orionldContextItemLookup.h"            // orionldContextItemLookup
+#include "orionld/context/orionldContextMemoLookup.h"            // orionldContextMemoLookup
+#include "orionld/context/orionldContextMemoInsert.h"            // orionldContextMemoInsert
 #include "orionld/context/orionldContextItemExpand.h"            // Own interface
 
 
@@ -58,6 +66,9 @@
 //   If the expansion IS found, then a pointer to the longname (that is part of the context where it was found)
 //   is returned and we save some time by not copying anything.
 //
+//   The expansions of prefixed names (CURIEs) are memoized in the context (see orionldContextMemoLookup), so the
+//   prefix is looked up and the long name composed only the first time a CURIE is seen.
+//
 char* orionldContextItemExpand
 (
   OrionldContext*       contextP,
@@ -77,10 +88,33 @@ char* orionldContextItemExpand
     contextP = orionldCoreContextP;
 
   if ((colonP = strchr((char*) shortName, ':')) != NULL)
-    return orionldContextPrefixExpand(contextP, shortName, colonP);
+  {
+    // URNs and URLs are not expanded (see orionldContextPrefixExpand) - no need to look them up in the memo
+    if (SCOMPARE4(shortName, 'u', 'r', 'n', ':') || ((colonP[1] == '/') && (colonP[2] == '/')))
+      return (char*) shortName;
+
+    //
+    // Prefixed names are memoized. The caller may modify the returned string, so, just like
+    // orionldContextPrefixExpand does, a copy in the request's allocator is returned.
+    //
+    OrionldContextMemoItem* memoItemP = orionldContextMemoLookup(contextP, shortName);
+
+    if (memoItemP != NULL)
+      return kaStrdup(&orionldState.kalloc, memoItemP->longName);
+
+    char* longName = orionldContextPrefixExpand(contextP, shortName, colonP);
+
+    if (longName != shortName)
+      orionldContextMemoInsert(contextP, shortName, longName);
+
+    return longName;
+  }
 
-  // 1. Lookup in Core Context
-  contextItemP = orionldContextItemLookup(orionldCoreContextP, shortName, NULL);
+  // 1. Lookup in Core Context - unless the Core Context is part of the term tables of the given context
+  if (contextP->termsWithCore == false)
+    contextItemP = orionldContextItemLookup(orionldCoreContextP, shortName, NULL);
+  else
+    contextItemP = NULL;
 
   // 2. Lookup in given context (unless it's the Core Context)
   if ((contextItemP == NULL) && (contextP != orionldCoreContextP))
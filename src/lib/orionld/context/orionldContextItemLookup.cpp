@@ -41,6 +41,11 @@ extern "C"
 //
 // orionldContextItemLookup - lookup an item in a context
 //
+// All terms of a context, also those of the members of an array context, are in its flattened
+// term tables (see orionldContextTermTablesCreate), so this is a single hash table lookup.
+// Contexts without term tables (not created by orionldContextFromObject/orionldContextFromArray)
+// are looked up member by member.
+//
 OrionldContextItem* orionldContextItemLookup(OrionldContext* contextP, const char* name, bool* valueMayBeCompactedP)
 {
   OrionldContextItem* itemP = NULL;
@@ -48,7 +53,9 @@ OrionldContextItem* orionldContextItemLookup(OrionldContext* contextP, const cha
   if (contextP == NULL)
     contextP = orionldCoreContextP;
 
-  if (contextP->keyValues == true)
+  if (contextP->terms.nameHashTable != NULL)
+    itemP = (OrionldContextItem*) khashItemLookup(contextP->terms.nameHashTable, name);
+  else if (contextP->keyValues == true)
     itemP = (OrionldContextItem*) khashItemLookup(contextP->context.hash.nameHashTable, name);
   else
   {
@@ -61,7 +68,7 @@ OrionldContextItem* orionldContextItemLookup(OrionldContext* contextP, const cha
 
   if (valueMayBeCompactedP != NULL)
   {
-    if ((itemP->type != NULL) && (strcmp(itemP->type, "@vocab") == 0))
+    if ((itemP != NULL) && (itemP->type != NULL) && (strcmp(itemP->type, "@vocab") == 0))
       *valueMayBeCompactedP = true;
     else
       *valueMayBeCompactedP = false;
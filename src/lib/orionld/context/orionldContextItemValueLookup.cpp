@@ -36,11 +36,15 @@
 //
 // orionldContextItemValueLookup - lookup a value in a context
 //
+// Just like orionldContextItemLookup, a single lookup in the flattened term tables, if present.
+//
 OrionldContextItem* orionldContextItemValueLookup(OrionldContext* contextP, const char* longname)
 {
   OrionldContextItem* itemP = NULL;
 
-  if (contextP->keyValues == true)
+  if (contextP->terms.valueHashTable != NULL)
+    itemP = (OrionldContextItem*) khashItemLookup(contextP->terms.valueHashTable, longname);
+  else if (contextP->keyValues == true)
     itemP = (OrionldContextItem*) khashItemLookup(contextP->context.hash.valueHashTable, longname);
   else
   {
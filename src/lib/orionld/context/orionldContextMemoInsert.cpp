@@ -0,0 +1,91 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp
+#include <semaphore.h>                                           // sem_wait, sem_post
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+#include "kalloc/kaStrdup.h"                                     // kaStrdup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/context/OrionldContext.h"                      // OrionldContext, OrionldContextMemoItem
+#include "orionld/context/orionldContextCache.h"                 // orionldContextMemoStats
+#include "orionld/context/orionldContextTermHash.h"              // orionldContextTermHash
+#include "orionld/context/orionldContextMemoInsert.h"            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextMemoInsert - memoize the expansion of a name
+//
+// The item is allocated on the kalloc of the context, and so it lives as long as the context does.
+// The inserts are serialized by the semaphore of the memo, and the item is complete before it is published
+// as the new head of its bucket list (release semantics), so orionldContextMemoLookup needs no lock.
+//
+// Once a context has ORIONLD_CONTEXT_MEMO_MAX_ITEMS memoized expansions, nothing more is added - names that
+// aren't in the memo are simply expanded the normal way.
+//
+void orionldContextMemoInsert(OrionldContext* contextP, const char* shortName, const char* longName)
+{
+  OrionldContextMemo*  memoP  = &contextP->memo;
+  unsigned int         bucket = orionldContextTermHash(shortName) & (ORIONLD_CONTEXT_MEMO_BUCKETS - 1);
+
+  sem_wait(&memoP->sem);
+
+  if (memoP->items >= ORIONLD_CONTEXT_MEMO_MAX_ITEMS)
+  {
+    sem_post(&memoP->sem);
+    return;
+  }
+
+  // Another thread may have inserted the same name meanwhile
+  for (OrionldContextMemoItem* itemP = memoP->bucket[bucket]; itemP != NULL; itemP = itemP->next)
+  {
+    if (strcmp(itemP->shortName, shortName) == 0)
+    {
+      sem_post(&memoP->sem);
+      return;
+    }
+  }
+
+  OrionldContextMemoItem* itemP = (OrionldContextMemoItem*) kaAlloc(&contextP->kalloc, sizeof(OrionldContextMemoItem));
+
+  itemP->shortName = kaStrdup(&contextP->kalloc, shortName);
+  itemP->longName  = kaStrdup(&contextP->kalloc, longName);
+  itemP->next      = memoP->bucket[bucket];
+
+  __atomic_store_n(&memoP->bucket[bucket], itemP, __ATOMIC_RELEASE);
+  ++memoP->items;
+
+  sem_post(&memoP->sem);
+
+  __sync_fetch_and_add(&orionldContextMemoStats.inserts, 1);
+  LM_T(LmtContext, ("Memoized expansion '%s' -> '%s' in context '%s'", shortName, longName, contextP->url));
+}
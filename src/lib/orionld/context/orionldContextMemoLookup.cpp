@@ -0,0 +1,61 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp
+
+#include "orionld/context/OrionldContext.h"                      // OrionldContext, OrionldContextMemoItem
+#include "orionld/context/orionldContextCache.h"                 // orionldContextMemoStats
+#include "orionld/context/orionldContextTermHash.h"              // orionldContextTermHash
+#include "orionld/context/orionldContextMemoLookup.h"            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextMemoLookup - lookup a memoized expansion of a name
+//
+// The memo of a context is shared by all threads and lives as long as the context.
+// Items are only ever added (at the head of the bucket lists, see orionldContextMemoInsert), never modified or
+// removed, so the lookup needs no lock - the bucket heads are read with acquire semantics to see complete items.
+//
+OrionldContextMemoItem* orionldContextMemoLookup(OrionldContext* contextP, const char* shortName)
+{
+  unsigned int             bucket = orionldContextTermHash(shortName) & (ORIONLD_CONTEXT_MEMO_BUCKETS - 1);
+  OrionldContextMemoItem*  itemP  = __atomic_load_n(&contextP->memo.bucket[bucket], __ATOMIC_ACQUIRE);
+
+  __sync_fetch_and_add(&orionldContextMemoStats.lookups, 1);
+
+  while (itemP != NULL)
+  {
+    if (strcmp(itemP->shortName, shortName) == 0)
+    {
+      __sync_fetch_and_add(&orionldContextMemoStats.hits, 1);
+      return itemP;
+    }
+
+    itemP = itemP->next;
+  }
+
+  return NULL;
+}
@@ -0,0 +1,50 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/context/orionldContextTermHash.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextTermHash - hash function for the term tables of the contexts
+//
+// 32-bit FNV-1a.
+// Summing the bytes of the term, as was done before, makes names made of the same characters (e.g. 'name' and 'mean')
+// collide, and crowds the short names in the lower slots of the table.
+// FNV-1a spreads the terms over the whole table, also in its low bits, so the table size may be a power of two.
+//
+unsigned int orionldContextTermHash(const char* term)
+{
+  unsigned int hash = 2166136261U;
+
+  while (*term != 0)
+  {
+    hash ^= (unsigned char) *term;
+    hash *= 16777619U;
+    ++term;
+  }
+
+  return hash;
+}
@@ -0,0 +1,190 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp
+
+extern "C"
+{
+#include "khash/khash.h"                                         // KHashTable, KHashListItem, khashTableCreate, khashItemAdd, khashItemLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/context/OrionldContext.h"                      // OrionldContext, OrionldContextHashTables
+#include "orionld/context/OrionldContextItem.h"                  // OrionldContextItem
+#include "orionld/context/orionldCoreContext.h"                  // orionldCoreContextP
+#include "orionld/context/orionldContextTermHash.h"              // orionldContextTermHash
+#include "orionld/context/orionldContextTermTablesCreate.h"      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// nameCompareFunction -
+//
+static int nameCompareFunction(const char* name, void* itemP)
+{
+  OrionldContextItem* cItemP = (OrionldContextItem*) itemP;
+
+  return strcmp(name, cItemP->name);
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// valueCompareFunction -
+//
+static int valueCompareFunction(const char* longname, void* itemP)
+{
+  OrionldContextItem* cItemP = (OrionldContextItem*) itemP;
+
+  return strcmp(longname, cItemP->id);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// termsCount -
+//
+static unsigned int termsCount(KHashTable* tableP)
+{
+  unsigned int terms = 0;
+
+  for (unsigned int slot = 0; slot < tableP->arraySize; ++slot)
+  {
+    for (KHashListItem* itemP = tableP->array[slot]; itemP != NULL; itemP = itemP->next)
+      ++terms;
+  }
+
+  return terms;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// termsMerge - add the terms of 'termsP' that aren't already in 'flatP'
+//
+// The terms are merged in order of precedence, so a term that is already present is not overridden.
+//
+static void termsMerge(OrionldContextHashTables* flatP, OrionldContextHashTables* termsP)
+{
+  KHashTable* tableP = termsP->nameHashTable;
+
+  for (unsigned int slot = 0; slot < tableP->arraySize; ++slot)
+  {
+    for (KHashListItem* itemP = tableP->array[slot]; itemP != NULL; itemP = itemP->next)
+    {
+      OrionldContextItem* ciP = (OrionldContextItem*) itemP->data;
+
+      if (khashItemLookup(flatP->nameHashTable, ciP->name) == NULL)
+        khashItemAdd(flatP->nameHashTable, ciP->name, ciP);
+
+      if (khashItemLookup(flatP->valueHashTable, ciP->id) == NULL)
+        khashItemAdd(flatP->valueHashTable, ciP->id, ciP);
+    }
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextTermTablesCreate - create the flattened term tables of a context
+//
+// The 'terms' of a context are a single pair of hash tables (name -> item and long name -> item) with all
+// the terms that the context resolves - those of the Core Context and those of all members of an array context,
+// nested arrays included - so that expanding or compacting a name is a single lookup, however the context is nested.
+//
+// The terms are merged in the order of precedence that orionldContextItemExpand and orionldContextItemAliasLookup
+// have always used:
+//   1. The Core Context (its terms cannot be overridden)
+//   2. The members of an array context, the last member first (context.array.vector is sorted backwards)
+//
+// Members of array contexts already have their term tables, so their terms are merged as is, without recursion.
+// The items themselves are not copied - the tables point to the items of the contexts that define them. The members
+// of a cached array context are never evicted while the array context remains in the cache (see 'arrayRefs')
+// and the Core Context is permanent.
+//
+// A key-value context with no Core Context to merge (the Core Context itself, and contexts loaded before the
+// Core Context) simply uses its own hash tables as term tables. 'termsWithCore' tells whether the Core Context
+// is part of the term tables - if not, the Core Context must be looked up first.
+//
+// The tables are allocated on the kalloc of the context and sized to the number of terms.
+//
+void orionldContextTermTablesCreate(OrionldContext* contextP)
+{
+  bool withCore = (orionldCoreContextP != NULL) && (contextP != orionldCoreContextP);
+
+  if ((contextP->keyValues == true) && (withCore == false))
+  {
+    contextP->terms         = contextP->context.hash;
+    contextP->termsWithCore = false;
+    return;
+  }
+
+  //
+  // Count the terms, to size the tables
+  //
+  unsigned int terms = 0;
+
+  if (withCore == true)
+    terms += termsCount(orionldCoreContextP->terms.nameHashTable);
+
+  if (contextP->keyValues == true)
+    terms += termsCount(contextP->context.hash.nameHashTable);
+  else
+  {
+    for (int ix = 0; ix < contextP->context.array.items; ++ix)
+      terms += termsCount(contextP->context.array.vector[ix]->terms.nameHashTable);
+  }
+
+  //
+  // Twice as many slots as terms, rounded up to a power of two
+  //
+  unsigned int slots = 16;
+
+  while (slots < 2 * terms)
+    slots *= 2;
+
+  contextP->terms.nameHashTable  = khashTableCreate(&contextP->kalloc, orionldContextTermHash, nameCompareFunction,  slots);
+  contextP->terms.valueHashTable = khashTableCreate(&contextP->kalloc, orionldContextTermHash, valueCompareFunction, slots);
+  contextP->termsWithCore        = withCore;
+
+  if (withCore == true)
+    termsMerge(&contextP->terms, &orionldCoreContextP->terms);
+
+  if (contextP->keyValues == true)
+    termsMerge(&contextP->terms, &contextP->context.hash);
+  else
+  {
+    for (int ix = 0; ix < contextP->context.array.items; ++ix)
+      termsMerge(&contextP->terms, &contextP->context.array.vector[ix]->terms);
+  }
+
+  LM_T(LmtContext, ("Context '%s': %d terms in %d slots (%s the Core Context)", contextP->url, terms, slots, (withCore == true)? "with" : "without"));
+}
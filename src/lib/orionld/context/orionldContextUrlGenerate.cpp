@@ -28,7 +28,7 @@ extern "C"
 }
 
 #include "orionld/common/uuidGenerate.h"                         // uuidGenerate
-#include "orionld/common/orionldState.h"                         // orionldHostName, orionldHostNameLen
+#include "orionld/common/orionldState.h"                         // orionldState, orionldHostName, orionldHostNameLen
 #include "orionld/context/orionldContextUrlGenerate.h"           // Own interface
 
 
@@ -37,23 +37,31 @@ extern "C"
 //
 // orionldContextUrlGenerate -
 //
+// The id of the context is the hex representation of the hash of its content, so that an inline context
+// always gets the same URL - also after a restart of the broker.
+// If 'contentHash' is zero (two different contexts with the same hash), a uuid is used instead.
+// The URL is allocated in the request's kalloc, orionldContextCreate copies it to the context.
+//
 // The size used in the call to kaAlloc:
 //   - strlen("http://HOSTNAME:PORT"):       12
 //   - strlen("/ngsi-ld/ex/v1/contexts/"):   24
-//   - uuidGenerate:                         37
+//   - uuidGenerate (or 16 hex digits):      37
 //   - zero termination:                     1
 //   - orionldHostNameLen
 //
 //  => 74 + orionldHostNameLen
 //
-char* orionldContextUrlGenerate(char** contextIdP)
+char* orionldContextUrlGenerate(unsigned long long contentHash, char** contextIdP)
 {
-  char* url = (char*) kaAlloc(&kalloc, 74 + orionldHostNameLen);
+  char* url    = (char*) kaAlloc(&orionldState.kalloc, 74 + orionldHostNameLen);
+  int   urlLen = snprintf(url, 74 + orionldHostNameLen, "http://%s:%d/ngsi-ld/ex/v1/contexts/", orionldHostName, portNo);
 
-  snprintf(url, 74 + orionldHostNameLen, "http://%s:%d/ngsi-ld/ex/v1/contexts/", orionldHostName, portNo);
-  uuidGenerate(&url[36 + orionldHostNameLen]);
+  if (contentHash != 0)
+    snprintf(&url[urlLen], 74 + orionldHostNameLen - urlLen, "%016llx", contentHash);
+  else
+    uuidGenerate(&url[urlLen]);
 
-  *contextIdP = &url[36 + orionldHostNameLen];
+  *contextIdP = &url[urlLen];
 
   return url;
 }
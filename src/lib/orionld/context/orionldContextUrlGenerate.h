@@ -30,8 +30,8 @@
 
 // -----------------------------------------------------------------------------
 //
-// orionldContextUrlGenerate -
+// orionldContextUrlGenerate - generate the URL of a context that was created by the broker
 //
-extern char* orionldContextUrlGenerate(char** contextIdP);
+extern char* orionldContextUrlGenerate(unsigned long long contentHash, char** contextIdP);
 
 #endif  // SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXTURLGENERATE_H_
@@ -34,17 +34,20 @@ extern "C"
 
 // -----------------------------------------------------------------------------
 //
-// DB_DRIVER_MONGO_CPP_LEGACY - Use the mongo C++ Legacy driver
+// DB_DRIVER_MONGOC - Use the "newest" mongo C driver
+//
+// Defined by the build (cmake -DORIONLD_MONGOC=ON), not here.
 //
-#define DB_DRIVER_MONGO_CPP_LEGACY 1
 
 
 
 // -----------------------------------------------------------------------------
 //
-// DB_DRIVER_MONGOC - Use the "newest" mongo C driver
+// DB_DRIVER_MONGO_CPP_LEGACY - Use the mongo C++ Legacy driver - the default
 //
-// #define DB_DRIVER_MONGOC 1
+#ifndef DB_DRIVER_MONGOC
+#define DB_DRIVER_MONGO_CPP_LEGACY 1
+#endif
 
 
 
@@ -77,6 +80,8 @@ typedef KjNode* (*DbSubscriptionGet)(const char* subscriptionId);
 typedef bool    (*DbSubscriptionReplace)(const char* subscriptionId, KjNode* dbSubscriptionP);
 typedef KjNode* (*DbRegistrationGet)(const char* registrationId);
 typedef bool    (*DbRegistrationReplace)(const char* registrationId, KjNode* dbRegistrationP);
+typedef KjNode* (*DbRegistrationListGet)(void);
+typedef KjNode* (*DbEntitiesQuery)(KjNode* entitySelectorArray, KjNode* attrsArray, char** cursorV, int offset, int limit, long long* countP, bool countEstimated);
 
 
 
@@ -101,5 +106,7 @@ extern DbSubscriptionGet                         dbSubscriptionGet;
 extern DbSubscriptionReplace                     dbSubscriptionReplace;
 extern DbRegistrationGet                         dbRegistrationGet;
 extern DbRegistrationReplace                     dbRegistrationReplace;
+extern DbRegistrationListGet                     dbRegistrationListGet;
+extern DbEntitiesQuery                           dbEntitiesQuery;
 
 #endif  // SRC_LIB_ORIONLD_DB_DBCONFIGURATION_H_
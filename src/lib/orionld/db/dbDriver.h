@@ -27,9 +27,10 @@
 */
 #include "orionld/db/dbConfiguration.h"                        // DB_DRIVER_MONGOC
 
-#ifdef DB_DRIVER_MONGO_CPP_LEGACY
+//
+// The Legacy C++ driver is needed also with DB_DRIVER_MONGOC, as mongoBackend (and orionldState.qMongoFilterP) still use it
+//
 #include "mongo/client/dbclient.h"                             // mongo::BSONObj of Legacy C++ driver
-#endif
 
 #ifdef DB_DRIVER_MONGOC
 #include "mongoc/mongoc.h"                                     // MongoDB C Client Driver
@@ -22,7 +22,10 @@
 *
 * Author: Ken Zangelin
 */
+#include "common/globals.h"                                                 // noCache
 #include "orionld/db/dbConfiguration.h"                                    // This is where the DB is selected
+#include "orionld/db/dbSubCacheSubscriptionMatchEntityIdAndAttributes.h"   // dbSubCacheSubscriptionMatchEntityIdAndAttributes
+#include "orionld/db/dbRegCacheRegistrationLookup.h"                       // dbRegCacheRegistrationLookup
 
 #if DB_DRIVER_MONGO_CPP_LEGACY
 
@@ -43,12 +46,29 @@
 #include "orionld/mongoCppLegacy/mongoCppLegacySubscriptionReplace.h"      // mongoCppLegacySubscriptionReplace
 #include "orionld/mongoCppLegacy/mongoCppLegacyRegistrationGet.h"          // mongoCppLegacyRegistrationGet
 #include "orionld/mongoCppLegacy/mongoCppLegacyRegistrationReplace.h"      // mongoCppLegacyRegistrationReplace
+#include "orionld/mongoCppLegacy/mongoCppLegacyRegistrationListGet.h"      // mongoCppLegacyRegistrationListGet
+#include "orionld/mongoCppLegacy/mongoCppLegacyEntitiesQuery.h"            // mongoCppLegacyEntitiesQuery
 
 #elif DB_DRIVER_MONGOC
 #include "orionld/mongoc/mongocInit.h"                                     // mongocInit
 #include "orionld/mongoc/mongocEntityUpdate.h"                             // mongocEntityUpdate
 #include "orionld/mongoc/mongocEntityLookup.h"                             // mongocEntityLookup
+#include "orionld/mongoc/mongocEntityAttributeLookup.h"                    // mongocEntityAttributeLookup
+#include "orionld/mongoc/mongocEntityAttributesDelete.h"                   // mongocEntityAttributesDelete
 #include "orionld/mongoc/mongocKjTreeFromBson.h"                           // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocKjTreeToBson.h"                             // mongocKjTreeToBson
+#include "orionld/mongoc/mongocEntityBatchDelete.h"                        // mongocEntityBatchDelete
+#include "orionld/mongoc/mongocEntityListLookupWithIdTypeCreDate.h"        // mongocEntityListLookupWithIdTypeCreDate
+#include "orionld/mongoc/mongocRegistrationLookup.h"                       // mongocRegistrationLookup
+#include "orionld/mongoc/mongocRegistrationExists.h"                       // mongocRegistrationExists
+#include "orionld/mongoc/mongocRegistrationDelete.h"                       // mongocRegistrationDelete
+#include "orionld/mongoc/mongocSubscriptionGet.h"                          // mongocSubscriptionGet
+#include "orionld/mongoc/mongocSubscriptionReplace.h"                      // mongocSubscriptionReplace
+#include "orionld/mongoc/mongocRegistrationGet.h"                          // mongocRegistrationGet
+#include "orionld/mongoc/mongocRegistrationReplace.h"                      // mongocRegistrationReplace
+#include "orionld/mongoc/mongocRegistrationListGet.h"                      // mongocRegistrationListGet
+#include "orionld/mongoc/mongocEntitiesQuery.h"                            // mongocEntitiesQuery
+#include "orionld/mongoc/mongocSubscriptionMatchEntityIdAndAttributes.h"   // mongocSubscriptionMatchEntityIdAndAttributes
 #endif
 #include "orionld/db/dbInit.h"                                             // Own interface
 
@@ -82,29 +102,55 @@ void dbInit(const char* dbHost, const char* dbName)
   dbSubscriptionReplace                    = mongoCppLegacySubscriptionReplace;
   dbRegistrationGet                        = mongoCppLegacyRegistrationGet;
   dbRegistrationReplace                    = mongoCppLegacyRegistrationReplace;
+  dbRegistrationListGet                    = mongoCppLegacyRegistrationListGet;
+  dbEntitiesQuery                          = mongoCppLegacyEntitiesQuery;
+
+  //
+  // Unless the subscription cache is turned off, subscriptions are matched using the cache
+  // Same thing for the registrations, used for forwarding
+  //
+  if (noCache == false)
+  {
+    dbSubscriptionMatchEntityIdAndAttributes = dbSubCacheSubscriptionMatchEntityIdAndAttributes;
+    dbRegistrationLookup                     = dbRegCacheRegistrationLookup;
+  }
 
   mongoCppLegacyInit(dbHost, dbName);
 
 #elif DB_DRIVER_MONGOC
 
   dbEntityLookup                           = mongocEntityLookup;
+  dbEntityAttributeLookup                  = mongocEntityAttributeLookup;
+  dbEntityAttributesDelete                 = mongocEntityAttributesDelete;
   dbEntityUpdate                           = mongocEntityUpdate;
-  dbDataToKjTree                           = mongocKjTreeFromBsonObj;
-  dbDataFromKjTree                         = NULL;  // FIXME: Implement mongocKjTreeToBson
-  dbEntityBatchDelete                      = NULL;  // FIXME: Implement mongocEntityBatchDelete
-  dbSubscriptionMatchEntityIdAndAttributes = NULL;  // FIXME: Implement mongocSubscriptionMatchEntityIdAndAttributes
-  dbEntityListLookupWithIdTypeCreDate      = NULL;  // FIXME: Implement mongocEntityListLookupWithIdTypeCreDate
-  dbRegistrationLookup                     = NULL;  // FIXME: Implement mongocRegistrationLookup
-  dbRegistrationExists                     = NULL;  // FIXME: Implement mongocRegistrationExists
-  dbRegistrationDelete                     = NULL;  // FIXME: Implement mongocRegistrationDelete
-  dbSubscriptionGet                        = NULL;  // FIXME: Implement mongocSubscriptionGet
-  dbSubscriptionReplace                    = NULL;  // FIXME: Implement mongocSubscriptionReplace
-  dbRegistrationGet                        = NULL;  // FIXME: Implement mongocRegistrationGet
-  dbRegistrationReplace                    = NULL;  // FIXME: Implement mongocRegistrationReplace
+  dbDataToKjTree                           = mongocKjTreeFromBson;
+  dbDataFromKjTree                         = mongocKjTreeToBson;
+  dbEntityBatchDelete                      = mongocEntityBatchDelete;
+  dbSubscriptionMatchEntityIdAndAttributes = mongocSubscriptionMatchEntityIdAndAttributes;
+  dbEntityListLookupWithIdTypeCreDate      = mongocEntityListLookupWithIdTypeCreDate;
+  dbRegistrationLookup                     = mongocRegistrationLookup;
+  dbRegistrationExists                     = mongocRegistrationExists;
+  dbRegistrationDelete                     = mongocRegistrationDelete;
+  dbSubscriptionGet                        = mongocSubscriptionGet;
+  dbSubscriptionReplace                    = mongocSubscriptionReplace;
+  dbRegistrationGet                        = mongocRegistrationGet;
+  dbRegistrationReplace                    = mongocRegistrationReplace;
+  dbRegistrationListGet                    = mongocRegistrationListGet;
+  dbEntitiesQuery                          = mongocEntitiesQuery;
+
+  //
+  // Unless the subscription cache is turned off, subscriptions are matched using the cache
+  // Same thing for the registrations, used for forwarding
+  //
+  if (noCache == false)
+  {
+    dbSubscriptionMatchEntityIdAndAttributes = dbSubCacheSubscriptionMatchEntityIdAndAttributes;
+    dbRegistrationLookup                     = dbRegCacheRegistrationLookup;
+  }
 
   mongocInit(dbHost, dbName);
 
 #else
-  #error Please define either DB_DRIVER_MONGO_CPP_LEGACY or DB_DRIVER_MONGOC in src/lib/orionld/db/dbConfiguration.h
+  #error Please define either DB_DRIVER_MONGO_CPP_LEGACY or DB_DRIVER_MONGOC (see src/lib/orionld/db/dbConfiguration.h)
 #endif
 }
@@ -0,0 +1,117 @@
+#ifndef SRC_LIB_ORIONLD_DB_DBREGCACHE_H_
+#define SRC_LIB_ORIONLD_DB_DBREGCACHE_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                             // pthread_rwlock_t
+#include <regex.h>                                               // regex_t
+
+extern "C"
+{
+#include "kalloc/KAlloc.h"                                       // KAlloc
+#include "khash/khash.h"                                         // KHashTable
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// RegCacheRegistration - a registration, as stored in the database, rendered as JSON text
+//
+// The JSON text is parsed into the allocator of the request on every hit, so that the tree that
+// is handed to the caller stays valid after the cache has been refreshed.
+//
+typedef struct RegCacheRegistration
+{
+  char*                         regId;
+  char*                         json;
+  struct RegCacheRegistration*  next;
+} RegCacheRegistration;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// RegCacheEntity - one entity (id or idPattern) of a contextRegistration of a registration
+//
+// If the contextRegistration has no attributes, all attributes are registered and 'attrV' is NULL.
+//
+// Entities with the same id are linked via 'sameIdNext', as only the first of them is in the hash table.
+// Entities with an idPattern are kept in the pattern list of the tenant instead.
+//
+typedef struct RegCacheEntity
+{
+  RegCacheRegistration*   regP;
+  char*                   id;
+  bool                    isPattern;
+  regex_t                 regex;
+  char**                  attrV;
+  int                     attrs;
+  struct RegCacheEntity*  sameIdNext;
+  struct RegCacheEntity*  next;
+} RegCacheEntity;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// RegCacheTenant - all registrations of a tenant
+//
+// Everything that hangs from a RegCacheTenant is allocated in its own allocator, so the
+// entire tenant is freed in one go when it's replaced by a newer version.
+//
+typedef struct RegCacheTenant
+{
+  char*                   tenant;
+  KAlloc                  kalloc;
+  char                    kallocBuffer[8 * 1024];
+  KHashTable*             idTable;
+  RegCacheEntity*         patternList;
+  RegCacheRegistration*   regList;
+  int                     registrations;
+  struct RegCacheTenant*  next;
+} RegCacheTenant;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Size of the entity id hash table of each tenant
+//
+#define REG_CACHE_ID_TABLE_SIZE  1024
+
+
+
+// -----------------------------------------------------------------------------
+//
+// regCacheTenantList - the cached tenants, protected by regCacheLock
+//
+// Lookups take the lock for reading, a refresh of a tenant only takes it for writing while
+// the new version of the tenant is swapped in.
+//
+extern RegCacheTenant*   regCacheTenantList;
+extern pthread_rwlock_t  regCacheLock;
+
+#endif  // SRC_LIB_ORIONLD_DB_DBREGCACHE_H_
@@ -0,0 +1,79 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                             // pthread_rwlock_rdlock, pthread_rwlock_unlock
+#include <string>                                                // std::string
+#include <vector>                                                // std::vector
+#include <algorithm>                                             // std::find
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "mongoBackend/MongoGlobal.h"                            // getOrionDatabases, tenantFromDb
+#include "orionld/common/orionldState.h"                         // multitenancy
+#include "orionld/db/dbRegCache.h"                               // RegCacheTenant, regCacheTenantList, regCacheLock
+#include "orionld/db/dbRegCacheTenantRefresh.h"                  // dbRegCacheTenantRefresh
+#include "orionld/db/dbRegCacheRefresh.h"                        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbRegCacheRefresh - reload the registrations of all tenants from the database into the registration cache
+//
+// The tenants to refresh are:
+//   - the default tenant ("")
+//   - the tenants that have a database (only if multitenancy is on)
+//   - the tenants that are already in the cache (a tenant whose database has been removed is emptied this way)
+//
+void dbRegCacheRefresh(void)
+{
+  std::vector<std::string> tenants;
+
+  tenants.push_back("");
+
+  if (multitenancy == true)
+  {
+    std::vector<std::string> databases;
+
+    getOrionDatabases(&databases);
+
+    for (unsigned int ix = 0; ix < databases.size(); ++ix)
+      tenants.push_back(tenantFromDb(databases[ix]));
+
+    pthread_rwlock_rdlock(&regCacheLock);
+    for (RegCacheTenant* tenantP = regCacheTenantList; tenantP != NULL; tenantP = tenantP->next)
+    {
+      if (std::find(tenants.begin(), tenants.end(), tenantP->tenant) == tenants.end())
+        tenants.push_back(tenantP->tenant);
+    }
+    pthread_rwlock_unlock(&regCacheLock);
+  }
+
+  for (unsigned int ix = 0; ix < tenants.size(); ++ix)
+  {
+    LM_T(LmtCacheSync, ("Refreshing the registration cache of tenant '%s'", tenants[ix].c_str()));
+    dbRegCacheTenantRefresh(tenants[ix].c_str());
+  }
+}
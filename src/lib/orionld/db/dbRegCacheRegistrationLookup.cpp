@@ -0,0 +1,196 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                             // pthread_rwlock_rdlock, pthread_rwlock_unlock
+#include <string.h>                                              // strcmp
+#include <regex.h>                                               // regexec
+
+extern "C"
+{
+#include "kalloc/kaStrdup.h"                                     // kaStrdup
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjChildAdd
+#include "kjson/kjParse.h"                                       // kjParse
+#include "khash/khash.h"                                         // khashItemLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, multitenancy
+#include "orionld/db/dbRegCache.h"                               // RegCacheTenant, RegCacheEntity, regCacheTenantList, regCacheLock
+#include "orionld/db/dbRegCacheTenantRefresh.h"                  // dbRegCacheTenantRefresh
+#include "orionld/db/dbRegCacheRegistrationLookup.h"             // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// REG_CACHE_MAX_MATCHES - max number of registrations returned by one lookup
+//
+#define REG_CACHE_MAX_MATCHES  100
+
+
+
+// -----------------------------------------------------------------------------
+//
+// tenantLookup - find a tenant in the registration cache - the lock must be held
+//
+static RegCacheTenant* tenantLookup(const char* tenant)
+{
+  for (RegCacheTenant* tenantP = regCacheTenantList; tenantP != NULL; tenantP = tenantP->next)
+  {
+    if (strcmp(tenantP->tenant, tenant) == 0)
+      return tenantP;
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// attributeMatch -
+//
+static bool attributeMatch(RegCacheEntity* rceP, const char* attribute)
+{
+  if ((attribute == NULL) || (rceP->attrV == NULL))
+    return true;
+
+  for (int ix = 0; ix < rceP->attrs; ix++)
+  {
+    if (strcmp(rceP->attrV[ix], attribute) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// registrationAdd - parse a matching registration into the allocator of the request and add it to the output array
+//
+// A registration may match via more than one of its entities, but it is only added once.
+//
+static KjNode* registrationAdd(KjNode* regArray, RegCacheRegistration* regP, RegCacheRegistration** addedV, int* addedP)
+{
+  for (int ix = 0; ix < *addedP; ix++)
+  {
+    if (addedV[ix] == regP)
+      return regArray;
+  }
+
+  if (*addedP >= REG_CACHE_MAX_MATCHES)
+  {
+    LM_W(("More than %d matching registrations - the rest are ignored", REG_CACHE_MAX_MATCHES));
+    return regArray;
+  }
+
+  KjNode* regTree = kjParse(orionldState.kjsonP, kaStrdup(&orionldState.kalloc, regP->json));
+
+  if (regTree == NULL)
+  {
+    LM_E(("Internal Error (unable to parse cached registration '%s')", regP->regId));
+    return regArray;
+  }
+
+  if (regArray == NULL)
+    regArray = kjArray(orionldState.kjsonP, NULL);
+
+  kjChildAdd(regArray, regTree);
+  addedV[*addedP] = regP;
+  *addedP += 1;
+
+  return regArray;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbRegCacheRegistrationLookup - find the registrations that match an entity id (and attribute) in the registration cache
+//
+// Replaces the database query of dbRegistrationLookup (mongoCppLegacyRegistrationLookup) and has the same contract:
+//   - the matching registrations are returned as a KjNode array, in the format of the database
+//   - NULL is returned if no registration matches
+//   - if attribute is non-NULL, a registration only matches if the contextRegistration that matches the entity
+//     has no attributes (all attributes registered) or has 'attribute' among its attributes
+//   - *noOfRegsP is set just like mongoCppLegacyRegistrationLookup does (1 if attribute is non-NULL, else 0)
+//
+// Unlike the database query, registrations with an idPattern also match.
+// A tenant that isn't in the cache yet is loaded from the database on its first lookup.
+//
+// The cached registrations are parsed into orionldState.kalloc while the read lock is held, so that the
+// returned tree isn't affected by a refresh of the cache.
+//
+KjNode* dbRegCacheRegistrationLookup(const char* entityId, const char* attribute, int* noOfRegsP)
+{
+  const char*            tenant   = ((multitenancy == true) && (orionldState.tenant != NULL))? orionldState.tenant : "";
+  KjNode*                regArray = NULL;
+  RegCacheRegistration*  addedV[REG_CACHE_MAX_MATCHES];
+  int                    added    = 0;
+  RegCacheTenant*        tenantP;
+
+  if (noOfRegsP != NULL)
+    *noOfRegsP = (attribute != NULL)? 1 : 0;
+
+  pthread_rwlock_rdlock(&regCacheLock);
+
+  if ((tenantP = tenantLookup(tenant)) == NULL)
+  {
+    //
+    // First time this tenant is seen (e.g. its database was created after the cache was populated).
+    // The tenant is loaded into the cache, so that the database is queried only once per tenant.
+    //
+    pthread_rwlock_unlock(&regCacheLock);
+
+    if (dbRegCacheTenantRefresh(tenant) == false)
+      return NULL;
+
+    pthread_rwlock_rdlock(&regCacheLock);
+    tenantP = tenantLookup(tenant);
+  }
+
+  if (tenantP != NULL)
+  {
+    for (RegCacheEntity* rceP = (RegCacheEntity*) khashItemLookup(tenantP->idTable, entityId); rceP != NULL; rceP = rceP->sameIdNext)
+    {
+      if (attributeMatch(rceP, attribute) == true)
+        regArray = registrationAdd(regArray, rceP->regP, addedV, &added);
+    }
+
+    for (RegCacheEntity* rceP = tenantP->patternList; rceP != NULL; rceP = rceP->next)
+    {
+      if ((regexec(&rceP->regex, entityId, 0, NULL, 0) == 0) && (attributeMatch(rceP, attribute) == true))
+        regArray = registrationAdd(regArray, rceP->regP, addedV, &added);
+    }
+  }
+
+  pthread_rwlock_unlock(&regCacheLock);
+
+  return regArray;
+}
@@ -0,0 +1,101 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                             // pthread_create, pthread_detach
+#include <unistd.h>                                              // sleep
+
+extern "C"
+{
+#include "kalloc/kaBufferReset.h"                                // kaBufferReset
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, orionldStateInit
+#include "orionld/db/dbConfiguration.h"                          // DB_DRIVER_MONGOC
+#ifdef DB_DRIVER_MONGOC
+#include "orionld/mongoc/mongocConnectionRelease.h"              // mongocConnectionRelease
+#endif
+#include "orionld/db/dbRegCacheRefresh.h"                        // dbRegCacheRefresh
+#include "orionld/db/dbRegCacheStart.h"                          // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// regCacheRefresherThread -
+//
+// The registration cache follows the refresh interval of the subscription cache (-subCacheIval).
+// Registrations created/modified/deleted via this broker are refreshed immediately, the periodic
+// refresh is for changes made via other brokers that share the database.
+//
+static void* regCacheRefresherThread(void* vP)
+{
+  extern int subCacheInterval;
+
+  while (1)
+  {
+    sleep(subCacheInterval);
+
+    orionldStateInit();
+    dbRegCacheRefresh();
+#ifdef DB_DRIVER_MONGOC
+    mongocConnectionRelease();  // orionldStateInit would lose the client otherwise
+#endif
+    kaBufferReset(&orionldState.kalloc, false);
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbRegCacheStart - populate the registration cache and start the thread that refreshes it
+//
+void dbRegCacheStart(void)
+{
+  extern int  subCacheInterval;
+  pthread_t   tid;
+  int         ret;
+
+  dbRegCacheRefresh();
+#ifdef DB_DRIVER_MONGOC
+  mongocConnectionRelease();
+#endif
+
+  if (subCacheInterval <= 0)
+    return;
+
+  ret = pthread_create(&tid, NULL, regCacheRefresherThread, NULL);
+
+  if (ret != 0)
+  {
+    LM_E(("Runtime Error (error creating thread: %d)", ret));
+    return;
+  }
+  pthread_detach(tid);
+}
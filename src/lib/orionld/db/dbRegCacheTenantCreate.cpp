@@ -0,0 +1,214 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // calloc
+#include <string.h>                                              // strcmp
+#include <regex.h>                                               // regcomp
+
+extern "C"
+{
+#include "kalloc/kaBufferInit.h"                                 // kaBufferInit
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+#include "kalloc/kaStrdup.h"                                     // kaStrdup
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjLookup.h"                                      // kjLookup
+#include "kjson/kjRender.h"                                      // kjRender
+#include "khash/khash.h"                                         // khashTableCreate, khashItemAdd, khashItemLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/stringHash.h"                           // stringHash
+#include "orionld/kjTree/kjTreeRenderSize.h"                     // kjTreeRenderSize
+#include "orionld/db/dbRegCache.h"                               // RegCacheTenant, RegCacheEntity, RegCacheRegistration
+#include "orionld/db/dbRegCacheTenantCreate.h"                   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// entityIdCompare -
+//
+static int entityIdCompare(const char* entityId, void* itemP)
+{
+  RegCacheEntity* rceP = (RegCacheEntity*) itemP;
+
+  return strcmp(entityId, rceP->id);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// attrVecCreate - extract the attribute names of a contextRegistration
+//
+// An empty (or missing) attrs array means that all attributes are registered, and that is
+// flagged by returning NULL.
+//
+static char** attrVecCreate(KAlloc* kaP, KjNode* attrArrayP, int* attrsP)
+{
+  int     attrs = 0;
+  char**  attrV;
+  int     ix    = 0;
+
+  *attrsP = 0;
+
+  if ((attrArrayP == NULL) || (attrArrayP->type != KjArray))
+    return NULL;
+
+  for (KjNode* attrP = attrArrayP->value.firstChildP; attrP != NULL; attrP = attrP->next)
+    ++attrs;
+
+  if (attrs == 0)
+    return NULL;
+
+  attrV = (char**) kaAlloc(kaP, sizeof(char*) * attrs);
+
+  for (KjNode* attrP = attrArrayP->value.firstChildP; attrP != NULL; attrP = attrP->next)
+  {
+    KjNode* nameP = kjLookup(attrP, "name");
+
+    if ((nameP != NULL) && (nameP->type == KjString))
+      attrV[ix++] = kaStrdup(kaP, nameP->value.s);
+  }
+
+  *attrsP = ix;
+
+  return attrV;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// entityAdd - add an entity of a contextRegistration to the id hash table or to the pattern list
+//
+static void entityAdd(RegCacheTenant* tenantP, RegCacheRegistration* regP, KjNode* entityP, char** attrV, int attrs)
+{
+  KjNode*          idP        = kjLookup(entityP, "id");
+  KjNode*          isPatternP = kjLookup(entityP, "isPattern");
+  RegCacheEntity*  rceP;
+
+  if ((idP == NULL) || (idP->type != KjString))
+    return;
+
+  rceP = (RegCacheEntity*) kaAlloc(&tenantP->kalloc, sizeof(RegCacheEntity));
+
+  rceP->regP       = regP;
+  rceP->id         = kaStrdup(&tenantP->kalloc, idP->value.s);
+  rceP->isPattern  = (isPatternP != NULL) && (isPatternP->type == KjString) && (strcmp(isPatternP->value.s, "true") == 0);
+  rceP->attrV      = attrV;
+  rceP->attrs      = attrs;
+  rceP->sameIdNext = NULL;
+  rceP->next       = NULL;
+
+  if (rceP->isPattern == true)
+  {
+    if (regcomp(&rceP->regex, rceP->id, REG_EXTENDED | REG_NOSUB) != 0)
+    {
+      LM_W(("Bad Input (invalid idPattern '%s' in registration '%s' - skipped)", rceP->id, regP->regId));
+      return;
+    }
+
+    rceP->next           = tenantP->patternList;
+    tenantP->patternList = rceP;
+    return;
+  }
+
+  RegCacheEntity* firstP = (RegCacheEntity*) khashItemLookup(tenantP->idTable, rceP->id);
+
+  if (firstP == NULL)
+    khashItemAdd(tenantP->idTable, rceP->id, rceP);
+  else
+  {
+    rceP->sameIdNext   = firstP->sameIdNext;
+    firstP->sameIdNext = rceP;
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbRegCacheTenantCreate - create a cache entry for a tenant out of its registrations, as found in the database
+//
+// Each registration is rendered to JSON text inside the allocator of the tenant and its entities are indexed:
+//   - entities with an 'id' go into a hash table, keyed by the entity id
+//   - entities with an 'idPattern' go into a list, with their regular expression already compiled
+//
+// The registration array is typically allocated in orionldState.kalloc and isn't referenced after this call.
+//
+RegCacheTenant* dbRegCacheTenantCreate(const char* tenant, KjNode* regArray)
+{
+  RegCacheTenant* tenantP = (RegCacheTenant*) calloc(1, sizeof(RegCacheTenant));
+
+  if (tenantP == NULL)
+  {
+    LM_E(("Out of memory (allocating registration cache for tenant '%s')", tenant));
+    return NULL;
+  }
+
+  kaBufferInit(&tenantP->kalloc, tenantP->kallocBuffer, sizeof(tenantP->kallocBuffer), 16 * 1024, NULL, "Registration Cache KAlloc buffer");
+
+  tenantP->tenant  = kaStrdup(&tenantP->kalloc, tenant);
+  tenantP->idTable = khashTableCreate(&tenantP->kalloc, stringHash, entityIdCompare, REG_CACHE_ID_TABLE_SIZE);
+
+  for (KjNode* dbRegP = regArray->value.firstChildP; dbRegP != NULL; dbRegP = dbRegP->next)
+  {
+    KjNode*               idP  = kjLookup(dbRegP, "_id");
+    KjNode*               crP  = kjLookup(dbRegP, "contextRegistration");
+    RegCacheRegistration* regP = (RegCacheRegistration*) kaAlloc(&tenantP->kalloc, sizeof(RegCacheRegistration));
+    int                   size = kjTreeRenderSize(orionldState.kjsonP, dbRegP);
+
+    regP->regId = ((idP != NULL) && (idP->type == KjString))? kaStrdup(&tenantP->kalloc, idP->value.s) : (char*) "";
+    regP->json  = (char*) kaAlloc(&tenantP->kalloc, size);
+    kjRender(orionldState.kjsonP, dbRegP, regP->json, size);
+
+    regP->next       = tenantP->regList;
+    tenantP->regList = regP;
+    ++tenantP->registrations;
+
+    if ((crP == NULL) || (crP->type != KjArray))
+      continue;
+
+    for (KjNode* crItemP = crP->value.firstChildP; crItemP != NULL; crItemP = crItemP->next)
+    {
+      KjNode*  entitiesP = kjLookup(crItemP, "entities");
+      int      attrs;
+      char**   attrV     = attrVecCreate(&tenantP->kalloc, kjLookup(crItemP, "attrs"), &attrs);
+
+      if ((entitiesP == NULL) || (entitiesP->type != KjArray))
+        continue;
+
+      for (KjNode* entityP = entitiesP->value.firstChildP; entityP != NULL; entityP = entityP->next)
+        entityAdd(tenantP, regP, entityP, attrV, attrs);
+    }
+  }
+
+  LM_T(LmtCacheSync, ("Registration cache for tenant '%s': %d registrations", tenantP->tenant, tenantP->registrations));
+
+  return tenantP;
+}
@@ -0,0 +1,118 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                             // pthread_rwlock_wrlock, pthread_rwlock_unlock
+#include <string.h>                                              // strcmp
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, multitenancy
+#include "orionld/db/dbConfiguration.h"                          // dbRegistrationListGet
+#include "orionld/db/dbRegCache.h"                               // RegCacheTenant, regCacheTenantList, regCacheLock
+#include "orionld/db/dbRegCacheTenantCreate.h"                   // dbRegCacheTenantCreate
+#include "orionld/db/dbRegCacheTenantFree.h"                     // dbRegCacheTenantFree
+#include "orionld/db/dbRegCacheTenantRefresh.h"                  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbRegCacheTenantRefresh - reload the registrations of a tenant from the database into the registration cache
+//
+// The new version of the tenant is built without holding the lock, so lookups are only blocked while the
+// pointers are swapped. The old version is freed after the lock has been released, as no lookup references
+// it any longer - lookups parse their own copy of the registrations while holding the read lock.
+//
+// The registrations are queried from the database of orionldState.tenant, so it is temporarily set to 'tenant'.
+// Without multitenancy, all requests use the default database, and the tenant is cached as "".
+//
+bool dbRegCacheTenantRefresh(const char* tenant)
+{
+  char*            savedTenant = orionldState.tenant;
+  KjNode*          regArray;
+  RegCacheTenant*  newP;
+  RegCacheTenant*  oldP        = NULL;
+
+  if (dbRegistrationListGet == NULL)
+    return false;
+
+  if ((multitenancy == false) || (tenant == NULL))
+    tenant = "";
+
+  orionldState.tenant = (char*) tenant;
+  regArray            = dbRegistrationListGet();
+  orionldState.tenant = savedTenant;
+
+  if (regArray == NULL)
+  {
+    LM_E(("Database Error (unable to refresh the registration cache of tenant '%s')", tenant));
+    return false;
+  }
+
+  if ((newP = dbRegCacheTenantCreate(tenant, regArray)) == NULL)
+    return false;
+
+  pthread_rwlock_wrlock(&regCacheLock);
+
+  RegCacheTenant* prevP = NULL;
+
+  for (RegCacheTenant* tenantP = regCacheTenantList; tenantP != NULL; tenantP = tenantP->next)
+  {
+    if (strcmp(tenantP->tenant, tenant) == 0)
+    {
+      oldP = tenantP;
+      break;
+    }
+
+    prevP = tenantP;
+  }
+
+  if (oldP == NULL)
+  {
+    newP->next         = regCacheTenantList;
+    regCacheTenantList = newP;
+  }
+  else
+  {
+    newP->next = oldP->next;
+
+    if (prevP == NULL)
+      regCacheTenantList = newP;
+    else
+      prevP->next = newP;
+  }
+
+  pthread_rwlock_unlock(&regCacheLock);
+
+  if (oldP != NULL)
+    dbRegCacheTenantFree(oldP);
+
+  return true;
+}
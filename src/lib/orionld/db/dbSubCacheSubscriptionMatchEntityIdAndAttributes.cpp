@@ -0,0 +1,197 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>                                                // std::string
+#include <vector>                                                // std::vector
+
+extern "C"
+{
+#include "kalloc/kaStrdup.h"                                     // kaStrdup
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjObject, kjArray, kjString, kjInteger, kjChildAdd
+#include "kjson/kjLookup.h"                                      // kjLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/sem.h"                                          // cacheSemTake, cacheSemGive
+#include "common/MimeType.h"                                     // mimeTypeToLongString
+#include "cache/subCache.h"                                      // CachedSubscription, subCacheMatch
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/qCompiledMatch.h"                       // qCompiledMatch
+#include "orionld/db/dbConfiguration.h"                          // DbSubscriptionMatchCallback
+#include "orionld/db/dbSubCacheSubscriptionMatchEntityIdAndAttributes.h"   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// subscriptionTreeFromCache -
+//
+// Creates a KjNode tree with the fields of the cached subscription that the match callback needs.
+// The tree, and all its strings, are allocated in the request's allocator, so they stay valid after the
+// cache semaphore has been released (a subCacheRefresh may free the cached subscription) and until the
+// notifications of the request have been sent.
+//
+static KjNode* subscriptionTreeFromCache(CachedSubscription* cSubP)
+{
+  KjNode*      treeP      = kjObject(orionldState.kjsonP, NULL);
+  const char*  mimeType   = mimeTypeToLongString(cSubP->httpInfo.mimeType);
+  KjNode*      nodeP;
+
+  nodeP = kjString(orionldState.kjsonP, "_id", kaStrdup(&orionldState.kalloc, cSubP->subscriptionId));
+  kjChildAdd(treeP, nodeP);
+
+  nodeP = kjString(orionldState.kjsonP, "reference", kaStrdup(&orionldState.kalloc, cSubP->httpInfo.url.c_str()));
+  kjChildAdd(treeP, nodeP);
+
+  nodeP = kjString(orionldState.kjsonP, "mimeType", (char*) mimeType);
+  kjChildAdd(treeP, nodeP);
+
+  KjNode* attrsP = kjArray(orionldState.kjsonP, "attrs");
+  for (unsigned int ix = 0; ix < cSubP->attributes.size(); ++ix)
+  {
+    nodeP = kjString(orionldState.kjsonP, NULL, kaStrdup(&orionldState.kalloc, cSubP->attributes[ix].c_str()));
+    kjChildAdd(attrsP, nodeP);
+  }
+  kjChildAdd(treeP, attrsP);
+
+  if (cSubP->expirationTime > 0)
+  {
+    nodeP = kjInteger(orionldState.kjsonP, "expiration", cSubP->expirationTime);
+    kjChildAdd(treeP, nodeP);
+  }
+
+  if (cSubP->throttling > 0)
+  {
+    nodeP = kjInteger(orionldState.kjsonP, "throttling", cSubP->throttling);
+    kjChildAdd(treeP, nodeP);
+  }
+
+  //
+  // Same names as in the database - the match callback doesn't know where the tree comes from
+  //
+  if (cSubP->httpInfo.batchMaxEntities > 0)
+  {
+    nodeP = kjInteger(orionldState.kjsonP, "batchMaxEntities", cSubP->httpInfo.batchMaxEntities);
+    kjChildAdd(treeP, nodeP);
+
+    nodeP = kjInteger(orionldState.kjsonP, "batchMaxDelay", cSubP->httpInfo.batchMaxDelay);
+    kjChildAdd(treeP, nodeP);
+  }
+
+  return treeP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbSubCacheSubscriptionMatchEntityIdAndAttributes -
+//
+// Same as mongoCppLegacySubscriptionMatchEntityIdAndAttributes, but the matching subscriptions are taken
+// from the subscription cache (indexed on tenant, service path, entity and attribute), instead of querying
+// the database for each and every update.
+//
+// The cache is kept up to date by POST/PATCH/DELETE /ngsi-ld/v1/subscriptions and resynced with the database
+// by subCacheRefresh.
+//
+// The 'q' of a subscription is evaluated in-memory, against the entity and the incoming attributes, using the
+// compiled 'q' of the cached subscription (compiled as the subscription is inserted in the cache, and on PATCH -
+// see subCacheItemQCompile).
+//
+// PARAMETERS
+//   * entityId             The ID of the entity as a string
+//   * currentEntityTree    The entire Entity as it is in the database before being updated
+//   * incomingRequestTree  The incoming request, supposed to modify the current Entity
+//   * subMatchCallback     The callback function to be called for each matching subscription
+//
+void dbSubCacheSubscriptionMatchEntityIdAndAttributes
+(
+  const char*                 entityId,
+  KjNode*                     currentEntityTree,
+  KjNode*                     incomingRequestTree,
+  DbSubscriptionMatchCallback subMatchCallback
+)
+{
+  const char*  entityType  = "";
+  const char*  servicePath = "/";
+  KjNode*      idNodeP     = (currentEntityTree != NULL)? kjLookup(currentEntityTree, "_id") : NULL;
+
+  if ((idNodeP != NULL) && (idNodeP->type == KjObject))
+  {
+    KjNode* typeP = kjLookup(idNodeP, "type");
+    KjNode* spP   = kjLookup(idNodeP, "servicePath");
+
+    if ((typeP != NULL) && (typeP->type == KjString))
+      entityType = typeP->value.s;
+    if ((spP != NULL) && (spP->type == KjString) && (spP->value.s[0] != 0))
+      servicePath = spP->value.s;
+  }
+
+  std::vector<std::string>  attrV;
+
+  for (KjNode* attrNodeP = incomingRequestTree->value.firstChildP; attrNodeP != NULL; attrNodeP = attrNodeP->next)
+  {
+    attrV.push_back(attrNodeP->name);
+  }
+
+
+  //
+  // Collect the matching subscriptions while holding the cache semaphore.
+  // The callbacks are invoked after the semaphore has been released.
+  //
+  std::vector<CachedSubscription*>  subV;
+  std::vector<KjNode*>              subTreeV;
+
+  cacheSemTake(__FUNCTION__, "Match NGSI-LD subscriptions");
+
+  subCacheMatch(orionldState.tenant, servicePath, entityId, entityType, attrV, &subV);
+
+  for (unsigned int ix = 0; ix < subV.size(); ++ix)
+  {
+    CachedSubscription* cSubP = subV[ix];
+
+    if (cSubP->status != "active")
+      continue;
+
+    if ((cSubP->qCompiledP != NULL) && (qCompiledMatch(cSubP->qCompiledP, currentEntityTree, incomingRequestTree) == false))
+    {
+      LM_T(LmtSubCache, ("q of subscription '%s' doesn't match entity '%s'", cSubP->subscriptionId, entityId));
+      continue;
+    }
+
+    subTreeV.push_back(subscriptionTreeFromCache(cSubP));
+  }
+
+  cacheSemGive(__FUNCTION__, "Match NGSI-LD subscriptions");
+
+  LM_T(LmtSubCache, ("%d matching subscriptions for entity '%s'", (int) subTreeV.size(), entityId));
+
+  for (unsigned int ix = 0; ix < subTreeV.size(); ++ix)
+  {
+    subMatchCallback(entityId, subTreeV[ix], currentEntityTree, incomingRequestTree);
+  }
+}
@@ -0,0 +1,59 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/geo/geoBoundingBox.h"                        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoBoundingBox -
+//
+void geoBoundingBox(OrionldGeometry* geoP)
+{
+  if (geoP->pointV.size() == 0)
+  {
+    geoP->bbox.minLon = 0;
+    geoP->bbox.minLat = 0;
+    geoP->bbox.maxLon = 0;
+    geoP->bbox.maxLat = 0;
+    return;
+  }
+
+  geoP->bbox.minLon = geoP->pointV[0].lon;
+  geoP->bbox.maxLon = geoP->pointV[0].lon;
+  geoP->bbox.minLat = geoP->pointV[0].lat;
+  geoP->bbox.maxLat = geoP->pointV[0].lat;
+
+  for (unsigned int ix = 1; ix < geoP->pointV.size(); ix++)
+  {
+    const OrionldGeoPoint* pP = &geoP->pointV[ix];
+
+    if (pP->lon < geoP->bbox.minLon)  geoP->bbox.minLon = pP->lon;
+    if (pP->lon > geoP->bbox.maxLon)  geoP->bbox.maxLon = pP->lon;
+    if (pP->lat < geoP->bbox.minLat)  geoP->bbox.minLat = pP->lat;
+    if (pP->lat > geoP->bbox.maxLat)  geoP->bbox.maxLat = pP->lat;
+  }
+}
@@ -0,0 +1,206 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // strtod
+#include <string>                                              // std::string
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/geo/geoTypeDepth.h"                          // geoTypeDepth
+#include "orionld/geo/geoBoundingBox.h"                        // geoBoundingBox
+#include "orionld/geo/geoCoordinatesParse.h"                   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// SKIP_WS -
+//
+#define SKIP_WS(s) while ((*s == ' ') || (*s == '\t') || (*s == '\n')) ++s
+
+
+
+// -----------------------------------------------------------------------------
+//
+// arrayParse - parse a JSON array of 'level' (1: a position, 2: a list of positions, ...)
+//
+// *sP points to the '[' of the array and is left pointing to the character after its ']'
+//
+static bool arrayParse(const char** sP, int level, OrionldGeometry* geoP, char** detailP)
+{
+  const char* s = *sP + 1;
+
+  SKIP_WS(s);
+
+  if (level == 1)
+  {
+    double  v[2]  = { 0, 0 };
+    int     items = 0;
+
+    while (true)
+    {
+      char*  end;
+      double d = strtod(s, &end);
+
+      if (end == s)
+      {
+        *detailP = (char*) "invalid number in position";
+        return false;
+      }
+
+      if (items < 2)
+        v[items] = d;
+      ++items;
+
+      s = end;
+      SKIP_WS(s);
+
+      if (*s == ']')
+        break;
+      if (*s != ',')
+      {
+        *detailP = (char*) "invalid character in position";
+        return false;
+      }
+
+      ++s;
+      SKIP_WS(s);
+    }
+
+    if (items < 2)
+    {
+      *detailP = (char*) "a position must have at least two numbers";
+      return false;
+    }
+
+    OrionldGeoPoint point = { v[0], v[1] };
+    geoP->pointV.push_back(point);
+  }
+  else
+  {
+    if (level == 3)
+      geoP->polygonV.push_back(geoP->partV.size());
+    else if (level == 2)
+      geoP->partV.push_back(geoP->pointV.size());
+
+    while (true)
+    {
+      if (*s != '[')
+      {
+        *detailP = (char*) "array expected in coordinates";
+        return false;
+      }
+
+      if (arrayParse(&s, level - 1, geoP, detailP) == false)
+        return false;
+
+      SKIP_WS(s);
+
+      if (*s == ']')
+        break;
+      if (*s != ',')
+      {
+        *detailP = (char*) "invalid character in coordinates";
+        return false;
+      }
+
+      ++s;
+      SKIP_WS(s);
+    }
+  }
+
+  *sP = s + 1;  // Skipping the ']'
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoCoordinatesParse -
+//
+// Parses the GeoJSON coordinates in the string 'coords' into geoP, whose 'type' must be set already.
+// The outer brackets of the coordinates are optional (subscriptions store the coordinates without them).
+//
+bool geoCoordinatesParse(const char* coords, OrionldGeometry* geoP, char** detailP)
+{
+  int          depth   = geoTypeDepth(geoP->type);
+  int          opening = 0;
+  std::string  wrapped;
+  const char*  s;
+
+  if (depth == 0)
+  {
+    *detailP = (char*) "invalid geometry";
+    return false;
+  }
+
+  s = coords;
+  SKIP_WS(s);
+
+  for (const char* cP = s; *cP != 0; ++cP)
+  {
+    if (*cP == '[')
+      ++opening;
+    else if ((*cP != ' ') && (*cP != '\t') && (*cP != '\n'))
+      break;
+  }
+
+  if (opening == depth - 1)
+  {
+    wrapped = std::string("[") + s + "]";
+    s       = wrapped.c_str();
+  }
+  else if (opening != depth)
+  {
+    *detailP = (char*) "coordinates don't match the geometry";
+    return false;
+  }
+
+  geoP->pointV.clear();
+  geoP->partV.clear();
+  geoP->polygonV.clear();
+
+  if (arrayParse(&s, depth, geoP, detailP) == false)
+  {
+    LM_W(("Bad Input (invalid coordinates '%s': %s)", coords, *detailP));
+    return false;
+  }
+
+  SKIP_WS(s);
+  if (*s != 0)
+  {
+    *detailP = (char*) "garbage after coordinates";
+    return false;
+  }
+
+  if (geoP->partV.size() == 0)  // Point
+    geoP->partV.push_back(0);
+
+  geoBoundingBox(geoP);
+
+  return true;
+}
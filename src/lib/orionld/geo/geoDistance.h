@@ -0,0 +1,46 @@
+#ifndef SRC_LIB_ORIONLD_GEO_GEODISTANCE_H_
+#define SRC_LIB_ORIONLD_GEO_GEODISTANCE_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+
+
+
+// -----------------------------------------------------------------------------
+//
+// EARTH_RADIUS - mean radius of the Earth, in meters
+//
+#define EARTH_RADIUS  6371008.8
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoDistance - great-circle distance in meters between two points (haversine)
+//
+extern double geoDistance(const OrionldGeoPoint* p1P, const OrionldGeoPoint* p2P);
+
+#endif  // SRC_LIB_ORIONLD_GEO_GEODISTANCE_H_
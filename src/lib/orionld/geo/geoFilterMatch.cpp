@@ -0,0 +1,166 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <math.h>                                              // sin, cos, asin, fabs, M_PI
+
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/types/OrionldGeoFilter.h"                    // OrionldGeoFilter
+#include "orionld/geo/geoBoxOverlap.h"                         // geoBoxOverlap
+#include "orionld/geo/geoDistance.h"                           // EARTH_RADIUS
+#include "orionld/geo/geoMinDistance.h"                        // geoMinDistance
+#include "orionld/geo/geoIntersects.h"                         // geoIntersects
+#include "orionld/geo/geoWithin.h"                             // geoWithin
+#include "orionld/geo/geoFilterMatch.h"                        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// nearBoxOverlap - may the bounding box 'bboxP' have points at 'maxDistance' meters or less from 'pointP'?
+//
+// The circle of radius maxDistance around the point is a spherical cap, and it is surrounded by a box
+// of latitudes lat +/- radius and longitudes lon +/- asin(sin(radius) / cos(lat)) - the widest point of the cap
+// is not at the latitude of its center. If the cap contains a pole, it spans all longitudes.
+//
+// The longitudes of the box may go beyond +/-180 degrees, as the cap crosses the antimeridian. The coordinates
+// of the geometry are always in [-180, 180], so the box is then also checked shifted 360 degrees the other way.
+//
+static bool nearBoxOverlap(const OrionldGeoPoint* pointP, double maxDistance, const OrionldGeoBox* bboxP)
+{
+  OrionldGeoBox  box;
+  double         radius = maxDistance / EARTH_RADIUS;  // radians
+  double         cosLat = cos(pointP->lat * M_PI / 180);
+
+  if (radius >= M_PI / 2)  // Half the Earth or more - no use for a box
+    return true;
+
+  box.minLat = pointP->lat - radius * 180 / M_PI;
+  box.maxLat = pointP->lat + radius * 180 / M_PI;
+
+  if (sin(radius) >= cosLat)  // The cap contains a pole
+  {
+    box.minLon = -180;
+    box.maxLon = 180;
+
+    return geoBoxOverlap(&box, bboxP);
+  }
+
+  double lonDelta = asin(sin(radius) / cosLat) * 180 / M_PI;
+
+  box.minLon = pointP->lon - lonDelta;
+  box.maxLon = pointP->lon + lonDelta;
+
+  if (geoBoxOverlap(&box, bboxP) == true)
+    return true;
+
+  if (box.minLon < -180)
+  {
+    box.minLon += 360;
+    box.maxLon += 360;
+  }
+  else if (box.maxLon > 180)
+  {
+    box.minLon -= 360;
+    box.maxLon -= 360;
+  }
+  else
+    return false;
+
+  return geoBoxOverlap(&box, bboxP);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// nearMatch -
+//
+// Before calculating the distance, the bounding box of the geometry is checked against the box
+// that surrounds the circle of radius maxDistance around the reference point.
+//
+static bool nearMatch(const OrionldGeoFilter* filterP, const OrionldGeometry* geoP)
+{
+  const OrionldGeoPoint*  pointP = &filterP->geometry.pointV[0];
+  double                  distance;
+
+  if ((filterP->maxDistance >= 0) && (nearBoxOverlap(pointP, filterP->maxDistance, &geoP->bbox) == false))
+    return false;
+
+  distance = geoMinDistance(pointP, geoP);
+  if (distance < 0)  // Empty geometry
+    return false;
+
+  if ((filterP->maxDistance >= 0) && (distance > filterP->maxDistance))
+    return false;
+
+  if ((filterP->minDistance >= 0) && (distance < filterP->minDistance))
+    return false;
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// equals -
+//
+static bool equals(const OrionldGeometry* aP, const OrionldGeometry* bP)
+{
+  if ((aP->type != bP->type) || (aP->pointV.size() != bP->pointV.size()) || (aP->partV != bP->partV) || (aP->polygonV != bP->polygonV))
+    return false;
+
+  for (unsigned int ix = 0; ix < aP->pointV.size(); ix++)
+  {
+    if ((fabs(aP->pointV[ix].lon - bP->pointV[ix].lon) > 1e-9) || (fabs(aP->pointV[ix].lat - bP->pointV[ix].lat) > 1e-9))
+      return false;
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoFilterMatch - does the geometry of an entity match the geo-filter of a subscription?
+//
+bool geoFilterMatch(const OrionldGeoFilter* filterP, const OrionldGeometry* geoP)
+{
+  const OrionldGeometry* filterGeoP = &filterP->geometry;
+
+  switch (filterP->georel)
+  {
+  case GeoRelNear:        return nearMatch(filterP, geoP);
+  case GeoRelWithin:      return geoWithin(geoP, filterGeoP);
+  case GeoRelContains:    return geoWithin(filterGeoP, geoP);
+  case GeoRelIntersects:  return geoIntersects(geoP, filterGeoP);
+  case GeoRelDisjoint:    return !geoIntersects(geoP, filterGeoP);
+  case GeoRelEquals:      return equals(geoP, filterGeoP);
+  case GeoRelOverlaps:    return geoIntersects(geoP, filterGeoP) && !geoWithin(geoP, filterGeoP) && !geoWithin(filterGeoP, geoP);
+  case GeoRelNone:        break;
+  }
+
+  return false;
+}
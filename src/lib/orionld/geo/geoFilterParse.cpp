@@ -0,0 +1,286 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // strtod
+#include <string>                                              // std::string
+#include <vector>                                              // std::vector
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/types/OrionldGeoFilter.h"                    // OrionldGeoFilter
+#include "orionld/payloadCheck/pcheckGeoType.h"                // pcheckGeoType
+#include "orionld/geo/geoBoundingBox.h"                        // geoBoundingBox
+#include "orionld/geo/geoCoordinatesParse.h"                   // geoCoordinatesParse
+#include "orionld/geo/geoFilterParse.h"                        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// v2CoordinatesParse - parse APIv2 coordinates ("lat,lon;lat,lon;...") for the geometries point, line, polygon and box
+//
+static bool v2CoordinatesParse(const std::string& geometry, const std::string& coords, OrionldGeometry* geoP, char** detailP)
+{
+  std::vector<OrionldGeoPoint>  pointV;
+  const char*                   s = coords.c_str();
+
+  while (*s != 0)
+  {
+    OrionldGeoPoint  point;
+    char*            end;
+
+    point.lat = strtod(s, &end);
+    if ((end == s) || (*end != ','))
+    {
+      *detailP = (char*) "invalid coordinates";
+      return false;
+    }
+
+    s = end + 1;
+    point.lon = strtod(s, &end);
+    if (end == s)
+    {
+      *detailP = (char*) "invalid coordinates";
+      return false;
+    }
+
+    s = end;
+    while (*s == ' ')
+      ++s;
+
+    if (*s == ';')
+      ++s;
+    else if (*s != 0)
+    {
+      *detailP = (char*) "invalid coordinates";
+      return false;
+    }
+
+    pointV.push_back(point);
+  }
+
+  geoP->pointV.clear();
+  geoP->partV.clear();
+  geoP->polygonV.clear();
+  geoP->partV.push_back(0);
+
+  if (geometry == "point")
+  {
+    if (pointV.size() != 1)
+    {
+      *detailP = (char*) "a point needs exactly one coordinate";
+      return false;
+    }
+
+    geoP->type   = GeoJsonPoint;
+    geoP->pointV = pointV;
+  }
+  else if (geometry == "line")
+  {
+    if (pointV.size() < 2)
+    {
+      *detailP = (char*) "a line needs at least two coordinates";
+      return false;
+    }
+
+    geoP->type   = GeoJsonLineString;
+    geoP->pointV = pointV;
+  }
+  else if (geometry == "polygon")
+  {
+    if (pointV.size() < 4)
+    {
+      *detailP = (char*) "a polygon needs at least four coordinates";
+      return false;
+    }
+
+    geoP->type   = GeoJsonPolygon;
+    geoP->pointV = pointV;
+    geoP->polygonV.push_back(0);
+  }
+  else  // box - turned into a polygon with a closed ring
+  {
+    if (pointV.size() != 2)
+    {
+      *detailP = (char*) "a box needs exactly two coordinates";
+      return false;
+    }
+
+    OrionldGeoPoint corner;
+    double          minLon = (pointV[0].lon < pointV[1].lon)? pointV[0].lon : pointV[1].lon;
+    double          maxLon = (pointV[0].lon < pointV[1].lon)? pointV[1].lon : pointV[0].lon;
+    double          minLat = (pointV[0].lat < pointV[1].lat)? pointV[0].lat : pointV[1].lat;
+    double          maxLat = (pointV[0].lat < pointV[1].lat)? pointV[1].lat : pointV[0].lat;
+
+    corner.lon = minLon;  corner.lat = minLat;  geoP->pointV.push_back(corner);
+    corner.lon = maxLon;  corner.lat = minLat;  geoP->pointV.push_back(corner);
+    corner.lon = maxLon;  corner.lat = maxLat;  geoP->pointV.push_back(corner);
+    corner.lon = minLon;  corner.lat = maxLat;  geoP->pointV.push_back(corner);
+    corner.lon = minLon;  corner.lat = minLat;  geoP->pointV.push_back(corner);
+
+    geoP->type = GeoJsonPolygon;
+    geoP->polygonV.push_back(0);
+  }
+
+  geoBoundingBox(geoP);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// distanceParse - parse the value of a "maxDistance==N" (NGSI-LD) or "maxDistance:N" (APIv2) modifier
+//
+static bool distanceParse(const std::string& modifier, unsigned int nameLen, double* distanceP)
+{
+  const char*  s = &modifier.c_str()[nameLen];
+  char*        end;
+
+  if ((s[0] == '=') && (s[1] == '='))
+    s += 2;
+  else if (s[0] == ':')
+    s += 1;
+  else
+    return false;
+
+  *distanceP = strtod(s, &end);
+
+  return ((end != s) && (*end == 0) && (*distanceP >= 0));
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoFilterParse -
+//
+// The geometry is either an APIv2 geometry (point, line, polygon, box) with APIv2 coordinates, or a GeoJSON
+// geometry type (NGSI-LD) with GeoJSON coordinates.
+// The georel is a relation (near, within, coveredBy, contains, intersects, disjoint, equals, overlaps), followed
+// by the distance modifiers of 'near', separated by ';'.
+//
+bool geoFilterParse(const std::string& geometry, const std::string& coords, const std::string& georel, OrionldGeoFilter* filterP, char** detailP)
+{
+  filterP->georel      = GeoRelNone;
+  filterP->minDistance = -1;
+  filterP->maxDistance = -1;
+
+  //
+  // Geometry and coordinates
+  //
+  if ((geometry == "point") || (geometry == "line") || (geometry == "polygon") || (geometry == "box"))
+  {
+    if (v2CoordinatesParse(geometry, coords, &filterP->geometry, detailP) == false)
+      return false;
+  }
+  else
+  {
+    if (pcheckGeoType((char*) geometry.c_str(), &filterP->geometry.type, detailP) == false)
+      return false;
+
+    if (geoCoordinatesParse(coords.c_str(), &filterP->geometry, detailP) == false)
+      return false;
+  }
+
+  //
+  // georel
+  //
+  std::string::size_type  start = 0;
+  bool                    first = true;
+
+  while (start <= georel.size())
+  {
+    std::string::size_type  end      = georel.find(';', start);
+    std::string             modifier = georel.substr(start, (end == std::string::npos)? std::string::npos : end - start);
+
+    if (first == true)
+    {
+      if      (modifier == "near")        filterP->georel = GeoRelNear;
+      else if (modifier == "within")      filterP->georel = GeoRelWithin;
+      else if (modifier == "coveredBy")   filterP->georel = GeoRelWithin;
+      else if (modifier == "contains")    filterP->georel = GeoRelContains;
+      else if (modifier == "intersects")  filterP->georel = GeoRelIntersects;
+      else if (modifier == "disjoint")    filterP->georel = GeoRelDisjoint;
+      else if (modifier == "equals")      filterP->georel = GeoRelEquals;
+      else if (modifier == "overlaps")    filterP->georel = GeoRelOverlaps;
+      else
+      {
+        *detailP = (char*) "invalid georel";
+        return false;
+      }
+
+      first = false;
+    }
+    else if (modifier.compare(0, 11, "maxDistance") == 0)
+    {
+      if (distanceParse(modifier, 11, &filterP->maxDistance) == false)
+      {
+        *detailP = (char*) "invalid maxDistance";
+        return false;
+      }
+    }
+    else if (modifier.compare(0, 11, "minDistance") == 0)
+    {
+      if (distanceParse(modifier, 11, &filterP->minDistance) == false)
+      {
+        *detailP = (char*) "invalid minDistance";
+        return false;
+      }
+    }
+    else
+    {
+      *detailP = (char*) "invalid georel modifier";
+      return false;
+    }
+
+    if (end == std::string::npos)
+      break;
+
+    start = end + 1;
+  }
+
+  if (filterP->georel == GeoRelNear)
+  {
+    if (filterP->geometry.type != GeoJsonPoint)
+    {
+      *detailP = (char*) "georel 'near' needs a point as geometry";
+      return false;
+    }
+
+    if ((filterP->minDistance < 0) && (filterP->maxDistance < 0))
+    {
+      *detailP = (char*) "georel 'near' needs minDistance or maxDistance";
+      return false;
+    }
+  }
+
+  LM_T(LmtGeoJson, ("Parsed geo-filter: georel %d, %d points, minDistance %f, maxDistance %f",
+                    filterP->georel, (int) filterP->geometry.pointV.size(), filterP->minDistance, filterP->maxDistance));
+
+  return true;
+}
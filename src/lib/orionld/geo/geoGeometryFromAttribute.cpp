@@ -0,0 +1,76 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                             // sscanf
+
+#include "ngsi/ContextAttribute.h"                             // ContextAttribute
+
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/geo/geoBoundingBox.h"                        // geoBoundingBox
+#include "orionld/geo/geoGeometryFromCompound.h"               // geoGeometryFromCompound
+#include "orionld/geo/geoGeometryFromAttribute.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoGeometryFromAttribute -
+//
+// Only the attribute types whose location can be evaluated in-process are recognized:
+//   - GeoProperty (NGSI-LD) and geo:json (APIv2), with a GeoJSON geometry as value
+//   - geo:point (APIv2), with a "lat, lon" string as value
+//
+// For any other attribute, false is returned.
+//
+bool geoGeometryFromAttribute(ContextAttribute* caP, OrionldGeometry* geoP)
+{
+  if ((caP->type == "GeoProperty") || (caP->type == "geo:json"))
+  {
+    if (caP->compoundValueP == NULL)
+      return false;
+
+    return geoGeometryFromCompound(caP->compoundValueP, geoP);
+  }
+  else if (caP->type == "geo:point")
+  {
+    OrionldGeoPoint point;
+
+    if (sscanf(caP->stringValue.c_str(), "%lf , %lf", &point.lat, &point.lon) != 2)
+      return false;
+
+    geoP->type = GeoJsonPoint;
+    geoP->pointV.clear();
+    geoP->partV.clear();
+    geoP->polygonV.clear();
+
+    geoP->pointV.push_back(point);
+    geoP->partV.push_back(0);
+
+    geoBoundingBox(geoP);
+
+    return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,118 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strcmp
+
+#include "orionTypes/OrionValueType.h"                         // orion::ValueType
+#include "parse/CompoundValueNode.h"                           // CompoundValueNode
+
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/payloadCheck/pcheckGeoType.h"                // pcheckGeoType
+#include "orionld/geo/geoTypeDepth.h"                          // geoTypeDepth
+#include "orionld/geo/geoBoundingBox.h"                        // geoBoundingBox
+#include "orionld/geo/geoGeometryFromCompound.h"               // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// positionsExtract - same as arrayParse in geoCoordinatesParse.cpp, for a compound value
+//
+static bool positionsExtract(orion::CompoundValueNode* nodeP, int level, OrionldGeometry* geoP)
+{
+  if (nodeP->valueType != orion::ValueTypeVector)
+    return false;
+
+  if (level == 1)
+  {
+    if ((nodeP->childV.size() < 2) ||
+        (nodeP->childV[0]->valueType != orion::ValueTypeNumber) ||
+        (nodeP->childV[1]->valueType != orion::ValueTypeNumber))
+      return false;
+
+    OrionldGeoPoint point = { nodeP->childV[0]->numberValue, nodeP->childV[1]->numberValue };
+    geoP->pointV.push_back(point);
+
+    return true;
+  }
+
+  if (level == 3)
+    geoP->polygonV.push_back(geoP->partV.size());
+  else if (level == 2)
+    geoP->partV.push_back(geoP->pointV.size());
+
+  for (unsigned int ix = 0; ix < nodeP->childV.size(); ix++)
+  {
+    if (positionsExtract(nodeP->childV[ix], level - 1, geoP) == false)
+      return false;
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoGeometryFromCompound -
+//
+// valueP is a GeoJSON geometry: { "type": "Point", "coordinates": [ 1, 2 ] }
+//
+bool geoGeometryFromCompound(orion::CompoundValueNode* valueP, OrionldGeometry* geoP)
+{
+  orion::CompoundValueNode*  typeP        = NULL;
+  orion::CompoundValueNode*  coordinatesP = NULL;
+  char*                      detail;
+
+  if (valueP->valueType != orion::ValueTypeObject)
+    return false;
+
+  for (unsigned int ix = 0; ix < valueP->childV.size(); ix++)
+  {
+    if (strcmp(valueP->childV[ix]->name.c_str(), "type") == 0)
+      typeP = valueP->childV[ix];
+    else if (strcmp(valueP->childV[ix]->name.c_str(), "coordinates") == 0)
+      coordinatesP = valueP->childV[ix];
+  }
+
+  if ((typeP == NULL) || (coordinatesP == NULL) || (typeP->valueType != orion::ValueTypeString))
+    return false;
+
+  if (pcheckGeoType((char*) typeP->stringValue.c_str(), &geoP->type, &detail) == false)
+    return false;
+
+  geoP->pointV.clear();
+  geoP->partV.clear();
+  geoP->polygonV.clear();
+
+  if (positionsExtract(coordinatesP, geoTypeDepth(geoP->type), geoP) == false)
+    return false;
+
+  if (geoP->partV.size() == 0)  // Point
+    geoP->partV.push_back(0);
+
+  geoBoundingBox(geoP);
+
+  return true;
+}
@@ -0,0 +1,84 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <vector>                                              // std::vector
+
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/geo/geoBoxOverlap.h"                         // geoBoxOverlap
+#include "orionld/geo/geoSegmentsGet.h"                        // geoSegmentsGet
+#include "orionld/geo/geoSegmentsIntersect.h"                  // geoSegmentsIntersect
+#include "orionld/geo/geoPointInPolygons.h"                    // geoPointInPolygons
+#include "orionld/geo/geoIntersects.h"                         // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// anyPointInPolygons - is any of the points of geometry A inside the polygons of geometry B?
+//
+static bool anyPointInPolygons(const OrionldGeometry* aP, const OrionldGeometry* bP)
+{
+  if ((bP->type != GeoJsonPolygon) && (bP->type != GeoJsonMultiPolygon))
+    return false;
+
+  for (unsigned int ix = 0; ix < aP->pointV.size(); ix++)
+  {
+    if (geoPointInPolygons(&aP->pointV[ix], bP) == true)
+      return true;
+  }
+
+  return false;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoIntersects -
+//
+// Two geometries intersect if any of their segments cross or touch each other, or if
+// one of them lies entirely inside a polygon of the other one.
+//
+bool geoIntersects(const OrionldGeometry* aP, const OrionldGeometry* bP)
+{
+  if (geoBoxOverlap(&aP->bbox, &bP->bbox) == false)
+    return false;
+
+  std::vector<OrionldGeoSegment> aSegmentV;
+  std::vector<OrionldGeoSegment> bSegmentV;
+
+  geoSegmentsGet(aP, &aSegmentV);
+  geoSegmentsGet(bP, &bSegmentV);
+
+  for (unsigned int aIx = 0; aIx < aSegmentV.size(); aIx++)
+  {
+    for (unsigned int bIx = 0; bIx < bSegmentV.size(); bIx++)
+    {
+      if (geoSegmentsIntersect(&aSegmentV[aIx].p1, &aSegmentV[aIx].p2, &bSegmentV[bIx].p1, &bSegmentV[bIx].p2, false) == true)
+        return true;
+    }
+  }
+
+  return anyPointInPolygons(aP, bP) || anyPointInPolygons(bP, aP);
+}
@@ -0,0 +1,93 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <math.h>                                              // cos, M_PI
+#include <vector>                                              // std::vector
+
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/geo/geoDistance.h"                           // geoDistance
+#include "orionld/geo/geoSegmentsGet.h"                        // geoSegmentsGet
+#include "orionld/geo/geoPointInPolygons.h"                    // geoPointInPolygons
+#include "orionld/geo/geoMinDistance.h"                        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// closestPointOnSegment -
+//
+// The closest point is found in an equirectangular projection centered on the point, which is accurate
+// enough for the short distances of geo-queries. The distance to it is then calculated with haversine.
+//
+static void closestPointOnSegment(const OrionldGeoPoint* pP, const OrionldGeoSegment* segmentP, OrionldGeoPoint* closestP)
+{
+  double scale = cos(pP->lat * M_PI / 180);
+  double ax    = (segmentP->p1.lon - pP->lon) * scale;
+  double ay    = segmentP->p1.lat - pP->lat;
+  double bx    = (segmentP->p2.lon - pP->lon) * scale;
+  double by    = segmentP->p2.lat - pP->lat;
+  double dx    = bx - ax;
+  double dy    = by - ay;
+  double len2  = dx * dx + dy * dy;
+  double t     = (len2 == 0)? 0 : -(ax * dx + ay * dy) / len2;
+
+  if (t < 0)  t = 0;
+  if (t > 1)  t = 1;
+
+  closestP->lon = segmentP->p1.lon + t * (segmentP->p2.lon - segmentP->p1.lon);
+  closestP->lat = segmentP->p1.lat + t * (segmentP->p2.lat - segmentP->p1.lat);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoMinDistance - distance in meters from a point to the closest part of a geometry
+//
+// Points inside a polygon are at distance zero.
+//
+double geoMinDistance(const OrionldGeoPoint* pointP, const OrionldGeometry* geoP)
+{
+  if (geoPointInPolygons(pointP, geoP) == true)
+    return 0;
+
+  std::vector<OrionldGeoSegment>  segmentV;
+  double                          minDistance = -1;
+
+  geoSegmentsGet(geoP, &segmentV);
+
+  for (unsigned int ix = 0; ix < segmentV.size(); ix++)
+  {
+    OrionldGeoPoint  closest;
+    double           distance;
+
+    closestPointOnSegment(pointP, &segmentV[ix], &closest);
+    distance = geoDistance(pointP, &closest);
+
+    if ((minDistance < 0) || (distance < minDistance))
+      minDistance = distance;
+  }
+
+  return minDistance;
+}
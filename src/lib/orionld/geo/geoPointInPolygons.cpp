@@ -0,0 +1,108 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry
+#include "orionld/geo/geoSegmentsIntersect.h"                  // geoSegmentsIntersect
+#include "orionld/geo/geoPointInPolygons.h"                    // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ringContains - is the point inside the ring? Points on the border of the ring count as inside
+//
+// Ray casting - a ray from the point towards east crosses the border of the ring an odd number of times
+// if the point is inside the ring.
+//
+static bool ringContains(const OrionldGeometry* geoP, unsigned int partIx, const OrionldGeoPoint* pP, bool* onBorderP)
+{
+  unsigned int  start  = geoP->partV[partIx];
+  unsigned int  end    = (partIx + 1 < geoP->partV.size())? geoP->partV[partIx + 1] : geoP->pointV.size();
+  bool          inside = false;
+
+  *onBorderP = false;
+
+  if (end - start < 3)
+    return false;
+
+  for (unsigned int ix = start, jx = end - 1; ix < end; jx = ix++)
+  {
+    const OrionldGeoPoint* iP = &geoP->pointV[ix];
+    const OrionldGeoPoint* jP = &geoP->pointV[jx];
+
+    if (geoSegmentsIntersect(pP, pP, iP, jP, false) == true)
+    {
+      *onBorderP = true;
+      return true;
+    }
+
+    if (((iP->lat > pP->lat) != (jP->lat > pP->lat)) &&
+        (pP->lon < (jP->lon - iP->lon) * (pP->lat - iP->lat) / (jP->lat - iP->lat) + iP->lon))
+    {
+      inside = !inside;
+    }
+  }
+
+  return inside;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoPointInPolygons -
+//
+// A point is inside a polygon if it is inside the exterior ring and not strictly inside any of the holes.
+// For geometries that aren't polygons, false is returned.
+//
+bool geoPointInPolygons(const OrionldGeoPoint* pointP, const OrionldGeometry* geoP)
+{
+  if ((geoP->type != GeoJsonPolygon) && (geoP->type != GeoJsonMultiPolygon))
+    return false;
+
+  for (unsigned int polygonIx = 0; polygonIx < geoP->polygonV.size(); polygonIx++)
+  {
+    unsigned int  firstPart = geoP->polygonV[polygonIx];
+    unsigned int  endPart   = (polygonIx + 1 < geoP->polygonV.size())? geoP->polygonV[polygonIx + 1] : geoP->partV.size();
+    bool          onBorder;
+    bool          inHole    = false;
+
+    if (ringContains(geoP, firstPart, pointP, &onBorder) == false)
+      continue;
+
+    for (unsigned int holeIx = firstPart + 1; holeIx < endPart; holeIx++)
+    {
+      if ((ringContains(geoP, holeIx, pointP, &onBorder) == true) && (onBorder == false))
+      {
+        inHole = true;
+        break;
+      }
+    }
+
+    if (inHole == false)
+      return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,68 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <vector>                                              // std::vector
+
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeometry, OrionldGeoSegment
+#include "orionld/geo/geoSegmentsGet.h"                        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoSegmentsGet -
+//
+// Lines and polygon rings give one segment per pair of consecutive points (GeoJSON rings are closed,
+// so the last point equals the first one). Points give a degenerate segment each (p1 == p2), so that
+// all geometry types can be handled alike by geoSegmentsIntersect.
+//
+void geoSegmentsGet(const OrionldGeometry* geoP, std::vector<OrionldGeoSegment>* segmentV)
+{
+  OrionldGeoSegment segment;
+
+  if ((geoP->type == GeoJsonPoint) || (geoP->type == GeoJsonMultiPoint))
+  {
+    for (unsigned int ix = 0; ix < geoP->pointV.size(); ix++)
+    {
+      segment.p1 = geoP->pointV[ix];
+      segment.p2 = geoP->pointV[ix];
+      segmentV->push_back(segment);
+    }
+
+    return;
+  }
+
+  for (unsigned int partIx = 0; partIx < geoP->partV.size(); partIx++)
+  {
+    unsigned int start = geoP->partV[partIx];
+    unsigned int end   = (partIx + 1 < geoP->partV.size())? geoP->partV[partIx + 1] : geoP->pointV.size();
+
+    for (unsigned int ix = start + 1; ix < end; ix++)
+    {
+      segment.p1 = geoP->pointV[ix - 1];
+      segment.p2 = geoP->pointV[ix];
+      segmentV->push_back(segment);
+    }
+  }
+}
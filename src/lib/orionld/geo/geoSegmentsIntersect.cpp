@@ -0,0 +1,99 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <math.h>                                              // fabs
+
+#include "orionld/types/OrionldGeometry.h"                     // OrionldGeoPoint
+#include "orionld/geo/geoSegmentsIntersect.h"                  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// GEO_EPSILON - coordinates closer than this (in degrees) are considered equal
+//
+#define GEO_EPSILON  1e-12
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orientation - >0: p-q-r turns counter-clockwise, <0: clockwise, 0: collinear
+//
+static double orientation(const OrionldGeoPoint* pP, const OrionldGeoPoint* qP, const OrionldGeoPoint* rP)
+{
+  double o = (qP->lon - pP->lon) * (rP->lat - pP->lat) - (qP->lat - pP->lat) * (rP->lon - pP->lon);
+
+  return (fabs(o) < GEO_EPSILON)? 0 : o;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// onSegment - is r (collinear with p-q) on the segment p-q?
+//
+static bool onSegment(const OrionldGeoPoint* pP, const OrionldGeoPoint* qP, const OrionldGeoPoint* rP)
+{
+  return ((rP->lon <= fmax(pP->lon, qP->lon) + GEO_EPSILON) && (rP->lon >= fmin(pP->lon, qP->lon) - GEO_EPSILON) &&
+          (rP->lat <= fmax(pP->lat, qP->lat) + GEO_EPSILON) && (rP->lat >= fmin(pP->lat, qP->lat) - GEO_EPSILON));
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoSegmentsIntersect -
+//
+// The coordinates are treated as planar (lon/lat in degrees) - good enough for the sizes of the areas
+// used in geo-queries, but not for areas spanning the antimeridian.
+// A segment can be a single point (a1 == a2).
+//
+bool geoSegmentsIntersect
+(
+  const OrionldGeoPoint*  a1P,
+  const OrionldGeoPoint*  a2P,
+  const OrionldGeoPoint*  b1P,
+  const OrionldGeoPoint*  b2P,
+  bool                    proper
+)
+{
+  double d1 = orientation(b1P, b2P, a1P);
+  double d2 = orientation(b1P, b2P, a2P);
+  double d3 = orientation(a1P, a2P, b1P);
+  double d4 = orientation(a1P, a2P, b2P);
+
+  if ((((d1 > 0) && (d2 < 0)) || ((d1 < 0) && (d2 > 0))) && (((d3 > 0) && (d4 < 0)) || ((d3 < 0) && (d4 > 0))))
+    return true;
+
+  if (proper == true)
+    return false;
+
+  if ((d1 == 0) && onSegment(b1P, b2P, a1P))  return true;
+  if ((d2 == 0) && onSegment(b1P, b2P, a2P))  return true;
+  if ((d3 == 0) && onSegment(a1P, a2P, b1P))  return true;
+  if ((d4 == 0) && onSegment(a1P, a2P, b2P))  return true;
+
+  return false;
+}
@@ -0,0 +1,458 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // qsort, strtoll
+#include <string.h>                                            // strcmp
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
+#include "kjson/KjNode.h"                                      // KjNode
+#include "kjson/kjBuilder.h"                                   // kjObject, kjString, kjBoolean, ...
+#include "kjson/kjLookup.h"                                    // kjLookup
+}
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "rest/ConnectionInfo.h"                               // ConnectionInfo
+
+#include "orionld/common/orionldErrorResponse.h"               // orionldErrorResponseCreate
+#include "orionld/common/numberToDate.h"                       // numberToDate
+#include "orionld/common/eqForDot.h"                           // eqForDot
+#include "orionld/common/SCOMPARE.h"                           // SCOMPAREx
+#include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/context/orionldContextItemAliasLookup.h"     // orionldContextItemAliasLookup
+#include "orionld/kjTree/kjTreeFromQueryContextResponse.h"     // orionldSysAttrs
+#include "orionld/kjTree/kjTreeFromDbEntity.h"                 // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbNumber - the value of a numeric field of a DB entity, as a double
+//
+// Dates are stored as Int or Double, but may also come as NumberLong, that dbDataToKjTree turns into { "$numberLong": "<value>" }
+//
+static double dbNumber(KjNode* nodeP)
+{
+  if (nodeP == NULL)
+    return 0;
+
+  if (nodeP->type == KjInt)
+    return (double) nodeP->value.i;
+  if (nodeP->type == KjFloat)
+    return nodeP->value.f;
+  if ((nodeP->type == KjObject) && (nodeP->value.firstChildP != NULL) && (nodeP->value.firstChildP->type == KjString))
+    return (double) strtoll(nodeP->value.firstChildP->value.s, NULL, 10);
+
+  return 0;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// nameCompare - qsort callback, comparing KjNode names
+//
+static int nameCompare(const void* aP, const void* bP)
+{
+  KjNode* a = *((KjNode**) aP);
+  KjNode* b = *((KjNode**) bP);
+
+  return strcmp(a->name, b->name);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// childrenSorted - the children of an object, sorted by name
+//
+// mongoBackend iterates over the attributes (and metadata) of an entity in the order of an std::set of the DB names.
+// To give the exact same response, the same ordering is used here.
+//
+static KjNode** childrenSorted(KjNode* containerP, int* sizeP)
+{
+  int size = 0;
+
+  for (KjNode* nodeP = containerP->value.firstChildP; nodeP != NULL; nodeP = nodeP->next)
+    ++size;
+
+  *sizeP = size;
+
+  if (size == 0)
+    return NULL;
+
+  KjNode** nodeV = (KjNode**) kaAlloc(&orionldState.kalloc, size * sizeof(KjNode*));
+  int      ix    = 0;
+
+  for (KjNode* nodeP = containerP->value.firstChildP; nodeP != NULL; nodeP = nodeP->next)
+    nodeV[ix++] = nodeP;
+
+  qsort(nodeV, size, sizeof(KjNode*), nameCompare);
+
+  return nodeV;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// stringValue - the string value of an attribute or sub-attribute - compacted if possible
+//
+static const char* stringValue(const char* value, bool valueMayBeCompacted)
+{
+  if (valueMayBeCompacted == true)
+  {
+    char* compactedValue = orionldContextItemAliasLookup(orionldState.contextP, value, NULL, NULL);
+
+    if (compactedValue != NULL)
+      return compactedValue;
+  }
+
+  return value;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// valueCopy - copy a value of the DB to the response, just like the values of the legacy object model are rendered
+//
+// * Numbers are always rendered as floats
+// * Strings are compacted if the attribute/sub-attribute allows it
+// * The names of the fields of compound values are decoded ('=' back to '.')
+//
+static KjNode* valueCopy(KjNode* valueP, const char* name, bool valueMayBeCompacted)
+{
+  KjNode* nodeP;
+
+  switch (valueP->type)
+  {
+  case KjString:   return kjString(orionldState.kjsonP,  name, stringValue(valueP->value.s, valueMayBeCompacted));
+  case KjInt:      return kjFloat(orionldState.kjsonP,   name, (double) valueP->value.i);
+  case KjFloat:    return kjFloat(orionldState.kjsonP,   name, valueP->value.f);
+  case KjBoolean:  return kjBoolean(orionldState.kjsonP, name, valueP->value.b);
+  case KjNull:     return kjNull(orionldState.kjsonP,    name);
+
+  case KjObject:
+  case KjArray:
+    nodeP = (valueP->type == KjObject)? kjObject(orionldState.kjsonP, name) : kjArray(orionldState.kjsonP, name);
+
+    for (KjNode* itemP = valueP->value.firstChildP; itemP != NULL; itemP = itemP->next)
+    {
+      char*   itemName = NULL;
+      KjNode* copyP;
+
+      if (valueP->type == KjObject)
+      {
+        itemName = itemP->name;
+        eqForDot(itemName);
+      }
+
+      if ((copyP = valueCopy(itemP, itemName, valueMayBeCompacted)) == NULL)
+        return NULL;
+
+      kjChildAdd(nodeP, copyP);
+    }
+
+    return nodeP;
+
+  default:
+    break;
+  }
+
+  return kjString(orionldState.kjsonP, name, "UNKNOWN TYPE");
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// observedAtDate - observedAt is stored as a number and rendered as an ISO8601 string
+//
+static KjNode* observedAtDate(KjNode* valueP)
+{
+  char   date[128];
+  char*  details;
+
+  if (numberToDate((time_t) dbNumber(valueP), date, sizeof(date), &details) == false)
+  {
+    LM_E(("Error creating a stringified date"));
+    orionldErrorResponseCreate(OrionldInternalError, "Unable to create a stringified observedAt date", details);
+    return NULL;
+  }
+
+  return kjString(orionldState.kjsonP, "observedAt", date);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// metadataTree - the sub-attribute 'mdP' of the DB, as a child of the attribute 'aTop'
+//
+static bool metadataTree(KjNode* aTop, KjNode* mdP)
+{
+  char*    mdName               = mdP->name;
+  KjNode*  typeP                = kjLookup(mdP, "type");
+  KjNode*  valueP               = kjLookup(mdP, "value");
+  bool     valueMayBeCompacted  = false;
+  KjNode*  nodeP;
+
+  eqForDot(mdName);
+
+  if ((strcmp(mdName, "observedAt") != 0) &&
+      (strcmp(mdName, "createdAt")  != 0) &&
+      (strcmp(mdName, "modifiedAt") != 0))
+  {
+    mdName = orionldContextItemAliasLookup(orionldState.contextP, mdName, &valueMayBeCompacted, NULL);
+  }
+
+  bool isNumber      = (valueP != NULL) && ((valueP->type == KjInt) || (valueP->type == KjFloat));
+  bool isObservedAt  = SCOMPARE11(mdName, 'o', 'b', 's', 'e', 'r', 'v', 'e', 'd', 'A', 't', 0);
+
+  if ((typeP != NULL) && (typeP->type == KjString) && (typeP->value.s[0] != 0))
+  {
+    const char*  valueFieldName = (strcmp(typeP->value.s, "Relationship") == 0)? "object" : "value";
+    KjNode*      mdValueP;
+
+    nodeP = kjObject(orionldState.kjsonP, mdName);
+    kjChildAdd(nodeP, kjString(orionldState.kjsonP, "type", typeP->value.s));
+
+    if (valueP == NULL)
+      mdValueP = kjString(orionldState.kjsonP, valueFieldName, "UNKNOWN TYPE IN MONGODB 1");
+    else if ((isNumber == true) && (isObservedAt == true))
+      mdValueP = observedAtDate(valueP);
+    else
+      mdValueP = valueCopy(valueP, ((valueP->type == KjObject) || (valueP->type == KjArray))? "value" : valueFieldName, valueMayBeCompacted);
+
+    if (mdValueP == NULL)
+      return false;
+
+    kjChildAdd(nodeP, mdValueP);
+  }
+  else
+  {
+    if (valueP == NULL)
+      nodeP = kjString(orionldState.kjsonP, mdName, "UNKNOWN TYPE IN MONGODB 2");
+    else if ((isNumber == true) && (isObservedAt == true))
+      nodeP = observedAtDate(valueP);
+    else
+      nodeP = valueCopy(valueP, ((valueP->type == KjObject) || (valueP->type == KjArray))? "value" : mdName, valueMayBeCompacted);
+
+    if (nodeP == NULL)
+      return false;
+  }
+
+  kjChildAdd(aTop, nodeP);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// attributeTree - the attribute 'dbAttrP' of the DB, as an attribute of the API entity 'top'
+//
+static bool attributeTree(ConnectionInfo* ciP, KjNode* top, KjNode* dbAttrP, const char* longName, bool keyValues, bool sysAttrs)
+{
+  bool     valueMayBeCompacted = false;
+  char*    attrName            = orionldContextItemAliasLookup(orionldState.contextP, longName, &valueMayBeCompacted, NULL);
+  KjNode*  valueP              = kjLookup(dbAttrP, "value");
+  KjNode*  aTop;
+
+  if (keyValues == true)
+  {
+    // Just the value of the attribute
+    if (valueP == NULL)
+      aTop = kjString(orionldState.kjsonP, attrName, "");
+    else
+      aTop = valueCopy(valueP, attrName, valueMayBeCompacted);
+
+    if (aTop == NULL)
+    {
+      orionldErrorResponseCreate(OrionldInternalError, "Unable to create tree node for an attribute value", "out of memory");
+      return false;
+    }
+
+    kjChildAdd(top, aTop);
+    return true;
+  }
+
+  KjNode*  typeP           = kjLookup(dbAttrP, "type");
+  char*    type            = ((typeP != NULL) && (typeP->type == KjString))? typeP->value.s : (char*) "";
+  char*    valueFieldName  = (char*) ((strcmp(type, "Relationship") == 0)? "object" : "value");
+  KjNode*  nodeP;
+
+  aTop = kjObject(orionldState.kjsonP, attrName);
+
+  // type
+  if (*type != 0)
+    kjChildAdd(aTop, kjString(orionldState.kjsonP, "type", type));
+
+  // value
+  if (valueP == NULL)
+    nodeP = kjString(orionldState.kjsonP, valueFieldName, "");
+  else if (((valueP->type == KjInt) || (valueP->type == KjFloat)) && (SCOMPARE11(longName, 'o', 'b', 's', 'e', 'r', 'v', 'e', 'd', 'A', 't', 0)))
+    nodeP = observedAtDate(valueP);
+  else
+    nodeP = valueCopy(valueP, valueFieldName, valueMayBeCompacted);
+
+  if (nodeP == NULL)
+  {
+    orionldErrorResponseCreate(OrionldInternalError, "Unable to create tree node for an attribute value", "out of memory");
+    return false;
+  }
+
+  kjChildAdd(aTop, nodeP);
+  kjChildAdd(top, aTop);
+
+  // System Attributes?
+  if (sysAttrs == true)
+  {
+    if (orionldSysAttrs(ciP, dbNumber(kjLookup(dbAttrP, "creDate")), dbNumber(kjLookup(dbAttrP, "modDate")), aTop) == false)
+    {
+      LM_E(("sysAttrs error"));
+      return false;
+    }
+  }
+
+  // Metadata
+  KjNode* mdsP = kjLookup(dbAttrP, "md");
+
+  if ((mdsP != NULL) && (mdsP->type == KjObject))
+  {
+    int       mds;
+    KjNode**  mdV = childrenSorted(mdsP, &mds);
+
+    for (int ix = 0; ix < mds; ix++)
+    {
+      if (metadataTree(aTop, mdV[ix]) == false)
+        LM_E(("Error in creation of KjNode for metadata '%s'", mdV[ix]->name));
+    }
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// inAttrsArray -
+//
+static bool inAttrsArray(const char* attrName, KjNode* attrsArray)
+{
+  for (KjNode* attrP = attrsArray->value.firstChildP; attrP != NULL; attrP = attrP->next)
+  {
+    if (strcmp(attrName, attrP->value.s) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjTreeFromDbEntity - render an entity, as it is stored in the database, as an NGSI-LD entity
+//
+// PARAMETERS
+//   ciP         - ConnectionInfo, where all info about each request is stored
+//   dbEntityP   - The entity as extracted from the database (by dbEntitiesQuery)
+//   attrsArray  - Array of expanded attribute names to be included in the response - NULL for all attributes
+//   keyValues   - if TRUE, omit details of the attributes
+//   sysAttrs    - if TRUE, include createdAt and modifiedAt
+//
+// The resulting tree is the same as kjTreeFromQueryContextResponse creates for the same entity, only without
+// passing through the ContextElementResponse of mongoBackend.
+// Note that the names of the DB entity are decoded ('=' back to '.') in-place.
+//
+KjNode* kjTreeFromDbEntity(ConnectionInfo* ciP, KjNode* dbEntityP, KjNode* attrsArray, bool keyValues, bool sysAttrs)
+{
+  KjNode* _idP = kjLookup(dbEntityP, "_id");
+
+  if ((_idP == NULL) || (_idP->type != KjObject))
+  {
+    LM_E(("Database Error (entity without _id)"));
+    orionldErrorResponseCreate(OrionldInternalError, "Invalid entity in database", "no _id field");
+    return NULL;
+  }
+
+  KjNode* idP   = kjLookup(_idP, "id");
+  KjNode* typeP = kjLookup(_idP, "type");
+  KjNode* top   = kjObject(orionldState.kjsonP, NULL);
+
+  // id
+  kjChildAdd(top, kjString(orionldState.kjsonP, "id", (idP != NULL)? idP->value.s : ""));
+
+  // type
+  if ((typeP != NULL) && (typeP->value.s[0] != 0))
+  {
+    char* alias = orionldContextItemAliasLookup(orionldState.contextP, typeP->value.s, NULL, NULL);
+
+    kjChildAdd(top, kjString(orionldState.kjsonP, "type", alias));
+  }
+
+  // System Attributes?
+  if (sysAttrs == true)
+  {
+    if (orionldSysAttrs(ciP, dbNumber(kjLookup(dbEntityP, "creDate")), dbNumber(kjLookup(dbEntityP, "modDate")), top) == false)
+    {
+      LM_E(("sysAttrs error"));
+      return NULL;
+    }
+  }
+
+  // Attributes
+  KjNode* attrsP = kjLookup(dbEntityP, "attrs");
+
+  if ((attrsP == NULL) || (attrsP->type != KjObject))
+    return top;
+
+  int       attrs;
+  KjNode**  attrV = childrenSorted(attrsP, &attrs);
+
+  for (int ix = 0; ix < attrs; ix++)
+  {
+    KjNode* dbAttrP = attrV[ix];
+
+    eqForDot(dbAttrP->name);
+
+    //
+    // If URI param attrs has been used, only matching attributes should be included in the response
+    //
+    if ((attrsArray != NULL) && (attrsArray->value.firstChildP != NULL) && (inAttrsArray(dbAttrP->name, attrsArray) == false))
+      continue;
+
+    if (attributeTree(ciP, top, dbAttrP, dbAttrP->name, keyValues, sysAttrs) == false)
+      return NULL;
+  }
+
+  return top;
+}
@@ -30,6 +30,14 @@
 
 
 
+// -----------------------------------------------------------------------------
+//
+// orionldSysAttrs - add createdAt and modifiedAt to a container
+//
+extern bool orionldSysAttrs(ConnectionInfo* ciP, double creDate, double modDate, KjNode* containerP);
+
+
+
 // -----------------------------------------------------------------------------
 //
 // kjTreeFromQueryContextResponse -
@@ -319,6 +319,19 @@ KjNode* kjTreeFromSubscription(ConnectionInfo* ciP, ngsiv2::Subscription* subscr
 
   kjChildAdd(objectP, endpointP);
 
+  // notification::batch
+  if (subscriptionP->notification.httpInfo.batchMaxEntities > 0)
+  {
+    KjNode* batchP = kjObject(orionldState.kjsonP, "batch");
+
+    nodeP = kjInteger(orionldState.kjsonP, "maxEntities", subscriptionP->notification.httpInfo.batchMaxEntities);
+    kjChildAdd(batchP, nodeP);
+    nodeP = kjInteger(orionldState.kjsonP, "maxDelay", subscriptionP->notification.httpInfo.batchMaxDelay);
+    kjChildAdd(batchP, nodeP);
+
+    kjChildAdd(objectP, batchP);
+  }
+
 
   // notification::timesSent
 #if 0
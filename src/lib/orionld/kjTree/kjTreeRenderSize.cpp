@@ -0,0 +1,149 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <string.h>                                              // strlen
+
+extern "C"
+{
+#include "kjson/kjson.h"                                         // Kjson
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "orionld/kjTree/kjTreeRenderSize.h"                     // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// stringRenderSize - size of a string, quotes included, assuming the worst case for escaped characters
+//
+// A character that needs escaping is rendered as \uXXXX at most (6 bytes)
+//
+static int stringRenderSize(const char* s)
+{
+  int size = 2;  // the quotes
+
+  while (*s != 0)
+  {
+    unsigned char c = (unsigned char) *s;
+
+    if ((c == '"') || (c == '\\') || (c < 0x20))
+      size += 6;
+    else
+      size += 1;
+
+    ++s;
+  }
+
+  return size;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// nodeRenderSize -
+//
+static int nodeRenderSize(Kjson* kjsonP, KjNode* nodeP, int level, int fixedOverhead)
+{
+  //
+  // Common to all nodes:
+  //   - indentation
+  //   - the name, if any, with its colon and the whitespace around it
+  //   - the comma and the newline after the node
+  //
+  int size = level * kjsonP->spacesPerIndent + fixedOverhead;
+
+  if (nodeP->name != NULL)
+    size += stringRenderSize(nodeP->name);
+
+  switch (nodeP->type)
+  {
+  case KjString:
+    size += stringRenderSize(nodeP->value.s);
+    break;
+
+  case KjInt:
+    size += 21;  // INT64_MIN: "-9223372036854775808"
+    break;
+
+  case KjFloat:
+    {
+      //
+      // The exact format used by kjRender is not known here, so the worst of "%f" and a 32-byte
+      // "%g"-style representation is assumed
+      //
+      int fSize = snprintf(NULL, 0, "%f", nodeP->value.f);
+      size += (fSize > 32)? fSize : 32;
+    }
+    break;
+
+  case KjBoolean:
+    size += 5;  // "false"
+    break;
+
+  case KjNull:
+    size += 4;  // "null"
+    break;
+
+  case KjObject:
+  case KjArray:
+    //
+    // Start and end brackets, with the newline after the start bracket and the indentation of the end bracket
+    //
+    size += 2 + fixedOverhead + level * kjsonP->spacesPerIndent;
+
+    for (KjNode* childP = nodeP->value.firstChildP; childP != NULL; childP = childP->next)
+    {
+      size += nodeRenderSize(kjsonP, childP, level + 1, fixedOverhead);
+    }
+    break;
+
+  default:
+    size += 32;
+    break;
+  }
+
+  return size;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjTreeRenderSize -
+//
+int kjTreeRenderSize(Kjson* kjsonP, KjNode* treeP)
+{
+  //
+  // Per node overhead: colon (with the strings before and after it), comma and newline
+  //
+  int fixedOverhead = 2 + strlen(kjsonP->stringBeforeColon) + strlen(kjsonP->stringAfterColon) + strlen(kjsonP->nlString);
+
+  if (treeP == NULL)
+    return 1;
+
+  return nodeRenderSize(kjsonP, treeP, 0, fixedOverhead) + 1;  // +1: the terminating zero
+}
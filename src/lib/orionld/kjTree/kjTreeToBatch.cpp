@@ -0,0 +1,88 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+extern "C"
+{
+#include "kjson/KjNode.h"                                      // KjNode
+}
+
+#include "rest/ConnectionInfo.h"                               // ConnectionInfo
+#include "apiTypesV2/HttpInfo.h"                               // HttpInfo
+
+#include "orionld/common/CHECK.h"                              // CHECKx()
+#include "orionld/common/SCOMPARE.h"                           // SCOMPAREx
+#include "orionld/common/orionldErrorResponse.h"               // orionldErrorResponseCreate
+#include "orionld/notifications/notificationBatch.h"           // NOTIFICATION_BATCH_*
+#include "orionld/kjTree/kjTreeToBatch.h"                      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjTreeToBatch -
+//
+bool kjTreeToBatch(ConnectionInfo* ciP, KjNode* kNodeP, ngsiv2::HttpInfo* httpInfoP)
+{
+  KjNode* maxEntitiesP = NULL;
+  KjNode* maxDelayP    = NULL;
+
+  for (KjNode* itemP = kNodeP->value.firstChildP; itemP != NULL; itemP = itemP->next)
+  {
+    if (SCOMPARE12(itemP->name, 'm', 'a', 'x', 'E', 'n', 't', 'i', 't', 'i', 'e', 's', 0))
+    {
+      DUPLICATE_CHECK(maxEntitiesP, "Batch::maxEntities", itemP);
+      INTEGER_CHECK(itemP, "Batch::maxEntities");
+
+      if ((itemP->value.i < 1) || (itemP->value.i > NOTIFICATION_BATCH_MAX_ENTITIES_MAX))
+      {
+        orionldErrorResponseCreate(OrionldBadRequestData, "Invalid value for Batch::maxEntities", "must be an integer between 1 and 1000");
+        ciP->httpStatusCode = SccBadRequest;
+        return false;
+      }
+    }
+    else if (SCOMPARE9(itemP->name, 'm', 'a', 'x', 'D', 'e', 'l', 'a', 'y', 0))
+    {
+      DUPLICATE_CHECK(maxDelayP, "Batch::maxDelay", itemP);
+      INTEGER_CHECK(itemP, "Batch::maxDelay");
+
+      if ((itemP->value.i < 1) || (itemP->value.i > NOTIFICATION_BATCH_MAX_DELAY_MAX))
+      {
+        orionldErrorResponseCreate(OrionldBadRequestData, "Invalid value for Batch::maxDelay", "must be an integer between 1 and 60000 (milliseconds)");
+        ciP->httpStatusCode = SccBadRequest;
+        return false;
+      }
+    }
+    else
+    {
+      orionldErrorResponseCreate(OrionldBadRequestData, "Unrecognized field in Batch", itemP->name);
+      ciP->httpStatusCode = SccBadRequest;
+      return false;
+    }
+  }
+
+  httpInfoP->batchMaxEntities = (maxEntitiesP != NULL)? maxEntitiesP->value.i : NOTIFICATION_BATCH_MAX_ENTITIES_DEFAULT;
+  httpInfoP->batchMaxDelay    = (maxDelayP    != NULL)? maxDelayP->value.i    : NOTIFICATION_BATCH_MAX_DELAY_DEFAULT;
+
+  return true;
+}
@@ -38,6 +38,7 @@ extern "C"
 #include "orionld/common/orionldErrorResponse.h"               // orionldErrorResponseCreate
 #include "orionld/kjTree/kjTreeToStringList.h"                 // kjTreeToStringList
 #include "orionld/kjTree/kjTreeToEndpoint.h"                   // kjTreeToEndpoint
+#include "orionld/kjTree/kjTreeToBatch.h"                      // kjTreeToBatch
 #include "orionld/kjTree/kjTreeToNotification.h"               // Own interface
 
 
@@ -73,6 +74,7 @@ bool kjTreeToNotification(ConnectionInfo* ciP, KjNode* kNodeP, ngsiv2::Subscript
   KjNode*   attributesP   = NULL;
   char*     formatP       = NULL;
   KjNode*   endpointP     = NULL;
+  KjNode*   batchP        = NULL;
   KjNode*   itemP;
 
   // Set default values
@@ -107,6 +109,14 @@ bool kjTreeToNotification(ConnectionInfo* ciP, KjNode* kNodeP, ngsiv2::Subscript
       if (kjTreeToEndpoint(ciP, itemP, &subP->notification.httpInfo) == false)
         return false;
     }
+    else if (SCOMPARE6(itemP->name, 'b', 'a', 't', 'c', 'h', 0))
+    {
+      DUPLICATE_CHECK(batchP, "Notification::batch", itemP);
+      OBJECT_CHECK(itemP, "Notification::batch");
+
+      if (kjTreeToBatch(ciP, itemP, &subP->notification.httpInfo) == false)
+        return false;
+    }
     else if (SCOMPARE7(itemP->name, 's', 't', 'a', 't', 'u', 's', 0))
     {
       // Ignored field - internal field that cannot be set by requests
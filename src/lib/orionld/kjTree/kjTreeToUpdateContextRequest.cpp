@@ -155,7 +155,10 @@ static bool kjTreeToContextElementAttributes
 //
 // If Content-Type is "application/ld+json", then the @context must be part of each and every item of the array
 //
-void kjTreeToUpdateContextRequest(ConnectionInfo* ciP, UpdateContextRequest* ucrP, KjNode* treeP, KjNode* errorsArrayP)
+// Each entity may have its own GeoProperty. It is given back in geoPropertyV (if non-NULL), using the same index
+// as the entity has in ucrP->contextElementVector. geoPropertyV must have room for all the entities of treeP.
+//
+void kjTreeToUpdateContextRequest(ConnectionInfo* ciP, UpdateContextRequest* ucrP, KjNode* treeP, KjNode* errorsArrayP, KjNode** geoPropertyV)
 {
   KjNode* next;
   KjNode* entityP = treeP->value.firstChildP;
@@ -233,6 +236,8 @@ void kjTreeToUpdateContextRequest(ConnectionInfo* ciP, UpdateContextRequest* ucr
     entityIdP->type      = entityTypeExpanded;
     entityIdP->isPattern = "false";
 
+    orionldState.locationAttributeP = NULL;  // One GeoProperty per entity, not per request
+
     if (kjTreeToContextElementAttributes(ciP, contextP, entityP, NULL, NULL, ceP, &title, &detail) == false)
     {
       LM_W(("kjTreeToContextElementAttributes flags error '%s: %s' for entity '%s'", title, detail, entityId));
@@ -242,7 +247,12 @@ void kjTreeToUpdateContextRequest(ConnectionInfo* ciP, UpdateContextRequest* ucr
       continue;
     }
 
+    if (geoPropertyV != NULL)
+      geoPropertyV[ucrP->contextElementVector.size()] = orionldState.locationAttributeP;
+
     ucrP->contextElementVector.push_back(ceP);
     entityP = next;
   }
+
+  orionldState.locationAttributeP = NULL;
 }
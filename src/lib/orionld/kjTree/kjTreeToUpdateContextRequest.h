@@ -44,7 +44,8 @@ extern void kjTreeToUpdateContextRequest
   ConnectionInfo*        ciP,
   UpdateContextRequest*  ucrP,
   KjNode*                treeP,
-  KjNode*                errorsArrayP
+  KjNode*                errorsArrayP,
+  KjNode**               geoPropertyV
 );
 
 #endif  // SRC_LIB_ORIONLD_KJTREE_KJTREETOUPDATECONTEXTREQUEST_H_
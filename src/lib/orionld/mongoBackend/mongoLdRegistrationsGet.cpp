@@ -37,7 +37,7 @@
 #include "orionld/context/orionldContextItemExpand.h"          // orionldContextItemExpand
 #include "mongoBackend/MongoGlobal.h"                          // getMongoConnection
 #include "mongoBackend/safeMongo.h"                            // moreSafe
-#include "mongoBackend/connectionOperations.h"                 // collectionRangedQuery
+#include "mongoBackend/connectionOperations.h"                 // collectionRangedQuery, collectionRangedCount
 #include "mongoBackend/mongoRegistrationAux.h"                 // mongoSetXxx
 #include "orionld/mongoBackend/mongoLdRegistrationAux.h"       // mongoSetLdRelationshipV, mongoSetLdPropertyV, ...
 #include "orionld/mongoBackend/mongoLdRegistrationsGet.h"      // Own interface
@@ -210,6 +210,10 @@ static bool uriParamAttrsToFilter(mongo::BSONObjBuilder* queryBuilderP, char* at
 /* ****************************************************************************
 *
 * mongoLdRegistrationsGet -
+*
+* If 'afterId' is non-NULL (pagination cursor), the listing starts right after the registration with that id
+* (keyset pagination on _id), and the URI param 'offset' is not used.
+* The count (if countP != NULL) is made without the cursor, and stopped at ESTIMATED_COUNT_MAX if 'countEstimated' is set.
 */
 bool mongoLdRegistrationsGet
 (
@@ -217,6 +221,8 @@ bool mongoLdRegistrationsGet
   std::vector<ngsiv2::Registration>*  regVecP,
   const char*                         tenant,
   long long*                          countP,
+  bool                                countEstimated,
+  const char*                         afterId,
   OrionError*                         oeP
 )
 {
@@ -250,7 +256,26 @@ bool mongoLdRegistrationsGet
   // FIXME: Many more URI params to be treated and added to queryBuilder - but that's for 2020 ...
   //
 
-  query = queryBuilder.obj();  // Here all the filters added to queryBuilder are "merged" into 'query'
+  mongo::BSONObj filter = queryBuilder.obj();  // Here all the filters added to queryBuilder are "merged" into 'filter'
+
+  //
+  // Keyset pagination - the id filters also use "_id", so the cursor condition is AND-ed to the filter
+  //
+  if (afterId != NULL)
+  {
+    mongo::BSONArrayBuilder  andArray;
+    mongo::BSONObjBuilder    keysetFilter;
+
+    andArray.append(filter);
+    andArray.append(BSON("_id" << BSON("$gt" << afterId)));
+    keysetFilter.append("$and", andArray.arr());
+
+    query  = keysetFilter.obj();
+    offset = 0;
+  }
+  else
+    query = filter;
+
   query.sort(BSON("_id" << 1));
 
   TIME_STAT_MONGO_READ_WAIT_START();
@@ -259,14 +284,15 @@ bool mongoLdRegistrationsGet
   std::auto_ptr<mongo::DBClientCursor>  cursor;
   mongo::DBClientBase*                  connection = getMongoConnection();
 
-  if (!collectionRangedQuery(connection,
-                             getRegistrationsCollectionName(tenant),
-                             query,
-                             limit,
-                             offset,
-                             &cursor,
-                             countP,
-                             &err))
+  if (((countP != NULL) && (!collectionRangedCount(connection, getRegistrationsCollectionName(tenant), filter, countEstimated, countP, &err))) ||
+      (!collectionRangedQuery(connection,
+                              getRegistrationsCollectionName(tenant),
+                              query,
+                              limit,
+                              offset,
+                              &cursor,
+                              NULL,
+                              &err)))
   {
     releaseMongoConnection(connection);
     TIME_STAT_MONGO_READ_WAIT_STOP();
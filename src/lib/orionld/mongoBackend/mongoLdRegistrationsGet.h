@@ -43,6 +43,8 @@ extern bool mongoLdRegistrationsGet
   std::vector<ngsiv2::Registration>*  regVecP,
   const char*                         tenant,
   long long*                          countP,
+  bool                                countEstimated,
+  const char*                         afterId,
   OrionError*                         oeP
 );
 
@@ -0,0 +1,239 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // strtod
+#include <string>                                                // std::string
+
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection, ensureEntityIndexes
+#include "mongoBackend/connectionOperations.h"                   // collectionRangedQuery, collectionRangedCount
+#include "mongoBackend/safeMongo.h"                              // moreSafe, nextSafeOrErrorF
+#include "orionld/common/SCOMPARE.h"                             // SCOMPAREx
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/db/dbCollectionPathGet.h"                      // dbCollectionPathGet
+#include "orionld/db/dbConfiguration.h"                          // dbDataToKjTree
+#include "orionld/mongoCppLegacy/mongoCppLegacyEntitiesQuery.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoCppLegacyEntitiesQuery - query the entities collection, returning the raw DB entities as a KjNode array
+//
+// PARAMETERS
+//   entitySelectorArray  - array of objects { "id" | "idPattern", [ "type" | "typePattern" ] } - OR-ed together
+//   attrsArray           - array of expanded attribute names (the entity must have at least one of them), or NULL
+//   cursorV              - sort key of the last entity of the previous page (creDate, id, type), or NULL
+//   offset               - pagination offset (not used if cursorV is given)
+//   limit                - pagination limit
+//   countP               - if non-NULL, the total number of matching entities is returned in *countP
+//   countEstimated       - if true, the count stops at ESTIMATED_COUNT_MAX
+//
+// The filter is the same as the one mongoBackend (entitiesQuery) builds for an NGSI-LD query without geo-scope:
+//
+//   {
+//     "$or": [ { "_id.id": ID | /IDPATTERN/, "_id.type": TYPE | /TYPEPATTERN/ }, ... ],
+//     "attrNames": { "$in": [ ATTRS ] },
+//     <orionldState.qMongoFilterP>
+//   }
+//
+// sorted by creation date (and entity id and type, to have a total order for keyset pagination).
+//
+// With a cursor, the page starts right after the entity the cursor points to, using the sort key:
+//
+//   "$or": [
+//     { "creDate": { "$gt": C } },
+//     { "creDate": C, "_id.id": { "$gt": ID } },
+//     { "creDate": C, "_id.id": ID, "_id.type": { "$gt": TYPE } }
+//   ]
+//
+// so that deep pages are found by the index instead of skipping all the entities of the previous pages.
+//
+// Instead of creating a ContextElementResponse per entity, the BSON documents are turned straight into KjNode trees
+// and it is up to the caller to render them as NGSI-LD entities.
+//
+// RETURN VALUE
+//   A KjNode array with the DB entities - empty array if there are no matches
+//   NULL if the database could not be queried
+//
+KjNode* mongoCppLegacyEntitiesQuery(KjNode* entitySelectorArray, KjNode* attrsArray, char** cursorV, int offset, int limit, long long* countP, bool countEstimated)
+{
+  char collectionPath[256];
+
+  if (dbCollectionPathGet(collectionPath, sizeof(collectionPath), "entities") == -1)
+  {
+    LM_E(("Internal Error (dbCollectionPathGet returned -1)"));
+    return NULL;
+  }
+
+  //
+  // The sort below (creDate, _id.id, _id.type) needs its index - also for tenants with no entity created since startup
+  //
+  ensureEntityIndexes(orionldState.tenant);
+
+  mongo::BSONObjBuilder    filter;
+  mongo::BSONArrayBuilder  orArray;
+
+  for (KjNode* selectorP = entitySelectorArray->value.firstChildP; selectorP != NULL; selectorP = selectorP->next)
+  {
+    mongo::BSONObjBuilder entity;
+
+    for (KjNode* itemP = selectorP->value.firstChildP; itemP != NULL; itemP = itemP->next)
+    {
+      if (SCOMPARE3(itemP->name, 'i', 'd', 0))
+        entity.append("_id.id", itemP->value.s);
+      else if (SCOMPARE10(itemP->name, 'i', 'd', 'P', 'a', 't', 't', 'e', 'r', 'n', 0))
+        entity.appendRegex("_id.id", itemP->value.s);
+      else if (SCOMPARE5(itemP->name, 't', 'y', 'p', 'e', 0))
+        entity.append("_id.type", itemP->value.s);
+      else if (SCOMPARE12(itemP->name, 't', 'y', 'p', 'e', 'P', 'a', 't', 't', 'e', 'r', 'n', 0))
+        entity.appendRegex("_id.type", itemP->value.s);
+    }
+
+    orArray.append(entity.obj());
+  }
+
+  filter.append("$or", orArray.arr());
+
+  if ((attrsArray != NULL) && (attrsArray->value.firstChildP != NULL))
+  {
+    mongo::BSONArrayBuilder  attrNames;
+    mongo::BSONObjBuilder    inObj;
+
+    for (KjNode* attrP = attrsArray->value.firstChildP; attrP != NULL; attrP = attrP->next)
+      attrNames.append(attrP->value.s);
+
+    inObj.append("$in", attrNames.arr());
+    filter.append("attrNames", inObj.obj());
+  }
+
+  if (orionldState.qMongoFilterP != NULL)
+    filter.appendElements(*orionldState.qMongoFilterP);
+
+  mongo::BSONObj         filterObj   = filter.obj();
+  mongo::DBClientBase*   connectionP = getMongoConnection();
+  std::string            err;
+
+  //
+  // The count is made without the cursor, on all matching entities
+  //
+  if ((countP != NULL) && (collectionRangedCount(connectionP, collectionPath, filterObj, countEstimated, countP, &err) == false))
+  {
+    LM_E(("Database Error (%s)", err.c_str()));
+    releaseMongoConnection(connectionP);
+    return NULL;
+  }
+
+  if (cursorV != NULL)
+  {
+    double                   creDate = strtod(cursorV[0], NULL);
+    mongo::BSONObjBuilder    gtCreDate;
+    mongo::BSONObjBuilder    gtId;
+    mongo::BSONObjBuilder    gtType;
+    mongo::BSONObjBuilder    after1;
+    mongo::BSONObjBuilder    after2;
+    mongo::BSONObjBuilder    after3;
+    mongo::BSONArrayBuilder  afterArray;
+    mongo::BSONObjBuilder    afterOr;
+    mongo::BSONArrayBuilder  andArray;
+    mongo::BSONObjBuilder    keysetFilter;
+
+    gtCreDate.append("$gt", creDate);
+    after1.append("creDate", gtCreDate.obj());
+
+    gtId.append("$gt", cursorV[1]);
+    after2.append("creDate", creDate);
+    after2.append("_id.id", gtId.obj());
+
+    gtType.append("$gt", cursorV[2]);
+    after3.append("creDate", creDate);
+    after3.append("_id.id", cursorV[1]);
+    after3.append("_id.type", gtType.obj());
+
+    afterArray.append(after1.obj());
+    afterArray.append(after2.obj());
+    afterArray.append(after3.obj());
+    afterOr.append("$or", afterArray.arr());
+
+    andArray.append(filterObj);
+    andArray.append(afterOr.obj());
+    keysetFilter.append("$and", andArray.arr());
+
+    filterObj = keysetFilter.obj();
+    offset    = 0;
+  }
+
+  mongo::BSONObjBuilder  sort;
+
+  sort.append("creDate",  1);
+  sort.append("_id.id",   1);
+  sort.append("_id.type", 1);
+
+  mongo::Query                          query(filterObj);
+  std::auto_ptr<mongo::DBClientCursor>  cursorP;
+
+  query.sort(sort.obj());
+
+  if (collectionRangedQuery(connectionP, collectionPath, query, limit, offset, &cursorP, NULL, &err) == false)
+  {
+    LM_E(("Database Error (%s)", err.c_str()));
+    releaseMongoConnection(connectionP);
+    return NULL;
+  }
+
+  KjNode* entityArray = kjArray(orionldState.kjsonP, NULL);
+
+  while (moreSafe(cursorP))
+  {
+    mongo::BSONObj  bsonObj;
+    char*           title;
+    char*           details;
+    KjNode*         entityP;
+
+    if (!nextSafeOrErrorF(cursorP, &bsonObj, &err))
+    {
+      LM_E(("Runtime Error (exception in nextSafe(): %s - query: %s)", err.c_str(), query.toString().c_str()));
+      continue;
+    }
+
+    if ((entityP = dbDataToKjTree(&bsonObj, &title, &details)) == NULL)
+      LM_E(("%s: %s", title, details));
+    else
+      kjChildAdd(entityArray, entityP);
+  }
+
+  releaseMongoConnection(connectionP);
+
+  return entityArray;
+}
@@ -48,9 +48,10 @@ extern "C"
 // mongoCppLegacyEntityListLookupWithIdTypeCreDate -
 //
 // This function extracts (from mongo) the entities whose ID are in the vector 'entityIdsArray'.
-// Instead of returning the complete information of the entities, only three fields are returned per entity, namely:
+// Instead of returning the complete information of the entities, only four fields are returned per entity, namely:
 //   * Entity ID
 //   * Entity Type
+//   * Entity Service Path (if present in the database)
 //   * Entity Creation Date
 //
 KjNode* mongoCppLegacyEntityListLookupWithIdTypeCreDate(KjNode* entityIdsArray)
@@ -80,7 +81,7 @@ KjNode* mongoCppLegacyEntityListLookupWithIdTypeCreDate(KjNode* entityIdsArray)
   //
   // Specify the fields to return
   //
-  fields.append("_id",     1);  // "id" and "type" are inside "_id"
+  fields.append("_id",     1);  // "id", "type" and "servicePath" are inside "_id"
   fields.append("creDate", 1);
 
   mongo::BSONObj                        fieldsToReturn = fields.obj();
@@ -114,6 +115,13 @@ KjNode* mongoCppLegacyEntityListLookupWithIdTypeCreDate(KjNode* entityIdsArray)
 
     kjChildAdd(entityTree, idNodeP);
     kjChildAdd(entityTree, typeNodeP);
+
+    if (idField.hasField("servicePath"))
+    {
+      KjNode* spNodeP = kjString(orionldState.kjsonP, "servicePath", getStringFieldF(idField, "servicePath").c_str());
+      kjChildAdd(entityTree, spNodeP);
+    }
+
     kjChildAdd(entityTree, creDateNodeP);
 
     char debugBuffer[512];
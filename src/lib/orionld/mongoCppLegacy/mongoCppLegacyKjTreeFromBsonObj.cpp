@@ -22,6 +22,9 @@
 *
 * Author: Ken Zangelin
 */
+#include <string.h>                                                  // memcpy
+#include <stdio.h>                                                   // snprintf
+#include <math.h>                                                    // fabs
 #include <string>                                                    // std::string
 
 #include "mongo/client/dbclient.h"                                   // mongo::BSONObj
@@ -29,7 +32,9 @@
 extern "C"
 {
 #include "kjson/KjNode.h"                                            // KjNode
+#include "kjson/kjBuilder.h"                                         // kjObject, kjArray, kjString, kjInteger, kjFloat, kjBoolean, kjNull, kjChildAdd
 #include "kjson/kjParse.h"                                           // kjParse
+#include "kalloc/kaAlloc.h"                                          // kaAlloc
 #include "kalloc/kaStrdup.h"                                         // kaStrdup
 }
 
@@ -41,31 +46,153 @@ extern "C"
 
 
 
+// -----------------------------------------------------------------------------
+//
+// kjTreeFromBsonObjContent - forward declaration
+//
+static bool kjTreeFromBsonObjContent(const mongo::BSONObj& bsonObj, KjNode* containerP, bool isArray);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjNodeFromBsonElement -
+//
+// The nodes are created just like they would be if the BSON element was rendered by BSONObj::jsonString() (Strict mode)
+// and then parsed by kjParse, i.e.:
+//   * Doubles without decimals become integers
+//   * NumberLong becomes { "$numberLong": "<value as string>" }
+//   * OID becomes { "$oid": "<hex string>" }
+//   * Any other type is rendered as JSON and parsed (not found in the orionld collections)
+//
+// Field names and string values point into the BSON data, that has been copied to orionldState.kalloc by the caller.
+//
+static KjNode* kjNodeFromBsonElement(const mongo::BSONElement& be, const char* name)
+{
+  KjNode* nodeP = NULL;
+
+  switch (be.type())
+  {
+  case mongo::String:
+    nodeP = kjString(orionldState.kjsonP, name, be.valuestr());
+    break;
+
+  case mongo::NumberDouble:
+    {
+      double d = be._numberDouble();
+
+      if ((fabs(d) < 1e16) && (d == (double) (long long) d))
+        nodeP = kjInteger(orionldState.kjsonP, name, (long long) d);
+      else
+        nodeP = kjFloat(orionldState.kjsonP, name, d);
+    }
+    break;
+
+  case mongo::NumberInt:
+    nodeP = kjInteger(orionldState.kjsonP, name, be._numberInt());
+    break;
+
+  case mongo::Bool:
+    nodeP = kjBoolean(orionldState.kjsonP, name, be.boolean());
+    break;
+
+  case mongo::jstNULL:
+    nodeP = kjNull(orionldState.kjsonP, name);
+    break;
+
+  case mongo::Object:
+  case mongo::Array:
+    nodeP = (be.type() == mongo::Object)? kjObject(orionldState.kjsonP, name) : kjArray(orionldState.kjsonP, name);
+    if (kjTreeFromBsonObjContent(be.embeddedObject(), nodeP, be.type() == mongo::Array) == false)
+      return NULL;
+    break;
+
+  case mongo::NumberLong:
+    {
+      char* longString = (char*) kaAlloc(&orionldState.kalloc, 24);
+
+      snprintf(longString, 24, "%lld", be._numberLong());
+      nodeP = kjObject(orionldState.kjsonP, name);
+      kjChildAdd(nodeP, kjString(orionldState.kjsonP, "$numberLong", longString));
+    }
+    break;
+
+  case mongo::jstOID:
+    nodeP = kjObject(orionldState.kjsonP, name);
+    kjChildAdd(nodeP, kjString(orionldState.kjsonP, "$oid", kaStrdup(&orionldState.kalloc, be.OID().toString().c_str())));
+    break;
+
+  default:
+    {
+      char* json = kaStrdup(&orionldState.kalloc, (char*) be.jsonString(mongo::Strict, false).c_str());
+
+      nodeP = kjParse(orionldState.kjsonP, json);
+      if (nodeP != NULL)
+        nodeP->name = (char*) name;
+    }
+    break;
+  }
+
+  return nodeP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjTreeFromBsonObjContent - add all elements of a BSONObj as children of a KjNode container
+//
+static bool kjTreeFromBsonObjContent(const mongo::BSONObj& bsonObj, KjNode* containerP, bool isArray)
+{
+  mongo::BSONObjIterator iter(bsonObj);
+
+  while (iter.more())
+  {
+    mongo::BSONElement  be    = iter.next();
+    KjNode*             nodeP = kjNodeFromBsonElement(be, (isArray == true)? NULL : be.fieldName());
+
+    if (nodeP == NULL)
+      return false;
+
+    kjChildAdd(containerP, nodeP);
+  }
+
+  return true;
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // mongoCppLegacyKjTreeFromBsonObj -
 //
+// The BSON data is copied to orionldState.kalloc (a single memcpy) and the KjNode tree is built walking the
+// elements of the copy. This way, field names and strings of the tree can point into the copy and live as
+// long as the request, without having to render the BSONObj as JSON and parse it back.
+//
 KjNode* mongoCppLegacyKjTreeFromBsonObj(const void* dataP, char** titleP, char** detailsP)
 {
-  mongo::BSONObj* bsonObjP = (mongo::BSONObj*) dataP;
-  KjNode*         treeP    = NULL;
+  mongo::BSONObj*  bsonObjP = (mongo::BSONObj*) dataP;
+  int              size     = bsonObjP->objsize();
+  char*            data     = (char*) kaAlloc(&orionldState.kalloc, size);
 
-  std::string jsonString = bsonObjP->jsonString();
-
-  if (jsonString == "")
+  if (data == NULL)
   {
     *titleP   = (char*) "Internal Error";
-    *detailsP = (char*) "Error creating JSON from BSONObj";
+    *detailsP = (char*) "Out of memory copying BSONObj";
+    return NULL;
   }
-  else
+
+  memcpy(data, bsonObjP->objdata(), size);
+
+  mongo::BSONObj  bsonObj(data);
+  KjNode*         treeP = kjObject(orionldState.kjsonP, NULL);
+
+  if (kjTreeFromBsonObjContent(bsonObj, treeP, false) == false)
   {
-    orionldState.jsonBuf = kaStrdup(&orionldState.kalloc, (char*) jsonString.c_str());
-    treeP = kjParse(orionldState.kjsonP, orionldState.jsonBuf);
-    if (treeP == NULL)
-    {
-      *titleP   = (char*) "Internal Error";
-      *detailsP = (char*) "Error parsing JSON output from bson_as_json";
-    }
+    *titleP   = (char*) "Internal Error";
+    *detailsP = (char*) "Error creating KjNode tree from BSONObj";
+    return NULL;
   }
 
   return treeP;
@@ -0,0 +1,93 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+#include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection, ...
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/db/dbCollectionPathGet.h"                      // dbCollectionPathGet
+#include "orionld/db/dbConfiguration.h"                          // dbDataToKjTree
+#include "orionld/mongoCppLegacy/mongoCppLegacyRegistrationListGet.h"   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoCppLegacyRegistrationListGet - get all registrations of the tenant
+//
+//   db.registrations.find({})
+//
+// RETURN VALUE
+//   A KjNode array with all the registrations of the tenant (orionldState.tenant) - empty array if there are none
+//   NULL if the database could not be queried
+//
+KjNode* mongoCppLegacyRegistrationListGet(void)
+{
+  char    collectionPath[256];
+  KjNode* kjRegArray;
+
+  if (dbCollectionPathGet(collectionPath, sizeof(collectionPath), "registrations") == -1)
+    return NULL;
+
+  kjRegArray = kjArray(orionldState.kjsonP, NULL);
+
+  mongo::DBClientBase*                  connectionP = getMongoConnection();
+  std::auto_ptr<mongo::DBClientCursor>  cursorP;
+  mongo::Query                          query;
+
+  try
+  {
+    cursorP = connectionP->query(collectionPath, query);
+
+    while (cursorP->more())
+    {
+      mongo::BSONObj  bsonObj = cursorP->nextSafe();
+      char*           title;
+      char*           details;
+      KjNode*         kjTree = dbDataToKjTree(&bsonObj, &title, &details);
+
+      if (kjTree == NULL)
+        LM_E(("%s: %s", title, details));
+      else
+        kjChildAdd(kjRegArray, kjTree);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    LM_E(("Database Error (querying '%s': %s)", collectionPath, e.what()));
+    kjRegArray = NULL;
+  }
+
+  releaseMongoConnection(connectionP);
+
+  return kjRegArray;
+}
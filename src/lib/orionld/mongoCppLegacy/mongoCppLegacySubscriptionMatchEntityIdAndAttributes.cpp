@@ -94,7 +94,7 @@ void mongoCppLegacySubscriptionMatchEntityIdAndAttributes
 
 
   // "expiration" - later
-  // "q" - later
+  // "q" - only evaluated (in-memory, see qCompiledMatch) when the subscription cache is used
   // "geometry" - later
 
 
@@ -107,8 +107,6 @@ void mongoCppLegacySubscriptionMatchEntityIdAndAttributes
 
   cursorP = connectionP->query(collectionPath, query);
 
-  int niIx = 0;
-
   while (cursorP->more())
   {
     mongo::BSONObj            bsonObj;
@@ -129,12 +127,7 @@ void mongoCppLegacySubscriptionMatchEntityIdAndAttributes
     // Found a matching subscription - now the caller of this function can do whatever he/she needs to do with it
     //
     subMatchCallback(entityId, subscriptionTree, currentEntityTree, incomingRequestTree);
-
-    //
-    // A maximum of 100 notifications has been agreed (agreed in solitary by KZ :-D)
-    //
-    ++niIx;
-    if (niIx >= 100)
-      break;
   }
+
+  releaseMongoConnection(connectionP);
 }
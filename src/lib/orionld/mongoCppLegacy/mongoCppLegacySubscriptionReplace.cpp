@@ -32,14 +32,41 @@ extern "C"
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
+#include "common/globals.h"                                      // noCache
+#include "common/sem.h"                                          // cacheSemTake, cacheSemGive
+#include "cache/subCache.h"                                      // subCacheItemLookup, subCacheItemRemove
 #include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection, ...
+#include "mongoBackend/mongoSubCache.h"                          // mongoSubCacheItemInsert
 
+#include "orionld/common/orionldState.h"                         // orionldState
 #include "orionld/db/dbCollectionPathGet.h"                      // dbCollectionPathGet
 #include "orionld/db/dbConfiguration.h"                          // dbDataToKjTree, dbDataFromKjTree
 #include "orionld/mongoCppLegacy/mongoCppLegacySubscriptionReplace.h"   // Own interface
 
 
 
+// -----------------------------------------------------------------------------
+//
+// subCacheItemReplace - replace the cached copy of a subscription with what was just written to the database
+//
+static void subCacheItemReplace(const char* subscriptionId, const mongo::BSONObj& subscription)
+{
+  const char* tenant = (orionldState.tenant != NULL)? orionldState.tenant : "";
+
+  cacheSemTake(__FUNCTION__, "Replacing subscription in cache");
+
+  CachedSubscription* cSubP = subCacheItemLookup(tenant, subscriptionId);
+  if (cSubP != NULL)
+    subCacheItemRemove(cSubP);
+
+  if (mongoSubCacheItemInsert(tenant, subscription) != 0)
+    LM_E(("Internal Error (unable to insert the subscription '%s' in the subscription cache)", subscriptionId));
+
+  cacheSemGive(__FUNCTION__, "Replacing subscription in cache");
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // mongoCppLegacySubscriptionReplace -
@@ -62,9 +89,12 @@ bool mongoCppLegacySubscriptionReplace(const char* subscriptionId, KjNode* dbSub
   mongo::DBClientBase*  connectionP = getMongoConnection();
   mongo::Query          query(filter.obj());
 
+  bool                  updated     = false;
+
   try
   {
     connectionP->update(collectionPath, query, payloadAsBsonObj, false, false);
+    updated = true;
   }
   catch (const std::exception &e)
   {
@@ -74,5 +104,11 @@ bool mongoCppLegacySubscriptionReplace(const char* subscriptionId, KjNode* dbSub
   releaseMongoConnection(connectionP);
   // semGive()
 
+  //
+  // The subscription cache must reflect the change, as subscriptions are matched using the cache
+  //
+  if ((updated == true) && (noCache == false))
+    subCacheItemReplace(subscriptionId, payloadAsBsonObj);
+
   return false;
 }
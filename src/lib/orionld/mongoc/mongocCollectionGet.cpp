@@ -0,0 +1,54 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/db/dbNameGet.h"                                // dbNameGet
+#include "orionld/mongoc/mongocConnectionGet.h"                  // mongocConnectionGet
+#include "orionld/mongoc/mongocCollectionGet.h"                  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocCollectionGet - get a handle to a collection of the database of the tenant of the current request
+//
+// The handle must be freed by the caller, using mongoc_collection_destroy()
+//
+mongoc_collection_t* mongocCollectionGet(const char* collectionName)
+{
+  char                  dbName[512];
+  mongoc_collection_t*  collectionP;
+
+  if (dbNameGet(dbName, sizeof(dbName)) == -1)
+    return NULL;
+
+  if ((collectionP = mongoc_client_get_collection(mongocConnectionGet(), dbName, collectionName)) == NULL)
+    LM_E(("Database Error (mongoc_client_get_collection(%s, %s) failed)", dbName, collectionName));
+
+  return collectionP;
+}
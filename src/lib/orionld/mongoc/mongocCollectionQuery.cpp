@@ -0,0 +1,98 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/db/dbConfiguration.h"                          // dbDataToKjTree
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocCollectionQuery.h"                // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocCollectionQuery - find documents in a collection and return them as a KjNode array
+//
+// PARAMETERS
+//   collectionName  - "entities", "registrations", "csubs", ...
+//   filterP         - the query filter
+//   optsP           - options for mongoc_collection_find_with_opts (projection, sort, skip, limit), or NULL
+//
+// RETURN VALUE
+//   A KjNode array with the documents - empty array if there are no matches
+//   NULL if the database could not be queried
+//
+KjNode* mongocCollectionQuery(const char* collectionName, const bson_t* filterP, const bson_t* optsP)
+{
+  mongoc_collection_t*  collectionP;
+  mongoc_cursor_t*      cursorP;
+  const bson_t*         docP;
+  bson_error_t          mongoError;
+  KjNode*               docArray;
+
+  if ((collectionP = mongocCollectionGet(collectionName)) == NULL)
+    return NULL;
+
+  if ((cursorP = mongoc_collection_find_with_opts(collectionP, filterP, optsP, NULL)) == NULL)
+  {
+    LM_E(("Internal Error (mongoc_collection_find_with_opts failed for collection '%s')", collectionName));
+    mongoc_collection_destroy(collectionP);
+    return NULL;
+  }
+
+  docArray = kjArray(orionldState.kjsonP, NULL);
+
+  while (mongoc_cursor_next(cursorP, &docP))
+  {
+    char*    title;
+    char*    details;
+    KjNode*  docNodeP = dbDataToKjTree(docP, &title, &details);
+
+    if (docNodeP == NULL)
+      LM_E(("%s: %s", title, details));
+    else
+      kjChildAdd(docArray, docNodeP);
+  }
+
+  if (mongoc_cursor_error(cursorP, &mongoError))
+  {
+    LM_E(("Database Error (querying '%s': %s)", collectionName, mongoError.message));
+    docArray = NULL;
+  }
+
+  mongoc_cursor_destroy(cursorP);
+  mongoc_collection_destroy(collectionP);
+
+  return docArray;
+}
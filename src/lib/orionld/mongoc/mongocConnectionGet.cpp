@@ -0,0 +1,51 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, mongocPool
+#include "orionld/mongoc/mongocConnectionGet.h"                  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocConnectionGet - get the connection to the database for the current request
+//
+// A mongoc_client_t is not thread-safe, so each request thread pops a client from the pool the first time it
+// needs the database and keeps it in orionldState until the request is done.
+// mongocConnectionRelease (called by orionldStateRelease) gives it back to the pool.
+//
+// mongoc_client_pool_pop blocks if all clients of the pool are in use (the size of the pool is -dbPoolSize).
+//
+mongoc_client_t* mongocConnectionGet(void)
+{
+  if (orionldState.mongoClient == NULL)
+    orionldState.mongoClient = mongoc_client_pool_pop(mongocPool);
+
+  return orionldState.mongoClient;
+}
@@ -0,0 +1,264 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // strtod
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "mongoBackend/connectionOperations.h"                   // ESTIMATED_COUNT_MAX
+#include "orionld/common/SCOMPARE.h"                             // SCOMPAREx
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocCollectionQuery.h"                // mongocCollectionQuery
+#include "orionld/mongoc/mongocEntitiesQuery.h"                  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// entitiesCount - count the entities matching the filter
+//
+// With 'estimated' set, the count stops at ESTIMATED_COUNT_MAX - for an empty filter the collection metadata is used
+//
+static bool entitiesCount(const bson_t* filterP, bool estimated, long long* countP)
+{
+  mongoc_collection_t*  collectionP;
+  bson_error_t          mongoError;
+  int64_t               count;
+
+  if ((collectionP = mongocCollectionGet("entities")) == NULL)
+    return false;
+
+  if ((estimated == true) && (bson_count_keys(filterP) == 0))
+    count = mongoc_collection_estimated_document_count(collectionP, NULL, NULL, NULL, &mongoError);
+  else
+  {
+    bson_t options;
+
+    bson_init(&options);
+    if (estimated == true)
+      bson_append_int64(&options, "limit", 5, ESTIMATED_COUNT_MAX);
+
+    count = mongoc_collection_count_documents(collectionP, filterP, &options, NULL, NULL, &mongoError);
+    bson_destroy(&options);
+  }
+
+  mongoc_collection_destroy(collectionP);
+
+  if (count == -1)
+  {
+    LM_E(("Database Error (counting entities: %s)", mongoError.message));
+    return false;
+  }
+
+  *countP = count;
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// keysetFilterAppend - append the condition for "entities sorted after the cursor" to a filter
+//
+//   "$or": [
+//     { "creDate": { "$gt": C } },
+//     { "creDate": C, "_id.id": { "$gt": ID } },
+//     { "creDate": C, "_id.id": ID, "_id.type": { "$gt": TYPE } }
+//   ]
+//
+static void keysetFilterAppend(bson_t* filterP, char** cursorV)
+{
+  double  creDate = strtod(cursorV[0], NULL);
+  bson_t  orArray;
+  bson_t  after;
+  bson_t  gt;
+
+  bson_append_array_begin(filterP, "$or", 3, &orArray);
+
+  bson_append_document_begin(&orArray, "0", 1, &after);
+  bson_append_document_begin(&after, "creDate", 7, &gt);
+  bson_append_double(&gt, "$gt", 3, creDate);
+  bson_append_document_end(&after, &gt);
+  bson_append_document_end(&orArray, &after);
+
+  bson_append_document_begin(&orArray, "1", 1, &after);
+  bson_append_double(&after, "creDate", 7, creDate);
+  bson_append_document_begin(&after, "_id.id", 6, &gt);
+  bson_append_utf8(&gt, "$gt", 3, cursorV[1], -1);
+  bson_append_document_end(&after, &gt);
+  bson_append_document_end(&orArray, &after);
+
+  bson_append_document_begin(&orArray, "2", 1, &after);
+  bson_append_double(&after, "creDate", 7, creDate);
+  bson_append_utf8(&after, "_id.id", 6, cursorV[1], -1);
+  bson_append_document_begin(&after, "_id.type", 8, &gt);
+  bson_append_utf8(&gt, "$gt", 3, cursorV[2], -1);
+  bson_append_document_end(&after, &gt);
+  bson_append_document_end(&orArray, &after);
+
+  bson_append_array_end(filterP, &orArray);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntitiesQuery - query the entities collection, returning the raw DB entities as a KjNode array
+//
+// Same filter, sort order and keyset pagination as mongoCppLegacyEntitiesQuery - see that function for the details.
+//
+// The q filter (orionldState.qMongoFilterP) is still built as a mongo::BSONObj, but as the BSON wire format is the
+// same for both drivers, its data is appended to the filter as is.
+//
+// RETURN VALUE
+//   A KjNode array with the DB entities - empty array if there are no matches
+//   NULL if the database could not be queried
+//
+KjNode* mongocEntitiesQuery(KjNode* entitySelectorArray, KjNode* attrsArray, char** cursorV, int offset, int limit, long long* countP, bool countEstimated)
+{
+  bson_t    filter;
+  bson_t    orArray;
+  uint32_t  index = 0;
+
+  bson_init(&filter);
+  bson_append_array_begin(&filter, "$or", 3, &orArray);
+
+  for (KjNode* selectorP = entitySelectorArray->value.firstChildP; selectorP != NULL; selectorP = selectorP->next)
+  {
+    char         indexBuf[16];
+    const char*  key;
+    bson_t       entity;
+
+    bson_uint32_to_string(index, &key, indexBuf, sizeof(indexBuf));
+    bson_append_document_begin(&orArray, key, -1, &entity);
+
+    for (KjNode* itemP = selectorP->value.firstChildP; itemP != NULL; itemP = itemP->next)
+    {
+      if (SCOMPARE3(itemP->name, 'i', 'd', 0))
+        bson_append_utf8(&entity, "_id.id", 6, itemP->value.s, -1);
+      else if (SCOMPARE10(itemP->name, 'i', 'd', 'P', 'a', 't', 't', 'e', 'r', 'n', 0))
+        bson_append_regex(&entity, "_id.id", 6, itemP->value.s, NULL);
+      else if (SCOMPARE5(itemP->name, 't', 'y', 'p', 'e', 0))
+        bson_append_utf8(&entity, "_id.type", 8, itemP->value.s, -1);
+      else if (SCOMPARE12(itemP->name, 't', 'y', 'p', 'e', 'P', 'a', 't', 't', 'e', 'r', 'n', 0))
+        bson_append_regex(&entity, "_id.type", 8, itemP->value.s, NULL);
+    }
+
+    bson_append_document_end(&orArray, &entity);
+    ++index;
+  }
+
+  bson_append_array_end(&filter, &orArray);
+
+  if ((attrsArray != NULL) && (attrsArray->value.firstChildP != NULL))
+  {
+    bson_t inObj;
+    bson_t attrNames;
+
+    index = 0;
+    bson_append_document_begin(&filter, "attrNames", 9, &inObj);
+    bson_append_array_begin(&inObj, "$in", 3, &attrNames);
+    for (KjNode* attrP = attrsArray->value.firstChildP; attrP != NULL; attrP = attrP->next)
+    {
+      char         indexBuf[16];
+      const char*  key;
+
+      bson_uint32_to_string(index, &key, indexBuf, sizeof(indexBuf));
+      bson_append_utf8(&attrNames, key, -1, attrP->value.s, -1);
+      ++index;
+    }
+    bson_append_array_end(&inObj, &attrNames);
+    bson_append_document_end(&filter, &inObj);
+  }
+
+  if (orionldState.qMongoFilterP != NULL)
+  {
+    bson_t qFilter;
+
+    if (bson_init_static(&qFilter, (const uint8_t*) orionldState.qMongoFilterP->objdata(), orionldState.qMongoFilterP->objsize()) == true)
+      bson_concat(&filter, &qFilter);
+  }
+
+  //
+  // The count is made without the cursor, on all matching entities
+  //
+  if ((countP != NULL) && (entitiesCount(&filter, countEstimated, countP) == false))
+  {
+    bson_destroy(&filter);
+    return NULL;
+  }
+
+  //
+  // With a cursor, the page starts right after the entity the cursor points to: { "$and": [ FILTER, KEYSET_FILTER ] }
+  //
+  bson_t   keysetFilter;
+  bson_t*  queryFilterP = &filter;
+
+  bson_init(&keysetFilter);
+
+  if (cursorV != NULL)
+  {
+    bson_t  andArray;
+    bson_t  afterCursor;
+
+    bson_append_array_begin(&keysetFilter, "$and", 4, &andArray);
+    bson_append_document(&andArray, "0", 1, &filter);
+    bson_append_document_begin(&andArray, "1", 1, &afterCursor);
+    keysetFilterAppend(&afterCursor, cursorV);
+    bson_append_document_end(&andArray, &afterCursor);
+    bson_append_array_end(&keysetFilter, &andArray);
+
+    queryFilterP = &keysetFilter;
+    offset       = 0;
+  }
+
+  bson_t   options;
+  bson_t   sort;
+  KjNode*  entityArray;
+
+  bson_init(&options);
+  bson_append_document_begin(&options, "sort", 4, &sort);
+  bson_append_int32(&sort, "creDate",  7, 1);
+  bson_append_int32(&sort, "_id.id",   6, 1);
+  bson_append_int32(&sort, "_id.type", 8, 1);
+  bson_append_document_end(&options, &sort);
+  bson_append_int64(&options, "skip",  4, offset);
+  bson_append_int64(&options, "limit", 5, limit);
+
+  entityArray = mongocCollectionQuery("entities", queryFilterP, &options);
+
+  bson_destroy(&options);
+  bson_destroy(&keysetFilter);
+  bson_destroy(&filter);
+
+  return entityArray;
+}
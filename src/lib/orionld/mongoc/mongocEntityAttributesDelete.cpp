@@ -0,0 +1,115 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <string.h>                                              // strlen
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/eqForDot.h"                             // eqForDot
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocEntityAttributesDelete.h"         // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntityAttributesDelete -
+//
+// db.entities.updateOne(
+//   { "_id.id": "urn:ngsi-ld:entities:E1" },
+//   {
+//     "$unset": { "attrs.https://uri=etsi=org/ngsi-ld/default-context/P1": 1, "attrs.https://uri=etsi=org/ngsi-ld/default-context/P2": 1 },
+//     "$pull":  { "attrNames": { "$in": [ "https://uri.etsi.org/ngsi-ld/default-context/P1", "https://uri.etsi.org/ngsi-ld/default-context/P2" ] } }
+//   }
+// )
+//
+bool mongocEntityAttributesDelete(const char* entityId, char** attrNameV, int vecSize)
+{
+  mongoc_collection_t*  collectionP;
+  bson_t                selector;
+  bson_t                update;
+  bson_t                unset;
+  bson_t                pull;
+  bson_t                pullIn;
+  bson_t                pullInVec;
+  bson_error_t          mongoError;
+  bool                  ok;
+
+  if ((collectionP = mongocCollectionGet("entities")) == NULL)
+    return false;
+
+  bson_init(&selector);
+  bson_init(&update);
+  bson_append_utf8(&selector, "_id.id", 6, entityId, -1);
+
+  //
+  // Attributes to remove from 'attrs', using $unset
+  // Due to the database model, we also need to remove the attributes from 'attrNames', using $pull
+  //
+  bson_append_document_begin(&update, "$unset", 6, &unset);
+  for (int ix = 0; ix < vecSize; ix++)
+  {
+    int   mongoPathLen  = 6 + strlen(attrNameV[ix]) + 1;  // 6 == strlen("attrs."), 1 == zero-termination
+    char* mongoPath     = (char*) kaAlloc(&orionldState.kalloc, mongoPathLen);
+
+    snprintf(mongoPath, mongoPathLen, "attrs.%s", attrNameV[ix]);
+    bson_append_int32(&unset, mongoPath, -1, 1);
+  }
+  bson_append_document_end(&update, &unset);
+
+  bson_append_document_begin(&update, "$pull", 5, &pull);
+  bson_append_document_begin(&pull, "attrNames", 9, &pullIn);
+  bson_append_array_begin(&pullIn, "$in", 3, &pullInVec);
+  for (int ix = 0; ix < vecSize; ix++)
+  {
+    char         indexBuf[16];
+    const char*  key;
+
+    eqForDot(attrNameV[ix]);
+    bson_uint32_to_string(ix, &key, indexBuf, sizeof(indexBuf));
+    bson_append_utf8(&pullInVec, key, -1, attrNameV[ix], -1);
+  }
+  bson_append_array_end(&pullIn, &pullInVec);
+  bson_append_document_end(&pull, &pullIn);
+  bson_append_document_end(&update, &pull);
+
+  ok = mongoc_collection_update_one(collectionP, &selector, &update, NULL, NULL, &mongoError);
+  if (ok == false)
+    LM_E(("Database Error (deleting attributes of entity '%s': %s)", entityId, mongoError.message));
+
+  bson_destroy(&update);
+  bson_destroy(&selector);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
@@ -0,0 +1,86 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocEntityBatchDelete.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntityBatchDelete - remove a list of entities, in one single unordered bulk write
+//
+bool mongocEntityBatchDelete(KjNode* entityIdsArray)
+{
+  mongoc_collection_t*      collectionP;
+  mongoc_bulk_operation_t*  bulkP;
+  bson_t                    bulkOptions;
+  bson_error_t              mongoError;
+  bool                      ok = true;
+
+  if ((collectionP = mongocCollectionGet("entities")) == NULL)
+    return false;
+
+  bson_init(&bulkOptions);
+  bson_append_bool(&bulkOptions, "ordered", 7, false);
+  bulkP = mongoc_collection_create_bulk_operation_with_opts(collectionP, &bulkOptions);
+
+  for (KjNode* idNodeP = entityIdsArray->value.firstChildP; idNodeP != NULL; idNodeP = idNodeP->next)
+  {
+    bson_t selector;
+
+    bson_init(&selector);
+    bson_append_utf8(&selector, "_id.id", 6, idNodeP->value.s, -1);
+
+    if (mongoc_bulk_operation_remove_many_with_opts(bulkP, &selector, NULL, &mongoError) == false)
+    {
+      LM_E(("Database Error (adding removal of '%s' to bulk operation: %s)", idNodeP->value.s, mongoError.message));
+      ok = false;
+    }
+
+    bson_destroy(&selector);
+  }
+
+  if ((ok == true) && (entityIdsArray->value.firstChildP != NULL) && (mongoc_bulk_operation_execute(bulkP, NULL, &mongoError) == 0))
+  {
+    LM_E(("Database Error (bulk removal of entities: %s)", mongoError.message));
+    ok = false;
+  }
+
+  mongoc_bulk_operation_destroy(bulkP);
+  bson_destroy(&bulkOptions);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
@@ -0,0 +1,133 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <bson/bson.h>                                           // BSON
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjObject, kjString, kjInteger, kjChildAdd
+#include "kjson/kjLookup.h"                                      // kjLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/mongoc/mongocCollectionQuery.h"                // mongocCollectionQuery
+#include "orionld/mongoc/mongocEntityListLookupWithIdTypeCreDate.h" // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntityListLookupWithIdTypeCreDate -
+//
+// This function extracts (from mongo) the entities whose ID are in the vector 'entityIdsArray'.
+// Instead of returning the complete information of the entities, only four fields are returned per entity, namely:
+//   * Entity ID
+//   * Entity Type
+//   * Entity Service Path (if present in the database)
+//   * Entity Creation Date
+//
+//   db.entities.find({ "_id.id": { "$in": [ IDS ] } }, { "_id": 1, "creDate": 1 }).limit(100)
+//
+// RETURN VALUE
+//   A KjNode array of { "id", "type", "servicePath", "creDate" } - NULL if no entity was found
+//
+KjNode* mongocEntityListLookupWithIdTypeCreDate(KjNode* entityIdsArray)
+{
+  bson_t    mongoFilter;
+  bson_t    inObj;
+  bson_t    idList;
+  bson_t    options;
+  bson_t    projection;
+  uint32_t  index = 0;
+  KjNode*   dbEntityArray;
+
+  bson_init(&mongoFilter);
+  bson_init(&options);
+
+  bson_append_document_begin(&mongoFilter, "_id.id", 6, &inObj);
+  bson_append_array_begin(&inObj, "$in", 3, &idList);
+  for (KjNode* idNodeP = entityIdsArray->value.firstChildP; idNodeP != NULL; idNodeP = idNodeP->next)
+  {
+    char         indexBuf[16];
+    const char*  key;
+
+    bson_uint32_to_string(index, &key, indexBuf, sizeof(indexBuf));
+    bson_append_utf8(&idList, key, -1, idNodeP->value.s, -1);
+    ++index;
+  }
+  bson_append_array_end(&inObj, &idList);
+  bson_append_document_end(&mongoFilter, &inObj);
+
+  //
+  // Only "_id" ("id", "type" and "servicePath" are inside "_id") and "creDate" are returned.
+  // A limit of 100 entities has been established.
+  //
+  bson_append_document_begin(&options, "projection", 10, &projection);
+  bson_append_int32(&projection, "_id",     3, 1);
+  bson_append_int32(&projection, "creDate", 7, 1);
+  bson_append_document_end(&options, &projection);
+  bson_append_int32(&options, "limit", 5, 100);
+
+  dbEntityArray = mongocCollectionQuery("entities", &mongoFilter, &options);
+
+  bson_destroy(&options);
+  bson_destroy(&mongoFilter);
+
+  if ((dbEntityArray == NULL) || (dbEntityArray->value.firstChildP == NULL))
+    return NULL;
+
+  KjNode* entitiesArray = kjArray(orionldState.kjsonP, NULL);
+
+  for (KjNode* dbEntityP = dbEntityArray->value.firstChildP; dbEntityP != NULL; dbEntityP = dbEntityP->next)
+  {
+    KjNode* idObjectP = kjLookup(dbEntityP, "_id");
+    KjNode* idP       = (idObjectP != NULL)? kjLookup(idObjectP, "id")   : NULL;
+    KjNode* typeP     = (idObjectP != NULL)? kjLookup(idObjectP, "type") : NULL;
+    KjNode* spP       = (idObjectP != NULL)? kjLookup(idObjectP, "servicePath") : NULL;
+    KjNode* creDateP  = kjLookup(dbEntityP, "creDate");
+
+    if ((idP == NULL) || (typeP == NULL) || (creDateP == NULL))
+    {
+      LM_E(("Database Error (entity without id, type or creDate)"));
+      continue;
+    }
+
+    KjNode* entityTree   = kjObject(orionldState.kjsonP, NULL);
+    int     creDate      = (creDateP->type == KjFloat)? (int) creDateP->value.f : (int) creDateP->value.i;
+
+    kjChildAdd(entityTree, kjString(orionldState.kjsonP,  "id",      idP->value.s));
+    kjChildAdd(entityTree, kjString(orionldState.kjsonP,  "type",    typeP->value.s));
+    if (spP != NULL)
+      kjChildAdd(entityTree, kjString(orionldState.kjsonP, "servicePath", spP->value.s));
+    kjChildAdd(entityTree, kjInteger(orionldState.kjsonP, "creDate", creDate));
+
+    kjChildAdd(entitiesArray, entityTree);
+  }
+
+  return entitiesArray;
+}
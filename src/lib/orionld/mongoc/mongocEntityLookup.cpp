@@ -22,20 +22,19 @@
 *
 * Author: Ken Zangelin
 */
-#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+#include <bson/bson.h>                                           // BSON
 
 extern "C"
 {
 #include "kjson/KjNode.h"                                        // KjNode
-#include "kjson/kjRender.h"                                      // kjRender - TMP
 }
 
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/common/orionldState.h"                         // orionldState, dbName, mongoEntitiesCollectionP
-#include "orionld/db/dbConfiguration.h"                          // dbDataToKjTree
-#include "orionld/db/dbNameGet.h"                                // dbNameGet
+#include "orionld/mongoc/mongocCollectionQuery.h"                // mongocCollectionQuery
+#include "orionld/mongoc/mongocEntityRelationshipObjectFix.h"    // mongocEntityRelationshipObjectFix
+#include "orionld/mongoc/mongocEntityLookup.h"                   // Own interface
 
 
 
@@ -43,50 +42,31 @@ extern "C"
 //
 // mongocEntityLookup -
 //
+//   db.entities.find({ "_id.id": ENTITY_ID }).limit(1)
+//
 KjNode* mongocEntityLookup(const char* entityId)
-{    
-  char              dbName[512];
-  bson_t            mongoFilter;
-  const bson_t*     mongoDocP;
-  mongoc_cursor_t*  mongoCursorP;
-  bson_error_t      mongoError;
-  char*             title;
-  char*             details;
-  KjNode*           entityNodeP = NULL;
-  
-  if (dbNameGet(dbName, sizeof(dbName)) == -1)
-    return NULL;
+{
+  bson_t   mongoFilter;
+  bson_t   options;
+  KjNode*  entityArray;
+  KjNode*  entityNodeP;
 
-  //
-  // Create the filter for the query
-  //
-  bson_append_utf8(&mongoFilter, "_id.id", 3, entityId, -1);
+  bson_init(&mongoFilter);
+  bson_init(&options);
 
-  //
-  // Run the query
-  //
-  // semTake(&mongoEntitiesSem);
-  if ((mongoCursorP = mongoc_collection_find_with_opts(mongoEntitiesCollectionP, &mongoFilter, NULL, NULL)) == NULL)
-  {
-    LM_E(("Internal Error (mongoc_collection_find_with_opts ERROR)"));
-    return NULL;
-  }
+  bson_append_utf8(&mongoFilter, "_id.id", 6, entityId, -1);
+  bson_append_int32(&options, "limit", 5, 1);
 
-  while (mongoc_cursor_next(mongoCursorP, &mongoDocP))
-  {
-    entityNodeP = dbDataToKjTree(mongoDocP, &title, &details);
-    break;  // Just using the first one - should be no more than one!
-  }
+  entityArray = mongocCollectionQuery("entities", &mongoFilter, &options);
 
-  if (mongoc_cursor_error(mongoCursorP, &mongoError))
-  {
-    LM_E(("Internal Error (DB Error '%s')", mongoError.message));
+  bson_destroy(&options);
+  bson_destroy(&mongoFilter);
+
+  if ((entityArray == NULL) || ((entityNodeP = entityArray->value.firstChildP) == NULL))
     return NULL;
-  }
 
-  mongoc_cursor_destroy(mongoCursorP);
-  // semGive(&mongoEntitiesSem);
-  bson_destroy(&mongoFilter);
- 
+  entityNodeP->next = NULL;
+  mongocEntityRelationshipObjectFix(entityNodeP);
+
   return entityNodeP;
 }
@@ -0,0 +1,84 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjLookup.h"                                      // kjLookup
+}
+
+#include "orionld/mongoc/mongocEntityRelationshipObjectFix.h"    // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// relationshipObjectFix - rename "value" to "object" if the attribute/sub-attribute is a Relationship
+//
+static void relationshipObjectFix(KjNode* attrP)
+{
+  KjNode* typeP = kjLookup(attrP, "type");
+
+  if ((typeP != NULL) && (typeP->type == KjString) && (strcmp(typeP->value.s, "Relationship") == 0))
+  {
+    KjNode* valueP = kjLookup(attrP, "value");
+
+    if (valueP != NULL)
+      valueP->name = (char*) "object";
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntityRelationshipObjectFix -
+//
+// Change "value" to "object" for all attributes (and metadata) that are "Relationship".
+// Note that the "object" field of a Relationship is stored in the database under the field "value".
+// That fact is fixed here, by renaming the "value" to "object" for attr with type == Relationship.
+// This depends on the database model and thus should be fixed in the database layer.
+//
+void mongocEntityRelationshipObjectFix(KjNode* dbEntityP)
+{
+  KjNode* attrsP = kjLookup(dbEntityP, "attrs");
+
+  if (attrsP == NULL)
+    return;
+
+  for (KjNode* attrP = attrsP->value.firstChildP; attrP != NULL; attrP = attrP->next)
+  {
+    KjNode* mdsP = kjLookup(attrP, "md");
+
+    relationshipObjectFix(attrP);
+
+    if (mdsP != NULL)
+    {
+      for (KjNode* mdP = mdsP->value.firstChildP; mdP != NULL; mdP = mdP->next)
+        relationshipObjectFix(mdP);
+    }
+  }
+}
@@ -32,17 +32,42 @@ extern "C"
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/db/dbNameGet.h"                                // dbNameGet
+#include "orionld/db/dbConfiguration.h"                          // dbDataFromKjTree
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
 #include "orionld/mongoc/mongocEntityUpdate.h"                   // Own interface
 
 
 
 // -----------------------------------------------------------------------------
 //
-// mongocEntityUpdate -
+// mongocEntityUpdate - replace an entity in the database
+//
+//   db.entities.replaceOne({ "_id.id": ENTITY_ID }, REQUEST_TREE)
+//
+// 'requestTree' is the complete DB entity (as the Legacy C++ driver, no upsert)
 //
 bool mongocEntityUpdate(const char* entityId, KjNode* requestTree)
 {
-  LM_E(("mongocEntityUpdate is not implemented"));
-  return false;
+  mongoc_collection_t*  collectionP;
+  bson_t                selector;
+  bson_t                replacement;
+  bson_error_t          mongoError;
+  bool                  ok;
+
+  if ((collectionP = mongocCollectionGet("entities")) == NULL)
+    return false;
+
+  bson_init(&selector);
+  bson_append_utf8(&selector, "_id.id", 6, entityId, -1);
+  dbDataFromKjTree(requestTree, &replacement);
+
+  ok = mongoc_collection_replace_one(collectionP, &selector, &replacement, NULL, NULL, &mongoError);
+  if (ok == false)
+    LM_E(("Database Error (replacing entity '%s': %s)", entityId, mongoError.message));
+
+  bson_destroy(&replacement);
+  bson_destroy(&selector);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
 }
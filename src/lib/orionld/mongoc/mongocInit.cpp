@@ -22,12 +22,56 @@
 *
 * Author: Ken Zangelin
 */
+#include <stdio.h>                                               // snprintf
+#include <string.h>                                              // strchr
 #include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
 
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/orionldState.h"                         // mongocUri, mongocPool, dbUser, dbPwd, dbPoolSize
+#include "orionld/mongoc/mongocInit.h"                           // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// uriEscape - percent-encode all characters of 's' that aren't 'unreserved' in a URI (RFC 3986)
+//
+// A user name or password with e.g. '@', ':' or '/' would otherwise break the connection string.
+// The output is truncated (never a half escape sequence) if 'out' is too small.
+//
+static char* uriEscape(const char* s, char* out, int outSize)
+{
+  static const char* hex = "0123456789ABCDEF";
+  int                ix  = 0;
+
+  for (; *s != 0; ++s)
+  {
+    unsigned char c = (unsigned char) *s;
+
+    if (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || ((c != 0) && (strchr("-._~", c) != NULL)))
+    {
+      if (ix + 1 >= outSize)
+        break;
+
+      out[ix++] = c;
+    }
+    else
+    {
+      if (ix + 3 >= outSize)
+        break;
+
+      out[ix++] = '%';
+      out[ix++] = hex[c >> 4];
+      out[ix++] = hex[c & 0xF];
+    }
+  }
+
+  out[ix] = 0;
+
+  return out;
+}
 
 
 
@@ -35,12 +79,28 @@
 //
 // mongocInit -
 //
+// One single client pool is created for the entire broker.
+// Each request thread pops a client from the pool when it first needs the database (mongocConnectionGet) and
+// pushes it back when the request is done (mongocConnectionRelease).
+// The collections are looked up per request, as the name of the database depends on the tenant.
+//
 void mongocInit(const char* dbHost, const char* dbName)
 {
   bson_error_t mongoError;
   char         mongoUri[512];
 
-  snprintf(mongoUri, sizeof(mongoUri), "mongodb://%s", dbHost);
+  if (dbUser[0] != 0)
+  {
+    char user[3 * 64 + 1];  // Every char of dbUser/dbPwd (char[64]) may need three chars when escaped
+    char pwd[3 * 64 + 1];
+
+    uriEscape(dbUser, user, sizeof(user));
+    uriEscape(dbPwd,  pwd,  sizeof(pwd));
+
+    snprintf(mongoUri, sizeof(mongoUri), "mongodb://%s:%s@%s/%s", user, pwd, dbHost, dbName);
+  }
+  else
+    snprintf(mongoUri, sizeof(mongoUri), "mongodb://%s", dbHost);
 
   //
   // Initialize libmongoc's internals
@@ -50,37 +110,22 @@ void mongocInit(const char* dbHost, const char* dbName)
   //
   // Safely create a MongoDB URI object from the given string
   //
-  orionldState.mongoUri = mongoc_uri_new_with_error(mongoUri, &mongoError);
-  if (orionldState.mongoUri == NULL)
-    LM_X(1, ("mongoc_uri_new_with_error(%s): %s", orionldState.mongoUri, mongoError.message));
+  mongocUri = mongoc_uri_new_with_error(mongoUri, &mongoError);
+  if (mongocUri == NULL)
+    LM_X(1, ("mongoc_uri_new_with_error(%s): %s", dbHost, mongoError.message));
 
   //
-  // Create a new client instance
+  // Create the pool of clients
   //
-  orionldState.mongoClient = mongoc_client_new_from_uri(orionldState.mongoUri);
-  if (orionldState.mongoClient == NULL)
-    LM_X(1, ("mongoc_client_new_from_uri failed"));
+  mongocPool = mongoc_client_pool_new(mongocUri);
+  if (mongocPool == NULL)
+    LM_X(1, ("mongoc_client_pool_new failed"));
 
-  //
-  // Register the application name (to get tracking possibilities in the profile logs on the server)
-  //
-  mongoc_client_set_appname(orionldState.mongoClient, "orionld");
-
-  //
-  // Get a handle on the database
-  //
-  orionldState.mongoDatabase = mongoc_client_get_database(orionldState.mongoClient, dbName);
-  if (orionldState.mongoDatabase == NULL)
-    LM_X(1, ("DB: mongoc_client_get_database FAILED"));
+  mongoc_client_pool_set_error_api(mongocPool, MONGOC_ERROR_API_VERSION_2);
+  mongoc_client_pool_max_size(mongocPool, dbPoolSize);
 
   //
-  // Get a handle on the collections
+  // Register the application name (to get tracking possibilities in the profile logs on the server)
   //
-  mongoEntitiesCollectionP = mongoc_client_get_collection(orionldState.mongoClient, dbName, "entities");
-  if (mongoEntitiesCollectionP == NULL)
-    LM_X(1, ("mongoc_client_get_collection(%s, 'entities') failed", dbName));
-
-  mongoRegistrationsCollectionP = mongoc_client_get_collection(orionldState.mongoClient, dbName, "registrations");
-  if (mongoRegistrationsCollectionP == NULL)
-    LM_X(1, ("mongoc_client_get_collection(%s, 'regiatrations') failed", dbName));
+  mongoc_client_pool_set_appname(mongocPool, "orionld");
 }
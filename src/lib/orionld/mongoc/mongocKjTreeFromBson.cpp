@@ -22,12 +22,16 @@
 *
 * Author: Ken Zangelin
 */
+#include <string.h>                                            // memcpy
 #include <bson/bson.h>                                         // BSON
 
 extern "C"
 {
 #include "kjson/KjNode.h"                                      // KjNode
+#include "kjson/kjBuilder.h"                                   // kjObject, kjArray, kjString, kjInteger, kjFloat, kjBoolean, kjNull, kjChildAdd
 #include "kjson/kjParse.h"                                     // kjParse
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
+#include "kalloc/kaStrdup.h"                                   // kaStrdup
 }
 
 #include "orionld/common/orionldState.h"                       // orionldState
@@ -35,32 +39,165 @@ extern "C"
 
 
 
+// -----------------------------------------------------------------------------
+//
+// kjTreeFromBsonIterContent - forward declaration
+//
+static bool kjTreeFromBsonIterContent(bson_iter_t* iterP, KjNode* containerP, bool isArray);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjNodeFromBsonIter -
+//
+// The nodes are created just like they would be if the BSON was rendered by bson_as_json() and then parsed by kjParse.
+// Types not found in the orionld collections are rendered as JSON and parsed.
+//
+// Keys and string values point into the BSON data, that has been copied to orionldState.kalloc by the caller.
+//
+static KjNode* kjNodeFromBsonIter(bson_iter_t* iterP, const char* name)
+{
+  KjNode*      nodeP = NULL;
+  bson_iter_t  childIter;
+  uint32_t     len;
+
+  switch (bson_iter_type(iterP))
+  {
+  case BSON_TYPE_UTF8:
+    nodeP = kjString(orionldState.kjsonP, name, bson_iter_utf8(iterP, &len));
+    break;
+
+  case BSON_TYPE_DOUBLE:
+    nodeP = kjFloat(orionldState.kjsonP, name, bson_iter_double(iterP));
+    break;
+
+  case BSON_TYPE_INT32:
+    nodeP = kjInteger(orionldState.kjsonP, name, bson_iter_int32(iterP));
+    break;
+
+  case BSON_TYPE_INT64:
+    nodeP = kjInteger(orionldState.kjsonP, name, bson_iter_int64(iterP));
+    break;
+
+  case BSON_TYPE_BOOL:
+    nodeP = kjBoolean(orionldState.kjsonP, name, bson_iter_bool(iterP));
+    break;
+
+  case BSON_TYPE_NULL:
+    nodeP = kjNull(orionldState.kjsonP, name);
+    break;
+
+  case BSON_TYPE_DOCUMENT:
+  case BSON_TYPE_ARRAY:
+    nodeP = (bson_iter_type(iterP) == BSON_TYPE_DOCUMENT)? kjObject(orionldState.kjsonP, name) : kjArray(orionldState.kjsonP, name);
+    if ((bson_iter_recurse(iterP, &childIter) == false) || (kjTreeFromBsonIterContent(&childIter, nodeP, nodeP->type == KjArray) == false))
+      return NULL;
+    break;
+
+  case BSON_TYPE_OID:
+    {
+      char* oidString = (char*) kaAlloc(&orionldState.kalloc, 25);
+
+      bson_oid_to_string(bson_iter_oid(iterP), oidString);
+      nodeP = kjObject(orionldState.kjsonP, name);
+      kjChildAdd(nodeP, kjString(orionldState.kjsonP, "$oid", oidString));
+    }
+    break;
+
+  default:
+    {
+      bson_t  element;
+      char*   json;
+
+      bson_init(&element);
+      bson_append_iter(&element, "v", 1, iterP);
+
+      if ((json = bson_as_json(&element, NULL)) != NULL)
+      {
+        KjNode* wrapperP = kjParse(orionldState.kjsonP, kaStrdup(&orionldState.kalloc, json));
+
+        if ((wrapperP != NULL) && (wrapperP->value.firstChildP != NULL))
+        {
+          nodeP       = wrapperP->value.firstChildP;
+          nodeP->name = (char*) name;
+          nodeP->next = NULL;
+        }
+
+        bson_free(json);
+      }
+
+      bson_destroy(&element);
+    }
+    break;
+  }
+
+  return nodeP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjTreeFromBsonIterContent - add all elements of a BSON iterator as children of a KjNode container
+//
+static bool kjTreeFromBsonIterContent(bson_iter_t* iterP, KjNode* containerP, bool isArray)
+{
+  while (bson_iter_next(iterP))
+  {
+    KjNode* nodeP = kjNodeFromBsonIter(iterP, (isArray == true)? NULL : bson_iter_key(iterP));
+
+    if (nodeP == NULL)
+      return false;
+
+    kjChildAdd(containerP, nodeP);
+  }
+
+  return true;
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // mongocKjTreeFromBson -
 //
+// The BSON data is copied to orionldState.kalloc (a single memcpy) and the KjNode tree is built iterating over
+// the copy, so keys and strings of the tree can point into the copy, instead of rendering the BSON as JSON and
+// parsing it back.
+//
 KjNode* mongocKjTreeFromBson(const void* dataP, char** titleP, char** detailsP)
 {
-  const bson_t*  bsonP  = (const bson_t*) dataP;
-  char*          json;
-  KjNode*        treeP = NULL;
+  const bson_t*  bsonP = (const bson_t*) dataP;
+  uint8_t*       data  = (uint8_t*) kaAlloc(&orionldState.kalloc, bsonP->len);
+  bson_t         bson;
+  bson_iter_t    iter;
+  KjNode*        treeP;
 
-  if ((json = bson_as_json(bsonP, NULL)) == NULL)
+  if (data == NULL)
   {
     *titleP   = (char*) "Internal Error";
-    *detailsP = (char*) "Error creating JSON from BSON";
+    *detailsP = (char*) "Out of memory copying BSON";
+    return NULL;
   }
-  else
+
+  memcpy(data, bson_get_data(bsonP), bsonP->len);
+
+  if ((bson_init_static(&bson, data, bsonP->len) == false) || (bson_iter_init(&iter, &bson) == false))
   {
-    treeP = kjParse(orionldState.kjsonP, json);
-    if (treeP == NULL)
-    {
-      *titleP   = (char*) "Internal Error";
-      *detailsP = (char*) "Error parsing JSON output from bson_as_json";
-    }
+    *titleP   = (char*) "Internal Error";
+    *detailsP = (char*) "Invalid BSON";
+    return NULL;
   }
 
-  bson_free(json);
+  treeP = kjObject(orionldState.kjsonP, NULL);
+
+  if (kjTreeFromBsonIterContent(&iter, treeP, false) == false)
+  {
+    *titleP   = (char*) "Internal Error";
+    *detailsP = (char*) "Error creating KjNode tree from BSON";
+    return NULL;
+  }
 
   return treeP;
 }
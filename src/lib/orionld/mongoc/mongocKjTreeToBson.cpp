@@ -0,0 +1,161 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp
+#include <bson/bson.h>                                           // BSON
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocKjTreeToBson.h"                   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjTreeToBsonContent - forward declaration
+//
+static void kjTreeToBsonContent(KjNode* containerP, bson_t* bsonP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjNodeToBson - append a KjNode to a BSON document (or array), as 'key'
+//
+// Integers that fit in 32 bits are stored as int32, just like the Legacy C++ driver does, to avoid NumberLong
+// in the database.
+// An object { "$oid": "..." } (as created by mongocKjTreeFromBson for an ObjectId) is stored back as an ObjectId.
+//
+static void kjNodeToBson(KjNode* nodeP, bson_t* bsonP, const char* key)
+{
+  bson_t  child;
+
+  switch (nodeP->type)
+  {
+  case KjString:
+    bson_append_utf8(bsonP, key, -1, nodeP->value.s, -1);
+    break;
+
+  case KjInt:
+    if ((nodeP->value.i >= INT32_MIN) && (nodeP->value.i <= INT32_MAX))
+      bson_append_int32(bsonP, key, -1, (int32_t) nodeP->value.i);
+    else
+      bson_append_int64(bsonP, key, -1, (int64_t) nodeP->value.i);
+    break;
+
+  case KjFloat:
+    bson_append_double(bsonP, key, -1, nodeP->value.f);
+    break;
+
+  case KjBoolean:
+    bson_append_bool(bsonP, key, -1, nodeP->value.b);
+    break;
+
+  case KjNull:
+    bson_append_null(bsonP, key, -1);
+    break;
+
+  case KjObject:
+    if ((nodeP->value.firstChildP != NULL) && (nodeP->value.firstChildP->next == NULL) && (nodeP->value.firstChildP->type == KjString) && (strcmp(nodeP->value.firstChildP->name, "$oid") == 0))
+    {
+      bson_oid_t oid;
+
+      bson_oid_init_from_string(&oid, nodeP->value.firstChildP->value.s);
+      bson_append_oid(bsonP, key, -1, &oid);
+      break;
+    }
+
+    bson_append_document_begin(bsonP, key, -1, &child);
+    kjTreeToBsonContent(nodeP, &child);
+    bson_append_document_end(bsonP, &child);
+    break;
+
+  case KjArray:
+    bson_append_array_begin(bsonP, key, -1, &child);
+    kjTreeToBsonContent(nodeP, &child);
+    bson_append_array_end(bsonP, &child);
+    break;
+
+  default:
+    LM_E(("Internal Error (invalid KjNode type %d for '%s')", nodeP->type, key));
+    break;
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjTreeToBsonContent - append all children of a KjNode container to a BSON document (or array)
+//
+// Array items are keyed "0", "1", "2", ... as BSON arrays are documents with the array index as keys.
+//
+static void kjTreeToBsonContent(KjNode* containerP, bson_t* bsonP)
+{
+  uint32_t index = 0;
+
+  for (KjNode* itemP = containerP->value.firstChildP; itemP != NULL; itemP = itemP->next)
+  {
+    if (containerP->type == KjArray)
+    {
+      char         indexBuf[16];
+      const char*  key;
+
+      bson_uint32_to_string(index, &key, indexBuf, sizeof(indexBuf));
+      kjNodeToBson(itemP, bsonP, key);
+      ++index;
+    }
+    else
+      kjNodeToBson(itemP, bsonP, itemP->name);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocKjTreeToBson -
+//
+// The BSON document is built straight from the KjNode tree - no JSON rendering and parsing involved.
+// 'dbDataP' is a pointer to an uninitialized bson_t, that must be freed by the caller using bson_destroy().
+//
+// A KjNode that is neither an object nor an array ends up as the only field of the document.
+//
+void mongocKjTreeToBson(KjNode* nodeP, void* dbDataP)
+{
+  bson_t* bsonP = (bson_t*) dbDataP;
+
+  bson_init(bsonP);
+
+  if ((nodeP->type == KjObject) || (nodeP->type == KjArray))
+    kjTreeToBsonContent(nodeP, bsonP);
+  else
+    kjNodeToBson(nodeP, bsonP, nodeP->name);
+}
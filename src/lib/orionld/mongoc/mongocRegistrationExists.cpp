@@ -0,0 +1,66 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocRegistrationExists.h"             // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocRegistrationExists -
+//
+//   db.registrations.countDocuments({ "_id": REGISTRATION_ID }, { "limit": 1 })
+//
+bool mongocRegistrationExists(const char* registrationId)
+{
+  mongoc_collection_t*  collectionP;
+  bson_t                mongoFilter;
+  bson_t                options;
+  bson_error_t          mongoError;
+  int64_t               hits;
+
+  if ((collectionP = mongocCollectionGet("registrations")) == NULL)
+    return false;
+
+  bson_init(&mongoFilter);
+  bson_init(&options);
+  bson_append_utf8(&mongoFilter, "_id", 3, registrationId, -1);
+  bson_append_int64(&options, "limit", 5, 1);
+
+  hits = mongoc_collection_count_documents(collectionP, &mongoFilter, &options, NULL, NULL, &mongoError);
+  if (hits == -1)
+    LM_E(("Database Error (counting registrations: %s)", mongoError.message));
+
+  bson_destroy(&options);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return (hits > 0)? true : false;
+}
@@ -0,0 +1,60 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <bson/bson.h>                                           // BSON
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionQuery.h"                // mongocCollectionQuery
+#include "orionld/mongoc/mongocRegistrationListGet.h"            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocRegistrationListGet - get all registrations of the tenant
+//
+//   db.registrations.find({})
+//
+// RETURN VALUE
+//   A KjNode array with all the registrations of the tenant (orionldState.tenant) - empty array if there are none
+//   NULL if the database could not be queried
+//
+KjNode* mongocRegistrationListGet(void)
+{
+  bson_t   mongoFilter;
+  KjNode*  regArray;
+
+  bson_init(&mongoFilter);
+  regArray = mongocCollectionQuery("registrations", &mongoFilter, NULL);
+  bson_destroy(&mongoFilter);
+
+  return regArray;
+}
@@ -0,0 +1,107 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <bson/bson.h>                                           // BSON
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionQuery.h"                // mongocCollectionQuery
+#include "orionld/mongoc/mongocRegistrationLookup.h"             // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocRegistrationLookup -
+//
+// If attribute is NULL: query registrations collection for:
+//   db.registrations.find({ "contextRegistration.entities.id": "urn:ngsi-ld:entities:E1" })
+//
+// If attribute is non-NULL:
+//   db.registrations.find(
+//     {
+//       "contextRegistration.entities.id": "urn:ngsi-ld:entities:E1",
+//       $or: [
+//         { "contextRegistration.attrs": { "$size": 0 } },
+//         { "contextRegistration.attrs.name": "https://uri.etsi.org/ngsi-ld/default-context/A1" }
+//       ]
+//     }
+//   )
+//
+// ToDo
+//   o Include idPattern in the query
+//
+// RETURN VALUE
+//   A KjNode array with the matching registrations - NULL if there are none
+//
+KjNode* mongocRegistrationLookup(const char* entityId, const char* attribute, int* noOfRegsP)
+{
+  bson_t   mongoFilter;
+  KjNode*  regArray;
+
+  if (noOfRegsP != NULL)
+    *noOfRegsP = 0;
+
+  bson_init(&mongoFilter);
+  bson_append_utf8(&mongoFilter, "contextRegistration.entities.id", 31, entityId, -1);
+
+  if (attribute != NULL)
+  {
+    bson_t orArray;
+    bson_t zeroSizeArrayItem;
+    bson_t zeroSizeObject;
+    bson_t attrNameMatchArrayItem;
+
+    bson_append_array_begin(&mongoFilter, "$or", 3, &orArray);
+
+    bson_append_document_begin(&orArray, "0", 1, &zeroSizeArrayItem);
+    bson_append_document_begin(&zeroSizeArrayItem, "contextRegistration.attrs", 25, &zeroSizeObject);
+    bson_append_int32(&zeroSizeObject, "$size", 5, 0);
+    bson_append_document_end(&zeroSizeArrayItem, &zeroSizeObject);
+    bson_append_document_end(&orArray, &zeroSizeArrayItem);
+
+    bson_append_document_begin(&orArray, "1", 1, &attrNameMatchArrayItem);
+    bson_append_utf8(&attrNameMatchArrayItem, "contextRegistration.attrs.name", 30, attribute, -1);
+    bson_append_document_end(&orArray, &attrNameMatchArrayItem);
+
+    bson_append_array_end(&mongoFilter, &orArray);
+
+    if (noOfRegsP != NULL)
+      *noOfRegsP += 1;
+  }
+
+  regArray = mongocCollectionQuery("registrations", &mongoFilter, NULL);
+  bson_destroy(&mongoFilter);
+
+  if ((regArray == NULL) || (regArray->value.firstChildP == NULL))
+    return NULL;
+
+  return regArray;
+}
@@ -0,0 +1,67 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <bson/bson.h>                                           // BSON
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionQuery.h"                // mongocCollectionQuery
+#include "orionld/mongoc/mongocSubscriptionGet.h"                // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocSubscriptionGet -
+//
+//   db.csubs.find({ "_id": SUBSCRIPTION_ID }).limit(1)
+//
+KjNode* mongocSubscriptionGet(const char* subscriptionId)
+{
+  bson_t   mongoFilter;
+  bson_t   options;
+  KjNode*  subscriptionArray;
+
+  bson_init(&mongoFilter);
+  bson_init(&options);
+
+  bson_append_utf8(&mongoFilter, "_id", 3, subscriptionId, -1);
+  bson_append_int32(&options, "limit", 5, 1);
+
+  subscriptionArray = mongocCollectionQuery("csubs", &mongoFilter, &options);
+
+  bson_destroy(&options);
+  bson_destroy(&mongoFilter);
+
+  if (subscriptionArray == NULL)
+    return NULL;
+
+  return subscriptionArray->value.firstChildP;
+}
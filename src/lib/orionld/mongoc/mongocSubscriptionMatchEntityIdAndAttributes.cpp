@@ -0,0 +1,112 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <bson/bson.h>                                           // BSON
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/db/dbConfiguration.h"                          // DbSubscriptionMatchCallback
+#include "orionld/mongoc/mongocCollectionQuery.h"                // mongocCollectionQuery
+#include "orionld/mongoc/mongocSubscriptionMatchEntityIdAndAttributes.h"   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocSubscriptionMatchEntityIdAndAttributes -
+//
+// Used instead of dbSubCacheSubscriptionMatchEntityIdAndAttributes when the subscription cache is turned off (-noCache).
+//
+//   db.csubs.find({ "entities.id": ENTITY_ID, "conditions": { "$in": [ ATTR1, ATTR2, ... ] }, "status": "active" })
+//
+// "q" is only evaluated (in-memory, see qCompiledMatch) when the subscription cache is used - same as in
+// mongoCppLegacySubscriptionMatchEntityIdAndAttributes.
+//
+void mongocSubscriptionMatchEntityIdAndAttributes
+(
+  const char*                 entityId,
+  KjNode*                     currentEntityTree,
+  KjNode*                     incomingRequestTree,
+  DbSubscriptionMatchCallback subMatchCallback
+)
+{
+  bson_t   mongoFilter;
+  bson_t   conditions;
+  bson_t   attrArray;
+  KjNode*  subscriptionArray;
+  int      ix = 0;
+
+  bson_init(&mongoFilter);
+
+  //
+  // 1. Entity ID, which in this case is FIXED
+  //
+  bson_append_utf8(&mongoFilter, "entities.id", 11, entityId, -1);
+
+  //
+  // 2. Attributes
+  //
+  bson_append_document_begin(&mongoFilter, "conditions", 10, &conditions);
+  bson_append_array_begin(&conditions, "$in", 3, &attrArray);
+
+  for (KjNode* attrNodeP = incomingRequestTree->value.firstChildP; attrNodeP != NULL; attrNodeP = attrNodeP->next)
+  {
+    char key[16];
+
+    snprintf(key, sizeof(key), "%d", ix++);
+    bson_append_utf8(&attrArray, key, -1, attrNodeP->name, -1);
+  }
+
+  bson_append_array_end(&conditions, &attrArray);
+  bson_append_document_end(&mongoFilter, &conditions);
+
+  //
+  // 3. status - must be "active"
+  //
+  bson_append_utf8(&mongoFilter, "status", 6, "active", 6);
+
+  subscriptionArray = mongocCollectionQuery("csubs", &mongoFilter, NULL);
+
+  bson_destroy(&mongoFilter);
+
+  if (subscriptionArray == NULL)
+    return;
+
+  KjNode* subscriptionTree = subscriptionArray->value.firstChildP;
+
+  while (subscriptionTree != NULL)
+  {
+    KjNode* next = subscriptionTree->next;  // The callback may link the tree somewhere else
+
+    subMatchCallback(entityId, subscriptionTree, currentEntityTree, incomingRequestTree);
+    subscriptionTree = next;
+  }
+}
@@ -0,0 +1,111 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+#include "mongo/client/dbclient.h"                               // mongo::BSONObj, for the subscription cache
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/globals.h"                                      // noCache
+#include "common/sem.h"                                          // cacheSemTake, cacheSemGive
+#include "cache/subCache.h"                                      // subCacheItemLookup, subCacheItemRemove
+#include "mongoBackend/mongoSubCache.h"                          // mongoSubCacheItemInsert
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/db/dbConfiguration.h"                          // dbDataFromKjTree
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocSubscriptionReplace.h"            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// subCacheItemReplace - replace the cached copy of a subscription with what was just written to the database
+//
+// The subscription cache is still fed with mongo::BSONObj (mongoSubCacheItemInsert).
+// The BSON wire format is the same for both drivers, so the data of the bson_t is used as is - no conversion.
+//
+static void subCacheItemReplace(const char* subscriptionId, const bson_t* subscriptionP)
+{
+  const char*     tenant = (orionldState.tenant != NULL)? orionldState.tenant : "";
+  mongo::BSONObj  subscription((const char*) bson_get_data(subscriptionP));
+
+  cacheSemTake(__FUNCTION__, "Replacing subscription in cache");
+
+  CachedSubscription* cSubP = subCacheItemLookup(tenant, subscriptionId);
+
+  if (cSubP != NULL)
+    subCacheItemRemove(cSubP);
+
+  if (mongoSubCacheItemInsert(tenant, subscription) != 0)
+    LM_E(("Internal Error (unable to insert the subscription '%s' in the subscription cache)", subscriptionId));
+
+  cacheSemGive(__FUNCTION__, "Replacing subscription in cache");
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocSubscriptionReplace -
+//
+//   db.csubs.replaceOne({ "_id": SUBSCRIPTION_ID }, DB_SUBSCRIPTION)
+//
+bool mongocSubscriptionReplace(const char* subscriptionId, KjNode* dbSubscriptionP)
+{
+  mongoc_collection_t*  collectionP;
+  bson_t                selector;
+  bson_t                replacement;
+  bson_error_t          mongoError;
+  bool                  ok;
+
+  if ((collectionP = mongocCollectionGet("csubs")) == NULL)
+    return false;
+
+  bson_init(&selector);
+  bson_append_utf8(&selector, "_id", 3, subscriptionId, -1);
+  dbDataFromKjTree(dbSubscriptionP, &replacement);
+
+  ok = mongoc_collection_replace_one(collectionP, &selector, &replacement, NULL, NULL, &mongoError);
+  if (ok == false)
+    LM_E(("Database Error (replacing subscription '%s': %s)", subscriptionId, mongoError.message));
+
+  //
+  // The subscription cache must reflect the change, as subscriptions are matched using the cache
+  //
+  if ((ok == true) && (noCache == false))
+    subCacheItemReplace(subscriptionId, &replacement);
+
+  bson_destroy(&replacement);
+  bson_destroy(&selector);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
@@ -0,0 +1,101 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONBATCH_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONBATCH_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                             // pthread_mutex_t, pthread_cond_t
+#include <time.h>                                                // struct timespec
+
+#include "common/MimeType.h"                                     // MimeType
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Limits and defaults for the notification batching of a subscription (Notification::batch)
+//
+// A subscription with batching accumulates the entities of its notifications and sends them all together,
+// as items of the 'data' array of one single notification, once 'maxEntities' entities have been accumulated,
+// or once the oldest entity has waited 'maxDelay' milliseconds - whatever comes first.
+//
+#define NOTIFICATION_BATCH_MAX_ENTITIES_DEFAULT   100
+#define NOTIFICATION_BATCH_MAX_ENTITIES_MAX      1000
+#define NOTIFICATION_BATCH_MAX_DELAY_DEFAULT     1000
+#define NOTIFICATION_BATCH_MAX_DELAY_MAX        60000
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationBatchItem - one entity of a batch, already rendered as JSON
+//
+// The item is allocated as one single chunk of memory, the rendered entity included.
+//
+typedef struct NotificationBatchItem
+{
+  struct NotificationBatchItem*  next;
+  char*                          json;
+  int                            jsonLen;
+} NotificationBatchItem;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationBatch - the accumulated entities of a subscription, waiting to be sent
+//
+// A batch is identified by tenant, subscription id and context.
+// All strings are allocated together with the batch, as one single chunk of memory.
+//
+typedef struct NotificationBatch
+{
+  struct NotificationBatch*  next;
+  char*                      tenant;
+  char*                      subscriptionId;
+  char*                      url;
+  char*                      ldContext;
+  MimeType                   mimeType;
+  int                        maxEntities;
+  NotificationBatchItem*     first;
+  NotificationBatchItem*     last;
+  int                        items;
+  int                        itemsLen;      // Accumulated length of the rendered items
+  struct timespec            deadline;      // CLOCK_MONOTONIC - the batch is flushed at this point in time
+} NotificationBatch;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// The open batches, protected by notificationBatchMutex
+//
+// notificationBatchCond wakes up the flusher thread when a batch is opened.
+// It uses CLOCK_MONOTONIC and is initialized by notificationBatchFlusherStart().
+//
+extern NotificationBatch*  notificationBatchList;
+extern pthread_mutex_t     notificationBatchMutex;
+extern pthread_cond_t      notificationBatchCond;
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONBATCH_H_
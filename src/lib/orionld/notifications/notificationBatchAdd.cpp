@@ -0,0 +1,196 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strlen, strcmp, memcpy
+#include <stdlib.h>                                              // malloc
+#include <pthread.h>                                             // pthread_once, pthread_mutex_lock, ...
+#include <time.h>                                                // clock_gettime
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/notifications/notificationQueue.h"             // notificationStats
+#include "orionld/notifications/notificationBatch.h"             // Notification Batch Internals
+#include "orionld/notifications/notificationBatchFlush.h"        // notificationBatchFlush
+#include "orionld/notifications/notificationBatchFlusherStart.h" // notificationBatchFlusherStart
+#include "orionld/notifications/notificationBatchAdd.h"          // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// flusherOnce - the flusher thread is started by the first batch
+//
+static pthread_once_t flusherOnce = PTHREAD_ONCE_INIT;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// batchCreate -
+//
+static NotificationBatch* batchCreate
+(
+  const char*  tenant,
+  const char*  subscriptionId,
+  const char*  url,
+  MimeType     mimeType,
+  const char*  ldContext,
+  int          maxEntities,
+  int          maxDelay
+)
+{
+  int                 tenantLen    = strlen(tenant) + 1;
+  int                 subIdLen     = strlen(subscriptionId) + 1;
+  int                 urlLen       = strlen(url) + 1;
+  int                 ldContextLen = strlen(ldContext) + 1;
+  NotificationBatch*  batchP       = (NotificationBatch*) malloc(sizeof(NotificationBatch) + tenantLen + subIdLen + urlLen + ldContextLen);
+
+  if (batchP == NULL)
+    LM_X(1, ("Runtime Error (out of memory allocating a notification batch)"));
+
+  batchP->tenant         = (char*) &batchP[1];
+  batchP->subscriptionId = &batchP->tenant[tenantLen];
+  batchP->url            = &batchP->subscriptionId[subIdLen];
+  batchP->ldContext      = &batchP->url[urlLen];
+  batchP->mimeType       = mimeType;
+  batchP->maxEntities    = maxEntities;
+  batchP->first          = NULL;
+  batchP->last           = NULL;
+  batchP->items          = 0;
+  batchP->itemsLen       = 0;
+
+  memcpy(batchP->tenant,         tenant,         tenantLen);
+  memcpy(batchP->subscriptionId, subscriptionId, subIdLen);
+  memcpy(batchP->url,            url,            urlLen);
+  memcpy(batchP->ldContext,      ldContext,      ldContextLen);
+
+  clock_gettime(CLOCK_MONOTONIC, &batchP->deadline);
+  batchP->deadline.tv_sec  += maxDelay / 1000;
+  batchP->deadline.tv_nsec += (maxDelay % 1000) * 1000000;
+  if (batchP->deadline.tv_nsec >= 1000000000)
+  {
+    batchP->deadline.tv_sec  += 1;
+    batchP->deadline.tv_nsec -= 1000000000;
+  }
+
+  return batchP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationBatchAdd -
+//
+void notificationBatchAdd
+(
+  const char*  tenant,
+  const char*  subscriptionId,
+  const char*  url,
+  MimeType     mimeType,
+  const char*  ldContext,
+  int          maxEntities,
+  int          maxDelay,
+  const char*  itemJson,
+  int          itemJsonLen
+)
+{
+  NotificationBatchItem*  itemP   = (NotificationBatchItem*) malloc(sizeof(NotificationBatchItem) + itemJsonLen + 1);
+  NotificationBatch*      staleP  = NULL;  // A batch of the subscription that can't be continued
+  NotificationBatch*      fullP   = NULL;  // The batch, if it's complete after adding the item
+  NotificationBatch*      batchP;
+  NotificationBatch*      prevP   = NULL;
+
+  if (itemP == NULL)
+    LM_X(1, ("Runtime Error (out of memory allocating a notification batch item)"));
+
+  itemP->next    = NULL;
+  itemP->json    = (char*) &itemP[1];
+  itemP->jsonLen = itemJsonLen;
+  memcpy(itemP->json, itemJson, itemJsonLen);
+  itemP->json[itemJsonLen] = 0;
+
+  pthread_once(&flusherOnce, notificationBatchFlusherStart);
+
+  pthread_mutex_lock(&notificationBatchMutex);
+
+  for (batchP = notificationBatchList; batchP != NULL; batchP = batchP->next)
+  {
+    if ((strcmp(batchP->subscriptionId, subscriptionId) == 0) && (strcmp(batchP->tenant, tenant) == 0))
+      break;
+    prevP = batchP;
+  }
+
+  if ((batchP != NULL) && ((batchP->mimeType != mimeType) || (strcmp(batchP->url, url) != 0) || (strcmp(batchP->ldContext, ldContext) != 0)))
+  {
+    if (prevP == NULL)
+      notificationBatchList = batchP->next;
+    else
+      prevP->next = batchP->next;
+
+    staleP = batchP;
+    batchP = NULL;
+  }
+
+  if (batchP == NULL)
+  {
+    batchP       = batchCreate(tenant, subscriptionId, url, mimeType, ldContext, maxEntities, maxDelay);
+    batchP->next = notificationBatchList;
+    prevP        = NULL;
+
+    notificationBatchList = batchP;
+    pthread_cond_signal(&notificationBatchCond);  // The flusher thread needs to know about the new deadline
+  }
+
+  if (batchP->last == NULL)
+    batchP->first = itemP;
+  else
+    batchP->last->next = itemP;
+
+  batchP->last      = itemP;
+  batchP->items    += 1;
+  batchP->itemsLen += itemJsonLen;
+
+  if (batchP->items >= batchP->maxEntities)
+  {
+    if (prevP == NULL)
+      notificationBatchList = batchP->next;
+    else
+      prevP->next = batchP->next;
+
+    fullP = batchP;
+  }
+
+  pthread_mutex_unlock(&notificationBatchMutex);
+
+  __sync_fetch_and_add(&notificationStats.batched, 1);
+  LM_T(LmtNotifications, ("Entity added to the notification batch of subscription '%s'", subscriptionId));
+
+  if (staleP != NULL)
+    notificationBatchFlush(staleP);
+
+  if (fullP != NULL)
+    notificationBatchFlush(fullP);
+}
@@ -0,0 +1,56 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONBATCHADD_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONBATCHADD_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "common/MimeType.h"                                     // MimeType
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationBatchAdd - add an entity to the notification batch of a subscription
+//
+// 'itemJson' is the entity, rendered as JSON, as it goes in the 'data' array of the notification.
+// The batch is opened if needed, and it is sent right away if it reaches 'maxEntities' entities.
+// Otherwise, it is sent by the flusher thread once 'maxDelay' milliseconds have passed since it was opened.
+//
+// A batch with a different endpoint, mime type or context for the same subscription (the subscription has been
+// modified) is sent before opening a new one.
+//
+extern void notificationBatchAdd
+(
+  const char*  tenant,
+  const char*  subscriptionId,
+  const char*  url,
+  MimeType     mimeType,
+  const char*  ldContext,
+  int          maxEntities,
+  int          maxDelay,
+  const char*  itemJson,
+  int          itemJsonLen
+);
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONBATCHADD_H_
@@ -0,0 +1,257 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strlen, strerror, memcpy, memmove
+#include <stdlib.h>                                              // malloc, free
+#include <stdio.h>                                               // snprintf
+#include <time.h>                                                // time
+#include <errno.h>                                               // errno
+#include <sys/socket.h>                                          // send, MSG_NOSIGNAL
+#include <sys/uio.h>                                             // struct iovec
+#include <string>                                                // std::string
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/string.h"                                       // parseUrl
+#include "rest/httpHeaderAdd.h"                                  // LINK_REL_AND_TYPE
+#include "orionld/common/numberToDate.h"                         // numberToDate
+#include "orionld/common/uuidGenerate.h"                         // uuidGenerate
+#include "orionld/common/orionldEndpointConnect.h"               // orionldEndpointConnect
+#include "orionld/common/orionldEndpointRelease.h"               // orionldEndpointRelease
+#include "orionld/common/orionldHttpResponseRead.h"              // orionldHttpResponseRead
+#include "orionld/context/orionldCoreContext.h"                  // ORIONLD_CORE_CONTEXT_URL
+#include "orionld/notifications/notificationQueue.h"             // notificationSenders, notificationStats, NOTIFICATION_TIMEOUT_MS
+#include "orionld/notifications/notificationEnqueue.h"           // notificationEnqueue
+#include "orionld/notifications/notificationBatch.h"             // NotificationBatch
+#include "orionld/notifications/notificationBatchFlush.h"        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// requestSend - send an entire request on a blocking connection, without SIGPIPE if the peer has closed it
+//
+static bool requestSend(int fd, const char* request, int requestLen)
+{
+  int sent = 0;
+
+  while (sent < requestLen)
+  {
+    int nb = send(fd, &request[sent], requestLen - sent, MSG_NOSIGNAL);
+
+    if (nb == -1)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    sent += nb;
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// requestSendSync - send the notification and wait for its response, on a keep-alive connection if possible
+//
+static void requestSendSync(const char* host, uint16_t port, const char* subscriptionId, const char* request, int requestLen)
+{
+  OrionldEndpoint*  endpointP;
+  bool              reused;
+  bool              keepAlive;
+  char              buf[1024];
+  int               fd = orionldEndpointConnect(host, port, false, ORIONLD_ENDPOINT_WAIT_TIMEOUT, &endpointP, &reused);
+
+  if (fd == -1)
+  {
+    LM_E(("Internal Error (unable to connect to %s:%d for notification for subscription '%s': %s)", host, port, subscriptionId, strerror(errno)));
+    return;
+  }
+
+  bool ok = requestSend(fd, request, requestLen);
+
+  if ((ok == false) && (reused == true))
+  {
+    // The peer may have closed the idle connection right now - one more try, on a new connection
+    orionldEndpointRelease(endpointP, fd, false);
+
+    fd = orionldEndpointConnect(host, port, false, ORIONLD_ENDPOINT_WAIT_TIMEOUT, &endpointP, &reused);
+    ok = (fd != -1) && requestSend(fd, request, requestLen);
+  }
+
+  if (ok == false)
+  {
+    if (fd != -1)
+      orionldEndpointRelease(endpointP, fd, false);
+
+    LM_E(("Internal Error (unable to send notification for subscription '%s' to %s:%d: %s)", subscriptionId, host, port, strerror(errno)));
+    return;
+  }
+
+  int statusCode = orionldHttpResponseRead(fd, buf, sizeof(buf), NOTIFICATION_TIMEOUT_MS, &keepAlive);
+
+  if (statusCode == -1)
+    LM_W(("Notification for subscription '%s': no valid response from %s:%d", subscriptionId, host, port));
+
+  orionldEndpointRelease(endpointP, fd, (statusCode != -1) && (keepAlive == true));
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// batchFree -
+//
+static void batchFree(NotificationBatch* batchP)
+{
+  NotificationBatchItem* itemP = batchP->first;
+
+  while (itemP != NULL)
+  {
+    NotificationBatchItem* next = itemP->next;
+
+    free(itemP);
+    itemP = next;
+  }
+
+  free(batchP);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationBatchFlush -
+//
+// The payload is put together as text, as the entities are already rendered:
+//
+//   {
+//     "id": "urn:ngsi-ld:Notification:<uuid>",
+//     "type": "Notification",
+//     "subscriptionId": "<subscription id>",
+//     "@context": "<context url>",                  (only for application/ld+json)
+//     "notifiedAt": "<now>",
+//     "data": [ <entity 1>, <entity 2>, ... ]
+//   }
+//
+void notificationBatchFlush(NotificationBatch* batchP)
+{
+  std::string  host;
+  int          port;
+  std::string  path;
+  std::string  protocol;
+
+  if ((parseUrl(batchP->url, host, port, path, protocol) == false) || (protocol != "http:"))
+  {
+    LM_E(("Runtime Error (not sending notification batch of subscription '%s': unsupported URL: '%s')", batchP->subscriptionId, batchP->url));
+    batchFree(batchP);
+    return;
+  }
+
+  const char*  ldContext = (batchP->ldContext[0] != 0)? batchP->ldContext : ORIONLD_CORE_CONTEXT_URL;
+  char         notificationId[64];
+  char         nowString[64];
+  char*        detail;
+
+  strncpy(notificationId, "urn:ngsi-ld:Notification:", sizeof(notificationId));
+  uuidGenerate(&notificationId[25]);
+
+  if (numberToDate(time(NULL), nowString, sizeof(nowString), &detail) == false)
+  {
+    LM_E(("Internal Error (converting timestamp to DateTime string: %s)", detail));
+    snprintf(nowString, sizeof(nowString), "1970-01-01T00:00:00Z");
+  }
+
+  //
+  // Room for the HTTP headers and for the payload, fixed parts included - the items of 'data' need a comma each.
+  // The payload is put together first, after the room for the headers, as Content-Length is needed for the headers.
+  // Once the headers are rendered, the payload is moved down to right after them.
+  //
+  int    headersRoom = 400 + path.length() + host.length() + strlen(ldContext) + strlen(batchP->tenant);
+  int    payloadRoom = 200 + strlen(batchP->subscriptionId) + strlen(ldContext) + batchP->itemsLen + batchP->items;
+  char*  buf         = (char*) malloc(headersRoom + payloadRoom);
+  char*  payload;
+  int    payloadLen;
+  int    headersLen;
+
+  if (buf == NULL)
+    LM_X(1, ("Runtime Error (out of memory allocating a notification of %d bytes)", headersRoom + payloadRoom));
+
+  payload    = &buf[headersRoom];
+  payloadLen = snprintf(payload, payloadRoom, "{\"id\":\"%s\",\"type\":\"Notification\",\"subscriptionId\":\"%s\",", notificationId, batchP->subscriptionId);
+
+  if (batchP->mimeType == JSONLD)
+    payloadLen += snprintf(&payload[payloadLen], payloadRoom - payloadLen, "\"@context\":\"%s\",", ldContext);
+
+  payloadLen += snprintf(&payload[payloadLen], payloadRoom - payloadLen, "\"notifiedAt\":\"%s\",\"data\":[", nowString);
+
+  for (NotificationBatchItem* itemP = batchP->first; itemP != NULL; itemP = itemP->next)
+  {
+    if (itemP != batchP->first)
+      payload[payloadLen++] = ',';
+
+    memcpy(&payload[payloadLen], itemP->json, itemP->jsonLen);
+    payloadLen += itemP->jsonLen;
+  }
+
+  payload[payloadLen++] = ']';
+  payload[payloadLen++] = '}';
+
+  headersLen = snprintf(buf, headersRoom, "POST %s HTTP/1.1\r\nHost: %s:%d\r\nContent-Length: %d\r\nContent-Type: %s\r\n",
+                        path.c_str(),
+                        host.c_str(),
+                        port,
+                        payloadLen,
+                        (batchP->mimeType == JSONLD)? "application/ld+json" : "application/json");
+
+  if (batchP->mimeType != JSONLD)
+    headersLen += snprintf(&buf[headersLen], headersRoom - headersLen, "Link: <%s>; %s\r\n", ldContext, LINK_REL_AND_TYPE);
+
+  if (batchP->tenant[0] != 0)
+    headersLen += snprintf(&buf[headersLen], headersRoom - headersLen, "Fiware-Service: %s\r\n", batchP->tenant);
+
+  headersLen += snprintf(&buf[headersLen], headersRoom - headersLen, "User-Agent: orionld\r\n\r\n");
+
+  memmove(&buf[headersLen], payload, payloadLen);
+
+  __sync_fetch_and_add(&notificationStats.batches, 1);
+  LM_T(LmtNotifications, ("Sending a notification with %d entities for subscription '%s'", batchP->items, batchP->subscriptionId));
+
+  if (notificationSenders > 0)
+  {
+    struct iovec ioVec[1] = { { buf, (size_t) (headersLen + payloadLen) } };
+
+    notificationEnqueue(host.c_str(), port, batchP->subscriptionId, ioVec, 1);
+  }
+  else
+    requestSendSync(host.c_str(), port, batchP->subscriptionId, buf, headersLen + payloadLen);
+
+  free(buf);
+  batchFree(batchP);
+}
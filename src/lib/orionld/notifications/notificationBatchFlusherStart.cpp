@@ -0,0 +1,145 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strerror
+#include <pthread.h>                                             // pthread_create, pthread_cond_timedwait, ...
+#include <time.h>                                                // clock_gettime
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/notifications/notificationBatch.h"             // Notification Batch Internals
+#include "orionld/notifications/notificationBatchFlush.h"        // notificationBatchFlush
+#include "orionld/notifications/notificationBatchFlusherStart.h" // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// deadlinePassed -
+//
+static bool deadlinePassed(const struct timespec* deadlineP, const struct timespec* nowP)
+{
+  if (deadlineP->tv_sec != nowP->tv_sec)
+    return deadlineP->tv_sec < nowP->tv_sec;
+
+  return deadlineP->tv_nsec <= nowP->tv_nsec;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationBatchFlusher - the thread that sends the batches whose delay has expired
+//
+// The expired batches are unlinked from the list while holding the mutex, and sent without it,
+// so that the request threads can keep adding entities to other batches in the meantime.
+//
+static void* notificationBatchFlusher(void* arg)
+{
+  pthread_mutex_lock(&notificationBatchMutex);
+
+  while (1)
+  {
+    NotificationBatch*  expiredList  = NULL;
+    NotificationBatch*  prevP        = NULL;
+    NotificationBatch*  batchP       = notificationBatchList;
+    struct timespec*    earliestP    = NULL;
+    struct timespec     now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    while (batchP != NULL)
+    {
+      NotificationBatch* next = batchP->next;
+
+      if (deadlinePassed(&batchP->deadline, &now))
+      {
+        if (prevP == NULL)
+          notificationBatchList = next;
+        else
+          prevP->next = next;
+
+        batchP->next = expiredList;
+        expiredList  = batchP;
+      }
+      else
+      {
+        if ((earliestP == NULL) || deadlinePassed(&batchP->deadline, earliestP))
+          earliestP = &batchP->deadline;
+        prevP = batchP;
+      }
+
+      batchP = next;
+    }
+
+    if (expiredList != NULL)
+    {
+      pthread_mutex_unlock(&notificationBatchMutex);
+
+      while (expiredList != NULL)
+      {
+        NotificationBatch* next = expiredList->next;
+
+        notificationBatchFlush(expiredList);
+        expiredList = next;
+      }
+
+      pthread_mutex_lock(&notificationBatchMutex);
+    }
+    else if (earliestP == NULL)
+      pthread_cond_wait(&notificationBatchCond, &notificationBatchMutex);
+    else
+    {
+      struct timespec deadline = *earliestP;  // The batch may be unlinked and freed while waiting
+
+      pthread_cond_timedwait(&notificationBatchCond, &notificationBatchMutex, &deadline);
+    }
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationBatchFlusherStart -
+//
+void notificationBatchFlusherStart(void)
+{
+  pthread_condattr_t  condAttr;
+  pthread_t           tid;
+
+  pthread_condattr_init(&condAttr);
+  pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+  pthread_cond_init(&notificationBatchCond, &condAttr);
+  pthread_condattr_destroy(&condAttr);
+
+  int s = pthread_create(&tid, NULL, notificationBatchFlusher, NULL);
+  if (s != 0)
+    LM_X(1, ("Fatal Error (pthread_create: %s)", strerror(s)));
+
+  pthread_detach(tid);
+}
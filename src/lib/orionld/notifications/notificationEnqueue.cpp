@@ -0,0 +1,103 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strlen, memcpy
+#include <stdlib.h>                                              // malloc
+#include <stdint.h>                                              // uint64_t
+#include <errno.h>                                               // errno
+#include <unistd.h>                                              // write
+#include <time.h>                                                // clock_gettime
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/stringHash.h"                           // stringHash
+#include "orionld/common/orionldEndpointResolve.h"               // orionldEndpointResolve
+#include "orionld/notifications/notificationQueue.h"             // Notification Sender Internals
+#include "orionld/notifications/notificationQueuePush.h"         // notificationQueuePush
+#include "orionld/notifications/notificationEnqueue.h"           // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationEnqueue -
+//
+// The host name of the endpoint is resolved here, in the thread of the request, and not by the notification sender,
+// as resolving a name blocks - the senders only use the addresses in the DNS cache of the endpoint pool.
+// A host name that can't be resolved is still queued - the transfer fails (and is retried) in the sender.
+//
+bool notificationEnqueue(const char* host, uint16_t port, const char* subscriptionId, const struct iovec* ioVec, int ioVecLen)
+{
+  if (__sync_add_and_fetch(&notificationStats.queueDepth, 1) > notificationQueueMaxDepth)
+  {
+    __sync_fetch_and_sub(&notificationStats.queueDepth, 1);
+    __sync_fetch_and_add(&notificationStats.dropped, 1);
+    LM_W(("Notification for subscription '%s' dropped - the notification queues are full", subscriptionId));
+    return false;
+  }
+
+  orionldEndpointResolve(host, port, NULL);
+
+  int requestLen = 0;
+  for (int ix = 0; ix < ioVecLen; ix++)
+    requestLen += ioVec[ix].iov_len;
+
+  int                  hostLen  = strlen(host) + 1;
+  int                  subIdLen = strlen(subscriptionId) + 1;
+  NotificationRecord*  recordP  = (NotificationRecord*) malloc(sizeof(NotificationRecord) + requestLen + hostLen + subIdLen);
+
+  if (recordP == NULL)
+    LM_X(1, ("Runtime Error (out of memory allocating a notification)"));
+
+  recordP->request        = (char*) &recordP[1];
+  recordP->requestLen     = requestLen;
+  recordP->host           = &recordP->request[requestLen];
+  recordP->port           = port;
+  recordP->subscriptionId = &recordP->host[hostLen];
+  recordP->attempts       = 0;
+
+  char* p = recordP->request;
+  for (int ix = 0; ix < ioVecLen; ix++)
+  {
+    memcpy(p, ioVec[ix].iov_base, ioVec[ix].iov_len);
+    p += ioVec[ix].iov_len;
+  }
+
+  memcpy(recordP->host,           host,           hostLen);
+  memcpy(recordP->subscriptionId, subscriptionId, subIdLen);
+
+  clock_gettime(CLOCK_MONOTONIC, &recordP->queuedAt);
+
+  NotificationSender*  senderP = &notificationSenderV[(stringHash(host) ^ port) % notificationSenders];
+  uint64_t             one     = 1;
+
+  notificationQueuePush(&senderP->queue, recordP);
+  __sync_fetch_and_add(&notificationStats.queued, 1);
+
+  if (write(senderP->eventFd, &one, sizeof(one)) != sizeof(one))
+    LM_E(("Internal Error (unable to wake up notification sender %d: %s)", senderP->index, strerror(errno)));
+
+  return true;
+}
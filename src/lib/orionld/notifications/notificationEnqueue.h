@@ -0,0 +1,44 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONENQUEUE_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONENQUEUE_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint16_t
+#include <sys/uio.h>                                             // struct iovec
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationEnqueue - queue a notification for asynchronous delivery by the sender threads
+//
+// The HTTP request is given as an iovec (headers and payload body) and is copied into the notification record.
+// All notifications to the same endpoint (host:port) go to the same sender thread.
+//
+// Returns false if the notification was dropped (the queues are full).
+//
+extern bool notificationEnqueue(const char* host, uint16_t port, const char* subscriptionId, const struct iovec* ioVec, int ioVecLen);
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONENQUEUE_H_
@@ -0,0 +1,169 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONQUEUE_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONQUEUE_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint16_t
+#include <pthread.h>                                             // pthread_t
+#include <time.h>                                                // struct timespec
+
+#include "orionld/common/orionldEndpointPool.h"                  // OrionldEndpoint
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_TIMEOUT_MS - max time for one attempt of a notification: connect, send, and receive the response
+//
+#define NOTIFICATION_TIMEOUT_MS  10000
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_ATTEMPTS - max number of attempts to deliver a notification
+//
+// A notification is retried after a connection/transport error or a 5xx response.
+// The delay before retry N is NOTIFICATION_RETRY_DELAY_MS * 2^(N-1)
+//
+#define NOTIFICATION_ATTEMPTS        3
+#define NOTIFICATION_RETRY_DELAY_MS  100
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_POOL_WAIT_MS - delay before trying again to connect, when the endpoint had no free connection
+//
+#define NOTIFICATION_POOL_WAIT_MS  20
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_SENDERS_MAX - upper limit for the CLI option -notifSenders
+//
+#define NOTIFICATION_SENDERS_MAX  32
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_LATENCY_BUCKETS - number of buckets of the notification latency histogram
+//
+#define NOTIFICATION_LATENCY_BUCKETS  10
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationRecord - a notification, ready to be sent
+//
+// The complete HTTP request (headers and payload body) is rendered by the request thread into 'request',
+// and the record is allocated as one single chunk of memory, strings included.
+//
+typedef struct NotificationRecord
+{
+  struct NotificationRecord*  next;           // Next in the queue - only to be accessed via the queue functions
+  char*                       host;
+  uint16_t                    port;
+  char*                       subscriptionId;
+  char*                       request;
+  int                         requestLen;
+  struct timespec             queuedAt;
+  int                         attempts;
+} NotificationRecord;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationQueue - lock-free multi-producer single-consumer queue (intrusive, Vyukov style)
+//
+// Producers (request threads) swap 'head'. The consumer (the sender thread that owns the queue) is
+// the only one to use 'tail'. 'stub' is a dummy record that makes the queue never empty internally.
+//
+typedef struct NotificationQueue
+{
+  NotificationRecord* volatile  head;
+  NotificationRecord*           tail;
+  NotificationRecord            stub;
+} NotificationQueue;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationSender - a sender thread, with its own queue
+//
+typedef struct NotificationSender
+{
+  int                  index;
+  pthread_t            tid;
+  int                  epollFd;
+  int                  eventFd;     // Written by producers to wake up the sender thread
+  NotificationQueue    queue;
+} NotificationSender;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationStats -
+//
+// All counters are updated using atomic builtins.
+// latency[ix] counts the delivered notifications (queued until response received) with a latency below
+// notificationLatencyLimits[ix] milliseconds (the last bucket has no limit).
+//
+typedef struct NotificationStats
+{
+  unsigned long long  queued;
+  unsigned long long  dropped;         // Queue full
+  unsigned long long  sent;            // Attempts
+  unsigned long long  delivered;       // Response with 2xx status code
+  unsigned long long  rejected;        // Response with a non-2xx status code, not retried
+  unsigned long long  retries;
+  unsigned long long  failed;          // Given up after NOTIFICATION_ATTEMPTS attempts
+  unsigned long long  timeouts;
+  unsigned long long  batched;         // Entities added to a notification batch
+  unsigned long long  batches;         // Notifications with a batch of entities
+  long long           queueDepth;
+  long long           inFlight;
+  unsigned long long  latency[NOTIFICATION_LATENCY_BUCKETS];
+} NotificationStats;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// The notification senders
+//
+extern NotificationSender*  notificationSenderV;
+extern int                  notificationSenders;       // CLI option -notifSenders - 0: notifications are sent synchronously
+extern int                  notificationQueueMaxDepth;  // CLI option -notifQueueSize - for all queues together
+extern NotificationStats    notificationStats;
+extern const int            notificationLatencyLimits[NOTIFICATION_LATENCY_BUCKETS - 1];
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONQUEUE_H_
@@ -0,0 +1,80 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                              // NULL
+
+#include "orionld/notifications/notificationQueue.h"             // NotificationQueue, NotificationRecord
+#include "orionld/notifications/notificationQueuePush.h"         // notificationQueuePush
+#include "orionld/notifications/notificationQueuePop.h"          // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueuePop -
+//
+NotificationRecord* notificationQueuePop(NotificationQueue* queueP)
+{
+  NotificationRecord* tailP = queueP->tail;
+  NotificationRecord* nextP = __atomic_load_n(&tailP->next, __ATOMIC_ACQUIRE);
+
+  //
+  // Skip the stub
+  //
+  if (tailP == &queueP->stub)
+  {
+    if (nextP == NULL)
+      return NULL;
+
+    queueP->tail = nextP;
+    tailP        = nextP;
+    nextP        = __atomic_load_n(&nextP->next, __ATOMIC_ACQUIRE);
+  }
+
+  if (nextP != NULL)
+  {
+    queueP->tail = nextP;
+    return tailP;
+  }
+
+  //
+  // tailP is the last record - unless a producer is about to link a new record after it
+  //
+  if (tailP != __atomic_load_n(&queueP->head, __ATOMIC_ACQUIRE))
+    return NULL;
+
+  //
+  // Put the stub back in the queue, after tailP, so that tailP can be taken out
+  //
+  notificationQueuePush(queueP, &queueP->stub);
+
+  nextP = __atomic_load_n(&tailP->next, __ATOMIC_ACQUIRE);
+  if (nextP != NULL)
+  {
+    queueP->tail = nextP;
+    return tailP;
+  }
+
+  return NULL;
+}
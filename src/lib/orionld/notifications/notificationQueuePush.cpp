@@ -0,0 +1,46 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                              // NULL
+
+#include "orionld/notifications/notificationQueue.h"             // NotificationQueue, NotificationRecord
+#include "orionld/notifications/notificationQueuePush.h"         // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueuePush -
+//
+// The record becomes the new head with one atomic exchange, and is then linked after the previous head.
+// Between the two steps, the consumer sees the queue as ending at the previous head (it retries later).
+//
+void notificationQueuePush(NotificationQueue* queueP, NotificationRecord* recordP)
+{
+  __atomic_store_n(&recordP->next, (NotificationRecord*) NULL, __ATOMIC_RELAXED);
+
+  NotificationRecord* prevP = __atomic_exchange_n(&queueP->head, recordP, __ATOMIC_ACQ_REL);
+
+  __atomic_store_n(&prevP->next, recordP, __ATOMIC_RELEASE);
+}
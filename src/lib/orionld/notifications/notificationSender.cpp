@@ -0,0 +1,391 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strerror, bzero
+#include <stdlib.h>                                              // calloc, free
+#include <stdint.h>                                              // uint64_t
+#include <errno.h>                                               // errno
+#include <unistd.h>                                              // read
+#include <time.h>                                                // clock_gettime
+#include <sys/epoll.h>                                           // epoll_wait, epoll_ctl
+#include <sys/socket.h>                                          // send, recv, getsockopt
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldEndpointConnect.h"               // orionldEndpointConnect
+#include "orionld/common/orionldEndpointRelease.h"               // orionldEndpointRelease
+#include "orionld/common/OrionldHttpResponseParser.h"            // OrionldHttpResponseParser
+#include "orionld/common/orionldHttpResponseParse.h"             // orionldHttpResponseParse
+#include "orionld/notifications/notificationQueue.h"             // Notification Sender Internals
+#include "orionld/notifications/notificationQueuePop.h"          // notificationQueuePop
+#include "orionld/notifications/notificationSender.h"            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TransferState -
+//
+typedef enum TransferState
+{
+  TransferConnecting,
+  TransferSending,
+  TransferReceiving,
+  TransferWaiting,     // Waiting to be retried
+  TransferDone         // To be freed
+} TransferState;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Transfer - the delivery of one notification record
+//
+// 'deadline' is the timeout of the ongoing attempt, or, for TransferWaiting, the time of the next attempt.
+// 'parser' keeps the state of the response between reads, as the response may arrive in more than one piece.
+//
+typedef struct Transfer
+{
+  NotificationRecord*        recordP;
+  TransferState              state;
+  int                        fd;
+  OrionldEndpoint*           endpointP;
+  bool                       reused;
+  int                        sent;
+  long long                  deadline;
+  OrionldHttpResponseParser  parser;
+  struct Transfer*           next;
+} Transfer;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// msNow - monotonic time in milliseconds
+//
+static long long msNow(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return now.tv_sec * 1000LL + now.tv_nsec / 1000000;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// latencyRecord - add the latency of a delivered notification (from queued to response received) to the histogram
+//
+static void latencyRecord(NotificationRecord* recordP)
+{
+  long long  queuedAt = recordP->queuedAt.tv_sec * 1000LL + recordP->queuedAt.tv_nsec / 1000000;
+  long long  latency  = msNow() - queuedAt;
+  int        bucket   = 0;
+
+  while ((bucket < NOTIFICATION_LATENCY_BUCKETS - 1) && (latency >= notificationLatencyLimits[bucket]))
+    ++bucket;
+
+  __sync_fetch_and_add(&notificationStats.latency[bucket], 1);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// transferEnd - the end of an attempt: done, or to be retried
+//
+// statusCode is the HTTP status code of the response, or -1 if the attempt failed before a response was received
+//
+static void transferEnd(NotificationSender* senderP, Transfer* tP, int statusCode, bool keepAlive)
+{
+  NotificationRecord* recordP = tP->recordP;
+
+  if (tP->fd != -1)
+  {
+    epoll_ctl(senderP->epollFd, EPOLL_CTL_DEL, tP->fd, NULL);
+    orionldEndpointRelease(tP->endpointP, tP->fd, (statusCode != -1) && (keepAlive == true));
+    tP->fd = -1;
+  }
+
+  __sync_fetch_and_sub(&notificationStats.inFlight, 1);
+
+  if ((statusCode >= 200) && (statusCode < 300))
+  {
+    __sync_fetch_and_add(&notificationStats.delivered, 1);
+    latencyRecord(recordP);
+    tP->state = TransferDone;
+  }
+  else if (((statusCode == -1) || (statusCode >= 500)) && (recordP->attempts < NOTIFICATION_ATTEMPTS))
+  {
+    __sync_fetch_and_add(&notificationStats.retries, 1);
+    tP->state    = TransferWaiting;
+    tP->deadline = msNow() + (NOTIFICATION_RETRY_DELAY_MS << (recordP->attempts - 1));
+  }
+  else if ((statusCode == -1) || (statusCode >= 500))
+  {
+    __sync_fetch_and_add(&notificationStats.failed, 1);
+    LM_W(("Notification for subscription '%s' to %s:%d failed after %d attempts", recordP->subscriptionId, recordP->host, recordP->port, recordP->attempts));
+    tP->state = TransferDone;
+  }
+  else
+  {
+    __sync_fetch_and_add(&notificationStats.rejected, 1);
+    LM_W(("Notification for subscription '%s' to %s:%d: response status code %d", recordP->subscriptionId, recordP->host, recordP->port, statusCode));
+    tP->state = TransferDone;
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// transferStart - start an attempt: connect (or reuse a keep-alive connection) and wait for the socket to be writable
+//
+// If the endpoint has no free connection (all its connections are in use), the transfer stays pending, without
+// counting it as an attempt, and the connection is tried again after NOTIFICATION_POOL_WAIT_MS.
+//
+static void transferStart(NotificationSender* senderP, Transfer* tP)
+{
+  NotificationRecord*  recordP = tP->recordP;
+  struct epoll_event   ev;
+
+  tP->fd = orionldEndpointConnect(recordP->host, recordP->port, true, 0, &tP->endpointP, &tP->reused);
+
+  if ((tP->fd == -1) && (errno == EAGAIN))
+  {
+    tP->state    = TransferWaiting;
+    tP->deadline = msNow() + NOTIFICATION_POOL_WAIT_MS;
+    return;
+  }
+
+  recordP->attempts += 1;
+  __sync_fetch_and_add(&notificationStats.sent, 1);
+  __sync_fetch_and_add(&notificationStats.inFlight, 1);
+
+  tP->sent     = 0;
+  tP->deadline = msNow() + NOTIFICATION_TIMEOUT_MS;
+
+  if (tP->fd == -1)
+  {
+    transferEnd(senderP, tP, -1, false);
+    return;
+  }
+
+  bzero(&tP->parser, sizeof(tP->parser));
+
+  tP->state   = (tP->reused == true)? TransferSending : TransferConnecting;
+  ev.events   = EPOLLOUT;
+  ev.data.ptr = tP;
+
+  if (epoll_ctl(senderP->epollFd, EPOLL_CTL_ADD, tP->fd, &ev) == -1)
+  {
+    LM_E(("Internal Error (epoll_ctl: %s)", strerror(errno)));
+    transferEnd(senderP, tP, -1, false);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// transferProgress - treat an epoll event of a transfer
+//
+// The response is read without blocking - whatever is available when the socket is readable - and fed to the
+// response parser of the transfer. The transfer ends when the parser has seen the entire response. If the response
+// doesn't arrive before the deadline of the attempt, the transfer times out in the loop of notificationSender.
+//
+static void transferProgress(NotificationSender* senderP, Transfer* tP, uint32_t events, char* buf, int bufSize)
+{
+  NotificationRecord* recordP = tP->recordP;
+
+  if (tP->state == TransferConnecting)
+  {
+    int        err    = 0;
+    socklen_t  errLen = sizeof(err);
+
+    if ((getsockopt(tP->fd, SOL_SOCKET, SO_ERROR, &err, &errLen) == -1) || (err != 0))
+    {
+      LM_W(("Unable to connect to %s:%d for notification of subscription '%s': %s", recordP->host, recordP->port, recordP->subscriptionId, strerror(err)));
+      transferEnd(senderP, tP, -1, false);
+      return;
+    }
+
+    tP->state = TransferSending;
+  }
+
+  if (tP->state == TransferSending)
+  {
+    int nb = send(tP->fd, &recordP->request[tP->sent], recordP->requestLen - tP->sent, MSG_NOSIGNAL);
+
+    if (nb == -1)
+    {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+        transferEnd(senderP, tP, -1, false);
+      return;
+    }
+
+    tP->sent += nb;
+
+    if (tP->sent == recordP->requestLen)
+    {
+      struct epoll_event ev;
+
+      ev.events   = EPOLLIN;
+      ev.data.ptr = tP;
+
+      epoll_ctl(senderP->epollFd, EPOLL_CTL_MOD, tP->fd, &ev);
+      tP->state = TransferReceiving;
+    }
+  }
+  else if ((tP->state == TransferReceiving) && ((events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0))
+  {
+    while (1)
+    {
+      int nb = recv(tP->fd, buf, bufSize, MSG_DONTWAIT);
+
+      if (nb == -1)
+      {
+        if (errno == EINTR)
+          continue;
+
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+        {
+          LM_W(("Error reading the response to a notification for subscription '%s' from %s:%d: %s", recordP->subscriptionId, recordP->host, recordP->port, strerror(errno)));
+          transferEnd(senderP, tP, -1, false);
+        }
+
+        return;
+      }
+
+      int statusCode = orionldHttpResponseParse(&tP->parser, buf, nb);
+
+      if (statusCode != 0)
+      {
+        transferEnd(senderP, tP, statusCode, tP->parser.keepAlive);
+        return;
+      }
+    }
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationSender -
+//
+// Loop:
+//   1. Wait for events on the ongoing transfers (or on the event fd, written when a notification is queued),
+//      at most until the closest deadline
+//   2. Treat the events
+//   3. Start a transfer for each newly queued notification
+//   4. Time out transfers whose deadline has passed, start the retries that are due, free finished transfers
+//
+void* notificationSender(void* vP)
+{
+  NotificationSender*  senderP      = (NotificationSender*) vP;
+  Transfer*            transferList = NULL;
+  struct epoll_event   events[64];
+  char                 buf[8 * 1024];
+
+  while (1)
+  {
+    long long now       = msNow();
+    long long timeoutMs = 1000;
+
+    for (Transfer* tP = transferList; tP != NULL; tP = tP->next)
+    {
+      if (tP->deadline - now < timeoutMs)
+        timeoutMs = (tP->deadline > now)? tP->deadline - now : 0;
+    }
+
+    int nEvents = epoll_wait(senderP->epollFd, events, 64, timeoutMs);
+
+    if ((nEvents == -1) && (errno != EINTR))
+      LM_E(("Internal Error (epoll_wait: %s)", strerror(errno)));
+
+    for (int ix = 0; ix < nEvents; ix++)
+    {
+      Transfer* tP = (Transfer*) events[ix].data.ptr;
+
+      if (tP == NULL)
+      {
+        uint64_t counter;
+
+        if (read(senderP->eventFd, &counter, sizeof(counter)) == -1)
+          LM_E(("Internal Error (reading event fd of notification sender %d: %s)", senderP->index, strerror(errno)));
+      }
+      else if ((tP->state != TransferWaiting) && (tP->state != TransferDone))
+        transferProgress(senderP, tP, events[ix].events, buf, sizeof(buf));
+    }
+
+    NotificationRecord* recordP;
+    while ((recordP = notificationQueuePop(&senderP->queue)) != NULL)
+    {
+      Transfer* tP = (Transfer*) calloc(1, sizeof(Transfer));
+
+      if (tP == NULL)
+        LM_X(1, ("Runtime Error (out of memory allocating a notification transfer)"));
+
+      __sync_fetch_and_sub(&notificationStats.queueDepth, 1);
+
+      tP->recordP  = recordP;
+      tP->fd       = -1;
+      tP->next     = transferList;
+      transferList = tP;
+
+      transferStart(senderP, tP);
+    }
+
+    now = msNow();
+
+    Transfer** tPP = &transferList;
+    while (*tPP != NULL)
+    {
+      Transfer* tP = *tPP;
+
+      if ((tP->state == TransferWaiting) && (tP->deadline <= now))
+        transferStart(senderP, tP);
+      else if ((tP->state != TransferWaiting) && (tP->state != TransferDone) && (tP->deadline <= now))
+      {
+        __sync_fetch_and_add(&notificationStats.timeouts, 1);
+        transferEnd(senderP, tP, -1, false);
+      }
+
+      if (tP->state == TransferDone)
+      {
+        *tPP = tP->next;
+        free(tP->recordP);
+        free(tP);
+      }
+      else
+        tPP = &tP->next;
+    }
+  }
+
+  return NULL;
+}
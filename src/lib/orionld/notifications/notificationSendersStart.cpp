@@ -0,0 +1,85 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strerror, bzero
+#include <stdlib.h>                                              // calloc
+#include <errno.h>                                               // errno
+#include <pthread.h>                                             // pthread_create
+#include <sys/epoll.h>                                           // epoll_create1, epoll_ctl
+#include <sys/eventfd.h>                                         // eventfd
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/notifications/notificationQueue.h"             // NotificationSender, notificationSenderV, ...
+#include "orionld/notifications/notificationSender.h"            // notificationSender
+#include "orionld/notifications/notificationSendersStart.h"      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationSendersStart -
+//
+void notificationSendersStart(int senders, int queueMaxDepth)
+{
+  bzero(&notificationStats, sizeof(notificationStats));
+  notificationQueueMaxDepth = queueMaxDepth;
+
+  if (senders <= 0)
+    return;
+
+  notificationSenderV = (NotificationSender*) calloc(senders, sizeof(NotificationSender));
+  if (notificationSenderV == NULL)
+    LM_X(1, ("Runtime Error (out of memory allocating %d notification senders)", senders));
+
+  for (int ix = 0; ix < senders; ix++)
+  {
+    NotificationSender*  senderP = &notificationSenderV[ix];
+    struct epoll_event   ev;
+
+    senderP->index            = ix;
+    senderP->queue.stub.next  = NULL;
+    senderP->queue.head       = &senderP->queue.stub;
+    senderP->queue.tail       = &senderP->queue.stub;
+
+    if ((senderP->epollFd = epoll_create1(0)) == -1)
+      LM_X(1, ("Fatal Error (epoll_create1: %s)", strerror(errno)));
+
+    if ((senderP->eventFd = eventfd(0, EFD_NONBLOCK)) == -1)
+      LM_X(1, ("Fatal Error (eventfd: %s)", strerror(errno)));
+
+    ev.events   = EPOLLIN;
+    ev.data.ptr = NULL;  // NULL identifies the event fd
+    if (epoll_ctl(senderP->epollFd, EPOLL_CTL_ADD, senderP->eventFd, &ev) == -1)
+      LM_X(1, ("Fatal Error (epoll_ctl: %s)", strerror(errno)));
+
+    int s = pthread_create(&senderP->tid, NULL, notificationSender, senderP);
+    if (s != 0)
+      LM_X(1, ("Fatal Error (pthread_create: %s)", strerror(s)));
+  }
+
+  // Not before all senders are ready - notificationEnqueue uses notificationSenders to pick a sender
+  notificationSenders = senders;
+}
@@ -0,0 +1,94 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                             // strcmp
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                       // KjNode
+#include "kjson/kjBuilder.h"                                    // kjInteger, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                      // LM_*
+#include "logMsg/traceLevels.h"                                 // Lmt*
+
+#include "rest/ConnectionInfo.h"                                // ConnectionInfo
+
+#include "orionld/common/CHECK.h"                               // INTEGER_CHECK, ...
+#include "orionld/common/orionldState.h"                        // orionldState
+#include "orionld/common/orionldErrorResponse.h"                // orionldErrorResponseCreate
+#include "orionld/notifications/notificationBatch.h"            // NOTIFICATION_BATCH_*
+#include "orionld/payloadCheck/pcheckBatch.h"                   // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// pcheckBatch -
+//
+bool pcheckBatch(ConnectionInfo* ciP, KjNode* batchP)
+{
+  KjNode* maxEntitiesP = NULL;
+  KjNode* maxDelayP    = NULL;
+
+  for (KjNode* bItemP = batchP->value.firstChildP; bItemP != NULL; bItemP = bItemP->next)
+  {
+    if (strcmp(bItemP->name, "maxEntities") == 0)
+    {
+      DUPLICATE_CHECK(maxEntitiesP, "batch::maxEntities", bItemP);
+      INTEGER_CHECK(maxEntitiesP, "batch::maxEntities");
+      if ((maxEntitiesP->value.i < 1) || (maxEntitiesP->value.i > NOTIFICATION_BATCH_MAX_ENTITIES_MAX))
+      {
+        orionldErrorResponseCreate(OrionldBadRequestData, "Invalid value for 'batch::maxEntities'", "must be an integer between 1 and 1000");
+        ciP->httpStatusCode = SccBadRequest;
+        return false;
+      }
+    }
+    else if (strcmp(bItemP->name, "maxDelay") == 0)
+    {
+      DUPLICATE_CHECK(maxDelayP, "batch::maxDelay", bItemP);
+      INTEGER_CHECK(maxDelayP, "batch::maxDelay");
+      if ((maxDelayP->value.i < 1) || (maxDelayP->value.i > NOTIFICATION_BATCH_MAX_DELAY_MAX))
+      {
+        orionldErrorResponseCreate(OrionldBadRequestData, "Invalid value for 'batch::maxDelay'", "must be an integer between 1 and 60000 (milliseconds)");
+        ciP->httpStatusCode = SccBadRequest;
+        return false;
+      }
+    }
+    else
+    {
+      orionldErrorResponseCreate(OrionldBadRequestData, "Invalid field for 'batch'", bItemP->name);
+      ciP->httpStatusCode = SccBadRequest;
+      return false;
+    }
+  }
+
+  if (maxEntitiesP == NULL)
+    kjChildAdd(batchP, kjInteger(orionldState.kjsonP, "maxEntities", NOTIFICATION_BATCH_MAX_ENTITIES_DEFAULT));
+
+  if (maxDelayP == NULL)
+    kjChildAdd(batchP, kjInteger(orionldState.kjsonP, "maxDelay", NOTIFICATION_BATCH_MAX_DELAY_DEFAULT));
+
+  return true;
+}
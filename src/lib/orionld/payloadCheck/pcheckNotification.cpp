@@ -37,6 +37,7 @@ extern "C"
 #include "orionld/common/orionldErrorResponse.h"                // orionldErrorResponseCreate
 #include "orionld/context/orionldContextItemExpand.h"           // orionldContextItemExpand
 #include "orionld/payloadCheck/pcheckEndpoint.h"                // pcheckEndpoint
+#include "orionld/payloadCheck/pcheckBatch.h"                   // pcheckBatch
 #include "orionld/payloadCheck/pcheckNotification.h"            // Own interface
 
 
@@ -50,6 +51,7 @@ bool pcheckNotification(ConnectionInfo* ciP, KjNode* notificationP)
   KjNode* attributesP = NULL;
   KjNode* formatP     = NULL;
   KjNode* endpointP   = NULL;
+  KjNode* batchP      = NULL;
 
   OBJECT_CHECK(notificationP, "notification");
   EMPTY_OBJECT_CHECK(notificationP, "notification");
@@ -88,6 +90,13 @@ bool pcheckNotification(ConnectionInfo* ciP, KjNode* notificationP)
       if (pcheckEndpoint(ciP, endpointP) == false)
         return false;
     }
+    else if (strcmp(nItemP->name, "batch") == 0)
+    {
+      DUPLICATE_CHECK(batchP, "batch", nItemP);
+      OBJECT_CHECK(batchP, "batch");
+      if (pcheckBatch(ciP, batchP) == false)
+        return false;
+    }
     else if (strcmp(nItemP->name, "status") == 0)
     {
       orionldErrorResponseCreate(OrionldBadRequestData, "Invalid field for notification", "'status' is read-only");
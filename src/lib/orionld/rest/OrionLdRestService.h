@@ -26,6 +26,7 @@
 * Author: Ken Zangelin
 */
 #include "rest/ConnectionInfo.h"
+#include "orionld/types/OrionldLatencyHistogram.h"
 
 
 
@@ -115,6 +116,7 @@ typedef struct OrionLdRestService
   char                   matchForSecondWildcard[16];    // E.g. "/attrs/" for [/ngsi-ld/v1]/entities/*/attrs/*
   int                    matchForSecondWildcardLen;     // strlen of last path to match
   uint32_t               options;                       // Peculiarities of this type of requests
+  OrionldServiceLatency* latencyP;                      // Latency histograms - allocated on first use, see orionldSpanEnd()
 } OrionLdRestService;
 
 
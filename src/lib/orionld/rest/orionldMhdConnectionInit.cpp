@@ -37,6 +37,7 @@ extern "C"
 #include "rest/ConnectionInfo.h"                                 // ConnectionInfo
 #include "orionld/common/orionldErrorResponse.h"                 // OrionldBadRequestData, ...
 #include "orionld/common/orionldState.h"                         // orionldState, orionldStateInit
+#include "orionld/common/orionldSpanStart.h"                     // orionldSpanStart
 #include "orionld/common/SCOMPARE.h"                             // SCOMPARE
 #include "orionld/rest/temporaryErrorPayloads.h"                 // Temporary Error Payloads
 #include "orionld/rest/orionldMhdConnectionInit.h"               // Own interface
@@ -294,6 +295,7 @@ int orionldMhdConnectionInit
   //
   orionldStateInit();
   orionldState.ciP = ciP;
+  orionldSpanStart();
 
 
   // The 'connection', as given by MHD is very important. No responses can be sent without it
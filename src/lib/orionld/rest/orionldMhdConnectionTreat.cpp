@@ -30,7 +30,6 @@ extern "C"
 #include "kjson/KjNode.h"                                        // KjNode
 #include "kjson/kjBufferCreate.h"                                // kjBufferCreate
 #include "kjson/kjParse.h"                                       // kjParse
-#include "kjson/kjRender.h"                                      // kjRender
 #include "kjson/kjClone.h"                                       // kjClone
 #include "kjson/kjFree.h"                                        // kjFree
 #include "kjson/kjBuilder.h"                                     // kjString, ...
@@ -41,7 +40,6 @@ extern "C"
 #include "common/string.h"                                       // FT
 #include "rest/ConnectionInfo.h"                                 // ConnectionInfo
 #include "rest/httpHeaderAdd.h"                                  // httpHeaderAdd, httpHeaderLinkAdd
-#include "rest/restReply.h"                                      // restReply
 
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
 #include "orionld/common/OrionldProblemDetails.h"                // OrionldProblemDetails
@@ -51,12 +49,14 @@ extern "C"
 #include "orionld/common/orionldState.h"                         // orionldState, orionldHostName
 #include "orionld/common/uuidGenerate.h"                         // uuidGenerate
 #include "orionld/common/orionldEntityPayloadCheck.h"            // orionldValidName  - FIXME: Own file for "orionldValidName()"!
+#include "orionld/common/orionldSpanMark.h"                      // orionldSpanMark
 #include "orionld/context/orionldCoreContext.h"                  // ORIONLD_CORE_CONTEXT_URL
 #include "orionld/context/orionldContextFromUrl.h"               // orionldContextFromUrl
 #include "orionld/context/orionldContextFromTree.h"              // orionldContextFromTree
 #include "orionld/serviceRoutines/orionldBadVerb.h"              // orionldBadVerb
 #include "orionld/rest/orionldServiceInit.h"                     // orionldRestServiceV
 #include "orionld/rest/orionldServiceLookup.h"                   // orionldServiceLookup
+#include "orionld/rest/orionldResponseSend.h"                    // orionldResponseSend
 #include "orionld/rest/temporaryErrorPayloads.h"                 // Temporary Error Payloads
 #include "orionld/rest/orionldMhdConnectionTreat.h"              // Own Interface
 
@@ -644,13 +644,13 @@ static void contextToPayload(void)
 //   19. Check for existing responseTree, in case of httpStatusCode >= 400 (except for 405)
 //   20. If (orionldState.acceptNgsild): Add orionldState.payloadContextTree to orionldState.responseTree
 //   21. If (orionldState.acceptNgsi):   Set HTTP Header "Link" to orionldState.contextP->url
-//   22. Render response tree
-//   23. IF accept == app/json, add the Link HTTP header
-//   24. REPLY
-//   25. Cleanup
-//   26. DONE
-//
+//   22. IF accept == app/json, add the Link HTTP header
+//   23. Render response tree and REPLY - right-sized buffer or, for big arrays, streamed
+//   24. Cleanup (postponed until MHD is done with the response if streamed)
+//   25. DONE
 //
+// The time spent in the different steps is accumulated per phase with orionldSpanMark() (see OrionldPhase).
+// The span is started in orionldMhdConnectionInit() and ended in requestCompleted() (rest.cpp).
 //
 int orionldMhdConnectionTreat(ConnectionInfo* ciP)
 {
@@ -658,6 +658,7 @@ int orionldMhdConnectionTreat(ConnectionInfo* ciP)
   bool     serviceRoutineResult = false;
 
   LM_T(LmtMhd, ("Read all the payload - treating the request!"));
+  orionldSpanMark(OrionldPhaseRead);
 
   //
   // 01. Predetected Error?
@@ -672,6 +673,7 @@ int orionldMhdConnectionTreat(ConnectionInfo* ciP)
   //
   if ((orionldState.serviceP = serviceLookup(ciP)) == NULL)
     goto respond;
+  orionldSpanMark(OrionldPhaseLookup);
 
   //
   // 03. Check for empty payload for POST/PATCH/PUT
@@ -693,6 +695,7 @@ int orionldMhdConnectionTreat(ConnectionInfo* ciP)
   //
   if ((ciP->payload != NULL) && (payloadParseAndExtractSpecialFields(ciP, &contextToBeCashed) == false))
     goto respond;
+  orionldSpanMark(OrionldPhaseParse);
 
 
   //
@@ -707,6 +710,7 @@ int orionldMhdConnectionTreat(ConnectionInfo* ciP)
   //
   if (acceptHeaderExtractAndCheck(ciP) == false)
     goto respond;
+  orionldSpanMark(OrionldPhaseChecks);
 
   //
   // 07. Check the @context in HTTP Header, if present
@@ -742,6 +746,7 @@ int orionldMhdConnectionTreat(ConnectionInfo* ciP)
     orionldState.contextP = orionldCoreContextP;
 
   orionldState.link = orionldState.contextP->url;
+  orionldSpanMark(OrionldPhaseContext);
 
   // ********************************************************************************************
   //
@@ -750,6 +755,7 @@ int orionldMhdConnectionTreat(ConnectionInfo* ciP)
   LM_T(LmtServiceRoutine, ("Calling Service Routine %s (context at %p)", orionldState.serviceP->url, orionldState.contextP));
 
   serviceRoutineResult = orionldState.serviceP->serviceRoutine(ciP);
+  orionldSpanMark(OrionldPhaseService);
   LM_T(LmtServiceRoutine, ("service routine '%s %s' done", orionldState.verbString, orionldState.serviceP->url));
 
   //
@@ -823,37 +829,15 @@ int orionldMhdConnectionTreat(ConnectionInfo* ciP)
       if ((orionldState.acceptJsonld == true) && (ciP->httpStatusCode < 300))
         contextToPayload();
     }
-
-
-    //
-    // Render the payload to get a string for restReply to send the response
-    //
-    // FIXME: Smarter allocation !!!
-    //
-    int bufLen = 1024 * 1024 * 32;
-    orionldState.responsePayload = (char*) malloc(bufLen);
-    if (orionldState.responsePayload != NULL)
-    {
-      orionldState.responsePayloadAllocated = true;
-      kjRender(orionldState.kjsonP, orionldState.responseTree, orionldState.responsePayload, bufLen);
-    }
-    else
-    {
-      LM_E(("Error allocating buffer for response payload"));
-      orionldErrorResponseCreate(OrionldInternalError, "Out of memory", NULL);
-    }
   }
 
-  if (orionldState.responsePayload != NULL)
-    restReply(ciP, orionldState.responsePayload);    // orionldState.responsePayload freed and NULLed by restReply()
-  else
-    restReply(ciP, "");
-
-
   //
-  // Cleanup
+  // Render the payload (if any) and send the response
+  //
+  // If the response is streamed, orionldStateRelease is called once MHD is done with the response
   //
-  orionldStateRelease();
+  if (orionldResponseSend(ciP) == false)
+    orionldStateRelease();
 
   return MHD_YES;
 }
@@ -0,0 +1,320 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // malloc, realloc, free
+#include <string.h>                                              // strlen, memcpy
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjRender.h"                                      // kjRender
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "rest/ConnectionInfo.h"                                 // ConnectionInfo
+#include "rest/rest.h"                                           // restThreadPoolSizeGet
+#include "rest/restReply.h"                                      // restReply, restReplyFromCallback
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/orionldSpanMark.h"                      // orionldSpanMark
+#include "orionld/kjTree/kjTreeRenderSize.h"                     // kjTreeRenderSize
+#include "orionld/rest/orionldResponseSend.h"                    // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// RENDER_BUFFER_MAX_SIZE - max size of the per-thread render buffer
+//
+// Responses that fit in this size are rendered in a buffer that is kept and reused by the thread.
+// Bigger responses are either streamed or rendered in an allocated buffer of the exact size needed
+//
+#define RENDER_BUFFER_MAX_SIZE  (64 * 1024)
+
+
+
+// -----------------------------------------------------------------------------
+//
+// STREAM_MIN_SIZE - responses smaller than this are never streamed
+//
+#define STREAM_MIN_SIZE  RENDER_BUFFER_MAX_SIZE
+
+
+
+// -----------------------------------------------------------------------------
+//
+// renderBuffer - per-thread buffer for rendering of small responses
+//
+static __thread char*  renderBuffer     = NULL;
+static __thread int    renderBufferSize = 0;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ResponseStream - state of a streamed response
+//
+// The response tree is a JSON Array and its items are rendered one by one, as MHD asks for more data.
+// Only one item is rendered at a time, in 'chunk', a buffer that is reused for all items of the array.
+//
+typedef struct ResponseStream
+{
+  Kjson*   kjsonP;
+  KjNode*  itemP;       // Next item of the array to be rendered
+  bool     started;     // The start bracket '[' has been rendered
+  bool     ended;       // The end bracket ']' has been rendered
+  char*    chunk;
+  int      chunkSize;   // Allocated size of 'chunk'
+  int      chunkLen;    // Length of the rendered data in 'chunk'
+  int      chunkPos;    // How much of the rendered data in 'chunk' has been handed over to MHD
+} ResponseStream;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// responseStreamChunkFill - render the next item of the array into the chunk
+//
+// Returns false when there is nothing more to render.
+//
+static bool responseStreamChunkFill(ResponseStream* rsP)
+{
+  int size;
+  int len = 0;
+
+  if (rsP->ended == true)
+    return false;
+
+  size = (rsP->itemP != NULL)? kjTreeRenderSize(rsP->kjsonP, rsP->itemP) + 3 : 3;  // +3: '[', ',' and ']'
+
+  if (size > rsP->chunkSize)
+  {
+    char* chunk = (char*) realloc(rsP->chunk, size);
+
+    if (chunk == NULL)
+    {
+      LM_E(("Out of memory (allocating %d bytes for a chunk of a streamed response)", size));
+      return false;
+    }
+
+    rsP->chunk     = chunk;
+    rsP->chunkSize = size;
+  }
+
+  if (rsP->started == false)
+  {
+    rsP->chunk[len++] = '[';
+    rsP->started      = true;
+  }
+  else if (rsP->itemP != NULL)
+    rsP->chunk[len++] = ',';
+
+  if (rsP->itemP != NULL)
+  {
+    kjRender(rsP->kjsonP, rsP->itemP, &rsP->chunk[len], rsP->chunkSize - len);
+    len += strlen(&rsP->chunk[len]);
+
+    rsP->itemP = rsP->itemP->next;
+  }
+  else
+  {
+    rsP->chunk[len++] = ']';
+    rsP->ended        = true;
+  }
+
+  rsP->chunkLen = len;
+  rsP->chunkPos = 0;
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// responseStreamRead - MHD content reader callback
+//
+static ssize_t responseStreamRead(void* cls, uint64_t pos, char* buf, size_t max)
+{
+  ResponseStream* rsP     = (ResponseStream*) cls;
+  size_t          written = 0;
+
+  while (written < max)
+  {
+    if ((rsP->chunkPos == rsP->chunkLen) && (responseStreamChunkFill(rsP) == false))
+      break;
+
+    size_t left  = rsP->chunkLen - rsP->chunkPos;
+    size_t bytes = (left < max - written)? left : max - written;
+
+    memcpy(&buf[written], &rsP->chunk[rsP->chunkPos], bytes);
+    rsP->chunkPos += bytes;
+    written       += bytes;
+  }
+
+  if (written == 0)
+    return (rsP->ended == true)? MHD_CONTENT_READER_END_OF_STREAM : MHD_CONTENT_READER_END_WITH_ERROR;
+
+  return written;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// responseStreamFree - MHD content reader free callback
+//
+// MHD is done with the response, so the state of the request can finally be released
+//
+static void responseStreamFree(void* cls)
+{
+  ResponseStream* rsP = (ResponseStream*) cls;
+
+  free(rsP->chunk);
+  free(rsP);
+
+  orionldStateRelease();
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// responseStreamable -
+//
+// A response is streamed only if:
+//   - MHD runs in 'thread per connection' mode. The response tree lives in the thread-local orionldState and with a
+//     thread pool, the thread may serve other connections before MHD asks for more data of this response.
+//   - The response tree is an array (a list of entities, subscriptions, ...)
+//   - Pretty-print isn't used. The items are rendered one by one, and their indentation would be wrong.
+//   - The response is big
+//
+static bool responseStreamable(int size)
+{
+  if (restThreadPoolSizeGet() != 0)
+    return false;
+
+  if (orionldState.responseTree->type != KjArray)
+    return false;
+
+  if (orionldState.prettyPrint == true)
+    return false;
+
+  return size > STREAM_MIN_SIZE;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// responseStream -
+//
+static bool responseStream(ConnectionInfo* ciP)
+{
+  ResponseStream* rsP = (ResponseStream*) calloc(1, sizeof(ResponseStream));
+
+  if (rsP == NULL)
+    return false;
+
+  rsP->kjsonP = orionldState.kjsonP;
+  rsP->itemP  = orionldState.responseTree->value.firstChildP;
+
+  if (restReplyFromCallback(ciP, responseStreamRead, responseStreamFree, rsP) == false)
+  {
+    free(rsP);
+    return false;
+  }
+
+  orionldSpanMark(OrionldPhaseReply);  // Rendering of streamed responses is done by MHD, and accounted for as 'send'
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldResponseSend -
+//
+// The buffer for the rendered response is sized according to kjTreeRenderSize():
+//   - small responses are rendered in a per-thread buffer that is reused for all requests of the thread
+//   - big responses are streamed, if possible (see responseStreamable), or rendered in an allocated buffer
+//
+bool orionldResponseSend(ConnectionInfo* ciP)
+{
+  if (orionldState.responseTree != NULL)
+  {
+    int size = kjTreeRenderSize(orionldState.kjsonP, orionldState.responseTree);
+
+    if ((responseStreamable(size) == true) && (responseStream(ciP) == true))
+      return true;
+
+    if (size <= RENDER_BUFFER_MAX_SIZE)
+    {
+      if (size > renderBufferSize)
+      {
+        int   newSize = (size < 4096)? 4096 : RENDER_BUFFER_MAX_SIZE;
+        char* bufP    = (char*) realloc(renderBuffer, newSize);
+
+        if (bufP != NULL)
+        {
+          renderBuffer     = bufP;
+          renderBufferSize = newSize;
+        }
+      }
+
+      if (size <= renderBufferSize)
+      {
+        kjRender(orionldState.kjsonP, orionldState.responseTree, renderBuffer, renderBufferSize);
+        orionldSpanMark(OrionldPhaseRender);
+        restReply(ciP, renderBuffer, strlen(renderBuffer));
+        orionldSpanMark(OrionldPhaseReply);
+        return false;
+      }
+    }
+
+    orionldState.responsePayload = (char*) malloc(size);
+    if (orionldState.responsePayload != NULL)
+    {
+      orionldState.responsePayloadAllocated = true;
+      kjRender(orionldState.kjsonP, orionldState.responseTree, orionldState.responsePayload, size);
+      orionldSpanMark(OrionldPhaseRender);
+    }
+    else
+    {
+      LM_E(("Error allocating buffer of %d bytes for response payload", size));
+      restReply(ciP, "");
+      return false;
+    }
+  }
+
+  if (orionldState.responsePayload != NULL)
+    restReply(ciP, orionldState.responsePayload, strlen(orionldState.responsePayload));  // orionldState.responsePayload freed and NULLed by restReply()
+  else
+    restReply(ciP, "");
+  orionldSpanMark(OrionldPhaseReply);
+
+  return false;
+}
@@ -56,6 +56,7 @@ extern "C"
 #include "orionld/serviceRoutines/orionldGetSubscription.h"          // orionldGetSubscription
 #include "orionld/serviceRoutines/orionldPostRegistrations.h"        // orionldPostRegistrations
 #include "orionld/serviceRoutines/orionldGetVersion.h"               // orionldGetVersion
+#include "orionld/serviceRoutines/orionldGetStatistics.h"            // orionldGetStatistics
 #include "orionld/serviceRoutines/orionldPostBatchDeleteEntities.h"  // orionldPostBatchDeleteEntities
 #include "orionld/rest/orionldMhdConnection.h"                       // Own Interface
 
@@ -216,6 +217,10 @@ static void restServicePrepare(OrionLdRestService* serviceP, OrionLdRestServiceS
   {
     serviceP->options  = ORIONLD_SERVICE_OPTION_DONT_ADD_CONTEXT_TO_RESPONSE_PAYLOAD;
   }
+  else if (serviceP->serviceRoutine == orionldGetStatistics)
+  {
+    serviceP->options  = ORIONLD_SERVICE_OPTION_DONT_ADD_CONTEXT_TO_RESPONSE_PAYLOAD;
+  }
   else if (serviceP->serviceRoutine == orionldPostRegistrations)
   {
     serviceP->options  = ORIONLD_SERVICE_OPTION_PREFETCH_ID_AND_TYPE;
@@ -25,12 +25,14 @@
 #include "logMsg/logMsg.h"                                        // LM_*
 #include "logMsg/traceLevels.h"                                   // Lmt*
 
+#include "common/globals.h"                                       // noCache
 #include "rest/ConnectionInfo.h"                                  // ConnectionInfo
 #include "orionld/common/orionldState.h"                          // orionldState
 #include "orionld/common/urlCheck.h"                              // urlCheck
 #include "orionld/common/urnCheck.h"                              // urnCheck
 #include "orionld/common/orionldErrorResponse.h"                  // orionldErrorResponseCreate
 #include "orionld/db/dbConfiguration.h"                           // dbRegistrationDelete
+#include "orionld/db/dbRegCacheTenantRefresh.h"                   // dbRegCacheTenantRefresh
 #include "orionld/serviceRoutines/orionldDeleteRegistration.h"    // Own Interface
 
 
@@ -67,6 +69,10 @@ bool orionldDeleteRegistration(ConnectionInfo* ciP)
     return false;
   }
 
+  // Forwarding lookups use the registration cache - the deleted registration must be removed from it
+  if (noCache == false)
+    dbRegCacheTenantRefresh(orionldState.tenant);
+
   ciP->httpStatusCode = SccNoContent;
 
   return true;
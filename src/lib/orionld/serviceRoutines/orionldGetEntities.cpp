@@ -29,6 +29,7 @@ extern "C"
 {
 #include "kbase/kStringSplit.h"                                // kStringSplit
 #include "kjson/kjBuilder.h"                                   // kjArray, kjChildAdd, ...
+#include "kjson/kjLookup.h"                                    // kjLookup
 }
 
 #include "logMsg/logMsg.h"                                     // LM_*
@@ -37,6 +38,8 @@ extern "C"
 #include "rest/ConnectionInfo.h"                               // ConnectionInfo
 #include "ngsi10/QueryContextRequest.h"                        // QueryContextRequest
 #include "ngsi10/QueryContextResponse.h"                       // QueryContextResponse
+#include "rest/uriParamNames.h"                                // URI_PARAM_PAGINATION_OFFSET, ...
+#include "rest/httpHeaderAdd.h"                                // httpHeaderLinkNextAdd
 #include "mongoBackend/mongoQueryContext.h"                    // mongoQueryContext
 
 #include "orionld/common/SCOMPARE.h"                           // SCOMPAREx
@@ -46,7 +49,11 @@ extern "C"
 #include "orionld/common/qParse.h"                             // qParse
 #include "orionld/common/qTreeToBsonObj.h"                     // qTreeToBsonObj
 #include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/common/pageTokenCreate.h"                    // pageTokenCreate
+#include "orionld/common/pageTokenParse.h"                     // pageTokenParse
 #include "orionld/kjTree/kjTreeFromQueryContextResponse.h"     // kjTreeFromQueryContextResponse
+#include "orionld/kjTree/kjTreeFromDbEntity.h"                 // kjTreeFromDbEntity
+#include "orionld/db/dbConfiguration.h"                        // dbEntitiesQuery
 #include "orionld/context/orionldCoreContext.h"                // orionldDefaultUrl
 #include "orionld/common/orionldErrorResponse.h"               // orionldErrorResponseCreate
 #include "orionld/context/orionldContextItemExpand.h"          // orionldContextItemExpand
@@ -54,6 +61,57 @@ extern "C"
 
 
 
+// ----------------------------------------------------------------------------
+//
+// entitySelectorAdd - add an entity selector for dbEntitiesQuery
+//
+// Same semantics as the EntityId of the QueryContextRequest for mongoBackend: an empty type matches all types
+//
+static void entitySelectorAdd(KjNode* selectorArray, const char* id, bool idIsPattern, const char* type, bool typeIsPattern)
+{
+  KjNode* selectorP = kjObject(orionldState.kjsonP, NULL);
+
+  kjChildAdd(selectorP, kjString(orionldState.kjsonP, (idIsPattern == true)? "idPattern" : "id", id));
+
+  if (*type != 0)
+    kjChildAdd(selectorP, kjString(orionldState.kjsonP, (typeIsPattern == true)? "typePattern" : "type", type));
+
+  kjChildAdd(selectorArray, selectorP);
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// entityCursorCreate - pagination cursor pointing to a DB entity (the last one of a page)
+//
+// The cursor holds the sort key of dbEntitiesQuery: creDate, entity id and entity type
+//
+static char* entityCursorCreate(KjNode* dbEntityP)
+{
+  KjNode*      _idP     = kjLookup(dbEntityP, "_id");
+  KjNode*      idP      = (_idP != NULL)? kjLookup(_idP, "id")   : NULL;
+  KjNode*      typeP    = (_idP != NULL)? kjLookup(_idP, "type") : NULL;
+  KjNode*      creDateP = kjLookup(dbEntityP, "creDate");
+  char         creDate[64];
+  const char*  fieldV[3];
+
+  if ((creDateP != NULL) && (creDateP->type == KjInt))
+    snprintf(creDate, sizeof(creDate), "%lld", creDateP->value.i);
+  else if ((creDateP != NULL) && (creDateP->type == KjFloat))
+    snprintf(creDate, sizeof(creDate), "%.17g", creDateP->value.f);
+  else
+    snprintf(creDate, sizeof(creDate), "0");
+
+  fieldV[0] = creDate;
+  fieldV[1] = ((idP   != NULL) && (idP->type   == KjString))? idP->value.s   : "";
+  fieldV[2] = ((typeP != NULL) && (typeP->type == KjString))? typeP->value.s : "";
+
+  return pageTokenCreate(fieldV, 3);
+}
+
+
+
 // ----------------------------------------------------------------------------
 //
 // orionldGetEntities -
@@ -71,6 +129,15 @@ extern "C"
 // - georel
 // - maxDistance
 // - options=keyValues
+// - cursor      (keyset pagination - the Link header (rel=next) of the previous page has it)
+//
+// Unless it's a geo-query (or the DB layer lacks dbEntitiesQuery), the query is performed by dbEntitiesQuery and
+// the DB entities are rendered straight into the response tree by kjTreeFromDbEntity.
+// mongoBackend (mongoQueryContext + kjTreeFromQueryContextResponse) is only used for geo-queries.
+//
+// When a page is full, a Link header with a cursor to the next page is added to the response.
+// Following the cursor, the next page is found via the index, at the same cost as the first page, while 'offset'
+// makes mongo skip all the entities of the previous pages.
 //
 bool orionldGetEntities(ConnectionInfo* ciP)
 {
@@ -97,6 +164,11 @@ bool orionldGetEntities(ConnectionInfo* ciP)
   bool                  keyValues      = ciP->uriParamOptions[OPT_KEY_VALUES];
   QueryContextRequest   mongoRequest;
   QueryContextResponse  mongoResponse;
+  bool                  nativeQuery    = (geometry == NULL) && (dbEntitiesQuery != NULL) && (ciP->uriParam[URI_PARAM_SORTED].empty());
+  KjNode*               selectorArray  = kjArray(orionldState.kjsonP, NULL);
+  KjNode*               attrsArray     = NULL;
+  char*                 cursor         = (ciP->uriParam[URI_PARAM_PAGINATION_CURSOR].empty())? NULL : (char*) ciP->uriParam[URI_PARAM_PAGINATION_CURSOR].c_str();
+  char*                 cursorV[3];
 
   if ((id == NULL) && (idPattern == NULL) && (*type == 0) && ((geometry == NULL) || (*geometry == 0)) && (attrs == NULL) && (q == NULL))
   {
@@ -118,6 +190,33 @@ bool orionldGetEntities(ConnectionInfo* ciP)
     return false;
   }
 
+  if (cursor != NULL)
+  {
+    if (nativeQuery == false)
+    {
+      LM_W(("Bad Input (pagination cursor used in a geo-query)"));
+      orionldErrorResponseCreate(OrionldBadRequestData, "Pagination cursor not supported", "geo-queries and orderBy must use offset");
+      ciP->httpStatusCode = SccBadRequest;
+      return false;
+    }
+
+    if (atoi(ciP->uriParam[URI_PARAM_PAGINATION_OFFSET].c_str()) != 0)
+    {
+      LM_W(("Bad Input (both 'cursor' and 'offset' used)"));
+      orionldErrorResponseCreate(OrionldBadRequestData, "Incompatible parameters", "cursor, offset");
+      ciP->httpStatusCode = SccBadRequest;
+      return false;
+    }
+
+    if (pageTokenParse(cursor, cursorV, 3) != 0)
+    {
+      LM_W(("Bad Input (invalid pagination cursor)"));
+      orionldErrorResponseCreate(OrionldBadRequestData, "Invalid value for URI parameter /cursor/", cursor);
+      ciP->httpStatusCode = SccBadRequest;
+      return false;
+    }
+  }
+
   //
   // If 'georel' is present, make sure it has a valid value
   //
@@ -265,8 +364,13 @@ bool orionldGetEntities(ConnectionInfo* ciP)
   {
     for (int ix = 0; ix < idVecItems; ix++)
     {
-      entityIdP = new EntityId(idVector[ix], type, "false", isTypePattern);
-      mongoRequest.entityIdVector.push_back(entityIdP);
+      if (nativeQuery == true)
+        entitySelectorAdd(selectorArray, idVector[ix], false, type, isTypePattern);
+      else
+      {
+        entityIdP = new EntityId(idVector[ix], type, "false", isTypePattern);
+        mongoRequest.entityIdVector.push_back(entityIdP);
+      }
     }
   }
   else if (typeVecItems > 1)  // A list of Entity Types
@@ -278,14 +382,24 @@ bool orionldGetEntities(ConnectionInfo* ciP)
       else
         typeExpanded = typeVector[ix];
 
-      entityIdP = new EntityId(idString, typeExpanded, isIdPattern, false);
-      mongoRequest.entityIdVector.push_back(entityIdP);
+      if (nativeQuery == true)
+        entitySelectorAdd(selectorArray, idString, (strcmp(isIdPattern, "true") == 0), typeExpanded, false);
+      else
+      {
+        entityIdP = new EntityId(idString, typeExpanded, isIdPattern, false);
+        mongoRequest.entityIdVector.push_back(entityIdP);
+      }
     }
   }
   else  // Definitely no lists in EntityId id/type
   {
-    entityIdP = new EntityId(idString, type, isIdPattern, isTypePattern);
-    mongoRequest.entityIdVector.push_back(entityIdP);
+    if (nativeQuery == true)
+      entitySelectorAdd(selectorArray, idString, (strcmp(isIdPattern, "true") == 0), type, isTypePattern);
+    else
+    {
+      entityIdP = new EntityId(idString, type, isIdPattern, isTypePattern);
+      mongoRequest.entityIdVector.push_back(entityIdP);
+    }
   }
 
   if (attrs != NULL)
@@ -295,11 +409,17 @@ bool orionldGetEntities(ConnectionInfo* ciP)
 
     vecItems = kStringSplit(attrs, ',', (char**) shortNameVector, vecItems);
 
+    if (nativeQuery == true)
+      attrsArray = kjArray(orionldState.kjsonP, NULL);
+
     for (int ix = 0; ix < vecItems; ix++)
     {
       const char* longName = orionldContextItemExpand(orionldState.contextP, shortNameVector[ix], NULL, true, NULL);
 
-      mongoRequest.attributeList.push_back(longName);
+      if (nativeQuery == true)
+        kjChildAdd(attrsArray, kjString(orionldState.kjsonP, NULL, longName));
+      else
+        mongoRequest.attributeList.push_back(longName);
     }
   }
 
@@ -346,28 +466,71 @@ bool orionldGetEntities(ConnectionInfo* ciP)
   }
 
 
-  //
-  // Call mongoBackend
-  //
   long long   count;
-  long long*  countP = (ciP->uriParamOptions["count"] == true)? &count : NULL;
+  bool        countEstimated = ciP->uriParamOptions[OPT_ESTIMATED_COUNT];
+  long long*  countP         = ((ciP->uriParamOptions["count"] == true) || (countEstimated == true))? &count : NULL;
 
-  ciP->httpStatusCode = mongoQueryContext(&mongoRequest,
-                                          &mongoResponse,
-                                          orionldState.tenant,
-                                          ciP->servicePathV,
-                                          ciP->uriParam,
-                                          ciP->uriParamOptions,
-                                          countP,
-                                          ciP->apiVersion);
+  if (nativeQuery == true)
+  {
+    int      offset   = atoi(ciP->uriParam[URI_PARAM_PAGINATION_OFFSET].c_str());
+    int      limit    = atoi(ciP->uriParam[URI_PARAM_PAGINATION_LIMIT].c_str());
+    bool     sysAttrs = ciP->uriParamOptions["sysAttrs"];
+    KjNode*  dbEntityArray;
+    KjNode*  lastDbEntityP = NULL;
+    int      entities      = 0;
+
+    if ((dbEntityArray = dbEntitiesQuery(selectorArray, attrsArray, (cursor != NULL)? cursorV : NULL, offset, limit, countP, countEstimated)) == NULL)
+    {
+      LM_E(("Database Error (dbEntitiesQuery failed)"));
+      orionldErrorResponseCreate(OrionldInternalError, "Database Error", "error querying the entities collection");
+      ciP->httpStatusCode = SccReceiverInternalError;
+      return false;
+    }
 
+    orionldState.responseTree = kjArray(orionldState.kjsonP, NULL);
 
-  //
-  // Transform QueryContextResponse to KJ-Tree
-  //
-  ciP->httpStatusCode = SccOk;
+    for (KjNode* dbEntityP = dbEntityArray->value.firstChildP; dbEntityP != NULL; dbEntityP = dbEntityP->next)
+    {
+      KjNode* entityP = kjTreeFromDbEntity(ciP, dbEntityP, attrsArray, keyValues, sysAttrs);
+
+      if (entityP == NULL)
+      {
+        ciP->httpStatusCode = SccReceiverInternalError;
+        return false;
+      }
+
+      kjChildAdd(orionldState.responseTree, entityP);
+      lastDbEntityP = dbEntityP;
+      ++entities;
+    }
+
+    // A full page - there may be more entities to come
+    if ((entities == limit) && (lastDbEntityP != NULL))
+      httpHeaderLinkNextAdd(ciP, entityCursorCreate(lastDbEntityP));
 
-  orionldState.responseTree = kjTreeFromQueryContextResponse(ciP, false, NULL, keyValues, &mongoResponse);
+    ciP->httpStatusCode = SccOk;
+  }
+  else
+  {
+    //
+    // Call mongoBackend
+    //
+    ciP->httpStatusCode = mongoQueryContext(&mongoRequest,
+                                            &mongoResponse,
+                                            orionldState.tenant,
+                                            ciP->servicePathV,
+                                            ciP->uriParam,
+                                            ciP->uriParamOptions,
+                                            countP,
+                                            ciP->apiVersion);
+
+    //
+    // Transform QueryContextResponse to KJ-Tree
+    //
+    ciP->httpStatusCode = SccOk;
+
+    orionldState.responseTree = kjTreeFromQueryContextResponse(ciP, false, NULL, keyValues, &mongoResponse);
+  }
 
   // Add "count" if asked for
   if (countP != NULL)
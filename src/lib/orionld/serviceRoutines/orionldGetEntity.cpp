@@ -24,6 +24,7 @@
 */
 extern "C"
 {
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
 #include "kbase/kMacros.h"                                       // K_VEC_SIZE, K_FT
 #include "kbase/kStringSplit.h"                                  // kStringSplit
 #include "kbase/kStringArrayJoin.h"                              // kStringArrayJoin
@@ -44,7 +45,8 @@ extern "C"
 #include "orionld/common/urnCheck.h"                             // urnCheck
 #include "orionld/common/orionldState.h"                         // orionldState
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
-#include "orionld/common/orionldRequestSend.h"                   // orionldRequestSend
+#include "orionld/common/orionldRequestSendMulti.h"              // OrionldRequest, orionldRequestSendMulti
+#include "orionld/common/forwardStats.h"                         // forwardStatsAdd
 #include "orionld/context/orionldContextItemAliasLookup.h"       // orionldContextItemAliasLookup
 #include "orionld/db/dbConfiguration.h"                          // dbRegistrationLookup
 #include "orionld/kjTree/kjTreeFromQueryContextResponse.h"       // kjTreeFromQueryContextResponse
@@ -70,7 +72,7 @@ static void attrsToAlias(OrionldContext* contextP, char* attrV[], int attrs)
 
 // -----------------------------------------------------------------------------
 //
-// orionldForwardGetEntity2 -
+// orionldForwardGetEntityRequest - prepare the forwarded request for one matching registration
 //
 // An NGSI-LD Registration looks like this:
 //
@@ -151,19 +153,21 @@ static void attrsToAlias(OrionldContext* contextP, char* attrV[], int attrs)
 //   YES                                               YES                                    "attrs" URI param is a merge between the two
 //
 //
-static KjNode* orionldForwardGetEntityPart(KjNode* registrationP, char* entityId, char** uriParamAttrV, int uriParamAttrs)
+static bool orionldForwardGetEntityRequest(KjNode* registrationP, char* entityId, char** uriParamAttrV, int uriParamAttrs, OrionldHttpHeader* headerV, OrionldRequest* requestP)
 {
-  char            host[128]                  = { 0 };
-  char            protocol[32]               = { 0 };
+  char*           host                       = (char*) kaAlloc(&orionldState.kalloc, 128);
+  char*           protocol                   = (char*) kaAlloc(&orionldState.kalloc, 32);
   unsigned short  port                       = 0;
   char*           uriDir                     = (char*) "";
   char*           detail;
-  KjNode*         entityP                    = NULL;
   char*           registrationAttrV[100];
   int             registrationAttrs          = 0;
 
-  if (kjTreeRegistrationInfoExtract(registrationP, protocol, sizeof(protocol), host, sizeof(host), &port, &uriDir, registrationAttrV, 100, &registrationAttrs, &detail) == false)
-    return NULL;
+  host[0]     = 0;
+  protocol[0] = 0;
+
+  if (kjTreeRegistrationInfoExtract(registrationP, protocol, 32, host, 128, &port, &uriDir, registrationAttrV, 100, &registrationAttrs, &detail) == false)
+    return false;
 
   char* newUriParamAttrsString = (char*) kaAlloc(&orionldState.kalloc, 200 * 30);  // Assuming max 20 attrs, max 200 chars per attr ...
 
@@ -228,52 +232,24 @@ static KjNode* orionldForwardGetEntityPart(KjNode* registrationP, char* entityId
       snprintf(urlPath, size, "%s/ngsi-ld/v1/entities/%s", uriDirP, entityId);
   }
 
-  //
-  // Sending the Forwarded request
-  //
-  orionldState.httpResponse.buf       = NULL;  // orionldRequestSend allocates
-  orionldState.httpResponse.size      = 0;
-  orionldState.httpResponse.used      = 0;
-  orionldState.httpResponse.allocated = false;
-
-  bool tryAgain = false;
-  bool reqOk;
-  bool downloadFailed;
-
-  //
-  // Prepare HTTP headers
-  //
-  OrionldHttpHeader headerV[5];
-  int               header = 0;
-
-  if ((orionldState.tenant != NULL) && (orionldState.tenant[0] != 0))
-  {
-    headerV[header].type  = HttpHeaderTenant;
-    headerV[header].value = orionldState.tenant;
-    ++header;
-  }
-  if ((orionldState.servicePath != NULL) && (orionldState.servicePath[0] != 0))
-  {
-    headerV[header].type  = HttpHeaderPath;
-    headerV[header].value = orionldState.servicePath;
-    ++header;
-  }
-  headerV[header].type = HttpHeaderNone;
+  requestP->protocol     = protocol;
+  requestP->host         = host;
+  requestP->port         = port;
+  requestP->verb         = "GET";
+  requestP->urlPath      = urlPath;
+  requestP->linkHeader   = NULL;
+  requestP->acceptHeader = "Accept: application/json";
+  requestP->headerV      = headerV;
 
   if (orionldState.linkHttpHeaderPresent)
   {
-    char link[512];
+    char* link = (char*) kaAlloc(&orionldState.kalloc, 512);
 
-    snprintf(link, sizeof(link), "<%s>; rel=\"http://www.w3.org/ns/json-ld#context\"; type=\"application/ld+json\"", orionldState.link);
-    reqOk = orionldRequestSend(&orionldState.httpResponse, protocol, host, port, "GET", urlPath, 5000, link, &detail, &tryAgain, &downloadFailed, "Accept: application/json", NULL, NULL, 0, headerV);
+    snprintf(link, 512, "<%s>; rel=\"http://www.w3.org/ns/json-ld#context\"; type=\"application/ld+json\"", orionldState.link);
+    requestP->linkHeader = link;
   }
-  else
-    reqOk = orionldRequestSend(&orionldState.httpResponse, protocol, host, port, "GET", urlPath, 5000, NULL, &detail, &tryAgain, &downloadFailed, "Accept: application/json", NULL, NULL, 0, headerV);
-
-  if (reqOk)
-    entityP = kjParse(orionldState.kjsonP, orionldState.httpResponse.buf);
 
-  return entityP;
+  return true;
 }
 
 
@@ -282,6 +258,10 @@ static KjNode* orionldForwardGetEntityPart(KjNode* registrationP, char* entityId
 //
 // orionldForwardGetEntity -
 //
+// The forwarded requests are all sent at the same time, so the time it takes is that of the slowest
+// context provider, not the sum of all of them. The overall deadline is 5 seconds - what arrives before
+// that is merged into the response, in the order of the registrations.
+//
 static KjNode* orionldForwardGetEntity(ConnectionInfo* ciP, char* entityId, KjNode* regArrayP, KjNode* responseP, bool needEntityType)
 {
   //
@@ -306,11 +286,63 @@ static KjNode* orionldForwardGetEntity(ConnectionInfo* ciP, char* entityId, KjNo
   }
 
   //
-  // Treating all hits from the registrations
+  // Prepare HTTP headers - the same for all forwarded requests
+  //
+  OrionldHttpHeader* headerV = (OrionldHttpHeader*) kaAlloc(&orionldState.kalloc, 3 * sizeof(OrionldHttpHeader));
+  int                header  = 0;
+
+  if ((orionldState.tenant != NULL) && (orionldState.tenant[0] != 0))
+  {
+    headerV[header].type  = HttpHeaderTenant;
+    headerV[header].value = orionldState.tenant;
+    ++header;
+  }
+  if ((orionldState.servicePath != NULL) && (orionldState.servicePath[0] != 0))
+  {
+    headerV[header].type  = HttpHeaderPath;
+    headerV[header].value = orionldState.servicePath;
+    ++header;
+  }
+  headerV[header].type = HttpHeaderNone;
+
+  //
+  // One request per matching registration
   //
+  int regs = 0;
   for (KjNode* regP = regArrayP->value.firstChildP; regP != NULL; regP = regP->next)
+    ++regs;
+
+  OrionldRequest* requestV = (OrionldRequest*) kaAlloc(&orionldState.kalloc, regs * sizeof(OrionldRequest));
+  int             requests = 0;
+
+  for (KjNode* regP = regArrayP->value.firstChildP; regP != NULL; regP = regP->next)
+  {
+    if (orionldForwardGetEntityRequest(regP, entityId, uriParamAttrsV, uriParamAttrs, headerV, &requestV[requests]) == true)
+      ++requests;
+  }
+
+  orionldRequestSendMulti(requestV, requests, 5000);
+
+  //
+  // Treating all responses from the context providers
+  //
+  for (int ix = 0; ix < requests; ix++)
   {
-    KjNode*  partTree = orionldForwardGetEntityPart(regP, entityId, uriParamAttrsV, uriParamAttrs);
+    OrionldRequest* requestP = &requestV[ix];
+    char            provider[160];
+
+    snprintf(provider, sizeof(provider), "%s:%d", requestP->host, requestP->port);
+    forwardStatsAdd(provider, requestP->latencyMs, requestP->ok, requestP->timedOut);
+
+    if (requestP->ok == false)
+    {
+      LM_W(("Forwarded request to %s failed after %d ms: %s", provider, requestP->latencyMs, requestP->detail));
+      continue;
+    }
+
+    LM_T(LmtRequestSend, ("Forwarded request to %s took %d ms", provider, requestP->latencyMs));
+
+    KjNode*  partTree = kjParse(orionldState.kjsonP, requestP->response);
 
     if (partTree != NULL)  // Move all attributes from 'partTree' into responseP
     {
@@ -38,9 +38,12 @@ extern "C"
 #include "common/string.h"                                    // toString
 #include "rest/uriParamNames.h"                               // URI_PARAM_PAGINATION_OFFSET, URI_PARAM_PAGINATION_LIMIT
 #include "rest/ConnectionInfo.h"                              // ConnectionInfo
+#include "rest/httpHeaderAdd.h"                               // httpHeaderLinkNextAdd
 #include "orionld/mongoBackend/mongoLdRegistrationsGet.h"     // mongoLdRegistrationsGet
 #include "orionld/common/orionldState.h"                      // orionldState
 #include "orionld/common/orionldErrorResponse.h"              // orionldErrorResponseCreate
+#include "orionld/common/pageTokenCreate.h"                   // pageTokenCreate
+#include "orionld/common/pageTokenParse.h"                    // pageTokenParse
 #include "orionld/kjTree/kjTreeFromRegistration.h"            // kjTreeFromRegistration
 #include "orionld/serviceRoutines/orionldGetRegistrations.h"  // Own Interface
 
@@ -66,24 +69,47 @@ extern "C"
 // - endTime
 // - limit
 // - offset
+// - cursor        (keyset pagination - the Link header (rel=next) of the previous page has it)
 // - options=count
+// - options=estimatedCount
 //
 bool orionldGetRegistrations(ConnectionInfo *ciP)
 {
   std::vector<ngsiv2::Registration>  registrationVec;
   OrionError                         oe;
   long long                          count;
+  bool                               countEstimated = ciP->uriParamOptions[OPT_ESTIMATED_COUNT];
+  bool                               countWanted    = (ciP->uriParamOptions["count"] == true) || (countEstimated == true);
+  char*                              cursor         = (ciP->uriParam[URI_PARAM_PAGINATION_CURSOR].empty())? NULL : (char*) ciP->uriParam[URI_PARAM_PAGINATION_CURSOR].c_str();
+  char*                              afterId        = NULL;
+  int                                limit          = atoi(ciP->uriParam[URI_PARAM_PAGINATION_LIMIT].c_str());
 
   LM_T(LmtServiceRoutine, ("In orionldGetCSourceRegistrations"));
 
-  if (!mongoLdRegistrationsGet(ciP, &registrationVec, orionldState.tenant, &count, &oe))
+  if ((cursor != NULL) && (atoi(ciP->uriParam[URI_PARAM_PAGINATION_OFFSET].c_str()) != 0))
+  {
+    LM_W(("Bad Input (both 'cursor' and 'offset' used)"));
+    orionldErrorResponseCreate(OrionldBadRequestData, "Incompatible parameters", "cursor, offset");
+    ciP->httpStatusCode = SccBadRequest;
+    return false;
+  }
+
+  if ((cursor != NULL) && (pageTokenParse(cursor, &afterId, 1) != 0))
+  {
+    LM_W(("Bad Input (invalid pagination cursor)"));
+    orionldErrorResponseCreate(OrionldBadRequestData, "Invalid value for URI parameter /cursor/", cursor);
+    ciP->httpStatusCode = SccBadRequest;
+    return false;
+  }
+
+  if (!mongoLdRegistrationsGet(ciP, &registrationVec, orionldState.tenant, (countWanted == true)? &count : NULL, countEstimated, afterId, &oe))
   {
     orionldErrorResponseCreate(OrionldBadRequestData, "Bad Request", oe.details.c_str());
     ciP->httpStatusCode = SccBadRequest;
     return false;
   }
 
-  if ((ciP->uriParamOptions["count"]))
+  if (countWanted == true)
   {
     ciP->httpHeader.push_back(HTTP_FIWARE_TOTAL_COUNT);
     ciP->httpHeaderValue.push_back(toString(count));
@@ -97,6 +123,14 @@ bool orionldGetRegistrations(ConnectionInfo *ciP)
     kjChildAdd(orionldState.responseTree, registrationNodeP);
   }
 
+  // A full page - there may be more registrations to come
+  if ((limit > 0) && (registrationVec.size() == (unsigned int) limit))
+  {
+    const char* lastId = registrationVec[limit - 1].id.c_str();
+
+    httpHeaderLinkNextAdd(ciP, pageTokenCreate(&lastId, 1));
+  }
+
   ciP->httpStatusCode = SccOk;
 
   return true;
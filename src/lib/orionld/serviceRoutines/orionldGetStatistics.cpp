@@ -0,0 +1,364 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <semaphore.h>                                           // sem_wait, sem_post
+#include <string>                                                // std::string
+#include <map>                                                   // std::map
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjObject, kjInteger, kjFloat, kjChildAdd
+#include "kalloc/kaStrdup.h"                                     // kaStrdup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*, lmAsyncDroppedGet, lmLogLinesGet
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/sem.h"                                          // curlHostCountersGet, CurlHostCounters
+#include "rest/ConnectionInfo.h"                                 // ConnectionInfo
+#include "rest/Verb.h"                                           // Verb, verbName
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/context/orionldContextCache.h"                 // orionldContextCacheStats, orionldContextMemoStats, ...
+#include "orionld/common/orionldEndpointPool.h"                  // orionldEndpointPoolStats, orionldEndpointPoolSem, ...
+#include "orionld/common/forwardStats.h"                         // forwardStatsGet, ForwardProviderStats
+#include "orionld/notifications/notificationQueue.h"             // notificationStats, notificationLatencyLimits, ...
+#include "orionld/types/OrionldSpan.h"                           // ORIONLD_PHASES, OrionldPhase
+#include "orionld/types/OrionldLatencyHistogram.h"               // OrionldLatencyHistogram, OrionldServiceLatency
+#include "orionld/common/orionldLatencyPercentile.h"             // orionldLatencyPercentile
+#include "orionld/common/orionldPhaseName.h"                     // orionldPhaseName
+#include "orionld/rest/OrionLdRestService.h"                     // OrionLdRestService
+#include "orionld/rest/orionldServiceInit.h"                     // orionldRestServiceV
+#include "orionld/serviceRoutines/orionldGetStatistics.h"        // Own Interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// counterAdd -
+//
+static void counterAdd(KjNode* containerP, const char* name, long long value)
+{
+  KjNode* nodeP = kjInteger(orionldState.kjsonP, name, value);
+
+  kjChildAdd(containerP, nodeP);
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// contextCacheStatistics -
+//
+static KjNode* contextCacheStatistics(void)
+{
+  KjNode*                   contextCacheP = kjObject(orionldState.kjsonP, "contextCache");
+  OrionldContextCacheStats  stats;
+  int                       items;
+
+  sem_wait(&orionldContextCacheSem);
+  stats = orionldContextCacheStats;
+  items = orionldContextCacheItems;
+  sem_post(&orionldContextCacheSem);
+
+  counterAdd(contextCacheP, "items",     items);
+  counterAdd(contextCacheP, "maxItems",  orionldContextCacheMaxItems);
+  counterAdd(contextCacheP, "lookups",   stats.lookups);
+  counterAdd(contextCacheP, "hits",      stats.hits);
+  counterAdd(contextCacheP, "misses",    stats.misses);
+  counterAdd(contextCacheP, "inserts",   stats.inserts);
+  counterAdd(contextCacheP, "dedups",    stats.dedups);
+  counterAdd(contextCacheP, "evictions", stats.evictions);
+  counterAdd(contextCacheP, "frees",     stats.frees);
+
+  //
+  // Expansion memos of the contexts (prefixed names)
+  //
+  KjNode*             memoP   = kjObject(orionldState.kjsonP, "memo");
+  unsigned long long  lookups = orionldContextMemoStats.lookups;
+  unsigned long long  hits    = orionldContextMemoStats.hits;
+
+  counterAdd(memoP, "lookups", lookups);
+  counterAdd(memoP, "hits",    hits);
+  counterAdd(memoP, "inserts", orionldContextMemoStats.inserts);
+  kjChildAdd(memoP, kjFloat(orionldState.kjsonP, "hitRatio", (lookups == 0)? 0 : (double) hits / lookups));
+  kjChildAdd(contextCacheP, memoP);
+
+  return contextCacheP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// notificationConnectionStatistics -
+//
+// reuseRatio: reused connections / all connections used (new + reused)
+//
+static KjNode* notificationConnectionStatistics(void)
+{
+  KjNode*                   poolP = kjObject(orionldState.kjsonP, "notificationConnections");
+  OrionldEndpointPoolStats  stats;
+  unsigned long long        used;
+
+  sem_wait(&orionldEndpointPoolSem);
+  stats = orionldEndpointPoolStats;
+  sem_post(&orionldEndpointPoolSem);
+
+  used = stats.connects + stats.reuses;
+
+  counterAdd(poolP, "maxPerEndpoint", orionldEndpointPoolMaxConnections);
+  counterAdd(poolP, "idleTimeout",    orionldEndpointPoolIdleTimeout);
+  counterAdd(poolP, "connects",       stats.connects);
+  counterAdd(poolP, "reuses",         stats.reuses);
+  counterAdd(poolP, "kept",           stats.kept);
+  counterAdd(poolP, "closes",         stats.closes);
+  counterAdd(poolP, "staleClosed",    stats.staleClosed);
+  counterAdd(poolP, "idleTimeouts",   stats.idleTimeouts);
+  counterAdd(poolP, "waits",          stats.waits);
+  counterAdd(poolP, "rejects",        stats.rejects);
+  counterAdd(poolP, "dnsLookups",     stats.dnsLookups);
+  counterAdd(poolP, "dnsCacheHits",   stats.dnsCacheHits);
+  counterAdd(poolP, "errors",         stats.errors);
+
+  kjChildAdd(poolP, kjFloat(orionldState.kjsonP, "reuseRatio", (used == 0)? 0 : (double) stats.reuses / used));
+
+  return poolP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// notificationStatistics -
+//
+// The latency histogram has one member per bucket, named after the upper limit of the bucket ("<5ms"), and the
+// last bucket is named after the lower limit (">=10000ms").
+// The counters are read without lock - each counter is consistent, but not the set of counters.
+//
+static KjNode* notificationStatistics(void)
+{
+  KjNode* notificationsP = kjObject(orionldState.kjsonP, "notifications");
+  KjNode* latencyP       = kjObject(orionldState.kjsonP, "latency");
+  char    bucketName[32];
+
+  counterAdd(notificationsP, "senders",    notificationSenders);
+  counterAdd(notificationsP, "maxQueued",  notificationQueueMaxDepth);
+  counterAdd(notificationsP, "queued",     notificationStats.queued);
+  counterAdd(notificationsP, "dropped",    notificationStats.dropped);
+  counterAdd(notificationsP, "sent",       notificationStats.sent);
+  counterAdd(notificationsP, "delivered",  notificationStats.delivered);
+  counterAdd(notificationsP, "rejected",   notificationStats.rejected);
+  counterAdd(notificationsP, "retries",    notificationStats.retries);
+  counterAdd(notificationsP, "failed",     notificationStats.failed);
+  counterAdd(notificationsP, "timeouts",   notificationStats.timeouts);
+  counterAdd(notificationsP, "queueDepth", notificationStats.queueDepth);
+  counterAdd(notificationsP, "inFlight",   notificationStats.inFlight);
+  counterAdd(notificationsP, "batched",    notificationStats.batched);
+  counterAdd(notificationsP, "batches",    notificationStats.batches);
+
+  for (int ix = 0; ix < NOTIFICATION_LATENCY_BUCKETS; ix++)
+  {
+    if (ix < NOTIFICATION_LATENCY_BUCKETS - 1)
+      snprintf(bucketName, sizeof(bucketName), "<%dms", notificationLatencyLimits[ix]);
+    else
+      snprintf(bucketName, sizeof(bucketName), ">=%dms", notificationLatencyLimits[ix - 1]);
+
+    counterAdd(latencyP, kaStrdup(&orionldState.kalloc, bucketName), notificationStats.latency[ix]);
+  }
+
+  kjChildAdd(notificationsP, latencyP);
+
+  return notificationsP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// curlHostStatistics - one member per host for which curl contexts exist ("persistent" notification mode)
+//
+static KjNode* curlHostStatistics(void)
+{
+  KjNode*                                  curlHostsP = kjObject(orionldState.kjsonP, "curlHosts");
+  std::map<std::string, CurlHostCounters>  counters;
+
+  curlHostCountersGet(&counters);
+
+  for (std::map<std::string, CurlHostCounters>::iterator it = counters.begin(); it != counters.end(); ++it)
+  {
+    KjNode* hostP = kjObject(orionldState.kjsonP, kaStrdup(&orionldState.kalloc, it->first.c_str()));
+
+    counterAdd(hostP, "inFlight",  it->second.inFlight);
+    counterAdd(hostP, "queued",    it->second.queued);
+    counterAdd(hostP, "idle",      it->second.idle);
+    counterAdd(hostP, "transfers", it->second.transfers);
+
+    kjChildAdd(curlHostsP, hostP);
+  }
+
+  return curlHostsP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// forwardingStatistics - one member per context provider ("host:port") that requests have been forwarded to
+//
+static KjNode* forwardingStatistics(void)
+{
+  KjNode*                                      forwardingP = kjObject(orionldState.kjsonP, "forwarding");
+  std::map<std::string, ForwardProviderStats>  stats;
+
+  forwardStatsGet(&stats);
+
+  for (std::map<std::string, ForwardProviderStats>::iterator it = stats.begin(); it != stats.end(); ++it)
+  {
+    KjNode* providerP = kjObject(orionldState.kjsonP, kaStrdup(&orionldState.kalloc, it->first.c_str()));
+
+    counterAdd(providerP, "requests", it->second.requests);
+    counterAdd(providerP, "errors",   it->second.errors);
+    counterAdd(providerP, "timeouts", it->second.timeouts);
+    counterAdd(providerP, "avgMs",    (it->second.requests == 0)? 0 : it->second.totalMs / it->second.requests);
+    counterAdd(providerP, "maxMs",    it->second.maxMs);
+    counterAdd(providerP, "lastMs",   it->second.lastMs);
+
+    kjChildAdd(forwardingP, providerP);
+  }
+
+  return forwardingP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// logStatistics -
+//
+// droppedLines: log lines lost as the queue of the asynchronous log writer was full (see -logQueueSize)
+//
+static KjNode* logStatistics(void)
+{
+  KjNode* logP = kjObject(orionldState.kjsonP, "log");
+
+  counterAdd(logP, "lines",        lmLogLinesGet());
+  counterAdd(logP, "droppedLines", lmAsyncDroppedGet());
+
+  return logP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// percentilesAdd - all values in microseconds
+//
+static void percentilesAdd(KjNode* containerP, OrionldLatencyHistogram* hP)
+{
+  counterAdd(containerP, "count", hP->count);
+  counterAdd(containerP, "p50",   orionldLatencyPercentile(hP, 50));
+  counterAdd(containerP, "p99",   orionldLatencyPercentile(hP, 99));
+  counterAdd(containerP, "p999",  orionldLatencyPercentile(hP, 99.9));
+  counterAdd(containerP, "max",   hP->max);
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// latencyStatistics - one member per service that has been used ("GET /ngsi-ld/v1/entities/*")
+//
+// The latency of the entire request ("avg", "p50", ...) and of each phase of the request (see OrionldPhase), in microseconds.
+// The percentiles come from the HDR-style histograms of orionldLatencyRecord() and are accurate to 1/16 of the value.
+//
+static KjNode* latencyStatistics(void)
+{
+  KjNode* latencyP = kjObject(orionldState.kjsonP, "latency");
+  char    serviceName[256];
+
+  for (int svIx = 0; svIx < 9; svIx++)
+  {
+    OrionLdRestServiceVector* serviceV = &orionldRestServiceV[svIx];
+
+    for (int sIx = 0; sIx < serviceV->services; sIx++)
+    {
+      OrionLdRestService*     serviceP        = &serviceV->serviceV[sIx];
+      OrionldServiceLatency*  serviceLatencyP = serviceP->latencyP;
+
+      if ((serviceLatencyP == NULL) || (serviceLatencyP->total.count == 0))
+        continue;
+
+      OrionldLatencyHistogram* totalP   = &serviceLatencyP->total;
+      KjNode*                  serviceN;
+      KjNode*                  phasesP  = kjObject(orionldState.kjsonP, "phases");
+
+      snprintf(serviceName, sizeof(serviceName), "%s %s", verbName((Verb) svIx), serviceP->url);
+      serviceN = kjObject(orionldState.kjsonP, kaStrdup(&orionldState.kalloc, serviceName));
+
+      percentilesAdd(serviceN, totalP);
+      counterAdd(serviceN, "avg", totalP->sum / totalP->count);
+
+      for (int ix = 0; ix < ORIONLD_PHASES; ix++)
+      {
+        OrionldLatencyHistogram* phaseP = &serviceLatencyP->phaseV[ix];
+        KjNode*                  phaseN;
+
+        if (phaseP->count == 0)
+          continue;
+
+        phaseN = kjObject(orionldState.kjsonP, orionldPhaseName((OrionldPhase) ix));
+        percentilesAdd(phaseN, phaseP);
+        kjChildAdd(phasesP, phaseN);
+      }
+
+      kjChildAdd(serviceN, phasesP);
+      kjChildAdd(latencyP, serviceN);
+    }
+  }
+
+  return latencyP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// orionldGetStatistics - GET /ngsi-ld/ex/v1/statistics
+//
+bool orionldGetStatistics(ConnectionInfo* ciP)
+{
+  orionldState.responseTree = kjObject(orionldState.kjsonP, NULL);
+
+  kjChildAdd(orionldState.responseTree, contextCacheStatistics());
+  kjChildAdd(orionldState.responseTree, notificationConnectionStatistics());
+  kjChildAdd(orionldState.responseTree, notificationStatistics());
+  kjChildAdd(orionldState.responseTree, curlHostStatistics());
+  kjChildAdd(orionldState.responseTree, forwardingStatistics());
+  kjChildAdd(orionldState.responseTree, logStatistics());
+  kjChildAdd(orionldState.responseTree, latencyStatistics());
+
+  return true;
+}
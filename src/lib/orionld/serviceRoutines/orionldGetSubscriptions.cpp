@@ -36,9 +36,12 @@ extern "C"
 #include "common/string.h"                                     // toString
 #include "rest/uriParamNames.h"                                // URI_PARAM_PAGINATION_OFFSET, URI_PARAM_PAGINATION_LIMIT
 #include "rest/ConnectionInfo.h"                               // ConnectionInfo
+#include "rest/httpHeaderAdd.h"                                // httpHeaderLinkNextAdd
 #include "mongoBackend/mongoGetSubscriptions.h"                // mongoListSubscriptions
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/common/orionldErrorResponse.h"               // orionldErrorResponseCreate
+#include "orionld/common/pageTokenCreate.h"                    // pageTokenCreate
+#include "orionld/common/pageTokenParse.h"                     // pageTokenParse
 #include "orionld/kjTree/kjTreeFromSubscription.h"             // kjTreeFromSubscription
 #include "orionld/serviceRoutines/orionldGetSubscriptions.h"   // Own Interface
 
@@ -48,17 +51,46 @@ extern "C"
 //
 // orionldGetSubscriptions -
 //
+// Pagination: 'offset' or 'cursor' - the cursor of the next page is found in the Link header (rel=next) of the response
+//
 bool orionldGetSubscriptions(ConnectionInfo* ciP)
 {
   std::vector<ngsiv2::Subscription> subVec;
   OrionError                        oe;
-  int64_t                           count  = 0;
+  int64_t                           count          = 0;
+  bool                              countEstimated = ciP->uriParamOptions[OPT_ESTIMATED_COUNT];
+  bool                              countWanted    = (ciP->uriParamOptions["count"] == true) || (countEstimated == true);
+  char*                             cursor         = (ciP->uriParam[URI_PARAM_PAGINATION_CURSOR].empty())? NULL : (char*) ciP->uriParam[URI_PARAM_PAGINATION_CURSOR].c_str();
+  char*                             afterId        = NULL;
+  int                               limit          = atoi(ciP->uriParam[URI_PARAM_PAGINATION_LIMIT].c_str());
 
   LM_T(LmtServiceRoutine, ("In orionldGetSubscription"));
 
-  mongoGetLdSubscriptions(ciP, &subVec, orionldState.tenant, (long long*) &count, &oe);
+  if ((cursor != NULL) && (atoi(ciP->uriParam[URI_PARAM_PAGINATION_OFFSET].c_str()) != 0))
+  {
+    LM_W(("Bad Input (both 'cursor' and 'offset' used)"));
+    orionldErrorResponseCreate(OrionldBadRequestData, "Incompatible parameters", "cursor, offset");
+    ciP->httpStatusCode = SccBadRequest;
+    return false;
+  }
 
-  if ((ciP->uriParamOptions["count"]))
+  if ((cursor != NULL) && (pageTokenParse(cursor, &afterId, 1) != 0))
+  {
+    LM_W(("Bad Input (invalid pagination cursor)"));
+    orionldErrorResponseCreate(OrionldBadRequestData, "Invalid value for URI parameter /cursor/", cursor);
+    ciP->httpStatusCode = SccBadRequest;
+    return false;
+  }
+
+  if (mongoGetLdSubscriptions(ciP, &subVec, orionldState.tenant, (countWanted == true)? (long long*) &count : NULL, countEstimated, afterId, &oe) == false)
+  {
+    LM_E(("mongoGetLdSubscriptions: %s", oe.details.c_str()));
+    orionldErrorResponseCreate(OrionldInternalError, "Database Error", oe.details.c_str());
+    ciP->httpStatusCode = SccReceiverInternalError;
+    return false;
+  }
+
+  if (countWanted == true)
   {
     ciP->httpHeader.push_back(HTTP_FIWARE_TOTAL_COUNT);
     ciP->httpHeaderValue.push_back(toString(count));
@@ -73,5 +105,13 @@ bool orionldGetSubscriptions(ConnectionInfo* ciP)
     kjChildAdd(orionldState.responseTree, subscriptionNodeP);
   }
 
+  // A full page - there may be more subscriptions to come
+  if ((limit > 0) && (subVec.size() == (unsigned int) limit))
+  {
+    const char* lastId = subVec[limit - 1].id.c_str();
+
+    httpHeaderLinkNextAdd(ciP, pageTokenCreate(&lastId, 1));
+  }
+
   return true;
 }
@@ -23,8 +23,11 @@
 * Author: Ken Zangelin
 */
 #include <string.h>                                              // strlen
-#include <sys/uio.h>                                             // writev
-#include <sys/select.h>                                          // select
+#include <strings.h>                                             // bzero
+#include <errno.h>                                               // errno, EAGAIN
+#include <time.h>                                                // clock_gettime
+#include <sys/uio.h>                                             // struct iovec
+#include <sys/socket.h>                                          // sendmsg
 
 extern "C"
 {
@@ -36,11 +39,19 @@ extern "C"
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
+#include "rest/httpHeaderAdd.h"                                  // LINK_REL_AND_TYPE, LINK_REL_AND_TYPE_SIZE
+
 #include "orionld/common/orionldState.h"                         // orionldState
 #include "orionld/common/numberToDate.h"                         // numberToDate
 #include "orionld/common/uuidGenerate.h"                         // uuidGenerate
-#include "orionld/common/orionldServerConnect.h"                 // orionldServerConnect
+#include "orionld/common/orionldEndpointConnect.h"               // orionldEndpointConnect
+#include "orionld/common/orionldEndpointRelease.h"               // orionldEndpointRelease
+#include "orionld/common/orionldHttpResponseRead.h"              // orionldHttpResponseRead
 #include "orionld/context/orionldCoreContext.h"                  // ORIONLD_CORE_CONTEXT_URL
+#include "orionld/notifications/notificationQueue.h"             // notificationSenders
+#include "orionld/notifications/notificationEnqueue.h"           // notificationEnqueue
+#include "orionld/notifications/notificationBatchAdd.h"          // notificationBatchAdd
+#include "orionld/kjTree/kjTreeRenderSize.h"                     // kjTreeRenderSize
 #include "orionld/serviceRoutines/orionldNotify.h"               // Own interface
 
 
@@ -86,38 +97,71 @@ static void ipPortAndRest(char* ipport, char** ipP, unsigned short* portP, char*
 
 // -----------------------------------------------------------------------------
 //
-// responseTreat -
+// requestSend - send the notification, without SIGPIPE if the peer has closed the connection
 //
-static void responseTreat(OrionldNotificationInfo* niP, char* buf, int bufLen)
+static int requestSend(int fd, struct iovec* ioVec, int ioVecLen)
 {
-  int    nb             = read(niP->fd, buf, bufLen);
-  char*  firstLine      = NULL;
-  char*  endOfFirstLine = NULL;
+  struct msghdr msg;
 
-  if (nb == -1)
-  {
-    LM_E(("Internal Error (error reading from notification endpoint: %s)", strerror(errno)));
-    return;
-  }
+  bzero(&msg, sizeof(msg));
+  msg.msg_iov    = ioVec;
+  msg.msg_iovlen = ioVecLen;
 
-  //
-  //
-  //
-  firstLine      = buf;
-  endOfFirstLine = strchr(firstLine, '\n');
+  return sendmsg(fd, &msg, MSG_NOSIGNAL);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// responsesRead - read the responses of all the notifications that have been sent and not yet answered
+//
+// The responses are read completely, so that the connections can be reused, and the connections are given back
+// to the endpoint pool.
+//
+// Timeout after 10 seconds, for all responses together.
+// The payload bodies of the responses are not kept - 'buf' is only a read buffer.
+//
+static void responsesRead(void)
+{
+  char             buf[4 * 1024];
+  struct timespec  startTime;
+  struct timespec  checkTime;
+
+  clock_gettime(CLOCK_MONOTONIC, &startTime);
 
-  if (endOfFirstLine == NULL)
+  for (int ix = 0; ix < orionldState.notificationRecords; ix++)
   {
-    LM_E(("Internal Error (unable to find end of first line from notification endpoint: %s)", strerror(errno)));
-    return;
-  }
+    OrionldNotificationInfo*  niP = &orionldState.notificationInfo[ix];
+    bool                      keepAlive;
+    int                       timeoutMs;
+    int                       statusCode;
+
+    if ((niP->fd == -1) || (niP->connected == false))
+      continue;
 
-  *endOfFirstLine = 0;
+    clock_gettime(CLOCK_MONOTONIC, &checkTime);
+    timeoutMs = 10000 - ((checkTime.tv_sec - startTime.tv_sec) * 1000 + (checkTime.tv_nsec - startTime.tv_nsec) / 1000000);
+    if (timeoutMs < 0)
+      timeoutMs = 0;
 
-  //
-  // FIXME: Read the rest of the message, using select
-  //
-  niP->allOK = true;
+    statusCode = orionldHttpResponseRead(niP->fd, buf, sizeof(buf), timeoutMs, &keepAlive);
+    niP->allOK = (statusCode >= 200) && (statusCode < 300);
+
+    if (statusCode == -1)
+      LM_W(("Notification for subscription '%s': no valid response from %s", niP->subscriptionId, niP->reference));
+
+    orionldEndpointRelease(niP->endpointP, niP->fd, (statusCode != -1) && (keepAlive == true));
+    niP->fd        = -1;
+    niP->connected = false;
+
+#if 0
+    if (niP->allOK == true)
+      dbSubscriptionLastSuccessSet(niP->subscriptionId);
+    else
+      dbSubscriptionLastFailureSet(niP->subscriptionId);
+#endif
+  }
 }
 
 
@@ -138,9 +182,9 @@ void orionldNotify(void)
 {
   //
   // Preparing the HTTP headers which will be pretty much the same for all notifications
-  // What differs is Content-Length, Content-Type, and the Request header
+  // What differs is Content-Length, Content-Type, the Link header, and the Request header
   //
-  char  requestHeader[128];
+  char  requestHeader[512];
   char  contentLenHeader[32];
   char* lenP                    = &contentLenHeader[16];
   char* contentTypeHeaderJson   = (char*) "Content-Type: application/json\r\n";
@@ -162,11 +206,18 @@ void orionldNotify(void)
   // };
   //
   int           contentLength;
-  struct iovec  ioVec[6]        = { { requestHeader, 0 }, { contentLenHeader, 0 }, { contentTypeHeaderJson, 32 }, { userAgentHeader, 23 }, { payload, 0 } };
-  int           ioVecLen        = 5;
+  struct iovec  ioVec[6];
+  int           ioVecLen;
   int           now             = time(NULL);
   char          nowString[64];
   char*         detail;
+  bool          coreContext     = (orionldState.contextP == NULL) || (orionldState.contextP == orionldCoreContextP);
+  char*         contextUrl      = (coreContext == true)? (char*) ORIONLD_CORE_CONTEXT_URL : orionldState.contextP->url;
+  int           linkHeaderSize  = strlen(contextUrl) + LINK_REL_AND_TYPE_SIZE + 16;
+  char*         linkHeader      = (char*) kaAlloc(&orionldState.kalloc, linkHeaderSize);
+
+  // The @context goes in the Link header of the notifications that are not JSON-LD
+  snprintf(linkHeader, linkHeaderSize, "Link: <%s>; %s\r\n", contextUrl, LINK_REL_AND_TYPE);
 
   if (numberToDate(now, nowString, sizeof(nowString), &detail) == false)
   {
@@ -183,31 +234,38 @@ void orionldNotify(void)
     KjNode*                   notificationTree;
     char                      notificationId[64];
 
+    //
+    // Subscriptions with notification batching - the entity is sent later, together with others
+    //
+    if (niP->batchMaxEntities > 0)
+    {
+      int    itemSize    = kjTreeRenderSize(orionldState.kjsonP, niP->attrsForNotification);
+      char*  item        = (char*) kaAlloc(&orionldState.kalloc, itemSize);
+
+      kjRender(orionldState.kjsonP, niP->attrsForNotification, item, itemSize);
+      notificationBatchAdd(orionldState.tenant, niP->subscriptionId, niP->reference, niP->mimeType, contextUrl, niP->batchMaxEntities, niP->batchMaxDelay, item, strlen(item));
+
+      niP->fd        = -1;
+      niP->connected = false;
+      niP->allOK     = true;
+      continue;
+    }
+
     notificationTree = kjObject(orionldState.kjsonP, NULL);
 
     strncpy(notificationId, "urn:ngsi-ld:Notification:", sizeof(notificationId));
     uuidGenerate(&notificationId[25]);
 
     ipPortAndRest(niP->reference, &ip, &port, &rest);
-    snprintf(requestHeader, sizeof(requestHeader), "POST %s HTTP/1.1\r\n", rest);
+    snprintf(requestHeader, sizeof(requestHeader), "POST %s HTTP/1.1\r\nHost: %s:%d\r\n", (rest != NULL)? rest : "/", ip, port);
 
+    //
+    // JSON-LD notifications carry the @context in the payload - the others in a Link header (see the ioVec below)
+    //
     if (niP->mimeType == JSONLD)
     {
-      //
-      // For better tput, I could maintain not one ioVec but TWO.
-      // One for "application/json" and another one for "application/ld+json"
-      //
-
-      //
-      // Overwrite contentTypeHeaderJson in ioVec[2]
-      //
-      ioVec[2].iov_base = contentTypeHeaderJsonLd;
-      ioVec[2].iov_len  = 35;
-
-      // Add @context to payload
-      if ((orionldState.contextP == NULL) || (orionldState.contextP == orionldCoreContextP))
+      if (coreContext == true)
       {
-        orionldState.contextP = orionldCoreContextP;
         KjNode* contextStringNodeP = kjString(orionldState.kjsonP, "@context", ORIONLD_CORE_CONTEXT_URL);
         kjChildAdd(notificationTree, contextStringNodeP);
       }
@@ -216,25 +274,6 @@ void orionldNotify(void)
       else
         LM_E(("Internal Error (context has no tree ...)"));
     }
-    else
-    {
-      //
-      // Add Link HTTP header
-      //
-      ioVecLen = 6;
-
-      // Move down PAYLOAD
-      ioVec[5].iov_base = ioVec[4].iov_base;
-      ioVec[5].iov_len  = ioVec[4].iov_len;
-
-      // Move down userAgentHeader - must be the last as it contains the double \r\n
-      ioVec[4].iov_base = ioVec[3].iov_base;
-      ioVec[4].iov_len  = ioVec[3].iov_len;
-
-      // Now ioVec[3] is free for the Link header
-      ioVec[3].iov_base = orionldState.contextP->url;
-      ioVec[3].iov_len  = strlen(orionldState.contextP->url);
-    }
 
     //
     // Fix payload
@@ -268,104 +307,113 @@ void orionldNotify(void)
     contentLength = strlen(payload);
     snprintf(lenP, sizeLeftForLen, "%d\r\n", contentLength);  // Writing Content-Length inside contentLenHeader
 
-    ioVec[0].iov_len = strlen(requestHeader);
-    ioVec[1].iov_len = strlen(contentLenHeader);
-    ioVec[4].iov_len = contentLength;
-
     //
-    // Data ready to send
+    // The ioVec is built for each notification - the Content-Type and the Link header depend on the subscription.
+    // The User-Agent header must be the last one, as it ends the headers with a double newline.
     //
-    niP->fd = orionldServerConnect(ip, port);
+    char* contentTypeHeader = (niP->mimeType == JSONLD)? contentTypeHeaderJsonLd : contentTypeHeaderJson;
 
-    if (niP->fd == -1)
+    ioVecLen = 0;
+
+    ioVec[ioVecLen].iov_base = requestHeader;
+    ioVec[ioVecLen].iov_len  = strlen(requestHeader);
+    ++ioVecLen;
+
+    ioVec[ioVecLen].iov_base = contentLenHeader;
+    ioVec[ioVecLen].iov_len  = strlen(contentLenHeader);
+    ++ioVecLen;
+
+    ioVec[ioVecLen].iov_base = contentTypeHeader;
+    ioVec[ioVecLen].iov_len  = strlen(contentTypeHeader);
+    ++ioVecLen;
+
+    if (niP->mimeType != JSONLD)
     {
-      niP->connected = false;
-      LM_E(("Internal Error (unable to connent to server for notification for subscription '%s': %s)", niP->subscriptionId, strerror(errno)));
-      continue;
+      ioVec[ioVecLen].iov_base = linkHeader;
+      ioVec[ioVecLen].iov_len  = strlen(linkHeader);
+      ++ioVecLen;
     }
 
-    niP->connected = true;
+    ioVec[ioVecLen].iov_base = userAgentHeader;
+    ioVec[ioVecLen].iov_len  = strlen(userAgentHeader);
+    ++ioVecLen;
 
-    if (writev(niP->fd, ioVec, ioVecLen) == -1)
-    {
-      close(niP->fd);
+    ioVec[ioVecLen].iov_base = payload;
+    ioVec[ioVecLen].iov_len  = contentLength;
+    ++ioVecLen;
 
+    niP->allOK = false;  // Set to 'true' once the response of the notification is received
+
+    //
+    // With notification sender threads, the request is queued and this thread is done with it
+    //
+    if (notificationSenders > 0)
+    {
       niP->fd        = -1;
       niP->connected = false;
 
-      LM_E(("Internal Error (unable to send to server for notification for subscription '%s'): %s", niP->subscriptionId, strerror(errno)));
+      notificationEnqueue(ip, port, niP->subscriptionId, ioVec, ioVecLen);
       continue;
     }
-  }
-
-  //
-  // Receive responses
-  //
-  int             fds;
-  fd_set          rFds;
-  int             fdMax      = 0;
-  int             startTime  = time(NULL);
-  struct timeval  tv         = { 1, 0 };
 
-  while (1)
-  {
     //
-    // Set File Descriptors for the select
+    // Data ready to send - on a keep-alive connection from the endpoint pool, if there is one
     //
-    FD_ZERO(&rFds);
-    for (int ix = 0; ix < orionldState.notificationRecords; ix++)
-    {
-      OrionldNotificationInfo*  niP = &orionldState.notificationInfo[ix];
+    bool reused;
 
-      if ((niP->fd != -1) && (niP->connected == true))
-      {
-        FD_SET(niP->fd, &rFds);
-        fdMax = MAX(fdMax, niP->fd);
-      }
+    niP->fd = orionldEndpointConnect(ip, port, false, 0, &niP->endpointP, &reused);
 
-      niP->allOK = false;  // Set to 'true' once the response of the notification is received
+    if ((niP->fd == -1) && (errno == EAGAIN))
+    {
+      //
+      // The endpoint has no free connection - possibly as this very request holds them all, waiting for their
+      // responses. Those responses are read (and the connections released) before waiting for a free connection.
+      //
+      responsesRead();
+      niP->fd = orionldEndpointConnect(ip, port, false, ORIONLD_ENDPOINT_WAIT_TIMEOUT, &niP->endpointP, &reused);
     }
 
-    fds = select(1, &rFds, NULL, NULL, &tv);
-    if ((fds == -1) && (errno != EINTR))
-      LM_X(1, ("select error: %s\n", strerror(errno)));
-    else if (fds > 0)
+    if (niP->fd == -1)
     {
-      for (int ix = 0; ix < orionldState.notificationRecords; ix++)
-      {
-        OrionldNotificationInfo*  niP = &orionldState.notificationInfo[ix];
+      niP->connected = false;
+      LM_E(("Internal Error (unable to connent to server for notification for subscription '%s': %s)", niP->subscriptionId, strerror(errno)));
+      continue;
+    }
 
-        if (FD_ISSET(niP->fd, &rFds))
-          responseTreat(niP, payload, payloadLen);  // We reuse the allocated buffer 'payload'
-      }
+    niP->connected = true;
+
+    int nb = requestSend(niP->fd, ioVec, ioVecLen);
+
+    if ((nb == -1) && (reused == true))
+    {
+      //
+      // The peer may have closed the idle connection right now - one more try, on a new connection
+      //
+      orionldEndpointRelease(niP->endpointP, niP->fd, false);
+
+      niP->fd = orionldEndpointConnect(ip, port, false, ORIONLD_ENDPOINT_WAIT_TIMEOUT, &niP->endpointP, &reused);
+      nb      = (niP->fd == -1)? -1 : requestSend(niP->fd, ioVec, ioVecLen);
     }
 
-    //
-    // Timeout after 10 seconds
-    //
-    // FIXME: calling time() might be avoided by inspecting 'tv'
-    //
-    if (time(NULL) > startTime + 10)
-      break;
-  }
+    if (nb == -1)
+    {
+      orionldEndpointRelease(niP->endpointP, niP->fd, false);
 
-  free(payload);
+      niP->fd        = -1;
+      niP->connected = false;
+
+      LM_E(("Internal Error (unable to send to server for notification for subscription '%s'): %s", niP->subscriptionId, strerror(errno)));
+      continue;
+    }
+  }
 
   //
-  // Close file descriptors and set lastFailure/lastSuccess
+  // Receive responses
   //
-  for (int ix = 0; ix < orionldState.notificationRecords; ix++)
-  {
-    OrionldNotificationInfo*  niP = &orionldState.notificationInfo[ix];
-
-    if (niP->fd != -1)
-      close(niP->fd);
+  // All notifications have been sent before waiting for the first response (unless an endpoint ran out of
+  // connections), so the receivers work in parallel.
+  //
+  responsesRead();
 
-#if 0
-    if (niP->allOK == true)
-      dbSubscriptionLastSuccessSet(niP->subscriptionId);
-    else
-      dbSubscriptionLastFailureSet(niP->subscriptionId);
-#endif
-  }
+  free(payload);
 }
@@ -36,9 +36,11 @@ extern "C"
 
 #include "rest/ConnectionInfo.h"                                 // ConnectionInfo
 #include "rest/HttpStatusCode.h"                                 // SccNotFound
+#include "rest/OrionError.h"                                     // OrionError
 #include "ngsi/ContextElement.h"                                 // ContextElement
+#include "ngsi10/UpdateContextRequest.h"                         // UpdateContextRequest
 
-#include "mongoBackend/mongoUpdateContext.h"                     // mongoUpdateContext
+#include "mongoBackend/mongoEntityAttributesReplace.h"           // mongoEntityAttributesReplace
 #include "mongoBackend/mongoQueryContext.h"                      // mongoQueryContext
 
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
@@ -308,7 +310,7 @@ KjNode* kjTreeAttributeMerge(KjNode* entityP, KjNode* newAttrP, const char* attr
 //   2. If matching registration - forward, await response and return that response to caller
 //   3. Convert KjNode tree to UpdateContextRequest
 //   ?. Perhaps GET the entity+attribute first and merge with incoming payload KjNode tree
-//   5. mongoUpdateContext with Update (Append?)
+//   5. mongoEntityAttributesReplace - only the attribute is written
 //
 // About Forwarding
 //   A PATCH can have only ONE match in the registrations.
@@ -388,38 +390,60 @@ bool orionldPatchAttribute(ConnectionInfo* ciP)
   // Convert the KjNode tree into an UpdateContextRequest, fit for mongoBackend
   //
   UpdateContextRequest   mongoRequest;
-  UpdateContextResponse  mongoResponse;
   ContextElement*        ceP = new ContextElement();
 
   mongoRequest.contextElementVector.push_back(ceP);
 
   if (kjTreeToEntity(&mongoRequest, mergedP) == false)
+  {
+    mongoRequest.release();
     return false;
+  }
 
 
   //
-  // Calling mongoBackend to do the actual DB update
+  // Calling mongoBackend to do the actual DB update - only the attribute is written, not the entire entity
   //
-  mongoRequest.updateActionType = ActionTypeAppend;
-  ciP->httpStatusCode = mongoUpdateContext(&mongoRequest,
-                                           &mongoResponse,
-                                           orionldState.tenant,
-                                           ciP->servicePathV,
-                                           ciP->uriParam,
-                                           ciP->httpHeaders.xauthToken,
-                                           ciP->httpHeaders.correlator,
-                                           ciP->httpHeaders.ngsiv2AttrsFormat,
-                                           ciP->apiVersion,
-                                           NGSIV2_NO_FLAVOUR);
-
-  if (ciP->httpStatusCode == SccOk)
-    ciP->httpStatusCode = SccNoContent;
-  else
+  std::vector<std::string>  notFoundV;
+  OrionError                oe;
+  HttpStatusCode            statusCode;
+
+  statusCode = mongoEntityAttributesReplace(ceP,
+                                            orionldState.tenant,
+                                            ciP->servicePathV,
+                                            ciP->httpHeaders.xauthToken,
+                                            ciP->httpHeaders.correlator,
+                                            ciP->apiVersion,
+                                            &notFoundV,
+                                            &oe);
+  mongoRequest.release();
+
+  if ((statusCode == SccContextElementNotFound) || (notFoundV.size() != 0))
+  {
+    // The entity/attribute was deleted after being looked up
+    char pair[1024];
+
+    snprintf(pair, sizeof(pair), "Entity '%s', Attribute '%s'", entityId, attrName);
+    ciP->httpStatusCode = SccNotFound;
+    orionldErrorResponseCreate(OrionldBadRequestData, "Entity/Attribute not found", pair);
+    return false;
+  }
+  else if (statusCode == SccConflict)
+  {
+    // The entity was modified by another request while its attributes were being replaced - the client may retry
+    ciP->httpStatusCode = SccConflict;
+    orionldErrorResponseCreate(OrionldBadRequestData, "Entity modified during the update - please retry", entityId);
+    return false;
+  }
+  else if (statusCode != SccOk)
   {
-    LM_E(("mongoUpdateContext: HTTP Status Code: %d", ciP->httpStatusCode));
-    orionldErrorResponseCreate(OrionldBadRequestData, "Internal Error", "Error from Mongo-DB backend");
+    LM_E(("mongoEntityAttributesReplace: HTTP Status Code: %d (%s)", statusCode, oe.details.c_str()));
+    ciP->httpStatusCode = SccReceiverInternalError;
+    orionldErrorResponseCreate(OrionldInternalError, "Internal Error", "Error from Mongo-DB backend");
     return false;
   }
 
+  ciP->httpStatusCode = SccNoContent;
+
   return true;
 }
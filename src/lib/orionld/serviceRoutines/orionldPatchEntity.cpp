@@ -26,9 +26,7 @@ extern "C"
 {
 #include "kalloc/kaStrdup.h"                                     // kaStrdup
 #include "kjson/KjNode.h"                                        // KjNode
-#include "kjson/kjLookup.h"                                      // kjLookup
-#include "kjson/kjBuilder.h"                                     // kjChildRemove
-#include "kjson/kjRender.h"                                      // kjRender
+#include "kjson/kjBuilder.h"                                     // kjObject, kjArray, kjString, kjChildAdd
 }
 
 #include "logMsg/logMsg.h"                                       // LM_*
@@ -36,19 +34,19 @@ extern "C"
 
 #include "rest/ConnectionInfo.h"                                 // ConnectionInfo
 #include "rest/HttpStatusCode.h"                                 // SccNotFound
-#include "mongoBackend/mongoUpdateContext.h"                     // mongoUpdateContext
+#include "rest/OrionError.h"                                     // OrionError
+#include "ngsi/ContextElement.h"                                 // ContextElement
+#include "mongoBackend/mongoEntityAttributesReplace.h"           // mongoEntityAttributesReplace
 
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
 #include "orionld/common/OrionldConnection.h"                    // orionldState
 #include "orionld/common/SCOMPARE.h"                             // SCOMPAREx
 #include "orionld/common/CHECK.h"                                // DUPLICATE_CHECK, STRING_CHECK, ...
-#include "orionld/common/dotForEq.h"                             // dotForEq
+#include "orionld/common/urlCheck.h"                             // urlCheck
+#include "orionld/common/urnCheck.h"                             // urnCheck
 #include "orionld/context/orionldContextItemExpand.h"            // orionldContextItemExpand
 #include "orionld/context/orionldContextValueExpand.h"           // orionldContextValueExpand
 #include "orionld/kjTree/kjTreeToContextAttribute.h"             // kjTreeToContextAttribute
-#include "orionld/kjTree/kjStringValueLookupInArray.h"           // kjStringValueLookupInArray
-#include "orionld/kjTree/kjTreeToUpdateContextRequest.h"         // kjTreeToUpdateContextRequest
-#include "orionld/mongoBackend/mongoAttributeExists.h"           // mongoAttributeExists
 #include "orionld/serviceRoutines/orionldPatchEntity.h"          // Own Interface
 
 
@@ -191,6 +189,9 @@ bool attributeCheck(ConnectionInfo* ciP, KjNode* attrNodeP, char** titleP, char*
 //   Attribute includes a datasetId, only an Attribute instance with the same datasetId is replaced.
 //   In all other cases, the Attribute shall be ignored.
 //
+// The entity is not read from the database - only the attributes of the payload are written (mongoEntityAttributesReplace),
+// and the attributes that the entity doesn't have are reported back by mongoBackend.
+//
 bool orionldPatchEntity(ConnectionInfo* ciP)
 {
   char* entityId   = orionldState.wildcard[0];
@@ -207,67 +208,20 @@ bool orionldPatchEntity(ConnectionInfo* ciP)
   // 2. Is the payload not a JSON object?
   OBJECT_CHECK(orionldState.requestTree, kjValueType(orionldState.requestTree->type));
 
-  // 3. Get the entity from mongo
-  KjNode* dbEntityP;
-  if ((dbEntityP = dbEntityLookup(entityId)) == NULL)
-  {
-    ciP->httpStatusCode = SccNotFound;
-    orionldErrorResponseCreate(OrionldBadRequestData, "Entity does not exist", entityId);
-    return false;
-  }
-
-  // 3. Get the Entity Type, needed later in the call to the constructor of ContextElement
-  KjNode* idNodeP = kjLookup(dbEntityP, "_id");
-
-  if (idNodeP == NULL)
-  {
-    ciP->httpStatusCode = SccReceiverInternalError;
-    orionldErrorResponseCreate(OrionldInternalError, "Corrupt Database", "'_id' field of entity from DB not found");
-    return false;
-  }
-
-  KjNode*     entityTypeNodeP = kjLookup(idNodeP, "type");
-  const char* entityType      = (entityTypeNodeP != NULL)? entityTypeNodeP->value.s : NULL;
-
-  if (entityTypeNodeP == NULL)
-  {
-    ciP->httpStatusCode = SccReceiverInternalError;
-    orionldErrorResponseCreate(OrionldInternalError, "Corrupt Database", "'_id::type' field of entity from DB not found");
-    return false;
-  }
-
-  // 4. Get the 'attrNames' array from the mongo entity - to see whether an attribute already existed or not
-  KjNode* inDbAttrNamesP = kjLookup(dbEntityP, "attrNames");
-  if (inDbAttrNamesP == NULL)
-  {
-    ciP->httpStatusCode = SccReceiverInternalError;
-    orionldErrorResponseCreate(OrionldInternalError, "Corrupt Database", "'attrNames' field of entity from DB not found");
-    return false;
-  }
-
-  // 4. Also, get the "attrs" object for insertion of modified attributes
-  KjNode* inDbAttrsP = kjLookup(dbEntityP, "attrs");
-  if (inDbAttrsP == NULL)
-  {
-    ciP->httpStatusCode = SccReceiverInternalError;
-    orionldErrorResponseCreate(OrionldInternalError, "Corrupt Database", "'attrs' field of entity from DB not found");
-    return false;
-  }
-
   //
-  // 5. Loop over the incoming payload data
-  //    Those attrs that don't exist in the DB (dbEntityP) are discarded and added to the 'notUpdated' array
-  //    Those that do exist in dbEntityP are removed from dbEntityP and replaced with the corresponding attribute from the incoming payload data.
-  //    (finally the modified dbEntityP will REPLACE what is currently in the database)
+  // 3. Loop over the incoming payload data and convert the valid attributes to ContextAttributes
+  //    Invalid attributes are discarded and added to the 'notUpdated' array
   //
-  KjNode* newAttrP     = orionldState.requestTree->value.firstChildP;
-  KjNode* next;
-  KjNode* updatedP     = kjArray(orionldState.kjsonP, "updated");
-  KjNode* notUpdatedP  = kjArray(orionldState.kjsonP, "notUpdated");
+  ContextElement  ce;
+  KjNode*         newAttrP     = orionldState.requestTree->value.firstChildP;
+  KjNode*         next;
+  KjNode*         updatedP     = kjArray(orionldState.kjsonP, "updated");
+  KjNode*         notUpdatedP  = kjArray(orionldState.kjsonP, "notUpdated");
+
+  ce.entityId.id = entityId;
 
   while (newAttrP != NULL)
   {
-    KjNode*  dbAttrP;
     bool     valueMayBeExpanded = false;
     char*    title;
     char*    detail;
@@ -285,96 +239,85 @@ bool orionldPatchEntity(ConnectionInfo* ciP)
       continue;
     }
 
-    char* eqName = kaStrdup(&orionldState.kalloc, newAttrP->name);
-    dotForEq(eqName);
-    dbAttrP = kjLookup(inDbAttrsP, eqName);
-    if (dbAttrP == NULL)  // Doesn't already exist - must be discarded
-    {
-      attributeNotUpdated(notUpdatedP, newAttrP->name, "attribute doesn't exist");
-      newAttrP = next;
-      continue;
-    }
-
     // All good, time to expand the value, if applicable
     if (valueMayBeExpanded)
       orionldContextValueExpand(newAttrP);
 
-    // Steal createdAt from dbAttrP?
-
-    // Remove the attribute to be updated (from dbEntityP::inDbAttrsP) and insert the attribute from the payload data
-    // <DEBUG>
-    char buf[1024];
-    kjRender(orionldState.kjsonP, dbAttrP, buf, sizeof(buf));
-    kjRender(orionldState.kjsonP, newAttrP, buf, sizeof(buf));
-
-    kjChildRemove(inDbAttrsP, dbAttrP);
-    kjChildAdd(inDbAttrsP, newAttrP);
-    attributeUpdated(updatedP, newAttrP->name);
-    newAttrP = next;
-  }
-
-
-  // 6. Convert the resulting tree (dbEntityP) to a ContextElement
-  UpdateContextRequest ucRequest;
-  ContextElement*      ceP = new ContextElement(entityId, entityType, "false");
-
-  ucRequest.contextElementVector.push_back(ceP);
-
-  for (KjNode* attrP = inDbAttrsP->value.firstChildP; attrP != NULL; attrP = attrP->next)
-  {
     ContextAttribute* caP = new ContextAttribute();
 
-    if (kjTreeToContextAttribute(ciP, orionldState.contextP, attrP, caP, NULL, &detail) == false)
+    if (kjTreeToContextAttribute(ciP, orionldState.contextP, newAttrP, caP, NULL, &detail) == false)
     {
       LM_E(("kjTreeToContextAttribute: %s", detail));
-      attributeNotUpdated(notUpdatedP, attrP->name, "Error");
+      attributeNotUpdated(notUpdatedP, newAttrP->name, "Error");
       delete caP;
     }
     else
-      ceP->contextAttributeVector.push_back(caP);
+      ce.contextAttributeVector.push_back(caP);
+
+    newAttrP = next;
   }
-  ucRequest.updateActionType = ActionTypeReplace;
 
 
-  // 8. Call mongoBackend to do the REPLACE of the entity
-  UpdateContextResponse  ucResponse;
+  // 4. Call mongoBackend to do the REPLACE of the attributes
+  std::vector<std::string>  notFoundV;
+  OrionError                oe;
+  HttpStatusCode            statusCode;
 
-  ciP->httpStatusCode = mongoUpdateContext(&ucRequest,
-                                           &ucResponse,
-                                           orionldState.tenant,
-                                           ciP->servicePathV,
-                                           ciP->uriParam,
-                                           ciP->httpHeaders.xauthToken,
-                                           ciP->httpHeaders.correlator,
-                                           ciP->httpHeaders.ngsiv2AttrsFormat,
-                                           ciP->apiVersion,
-                                           NGSIV2_NO_FLAVOUR);
+  statusCode = mongoEntityAttributesReplace(&ce,
+                                            orionldState.tenant,
+                                            ciP->servicePathV,
+                                            ciP->httpHeaders.xauthToken,
+                                            ciP->httpHeaders.correlator,
+                                            ciP->apiVersion,
+                                            &notFoundV,
+                                            &oe);
 
-  // 9. Postprocess output from mongoBackend
-  if (ciP->httpStatusCode == SccOk)
-  {
-    //
-    // 204 or 207?
-    // If 207 - prepare the response payload data
-    //
-    if (notUpdatedP->value.firstChildP != NULL)
-    {
-      orionldState.responseTree = kjObject(orionldState.kjsonP, NULL);
+  // Attributes not found in the entity have been removed from 'ce' by mongoBackend
+  for (unsigned int ix = 0; ix < ce.contextAttributeVector.size(); ix++)
+    attributeUpdated(updatedP, kaStrdup(&orionldState.kalloc, ce.contextAttributeVector[ix]->name.c_str()));
 
-      kjChildAdd(orionldState.responseTree, updatedP);
-      kjChildAdd(orionldState.responseTree, notUpdatedP);
+  for (unsigned int ix = 0; ix < notFoundV.size(); ix++)
+    attributeNotUpdated(notUpdatedP, kaStrdup(&orionldState.kalloc, notFoundV[ix].c_str()), "attribute doesn't exist");
 
-      ciP->httpStatusCode = SccMultiStatus;
-    }
-    else
-      ciP->httpStatusCode = SccNoContent;
+  ce.release();
+
+  // 5. Postprocess output from mongoBackend
+  if (statusCode == SccContextElementNotFound)
+  {
+    ciP->httpStatusCode = SccNotFound;
+    orionldErrorResponseCreate(OrionldBadRequestData, "Entity does not exist", entityId);
+    return false;
   }
-  else
+  else if (statusCode == SccConflict)
   {
-    LM_E(("mongoUpdateContext: HTTP Status Code: %d", ciP->httpStatusCode));
-    orionldErrorResponseCreate(OrionldBadRequestData, "Internal Error", "Error from Mongo-DB backend");
+    // The entity was modified by another request while its attributes were being replaced - the client may retry
+    ciP->httpStatusCode = SccConflict;
+    orionldErrorResponseCreate(OrionldBadRequestData, "Entity modified during the update - please retry", entityId);
+    return false;
+  }
+  else if (statusCode != SccOk)
+  {
+    LM_E(("mongoEntityAttributesReplace: HTTP Status Code: %d (%s)", statusCode, oe.details.c_str()));
+    ciP->httpStatusCode = SccReceiverInternalError;
+    orionldErrorResponseCreate(OrionldInternalError, "Internal Error", "Error from Mongo-DB backend");
     return false;
   }
 
+  //
+  // 204 or 207?
+  // If 207 - prepare the response payload data
+  //
+  if (notUpdatedP->value.firstChildP != NULL)
+  {
+    orionldState.responseTree = kjObject(orionldState.kjsonP, NULL);
+
+    kjChildAdd(orionldState.responseTree, updatedP);
+    kjChildAdd(orionldState.responseTree, notUpdatedP);
+
+    ciP->httpStatusCode = SccMultiStatus;
+  }
+  else
+    ciP->httpStatusCode = SccNoContent;
+
   return true;
 }
@@ -31,7 +31,7 @@ extern "C"
 #include "logMsg/logMsg.h"                                      // LM_*
 #include "logMsg/traceLevels.h"                                 // Lmt*
 
-#include "common/globals.h"                                     // parse8601Time
+#include "common/globals.h"                                     // parse8601Time, noCache
 #include "rest/ConnectionInfo.h"                                // ConnectionInfo
 
 #include "orionld/common/orionldState.h"                        // orionldState
@@ -42,6 +42,7 @@ extern "C"
 #include "orionld/context/orionldContextValueExpand.h"          // orionldContextValueExpand
 #include "orionld/context/orionldContextItemAlreadyExpanded.h"  // orionldContextItemAlreadyExpanded
 #include "orionld/db/dbConfiguration.h"                         // dbRegistrationGet, dbRegistrationReplace
+#include "orionld/db/dbRegCacheTenantRefresh.h"                 // dbRegCacheTenantRefresh
 #include "orionld/payloadCheck/pcheckRegistration.h"            // pcheckRegistration
 #include "orionld/serviceRoutines/orionldPatchRegistration.h"   // Own Interface
 
@@ -646,6 +647,10 @@ bool orionldPatchRegistration(ConnectionInfo* ciP)
   //
   dbRegistrationReplace(registrationId, dbRegistrationP);
 
+  // Forwarding lookups use the registration cache - it must reflect the patched registration
+  if (noCache == false)
+    dbRegCacheTenantRefresh(orionldState.tenant);
+
   // All OK? 204
   ciP->httpStatusCode = SccNoContent;
 
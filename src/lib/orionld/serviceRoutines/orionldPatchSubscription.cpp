@@ -32,12 +32,16 @@ extern "C"
 #include "logMsg/logMsg.h"                                      // LM_*
 #include "logMsg/traceLevels.h"                                 // Lmt*
 
+#include "common/globals.h"                                     // noCache
+#include "common/sem.h"                                         // cacheSemTake, cacheSemGive
 #include "rest/ConnectionInfo.h"                                // ConnectionInfo
+#include "cache/subCache.h"                                     // CachedSubscription, subCacheItemLookup, subCacheItemQCompile
 
 #include "orionld/common/orionldState.h"                        // orionldState
 #include "orionld/common/orionldErrorResponse.h"                // orionldErrorResponseCreate
 #include "orionld/common/urlCheck.h"                            // urlCheck
 #include "orionld/common/urnCheck.h"                            // urnCheck
+#include "orionld/common/qCompiledRelease.h"                    // qCompiledRelease
 #include "orionld/payloadCheck/pcheckSubscription.h"            // pcheckSubscription
 #include "orionld/db/dbConfiguration.h"                         // dbSubscriptionGet
 #include "orionld/serviceRoutines/orionldPatchSubscription.h"   // Own Interface
@@ -403,6 +407,17 @@ static bool ngsildSubscriptionToAPIv1Datamodel(KjNode* patchTree)
           kjChildAdd(patchTree, acceptP);
         }
       }
+      else if (strcmp(nItemP->name, "batch") == 0)
+      {
+        KjNode* maxEntitiesP = kjLookup(nItemP, "maxEntities");  // pcheckBatch makes sure both fields are present
+        KjNode* maxDelayP    = kjLookup(nItemP, "maxDelay");
+
+        kjChildRemove(notificationP, nItemP);
+        maxEntitiesP->name = (char*) "batchMaxEntities";
+        maxDelayP->name    = (char*) "batchMaxDelay";
+        kjChildAdd(patchTree, maxEntitiesP);
+        kjChildAdd(patchTree, maxDelayP);
+      }
 
       nItemP = next;
     }
@@ -462,6 +477,39 @@ static void fixDbSubscription(KjNode* dbSubscriptionP)
 
 
 
+// ----------------------------------------------------------------------------
+//
+// subCacheItemQReplace - replace the 'q' of the cached subscription, and recompile it
+//
+// The attribute names of 'q' have already been expanded (by pcheckSubscription), but string values may need the
+// @context of the request to be expanded, so the new 'q' is compiled using the @context of the PATCH request.
+//
+static void subCacheItemQReplace(const char* subscriptionId, const char* q)
+{
+  cacheSemTake(__FUNCTION__, "Replacing the q of a cached subscription");
+
+  CachedSubscription* cSubP = subCacheItemLookup(orionldState.tenant, subscriptionId);
+
+  if (cSubP != NULL)
+  {
+    if (cSubP->qCompiledP != NULL)
+    {
+      qCompiledRelease(cSubP->qCompiledP);
+      cSubP->qCompiledP = NULL;
+    }
+
+    cSubP->expression.q = q;
+    cSubP->qPending     = false;
+
+    if (q[0] != 0)
+      subCacheItemQCompile(cSubP, orionldState.contextP);
+  }
+
+  cacheSemGive(__FUNCTION__, "Replacing the q of a cached subscription");
+}
+
+
+
 // ----------------------------------------------------------------------------
 //
 // orionldPatchSubscription -
@@ -574,6 +622,13 @@ bool orionldPatchSubscription(ConnectionInfo* ciP)
   //
   dbSubscriptionReplace(subscriptionId, dbSubscriptionP);
 
+  //
+  // The rest of the cached subscription is updated by the next refresh of the subscription cache, but
+  // the compiled 'q' is what filters the notifications, so, it is replaced right away
+  //
+  if ((noCache == false) && (qP != NULL) && (qP->type == KjString))
+    subCacheItemQReplace(subscriptionId, qP->value.s);
+
   // All OK? 204
   ciP->httpStatusCode = SccNoContent;
 
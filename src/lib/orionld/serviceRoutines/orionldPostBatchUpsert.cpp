@@ -29,6 +29,8 @@ extern "C"
 #include "kjson/kjBuilder.h"                                   // kjString, kjObject, ...
 #include "kjson/kjLookup.h"                                    // kjLookup
 #include "kjson/kjRender.h"                                    // kjRender
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
+#include "khash/khash.h"                                       // KHashTable, khashTableCreate, khashItemAdd, khashItemLookup
 }
 
 #include "logMsg/logMsg.h"                                     // LM_*
@@ -43,7 +45,7 @@ extern "C"
 #include "ngsi/ContextAttribute.h"                             // ContextAttribute
 #include "ngsi10/UpdateContextRequest.h"                       // UpdateContextRequest
 #include "ngsi10/UpdateContextResponse.h"                      // UpdateContextResponse
-#include "mongoBackend/mongoUpdateContext.h"                   // mongoUpdateContext
+#include "mongoBackend/mongoBatchUpsert.h"                     // mongoBatchUpsert
 #include "rest/uriParamNames.h"                                // URI_PARAM_PAGINATION_OFFSET, URI_PARAM_PAGINATION_LIMIT
 #include "mongoBackend/MongoGlobal.h"                          // getMongoConnection()
 
@@ -56,12 +58,12 @@ extern "C"
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/common/entityErrorPush.h"                    // entityErrorPush
 #include "orionld/common/OrionldProblemDetails.h"              // OrionldProblemDetails
+#include "orionld/common/stringHash.h"                         // stringHash
 #include "orionld/context/orionldCoreContext.h"                // orionldDefaultUrl, orionldCoreContext
 #include "orionld/context/orionldContextPresent.h"             // orionldContextPresent
 #include "orionld/context/orionldContextItemAliasLookup.h"     // orionldContextItemAliasLookup
 #include "orionld/context/orionldContextItemExpand.h"          // orionldUriExpand
 #include "orionld/context/orionldContextFromTree.h"            // orionldContextFromTree
-#include "orionld/kjTree/kjStringValueLookupInArray.h"         // kjStringValueLookupInArray
 #include "orionld/kjTree/kjTreeToUpdateContextRequest.h"       // kjTreeToUpdateContextRequest
 #include "orionld/serviceRoutines/orionldPostBatchUpsert.h"    // Own Interface
 
@@ -82,19 +84,16 @@ static void entityIdPush(KjNode* entityIdsArrayP, const char* entityId)
 
 // -----------------------------------------------------------------------------
 //
-// entityLookupById - lookup an entity in an array of entities, by its entity-id
+// entityIdCompare - compare function for the hash tables of entities, keyed by entity-id
 //
-static KjNode* entityLookupById(KjNode* entityArray, char* entityId)
+static int entityIdCompare(const char* entityId, void* itemP)
 {
-  for (KjNode* entityP = entityArray->value.firstChildP; entityP != NULL; entityP = entityP->next)
-  {
-    KjNode* idNodeP = kjLookup(entityP, "id");
+  KjNode* idNodeP = kjLookup((KjNode*) itemP, "id");
 
-    if ((idNodeP != NULL) && (strcmp(idNodeP->value.s, entityId) == 0))  // If NULL, something is really wrong!!!
-      return entityP;
-  }
+  if (idNodeP == NULL)  // Entities without id are never added to the hash tables
+    return 1;
 
-  return NULL;
+  return strcmp(entityId, idNodeP->value.s);
 }
 
 
@@ -289,28 +288,11 @@ static void entityTypeAndCreDateGet(KjNode* dbEntityP, char** idP, char** typeP,
 
 
 
-// -----------------------------------------------------------------------------
-//
-// removeArrayRemoveEntity -
-//
-KjNode* removeArrayEntityLookup(KjNode* removeArray, char* entityId)
-{
-  for (KjNode* nodeP = removeArray->value.firstChildP; nodeP != NULL; nodeP = nodeP->next)
-  {
-    if (strcmp(nodeP->value.s, entityId) == 0)
-      return nodeP;
-  }
-
-  return NULL;
-}
-
-
-
 // ----------------------------------------------------------------------------
 //
 // typeCheckForNonExistingEntities -
 //
-bool typeCheckForNonExistingEntities(KjNode* incomingTree, KjNode* idTypeAndCreDateFromDb, KjNode* errorsArrayP, KjNode* removeArray)
+static bool typeCheckForNonExistingEntities(KjNode* incomingTree, KHashTable* dbEntityHash, KjNode* errorsArrayP)
 {
   KjNode* inNodeP = incomingTree->value.firstChildP;
   KjNode* next;
@@ -332,13 +314,10 @@ bool typeCheckForNonExistingEntities(KjNode* incomingTree, KjNode* idTypeAndCreD
       continue;
     }
 
-    KjNode* dbEntityId = NULL;
+    // Lookup the entity::id in what came from the database
+    KjNode* dbEntityP = (KjNode*) khashItemLookup(dbEntityHash, inEntityIdNodeP->value.s);
 
-    // Lookup the entity::id in what came from the database - if anything at all came
-    if (idTypeAndCreDateFromDb != NULL)
-      dbEntityId = entityLookupById(idTypeAndCreDateFromDb, inEntityIdNodeP->value.s);
-
-    if (dbEntityId == NULL)  // This Entity is to be created - "type" is mandatory!
+    if (dbEntityP == NULL)  // This Entity is to be created - "type" is mandatory!
     {
       KjNode* inEntityTypeNodeP = kjLookup(inNodeP, "type");
 
@@ -347,10 +326,6 @@ bool typeCheckForNonExistingEntities(KjNode* incomingTree, KjNode* idTypeAndCreD
         LM_E(("KZ: Invalid Entity: Mandatory field entity::type is missing"));
         entityErrorPush(errorsArrayP, inEntityIdNodeP->value.s, OrionldBadRequestData, "Invalid Entity", "Mandatory field entity::type is missing", 400);
 
-        KjNode* entityInRemoveArray = removeArrayEntityLookup(removeArray, inEntityIdNodeP->value.s);
-        if (entityInRemoveArray != NULL)
-          kjChildRemove(removeArray, entityInRemoveArray);
-
         next = inNodeP->next;
         kjChildRemove(incomingTree, inNodeP);
         inNodeP = next;
@@ -410,38 +385,38 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
   // if (replace)
   // {
   //   01. Create "idArray" from the "incomingTree", with error handling
+  //       All valid entities are hashed by Entity::Id into "incomingHash" (duplicated Entity::Ids are errors)
   //   02. Get "idTypeAndCredateFromDb" by calling dbEntityListLookupWithIdTypeCreDate(idArray);
-  //   03. Creation Date from DB entities, and type-check
+  //   03. Type-check the entities that already exist
   //       - Make sure that no entity in the incomingTree contains a "type" != type in db for that entity
-  //       - Add creDate from DB to incomingTree
   //       Foreach entity in idTypeAndCredateFromDb  (those that existed in the database)
-  //       03.1 Lookup entity-pointer in "incomingTree"
-  //       03.2 Call entityFieldsExtract
-  //       03.3 If entityFieldsExtract returns false:
+  //       03.1 Add the entity to "dbEntityHash"
+  //       03.2 Lookup entity-pointer in "incomingHash"
+  //       03.3 Compare types, if entity in idTypeAndCredateFromDb has one and if not the same:
   //            03.3.1 remove entity from incomingTree
-  //            03.3.1 remove entity from idArray
   //            03.3.2 add error by calling entityErrorPush()
-  //       03.4 Get type and creDate from entity in idTypeAndCredateFromDb
-  //       03.5 Compare types, if entity in idTypeAndCredateFromDb has one and if not the same:
-  //            03.5.1 remove entity from incomingTree
-  //            03.5.1 remove entity from idArray
-  //            03.5.2 add error by calling entityErrorPush()
-  //       03.6 Add creDate to entity-pointer in "incomingTree"
-  //       04. Make sure all entities that did not exist hav a type in the incoming payload
-  //       05. Remove the entities in "idArray" from DB
+  //       04. Make sure all entities that did not exist have a type in the incoming payload
   // }
   //
-  // 06. Fill in UpdateContextRequest from "incomingTree"
-  // 07. Set 'modDate' as "RIGHT NOW" for all entities
-  // 08. Call mongoBackend with AppendStrict - as all already existing entities have been removed
+  // 05. Fill in UpdateContextRequest from "incomingTree"
+  // 06. Set creDate (from DB, for existing entities) and 'modDate' as "RIGHT NOW" for all entities
+  // 07. Call mongoBackend to create/replace all entities in one bulk write
+  //     Existing entities are replaced (not removed and re-created), keeping their creDate
   //
   KjNode*               incomingTree   = orionldState.requestTree;
   KjNode*               idArray        = kjArray(orionldState.kjsonP, NULL);
   KjNode*               successArrayP  = kjArray(orionldState.kjsonP, "success");
   KjNode*               errorsArrayP   = kjArray(orionldState.kjsonP, "errors");
+  int                   entities       = 0;
   KjNode*               entityP;
   KjNode*               next;
 
+  for (entityP = incomingTree->value.firstChildP; entityP != NULL; entityP = entityP->next)
+    ++entities;
+
+  KHashTable* incomingHash = khashTableCreate(&orionldState.kalloc, stringHash, entityIdCompare, entities);
+  KHashTable* dbEntityHash = khashTableCreate(&orionldState.kalloc, stringHash, entityIdCompare, entities);
+
   //
   // 01. Create idArray as an array of entity IDs, extracted from orionldState.requestTree
   //
@@ -454,9 +429,7 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
     char*   entityType;
 
     // entityIdAndTypeGet calls entityIdCheck/entityTypeCheck that adds the entity in errorsArrayP if needed
-    if (entityIdAndTypeGet(entityP, &entityId, &entityType, errorsArrayP) == true)
-      entityIdPush(idArray, entityId);
-    else
+    if (entityIdAndTypeGet(entityP, &entityId, &entityType, errorsArrayP) == false)
     {
       kjChildRemove(incomingTree, entityP);
       entityP = next;
@@ -478,6 +451,19 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
       entityErrorPush(errorsArrayP, entityId, OrionldBadRequestData, "Invalid payload", "Content-Type is 'application/json', and an @context is present in the payload data array item", 400);
       kjChildRemove(incomingTree, entityP);
     }
+    else if (khashItemLookup(incomingHash, entityId) != NULL)
+    {
+      //
+      // All operations of the bulk write are unordered - the same entity cannot be upserted twice
+      //
+      entityErrorPush(errorsArrayP, entityId, OrionldBadRequestData, "Duplicated entity", entityId, 400);
+      kjChildRemove(incomingTree, entityP);
+    }
+    else
+    {
+      khashItemAdd(incomingHash, entityId, entityP);
+      entityIdPush(idArray, entityId);
+    }
 
     entityP = next;
   }
@@ -491,14 +477,8 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
   KjNode* idTypeAndCreDateFromDb = dbEntityListLookupWithIdTypeCreDate(idArray);
 
   //
-  // 03. Creation Date from DB entities, and type-check
-  //
-  // LOOP OVER idTypeAndCreDateFromDb.
-  // Add all the entities to "removeArray", unless an error occurs (with non-matching types for example)
+  // 03. Type-check the entities that already exist
   //
-  KjNode* removeArray       = NULL;  // This array contains the Entity::Id of all entities to be removed from DB
-  int     entitiesToRemove  = 0;
-
   if (idTypeAndCreDateFromDb != NULL)
   {
     for (KjNode* dbEntityP = idTypeAndCreDateFromDb->value.firstChildP; dbEntityP != NULL; dbEntityP = dbEntityP->next)
@@ -515,11 +495,19 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
       // Get entity id, type and creDate from the DB
       entityTypeAndCreDateGet(dbEntityP, &idInDb, &typeInDb, &creDateInDb);
 
+      if (idInDb == NULL)
+        continue;
+
+      khashItemAdd(dbEntityHash, idInDb, dbEntityP);
+
       //
       // For the entity in question - get id and type from the incoming payload
       // First look up the entity with ID 'idInDb' in the incoming payload
       //
-      entityP       = entityLookupById(incomingTree, idInDb);
+      entityP = (KjNode*) khashItemLookup(incomingHash, idInDb);
+      if (entityP == NULL)
+        continue;
+
       typeInPayload = entityTypeGet(entityP, &contextNodeP);
 
       if (contextNodeP != NULL)
@@ -531,7 +519,6 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
       // If type exists in the incoming payload, it must be equal to the type in the DB
       // If not, it's an error, so:
       //   - add entityId to errorsArrayP
-      //   - add entityId to removeArray
       //   - remove from incomingTree
       //
       // Remember, the type in DB is expanded. We must expand the 'type' in the incoming payload as well, before we compare
@@ -543,14 +530,11 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
         if (strcmp(typeInPayloadExpanded, typeInDb) != 0)
         {
           //
-          // As the entity type differed, this entity will not be updated in DB, nor will it be removed:
-          // - removed from incomingTree
-          // - not added to "removeArray"
+          // As the entity type differed, this entity will not be updated in DB - removed from incomingTree
           //
           LM_W(("Bad Input (orig entity type: '%s'. New entity type: '%s'", typeInDb, typeInPayloadExpanded));
           entityErrorPush(errorsArrayP, idInDb, OrionldBadRequestData, "non-matching entity type", typeInPayload, 400);
           kjChildRemove(incomingTree, entityP);
-          entityP = next;
           continue;
         }
       }
@@ -560,90 +544,72 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
         KjNode* typeNodeP = kjString(orionldState.kjsonP, "type", typeInDb);
         kjChildAdd(entityP, typeNodeP);
       }
-
-      //
-      // Add creDate from DB to the entity of the incoming tree
-      //
-      KjNode* creDateNodeP = kjInteger(orionldState.kjsonP, idInDb, creDateInDb);
-      if (orionldState.creDatesP == NULL)
-        orionldState.creDatesP = kjObject(orionldState.kjsonP, NULL);
-      kjChildAdd(orionldState.creDatesP, creDateNodeP);
-
-      //
-      // Add the Entity-ID to "removeArray" for later removal, before re-creation
-      //
-      if (removeArray == NULL)
-        removeArray = kjArray(orionldState.kjsonP, NULL);
-
-      KjNode* idNodeP = kjString(orionldState.kjsonP, NULL, idInDb);
-      kjChildAdd(removeArray, idNodeP);
-      ++entitiesToRemove;
-
-      // Point to the next entity and continue
-      entityP = next;
     }
   }
 
 
   //
   // 04. Entity::type is MANDATORY for entities that did not already exist
-  //     Erroneous entities must be:
-  //     - reported via entityErrorPush()
-  //     - removed from "removeArray"
-  //     - removed from "incomingTree"
-  //
-  // So, before calling 'typeCheckForNonExistingEntities' we must make sure the removeArray exists
-  //
-  if (removeArray == NULL)
-    removeArray = kjArray(orionldState.kjsonP, NULL);
-
-  typeCheckForNonExistingEntities(incomingTree, idTypeAndCreDateFromDb, errorsArrayP, removeArray);
-
-
+  //     Erroneous entities are reported via entityErrorPush() and removed from "incomingTree"
   //
-  // 05. Remove the entities in "removeArray" from DB
-  //
-  if ((removeArray != NULL) && (removeArray->value.firstChildP != NULL))
-    dbEntityBatchDelete(removeArray);
+  typeCheckForNonExistingEntities(incomingTree, dbEntityHash, errorsArrayP);
 
 
   //
-  // 06. Fill in UpdateContextRequest from "incomingTree"
+  // 05. Fill in UpdateContextRequest from "incomingTree"
   //
   UpdateContextRequest  mongoRequest;
+  KjNode**              geoPropertyV = (KjNode**) kaAlloc(&orionldState.kalloc, (entities + 1) * sizeof(KjNode*));
 
   mongoRequest.updateActionType = ActionTypeAppendStrict;
 
-  kjTreeToUpdateContextRequest(ciP, &mongoRequest, incomingTree, errorsArrayP);
+  kjTreeToUpdateContextRequest(ciP, &mongoRequest, incomingTree, errorsArrayP, geoPropertyV);
 
 
   //
-  // 07. Set 'modDate' as "RIGHT NOW"
+  // 06. Set 'creDate', type and service path of already existing entities and 'modDate' as "RIGHT NOW"
+  //     The stored type and service path are part of the _id of the entity in the database, and the _id
+  //     of an existing entity cannot change in the replace
   //
   time_t now = time(NULL);
 
   for (unsigned int ix = 0; ix < mongoRequest.contextElementVector.size(); ++ix)
   {
-    mongoRequest.contextElementVector[ix]->entityId.modDate = now;
+    EntityId* entityIdP = &mongoRequest.contextElementVector[ix]->entityId;
+    KjNode*   dbEntityP = (KjNode*) khashItemLookup(dbEntityHash, entityIdP->id.c_str());
+
+    if (dbEntityP != NULL)
+    {
+      KjNode* creDateNodeP     = kjLookup(dbEntityP, "creDate");
+      KjNode* typeNodeP        = kjLookup(dbEntityP, "type");
+      KjNode* servicePathNodeP = kjLookup(dbEntityP, "servicePath");
+
+      if (creDateNodeP != NULL)
+        entityIdP->creDate = (creDateNodeP->type == KjInt)? creDateNodeP->value.i : creDateNodeP->value.f;
+
+      if (typeNodeP != NULL)
+        entityIdP->type = typeNodeP->value.s;
+
+      entityIdP->servicePath = (servicePathNodeP != NULL)? servicePathNodeP->value.s : "/";
+    }
+
+    entityIdP->modDate = now;
   }
 
 
   //
-  // 08. Call mongoBackend - to create/modify the entities
-  //     In case of REPLACE, all entities have been removed from the DB prior to this call, so, they will all be created.
+  // 07. Call mongoBackend - to create/replace the entities, all of them in one bulk write
   //
   UpdateContextResponse mongoResponse;
 
-  ciP->httpStatusCode = mongoUpdateContext(&mongoRequest,
-                                           &mongoResponse,
-                                           orionldState.tenant,
-                                           ciP->servicePathV,
-                                           ciP->uriParam,
-                                           ciP->httpHeaders.xauthToken,
-                                           ciP->httpHeaders.correlator,
-                                           ciP->httpHeaders.ngsiv2AttrsFormat,
-                                           ciP->apiVersion,
-                                           NGSIV2_NO_FLAVOUR);
+  ciP->httpStatusCode = mongoBatchUpsert(&mongoRequest,
+                                         geoPropertyV,
+                                         &mongoResponse,
+                                         orionldState.tenant,
+                                         ciP->servicePathV,
+                                         ciP->httpHeaders.xauthToken,
+                                         ciP->httpHeaders.correlator,
+                                         ciP->apiVersion);
 
   //
   // Now check orionldState.errorAttributeArray to see whether any attribute failed to be updated
@@ -656,27 +622,20 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
   {
     orionldState.responseTree = kjObject(orionldState.kjsonP, NULL);
 
+    //
+    // The bulk write gives back one ContextElementResponse per entity, with the outcome of that very entity
+    //
     for (unsigned int ix = 0; ix < mongoResponse.contextElementResponseVector.vec.size(); ix++)
     {
-      const char* entityId = mongoResponse.contextElementResponseVector.vec[ix]->contextElement.entityId.id.c_str();
+      ContextElementResponse* cerP     = mongoResponse.contextElementResponseVector.vec[ix];
+      const char*             entityId = cerP->contextElement.entityId.id.c_str();
 
-      if (mongoResponse.contextElementResponseVector.vec[ix]->statusCode.code == SccOk)
+      if (cerP->statusCode.code == SccOk)
         entitySuccessPush(successArrayP, entityId);
+      else if (cerP->statusCode.code == SccReceiverInternalError)
+        entityErrorPush(errorsArrayP, entityId, OrionldInternalError, "Database Error", cerP->statusCode.details.c_str(), 500);
       else
-        entityErrorPush(errorsArrayP,
-                        entityId,
-                        OrionldBadRequestData,
-                        "",
-                        mongoResponse.contextElementResponseVector.vec[ix]->statusCode.reasonPhrase.c_str(),
-                        400);
-    }
-
-    for (unsigned int ix = 0; ix < mongoRequest.contextElementVector.vec.size(); ix++)
-    {
-      const char* entityId = mongoRequest.contextElementVector.vec[ix]->entityId.id.c_str();
-
-      if (kjStringValueLookupInArray(successArrayP, entityId) == NULL)
-        entitySuccessPush(successArrayP, entityId);
+        entityErrorPush(errorsArrayP, entityId, OrionldBadRequestData, cerP->statusCode.reasonPhrase.c_str(), cerP->statusCode.details.c_str(), 400);
     }
 
     //
@@ -40,9 +40,9 @@ extern "C"
 #include "orionTypes/UpdateActionType.h"                         // ActionType
 #include "parse/CompoundValueNode.h"                             // CompoundValueNode
 #include "ngsi/ContextAttribute.h"                               // ContextAttribute
-#include "ngsi10/UpdateContextRequest.h"                         // UpdateContextRequest
-#include "ngsi10/UpdateContextResponse.h"                        // UpdateContextResponse
-#include "mongoBackend/mongoUpdateContext.h"                     // mongoUpdateContext
+#include "ngsi/ContextElement.h"                                 // ContextElement
+#include "rest/OrionError.h"                                     // OrionError
+#include "mongoBackend/mongoEntityCreate.h"                      // mongoEntityCreate
 
 #include "orionld/rest/orionldServiceInit.h"                     // orionldHostName, orionldHostNameLen
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
@@ -54,7 +54,6 @@ extern "C"
 #include "orionld/common/orionldEntityPayloadCheck.h"            // orionldEntityPayloadCheck
 #include "orionld/context/orionldContextItemExpand.h"            // orionldContextItemExpand
 #include "orionld/kjTree/kjTreeToContextAttribute.h"             // kjTreeToContextAttribute
-#include "orionld/mongoBackend/mongoEntityExists.h"              // mongoEntityExists
 #include "orionld/serviceRoutines/orionldPostEntities.h"         // Own interface
 
 
@@ -90,27 +89,10 @@ bool orionldPostEntities(ConnectionInfo* ciP)
     return false;
   }
 
-
-  //
-  // If the entity already exists, an error should be returned
-  //
-  if (mongoEntityExists(entityId, orionldState.tenant) == true)
-  {
-    orionldErrorResponseCreate(OrionldAlreadyExists, "Entity already exists", entityId);
-    ciP->httpStatusCode = SccConflict;
-    return false;
-  }
-
   orionldState.entityId = entityId;
 
-  UpdateContextRequest   mongoRequest;
-  UpdateContextResponse  mongoResponse;
-  ContextElement*        ceP       = new ContextElement();  // FIXME: Any way I can avoid to allocate ?
-  EntityId*              entityIdP;
-
-  mongoRequest.contextElementVector.push_back(ceP);
-  entityIdP = &mongoRequest.contextElementVector[0]->entityId;
-  mongoRequest.updateActionType = ActionTypeAppend;
+  ContextElement  ce;
+  EntityId*       entityIdP = &ce.entityId;
 
   entityIdP->id            = entityId;
   entityIdP->isPattern     = "false";
@@ -139,12 +121,12 @@ bool orionldPostEntities(ConnectionInfo* ciP)
       // kjTreeToContextAttribute calls orionldErrorResponseCreate
       LM_E(("kjTreeToContextAttribute failed: %s", detail));
       delete caP;
-      mongoRequest.release();
+      ce.release();
       return false;
     }
 
     if (attrTypeNodeP != NULL)
-      ceP->contextAttributeVector.push_back(caP);
+      ce.contextAttributeVector.push_back(caP);
     else
       delete caP;
   }
@@ -153,23 +135,30 @@ bool orionldPostEntities(ConnectionInfo* ciP)
   //
   // Mongo
   //
-  ciP->httpStatusCode = mongoUpdateContext(&mongoRequest,
-                                           &mongoResponse,
-                                           orionldState.tenant,
-                                           ciP->servicePathV,
-                                           ciP->uriParam,
-                                           ciP->httpHeaders.xauthToken,
-                                           ciP->httpHeaders.correlator,
-                                           ciP->httpHeaders.ngsiv2AttrsFormat,
-                                           ciP->apiVersion,
-                                           NGSIV2_NO_FLAVOUR);
-
-  mongoRequest.release();
-  mongoResponse.release();
-
-  if (ciP->httpStatusCode != SccOk)
+  // The entity is inserted without being queried first - if an entity with the same id already exists,
+  // mongoEntityCreate returns SccConflict
+  //
+  OrionError      oe;
+  HttpStatusCode  statusCode;
+
+  statusCode = mongoEntityCreate(&ce,
+                                 orionldState.tenant,
+                                 ciP->servicePathV,
+                                 ciP->httpHeaders.xauthToken,
+                                 ciP->httpHeaders.correlator,
+                                 ciP->apiVersion,
+                                 &oe);
+  ce.release();
+
+  if (statusCode == SccConflict)
+  {
+    orionldErrorResponseCreate(OrionldAlreadyExists, "Entity already exists", entityId);
+    ciP->httpStatusCode = SccConflict;
+    return false;
+  }
+  else if (statusCode != SccOk)
   {
-    LM_E(("mongoUpdateContext: HTTP Status Code: %d", ciP->httpStatusCode));
+    LM_E(("mongoEntityCreate: HTTP Status Code: %d (%s)", statusCode, oe.details.c_str()));
     orionldErrorResponseCreate(OrionldBadRequestData, "Internal Error", "Error from Mongo-DB backend");
     return false;
   }
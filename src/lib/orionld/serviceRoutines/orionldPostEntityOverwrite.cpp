@@ -541,6 +541,8 @@ static bool subscriptionMatchCallback
   KjNode*  attrsP            = NULL;
   KjNode*  expirationP       = NULL;
   KjNode*  throttlingP       = NULL;
+  KjNode*  batchMaxEntitiesP = NULL;
+  KjNode*  batchMaxDelayP    = NULL;
   int      now               = 0;
 
   for (KjNode* nodeP = subscriptionTree->value.firstChildP; nodeP != NULL; nodeP = nodeP->next)
@@ -557,6 +559,10 @@ static bool subscriptionMatchCallback
       expirationP = nodeP;
     else if ((throttlingP == NULL) && (strcmp(nodeP->name, "throttling") == 0))
       throttlingP = nodeP;
+    else if ((batchMaxEntitiesP == NULL) && (strcmp(nodeP->name, "batchMaxEntities") == 0))
+      batchMaxEntitiesP = nodeP;
+    else if ((batchMaxDelayP == NULL) && (strcmp(nodeP->name, "batchMaxDelay") == 0))
+      batchMaxDelayP = nodeP;
   }
 
   if (idP == NULL)
@@ -600,30 +606,19 @@ static bool subscriptionMatchCallback
     allAttributesInNotification = true;
 
 
-  //
-  // Is there room in the notificationInfo vector?
-  //
-
-  // FIXME semTake for orionldState.notificationInfo/notificationRecords
-  if ((unsigned int) orionldState.notificationRecords >= K_VEC_SIZE(orionldState.notificationInfo))
-  {
-    LM_W(("SUB: No room in orionldState.notificationInfo - notification dropped"));
-    return false;
-  }
-
-
   //
   // Creating the attribute list that the Notification will be based on
   //
+  OrionldNotificationInfo*  niP = orionldNotificationInfoAdd();
 
-  OrionldNotificationInfo*  niP = &orionldState.notificationInfo[orionldState.notificationRecords];
-
-  orionldState.notificationRecords += 1;  // For next callback - FIXME: will need a semaphore for this
-  // FIXME semGive for orionldState.notificationInfo/notificationRecords
+  if (niP == NULL)
+    return false;
 
   niP->subscriptionId       = idP->value.s;
   niP->reference            = referenceP->value.s;
   niP->attrsForNotification = NULL;  // The notification is based on this list of attributes
+  niP->batchMaxEntities     = ((batchMaxEntitiesP != NULL) && (batchMaxEntitiesP->type == KjInt))? batchMaxEntitiesP->value.i : 0;
+  niP->batchMaxDelay        = ((batchMaxDelayP    != NULL) && (batchMaxDelayP->type    == KjInt))? batchMaxDelayP->value.i    : 0;
 
   if ((mimeTypeP != NULL) && (strcmp(mimeTypeP->value.s, "application/ld+json") == 0))
     niP->mimeType = JSONLD;
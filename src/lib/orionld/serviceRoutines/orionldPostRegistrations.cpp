@@ -27,6 +27,7 @@
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
+#include "common/globals.h"                                    // noCache
 #include "rest/ConnectionInfo.h"                               // ConnectionInfo
 #include "rest/httpHeaderAdd.h"                                // httpHeaderLocationAdd
 #include "rest/OrionError.h"                                   // OrionError
@@ -39,6 +40,7 @@
 #include "orionld/kjTree/kjTreeToRegistration.h"               // kjTreeToRegistration
 #include "orionld/context/orionldCoreContext.h"                // ORIONLD_CORE_CONTEXT_URL
 #include "orionld/mongoBackend/mongoLdRegistrationGet.h"       // mongoLdRegistrationGet
+#include "orionld/db/dbRegCacheTenantRefresh.h"                // dbRegCacheTenantRefresh
 #include "orionld/serviceRoutines/orionldPostRegistrations.h"  // Own Interface
 
 
@@ -101,6 +103,10 @@ bool orionldPostRegistrations(ConnectionInfo* ciP)
   // FIXME: Check oError for failure!
   ciP->httpStatusCode = SccCreated;
 
+  // Forwarding lookups use the registration cache - it must include the new registration
+  if (noCache == false)
+    dbRegCacheTenantRefresh(orionldState.tenant);
+
   httpHeaderLocationAdd(ciP, "/ngsi-ld/v1/csourceRegistrations/", regIdP);
 
   return true;
@@ -0,0 +1,97 @@
+#ifndef SRC_LIB_ORIONLD_TYPES_ORIONLDGEOMETRY_H_
+#define SRC_LIB_ORIONLD_TYPES_ORIONLDGEOMETRY_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <vector>                                              // std::vector
+
+#include "orionld/types/OrionldGeoJsonType.h"                  // OrionldGeoJsonType
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldGeoPoint -
+//
+typedef struct OrionldGeoPoint
+{
+  double lon;
+  double lat;
+} OrionldGeoPoint;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldGeoSegment -
+//
+typedef struct OrionldGeoSegment
+{
+  OrionldGeoPoint p1;
+  OrionldGeoPoint p2;
+} OrionldGeoSegment;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldGeoBox - bounding box
+//
+typedef struct OrionldGeoBox
+{
+  double minLon;
+  double minLat;
+  double maxLon;
+  double maxLat;
+} OrionldGeoBox;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldGeometry - a GeoJSON geometry, in a flat representation
+//
+// All the points of the geometry are kept in one vector, pointV.
+// partV holds the index in pointV where each part (line or polygon ring) starts, and
+// polygonV holds the index in partV where each polygon starts - the first ring of
+// a polygon is its exterior ring, the rest of its rings are holes.
+//
+//   Point:            1 point, 1 part
+//   MultiPoint:       N points, 1 part
+//   LineString:       1 part
+//   MultiLineString:  1 part per line
+//   Polygon:          1 part per ring, 1 polygon
+//   MultiPolygon:     1 part per ring, 1 polygon per polygon
+//
+typedef struct OrionldGeometry
+{
+  OrionldGeoJsonType            type;
+  std::vector<OrionldGeoPoint>  pointV;
+  std::vector<int>              partV;
+  std::vector<int>              polygonV;
+  OrionldGeoBox                 bbox;
+} OrionldGeometry;
+
+#endif  // SRC_LIB_ORIONLD_TYPES_ORIONLDGEOMETRY_H_
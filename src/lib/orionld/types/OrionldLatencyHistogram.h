@@ -0,0 +1,74 @@
+#ifndef SRC_LIB_ORIONLD_TYPES_ORIONLDLATENCYHISTOGRAM_H_
+#define SRC_LIB_ORIONLD_TYPES_ORIONLDLATENCYHISTOGRAM_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/types/OrionldSpan.h"                         // ORIONLD_PHASES
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Latency histogram layout - HDR style, in microseconds
+//
+// Values below 16 have a bucket each. Each power of two above that is split in 16 sub-buckets,
+// so the relative error of a percentile is at most 1/16 (6.25%), from 1 microsecond to 2^32 microseconds
+// (over an hour). Bigger values end up in the last bucket.
+//
+#define LATENCY_SUB_BUCKET_BITS   4
+#define LATENCY_SUB_BUCKETS       (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_MAX_BITS          32
+#define LATENCY_BUCKETS           ((LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldLatencyHistogram -
+//
+// All fields are updated with atomic operations, without lock. A reader sees each counter consistent,
+// but not necessarily the set of counters.
+//
+typedef struct OrionldLatencyHistogram
+{
+  unsigned long long  count;
+  unsigned long long  sum;                       // Microseconds
+  unsigned long long  max;                       // Microseconds
+  unsigned long long  bucketV[LATENCY_BUCKETS];
+} OrionldLatencyHistogram;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldServiceLatency - latency histograms of one service (URL path + verb)
+//
+typedef struct OrionldServiceLatency
+{
+  OrionldLatencyHistogram  total;
+  OrionldLatencyHistogram  phaseV[ORIONLD_PHASES];
+} OrionldServiceLatency;
+
+#endif  // SRC_LIB_ORIONLD_TYPES_ORIONLDLATENCYHISTOGRAM_H_
@@ -0,0 +1,70 @@
+#ifndef SRC_LIB_ORIONLD_TYPES_ORIONLDSPAN_H_
+#define SRC_LIB_ORIONLD_TYPES_ORIONLDSPAN_H_
+
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                            // uint64_t
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldPhase - the phases of an NGSI-LD request, as measured by the span recorder
+//
+// A phase ends when orionldSpanMark() is called for it, and it lasts from the end of the previous phase.
+// Phases that are skipped (e.g. after an error) are simply zero and their time goes to the next phase.
+//
+typedef enum OrionldPhase
+{
+  OrionldPhaseRead = 0,         // orionldMhdConnectionInit + reading of the payload
+  OrionldPhaseLookup,           // Service lookup
+  OrionldPhaseParse,            // kjParse of the payload, extraction of @context, id and type
+  OrionldPhaseChecks,           // Content-Type and Accept
+  OrionldPhaseContext,          // @context of the Link header (possibly downloaded) or of the payload
+  OrionldPhaseService,          // The service routine
+  OrionldPhaseRender,           // kjRender of the response
+  OrionldPhaseReply,            // restReply - the response is handed over to MHD
+  OrionldPhaseSend,             // Until MHD has sent the response
+  OrionldPhaseNotify            // orionldNotify
+} OrionldPhase;
+
+#define ORIONLD_PHASES  10
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldSpan - the timestamps of a request, in nanoseconds of CLOCK_MONOTONIC
+//
+// start == 0 means that no span is being recorded (the request isn't an NGSI-LD request)
+//
+typedef struct OrionldSpan
+{
+  uint64_t  start;
+  uint64_t  mark;                     // End of the last phase
+  uint64_t  phaseV[ORIONLD_PHASES];   // Duration of each phase
+} OrionldSpan;
+
+#endif  // SRC_LIB_ORIONLD_TYPES_ORIONLDSPAN_H_
@@ -58,6 +58,7 @@ static const char* validOptions[] =
   , OPT_NO_OVERWRITE
   , OPT_UPDATE
   , OPT_REPLACE
+  , OPT_ESTIMATED_COUNT
 #endif
 };
 
@@ -572,7 +572,7 @@ std::string restService(ConnectionInfo* ciP, RestService* serviceV)
     std::string spath = (ciP->servicePathV.size() > 0)? ciP->servicePathV[0] : "";
 
     ciP->parseDataP = &parseData;
-    metricsMgr.add(ciP->httpHeaders.tenant, spath, METRIC_TRANS_IN_REQ_SIZE, ciP->payloadSize);
+    metricsMgr.add(ciP->httpHeaders.tenant, spath, MetricTransInReqSize, ciP->payloadSize);
     LM_T(LmtPayload, ("Parsing payload '%s'", ciP->payload));
 
     response = payloadParse(ciP, &parseData, ciP->restServiceP, &jsonReqP, &jsonRelease, ciP->urlCompV);
@@ -22,8 +22,10 @@
 *
 * Author: Ken Zangelin
 */
+#include <ctype.h>
 #include <string>
 #include <vector>
+#include <map>
 
 #include "orionld/common/orionldState.h"                         // orionldState
 
@@ -46,6 +48,7 @@ void httpHeaderAdd(ConnectionInfo* ciP, const char* key, const char* value)
 
 #ifdef ORIONLD
 #include "orionld/context/orionldCoreContext.h" // orionldCoreContext
+#include "rest/uriParamNames.h"                 // URI_PARAM_PAGINATION_OFFSET, URI_PARAM_PAGINATION_CURSOR
 
 // -----------------------------------------------------------------------------
 //
@@ -122,4 +125,60 @@ void httpHeaderLinkAdd(ConnectionInfo* ciP, const char* _url)
 
   orionldState.linkHeaderAdded = true;
 }
+
+
+
+// -----------------------------------------------------------------------------
+//
+// uriParamEncode - percent-encode all but the unreserved characters of RFC 3986
+//
+static void uriParamEncode(std::string* outP, const char* s)
+{
+  static const char hex[] = "0123456789ABCDEF";
+
+  for (const unsigned char* cP = (const unsigned char*) s; *cP != 0; ++cP)
+  {
+    if (isalnum(*cP) || (*cP == '-') || (*cP == '.') || (*cP == '_') || (*cP == '~'))
+      *outP += (char) *cP;
+    else
+    {
+      *outP += '%';
+      *outP += hex[*cP >> 4];
+      *outP += hex[*cP & 0x0F];
+    }
+  }
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// httpHeaderLinkNextAdd - add a Link header for the next page of a listing
+//
+//   Link: </ngsi-ld/v1/entities?type=T&limit=20&cursor=CURSOR>; rel="next"
+//
+// All URI params of the current request are kept, except 'offset' (the cursor replaces it) and the old 'cursor'.
+//
+void httpHeaderLinkNextAdd(ConnectionInfo* ciP, const char* cursor)
+{
+  std::string link = "<" + ciP->url + "?";
+
+  for (std::map<std::string, std::string>::iterator it = ciP->uriParam.begin(); it != ciP->uriParam.end(); ++it)
+  {
+    if ((it->second.empty()) || (it->first == URI_PARAM_PAGINATION_OFFSET) || (it->first == URI_PARAM_PAGINATION_CURSOR))
+      continue;
+
+    uriParamEncode(&link, it->first.c_str());
+    link += '=';
+    uriParamEncode(&link, it->second.c_str());
+    link += '&';
+  }
+
+  link += URI_PARAM_PAGINATION_CURSOR "=";
+  link += cursor;
+  link += ">; rel=\"next\"";
+
+  ciP->httpHeader.push_back(HTTP_LINK);
+  ciP->httpHeaderValue.push_back(link);
+}
 #endif
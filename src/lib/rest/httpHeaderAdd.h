@@ -69,5 +69,13 @@ struct OrionldContext;
 //
 extern void httpHeaderLinkAdd(ConnectionInfo* ciP, const char* _url);
 
+
+
+// ----------------------------------------------------------------------------
+//
+// httpHeaderLinkNextAdd -
+//
+extern void httpHeaderLinkNextAdd(ConnectionInfo* ciP, const char* cursor);
+
 #endif  // ORIONLD
 #endif  // SRC_LIB_REST_HTTPHEADERADD_H_
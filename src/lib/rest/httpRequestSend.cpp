@@ -274,7 +274,7 @@ int httpRequestSendWithCurl
 
   firstServicePath(servicePath.c_str(), servicePath0, sizeof(servicePath0));
 
-  metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT, 1);
+  metricsMgr.add(tenant, servicePath0, MetricTransOut, 1);
 
   ++callNo;
 
@@ -295,7 +295,7 @@ int httpRequestSendWithCurl
   // Preconditions check
   if (port == 0)
   {
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_ERRORS, 1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutErrors, 1);
     LM_E(("Runtime Error (port is ZERO)"));
     lmTransactionEnd();
 
@@ -305,7 +305,7 @@ int httpRequestSendWithCurl
 
   if (ip.empty())
   {
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_ERRORS, 1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutErrors, 1);
     LM_E(("Runtime Error (ip is empty)"));
     lmTransactionEnd();
 
@@ -315,7 +315,7 @@ int httpRequestSendWithCurl
 
   if (verb.empty())
   {
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_ERRORS, 1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutErrors, 1);
     LM_E(("Runtime Error (verb is empty)"));
     lmTransactionEnd();
 
@@ -325,7 +325,7 @@ int httpRequestSendWithCurl
 
   if (resource.empty())
   {
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_ERRORS, 1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutErrors, 1);
     LM_E(("Runtime Error (resource is empty)"));
     lmTransactionEnd();
 
@@ -335,7 +335,7 @@ int httpRequestSendWithCurl
 
   if ((content_type.empty()) && (!content.empty()))
   {
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_ERRORS, 1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutErrors, 1);
     LM_E(("Runtime Error (Content-Type is empty but there is actual content)"));
     lmTransactionEnd();
 
@@ -345,7 +345,7 @@ int httpRequestSendWithCurl
 
   if ((!content_type.empty()) && (content.empty()))
   {
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_ERRORS, 1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutErrors, 1);
     LM_E(("Runtime Error (Content-Type non-empty but there is no content)"));
     lmTransactionEnd();
 
@@ -521,7 +521,7 @@ int httpRequestSendWithCurl
   // Check if total outgoing message size is too big
   if (outgoingMsgSize > MAX_DYN_MSG_SIZE)
   {
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_ERRORS, 1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutErrors, 1);
     LM_E(("Runtime Error (HTTP request to send is too large: %d bytes)", outgoingMsgSize));
 
     curl_slist_free_all(headers);
@@ -603,7 +603,7 @@ int httpRequestSendWithCurl
     alarmMgr.notificationError(url, "(curl_easy_perform failed: " + std::string(curl_easy_strerror(res)) + ")");
     *outP = "notification failure";
 
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_ERRORS, 1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutErrors, 1);
   }
   else
   {
@@ -615,12 +615,12 @@ int httpRequestSendWithCurl
     LM_I(("Notification Successfully Sent to %s", url.c_str()));
     outP->assign(httpResponse->memory, httpResponse->size);
 
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_RESP_SIZE, payloadLen);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutRespSize, payloadLen);
   }
 
   if (payloadSize > 0)
   {
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_REQ_SIZE, payloadSize);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutReqSize, payloadSize);
   }
 
   // Cleanup curl environment
@@ -687,8 +687,8 @@ int httpRequestSend
 
     firstServicePath(servicePath.c_str(), servicePath0, sizeof(servicePath0));
 
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT,        1);
-    metricsMgr.add(tenant, servicePath0, METRIC_TRANS_OUT_ERRORS, 1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOut,       1);
+    metricsMgr.add(tenant, servicePath0, MetricTransOutErrors, 1);
 
     release_curl_context(&cc);
     LM_E(("Runtime Error (could not init libcurl)"));
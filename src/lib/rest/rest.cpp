@@ -63,6 +63,9 @@ extern "C"
 #include "orionld/rest/orionldMhdConnectionTreat.h"
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
 #include "orionld/serviceRoutines/orionldNotify.h"               // orionldNotify
+#include "orionld/common/orionldSpanMark.h"                      // orionldSpanMark
+#include "orionld/common/orionldSpanEnd.h"                       // orionldSpanEnd
+#include "orionld/context/orionldContextCacheUsersRelease.h"     // orionldContextCacheUsersRelease
 #endif
 
 #include "rest/Verb.h"
@@ -115,6 +118,19 @@ unsigned short restPortGet(void)
 
 
 
+/* ****************************************************************************
+*
+* restThreadPoolSizeGet -
+*
+* Zero means that MHD runs in 'thread per connection' mode.
+*/
+unsigned int restThreadPoolSizeGet(void)
+{
+  return threadPoolSize;
+}
+
+
+
 /* ****************************************************************************
 *
 * correlatorGenerate -
@@ -684,8 +700,15 @@ static void requestCompleted
   std::string      spath    = (ciP->servicePathV.size() > 0)? ciP->servicePathV[0] : "";
   struct timespec  reqEndTime;
 
+  orionldSpanMark(OrionldPhaseSend);
+
   if (orionldState.notify == true)
+  {
     orionldNotify();
+    orionldSpanMark(OrionldPhaseNotify);
+  }
+
+  orionldSpanEnd();
 
   if ((ciP->payload != NULL) && (ciP->payload != static_buffer))
   {
@@ -739,14 +762,14 @@ static void requestCompleted
   //
   // Metrics
   //
-  metricsMgr.add(ciP->httpHeaders.tenant, spath, METRIC_TRANS_IN, 1);
+  metricsMgr.add(ciP->httpHeaders.tenant, spath, MetricTransIn, 1);
 
   //
   // If the httpStatusCode is above the set of 200s, an error has occurred
   //
   if (ciP->httpStatusCode >= SccBadRequest)
   {
-    metricsMgr.add(ciP->httpHeaders.tenant, spath, METRIC_TRANS_IN_ERRORS, 1);
+    metricsMgr.add(ciP->httpHeaders.tenant, spath, MetricTransInErrors, 1);
   }
 
   if (metricsMgr.isOn() && (ciP->transactionStart.tv_sec != 0))
@@ -759,7 +782,7 @@ static void requestCompleted
         (end.tv_sec  - ciP->transactionStart.tv_sec) * 1000000 +
         (end.tv_usec - ciP->transactionStart.tv_usec);
 
-      metricsMgr.add(ciP->httpHeaders.tenant, spath, _METRIC_TOTAL_SERVICE_TIME, elapsed);
+      metricsMgr.add(ciP->httpHeaders.tenant, spath, MetricTotalServiceTime, elapsed);
     }
   }
 
@@ -774,6 +797,7 @@ static void requestCompleted
   delete(ciP);
 
 #ifdef ORIONLD
+  orionldContextCacheUsersRelease();  // The response has been sent - the contexts of the request are no longer used
   kaBufferReset(&orionldState.kalloc, false);  // 'false': it's reused, but in a different thread ...
 
   if ((orionldState.responseTree != NULL) && (orionldState.kjsonP == NULL))
@@ -1189,6 +1213,7 @@ static ApiVersion apiVersionGet(const char* path)
 * acceptHeadersAcceptable -
 *
 * URI paths ending with '/value' accept both text/plain and application/json.
+* So does '/admin/metrics/prometheus' (Prometheus asks for text/plain).
 * All other requests accept only application/json.
 *
 * This function just checks that the media types flagged as accepted by the client
@@ -1211,6 +1236,10 @@ static bool acceptHeadersAcceptable(ConnectionInfo* ciP, bool* textAcceptedP)
   {
     *textAcceptedP = true;
   }
+  else if (ciP->url == "/admin/metrics/prometheus")
+  {
+    *textAcceptedP = true;
+  }
 
 
   //
@@ -93,6 +93,14 @@ extern unsigned short restPortGet(void);
 
 
 
+/* ****************************************************************************
+*
+* restThreadPoolSizeGet -
+*/
+extern unsigned int restThreadPoolSizeGet(void);
+
+
+
 /* ****************************************************************************
 *
 * restInit -
@@ -71,54 +71,18 @@ static int replyIx = 0;
 
 /* ****************************************************************************
 *
-* restReply -
+* restReplyHeadersAdd -
+*
+* Adds the HTTP headers of the response: the headers in ciP->httpHeader, Content-Type (if there is payload) and CORS.
 */
-void restReply(ConnectionInfo* ciP, const std::string& answer)
+static void restReplyHeadersAdd(ConnectionInfo* ciP, MHD_Response* response, bool payload)
 {
-  MHD_Response*  response;
-
-  uint64_t       answerLen = answer.length();
-  std::string    spath     = (ciP->servicePathV.size() > 0)? ciP->servicePathV[0] : "";
-
-  ++replyIx;
-  LM_T(LmtServiceOutPayload, ("Response %d: responding with %d bytes, Status Code %d", replyIx, answerLen, ciP->httpStatusCode));
-  LM_T(LmtServiceOutPayload, ("Response payload: '%s'", answer.c_str()));
-
-  response = MHD_create_response_from_buffer(answerLen, (void*) answer.c_str(), MHD_RESPMEM_MUST_COPY);
-  if (!response)
-  {
-    if (ciP->apiVersion != NGSI_LD_V1)
-    {
-      metricsMgr.add(ciP->httpHeaders.tenant, spath, METRIC_TRANS_IN_ERRORS, 1);
-    }
-    
-    LM_E(("Runtime Error (MHD_create_response_from_buffer FAILED)"));
-
-#ifdef ORIONLD
-    if (orionldState.responsePayloadAllocated == true)
-    {
-      free(orionldState.responsePayload);
-      orionldState.responsePayload = NULL;
-    }
-#endif    
-
-    return;
-  }
-
-  if (answerLen > 0)
-  {
-    if (ciP->apiVersion != NGSI_LD_V1)
-    {
-      metricsMgr.add(ciP->httpHeaders.tenant, spath, METRIC_TRANS_IN_RESP_SIZE, answerLen);
-    }
-  }
-
   for (unsigned int hIx = 0; hIx < ciP->httpHeader.size(); ++hIx)
   {
     MHD_add_response_header(response, ciP->httpHeader[hIx].c_str(), ciP->httpHeaderValue[hIx].c_str());
   }
 
-  if (answer != "")
+  if (payload == true)
   {
     //
     // For error-responses, never respond with application/ld+json
@@ -184,6 +148,66 @@ void restReply(ConnectionInfo* ciP, const std::string& answer)
       }
     }
   }
+}
+
+
+
+/* ****************************************************************************
+*
+* restReply -
+*/
+void restReply(ConnectionInfo* ciP, const std::string& answer)
+{
+  restReply(ciP, answer.c_str(), answer.length());
+}
+
+
+
+/* ****************************************************************************
+*
+* restReply -
+*
+* The payload 'answer' is copied by MHD, so the caller keeps the ownership of the buffer.
+*/
+void restReply(ConnectionInfo* ciP, const char* answer, uint64_t answerLen)
+{
+  MHD_Response*  response;
+  std::string    spath     = (ciP->servicePathV.size() > 0)? ciP->servicePathV[0] : "";
+
+  ++replyIx;
+  LM_T(LmtServiceOutPayload, ("Response %d: responding with %d bytes, Status Code %d", replyIx, answerLen, ciP->httpStatusCode));
+  LM_T(LmtServiceOutPayload, ("Response payload: '%s'", answer));
+
+  response = MHD_create_response_from_buffer(answerLen, (void*) answer, MHD_RESPMEM_MUST_COPY);
+  if (!response)
+  {
+    if (ciP->apiVersion != NGSI_LD_V1)
+    {
+      metricsMgr.add(ciP->httpHeaders.tenant, spath, MetricTransInErrors, 1);
+    }
+    
+    LM_E(("Runtime Error (MHD_create_response_from_buffer FAILED)"));
+
+#ifdef ORIONLD
+    if (orionldState.responsePayloadAllocated == true)
+    {
+      free(orionldState.responsePayload);
+      orionldState.responsePayload = NULL;
+    }
+#endif    
+
+    return;
+  }
+
+  if (answerLen > 0)
+  {
+    if (ciP->apiVersion != NGSI_LD_V1)
+    {
+      metricsMgr.add(ciP->httpHeaders.tenant, spath, MetricTransInRespSize, answerLen);
+    }
+  }
+
+  restReplyHeadersAdd(ciP, response, answerLen > 0);
 
   MHD_queue_response(ciP->connection, ciP->httpStatusCode, response);
   MHD_destroy_response(response);
@@ -199,6 +223,41 @@ void restReply(ConnectionInfo* ciP, const std::string& answer)
 
 
 
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* restReplyFromCallback -
+*
+* The payload is produced piece by piece by 'readerCallback', as MHD needs it, and the size of the payload is unknown
+* beforehand (MHD uses chunked transfer encoding).
+* 'freeCallback' is called by MHD when the response has been sent (or the connection is closed) and it receives
+* 'cls' as parameter, just like 'readerCallback'.
+*/
+bool restReplyFromCallback(ConnectionInfo* ciP, MHD_ContentReaderCallback readerCallback, MHD_ContentReaderFreeCallback freeCallback, void* cls)
+{
+  MHD_Response* response;
+
+  ++replyIx;
+  LM_T(LmtServiceOutPayload, ("Response %d: responding with streamed payload, Status Code %d", replyIx, ciP->httpStatusCode));
+
+  response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, 32 * 1024, readerCallback, cls, freeCallback);
+  if (!response)
+  {
+    LM_E(("Runtime Error (MHD_create_response_from_callback FAILED)"));
+    return false;
+  }
+
+  restReplyHeadersAdd(ciP, response, true);
+
+  MHD_queue_response(ciP->connection, ciP->httpStatusCode, response);
+  MHD_destroy_response(response);
+
+  return true;
+}
+#endif
+
+
+
 /* ****************************************************************************
 *
 * restErrorReplyGet -
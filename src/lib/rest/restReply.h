@@ -29,6 +29,7 @@
 
 #include "rest/ConnectionInfo.h"
 #include "rest/HttpStatusCode.h"
+#include "rest/mhd.h"
 
 
 
@@ -37,6 +38,23 @@
 * restReply - 
 */
 extern void restReply(ConnectionInfo* ciP, const std::string& answer);
+extern void restReply(ConnectionInfo* ciP, const char* answer, uint64_t answerLen);
+
+
+
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* restReplyFromCallback - 
+*/
+extern bool restReplyFromCallback
+(
+  ConnectionInfo*                ciP,
+  MHD_ContentReaderCallback      readerCallback,
+  MHD_ContentReaderFreeCallback  freeCallback,
+  void*                          cls
+);
+#endif
 
 
 
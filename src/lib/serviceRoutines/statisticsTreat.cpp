@@ -41,6 +41,8 @@
 #include "mongoBackend/mongoConnectionPool.h"
 #include "cache/subCache.h"
 #include "ngsiNotify/QueueStatistics.h"
+#include "ngsiNotify/QueueNotifier.h"
+#include "mongoBackend/MongoGlobal.h"
 #include "common/JsonHelper.h"
 
 
@@ -280,6 +282,40 @@ std::string renderNotifQueueStats(void)
   jh.addNumber ("avgTimeInQueue", out==0 ? 0.0f : (timeInQ/out));
   jh.addNumber("size",           (long long)QueueStatistics::getQSize());
 
+  //
+  // Per endpoint (shard of the queue) - only if any notification has been queued
+  //
+  QueueNotifier* queueNotifierP = dynamic_cast<QueueNotifier*>(getNotifier());
+
+  if (queueNotifierP != NULL)
+  {
+    std::map<std::string, SyncQShardCounters> counters;
+
+    queueNotifierP->endpointCounters(&counters);
+
+    if (counters.size() > 0)
+    {
+      JsonHelper endpoints;
+
+      for (std::map<std::string, SyncQShardCounters>::iterator it = counters.begin(); it != counters.end(); ++it)
+      {
+        JsonHelper endpoint;
+
+        endpoint.addNumber("queued",         (long long) it->second.queued);
+        endpoint.addNumber("active",         (long long) it->second.active);
+        endpoint.addNumber("reject",         (long long) it->second.reject);
+        endpoint.addNumber("sentOk",         (long long) it->second.sentOk);
+        endpoint.addNumber("sentError",      (long long) it->second.sentError);
+        endpoint.addNumber("shortCircuited", (long long) it->second.shortCircuited);
+        endpoint.addString("circuit",        it->second.circuit);
+
+        endpoints.addRaw(it->first, endpoint.str());
+      }
+
+      jh.addRaw("endpoints", endpoints.str());
+    }
+  }
+
   return jh.str();
 }
 
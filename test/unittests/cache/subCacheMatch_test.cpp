@@ -0,0 +1,230 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "logMsg/logMsg.h"
+
+#include "cache/subCache.h"
+
+
+
+/* ****************************************************************************
+*
+* subAdd - create a subscription and insert it in the subscription cache
+*
+* If 'id' is NULL, 'idPattern' is used. If 'type' is NULL, the type is the pattern ".*"
+*/
+static CachedSubscription* subAdd
+(
+  const char*  subscriptionId,
+  const char*  servicePath,
+  const char*  id,
+  const char*  idPattern,
+  const char*  type,
+  const char*  attr
+)
+{
+  CachedSubscription* cSubP = new CachedSubscription();
+
+  cSubP->tenant          = NULL;
+  cSubP->servicePath     = strdup(servicePath);
+  cSubP->subscriptionId  = strdup(subscriptionId);
+  cSubP->next            = NULL;
+
+  if (id != NULL)
+  {
+    cSubP->entityIdInfos.push_back(new EntityInfo(id, (type == NULL)? "" : type, "false", false));
+  }
+  else
+  {
+    cSubP->entityIdInfos.push_back(new EntityInfo(idPattern, (type == NULL)? ".*" : type, "true", type == NULL));
+  }
+
+  if (attr != NULL)
+  {
+    cSubP->notifyConditionV.push_back(attr);
+  }
+
+  subCacheItemInsert(cSubP);
+
+  return cSubP;
+}
+
+
+
+/* ****************************************************************************
+*
+* matchIds - the ids of the matching subscriptions, as a comma-separated list
+*/
+static std::string matchIds
+(
+  const char*  servicePath,
+  const char*  entityId,
+  const char*  entityType,
+  const char*  attr
+)
+{
+  std::vector<CachedSubscription*>  subV;
+  std::string                       ids;
+
+  subCacheMatch("", servicePath, entityId, entityType, attr, &subV);
+
+  for (unsigned int ix = 0; ix < subV.size(); ++ix)
+  {
+    if (ix != 0)
+    {
+      ids += ",";
+    }
+
+    ids += subV[ix]->subscriptionId;
+  }
+
+  return ids;
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheMatch.index -
+*/
+TEST(subCacheMatch, index)
+{
+  subCacheInit();
+
+  CachedSubscription* sub1P = subAdd("S1", "/",    "E1", NULL,   "T",  "A");
+  subAdd("S2", "/",    NULL, "E.*",  "T",  NULL);
+  subAdd("S3", "/a/#", NULL, ".*",   NULL, "B");
+  subAdd("S4", "/a/b", "E1", NULL,   "T",  "A");
+
+  EXPECT_EQ("S1,S2",    matchIds("/",    "E1", "T",  "A"));
+  EXPECT_EQ("S1,S2",    matchIds("",     "E1", "T",  "A"));
+  EXPECT_EQ("S1,S2",    matchIds("/",    "E1", "",   "A"));
+  EXPECT_EQ("S2",       matchIds("/",    "E2", "T",  "C"));
+  EXPECT_EQ("",         matchIds("/",    "E2", "T2", "C"));
+  EXPECT_EQ("S4",       matchIds("/a/b", "E1", "T",  "A"));
+  EXPECT_EQ("S3",       matchIds("/a/b", "E2", "T",  "B"));
+  EXPECT_EQ("S3",       matchIds("/a",   "X",  "T2", "B"));
+  EXPECT_EQ("",         matchIds("/ab",  "X",  "T",  "B"));
+  EXPECT_EQ("S1,S2,S4", matchIds("/#",   "E1", "T",  "A"));
+
+  subCacheItemRemove(sub1P);
+  EXPECT_EQ("S2",       matchIds("/",    "E1", "T",  "A"));
+
+  subCacheDestroy();
+  EXPECT_EQ("",         matchIds("/",    "E1", "T",  "A"));
+}
+
+
+
+/* ****************************************************************************
+*
+* benchmark - time subCacheMatch with 'subs' subscriptions in the cache
+*
+* 90% of the subscriptions are on an entity id, 5% on an entity type and 5% on
+* an id pattern and a type pattern. Every 10th subscription has a wildcard service path.
+*/
+static void benchmark(int subs)
+{
+  const int  matches = 1000;
+  char       subId[32];
+  char       id[32];
+  char       type[32];
+  char       attr[32];
+
+  subCacheInit();
+
+  for (int ix = 0; ix < subs; ++ix)
+  {
+    const char* spath = ((ix % 10) == 0)? "/a/#" : "/a";
+
+    snprintf(subId, sizeof(subId), "S%d", ix);
+    snprintf(id,    sizeof(id),    "urn:E%d", ix);
+    snprintf(type,  sizeof(type),  "T%d", ix % 100);
+    snprintf(attr,  sizeof(attr),  "A%d", ix % 10);
+
+    if ((ix % 20) == 1)
+    {
+      subAdd(subId, spath, NULL, ".*", type, attr);
+    }
+    else if ((ix % 20) == 2)
+    {
+      subAdd(subId, spath, NULL, "urn:X.*", NULL, attr);
+    }
+    else
+    {
+      subAdd(subId, spath, id, NULL, type, attr);
+    }
+  }
+
+  struct timespec  start;
+  struct timespec  end;
+  int              hits = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int ix = 0; ix < matches; ++ix)
+  {
+    std::vector<CachedSubscription*>  subV;
+    int                               eIx = (ix * 7919) % subs;
+
+    snprintf(id,   sizeof(id),   "urn:E%d", eIx);
+    snprintf(type, sizeof(type), "T%d", eIx % 100);
+    snprintf(attr, sizeof(attr), "A%d", eIx % 10);
+
+    subCacheMatch("", "/a", id, type, attr, &subV);
+    hits += subV.size();
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double usecs = (end.tv_sec - start.tv_sec) * 1000000.0 + (end.tv_nsec - start.tv_nsec) / 1000.0;
+
+  printf("subCacheMatch benchmark: %6d subscriptions: %8.2f microseconds per match (%d hits)\n", subs, usecs / matches, hits);
+
+  // Each entity matches at least its own subscription
+  EXPECT_TRUE(hits >= matches);
+
+  subCacheDestroy();
+}
+
+
+
+/* ****************************************************************************
+*
+* subCacheMatch.benchmark -
+*/
+TEST(subCacheMatch, benchmark)
+{
+  benchmark(1000);
+  benchmark(10000);
+  benchmark(100000);
+}
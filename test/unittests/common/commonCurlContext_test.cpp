@@ -0,0 +1,93 @@
+/*
+*
+* Copyright 2020 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "gtest/gtest.h"
+
+#include "common/globals.h"
+#include "common/sem.h"
+
+
+
+/* ****************************************************************************
+*
+* msSince -
+*/
+static int msSince(struct timespec* startP)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (now.tv_sec - startP->tv_sec) * 1000 + (now.tv_nsec - startP->tv_nsec) / 1000000;
+}
+
+
+
+/* ****************************************************************************
+*
+* tryAtLimit - get_curl_context_try doesn't block when the host is at its limit (curlMaxPerHost)
+*/
+TEST(commonCurlContext, tryAtLimit)
+{
+  struct curl_context  cc1;
+  struct curl_context  cc2;
+  struct timespec      start;
+  char                 savedMode[64];
+  int                  savedMax = curlMaxPerHost;
+
+  strncpy(savedMode, notificationMode, sizeof(savedMode));
+  strncpy(notificationMode, "persistent", 64);
+  curlMaxPerHost = 1;
+
+  EXPECT_EQ(0, get_curl_context_try("host1", &cc1, 0));
+  EXPECT_TRUE(cc1.curl != NULL);
+
+  // At the limit - not waiting at all
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  EXPECT_EQ(EBUSY, get_curl_context_try("host1", &cc2, 0));
+  EXPECT_TRUE(cc2.curl == NULL);
+  EXPECT_LT(msSince(&start), 50);
+
+  // At the limit - waiting at most 100 milliseconds
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  EXPECT_EQ(EBUSY, get_curl_context_try("host1", &cc2, 100));
+  EXPECT_GE(msSince(&start), 90);
+
+  // Other hosts are not affected
+  EXPECT_EQ(0, get_curl_context_try("host2", &cc2, 0));
+  release_curl_context(&cc2);
+
+  // Once released, the context of host1 is available again
+  release_curl_context(&cc1);
+  EXPECT_EQ(0, get_curl_context_try("host1", &cc2, 0));
+  EXPECT_TRUE(cc2.curl != NULL);
+  release_curl_context(&cc2);
+
+  curlMaxPerHost = savedMax;
+  strncpy(notificationMode, savedMode, 64);
+}
@@ -0,0 +1,246 @@
+/*
+*
+* Copyright 2020 Telefonica Investigacion y Desarrollo, S.A.U
+*
+* This file is part of Orion Context Broker.
+*
+* Orion Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* iot_support at tid dot es
+*
+* Author: Orion dev team
+*/
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "common/SyncQSharded.h"
+
+
+
+/* ****************************************************************************
+*
+* roundRobin - shards are served in turn, whatever the order of the pushes
+*/
+TEST(commonSyncQSharded, roundRobin)
+{
+  SyncQSharded<int>  q(100, 0, 0, 0);
+  std::string        key;
+  bool               circuitOpen;
+
+  for (int ix = 0; ix < 3; ix++)
+  {
+    EXPECT_TRUE(q.try_push("A", ix));
+  }
+  EXPECT_TRUE(q.try_push("B", 10));
+  EXPECT_TRUE(q.try_push("B", 11));
+
+  EXPECT_EQ(0,  q.pop(&key, &circuitOpen));
+  EXPECT_EQ("A", key);
+  EXPECT_EQ(10, q.pop(&key, &circuitOpen));
+  EXPECT_EQ("B", key);
+  EXPECT_EQ(1,  q.pop(&key, &circuitOpen));
+  EXPECT_EQ(11, q.pop(&key, &circuitOpen));
+  EXPECT_EQ(2,  q.pop(&key, &circuitOpen));
+  EXPECT_FALSE(circuitOpen);
+  EXPECT_EQ(0, q.size());
+}
+
+
+
+/* ****************************************************************************
+*
+* overflow - rejections are accounted to the shard
+*/
+TEST(commonSyncQSharded, overflow)
+{
+  SyncQSharded<int>                          q(2, 0, 0, 0);
+  std::map<std::string, SyncQShardCounters>  counters;
+
+  EXPECT_TRUE(q.try_push("A", 1));
+  EXPECT_TRUE(q.try_push("A", 2));
+  EXPECT_FALSE(q.try_push("B", 3));
+
+  q.counters(&counters);
+  EXPECT_EQ(2, counters["A"].queued);
+  EXPECT_EQ(0, counters["A"].reject);
+  EXPECT_EQ(0, counters["B"].queued);
+  EXPECT_EQ(1, counters["B"].reject);
+}
+
+
+
+/* ****************************************************************************
+*
+* concurrencyCap - a shard with 'maxActive' elements being processed is skipped
+*/
+TEST(commonSyncQSharded, concurrencyCap)
+{
+  SyncQSharded<int>  q(100, 1, 0, 0);
+  std::string        key;
+  bool               circuitOpen;
+
+  EXPECT_TRUE(q.try_push("A", 1));
+  EXPECT_TRUE(q.try_push("A", 2));
+  EXPECT_TRUE(q.try_push("B", 3));
+  EXPECT_TRUE(q.try_push("B", 4));
+
+  EXPECT_EQ(1, q.pop(&key, &circuitOpen));
+  EXPECT_EQ(3, q.pop(&key, &circuitOpen));
+
+  // Both shards at their cap - "A" is released first
+  q.done("A", 1, 0);
+  EXPECT_EQ(2, q.pop(&key, &circuitOpen));
+  EXPECT_EQ("A", key);
+}
+
+
+
+/* ****************************************************************************
+*
+* circuitBreaker - after 'failureThreshold' failures, elements are popped flagged as circuitOpen
+*/
+TEST(commonSyncQSharded, circuitBreaker)
+{
+  SyncQSharded<int>                          q(100, 0, 2, 3600);
+  std::map<std::string, SyncQShardCounters>  counters;
+  std::string                                key;
+  bool                                       circuitOpen;
+
+  for (int ix = 0; ix < 4; ix++)
+  {
+    EXPECT_TRUE(q.try_push("A", ix));
+  }
+
+  q.pop(&key, &circuitOpen);
+  EXPECT_FALSE(circuitOpen);
+  EXPECT_FALSE(q.done("A", 0, 1));
+
+  q.pop(&key, &circuitOpen);
+  EXPECT_FALSE(circuitOpen);
+  EXPECT_TRUE(q.done("A", 0, 1));
+
+  q.pop(&key, &circuitOpen);
+  EXPECT_TRUE(circuitOpen);
+  q.pop(&key, &circuitOpen);
+  EXPECT_TRUE(circuitOpen);
+
+  q.counters(&counters);
+  EXPECT_EQ(2, counters["A"].sentError);
+  EXPECT_EQ(2, counters["A"].shortCircuited);
+  EXPECT_STREQ("open", counters["A"].circuit);
+}
+
+
+
+/* ****************************************************************************
+*
+* halfOpen - once the open period is over, one single element is let through, and its result closes the circuit
+*/
+TEST(commonSyncQSharded, halfOpen)
+{
+  SyncQSharded<int>                          q(100, 0, 1, 0);
+  std::map<std::string, SyncQShardCounters>  counters;
+  std::string                                key;
+  bool                                       circuitOpen;
+
+  EXPECT_TRUE(q.try_push("A", 1));
+  q.pop(&key, &circuitOpen);
+  EXPECT_TRUE(q.done("A", 0, 1));
+
+  EXPECT_TRUE(q.try_push("A", 2));
+  EXPECT_TRUE(q.try_push("A", 3));
+  EXPECT_TRUE(q.try_push("B", 4));
+
+  q.pop(&key, &circuitOpen);          // Open period (0 seconds) is over - half-open
+  EXPECT_FALSE(circuitOpen);
+  EXPECT_EQ("A", key);
+
+  EXPECT_EQ(4, q.pop(&key, &circuitOpen));  // "A" is skipped while its probe is ongoing
+  q.done("B", 1, 0);
+
+  q.counters(&counters);
+  EXPECT_STREQ("halfOpen", counters["A"].circuit);
+
+  q.done("A", 1, 0);
+  counters.clear();
+  q.counters(&counters);
+  EXPECT_STREQ("closed", counters["A"].circuit);
+  EXPECT_EQ(3, q.pop(&key, &circuitOpen));
+  EXPECT_FALSE(circuitOpen);
+}
+
+
+
+/* ****************************************************************************
+*
+* consecutiveFailures - a success resets the failure count of the circuit breaker
+*/
+TEST(commonSyncQSharded, consecutiveFailures)
+{
+  SyncQSharded<int>  q(100, 0, 2, 3600);
+  std::string        key;
+  bool               circuitOpen;
+
+  for (int ix = 0; ix < 3; ix++)
+  {
+    EXPECT_TRUE(q.try_push("A", ix));
+  }
+
+  q.pop(&key, &circuitOpen);
+  EXPECT_FALSE(q.done("A", 0, 1));
+
+  q.pop(&key, &circuitOpen);
+  EXPECT_FALSE(q.done("A", 1, 1));    // A success in between - only one consecutive failure
+
+  q.pop(&key, &circuitOpen);
+  EXPECT_FALSE(circuitOpen);
+  EXPECT_TRUE(q.done("A", 0, 1));
+}
+
+
+
+/* ****************************************************************************
+*
+* prune - shards with nothing queued nor being processed are removed once idle
+*/
+TEST(commonSyncQSharded, prune)
+{
+  SyncQSharded<int>                          q(100, 0, 0, 0, 0);
+  std::map<std::string, SyncQShardCounters>  counters;
+  std::string                                key;
+  bool                                       circuitOpen;
+
+  EXPECT_TRUE(q.try_push("A", 1));
+  EXPECT_TRUE(q.try_push("B", 2));
+  EXPECT_TRUE(q.try_push("B", 3));
+
+  EXPECT_EQ(1, q.pop(&key, &circuitOpen));
+  EXPECT_EQ(2, q.pop(&key, &circuitOpen));
+  q.done("A", 1, 0);
+
+  // "A" is idle, "B" has one element queued and one being processed
+  q.counters(&counters);
+  EXPECT_EQ(1, counters.size());
+  EXPECT_EQ(1, counters.count("B"));
+
+  q.done("B", 1, 0);
+  EXPECT_EQ(3, q.pop(&key, &circuitOpen));
+  q.done("B", 1, 0);
+
+  counters.clear();
+  q.counters(&counters);
+  EXPECT_EQ(0, counters.size());
+}
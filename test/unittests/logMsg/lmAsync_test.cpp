@@ -0,0 +1,237 @@
+/*
+*
+* Copyright 2020 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "logMsg/logMsg.h"
+
+
+
+/* ****************************************************************************
+*
+* Lines written by the writer thread of the asynchronous log, to a file descriptor with
+* an alternative write function (lmWriteFunction) that keeps the lines in 'lines'.
+*
+* The write function is only called by the writer thread, and 'lines' is only inspected after lmAsyncFlush.
+* If 'gateClosed' is set, the write function waits for the 'gate' semaphore, to keep the writer thread busy.
+*/
+static std::vector<std::string>  lines;
+static bool                      gateClosed = false;
+static sem_t                     gate;
+
+
+
+/* ****************************************************************************
+*
+* linesWrite -
+*/
+static void linesWrite(char* line)
+{
+  if (__atomic_load_n(&gateClosed, __ATOMIC_SEQ_CST) == true)
+  {
+    sem_wait(&gate);
+  }
+
+  lines.push_back(line);
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncLogStart - start the asynchronous log, and register a file descriptor that keeps the lines in 'lines'
+*
+* The ring of the asynchronous log can't be resized once started, so all tests share the same ring, of 1024 slots.
+*/
+static int asyncLogStart(void)
+{
+  int fd    = open("/dev/null", O_WRONLY);
+  int index = -1;
+
+  EXPECT_EQ(LmsOk, lmAsyncStart(1024));
+  EXPECT_EQ(LmsOk, lmFdRegister(fd, "TEXT", "DEF", "lmAsync_test", &index));
+  EXPECT_EQ(LmsOk, lmWriteFunction(index, linesWrite));
+
+  lines.clear();
+
+  return fd;
+}
+
+
+
+/* ****************************************************************************
+*
+* asyncLogStop -
+*/
+static void asyncLogStop(int fd)
+{
+  lmAsyncFlush();
+  lmFdUnregister(fd);
+  close(fd);
+}
+
+
+
+/* ****************************************************************************
+*
+* logThread - log 100 lines, all of them prefixed with the number of the thread
+*/
+static void* logThread(void* vP)
+{
+  int  threadNo = *((int*) vP);
+  char text[64];
+
+  for (int ix = 0; ix < 100; ix++)
+  {
+    snprintf(text, sizeof(text), "t%d-%d", threadNo, ix);
+    lmOut(text, 'M', __FILE__, __LINE__, __FUNCTION__, 0, NULL, false);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsync.flush - after lmAsyncFlush, all lines logged so far have been written
+*/
+TEST(lmAsync, flush)
+{
+  int fd = asyncLogStart();
+
+  lmOut((char*) "line 1", 'M', __FILE__, __LINE__, __FUNCTION__, 0, NULL, false);
+  lmOut((char*) "line 2", 'M', __FILE__, __LINE__, __FUNCTION__, 0, NULL, false);
+  lmAsyncFlush();
+
+  ASSERT_EQ(2, lines.size());
+  EXPECT_EQ("line 1\n", lines[0]);
+  EXPECT_EQ("line 2\n", lines[1]);
+
+  // The writer thread is asleep now - a new line must wake it up
+  usleep(10000);
+  lmOut((char*) "line 3", 'M', __FILE__, __LINE__, __FUNCTION__, 0, NULL, false);
+  lmAsyncFlush();
+
+  ASSERT_EQ(3, lines.size());
+  EXPECT_EQ("line 3\n", lines[2]);
+
+  asyncLogStop(fd);
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsync.orderPerThread - lines logged concurrently keep their order, per thread
+*/
+TEST(lmAsync, orderPerThread)
+{
+  int        fd = asyncLogStart();
+  pthread_t  tid[4];
+  int        threadNo[4];
+  int        next[4] = { 0, 0, 0, 0 };
+
+  for (int ix = 0; ix < 4; ix++)
+  {
+    threadNo[ix] = ix;
+    pthread_create(&tid[ix], NULL, logThread, &threadNo[ix]);
+  }
+
+  for (int ix = 0; ix < 4; ix++)
+  {
+    pthread_join(tid[ix], NULL);
+  }
+
+  lmAsyncFlush();
+
+  ASSERT_EQ(400, lines.size());
+
+  for (unsigned int ix = 0; ix < lines.size(); ix++)
+  {
+    int t;
+    int n;
+
+    ASSERT_EQ(2, sscanf(lines[ix].c_str(), "t%d-%d", &t, &n));
+    ASSERT_TRUE((t >= 0) && (t < 4));
+    EXPECT_EQ(next[t], n);
+    next[t] = n + 1;
+  }
+
+  asyncLogStop(fd);
+}
+
+
+
+/* ****************************************************************************
+*
+* lmAsync.ringFull - lines are dropped, not waited for, when the ring is full
+*
+* The writer thread is kept busy writing the first line, while 3000 lines are logged.
+* The ring has 1024 slots and the writer thread holds at most one batch of them, so lines must be dropped.
+* Lines are dropped per file descriptor, so the count of dropped lines is not compared with the lines written.
+*/
+TEST(lmAsync, ringFull)
+{
+  int                 fd      = asyncLogStart();
+  unsigned long long  dropped = lmAsyncDroppedGet();
+
+  sem_init(&gate, 0, 0);
+  __atomic_store_n(&gateClosed, true, __ATOMIC_SEQ_CST);
+
+  for (int ix = 0; ix < 3000; ix++)
+  {
+    lmOut((char*) "full", 'M', __FILE__, __LINE__, __FUNCTION__, 0, NULL, false);
+  }
+
+  EXPECT_GT(lmAsyncDroppedGet(), dropped);
+
+  __atomic_store_n(&gateClosed, false, __ATOMIC_SEQ_CST);
+  sem_post(&gate);
+  lmAsyncFlush();
+
+  EXPECT_LT(lines.size(), 3000);
+
+  // Once the writer thread has caught up, lines are no longer dropped
+  lines.clear();
+  dropped = lmAsyncDroppedGet();
+  lmOut((char*) "not full", 'M', __FILE__, __LINE__, __FUNCTION__, 0, NULL, false);
+  lmAsyncFlush();
+
+  ASSERT_EQ(1, lines.size());
+  EXPECT_EQ("not full\n", lines[0]);
+  EXPECT_EQ(dropped, lmAsyncDroppedGet());
+
+  asyncLogStop(fd);
+  sem_destroy(&gate);
+}
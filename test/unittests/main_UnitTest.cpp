@@ -87,6 +87,7 @@ char          gtest_filter[1024];
 char          gtest_output[1024];
 int           contextDownloadAttempts = 5;
 int           contextDownloadTimeout  = 10000;
+int           slowRequestThreshold    = 0;
 
 
 
@@ -0,0 +1,226 @@
+/*
+*
+* Copyright 2020 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"
+#include "kalloc/kaStrdup.h"
+#include "kalloc/kaBufferReset.h"
+#include "khash/khash.h"
+}
+
+#include "gtest/gtest.h"
+
+#include "orionld/common/orionldState.h"
+#include "orionld/context/OrionldContext.h"
+#include "orionld/context/OrionldContextItem.h"
+#include "orionld/context/orionldCoreContext.h"
+#include "orionld/context/orionldContextCache.h"
+#include "orionld/context/orionldContextCreate.h"
+#include "orionld/context/orionldContextFree.h"
+#include "orionld/context/orionldContextTermHash.h"
+#include "orionld/context/orionldContextTermTablesCreate.h"
+#include "orionld/context/orionldContextItemExpand.h"
+#include "orionld/context/orionldContextMemoLookup.h"
+#include "orionld/context/orionldContextMemoInsert.h"
+
+
+
+/* ****************************************************************************
+*
+* nameCompare -
+*/
+static int nameCompare(const char* name, void* itemP)
+{
+  return strcmp(name, ((OrionldContextItem*) itemP)->name);
+}
+
+
+
+/* ****************************************************************************
+*
+* valueCompare -
+*/
+static int valueCompare(const char* longName, void* itemP)
+{
+  return strcmp(longName, ((OrionldContextItem*) itemP)->id);
+}
+
+
+
+/* ****************************************************************************
+*
+* keyValuesContext - create a key-values context with one term, and its term tables
+*/
+static OrionldContext* keyValuesContext(const char* url, const char* name, const char* id)
+{
+  OrionldContext*     contextP = orionldContextCreate(url, NULL, NULL, true, false);
+  OrionldContextItem* itemP;
+
+  contextP->context.hash.nameHashTable  = khashTableCreate(&contextP->kalloc, orionldContextTermHash, nameCompare,  64);
+  contextP->context.hash.valueHashTable = khashTableCreate(&contextP->kalloc, orionldContextTermHash, valueCompare, 64);
+
+  itemP       = (OrionldContextItem*) kaAlloc(&contextP->kalloc, sizeof(OrionldContextItem));
+  itemP->name = kaStrdup(&contextP->kalloc, name);
+  itemP->id   = kaStrdup(&contextP->kalloc, id);
+  itemP->type = NULL;
+
+  khashItemAdd(contextP->context.hash.nameHashTable,  itemP->name, itemP);
+  khashItemAdd(contextP->context.hash.valueHashTable, itemP->id,   itemP);
+
+  orionldContextTermTablesCreate(contextP);
+
+  return contextP;
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldContextMemo.insertAndLookup -
+*/
+TEST(orionldContextMemo, insertAndLookup)
+{
+  OrionldContext*          contextP = orionldContextCreate("http://a.b.c/ctx1.jsonld", NULL, NULL, true, false);
+  OrionldContextMemoItem*  itemP;
+
+  EXPECT_TRUE(orionldContextMemoLookup(contextP, "ex:speed") == NULL);
+
+  orionldContextMemoInsert(contextP, "ex:speed", "http://a.b.c/ex/speed");
+  orionldContextMemoInsert(contextP, "ex:color", "http://a.b.c/ex/color");
+  EXPECT_EQ(2, contextP->memo.items);
+
+  itemP = orionldContextMemoLookup(contextP, "ex:speed");
+  ASSERT_TRUE(itemP != NULL);
+  EXPECT_STREQ("http://a.b.c/ex/speed", itemP->longName);
+
+  itemP = orionldContextMemoLookup(contextP, "ex:color");
+  ASSERT_TRUE(itemP != NULL);
+  EXPECT_STREQ("http://a.b.c/ex/color", itemP->longName);
+
+  EXPECT_TRUE(orionldContextMemoLookup(contextP, "ex:size") == NULL);
+
+  // A name already memoized is not inserted again, and its expansion is not changed
+  orionldContextMemoInsert(contextP, "ex:speed", "http://x.y.z/speed");
+  EXPECT_EQ(2, contextP->memo.items);
+  EXPECT_STREQ("http://a.b.c/ex/speed", orionldContextMemoLookup(contextP, "ex:speed")->longName);
+
+  orionldContextFree(contextP);
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldContextMemo.perContext - the memo of one context is not seen by another context
+*/
+TEST(orionldContextMemo, perContext)
+{
+  OrionldContext* ctx1P = orionldContextCreate("http://a.b.c/ctx1.jsonld", NULL, NULL, true, false);
+  OrionldContext* ctx2P = orionldContextCreate("http://a.b.c/ctx2.jsonld", NULL, NULL, true, false);
+
+  orionldContextMemoInsert(ctx1P, "ex:speed", "http://a.b.c/ex/speed");
+
+  EXPECT_TRUE(orionldContextMemoLookup(ctx1P, "ex:speed") != NULL);
+  EXPECT_TRUE(orionldContextMemoLookup(ctx2P, "ex:speed") == NULL);
+
+  orionldContextFree(ctx2P);
+  orionldContextFree(ctx1P);
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldContextMemo.maxItems - once full, nothing more is memoized
+*/
+TEST(orionldContextMemo, maxItems)
+{
+  OrionldContext* contextP = orionldContextCreate("http://a.b.c/ctx1.jsonld", NULL, NULL, true, false);
+  char            shortName[32];
+
+  for (int ix = 0; ix < ORIONLD_CONTEXT_MEMO_MAX_ITEMS + 10; ++ix)
+  {
+    snprintf(shortName, sizeof(shortName), "ex:a%d", ix);
+    orionldContextMemoInsert(contextP, shortName, "http://a.b.c/ex/a");
+  }
+
+  EXPECT_EQ(ORIONLD_CONTEXT_MEMO_MAX_ITEMS, contextP->memo.items);
+
+  snprintf(shortName, sizeof(shortName), "ex:a%d", ORIONLD_CONTEXT_MEMO_MAX_ITEMS - 1);
+  EXPECT_TRUE(orionldContextMemoLookup(contextP, shortName) != NULL);
+
+  snprintf(shortName, sizeof(shortName), "ex:a%d", ORIONLD_CONTEXT_MEMO_MAX_ITEMS);
+  EXPECT_TRUE(orionldContextMemoLookup(contextP, shortName) == NULL);
+
+  orionldContextFree(contextP);
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldContextMemo.itemExpand -
+*
+* orionldContextItemExpand memoizes the expansion of a prefixed name the first time, and from then on
+* takes it from the memo. The caller gets a copy that it may modify, not the memoized string.
+* URNs and URLs are not memoized.
+*/
+TEST(orionldContextMemo, itemExpand)
+{
+  OrionldContext*     savedCoreP = orionldCoreContextP;
+  OrionldContext*     coreP      = keyValuesContext("http://a.b.c/core.jsonld", "location", "https://uri.etsi.org/ngsi-ld/location");
+  OrionldContext*     contextP;
+  static char         curie[]    = "ex:speed";
+  static char         urn[]      = "urn:ngsi-ld:T:E1";
+  char*               longName;
+  unsigned long long  hits;
+
+  orionldStateInit();
+  orionldCoreContextP = coreP;
+  contextP            = keyValuesContext("http://a.b.c/ctx1.jsonld", "ex", "http://a.b.c/ex/");
+
+  longName = orionldContextItemExpand(contextP, curie, NULL, true, NULL);
+  EXPECT_STREQ("http://a.b.c/ex/speed", longName);
+  EXPECT_EQ(1, contextP->memo.items);
+
+  hits     = orionldContextMemoStats.hits;
+  longName = orionldContextItemExpand(contextP, curie, NULL, true, NULL);
+  EXPECT_STREQ("http://a.b.c/ex/speed", longName);
+  EXPECT_EQ(hits + 1, orionldContextMemoStats.hits);
+
+  longName[0] = 'X';
+  EXPECT_STREQ("http://a.b.c/ex/speed", orionldContextMemoLookup(contextP, curie)->longName);
+
+  EXPECT_EQ(urn, orionldContextItemExpand(contextP, urn, NULL, true, NULL));
+  EXPECT_EQ(1, contextP->memo.items);
+
+  orionldContextFree(contextP);
+  orionldContextFree(coreP);
+  orionldCoreContextP = savedCoreP;
+  kaBufferReset(&orionldState.kalloc, false);
+}
@@ -0,0 +1,228 @@
+/*
+*
+* Copyright 2020 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"
+#include "kalloc/kaStrdup.h"
+#include "khash/khash.h"
+}
+
+#include "gtest/gtest.h"
+
+#include "orionld/context/OrionldContext.h"
+#include "orionld/context/OrionldContextItem.h"
+#include "orionld/context/orionldCoreContext.h"
+#include "orionld/context/orionldContextCreate.h"
+#include "orionld/context/orionldContextFree.h"
+#include "orionld/context/orionldContextTermHash.h"
+#include "orionld/context/orionldContextTermTablesCreate.h"
+
+
+
+/* ****************************************************************************
+*
+* nameCompare -
+*/
+static int nameCompare(const char* name, void* itemP)
+{
+  return strcmp(name, ((OrionldContextItem*) itemP)->name);
+}
+
+
+
+/* ****************************************************************************
+*
+* valueCompare -
+*/
+static int valueCompare(const char* longName, void* itemP)
+{
+  return strcmp(longName, ((OrionldContextItem*) itemP)->id);
+}
+
+
+
+/* ****************************************************************************
+*
+* keyValuesContext - create a key-values context with its own hash tables, but no term tables
+*/
+static OrionldContext* keyValuesContext(const char* url)
+{
+  OrionldContext* contextP = orionldContextCreate(url, NULL, NULL, true, false);
+
+  contextP->context.hash.nameHashTable  = khashTableCreate(&contextP->kalloc, orionldContextTermHash, nameCompare,  64);
+  contextP->context.hash.valueHashTable = khashTableCreate(&contextP->kalloc, orionldContextTermHash, valueCompare, 64);
+
+  return contextP;
+}
+
+
+
+/* ****************************************************************************
+*
+* termAdd - add a term to the hash tables of a key-values context
+*/
+static OrionldContextItem* termAdd(OrionldContext* contextP, const char* name, const char* id)
+{
+  OrionldContextItem* itemP = (OrionldContextItem*) kaAlloc(&contextP->kalloc, sizeof(OrionldContextItem));
+
+  itemP->name = kaStrdup(&contextP->kalloc, name);
+  itemP->id   = kaStrdup(&contextP->kalloc, id);
+  itemP->type = NULL;
+
+  khashItemAdd(contextP->context.hash.nameHashTable,  itemP->name, itemP);
+  khashItemAdd(contextP->context.hash.valueHashTable, itemP->id,   itemP);
+
+  return itemP;
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldContextTermHash.fnv1a - 32-bit FNV-1a, and no collision for names made of the same characters
+*/
+TEST(orionldContextTermHash, fnv1a)
+{
+  EXPECT_EQ(2166136261U, orionldContextTermHash(""));
+  EXPECT_EQ(0xe40c292cU, orionldContextTermHash("a"));
+  EXPECT_EQ(orionldContextTermHash("speed"), orionldContextTermHash("speed"));
+  EXPECT_NE(orionldContextTermHash("name"), orionldContextTermHash("mean"));
+  EXPECT_NE(orionldContextTermHash("ab"),   orionldContextTermHash("ba"));
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldContextTermTablesCreate.keyValuesWithoutCore - the own hash tables are used as term tables
+*/
+TEST(orionldContextTermTablesCreate, keyValuesWithoutCore)
+{
+  OrionldContext* savedCoreP = orionldCoreContextP;
+  OrionldContext* contextP   = keyValuesContext("http://a.b.c/ctx1.jsonld");
+
+  orionldCoreContextP = NULL;
+  termAdd(contextP, "speed", "http://a.b.c/speed");
+  orionldContextTermTablesCreate(contextP);
+
+  EXPECT_FALSE(contextP->termsWithCore);
+  EXPECT_EQ(contextP->context.hash.nameHashTable,  contextP->terms.nameHashTable);
+  EXPECT_EQ(contextP->context.hash.valueHashTable, contextP->terms.valueHashTable);
+
+  orionldContextFree(contextP);
+  orionldCoreContextP = savedCoreP;
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldContextTermTablesCreate.coreTermsCannotBeOverridden -
+*
+* The term tables of a key-values context have the terms of the Core Context as well, and
+* a term of the Core Context wins over a term with the same name in the context.
+*/
+TEST(orionldContextTermTablesCreate, coreTermsCannotBeOverridden)
+{
+  OrionldContext*     savedCoreP = orionldCoreContextP;
+  OrionldContext*     coreP      = keyValuesContext("http://a.b.c/core.jsonld");
+  OrionldContext*     contextP   = keyValuesContext("http://a.b.c/ctx1.jsonld");
+  OrionldContextItem* coreLocP;
+  OrionldContextItem* colorP;
+
+  coreLocP = termAdd(coreP, "location", "https://uri.etsi.org/ngsi-ld/location");
+  orionldCoreContextP = coreP;
+  orionldContextTermTablesCreate(coreP);
+  EXPECT_FALSE(coreP->termsWithCore);
+
+  termAdd(contextP, "location", "http://a.b.c/location");
+  colorP = termAdd(contextP, "color", "http://a.b.c/color");
+  orionldContextTermTablesCreate(contextP);
+
+  EXPECT_TRUE(contextP->termsWithCore);
+  EXPECT_NE(contextP->context.hash.nameHashTable, contextP->terms.nameHashTable);
+  EXPECT_EQ(coreLocP, khashItemLookup(contextP->terms.nameHashTable,  "location"));
+  EXPECT_EQ(colorP,   khashItemLookup(contextP->terms.nameHashTable,  "color"));
+  EXPECT_EQ(colorP,   khashItemLookup(contextP->terms.valueHashTable, "http://a.b.c/color"));
+  EXPECT_EQ(coreLocP, khashItemLookup(contextP->terms.valueHashTable, "https://uri.etsi.org/ngsi-ld/location"));
+  EXPECT_TRUE(khashItemLookup(contextP->terms.nameHashTable, "speed") == NULL);
+
+  orionldContextFree(contextP);
+  orionldContextFree(coreP);
+  orionldCoreContextP = savedCoreP;
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldContextTermTablesCreate.arrayMembers -
+*
+* The term tables of an array context have the terms of all members.
+* The vector of an array context is sorted backwards, so the first item of the vector (the last
+* member of the array in the @context) wins over the others.
+*/
+TEST(orionldContextTermTablesCreate, arrayMembers)
+{
+  OrionldContext*     savedCoreP = orionldCoreContextP;
+  OrionldContext*     ctx1P      = keyValuesContext("http://a.b.c/ctx1.jsonld");
+  OrionldContext*     ctx2P      = keyValuesContext("http://a.b.c/ctx2.jsonld");
+  OrionldContext*     arrayP     = orionldContextCreate("http://a.b.c/array.jsonld", NULL, NULL, false, false);
+  OrionldContextItem* speed1P;
+  OrionldContextItem* speed2P;
+  OrionldContextItem* colorP;
+  OrionldContextItem* sizeP;
+
+  orionldCoreContextP = NULL;
+
+  speed1P = termAdd(ctx1P, "speed", "http://a.b.c/ctx1/speed");
+  colorP  = termAdd(ctx1P, "color", "http://a.b.c/ctx1/color");
+  speed2P = termAdd(ctx2P, "speed", "http://a.b.c/ctx2/speed");
+  sizeP   = termAdd(ctx2P, "size",  "http://a.b.c/ctx2/size");
+  orionldContextTermTablesCreate(ctx1P);
+  orionldContextTermTablesCreate(ctx2P);
+
+  arrayP->context.array.items     = 2;
+  arrayP->context.array.vector    = (OrionldContext**) kaAlloc(&arrayP->kalloc, 2 * sizeof(OrionldContext*));
+  arrayP->context.array.vector[0] = ctx2P;
+  arrayP->context.array.vector[1] = ctx1P;
+  orionldContextTermTablesCreate(arrayP);
+
+  EXPECT_FALSE(arrayP->termsWithCore);
+  EXPECT_EQ(speed2P, khashItemLookup(arrayP->terms.nameHashTable, "speed"));
+  EXPECT_EQ(colorP,  khashItemLookup(arrayP->terms.nameHashTable, "color"));
+  EXPECT_EQ(sizeP,   khashItemLookup(arrayP->terms.nameHashTable, "size"));
+
+  // Both long names of 'speed' are compacted
+  EXPECT_EQ(speed1P, khashItemLookup(arrayP->terms.valueHashTable, "http://a.b.c/ctx1/speed"));
+  EXPECT_EQ(speed2P, khashItemLookup(arrayP->terms.valueHashTable, "http://a.b.c/ctx2/speed"));
+
+  orionldContextFree(arrayP);
+  orionldContextFree(ctx2P);
+  orionldContextFree(ctx1P);
+  orionldCoreContextP = savedCoreP;
+}
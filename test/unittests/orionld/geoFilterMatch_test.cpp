@@ -0,0 +1,104 @@
+/*
+*
+* Copyright 2020 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "orionld/types/OrionldGeoFilter.h"
+#include "orionld/geo/geoFilterParse.h"
+#include "orionld/geo/geoFilterMatch.h"
+
+
+
+/* ****************************************************************************
+*
+* nearMatch - does the point 'lat,lon' match the geo-filter 'near;maxDistance:N' around the point 'refLat,refLon'?
+*
+* The point of the entity is parsed just like the reference point of the filter.
+*/
+static bool nearMatch(const char* ref, double maxDistance, const char* point)
+{
+  OrionldGeoFilter  filter;
+  OrionldGeoFilter  entity;
+  char*             detail = NULL;
+  std::string       georel = "near;maxDistance:" + std::to_string((long long) maxDistance);
+
+  EXPECT_TRUE(geoFilterParse("point", ref,   georel,               &filter, &detail));
+  EXPECT_TRUE(geoFilterParse("point", point, "near;maxDistance:1", &entity, &detail));
+
+  return geoFilterMatch(&filter, &entity.geometry);
+}
+
+
+
+/* ****************************************************************************
+*
+* geoFilterMatch.near -
+*/
+TEST(geoFilterMatch, near)
+{
+  EXPECT_TRUE(nearMatch("40.0,-3.0",  1000, "40.005,-3.0"));   // ~556 meters
+  EXPECT_FALSE(nearMatch("40.0,-3.0", 1000, "40.01,-3.0"));    // ~1112 meters
+}
+
+
+
+/* ****************************************************************************
+*
+* geoFilterMatch.nearAcrossAntimeridian - points on both sides of +/-180 degrees of longitude
+*/
+TEST(geoFilterMatch, nearAcrossAntimeridian)
+{
+  EXPECT_TRUE(nearMatch("0,179.9",   30000, "0,-179.9"));   // ~22 km
+  EXPECT_FALSE(nearMatch("0,179.9",  30000, "0,-179.5"));   // ~67 km
+  EXPECT_TRUE(nearMatch("0,-179.95", 15000, "0,179.95"));   // ~11 km
+  EXPECT_FALSE(nearMatch("0,-179.95", 5000, "0,179.95"));
+}
+
+
+
+/* ****************************************************************************
+*
+* geoFilterMatch.nearHighLatitude - the circle is widest north of its center
+*
+* At latitude 60, a circle of 2000 km reaches longitude 38.1, beyond the 35.9 degrees of 2000 km along the parallel.
+*/
+TEST(geoFilterMatch, nearHighLatitude)
+{
+  EXPECT_TRUE(nearMatch("60,0",  2000000, "65.6,37.5"));   // ~1971 km
+  EXPECT_FALSE(nearMatch("60,0", 2000000, "60,40"));
+}
+
+
+
+/* ****************************************************************************
+*
+* geoFilterMatch.nearPole - a circle that contains a pole spans all longitudes
+*/
+TEST(geoFilterMatch, nearPole)
+{
+  EXPECT_TRUE(nearMatch("89.9,0",  50000, "89.9,180"));   // ~22 km, over the pole
+  EXPECT_FALSE(nearMatch("89.9,0", 50000, "89.0,180"));
+}
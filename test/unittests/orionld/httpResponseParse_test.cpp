@@ -0,0 +1,152 @@
+/*
+*
+* Copyright 2020 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include "orionld/common/OrionldHttpResponseParser.h"
+#include "orionld/common/orionldHttpResponseParse.h"
+
+
+
+/* ****************************************************************************
+*
+* parseInPieces - feed 'response' to a new parser, 'pieceLen' bytes at a time
+*
+* Returns the first non-zero result of orionldHttpResponseParse, or 0 if all the data was consumed
+* without the response being complete.
+*/
+static int parseInPieces(OrionldHttpResponseParser* parserP, const char* response, int pieceLen)
+{
+  int len = strlen(response);
+
+  bzero(parserP, sizeof(OrionldHttpResponseParser));
+
+  for (int ix = 0; ix < len; ix += pieceLen)
+  {
+    int n = (len - ix < pieceLen)? len - ix : pieceLen;
+    int r = orionldHttpResponseParse(parserP, &response[ix], n);
+
+    if (r != 0)
+      return r;
+  }
+
+  return 0;
+}
+
+
+
+/* ****************************************************************************
+*
+* contentLength -
+*/
+TEST(orionldHttpResponseParse, contentLength)
+{
+  OrionldHttpResponseParser  parser;
+  const char*                response = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+
+  EXPECT_EQ(200, parseInPieces(&parser, response, 1000));
+  EXPECT_TRUE(parser.keepAlive);
+
+  EXPECT_EQ(200, parseInPieces(&parser, response, 1));
+  EXPECT_TRUE(parser.keepAlive);
+}
+
+
+
+/* ****************************************************************************
+*
+* incomplete - the response isn't complete until the entire body has arrived
+*/
+TEST(orionldHttpResponseParse, incomplete)
+{
+  OrionldHttpResponseParser  parser;
+
+  EXPECT_EQ(0, parseInPieces(&parser, "HTTP/1.1 204 No Content\r\nContent-Length: 0\r\n", 3));
+  EXPECT_EQ(204, orionldHttpResponseParse(&parser, "\r\n", 2));
+
+  EXPECT_EQ(0, parseInPieces(&parser, "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nhello", 7));
+  EXPECT_EQ(-1, orionldHttpResponseParse(&parser, "", 0));
+}
+
+
+
+/* ****************************************************************************
+*
+* chunked -
+*/
+TEST(orionldHttpResponseParse, chunked)
+{
+  OrionldHttpResponseParser  parser;
+  const char*                response = "HTTP/1.1 201 Created\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n";
+
+  EXPECT_EQ(201, parseInPieces(&parser, response, 1000));
+  EXPECT_TRUE(parser.keepAlive);
+
+  EXPECT_EQ(201, parseInPieces(&parser, response, 1));
+  EXPECT_TRUE(parser.keepAlive);
+}
+
+
+
+/* ****************************************************************************
+*
+* untilClose - no Content-Length, not chunked: the body ends as the connection is closed
+*/
+TEST(orionldHttpResponseParse, untilClose)
+{
+  OrionldHttpResponseParser  parser;
+
+  EXPECT_EQ(0, parseInPieces(&parser, "HTTP/1.0 500 Internal Server Error\r\n\r\nbody", 4));
+  EXPECT_EQ(500, orionldHttpResponseParse(&parser, "", 0));
+  EXPECT_FALSE(parser.keepAlive);
+}
+
+
+
+/* ****************************************************************************
+*
+* connectionClose -
+*/
+TEST(orionldHttpResponseParse, connectionClose)
+{
+  OrionldHttpResponseParser  parser;
+
+  EXPECT_EQ(200, parseInPieces(&parser, "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 0\r\n\r\n", 5));
+  EXPECT_FALSE(parser.keepAlive);
+}
+
+
+
+/* ****************************************************************************
+*
+* notHttp -
+*/
+TEST(orionldHttpResponseParse, notHttp)
+{
+  OrionldHttpResponseParser  parser;
+
+  EXPECT_EQ(-1, parseInPieces(&parser, "SSH-2.0-OpenSSH_8.2\r\n\r\n", 1000));
+}
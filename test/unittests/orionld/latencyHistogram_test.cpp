@@ -0,0 +1,192 @@
+/*
+*
+* Copyright 2020 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include "orionld/types/OrionldLatencyHistogram.h"
+#include "orionld/common/orionldLatencyRecord.h"
+#include "orionld/common/orionldLatencyPercentile.h"
+
+
+
+/* ****************************************************************************
+*
+* bucketOf - the bucket where a value is recorded
+*/
+static int bucketOf(unsigned long long us)
+{
+  static OrionldLatencyHistogram h;
+
+  memset(&h, 0, sizeof(h));
+  orionldLatencyRecord(&h, us);
+
+  for (int ix = 0; ix < LATENCY_BUCKETS; ix++)
+  {
+    if (h.bucketV[ix] != 0)
+    {
+      return ix;
+    }
+  }
+
+  return -1;
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldLatencyRecord.bucketIndex -
+*
+* Values below 16 microseconds have a bucket each, every power of two above that is split in 16 buckets.
+*/
+TEST(orionldLatencyRecord, bucketIndex)
+{
+  for (unsigned long long us = 0; us < LATENCY_SUB_BUCKETS; us++)
+  {
+    EXPECT_EQ((int) us, bucketOf(us));
+  }
+
+  EXPECT_EQ(16, bucketOf(16));
+  EXPECT_EQ(31, bucketOf(31));
+  EXPECT_EQ(32, bucketOf(32));
+  EXPECT_EQ(32, bucketOf(33));
+  EXPECT_EQ(33, bucketOf(34));
+  EXPECT_EQ(47, bucketOf(63));
+  EXPECT_EQ(48, bucketOf(64));
+  EXPECT_EQ(57, bucketOf(100));
+  EXPECT_EQ(57, bucketOf(103));
+  EXPECT_EQ(58, bucketOf(104));
+
+  EXPECT_EQ(LATENCY_BUCKETS - 1, bucketOf((1ULL << LATENCY_MAX_BITS) - 1));
+  EXPECT_EQ(LATENCY_BUCKETS - 1, bucketOf(1ULL << LATENCY_MAX_BITS));
+  EXPECT_EQ(LATENCY_BUCKETS - 1, bucketOf(0xFFFFFFFFFFFFFFFFULL));
+
+  // Buckets never go backwards
+  int prev = 0;
+  for (unsigned long long us = 1; us < 100000; us++)
+  {
+    int ix = bucketOf(us);
+
+    ASSERT_GE(ix, prev);
+    ASSERT_LE(ix, prev + 1);
+    prev = ix;
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldLatencyRecord.counters -
+*/
+TEST(orionldLatencyRecord, counters)
+{
+  OrionldLatencyHistogram h;
+
+  memset(&h, 0, sizeof(h));
+  orionldLatencyRecord(&h, 10);
+  orionldLatencyRecord(&h, 2000);
+  orionldLatencyRecord(&h, 300);
+
+  EXPECT_EQ(3,    h.count);
+  EXPECT_EQ(2310, h.sum);
+  EXPECT_EQ(2000, h.max);
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldLatencyPercentile.empty -
+*/
+TEST(orionldLatencyPercentile, empty)
+{
+  OrionldLatencyHistogram h;
+
+  memset(&h, 0, sizeof(h));
+
+  EXPECT_EQ(0, orionldLatencyPercentile(&h, 50));
+  EXPECT_EQ(0, orionldLatencyPercentile(&h, 99));
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldLatencyPercentile.highestOfBucket -
+*
+* A percentile is the highest value of its bucket, but never more than the max recorded value.
+*/
+TEST(orionldLatencyPercentile, highestOfBucket)
+{
+  OrionldLatencyHistogram h;
+
+  memset(&h, 0, sizeof(h));
+  orionldLatencyRecord(&h, 100);
+  orionldLatencyRecord(&h, 5000);
+
+  EXPECT_EQ(103,  orionldLatencyPercentile(&h, 50));
+  EXPECT_EQ(5000, orionldLatencyPercentile(&h, 51));
+  EXPECT_EQ(5000, orionldLatencyPercentile(&h, 100));
+
+  memset(&h, 0, sizeof(h));
+  orionldLatencyRecord(&h, 100);
+
+  EXPECT_EQ(100, orionldLatencyPercentile(&h, 50));
+}
+
+
+
+/* ****************************************************************************
+*
+* orionldLatencyPercentile.relativeError - 1 to 100000 microseconds, uniformly
+*
+* The percentiles are never below the exact value, and never more than 1/16 above it.
+*/
+TEST(orionldLatencyPercentile, relativeError)
+{
+  static OrionldLatencyHistogram  h;
+  double                          percentileV[] = { 1, 10, 50, 90, 99, 99.9, 100 };
+
+  memset(&h, 0, sizeof(h));
+
+  for (unsigned long long us = 1; us <= 100000; us++)
+  {
+    orionldLatencyRecord(&h, us);
+  }
+
+  for (unsigned int ix = 0; ix < sizeof(percentileV) / sizeof(percentileV[0]); ix++)
+  {
+    unsigned long long exact = (unsigned long long) (100000 * percentileV[ix] / 100);
+    unsigned long long value = orionldLatencyPercentile(&h, percentileV[ix]);
+
+    EXPECT_GE(value, exact);
+    EXPECT_LE(value, exact + exact / LATENCY_SUB_BUCKETS);
+  }
+
+  EXPECT_EQ(1,      orionldLatencyPercentile(&h, 0));
+  EXPECT_EQ(100000, orionldLatencyPercentile(&h, 100));
+}
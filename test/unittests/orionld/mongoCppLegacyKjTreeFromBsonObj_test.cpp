@@ -0,0 +1,182 @@
+/*
+*
+* Copyright 2019 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+#include <string>
+
+#include "mongo/client/dbclient.h"
+
+extern "C"
+{
+#include "kalloc/kaStrdup.h"
+#include "kalloc/kaBufferReset.h"
+#include "kjson/KjNode.h"
+#include "kjson/kjParse.h"
+#include "kjson/kjRender.h"
+}
+
+#include "gtest/gtest.h"
+
+#include "logMsg/logMsg.h"
+
+#include "orionld/common/orionldState.h"
+#include "orionld/mongoCppLegacy/mongoCppLegacyKjTreeFromBsonObj.h"
+
+
+
+/* ****************************************************************************
+*
+* entityCreate - an entity as stored in the database, with 'attrs' attributes
+*/
+static mongo::BSONObj entityCreate(int attrs)
+{
+  mongo::BSONObjBuilder   entity;
+  mongo::BSONObjBuilder   attrsObj;
+  mongo::BSONArrayBuilder attrNames;
+
+  entity.append("_id", BSON("id" << "urn:ngsi-ld:Vehicle:V123" << "type" << "https://uri.etsi.org/ngsi-ld/default-context/Vehicle" << "servicePath" << "/"));
+
+  for (int ix = 0; ix < attrs; ix++)
+  {
+    char                   attrName[128];
+    mongo::BSONObjBuilder  attr;
+
+    snprintf(attrName, sizeof(attrName), "https://uri=etsi=org/ngsi-ld/default-context/attr%d", ix);
+    attrNames.append(attrName);
+
+    attr.append("type", "Property");
+    attr.append("creDate", 1573040000.5);
+    attr.append("modDate", 1573040000.5 + ix);
+
+    if (ix % 3 == 0)
+      attr.append("value", "a string value");
+    else if (ix % 3 == 1)
+      attr.append("value", ix + 0.25);
+    else
+      attr.append("value", BSON("lat" << 40.5 << "long" << -3.75 << "tags" << BSON_ARRAY("a" << "b" << true)));
+
+    attr.append("mdNames", BSON_ARRAY("https://uri.etsi.org/ngsi-ld/observedAt"));
+    attr.append("md", BSON("https://uri=etsi=org/ngsi-ld/observedAt" << BSON("value" << 1573040000)));
+
+    attrsObj.append(attrName, attr.obj());
+  }
+
+  entity.append("attrNames", attrNames.arr());
+  entity.append("attrs", attrsObj.obj());
+  entity.append("creDate", 1573040000.0);
+  entity.append("modDate", 1573040000.0);
+  entity.append("expiration", (long long) 1573040000123LL);
+  entity.append("lastCorrelator", "");
+
+  return entity.obj();
+}
+
+
+
+/* ****************************************************************************
+*
+* kjTreeViaJson - the old way: render the BSONObj as JSON and parse it
+*/
+static KjNode* kjTreeViaJson(const mongo::BSONObj& bsonObj)
+{
+  std::string  jsonString = bsonObj.jsonString();
+  char*        buf        = kaStrdup(&orionldState.kalloc, (char*) jsonString.c_str());
+
+  return kjParse(orionldState.kjsonP, buf);
+}
+
+
+
+/* ****************************************************************************
+*
+* mongoCppLegacyKjTreeFromBsonObj.sameAsJson -
+*/
+TEST(mongoCppLegacyKjTreeFromBsonObj, sameAsJson)
+{
+  mongo::BSONObj  entity = entityCreate(50);
+  char*           title;
+  char*           detail;
+  static char     viaJson[128 * 1024];
+  static char     direct[128 * 1024];
+
+  orionldStateInit();
+
+  KjNode* viaJsonP = kjTreeViaJson(entity);
+  KjNode* directP  = mongoCppLegacyKjTreeFromBsonObj(&entity, &title, &detail);
+
+  ASSERT_TRUE(viaJsonP != NULL);
+  ASSERT_TRUE(directP != NULL);
+
+  kjRender(orionldState.kjsonP, viaJsonP, viaJson, sizeof(viaJson));
+  kjRender(orionldState.kjsonP, directP,  direct,  sizeof(direct));
+
+  EXPECT_STREQ(viaJson, direct);
+
+  kaBufferReset(&orionldState.kalloc, false);
+}
+
+
+
+/* ****************************************************************************
+*
+* mongoCppLegacyKjTreeFromBsonObj.benchmark -
+*/
+TEST(mongoCppLegacyKjTreeFromBsonObj, benchmark)
+{
+  mongo::BSONObj   entity = entityCreate(50);
+  int              loops  = 10000;
+  char*            title;
+  char*            detail;
+  struct timespec  start;
+  struct timespec  end;
+  double           viaJsonUsecs;
+  double           directUsecs;
+
+  orionldStateInit();
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int ix = 0; ix < loops; ix++)
+  {
+    kjTreeViaJson(entity);
+    kaBufferReset(&orionldState.kalloc, false);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  viaJsonUsecs = (end.tv_sec - start.tv_sec) * 1000000.0 + (end.tv_nsec - start.tv_nsec) / 1000.0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int ix = 0; ix < loops; ix++)
+  {
+    mongoCppLegacyKjTreeFromBsonObj(&entity, &title, &detail);
+    kaBufferReset(&orionldState.kalloc, false);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  directUsecs = (end.tv_sec - start.tv_sec) * 1000000.0 + (end.tv_nsec - start.tv_nsec) / 1000.0;
+
+  printf("BSONObj to KjNode tree, 50 attributes: via JSON: %8.2f microseconds, direct: %8.2f microseconds\n",
+         viaJsonUsecs / loops, directUsecs / loops);
+
+  EXPECT_LT(directUsecs, viaJsonUsecs);
+}
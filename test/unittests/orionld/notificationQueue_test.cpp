@@ -0,0 +1,135 @@
+/*
+*
+* Copyright 2020 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "gtest/gtest.h"
+
+#include "orionld/notifications/notificationQueue.h"
+#include "orionld/notifications/notificationQueuePush.h"
+#include "orionld/notifications/notificationQueuePop.h"
+
+
+
+#define PRODUCERS   4
+#define RECORDS     50000
+
+
+
+/* ****************************************************************************
+*
+* queue -
+*/
+static NotificationQueue queue;
+
+
+
+/* ****************************************************************************
+*
+* producer - push RECORDS records, 'port' identifying the producer and 'attempts' the sequence number
+*/
+static void* producer(void* vP)
+{
+  long id = (long) vP;
+
+  for (int ix = 0; ix < RECORDS; ix++)
+  {
+    NotificationRecord* recordP = (NotificationRecord*) calloc(1, sizeof(NotificationRecord));
+
+    recordP->port     = id;
+    recordP->attempts = ix;
+
+    notificationQueuePush(&queue, recordP);
+  }
+
+  return NULL;
+}
+
+
+
+/* ****************************************************************************
+*
+* emptyQueue -
+*/
+TEST(notificationQueue, emptyQueue)
+{
+  NotificationRecord record;
+
+  queue.stub.next = NULL;
+  queue.head      = &queue.stub;
+  queue.tail      = &queue.stub;
+
+  EXPECT_TRUE(notificationQueuePop(&queue) == NULL);
+
+  notificationQueuePush(&queue, &record);
+  EXPECT_EQ(&record, notificationQueuePop(&queue));
+  EXPECT_TRUE(notificationQueuePop(&queue) == NULL);
+
+  notificationQueuePush(&queue, &record);
+  EXPECT_EQ(&record, notificationQueuePop(&queue));
+  EXPECT_TRUE(notificationQueuePop(&queue) == NULL);
+}
+
+
+
+/* ****************************************************************************
+*
+* multipleProducers - all records are popped, in order per producer
+*/
+TEST(notificationQueue, multipleProducers)
+{
+  pthread_t  tid[PRODUCERS];
+  int        last[PRODUCERS];
+  long       popped = 0;
+
+  queue.stub.next = NULL;
+  queue.head      = &queue.stub;
+  queue.tail      = &queue.stub;
+
+  for (long ix = 0; ix < PRODUCERS; ix++)
+  {
+    last[ix] = -1;
+    pthread_create(&tid[ix], NULL, producer, (void*) ix);
+  }
+
+  while (popped < PRODUCERS * RECORDS)
+  {
+    NotificationRecord* recordP = notificationQueuePop(&queue);
+
+    if (recordP == NULL)
+      continue;
+
+    EXPECT_EQ(last[recordP->port] + 1, recordP->attempts);
+    last[recordP->port] = recordP->attempts;
+
+    free(recordP);
+    ++popped;
+  }
+
+  for (int ix = 0; ix < PRODUCERS; ix++)
+    pthread_join(tid[ix], NULL);
+
+  EXPECT_TRUE(notificationQueuePop(&queue) == NULL);
+}
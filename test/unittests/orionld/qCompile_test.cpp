@@ -0,0 +1,250 @@
+/*
+*
+* Copyright 2020 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>
+
+extern "C"
+{
+#include "kalloc/kaStrdup.h"
+#include "kalloc/kaBufferReset.h"
+#include "kjson/KjNode.h"
+#include "kjson/kjParse.h"
+}
+
+#include "gtest/gtest.h"
+
+#include "orionld/common/orionldState.h"
+#include "orionld/common/QCompiled.h"
+#include "orionld/common/qCompile.h"
+#include "orionld/common/qCompiledMatch.h"
+#include "orionld/common/qCompiledRelease.h"
+
+
+
+/* ****************************************************************************
+*
+* Expanded attribute names - as stored in the database ('=') and as in payloads ('.')
+*
+* The 'q' of a subscription is stored in the database with its attribute names already expanded,
+* and that is what the subscription cache compiles. Expanded names need no @context (NULL).
+*/
+#define P1_DB  "https://uri=etsi=org/ngsi-ld/default-context/P1"
+#define P1     "https://uri.etsi.org/ngsi-ld/default-context/P1"
+#define P2_DB  "https://uri=etsi=org/ngsi-ld/default-context/P2"
+#define P2     "https://uri.etsi.org/ngsi-ld/default-context/P2"
+
+
+
+/* ****************************************************************************
+*
+* jsonParse - parse a JSON string into a KjNode tree
+*/
+static KjNode* jsonParse(const char* json)
+{
+  char* buf = kaStrdup(&orionldState.kalloc, json);
+
+  return kjParse(orionldState.kjsonP, buf);
+}
+
+
+
+/* ****************************************************************************
+*
+* compile - compile a Q-filter, without @context
+*/
+static QCompiled* compile(const char* q)
+{
+  char* title;
+  char* detail;
+
+  return qCompile(NULL, q, &title, &detail);
+}
+
+
+
+/* ****************************************************************************
+*
+* qCompile.greaterThan -
+*/
+TEST(qCompile, greaterThan)
+{
+  orionldStateInit();
+
+  QCompiled* qP = compile(P2_DB ">10");
+
+  ASSERT_TRUE(qP != NULL);
+  EXPECT_EQ(QNodeGT, qP->type);
+  EXPECT_STREQ(P2_DB, qP->attrName);
+  EXPECT_STREQ(P2, qP->attrNameDots);
+  EXPECT_TRUE(qP->mdName == NULL);
+  EXPECT_EQ(1, qP->values);
+
+  EXPECT_TRUE(qCompiledMatch(qP,  jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 13}}}"),   NULL));
+  EXPECT_TRUE(qCompiledMatch(qP,  jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 10.5}}}"), NULL));
+  EXPECT_FALSE(qCompiledMatch(qP, jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 10}}}"),   NULL));
+  EXPECT_FALSE(qCompiledMatch(qP, jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": \"13\"}}}"), NULL));
+  EXPECT_FALSE(qCompiledMatch(qP, jsonParse("{\"attrs\": {\"" P1_DB "\": {\"value\": 13}}}"),   NULL));
+
+  qCompiledRelease(qP);
+  kaBufferReset(&orionldState.kalloc, false);
+}
+
+
+
+/* ****************************************************************************
+*
+* qCompile.requestOverridesDatabase - the attributes of the incoming request win over the ones in the database
+*/
+TEST(qCompile, requestOverridesDatabase)
+{
+  orionldStateInit();
+
+  QCompiled* qP       = compile(P2_DB ">10");
+  KjNode*    dbEntity = jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 13}}}");
+
+  ASSERT_TRUE(qP != NULL);
+
+  EXPECT_TRUE(qCompiledMatch(qP,  dbEntity, jsonParse("{\"" P1 "\": {\"value\": 1}}")));
+  EXPECT_FALSE(qCompiledMatch(qP, dbEntity, jsonParse("{\"" P2 "\": {\"value\": 5}}")));
+  EXPECT_TRUE(qCompiledMatch(qP,  NULL,     jsonParse("{\"" P2 "\": {\"value\": 11}}")));
+
+  qCompiledRelease(qP);
+  kaBufferReset(&orionldState.kalloc, false);
+}
+
+
+
+/* ****************************************************************************
+*
+* qCompile.rangeAndList -
+*/
+TEST(qCompile, rangeAndList)
+{
+  orionldStateInit();
+
+  QCompiled* rangeP = compile(P2_DB "==10..20");
+  QCompiled* listP  = compile(P2_DB "==1,3,5");
+
+  ASSERT_TRUE(rangeP != NULL);
+  ASSERT_TRUE(listP  != NULL);
+  EXPECT_EQ(QNodeRange, rangeP->rhsType);
+  EXPECT_EQ(2, rangeP->values);
+  EXPECT_EQ(QNodeComma, listP->rhsType);
+  EXPECT_EQ(3, listP->values);
+
+  EXPECT_TRUE(qCompiledMatch(rangeP,  jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 10}}}"), NULL));
+  EXPECT_TRUE(qCompiledMatch(rangeP,  jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 20}}}"), NULL));
+  EXPECT_FALSE(qCompiledMatch(rangeP, jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 21}}}"), NULL));
+
+  EXPECT_TRUE(qCompiledMatch(listP,   jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 3}}}"), NULL));
+  EXPECT_FALSE(qCompiledMatch(listP,  jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 4}}}"), NULL));
+  EXPECT_TRUE(qCompiledMatch(listP,   jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": [ 2, 4, 5 ]}}}"), NULL));
+
+  qCompiledRelease(rangeP);
+  qCompiledRelease(listP);
+  kaBufferReset(&orionldState.kalloc, false);
+}
+
+
+
+/* ****************************************************************************
+*
+* qCompile.andOr -
+*/
+TEST(qCompile, andOr)
+{
+  orionldStateInit();
+
+  QCompiled* andP   = compile(P1_DB "==\"abc\";" P2_DB "<10");
+  QCompiled* orP    = compile(P1_DB "==\"abc\"|" P2_DB "<10");
+  KjNode*    bothP  = jsonParse("{\"attrs\": {\"" P1_DB "\": {\"value\": \"abc\"}, \"" P2_DB "\": {\"value\": 5}}}");
+  KjNode*    firstP = jsonParse("{\"attrs\": {\"" P1_DB "\": {\"value\": \"abc\"}, \"" P2_DB "\": {\"value\": 50}}}");
+  KjNode*    noneP  = jsonParse("{\"attrs\": {\"" P1_DB "\": {\"value\": \"abd\"}, \"" P2_DB "\": {\"value\": 50}}}");
+
+  ASSERT_TRUE(andP != NULL);
+  ASSERT_TRUE(orP  != NULL);
+  EXPECT_EQ(QNodeAnd, andP->type);
+  EXPECT_EQ(QNodeOr,  orP->type);
+
+  EXPECT_TRUE(qCompiledMatch(andP,  bothP,  NULL));
+  EXPECT_FALSE(qCompiledMatch(andP, firstP, NULL));
+  EXPECT_TRUE(qCompiledMatch(orP,   firstP, NULL));
+  EXPECT_FALSE(qCompiledMatch(orP,  noneP,  NULL));
+
+  qCompiledRelease(andP);
+  qCompiledRelease(orP);
+  kaBufferReset(&orionldState.kalloc, false);
+}
+
+
+
+/* ****************************************************************************
+*
+* qCompile.existence - 'A', '!A' and 'A!=X' (that needs 'A' to exist)
+*/
+TEST(qCompile, existence)
+{
+  orionldStateInit();
+
+  QCompiled* existsP    = compile(P2_DB);
+  QCompiled* notExistsP = compile("!" P2_DB);
+  QCompiled* neP        = compile(P2_DB "!=7");
+  KjNode*    withP      = jsonParse("{\"attrs\": {\"" P2_DB "\": {\"value\": 8}}}");
+  KjNode*    withoutP   = jsonParse("{\"attrs\": {\"" P1_DB "\": {\"value\": 8}}}");
+
+  ASSERT_TRUE(existsP    != NULL);
+  ASSERT_TRUE(notExistsP != NULL);
+  ASSERT_TRUE(neP        != NULL);
+
+  EXPECT_TRUE(qCompiledMatch(existsP,     withP,    NULL));
+  EXPECT_FALSE(qCompiledMatch(existsP,    withoutP, NULL));
+  EXPECT_FALSE(qCompiledMatch(notExistsP, withP,    NULL));
+  EXPECT_TRUE(qCompiledMatch(notExistsP,  withoutP, NULL));
+  EXPECT_TRUE(qCompiledMatch(neP,         withP,    NULL));
+  EXPECT_FALSE(qCompiledMatch(neP,        withoutP, NULL));
+
+  qCompiledRelease(existsP);
+  qCompiledRelease(notExistsP);
+  qCompiledRelease(neP);
+  kaBufferReset(&orionldState.kalloc, false);
+}
+
+
+
+/* ****************************************************************************
+*
+* qCompile.error - invalid Q-filters are not compiled, and the reason is given
+*/
+TEST(qCompile, error)
+{
+  char* title;
+  char* detail;
+
+  orionldStateInit();
+
+  EXPECT_TRUE(qCompile(NULL, P2_DB "==\"abc", &title, &detail) == NULL);
+  EXPECT_TRUE(title != NULL);
+
+  kaBufferReset(&orionldState.kalloc, false);
+}